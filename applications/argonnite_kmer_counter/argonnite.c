@@ -886,6 +886,9 @@ void argonnite_help(struct thorium_actor *actor)
                     BIOSAL_DEFAULT_OUTPUT);
     printf("-print-thorium-data                         display load, memory usage, actor count, active requests\n");
     printf("-print-counters                     print node-level biosal counters\n");
+    printf("-compact-kmer-store                 store kmers with quotienting and 8-bit counters (less memory)\n");
+    printf("-singleton-filter-bits bits         keep kmers seen once in a Bloom filter with this many bits per kmer\n");
+    printf("-single-pass-input                  push sequences to the stores while parsing (no counting pass)\n");
     printf("\n");
 
     printf("Output\n");
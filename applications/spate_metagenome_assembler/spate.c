@@ -741,6 +741,12 @@ void spate_help(struct thorium_actor *self)
     printf("    -o %s\n",
                     BIOSAL_DEFAULT_OUTPUT);
 
+    printf("\n");
+    printf("Options:\n");
+    printf("    -fused-graph-construction (distribute vertices and arcs in one pass on the sequences)\n");
+    printf("    -node-graph-store (graph stores of a node share one table, same-node reads use no messages)\n");
+    printf("    -single-pass-input (push sequences to the stores while parsing, without a counting pass)\n");
+
     printf("\n");
     printf("Example:\n");
     printf("    mpiexec -n 128 spate -threads-per-node 24 -k 51 -i interleaved_file_1.fastq -i interleaved_file_2.fastq -o my-assembly\n");
@@ -11,10 +11,12 @@ CORE_OBJECTS-y=
 CORE_OBJECTS-y += core/file_storage/output/buffered_file_writer.o
 CORE_OBJECTS-y += core/file_storage/input/buffered_reader.o
 CORE_OBJECTS-y += core/file_storage/input/raw_buffered_reader.o
+CORE_OBJECTS-y += core/file_storage/input/mapped_buffered_reader.o
 CORE_OBJECTS-y += core/file_storage/directory.o
 CORE_OBJECTS-y += core/file_storage/file.o
 
 CORE_OBJECTS-$(CONFIG_ZLIB) += core/file_storage/input/gzip_buffered_reader.o
+CORE_OBJECTS-$(CONFIG_ZLIB) += core/file_storage/input/bgzf_index.o
 
 CONFIG_CFLAGS += $(ZLIB_FLAGS-y)
 CONFIG_LDFLAGS += $(ZLIB_LDFLAGS-y)
@@ -0,0 +1,287 @@
+
+#include "bgzf_index.h"
+
+#include <core/system/memory.h>
+#include <core/system/debugger.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#define MEMORY_BGZF_INDEX 0x1c9e07b5
+
+/*
+ * ID1, ID2, CM, FLG, MTIME (4 bytes), XFL, OS, XLEN (2 bytes)
+ */
+#define GZIP_HEADER_SIZE 12
+#define GZIP_FLAG_EXTRA 4
+#define GZIP_TRAILER_SIZE 8
+
+#define SUBFIELD_HEADER_SIZE 4
+
+static int core_bgzf_index_read_header(FILE *descriptor, uint64_t offset, int *block_size);
+static int core_bgzf_index_read_uncompressed_size(FILE *descriptor, uint64_t offset,
+                int block_size, uint32_t *size);
+static void core_bgzf_index_load_gzi(struct core_bgzf_index *self, const char *file,
+                uint64_t file_size);
+
+void core_bgzf_index_init(struct core_bgzf_index *self)
+{
+    core_vector_init(&self->blocks, sizeof(struct core_bgzf_block));
+    self->uncompressed_size = 0;
+}
+
+void core_bgzf_index_destroy(struct core_bgzf_index *self)
+{
+    core_vector_destroy(&self->blocks);
+    self->uncompressed_size = 0;
+}
+
+int core_bgzf_index_detect(const char *file)
+{
+    FILE *descriptor;
+    int block_size;
+    int is_bgzf;
+
+    descriptor = fopen(file, "r");
+
+    if (descriptor == NULL) {
+        return 0;
+    }
+
+    is_bgzf = core_bgzf_index_read_header(descriptor, 0, &block_size);
+
+    fclose(descriptor);
+
+    return is_bgzf;
+}
+
+int core_bgzf_index_load(struct core_bgzf_index *self, const char *file)
+{
+    FILE *descriptor;
+    uint64_t file_size;
+    struct core_bgzf_block block;
+    uint32_t size;
+    int block_size;
+
+    core_vector_clear(&self->blocks);
+    self->uncompressed_size = 0;
+
+    descriptor = fopen(file, "r");
+
+    if (descriptor == NULL) {
+        return 0;
+    }
+
+    fseek(descriptor, 0, SEEK_END);
+    file_size = ftell(descriptor);
+
+    block.compressed_offset = 0;
+    block.uncompressed_offset = 0;
+    core_vector_push_back(&self->blocks, &block);
+
+    /*
+     * The .gzi index gives the first blocks for free. The blocks after
+     * its last entry (if any) are read from the file.
+     */
+    core_bgzf_index_load_gzi(self, file, file_size);
+
+    core_vector_get_value(&self->blocks, core_vector_size(&self->blocks) - 1, &block);
+
+    while (block.compressed_offset < file_size) {
+
+        if (!core_bgzf_index_read_header(descriptor, block.compressed_offset, &block_size)
+                        || !core_bgzf_index_read_uncompressed_size(descriptor,
+                                block.compressed_offset, block_size, &size)) {
+
+            fclose(descriptor);
+            core_vector_clear(&self->blocks);
+
+            return 0;
+        }
+
+        block.compressed_offset += block_size;
+        block.uncompressed_offset += size;
+
+        if (block.compressed_offset < file_size) {
+            core_vector_push_back(&self->blocks, &block);
+        }
+    }
+
+    self->uncompressed_size = block.uncompressed_offset;
+
+    fclose(descriptor);
+
+    return 1;
+}
+
+void core_bgzf_index_find(struct core_bgzf_index *self, uint64_t uncompressed_offset,
+                struct core_bgzf_block *block)
+{
+    struct core_bgzf_block *blocks;
+    int64_t first;
+    int64_t last;
+    int64_t middle;
+
+    CORE_DEBUGGER_ASSERT(core_vector_size(&self->blocks) > 0);
+
+    blocks = core_vector_at(&self->blocks, 0);
+    first = 0;
+    last = core_vector_size(&self->blocks) - 1;
+
+    /*
+     * blocks[first] always starts at or before the offset.
+     */
+    while (first < last) {
+        middle = first + (last - first + 1) / 2;
+
+        if (blocks[middle].uncompressed_offset <= uncompressed_offset) {
+            first = middle;
+        } else {
+            last = middle - 1;
+        }
+    }
+
+    *block = blocks[first];
+}
+
+int core_bgzf_index_size(struct core_bgzf_index *self)
+{
+    return core_vector_size(&self->blocks);
+}
+
+uint64_t core_bgzf_index_uncompressed_size(struct core_bgzf_index *self)
+{
+    return self->uncompressed_size;
+}
+
+/*
+ * A BGZF block is a gzip member with a "BC" extra subfield that
+ * contains the size of the block minus 1.
+ *
+ * \return 1 if there is a BGZF block header at the offset
+ */
+static int core_bgzf_index_read_header(FILE *descriptor, uint64_t offset, int *block_size)
+{
+    uint8_t header[GZIP_HEADER_SIZE];
+    uint8_t subfield[SUBFIELD_HEADER_SIZE];
+    uint8_t value[2];
+    int extra_length;
+    int subfield_length;
+    int position;
+
+    if (fseek(descriptor, offset, SEEK_SET) != 0
+                    || fread(header, 1, GZIP_HEADER_SIZE, descriptor) != GZIP_HEADER_SIZE) {
+        return 0;
+    }
+
+    if (header[0] != 0x1f || header[1] != 0x8b || header[2] != 8
+                    || !(header[3] & GZIP_FLAG_EXTRA)) {
+        return 0;
+    }
+
+    extra_length = header[10] | (header[11] << 8);
+    position = 0;
+
+    while (position + SUBFIELD_HEADER_SIZE <= extra_length) {
+
+        if (fread(subfield, 1, SUBFIELD_HEADER_SIZE, descriptor) != SUBFIELD_HEADER_SIZE) {
+            return 0;
+        }
+
+        subfield_length = subfield[2] | (subfield[3] << 8);
+        position += SUBFIELD_HEADER_SIZE + subfield_length;
+
+        if (subfield[0] == 'B' && subfield[1] == 'C' && subfield_length == 2) {
+
+            if (fread(value, 1, 2, descriptor) != 2) {
+                return 0;
+            }
+
+            *block_size = (value[0] | (value[1] << 8)) + 1;
+
+            return *block_size >= GZIP_HEADER_SIZE + extra_length + GZIP_TRAILER_SIZE;
+        }
+
+        if (fseek(descriptor, subfield_length, SEEK_CUR) != 0) {
+            return 0;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * The last 4 bytes of a gzip member are ISIZE, the size of the
+ * uncompressed data.
+ */
+static int core_bgzf_index_read_uncompressed_size(FILE *descriptor, uint64_t offset,
+                int block_size, uint32_t *size)
+{
+    uint8_t value[4];
+
+    if (fseek(descriptor, offset + block_size - 4, SEEK_SET) != 0
+                    || fread(value, 1, 4, descriptor) != 4) {
+        return 0;
+    }
+
+    *size = value[0] | (value[1] << 8) | (value[2] << 16) | ((uint32_t)value[3] << 24);
+
+    return 1;
+}
+
+/*
+ * The .gzi format is the number of entries followed by
+ * (compressed offset, uncompressed offset) pairs, all stored as
+ * little-endian uint64_t. The first block is not listed.
+ */
+static void core_bgzf_index_load_gzi(struct core_bgzf_index *self, const char *file,
+                uint64_t file_size)
+{
+    FILE *descriptor;
+    char *index_file;
+    uint64_t count;
+    uint64_t i;
+    struct core_bgzf_block block;
+    struct core_bgzf_block last;
+
+    index_file = core_memory_allocate(strlen(file) + strlen(CORE_BGZF_INDEX_SUFFIX) + 1,
+                    MEMORY_BGZF_INDEX);
+    strcpy(index_file, file);
+    strcat(index_file, CORE_BGZF_INDEX_SUFFIX);
+
+    descriptor = fopen(index_file, "r");
+
+    core_memory_free(index_file, MEMORY_BGZF_INDEX);
+
+    if (descriptor == NULL) {
+        return;
+    }
+
+    if (fread(&count, sizeof(count), 1, descriptor) != 1) {
+        count = 0;
+    }
+
+    core_vector_get_value(&self->blocks, 0, &last);
+
+    for (i = 0; i < count; ++i) {
+
+        if (fread(&block.compressed_offset, sizeof(uint64_t), 1, descriptor) != 1
+                        || fread(&block.uncompressed_offset, sizeof(uint64_t), 1, descriptor) != 1) {
+            break;
+        }
+
+        /*
+         * Ignore an index that does not match the file.
+         */
+        if (block.compressed_offset <= last.compressed_offset
+                        || block.compressed_offset >= file_size
+                        || block.uncompressed_offset < last.uncompressed_offset) {
+            break;
+        }
+
+        core_vector_push_back(&self->blocks, &block);
+        last = block;
+    }
+
+    fclose(descriptor);
+}
@@ -0,0 +1,65 @@
+
+#ifndef CORE_BGZF_INDEX_H
+#define CORE_BGZF_INDEX_H
+
+#include <core/structures/vector.h>
+
+#include <stdint.h>
+
+#define CORE_BGZF_INDEX_SUFFIX ".gzi"
+
+/*
+ * A BGZF block: its offset in the compressed file and the offset of
+ * its first byte in the uncompressed content.
+ */
+struct core_bgzf_block {
+    uint64_t compressed_offset;
+    uint64_t uncompressed_offset;
+};
+
+/*
+ * An index of the blocks of a BGZF file (blocked gzip, as written by
+ * bgzip).
+ *
+ * A BGZF file is a series of gzip members of at most 64 KiB. Each
+ * member has its compressed size in an extra field of its header and
+ * its uncompressed size in its trailer, so the index is built by
+ * reading only the headers and trailers. With the index, a reader
+ * starts inflating at any block, so a BGZF file can be split in ranges
+ * of uncompressed bytes like a raw file.
+ *
+ * If there is a <file>.gzi index (bgzip -i or bgzip -r), it is used
+ * for the blocks that it lists.
+ *
+ * \see http://samtools.github.io/hts-specs/SAMv1.pdf (section 4.1)
+ */
+struct core_bgzf_index {
+    struct core_vector blocks;
+    uint64_t uncompressed_size;
+};
+
+void core_bgzf_index_init(struct core_bgzf_index *self);
+void core_bgzf_index_destroy(struct core_bgzf_index *self);
+
+/*
+ * \return 1 if the file starts with a BGZF block, 0 otherwise
+ */
+int core_bgzf_index_detect(const char *file);
+
+/*
+ * Build the index of a BGZF file.
+ *
+ * \return 1 on success, 0 if the file is not a valid BGZF file
+ */
+int core_bgzf_index_load(struct core_bgzf_index *self, const char *file);
+
+/*
+ * Find the last block that starts at or before an uncompressed offset.
+ */
+void core_bgzf_index_find(struct core_bgzf_index *self, uint64_t uncompressed_offset,
+                struct core_bgzf_block *block);
+
+int core_bgzf_index_size(struct core_bgzf_index *self);
+uint64_t core_bgzf_index_uncompressed_size(struct core_bgzf_index *self);
+
+#endif
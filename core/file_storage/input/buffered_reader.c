@@ -2,11 +2,14 @@
 #include "buffered_reader.h"
 
 #include "raw_buffered_reader.h"
+#include "mapped_buffered_reader.h"
 
 #ifdef CONFIG_ZLIB
 #include "gzip_buffered_reader.h"
 #endif
 
+#include <core/file_storage/file.h>
+
 #include <core/system/memory.h>
 #include <core/system/debugger.h>
 
@@ -69,6 +72,19 @@ int core_buffered_reader_read_line(struct core_buffered_reader *self,
     return return_value;
 }
 
+int core_buffered_reader_read_line_view(struct core_buffered_reader *self,
+                const char **line)
+{
+    CORE_DEBUGGER_ASSERT(self->interface->read_line_view != NULL);
+
+    return self->interface->read_line_view(self, line);
+}
+
+int core_buffered_reader_has_line_views(struct core_buffered_reader *self)
+{
+    return self->interface->read_line_view != NULL;
+}
+
 void *core_buffered_reader_get_concrete_self(struct core_buffered_reader *self)
 {
     return self->concrete_self;
@@ -84,6 +100,12 @@ void core_buffered_reader_select(struct core_buffered_reader *self, const char *
     }
 #endif
 
+    if (core_mapped_buffered_reader_implementation.detect(self, file)) {
+
+        self->interface = &core_mapped_buffered_reader_implementation;
+        return;
+    }
+
     self->interface = &core_raw_buffered_reader_implementation;
 }
 
@@ -99,3 +121,18 @@ int core_buffered_reader_get_previous_bytes(struct core_buffered_reader *self, c
 {
     return self->interface->get_previous_bytes(self, buffer, length);
 }
+
+int core_buffered_reader_get_content_size(const char *file, uint64_t *size)
+{
+    struct core_buffered_reader reader;
+
+    core_buffered_reader_select(&reader, file);
+
+    if (reader.interface->get_content_size != NULL) {
+        return reader.interface->get_content_size(file, size);
+    }
+
+    *size = core_file_get_size(file);
+
+    return 1;
+}
@@ -34,8 +34,29 @@ void core_buffered_reader_destroy(struct core_buffered_reader *self);
 int core_buffered_reader_read_line(struct core_buffered_reader *self,
                 char *buffer, int length);
 
+/*
+ * Get the next line without copying it, if the reader supports it.
+ * The line is not terminated by a '\0' and it is valid until the
+ * reader is destroyed.
+ *
+ * \return number of bytes in the line, including the \n if any
+ */
+int core_buffered_reader_read_line_view(struct core_buffered_reader *self,
+                const char **line);
+int core_buffered_reader_has_line_views(struct core_buffered_reader *self);
+
 void *core_buffered_reader_get_concrete_self(struct core_buffered_reader *self);
 uint64_t core_buffered_reader_get_offset(struct core_buffered_reader *self);
 int core_buffered_reader_get_previous_bytes(struct core_buffered_reader *self, char *buffer, int length);
 
+/*
+ * Get the number of bytes that a reader reads in a file, which is
+ * the file size unless the file is compressed. Offsets given to
+ * core_buffered_reader_init are in these bytes.
+ *
+ * \return 1 if the size is known without reading the whole file,
+ * 0 otherwise (for instance, a gzip file that is not a BGZF file)
+ */
+int core_buffered_reader_get_content_size(const char *file, uint64_t *size);
+
 #endif
@@ -17,6 +17,12 @@ struct core_buffered_reader_interface {
     int (*detect)(struct core_buffered_reader *self, const char *file);
     uint64_t (*get_offset)(struct core_buffered_reader *self);
     int (*get_previous_bytes)(struct core_buffered_reader *self, char *buffer, int length);
+
+    /*
+     * Optional.
+     */
+    int (*read_line_view)(struct core_buffered_reader *self, const char **line);
+    int (*get_content_size)(const char *file, uint64_t *size);
 };
 
 #endif
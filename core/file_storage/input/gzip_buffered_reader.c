@@ -2,6 +2,7 @@
 #include "gzip_buffered_reader.h"
 
 #include "buffered_reader.h"
+#include "bgzf_index.h"
 
 #include <core/system/memory.h>
 #include <core/system/debugger.h>
@@ -10,6 +11,9 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <fcntl.h>
+#include <unistd.h>
+
 #include <inttypes.h>
 
 /*
@@ -25,6 +29,13 @@
 #define CORE_BUFFERED_READER_BUFFER_SIZE 8388608
 #define GZ_FILE_EXTENSION ".gz"
 
+/*
+ * The internal buffer of zlib for compressed bytes (the default is 8 KiB).
+ */
+#define GZ_INPUT_BUFFER_SIZE 131072
+
+#define CORE_GZIP_BUFFERED_READER_SLOT_SIZE 1048576
+
 #define MEMORY_GZIP 0x4480c242
 
 void core_gzip_buffered_reader_init(struct core_buffered_reader *reader,
@@ -47,6 +58,18 @@ void core_gzip_buffered_reader_open(struct core_buffered_reader *self,
 
 int core_gzip_buffered_reader_read(struct core_buffered_reader *self,
                 char *buffer, int length);
+int core_gzip_buffered_reader_inflate(struct core_buffered_reader *self,
+                char *buffer, int length);
+
+static gzFile core_gzip_buffered_reader_open_bgzf(const char *file, uint64_t offset);
+
+#ifdef CORE_GZIP_BUFFERED_READER_USE_HELPER_THREAD
+static void core_gzip_buffered_reader_start_helper(struct core_buffered_reader *self);
+static void core_gzip_buffered_reader_stop_helper(struct core_buffered_reader *self);
+static void *core_gzip_buffered_reader_run_helper(void *argument);
+static int core_gzip_buffered_reader_read_slot(struct core_buffered_reader *self,
+                char *buffer, int length);
+#endif
 
 #ifdef CORE_GZIP_BUFFERED_READER_USE_INFLATE
 int core_gzip_buffered_reader_pull_raw(struct core_buffered_reader *self);
@@ -72,7 +95,8 @@ struct core_buffered_reader_interface core_gzip_buffered_reader_implementation =
     .detect = core_gzip_buffered_reader_detect,
     .get_offset = core_gzip_buffered_reader_get_offset,
     .get_previous_bytes = core_gzip_buffered_reader_get_previous_bytes,
-    .size = sizeof(struct core_gzip_buffered_reader)
+    .size = sizeof(struct core_gzip_buffered_reader),
+    .get_content_size = core_gzip_buffered_reader_get_content_size
 };
 
 /*#define CORE_BUFFERED_READER_BUFFER_SIZE 4194304*/
@@ -96,6 +120,10 @@ void core_gzip_buffered_reader_init(struct core_buffered_reader *self,
     reader->buffer_size = 0;
 
     reader->offset = offset;
+
+#ifdef CORE_GZIP_BUFFERED_READER_USE_HELPER_THREAD
+    core_gzip_buffered_reader_start_helper(self);
+#endif
 }
 
 void core_gzip_buffered_reader_destroy(struct core_buffered_reader *self)
@@ -104,6 +132,10 @@ void core_gzip_buffered_reader_destroy(struct core_buffered_reader *self)
 
     reader = core_buffered_reader_get_concrete_self(self);
 
+#ifdef CORE_GZIP_BUFFERED_READER_USE_HELPER_THREAD
+    core_gzip_buffered_reader_stop_helper(self);
+#endif
+
     core_memory_free(reader->buffer, MEMORY_GZIP);
 
     reader->buffer = NULL;
@@ -128,8 +160,10 @@ void core_gzip_buffered_reader_destroy(struct core_buffered_reader *self)
         reader->got_header = 0;
     }
 #else
-    gzclose(reader->descriptor);
-    reader->descriptor = NULL;
+    if (reader->descriptor != NULL) {
+        gzclose(reader->descriptor);
+        reader->descriptor = NULL;
+    }
 #endif
 }
 
@@ -168,51 +202,55 @@ int core_gzip_buffered_reader_read_line_private(struct core_buffered_reader *sel
     }
 
     new_line = '\n';
-    position = reader->position_in_buffer;
-    has_new_line = 0;
 
-    while (position < reader->buffer_size) {
-        if (reader->buffer[position] == new_line) {
-            has_new_line = 1;
+    /*
+     * Like the raw reader, keep the new line (if any) so that offsets
+     * count every byte, and return the last line even if it has no
+     * new line.
+     */
+    while (1) {
+        position = reader->position_in_buffer;
+        has_new_line = 0;
+
+        while (position < reader->buffer_size) {
+            if (reader->buffer[position] == new_line) {
+                has_new_line = 1;
+                break;
+            }
+            position++;
+        }
+
+        if (has_new_line) {
+            ++position;
+            break;
+        }
+
+        /* try to pull some data
+         */
+        if (!core_gzip_buffered_reader_pull(self)) {
             break;
         }
-        position++;
     }
 
-    if (has_new_line) {
+    read = position - reader->position_in_buffer;
 
-        read = position - reader->position_in_buffer;
+    if (read > 0) {
         core_memory_copy(buffer, reader->buffer + reader->position_in_buffer,
                         read);
-        buffer[read] = '\0';
+    }
 
-        reader->position_in_buffer += read;
+    buffer[read] = '\0';
 
-        /* skip '\n'
-         */
-        reader->position_in_buffer++;
+    reader->position_in_buffer += read;
 
 #ifdef CORE_BUFFERED_READER_DEBUG9
-        printf("DEBUG core_buffered_reader_read_line has line"
-                        "  %i to %i-1 : %s\n", position,
-                        reader->position_in_buffer,
-                        buffer);
+    printf("DEBUG core_buffered_reader_read_line has line"
+                    "  %i to %i-1 : %s\n", position,
+                    reader->position_in_buffer,
+                    buffer);
 #endif
 
-        return read;
-    } else {
-        /* try to pull some data and do a recursive call
-         */
-        if (core_gzip_buffered_reader_pull(self)) {
-            return core_gzip_buffered_reader_read_line_private(self, buffer, length);
-        } else {
-            return 0;
-        }
-    }
-
-    /* otherwise, there is nothing to return
-     */
-    return 0;
+    return read;
 }
 
 int core_gzip_buffered_reader_pull(struct core_buffered_reader *self)
@@ -303,17 +341,87 @@ void core_gzip_buffered_reader_open(struct core_buffered_reader *self,
     reader->input_buffer = core_memory_allocate(reader->input_buffer_capacity, MEMORY_GZIP);
 
 #else
-    reader->descriptor = gzopen(file, "r");
+    reader->descriptor = NULL;
 
-    /* seek- in the file
-     */
-    gzseek(reader->descriptor, offset, SEEK_SET);
+    if (offset > 0) {
+        reader->descriptor = core_gzip_buffered_reader_open_bgzf(file, offset);
+    }
+
+    if (reader->descriptor == NULL) {
+        reader->descriptor = gzopen(file, "r");
+
+        if (reader->descriptor != NULL) {
+            gzbuffer(reader->descriptor, GZ_INPUT_BUFFER_SIZE);
+
+            /* seek- in the file
+             */
+            gzseek(reader->descriptor, offset, SEEK_SET);
+        }
+    }
 #endif
 }
 
+/*
+ * Open a BGZF file at the block that contains an uncompressed offset.
+ * zlib reads the following gzip members transparently.
+ *
+ * \return NULL if the file is not a BGZF file
+ */
+static gzFile core_gzip_buffered_reader_open_bgzf(const char *file, uint64_t offset)
+{
+    struct core_bgzf_index index;
+    struct core_bgzf_block block;
+    gzFile descriptor;
+    int file_descriptor;
+
+    if (!core_bgzf_index_detect(file)) {
+        return NULL;
+    }
+
+    descriptor = NULL;
+    core_bgzf_index_init(&index);
+
+    if (core_bgzf_index_load(&index, file)) {
+        core_bgzf_index_find(&index, offset, &block);
+
+        file_descriptor = open(file, O_RDONLY);
+
+        if (file_descriptor >= 0) {
+
+            /*
+             * gzdopen starts at the current position of the file descriptor.
+             */
+            if (lseek(file_descriptor, block.compressed_offset, SEEK_SET) >= 0) {
+                descriptor = gzdopen(file_descriptor, "r");
+            }
+
+            if (descriptor == NULL) {
+                close(file_descriptor);
+            } else {
+                gzbuffer(descriptor, GZ_INPUT_BUFFER_SIZE);
+                gzseek(descriptor, offset - block.uncompressed_offset, SEEK_SET);
+            }
+        }
+    }
+
+    core_bgzf_index_destroy(&index);
+
+    return descriptor;
+}
+
 int core_gzip_buffered_reader_read(struct core_buffered_reader *self,
                 char *buffer, int length)
 {
+#ifdef CORE_GZIP_BUFFERED_READER_USE_HELPER_THREAD
+    return core_gzip_buffered_reader_read_slot(self, buffer, length);
+#else
+    return core_gzip_buffered_reader_inflate(self, buffer, length);
+#endif
+}
+
+int core_gzip_buffered_reader_inflate(struct core_buffered_reader *self,
+                char *buffer, int length)
+{
 #ifdef CORE_GZIP_BUFFERED_READER_USE_INFLATE
     int read;
 
@@ -332,13 +440,172 @@ int core_gzip_buffered_reader_read(struct core_buffered_reader *self,
 
     reader = core_buffered_reader_get_concrete_self(self);
 
+    if (reader->descriptor == NULL) {
+        return 0;
+    }
+
     read = gzread(reader->descriptor, buffer, length);
 
+    if (read < 0) {
+        read = 0;
+    }
+
     return read;
 #endif
 
 }
 
+#ifdef CORE_GZIP_BUFFERED_READER_USE_HELPER_THREAD
+static void core_gzip_buffered_reader_start_helper(struct core_buffered_reader *self)
+{
+    struct core_gzip_buffered_reader *reader;
+    int i;
+
+    reader = core_buffered_reader_get_concrete_self(self);
+
+    pthread_mutex_init(&reader->slot_mutex, NULL);
+    pthread_cond_init(&reader->slot_condition, NULL);
+
+    reader->slot_capacity = CORE_GZIP_BUFFERED_READER_SLOT_SIZE;
+
+    for (i = 0; i < CORE_GZIP_BUFFERED_READER_SLOT_COUNT; ++i) {
+        reader->slots[i] = core_memory_allocate(reader->slot_capacity, MEMORY_GZIP);
+        reader->slot_sizes[i] = 0;
+        reader->slot_is_full[i] = 0;
+    }
+
+    reader->current_slot = 0;
+    reader->position_in_slot = 0;
+    reader->stop = 0;
+
+    core_thread_init(&reader->helper, core_gzip_buffered_reader_run_helper, self);
+    core_thread_start(&reader->helper);
+}
+
+static void core_gzip_buffered_reader_stop_helper(struct core_buffered_reader *self)
+{
+    struct core_gzip_buffered_reader *reader;
+    int i;
+
+    reader = core_buffered_reader_get_concrete_self(self);
+
+    pthread_mutex_lock(&reader->slot_mutex);
+    reader->stop = 1;
+    pthread_cond_broadcast(&reader->slot_condition);
+    pthread_mutex_unlock(&reader->slot_mutex);
+
+    core_thread_join(&reader->helper);
+    core_thread_destroy(&reader->helper);
+
+    for (i = 0; i < CORE_GZIP_BUFFERED_READER_SLOT_COUNT; ++i) {
+        core_memory_free(reader->slots[i], MEMORY_GZIP);
+        reader->slots[i] = NULL;
+    }
+
+    pthread_cond_destroy(&reader->slot_condition);
+    pthread_mutex_destroy(&reader->slot_mutex);
+}
+
+/*
+ * The helper inflates in the slots, in order. An empty slot marks
+ * the end of the file.
+ */
+static void *core_gzip_buffered_reader_run_helper(void *argument)
+{
+    struct core_buffered_reader *self;
+    struct core_gzip_buffered_reader *reader;
+    int slot;
+    int read;
+
+    self = argument;
+    reader = core_buffered_reader_get_concrete_self(self);
+    slot = 0;
+
+    while (1) {
+        pthread_mutex_lock(&reader->slot_mutex);
+
+        while (reader->slot_is_full[slot] && !reader->stop) {
+            pthread_cond_wait(&reader->slot_condition, &reader->slot_mutex);
+        }
+
+        if (reader->stop) {
+            pthread_mutex_unlock(&reader->slot_mutex);
+            break;
+        }
+
+        pthread_mutex_unlock(&reader->slot_mutex);
+
+        read = core_gzip_buffered_reader_inflate(self, reader->slots[slot],
+                        reader->slot_capacity);
+
+        pthread_mutex_lock(&reader->slot_mutex);
+        reader->slot_sizes[slot] = read;
+        reader->slot_is_full[slot] = 1;
+        pthread_cond_broadcast(&reader->slot_condition);
+        pthread_mutex_unlock(&reader->slot_mutex);
+
+        if (read == 0) {
+            break;
+        }
+
+        slot = (slot + 1) % CORE_GZIP_BUFFERED_READER_SLOT_COUNT;
+    }
+
+    return NULL;
+}
+
+static int core_gzip_buffered_reader_read_slot(struct core_buffered_reader *self,
+                char *buffer, int length)
+{
+    struct core_gzip_buffered_reader *reader;
+    int slot;
+    int available;
+
+    reader = core_buffered_reader_get_concrete_self(self);
+    slot = reader->current_slot;
+
+    pthread_mutex_lock(&reader->slot_mutex);
+
+    while (!reader->slot_is_full[slot]) {
+        pthread_cond_wait(&reader->slot_condition, &reader->slot_mutex);
+    }
+
+    pthread_mutex_unlock(&reader->slot_mutex);
+
+    available = reader->slot_sizes[slot] - reader->position_in_slot;
+
+    if (length > available) {
+        length = available;
+    }
+
+    /*
+     * The end of the file (the slot stays full).
+     */
+    if (length == 0) {
+        return 0;
+    }
+
+    core_memory_copy(buffer, reader->slots[slot] + reader->position_in_slot, length);
+    reader->position_in_slot += length;
+
+    /*
+     * Give the slot back to the helper.
+     */
+    if (reader->position_in_slot == reader->slot_sizes[slot]) {
+
+        pthread_mutex_lock(&reader->slot_mutex);
+        reader->slot_is_full[slot] = 0;
+        pthread_cond_broadcast(&reader->slot_condition);
+        pthread_mutex_unlock(&reader->slot_mutex);
+
+        reader->position_in_slot = 0;
+        reader->current_slot = (slot + 1) % CORE_GZIP_BUFFERED_READER_SLOT_COUNT;
+    }
+
+    return length;
+}
+#endif
+
 #ifdef CORE_GZIP_BUFFERED_READER_USE_INFLATE
 int core_gzip_buffered_reader_pull_raw(struct core_buffered_reader *self)
 {
@@ -567,3 +834,25 @@ int core_gzip_buffered_reader_get_previous_bytes(struct core_buffered_reader *se
      */
     return -1;
 }
+
+int core_gzip_buffered_reader_get_content_size(const char *file, uint64_t *size)
+{
+    struct core_bgzf_index index;
+    int found;
+
+    if (!core_bgzf_index_detect(file)) {
+        return 0;
+    }
+
+    core_bgzf_index_init(&index);
+
+    found = core_bgzf_index_load(&index, file);
+
+    if (found) {
+        *size = core_bgzf_index_uncompressed_size(&index);
+    }
+
+    core_bgzf_index_destroy(&index);
+
+    return found;
+}
@@ -5,7 +5,10 @@
 
 #include "buffered_reader_interface.h"
 
+#include <core/system/thread.h>
+
 #include <zlib.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdint.h>
 
@@ -18,10 +21,23 @@ struct core_buffered_reader;
 #define CORE_GZIP_BUFFERED_READER_USE_INFLATE
 */
 
+/*
+ * Decompress on a helper thread. The helper fills one slot while the
+ * parser consumes the other one, so parsing and inflating overlap.
+ */
+#define CORE_GZIP_BUFFERED_READER_USE_HELPER_THREAD
+
+#define CORE_GZIP_BUFFERED_READER_SLOT_COUNT 2
+
 /*
  * A buffered reader for compressed files
  * with gzip.
  *
+ * Offsets are offsets in the uncompressed content. For a BGZF file (see
+ * core_bgzf_index), the reader starts inflating at the block that
+ * contains the offset. Otherwise, it has to inflate everything before
+ * the offset.
+ *
  * \see http://www.lemoda.net/c/zlib-open-read/
  */
 struct core_gzip_buffered_reader {
@@ -51,8 +67,28 @@ struct core_gzip_buffered_reader {
     gzFile descriptor;
 #endif
 
+#ifdef CORE_GZIP_BUFFERED_READER_USE_HELPER_THREAD
+    struct core_thread helper;
+    pthread_mutex_t slot_mutex;
+    pthread_cond_t slot_condition;
+
+    char *slots[CORE_GZIP_BUFFERED_READER_SLOT_COUNT];
+    int slot_sizes[CORE_GZIP_BUFFERED_READER_SLOT_COUNT];
+    int slot_is_full[CORE_GZIP_BUFFERED_READER_SLOT_COUNT];
+    int slot_capacity;
+
+    int current_slot;
+    int position_in_slot;
+    int stop;
+#endif
 };
 
+/*
+ * \return 1 if the size of the uncompressed content is known
+ * without inflating the file (BGZF), 0 otherwise
+ */
+int core_gzip_buffered_reader_get_content_size(const char *file, uint64_t *size);
+
 extern struct core_buffered_reader_interface core_gzip_buffered_reader_implementation;
 
 #endif
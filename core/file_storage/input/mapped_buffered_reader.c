@@ -0,0 +1,283 @@
+#include "mapped_buffered_reader.h"
+
+#include "buffered_reader.h"
+
+#include <core/system/memory.h>
+
+#include <stdio.h>
+#include <string.h>
+
+#include <inttypes.h>
+
+/*
+ * Memory mapping is not used on the IBM Blue Gene/Q.
+ */
+#if defined(__linux__) && !defined(__bgq__)
+#define CORE_MAPPED_BUFFERED_READER_ENABLED
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/*
+ * The size of the windows given to madvise(MADV_WILLNEED).
+ */
+#define CORE_MAPPED_BUFFERED_READER_WINDOW_SIZE 8388608
+
+void core_mapped_buffered_reader_init(struct core_buffered_reader *self,
+                const char *file, uint64_t offset);
+void core_mapped_buffered_reader_destroy(struct core_buffered_reader *self);
+int core_mapped_buffered_reader_read_line(struct core_buffered_reader *self,
+                char *buffer, int length);
+int core_mapped_buffered_reader_read_line_view(struct core_buffered_reader *self,
+                const char **line);
+int core_mapped_buffered_reader_detect(struct core_buffered_reader *self,
+                const char *file);
+uint64_t core_mapped_buffered_reader_get_offset(struct core_buffered_reader *self);
+int core_mapped_buffered_reader_get_previous_bytes(struct core_buffered_reader *self,
+                char *buffer, int length);
+
+static void core_mapped_buffered_reader_advise(struct core_mapped_buffered_reader *self);
+
+struct core_buffered_reader_interface core_mapped_buffered_reader_implementation = {
+    .init = core_mapped_buffered_reader_init,
+    .destroy = core_mapped_buffered_reader_destroy,
+    .read_line = core_mapped_buffered_reader_read_line,
+    .read_line_view = core_mapped_buffered_reader_read_line_view,
+    .detect = core_mapped_buffered_reader_detect,
+    .get_offset = core_mapped_buffered_reader_get_offset,
+    .get_previous_bytes = core_mapped_buffered_reader_get_previous_bytes,
+    .size = sizeof(struct core_mapped_buffered_reader)
+};
+
+void core_mapped_buffered_reader_init(struct core_buffered_reader *self,
+                const char *file, uint64_t offset)
+{
+    struct core_mapped_buffered_reader *reader;
+#ifdef CORE_MAPPED_BUFFERED_READER_ENABLED
+    int descriptor;
+    struct stat information;
+    uint64_t page_size;
+    void *mapping;
+#endif
+
+    reader = core_buffered_reader_get_concrete_self(self);
+
+    reader->mapping = NULL;
+    reader->mapping_offset = 0;
+    reader->mapping_size = 0;
+    reader->file_size = 0;
+    reader->offset = offset;
+    reader->advised_offset = 0;
+
+#ifdef CORE_MAPPED_BUFFERED_READER_ENABLED
+    descriptor = open(file, O_RDONLY);
+
+    if (descriptor < 0) {
+        return;
+    }
+
+    if (fstat(descriptor, &information) != 0) {
+        close(descriptor);
+        return;
+    }
+
+    reader->file_size = information.st_size;
+
+    /*
+     * Only the part of the file after the offset is mapped.
+     */
+    page_size = sysconf(_SC_PAGESIZE);
+    reader->mapping_offset = offset / page_size * page_size;
+
+    if (reader->mapping_offset < reader->file_size) {
+        reader->mapping_size = reader->file_size - reader->mapping_offset;
+
+        mapping = mmap(NULL, reader->mapping_size, PROT_READ, MAP_PRIVATE,
+                        descriptor, reader->mapping_offset);
+
+        if (mapping != MAP_FAILED) {
+            reader->mapping = mapping;
+            reader->advised_offset = reader->mapping_offset;
+
+            madvise(reader->mapping, reader->mapping_size, MADV_SEQUENTIAL);
+            core_mapped_buffered_reader_advise(reader);
+        } else {
+            reader->mapping_size = 0;
+        }
+    }
+
+    /*
+     * The mapping stays valid after the file is closed.
+     */
+    close(descriptor);
+#endif
+}
+
+void core_mapped_buffered_reader_destroy(struct core_buffered_reader *self)
+{
+    struct core_mapped_buffered_reader *reader;
+
+    reader = core_buffered_reader_get_concrete_self(self);
+
+#ifdef CORE_MAPPED_BUFFERED_READER_ENABLED
+    if (reader->mapping != NULL) {
+        munmap(reader->mapping, reader->mapping_size);
+    }
+#endif
+
+    reader->mapping = NULL;
+    reader->mapping_size = 0;
+    reader->file_size = 0;
+    reader->offset = 0;
+}
+
+int core_mapped_buffered_reader_read_line_view(struct core_buffered_reader *self,
+                const char **line)
+{
+    struct core_mapped_buffered_reader *reader;
+    char *start;
+    char *new_line;
+    uint64_t available;
+    int length;
+
+    reader = core_buffered_reader_get_concrete_self(self);
+
+    if (reader->mapping == NULL || reader->offset >= reader->file_size) {
+        return 0;
+    }
+
+    start = reader->mapping + (reader->offset - reader->mapping_offset);
+    available = reader->file_size - reader->offset;
+
+    new_line = memchr(start, '\n', available);
+
+    /*
+     * Keep the new line if any.
+     */
+    if (new_line != NULL) {
+        length = new_line - start + 1;
+    } else {
+        length = available;
+    }
+
+    reader->offset += length;
+
+    /*
+     * The next window is requested when half of the current
+     * one is read.
+     */
+    if (reader->offset + CORE_MAPPED_BUFFERED_READER_WINDOW_SIZE / 2 > reader->advised_offset
+                    && reader->advised_offset < reader->file_size) {
+        core_mapped_buffered_reader_advise(reader);
+    }
+
+    *line = start;
+
+    return length;
+}
+
+int core_mapped_buffered_reader_read_line(struct core_buffered_reader *self,
+                char *buffer, int length)
+{
+    const char *line;
+    int read;
+
+    line = NULL;
+    read = core_mapped_buffered_reader_read_line_view(self, &line);
+
+    /*
+     * A line that does not fit in the buffer is truncated.
+     */
+    if (read > length - 1) {
+        read = length - 1;
+    }
+
+    if (read > 0) {
+        core_memory_copy(buffer, line, read);
+    }
+
+    buffer[read] = '\0';
+
+    return read;
+}
+
+/*
+ * Ask the kernel to read the next window of the file.
+ */
+static void core_mapped_buffered_reader_advise(struct core_mapped_buffered_reader *self)
+{
+#ifdef CORE_MAPPED_BUFFERED_READER_ENABLED
+    uint64_t start;
+    uint64_t end;
+
+    start = self->advised_offset;
+    end = self->offset + CORE_MAPPED_BUFFERED_READER_WINDOW_SIZE;
+
+    if (end >= self->file_size) {
+        end = self->file_size;
+    } else {
+        /*
+         * madvise needs addresses aligned on pages.
+         */
+        end -= (end - self->mapping_offset) % sysconf(_SC_PAGESIZE);
+    }
+
+    if (start < end) {
+        madvise(self->mapping + (start - self->mapping_offset), end - start, MADV_WILLNEED);
+        self->advised_offset = end;
+    }
+#endif
+}
+
+int core_mapped_buffered_reader_detect(struct core_buffered_reader *self,
+                const char *file)
+{
+#ifdef CORE_MAPPED_BUFFERED_READER_ENABLED
+    struct stat information;
+
+    if (stat(file, &information) != 0) {
+        return 0;
+    }
+
+    return S_ISREG(information.st_mode) && information.st_size > 0;
+#else
+    return 0;
+#endif
+}
+
+uint64_t core_mapped_buffered_reader_get_offset(struct core_buffered_reader *self)
+{
+    struct core_mapped_buffered_reader *reader;
+
+    reader = core_buffered_reader_get_concrete_self(self);
+
+    return reader->offset;
+}
+
+int core_mapped_buffered_reader_get_previous_bytes(struct core_buffered_reader *self,
+                char *buffer, int length)
+{
+    struct core_mapped_buffered_reader *reader;
+    uint64_t available;
+
+    reader = core_buffered_reader_get_concrete_self(self);
+
+    if (reader->mapping == NULL) {
+        return -1;
+    }
+
+    available = reader->offset - reader->mapping_offset;
+
+    if ((uint64_t)length > available) {
+        length = available;
+    }
+
+    if (length > 0) {
+        core_memory_copy(buffer, reader->mapping + (reader->offset - reader->mapping_offset - length),
+                        length);
+    }
+
+    return length;
+}
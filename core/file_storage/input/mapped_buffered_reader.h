@@ -0,0 +1,31 @@
+
+#ifndef CORE_MAPPED_BUFFERED_READER_H
+#define CORE_MAPPED_BUFFERED_READER_H
+
+#include "buffered_reader_interface.h"
+
+#include <stdint.h>
+
+struct core_buffered_reader;
+
+/*
+ * A reader for uncompressed files that maps the file in memory.
+ *
+ * Lines are views in the mapping, so they are not copied unless
+ * core_buffered_reader_read_line is used. The kernel is told that the
+ * file is read sequentially, and the next window is prefetched as the
+ * reader moves forward.
+ */
+struct core_mapped_buffered_reader {
+    char *mapping;
+    uint64_t mapping_offset;
+    uint64_t mapping_size;
+
+    uint64_t file_size;
+    uint64_t offset;
+    uint64_t advised_offset;
+};
+
+extern struct core_buffered_reader_interface core_mapped_buffered_reader_implementation;
+
+#endif
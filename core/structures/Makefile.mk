@@ -12,6 +12,8 @@ CORE_OBJECTS += core/structures/fast_queue_iterator.o
 CORE_OBJECTS += core/structures/block_queue.o
 CORE_OBJECTS += core/structures/simple_queue.o
 CORE_OBJECTS += core/structures/free_list.o
+CORE_OBJECTS += core/structures/work_stealing_deque.o
+CORE_OBJECTS += core/structures/log_histogram.o
 
 # unordered structures
 CORE_OBJECTS += core/structures/hash_table_group.o
@@ -24,12 +26,14 @@ CORE_OBJECTS += core/structures/map.o
 CORE_OBJECTS += core/structures/map_iterator.o
 CORE_OBJECTS += core/structures/set.o
 CORE_OBJECTS += core/structures/set_iterator.o
+CORE_OBJECTS += core/structures/bloom_filter.o
 CORE_OBJECTS += core/structures/stack.o
 
 # ordered structures
 CORE_OBJECTS += core/structures/ordered/red_black_node.o
 CORE_OBJECTS += core/structures/ordered/red_black_tree.o
 CORE_OBJECTS += core/structures/ordered/red_black_tree_iterator.o
+CORE_OBJECTS += core/structures/ordered/timing_wheel.o
 
 CORE_OBJECTS += core/structures/unordered/binary_heap_array.o
 
@@ -0,0 +1,253 @@
+
+#include "bloom_filter.h"
+
+#include <core/hash/hash.h>
+
+#include <core/system/memory_pool.h>
+#include <core/system/debugger.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+#define CORE_BLOOM_FILTER_BLOCK_BITS 512
+#define CORE_BLOOM_FILTER_BLOCK_WORDS (CORE_BLOOM_FILTER_BLOCK_BITS / 64)
+#define CORE_BLOOM_FILTER_MAXIMUM_HASH_COUNT 16
+#define CORE_BLOOM_FILTER_SEED 0x5bd1e995
+#define CORE_BLOOM_FILTER_GROWTH_FACTOR 4
+
+static void core_bloom_filter_add_generation(struct core_bloom_filter *self);
+static inline uint64_t core_bloom_filter_mix(uint64_t value);
+static inline uint64_t *core_bloom_filter_get_block(struct core_bloom_filter *self,
+                int generation, uint64_t hash);
+static inline int core_bloom_filter_find_in_generation(struct core_bloom_filter *self,
+                int generation, uint64_t hash);
+
+void core_bloom_filter_init(struct core_bloom_filter *self, int key_size, int bits_per_key,
+                uint64_t capacity, struct core_memory_pool *memory)
+{
+    CORE_DEBUGGER_ASSERT(key_size > 0);
+    CORE_DEBUGGER_ASSERT(bits_per_key > 0);
+
+    self->key_size = key_size;
+    self->bits_per_key = bits_per_key;
+    self->memory = memory;
+
+    if (capacity < 1) {
+        capacity = 1;
+    }
+
+    self->generations = 0;
+    self->size = 0;
+    self->generation_size = 0;
+    self->capacities[0] = capacity;
+
+    core_bloom_filter_add_generation(self);
+}
+
+void core_bloom_filter_destroy(struct core_bloom_filter *self)
+{
+    int i;
+
+    for (i = 0; i < self->generations; ++i) {
+        core_memory_pool_free(self->memory, self->blocks[i]);
+        self->blocks[i] = NULL;
+    }
+
+    self->generations = 0;
+    self->size = 0;
+    self->generation_size = 0;
+}
+
+static void core_bloom_filter_add_generation(struct core_bloom_filter *self)
+{
+    uint64_t capacity;
+    uint64_t block_count;
+    size_t bytes;
+    int generation;
+    int bits_per_key;
+    int hash_count;
+
+    generation = self->generations;
+
+    CORE_DEBUGGER_ASSERT(generation < CORE_BLOOM_FILTER_MAXIMUM_GENERATIONS);
+
+    capacity = self->capacities[0];
+
+    if (generation > 0) {
+        capacity = self->capacities[generation - 1] * CORE_BLOOM_FILTER_GROWTH_FACTOR;
+    }
+
+    bits_per_key = self->bits_per_key + generation;
+
+    /*
+     * The best number of hash functions is ln(2) * bits per key.
+     */
+    hash_count = (int)(bits_per_key * 0.693 + 0.5);
+
+    if (hash_count < 1) {
+        hash_count = 1;
+    } else if (hash_count > CORE_BLOOM_FILTER_MAXIMUM_HASH_COUNT) {
+        hash_count = CORE_BLOOM_FILTER_MAXIMUM_HASH_COUNT;
+    }
+
+    block_count = (capacity * bits_per_key + CORE_BLOOM_FILTER_BLOCK_BITS - 1)
+            / CORE_BLOOM_FILTER_BLOCK_BITS;
+
+    bytes = block_count * CORE_BLOOM_FILTER_BLOCK_WORDS * sizeof(uint64_t);
+
+    self->capacities[generation] = capacity;
+    self->hash_counts[generation] = hash_count;
+    self->block_counts[generation] = block_count;
+    self->blocks[generation] = core_memory_pool_allocate(self->memory, bytes);
+    memset(self->blocks[generation], 0, bytes);
+
+    self->generation_size = 0;
+    ++self->generations;
+}
+
+/*
+ * The 64-bit finalizer of MurmurHash3.
+ */
+static inline uint64_t core_bloom_filter_mix(uint64_t value)
+{
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdULL;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53ULL;
+    value ^= value >> 33;
+
+    return value;
+}
+
+/*
+ * Each generation uses a different block for the same key.
+ */
+static inline uint64_t *core_bloom_filter_get_block(struct core_bloom_filter *self,
+                int generation, uint64_t hash)
+{
+    uint64_t index;
+
+    index = core_bloom_filter_mix(hash + generation * 0x9e3779b97f4a7c15ULL)
+            % self->block_counts[generation];
+
+    return self->blocks[generation] + index * CORE_BLOOM_FILTER_BLOCK_WORDS;
+}
+
+/*
+ * The bits in the block are picked with double hashing.
+ */
+static inline int core_bloom_filter_find_in_generation(struct core_bloom_filter *self,
+                int generation, uint64_t hash)
+{
+    uint64_t *block;
+    uint32_t position;
+    uint32_t step;
+    int i;
+
+    block = core_bloom_filter_get_block(self, generation, hash);
+    position = (uint32_t)hash;
+    step = (uint32_t)(hash >> 32) | 1;
+
+    for (i = 0; i < self->hash_counts[generation]; ++i) {
+
+        if (!(block[(position % CORE_BLOOM_FILTER_BLOCK_BITS) / 64]
+                                & ((uint64_t)1 << (position % 64)))) {
+            return 0;
+        }
+
+        position += step;
+    }
+
+    return 1;
+}
+
+int core_bloom_filter_find(struct core_bloom_filter *self, void *key)
+{
+    uint64_t hash;
+    int i;
+
+    hash = core_hash_data_uint64_t(key, self->key_size, CORE_BLOOM_FILTER_SEED);
+
+    for (i = self->generations - 1; i >= 0; --i) {
+        if (core_bloom_filter_find_in_generation(self, i, hash)) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+int core_bloom_filter_add(struct core_bloom_filter *self, void *key)
+{
+    uint64_t hash;
+    uint64_t *block;
+    uint32_t position;
+    uint32_t step;
+    int generation;
+    int i;
+
+    hash = core_hash_data_uint64_t(key, self->key_size, CORE_BLOOM_FILTER_SEED);
+
+    for (i = self->generations - 1; i >= 0; --i) {
+        if (core_bloom_filter_find_in_generation(self, i, hash)) {
+            return 1;
+        }
+    }
+
+    /*
+     * The last generation keeps receiving keys if there is
+     * no room for another one.
+     */
+    if (self->generation_size >= self->capacities[self->generations - 1]
+                    && self->generations < CORE_BLOOM_FILTER_MAXIMUM_GENERATIONS) {
+        core_bloom_filter_add_generation(self);
+    }
+
+    generation = self->generations - 1;
+    block = core_bloom_filter_get_block(self, generation, hash);
+    position = (uint32_t)hash;
+    step = (uint32_t)(hash >> 32) | 1;
+
+    for (i = 0; i < self->hash_counts[generation]; ++i) {
+        block[(position % CORE_BLOOM_FILTER_BLOCK_BITS) / 64] |= (uint64_t)1 << (position % 64);
+        position += step;
+    }
+
+    ++self->size;
+    ++self->generation_size;
+
+    return 0;
+}
+
+uint64_t core_bloom_filter_size(struct core_bloom_filter *self)
+{
+    return self->size;
+}
+
+uint64_t core_bloom_filter_memory_usage(struct core_bloom_filter *self)
+{
+    uint64_t bytes;
+    int i;
+
+    bytes = 0;
+
+    for (i = 0; i < self->generations; ++i) {
+        bytes += self->block_counts[i] * CORE_BLOOM_FILTER_BLOCK_WORDS * sizeof(uint64_t);
+    }
+
+    return bytes;
+}
+
+int core_bloom_filter_generations(struct core_bloom_filter *self)
+{
+    return self->generations;
+}
+
+void core_bloom_filter_print(struct core_bloom_filter *self)
+{
+    printf("core_bloom_filter: size %" PRIu64 " generations %d bits_per_key %d"
+                    " memory %" PRIu64 " bytes\n",
+                    self->size, self->generations, self->bits_per_key,
+                    core_bloom_filter_memory_usage(self));
+}
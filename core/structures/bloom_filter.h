@@ -0,0 +1,71 @@
+
+#ifndef CORE_BLOOM_FILTER_H
+#define CORE_BLOOM_FILTER_H
+
+#include <stdint.h>
+
+struct core_memory_pool;
+
+#define CORE_BLOOM_FILTER_MAXIMUM_GENERATIONS 32
+
+/*
+ * A blocked Bloom filter: all the bits of a key are in one
+ * block of 512 bits (a cache line).
+ *
+ * The memory is bounded by a budget in bits per key. When a filter
+ * has received as many keys as planned, a new filter (a generation)
+ * with 4 times the capacity is added, and the previous ones are only
+ * read. The false positive rate is the sum of the rates of the
+ * generations, so each generation uses one more bit per key than the
+ * previous one to keep that sum close to the rate of the first one.
+ *
+ * Keys can not be removed.
+ */
+struct core_bloom_filter {
+    uint64_t *blocks[CORE_BLOOM_FILTER_MAXIMUM_GENERATIONS];
+    uint64_t block_counts[CORE_BLOOM_FILTER_MAXIMUM_GENERATIONS];
+    uint64_t capacities[CORE_BLOOM_FILTER_MAXIMUM_GENERATIONS];
+    int hash_counts[CORE_BLOOM_FILTER_MAXIMUM_GENERATIONS];
+    int generations;
+
+    uint64_t size;
+    uint64_t generation_size;
+
+    int key_size;
+    int bits_per_key;
+
+    struct core_memory_pool *memory;
+};
+
+/*
+ * \param bits_per_key memory budget of the first generation (8 bits
+ * per key gives about 3% of false positives)
+ * \param capacity number of keys in the first generation
+ */
+void core_bloom_filter_init(struct core_bloom_filter *self, int key_size, int bits_per_key,
+                uint64_t capacity, struct core_memory_pool *memory);
+void core_bloom_filter_destroy(struct core_bloom_filter *self);
+
+/*
+ * \return 1 if the key was probably added before, 0 if it was not
+ */
+int core_bloom_filter_find(struct core_bloom_filter *self, void *key);
+
+/*
+ * Add a key.
+ *
+ * \return 1 if the key was probably added before (the filter is
+ * unchanged), 0 otherwise
+ */
+int core_bloom_filter_add(struct core_bloom_filter *self, void *key);
+
+/*
+ * \return the number of keys added
+ */
+uint64_t core_bloom_filter_size(struct core_bloom_filter *self);
+uint64_t core_bloom_filter_memory_usage(struct core_bloom_filter *self);
+int core_bloom_filter_generations(struct core_bloom_filter *self);
+
+void core_bloom_filter_print(struct core_bloom_filter *self);
+
+#endif
@@ -0,0 +1,162 @@
+
+#include "log_histogram.h"
+
+#include <core/system/debugger.h>
+
+#define SUB_BUCKET_MASK (CORE_LOG_HISTOGRAM_SUB_BUCKETS - 1)
+
+static int core_log_histogram_highest_bit(uint64_t value);
+
+void core_log_histogram_init(struct core_log_histogram *self)
+{
+    int i;
+
+    self->count = 0;
+    self->sum = 0;
+    self->maximum = 0;
+
+    for (i = 0; i < CORE_LOG_HISTOGRAM_BUCKETS; ++i) {
+        self->buckets[i] = 0;
+    }
+}
+
+void core_log_histogram_destroy(struct core_log_histogram *self)
+{
+    self->count = 0;
+    self->sum = 0;
+    self->maximum = 0;
+}
+
+void core_log_histogram_add(struct core_log_histogram *self, uint64_t value)
+{
+    ++self->buckets[core_log_histogram_get_bucket(value)];
+
+    ++self->count;
+    self->sum += value;
+
+    if (value > self->maximum)
+        self->maximum = value;
+}
+
+void core_log_histogram_merge(struct core_log_histogram *self, struct core_log_histogram *other)
+{
+    int i;
+
+    for (i = 0; i < CORE_LOG_HISTOGRAM_BUCKETS; ++i) {
+        self->buckets[i] += other->buckets[i];
+    }
+
+    self->count += other->count;
+    self->sum += other->sum;
+
+    if (other->maximum > self->maximum)
+        self->maximum = other->maximum;
+}
+
+uint64_t core_log_histogram_count(struct core_log_histogram *self)
+{
+    return self->count;
+}
+
+uint64_t core_log_histogram_sum(struct core_log_histogram *self)
+{
+    return self->sum;
+}
+
+uint64_t core_log_histogram_maximum(struct core_log_histogram *self)
+{
+    return self->maximum;
+}
+
+uint64_t core_log_histogram_get_percentile(struct core_log_histogram *self, double percentile)
+{
+    uint64_t target;
+    uint64_t total;
+    uint64_t value;
+    int i;
+
+    if (self->count == 0)
+        return 0;
+
+    target = (uint64_t)(percentile / 100 * self->count + 0.5);
+
+    if (target < 1)
+        target = 1;
+
+    if (target > self->count)
+        target = self->count;
+
+    total = 0;
+
+    for (i = 0; i < CORE_LOG_HISTOGRAM_BUCKETS; ++i) {
+        total += self->buckets[i];
+
+        if (total >= target)
+            break;
+    }
+
+    /*
+     * The buckets are read without the producer when profiles are merged,
+     * so the total can be behind the count.
+     */
+    if (i == CORE_LOG_HISTOGRAM_BUCKETS)
+        return self->maximum;
+
+    value = core_log_histogram_get_bucket_maximum(i);
+
+    if (value > self->maximum)
+        value = self->maximum;
+
+    return value;
+}
+
+int core_log_histogram_get_bucket(uint64_t value)
+{
+    int bit;
+    int shift;
+
+    if (value < CORE_LOG_HISTOGRAM_SUB_BUCKETS)
+        return value;
+
+    bit = core_log_histogram_highest_bit(value);
+
+    if (bit >= CORE_LOG_HISTOGRAM_MAXIMUM_BITS)
+        return CORE_LOG_HISTOGRAM_BUCKETS - 1;
+
+    shift = bit - CORE_LOG_HISTOGRAM_SUB_BUCKET_BITS;
+
+    return CORE_LOG_HISTOGRAM_SUB_BUCKETS * (shift + 1) + ((value >> shift) & SUB_BUCKET_MASK);
+}
+
+uint64_t core_log_histogram_get_bucket_maximum(int bucket)
+{
+    int shift;
+    uint64_t low;
+
+    CORE_DEBUGGER_ASSERT(bucket >= 0 && bucket < CORE_LOG_HISTOGRAM_BUCKETS);
+
+    if (bucket < CORE_LOG_HISTOGRAM_SUB_BUCKETS)
+        return bucket;
+
+    shift = bucket / CORE_LOG_HISTOGRAM_SUB_BUCKETS - 1;
+    low = ((uint64_t)(CORE_LOG_HISTOGRAM_SUB_BUCKETS + (bucket & SUB_BUCKET_MASK))) << shift;
+
+    return low + (((uint64_t)1) << shift) - 1;
+}
+
+static int core_log_histogram_highest_bit(uint64_t value)
+{
+#if defined(__GNUC__)
+    return 63 - __builtin_clzll(value);
+#else
+    int bit;
+
+    bit = 0;
+
+    while (value >>= 1) {
+        ++bit;
+    }
+
+    return bit;
+#endif
+}
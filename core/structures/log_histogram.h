@@ -0,0 +1,58 @@
+
+#ifndef CORE_LOG_HISTOGRAM_H
+#define CORE_LOG_HISTOGRAM_H
+
+#include <stdint.h>
+
+/*
+ * Each power of 2 is split in 2^CORE_LOG_HISTOGRAM_SUB_BUCKET_BITS
+ * buckets, so the relative error of a value is at most 12.5%.
+ * Values below 2^CORE_LOG_HISTOGRAM_SUB_BUCKET_BITS are exact.
+ * Values of 2^CORE_LOG_HISTOGRAM_MAXIMUM_BITS or more go in the
+ * last bucket.
+ */
+#define CORE_LOG_HISTOGRAM_SUB_BUCKET_BITS 3
+#define CORE_LOG_HISTOGRAM_SUB_BUCKETS (1 << CORE_LOG_HISTOGRAM_SUB_BUCKET_BITS)
+#define CORE_LOG_HISTOGRAM_MAXIMUM_BITS 40
+#define CORE_LOG_HISTOGRAM_BUCKETS \
+    (CORE_LOG_HISTOGRAM_SUB_BUCKETS * (CORE_LOG_HISTOGRAM_MAXIMUM_BITS - CORE_LOG_HISTOGRAM_SUB_BUCKET_BITS + 1))
+
+/*
+ * A histogram with log-spaced buckets (like HdrHistogram).
+ *
+ * The memory is fixed: adding a value increments one bucket.
+ * Percentiles are read from the buckets.
+ *
+ * \see http://hdrhistogram.org/
+ */
+struct core_log_histogram {
+    uint64_t count;
+    uint64_t sum;
+    uint64_t maximum;
+    uint64_t buckets[CORE_LOG_HISTOGRAM_BUCKETS];
+};
+
+void core_log_histogram_init(struct core_log_histogram *self);
+void core_log_histogram_destroy(struct core_log_histogram *self);
+
+void core_log_histogram_add(struct core_log_histogram *self, uint64_t value);
+
+/*
+ * Add the values of <other> to <self>.
+ */
+void core_log_histogram_merge(struct core_log_histogram *self, struct core_log_histogram *other);
+
+uint64_t core_log_histogram_count(struct core_log_histogram *self);
+uint64_t core_log_histogram_sum(struct core_log_histogram *self);
+uint64_t core_log_histogram_maximum(struct core_log_histogram *self);
+
+/*
+ * \return the highest value of the bucket that contains the percentile
+ * (0 to 100), or 0 if the histogram is empty
+ */
+uint64_t core_log_histogram_get_percentile(struct core_log_histogram *self, double percentile);
+
+int core_log_histogram_get_bucket(uint64_t value);
+uint64_t core_log_histogram_get_bucket_maximum(int bucket);
+
+#endif
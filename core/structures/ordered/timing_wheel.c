@@ -0,0 +1,255 @@
+
+#include "timing_wheel.h"
+
+#include <core/system/memory.h>
+#include <core/system/debugger.h>
+
+#define NO_ENTRY (-1)
+
+#define SLOT_MASK (CORE_TIMING_WHEEL_SLOTS - 1)
+
+struct core_timing_wheel_entry {
+    uint64_t key;
+    int next;
+};
+
+static struct core_timing_wheel_entry *core_timing_wheel_get_entry(struct core_timing_wheel *self,
+                int index);
+static void core_timing_wheel_insert(struct core_timing_wheel *self, int index);
+static void core_timing_wheel_cascade(struct core_timing_wheel *self, int level, int slot);
+static int core_timing_wheel_lowest_bit(uint64_t value);
+
+void core_timing_wheel_init(struct core_timing_wheel *self, int value_size,
+                uint64_t tick_duration, struct core_memory_pool *pool)
+{
+    int level;
+    int slot;
+
+    CORE_DEBUGGER_ASSERT(tick_duration > 0);
+
+    self->current_tick = 0;
+    self->tick_duration = tick_duration;
+
+    for (level = 0; level < CORE_TIMING_WHEEL_LEVELS; ++level) {
+        for (slot = 0; slot < CORE_TIMING_WHEEL_SLOTS; ++slot) {
+            self->heads[level][slot] = NO_ENTRY;
+        }
+
+        self->occupied_slots[level] = 0;
+    }
+
+    self->value_size = value_size;
+
+    core_vector_init(&self->entries, sizeof(struct core_timing_wheel_entry) + value_size);
+    core_vector_set_memory_pool(&self->entries, pool);
+
+    self->free_entry = NO_ENTRY;
+    self->size = 0;
+}
+
+void core_timing_wheel_destroy(struct core_timing_wheel *self)
+{
+    core_vector_destroy(&self->entries);
+
+    self->free_entry = NO_ENTRY;
+    self->size = 0;
+}
+
+void core_timing_wheel_add(struct core_timing_wheel *self, uint64_t key, void *value)
+{
+    int index;
+    struct core_timing_wheel_entry *entry;
+
+    /*
+     * Recycle a removed entry if possible.
+     */
+    if (self->free_entry != NO_ENTRY) {
+        index = self->free_entry;
+        entry = core_timing_wheel_get_entry(self, index);
+        self->free_entry = entry->next;
+    } else {
+        index = core_vector_size(&self->entries);
+        core_vector_resize(&self->entries, index + 1);
+        entry = core_timing_wheel_get_entry(self, index);
+    }
+
+    entry->key = key;
+    core_memory_copy(entry + 1, value, self->value_size);
+
+    core_timing_wheel_insert(self, index);
+
+    ++self->size;
+}
+
+int core_timing_wheel_pop(struct core_timing_wheel *self, uint64_t maximum_key,
+                uint64_t *key, void *value)
+{
+    uint64_t maximum_tick;
+    uint64_t next_tick;
+    uint64_t available_slots;
+    int index;
+    int slot;
+    int level;
+    int shift;
+    struct core_timing_wheel_entry *entry;
+
+    maximum_tick = maximum_key / self->tick_duration;
+
+    while (1) {
+
+        /*
+         * Nothing to cascade, jump directly.
+         */
+        if (self->size == 0) {
+            if (self->current_tick < maximum_tick)
+                self->current_tick = maximum_tick;
+            return 0;
+        }
+
+        slot = self->current_tick & SLOT_MASK;
+        index = self->heads[0][slot];
+
+        if (index != NO_ENTRY) {
+            if (self->current_tick > maximum_tick)
+                return 0;
+
+            entry = core_timing_wheel_get_entry(self, index);
+
+            self->heads[0][slot] = entry->next;
+            if (entry->next == NO_ENTRY)
+                self->occupied_slots[0] &= ~(((uint64_t)1) << slot);
+
+            *key = entry->key;
+            core_memory_copy(value, entry + 1, self->value_size);
+
+            entry->next = self->free_entry;
+            self->free_entry = index;
+            --self->size;
+
+            return 1;
+        }
+
+        /*
+         * Find the next occupied slot. The entries of a level have a digit
+         * higher than the digit of the current tick at that level, and lower
+         * levels are always visited first.
+         */
+        next_tick = 0;
+
+        for (level = 0; level < CORE_TIMING_WHEEL_LEVELS; ++level) {
+            shift = level * CORE_TIMING_WHEEL_SLOT_BITS;
+            slot = (self->current_tick >> shift) & SLOT_MASK;
+
+            if (slot == SLOT_MASK)
+                continue;
+
+            available_slots = self->occupied_slots[level] & (~((uint64_t)0) << (slot + 1));
+
+            if (available_slots == 0)
+                continue;
+
+            slot = core_timing_wheel_lowest_bit(available_slots);
+
+            if (shift + CORE_TIMING_WHEEL_SLOT_BITS < 64)
+                next_tick = (self->current_tick >> (shift + CORE_TIMING_WHEEL_SLOT_BITS))
+                        << (shift + CORE_TIMING_WHEEL_SLOT_BITS);
+
+            next_tick |= ((uint64_t)slot) << shift;
+            break;
+        }
+
+        CORE_DEBUGGER_ASSERT(level < CORE_TIMING_WHEEL_LEVELS);
+
+        if (level == CORE_TIMING_WHEEL_LEVELS || next_tick > maximum_tick)
+            return 0;
+
+        self->current_tick = next_tick;
+
+        if (level > 0)
+            core_timing_wheel_cascade(self, level, slot);
+    }
+
+    return 0;
+}
+
+int core_timing_wheel_size(struct core_timing_wheel *self)
+{
+    return self->size;
+}
+
+int core_timing_wheel_empty(struct core_timing_wheel *self)
+{
+    return self->size == 0;
+}
+
+static struct core_timing_wheel_entry *core_timing_wheel_get_entry(struct core_timing_wheel *self,
+                int index)
+{
+    return core_vector_at(&self->entries, index);
+}
+
+static void core_timing_wheel_insert(struct core_timing_wheel *self, int index)
+{
+    struct core_timing_wheel_entry *entry;
+    uint64_t tick;
+    uint64_t difference;
+    int level;
+    int slot;
+
+    entry = core_timing_wheel_get_entry(self, index);
+    tick = entry->key / self->tick_duration;
+
+    /*
+     * Entries in the past are due now.
+     */
+    if (tick < self->current_tick)
+        tick = self->current_tick;
+
+    difference = tick ^ self->current_tick;
+    level = 0;
+
+    while (difference >= CORE_TIMING_WHEEL_SLOTS) {
+        difference >>= CORE_TIMING_WHEEL_SLOT_BITS;
+        ++level;
+    }
+
+    slot = (tick >> (level * CORE_TIMING_WHEEL_SLOT_BITS)) & SLOT_MASK;
+
+    entry->next = self->heads[level][slot];
+    self->heads[level][slot] = index;
+    self->occupied_slots[level] |= ((uint64_t)1) << slot;
+}
+
+static void core_timing_wheel_cascade(struct core_timing_wheel *self, int level, int slot)
+{
+    int index;
+    int next;
+
+    index = self->heads[level][slot];
+    self->heads[level][slot] = NO_ENTRY;
+    self->occupied_slots[level] &= ~(((uint64_t)1) << slot);
+
+    while (index != NO_ENTRY) {
+        next = core_timing_wheel_get_entry(self, index)->next;
+        core_timing_wheel_insert(self, index);
+        index = next;
+    }
+}
+
+static int core_timing_wheel_lowest_bit(uint64_t value)
+{
+#if defined(__GNUC__)
+    return __builtin_ctzll(value);
+#else
+    int bit;
+
+    bit = 0;
+
+    while (!(value & 1)) {
+        value >>= 1;
+        ++bit;
+    }
+
+    return bit;
+#endif
+}
@@ -0,0 +1,67 @@
+
+#ifndef CORE_TIMING_WHEEL_H
+#define CORE_TIMING_WHEEL_H
+
+#include <core/structures/vector.h>
+
+#include <stdint.h>
+
+struct core_memory_pool;
+
+/*
+ * Each level has 64 slots. With 11 levels, all the 64-bit ticks
+ * can be stored without clamping.
+ */
+#define CORE_TIMING_WHEEL_SLOT_BITS 6
+#define CORE_TIMING_WHEEL_SLOTS (1 << CORE_TIMING_WHEEL_SLOT_BITS)
+#define CORE_TIMING_WHEEL_LEVELS 11
+
+/*
+ * A hierarchical timing wheel.
+ *
+ * Keys are times (for example in nanoseconds). They are rounded down
+ * to ticks of <tick_duration>. An entry is stored at the level of the
+ * most significant 6-bit digit in which its tick differs from the current
+ * tick, so adding an entry is O(1). When the current tick reaches the
+ * range of a slot of a higher level, the entries of this slot are moved
+ * to lower levels (cascading).
+ *
+ * A bitmap of the occupied slots is kept for each level so that
+ * idle periods are skipped without visiting empty slots.
+ *
+ * Entries with the same tick are not ordered by their keys.
+ *
+ * \see http://www.cs.columbia.edu/~nahum/w6998/papers/sosp87-timing-wheels.pdf
+ */
+struct core_timing_wheel {
+    uint64_t current_tick;
+    uint64_t tick_duration;
+
+    int heads[CORE_TIMING_WHEEL_LEVELS][CORE_TIMING_WHEEL_SLOTS];
+    uint64_t occupied_slots[CORE_TIMING_WHEEL_LEVELS];
+
+    struct core_vector entries;
+    int free_entry;
+    int value_size;
+    int size;
+};
+
+void core_timing_wheel_init(struct core_timing_wheel *self, int value_size,
+                uint64_t tick_duration, struct core_memory_pool *pool);
+void core_timing_wheel_destroy(struct core_timing_wheel *self);
+
+void core_timing_wheel_add(struct core_timing_wheel *self, uint64_t key, void *value);
+
+/*
+ * Remove an entry whose tick is not after the tick of <maximum_key>.
+ * The entries are removed in the order of their ticks.
+ *
+ * \return 1 if an entry was removed, 0 otherwise
+ */
+int core_timing_wheel_pop(struct core_timing_wheel *self, uint64_t maximum_key,
+                uint64_t *key, void *value);
+
+int core_timing_wheel_size(struct core_timing_wheel *self);
+int core_timing_wheel_empty(struct core_timing_wheel *self);
+
+#endif
@@ -13,6 +13,7 @@
 
 #define core_queue_enqueue          core_simple_queue_enqueue
 #define core_queue_dequeue          core_simple_queue_dequeue
+#define core_queue_peek             core_simple_queue_peek
 
 #define core_queue_set_memory_pool  core_simple_queue_set_memory_pool
 
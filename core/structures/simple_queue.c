@@ -113,6 +113,14 @@ int core_simple_queue_dequeue(struct core_simple_queue *self, void *data)
     return 1;
 }
 
+void *core_simple_queue_peek(struct core_simple_queue *self)
+{
+    if (!self->size_)
+        return NULL;
+
+    return self->head_->data_;
+}
+
 int core_simple_queue_empty(struct core_simple_queue *self)
 {
     return !self->size_;
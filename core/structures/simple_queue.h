@@ -33,6 +33,11 @@ void core_simple_queue_destroy(struct core_simple_queue *self);
 int core_simple_queue_enqueue(struct core_simple_queue *self, void *data);
 int core_simple_queue_dequeue(struct core_simple_queue *self, void *data);
 
+/*
+ * \return the first item, or NULL if the queue is empty
+ */
+void *core_simple_queue_peek(struct core_simple_queue *self);
+
 int core_simple_queue_empty(struct core_simple_queue *self);
 int core_simple_queue_full(struct core_simple_queue *self);
 int core_simple_queue_size(struct core_simple_queue *self);
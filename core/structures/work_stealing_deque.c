@@ -0,0 +1,147 @@
+
+#include "work_stealing_deque.h"
+
+#include <core/system/memory.h>
+#include <core/system/atomic.h>
+#include <core/system/debugger.h>
+
+#define MEMORY_WORK_STEALING_DEQUE 0x4bd3e2f1
+
+void core_work_stealing_deque_init(struct core_work_stealing_deque *self, int capacity)
+{
+    int power;
+
+    power = 1;
+
+    while (power < capacity) {
+        power *= 2;
+    }
+
+    self->capacity = power;
+    self->mask = power - 1;
+    self->top = 0;
+    self->bottom = 0;
+
+    self->cells = core_memory_allocate(power * sizeof(void *), MEMORY_WORK_STEALING_DEQUE);
+}
+
+void core_work_stealing_deque_destroy(struct core_work_stealing_deque *self)
+{
+    core_memory_free((void *)self->cells, MEMORY_WORK_STEALING_DEQUE);
+
+    self->cells = NULL;
+    self->capacity = 0;
+    self->mask = 0;
+    self->top = 0;
+    self->bottom = 0;
+}
+
+int core_work_stealing_deque_push(struct core_work_stealing_deque *self, void *item)
+{
+    int64_t bottom;
+    int64_t top;
+
+    bottom = self->bottom;
+    top = self->top;
+
+    if (bottom - top >= self->capacity) {
+        return 0;
+    }
+
+    self->cells[bottom & self->mask] = item;
+
+    /*
+     * The item must be visible before the new bottom.
+     */
+    core_memory_fence();
+
+    self->bottom = bottom + 1;
+
+    return 1;
+}
+
+int core_work_stealing_deque_pop(struct core_work_stealing_deque *self, void **item)
+{
+    int64_t bottom;
+    int64_t top;
+    int value;
+
+    bottom = self->bottom - 1;
+    self->bottom = bottom;
+
+    /*
+     * Thieves must see the new bottom before the top is read.
+     */
+    core_memory_fence();
+
+    top = self->top;
+
+    if (top > bottom) {
+        self->bottom = bottom + 1;
+        return 0;
+    }
+
+    *item = self->cells[bottom & self->mask];
+    value = 1;
+
+    /*
+     * This is the last item: race with thieves for it.
+     */
+    if (top == bottom) {
+        if (!core_atomic_compare_and_swap_int(&self->top, top, top + 1)) {
+            value = 0;
+        }
+
+        self->bottom = bottom + 1;
+    }
+
+    return value;
+}
+
+int core_work_stealing_deque_steal(struct core_work_stealing_deque *self, void **item)
+{
+    int64_t bottom;
+    int64_t top;
+    void *value;
+
+    top = self->top;
+
+    core_memory_fence();
+
+    bottom = self->bottom;
+
+    if (top >= bottom) {
+        return 0;
+    }
+
+    value = self->cells[top & self->mask];
+
+    /*
+     * Another thief or the owner took it first.
+     */
+    if (!core_atomic_compare_and_swap_int(&self->top, top, top + 1)) {
+        return 0;
+    }
+
+    *item = value;
+
+    return 1;
+}
+
+int core_work_stealing_deque_size(struct core_work_stealing_deque *self)
+{
+    int64_t size;
+
+    size = self->bottom - self->top;
+
+    if (size < 0) {
+        size = 0;
+    }
+
+    return size;
+}
+
+int core_work_stealing_deque_capacity(struct core_work_stealing_deque *self)
+{
+    return self->capacity;
+}
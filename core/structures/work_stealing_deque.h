@@ -0,0 +1,45 @@
+
+#ifndef CORE_WORK_STEALING_DEQUE_H
+#define CORE_WORK_STEALING_DEQUE_H
+
+#include <stdint.h>
+
+/*
+ * A Chase-Lev work-stealing deque of pointers.
+ *
+ * The thread that owns the deque pushes and pops at the bottom (LIFO).
+ * Any other thread can steal at the top (FIFO). The owner can also
+ * steal from its own deque.
+ *
+ * The capacity is fixed, so cells are never reallocated while a thief
+ * reads them. core_work_stealing_deque_push returns 0 when the deque
+ * is full.
+ *
+ * \see http://dl.acm.org/citation.cfm?id=1073974
+ * \see http://www.di.ens.fr/~zappa/readings/ppopp13.pdf
+ */
+struct core_work_stealing_deque {
+    void * volatile *cells;
+    volatile int64_t top;
+    volatile int64_t bottom;
+    int64_t mask;
+    int capacity;
+};
+
+void core_work_stealing_deque_init(struct core_work_stealing_deque *self, int capacity);
+void core_work_stealing_deque_destroy(struct core_work_stealing_deque *self);
+
+/*
+ * Owner only.
+ */
+int core_work_stealing_deque_push(struct core_work_stealing_deque *self, void *item);
+int core_work_stealing_deque_pop(struct core_work_stealing_deque *self, void **item);
+
+/*
+ * Any thread.
+ */
+int core_work_stealing_deque_steal(struct core_work_stealing_deque *self, void **item);
+int core_work_stealing_deque_size(struct core_work_stealing_deque *self);
+int core_work_stealing_deque_capacity(struct core_work_stealing_deque *self);
+
+#endif
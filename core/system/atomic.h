@@ -46,6 +46,9 @@
 #define core_atomic_compare_and_swap_int(pointer, old_value, new_value) \
         __sync_bool_compare_and_swap(pointer, old_value, new_value)
 
+#define core_atomic_compare_and_swap_pointer(pointer, old_value, new_value) \
+        __sync_bool_compare_and_swap(pointer, old_value, new_value)
+
 /* \see http://docs.cray.com/cgi-bin/craydoc.cgi?mode=View;id=S-2179-74 */
 #elif defined(_CRAYC)
 
@@ -61,6 +64,9 @@
 #define core_atomic_compare_and_swap_int(pointer, old_value, new_value) \
         __sync_bool_compare_and_swap(pointer, old_value, new_value)
 
+#define core_atomic_compare_and_swap_pointer(pointer, old_value, new_value) \
+        __sync_bool_compare_and_swap(pointer, old_value, new_value)
+
 /* Intel compiler
  * \see https://software.intel.com/en-us/forums/topic/281802
  * \see https://www.cs.fsu.edu/~engelen/courses/HPC-adv/intref_cls.pdf
@@ -83,6 +89,9 @@
 #define core_atomic_compare_and_swap_int(pointer, old_value, new_value) \
         __sync_bool_compare_and_swap(pointer, old_value, new_value)
 
+#define core_atomic_compare_and_swap_pointer(pointer, old_value, new_value) \
+        __sync_bool_compare_and_swap(pointer, old_value, new_value)
+
 #else
 
 /* no atomic built in is available
@@ -35,6 +35,22 @@
 #include <malloc.h> /* for mallopt */
 #endif
 
+/*
+ * Pages and NUMA policies are only handled on Linux. The system calls
+ * are used directly so that libnuma is not needed.
+ */
+#if defined(__linux__) && !defined(__bgq__)
+#define CORE_MEMORY_USE_MMAP
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <dirent.h>
+#include <stdlib.h>
+
+#define CORE_MEMORY_MPOL_PREFERRED 1
+#define CORE_MEMORY_MPOL_F_NODE (1 << 0)
+#define CORE_MEMORY_MPOL_F_ADDR (1 << 1)
+#endif
+
 #define FAST_MEMORY
 
 /*
@@ -43,6 +59,8 @@
 void *wrapper_malloc(size_t size);
 void wrapper_free(void *pointer);
 
+static size_t core_memory_get_mapped_length(size_t size, int flags);
+
 void *core_memory_allocate_private(size_t size, const char *function, const char *file, int line, int key)
 {
     void *pointer;
@@ -667,3 +685,165 @@ int core_memory_compare(void *value1, const void *value2, size_t count)
 
     return memcmp(value1, value2, count);
 }
+
+static size_t core_memory_get_mapped_length(size_t size, int flags)
+{
+    size_t page_size;
+
+    page_size = sysconf(_SC_PAGESIZE);
+
+    if (flags & CORE_MEMORY_MAP_HUGE_PAGES) {
+        page_size = CORE_MEMORY_HUGE_PAGE_SIZE;
+    }
+
+    return (size + page_size - 1) / page_size * page_size;
+}
+
+void *core_memory_map_pages(size_t size, int flags, int numa_node)
+{
+#ifdef CORE_MEMORY_USE_MMAP
+    void *pointer;
+    char *base;
+    char *aligned;
+    size_t length;
+    size_t head;
+    unsigned long node_mask;
+
+    length = core_memory_get_mapped_length(size, flags);
+    pointer = MAP_FAILED;
+
+    if (flags & CORE_MEMORY_MAP_HUGE_PAGES) {
+
+#ifdef MAP_HUGETLB
+        pointer = mmap(NULL, length, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+#endif
+
+        /*
+         * There are no reserved huge pages, so ask for transparent
+         * huge pages on a range aligned on the huge page size.
+         */
+        if (pointer == MAP_FAILED) {
+            base = mmap(NULL, length + CORE_MEMORY_HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+            if (base == MAP_FAILED) {
+                return NULL;
+            }
+
+            aligned = (char *)(((uintptr_t)base + CORE_MEMORY_HUGE_PAGE_SIZE - 1)
+                            & ~((uintptr_t)CORE_MEMORY_HUGE_PAGE_SIZE - 1));
+            head = aligned - base;
+
+            if (head > 0) {
+                munmap(base, head);
+            }
+
+            if (CORE_MEMORY_HUGE_PAGE_SIZE - head > 0) {
+                munmap(aligned + length, CORE_MEMORY_HUGE_PAGE_SIZE - head);
+            }
+
+            pointer = aligned;
+
+#ifdef MADV_HUGEPAGE
+            madvise(pointer, length, MADV_HUGEPAGE);
+#endif
+        }
+    } else {
+        pointer = mmap(NULL, length, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+        if (pointer == MAP_FAILED) {
+            return NULL;
+        }
+    }
+
+    /*
+     * The policy must be set before the pages are touched.
+     * Errors are ignored: the pages are then placed by first touch.
+     */
+#ifdef SYS_mbind
+    if (flags & CORE_MEMORY_MAP_LOCAL_NODE) {
+        if (numa_node >= 0 && numa_node < (int)(sizeof(node_mask) * 8)) {
+            node_mask = 1UL << numa_node;
+            syscall(SYS_mbind, pointer, length, CORE_MEMORY_MPOL_PREFERRED,
+                            &node_mask, sizeof(node_mask) * 8, 0);
+        }
+    }
+#endif
+
+    return pointer;
+#else
+    return NULL;
+#endif
+}
+
+void core_memory_unmap_pages(void *pointer, size_t size, int flags)
+{
+#ifdef CORE_MEMORY_USE_MMAP
+    if (pointer == NULL) {
+        return;
+    }
+
+    munmap(pointer, core_memory_get_mapped_length(size, flags));
+#endif
+}
+
+int core_memory_get_numa_node(void *pointer)
+{
+#if defined(CORE_MEMORY_USE_MMAP) && defined(SYS_get_mempolicy)
+    int node;
+
+    node = CORE_MEMORY_NUMA_NODE_NONE;
+
+    if (syscall(SYS_get_mempolicy, &node, NULL, 0, pointer,
+                            CORE_MEMORY_MPOL_F_NODE | CORE_MEMORY_MPOL_F_ADDR) != 0) {
+        return CORE_MEMORY_NUMA_NODE_NONE;
+    }
+
+    return node;
+#else
+    return CORE_MEMORY_NUMA_NODE_NONE;
+#endif
+}
+
+int core_memory_get_processor_numa_node(int processor)
+{
+#ifdef CORE_MEMORY_USE_MMAP
+    char path[64];
+    DIR *directory;
+    struct dirent *entry;
+    int node;
+
+    if (processor < 0) {
+        return CORE_MEMORY_NUMA_NODE_NONE;
+    }
+
+    /*
+     * The directory of a processor has a link nodeN to its NUMA node.
+     */
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d", processor);
+
+    directory = opendir(path);
+
+    if (directory == NULL) {
+        return CORE_MEMORY_NUMA_NODE_NONE;
+    }
+
+    node = CORE_MEMORY_NUMA_NODE_NONE;
+
+    while ((entry = readdir(directory)) != NULL) {
+        if (strncmp(entry->d_name, "node", 4) == 0
+                        && entry->d_name[4] >= '0' && entry->d_name[4] <= '9') {
+            node = atoi(entry->d_name + 4);
+            break;
+        }
+    }
+
+    closedir(directory);
+
+    return node;
+#else
+    return CORE_MEMORY_NUMA_NODE_NONE;
+#endif
+}
@@ -194,4 +194,41 @@ int core_memory_compare(void *value1, const void *value2, size_t count);
 void *core_memory_move(void *destination, const void *source, size_t count);
 void core_memory_initialize_memory_subsystem();
 
+/*
+ * Flags for core_memory_map_pages.
+ */
+#define CORE_MEMORY_MAP_HUGE_PAGES      (1 << 0)
+#define CORE_MEMORY_MAP_LOCAL_NODE      (1 << 1)
+
+#define CORE_MEMORY_HUGE_PAGE_SIZE (2 * 1024 * 1024)
+#define CORE_MEMORY_NUMA_NODE_NONE -1
+
+/*
+ * Map anonymous pages directly from the operating system.
+ *
+ * With CORE_MEMORY_MAP_HUGE_PAGES, reserved 2 MiB huge pages are used
+ * if there are any. Otherwise the range is aligned on 2 MiB and
+ * transparent huge pages are requested with madvise.
+ *
+ * With CORE_MEMORY_MAP_LOCAL_NODE, the pages are bound to the NUMA
+ * node numa_node (with mbind). Without it, or if numa_node is
+ * CORE_MEMORY_NUMA_NODE_NONE, they are placed by the first thread
+ * touching them.
+ *
+ * \return NULL if pages can not be mapped on this system
+ */
+void *core_memory_map_pages(size_t size, int flags, int numa_node);
+void core_memory_unmap_pages(void *pointer, size_t size, int flags);
+
+/*
+ * \return the NUMA node of the page holding the address (the page is
+ * touched if needed), or CORE_MEMORY_NUMA_NODE_NONE
+ */
+int core_memory_get_numa_node(void *pointer);
+
+/*
+ * \return the NUMA node of a processor, or CORE_MEMORY_NUMA_NODE_NONE
+ */
+int core_memory_get_processor_numa_node(int processor);
+
 #endif
@@ -12,6 +12,11 @@ void core_memory_block_init(struct core_memory_block *self, int total_bytes, int
     self->memory = NULL;
     self->name = name;
 
+    self->map_flags = 0;
+    self->map_numa_node = CORE_MEMORY_NUMA_NODE_NONE;
+    self->mapped = 0;
+    self->numa_node = CORE_MEMORY_NUMA_NODE_NONE;
+
     core_memory_block_set_next(self, NULL);
 }
 
@@ -20,7 +25,11 @@ void core_memory_block_destroy(struct core_memory_block *self)
     self->total_bytes = 0;
     self->offset = 0;
 
-    if (self->memory != NULL) {
+    if (self->memory != NULL && self->mapped) {
+        core_memory_unmap_pages(self->memory, self->total_bytes, self->map_flags);
+        self->memory = NULL;
+
+    } else if (self->memory != NULL) {
         core_memory_free(self->memory, self->name);
         self->memory = NULL;
     }
@@ -33,7 +42,7 @@ void *core_memory_block_allocate(struct core_memory_block *self, int size)
     void *pointer;
 
     if (self->memory == NULL) {
-        self->memory = core_memory_allocate(self->total_bytes, self->name);
+        core_memory_block_allocate_memory(self);
     }
 
     if (self->offset + size > self->total_bytes) {
@@ -58,6 +67,58 @@ void core_memory_block_free_all(struct core_memory_block *self)
     self->offset = 0;
 }
 
+void core_memory_block_set_map_flags(struct core_memory_block *self, int flags,
+                int numa_node)
+{
+    self->map_flags = flags;
+    self->map_numa_node = numa_node;
+}
+
+void core_memory_block_allocate_memory(struct core_memory_block *self)
+{
+    if (self->memory != NULL) {
+        return;
+    }
+
+    if (self->map_flags) {
+        self->memory = core_memory_map_pages(self->total_bytes, self->map_flags,
+                        self->map_numa_node);
+
+        if (self->memory != NULL) {
+            self->mapped = 1;
+
+            /*
+             * Touch the first page so that it gets a node.
+             */
+            *(char *)self->memory = 0;
+            self->numa_node = core_memory_get_numa_node(self->memory);
+            return;
+        }
+    }
+
+    self->memory = core_memory_allocate(self->total_bytes, self->name);
+}
+
+int core_memory_block_numa_node(struct core_memory_block *self)
+{
+    return self->numa_node;
+}
+
+int core_memory_block_total_bytes(struct core_memory_block *self)
+{
+    return self->total_bytes;
+}
+
+int core_memory_block_offset(struct core_memory_block *self)
+{
+    return self->offset;
+}
+
+void core_memory_block_set_offset(struct core_memory_block *self, int offset)
+{
+    self->offset = offset;
+}
+
 struct core_memory_block *core_memory_block_next(struct core_memory_block *self)
 {
     return self->next;
@@ -11,6 +11,15 @@ struct core_memory_block {
     int offset;
     int name;
 
+    /*
+     * Flags and NUMA node for core_memory_map_pages, and the NUMA
+     * node of the memory once it is allocated.
+     */
+    int map_flags;
+    int map_numa_node;
+    int mapped;
+    int numa_node;
+
     struct core_memory_block *next;
 };
 
@@ -21,6 +30,23 @@ void *core_memory_block_allocate(struct core_memory_block *self, int size);
 void core_memory_block_free(struct core_memory_block *self, void *pointer);
 void core_memory_block_free_all(struct core_memory_block *self);
 
+int core_memory_block_offset(struct core_memory_block *self);
+void core_memory_block_set_offset(struct core_memory_block *self, int offset);
+
+/*
+ * Use pages from core_memory_map_pages for the memory of the block.
+ * This must be called before the first allocation.
+ */
+void core_memory_block_set_map_flags(struct core_memory_block *self, int flags,
+                int numa_node);
+
+/*
+ * Allocate the memory of the block if this is not done already.
+ */
+void core_memory_block_allocate_memory(struct core_memory_block *self);
+int core_memory_block_numa_node(struct core_memory_block *self);
+int core_memory_block_total_bytes(struct core_memory_block *self);
+
 struct core_memory_block *core_memory_block_next(struct core_memory_block *self);
 void core_memory_block_set_next(struct core_memory_block *self, struct core_memory_block *next);
 
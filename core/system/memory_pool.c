@@ -3,6 +3,7 @@
 
 #include <core/system/tracer.h>
 #include <core/system/debugger.h>
+#include <core/system/atomic.h>
 
 #include <core/helpers/bitmap.h>
 
@@ -12,6 +13,7 @@
 #include <core/structures/free_list.h>
 
 #include <stdio.h>
+#include <string.h>
 #include <inttypes.h>
 #include <stdint.h>
 
@@ -38,6 +40,10 @@
 #define FLAG_ALIGN                          CORE_BITMAP_MAKE_FLAG(3)
 #define FLAG_EPHEMERAL                      CORE_BITMAP_MAKE_FLAG(4)
 #define FLAG_ENABLE_TRACEPOINTS             CORE_BITMAP_MAKE_FLAG(5)
+#define FLAG_SLAB                           CORE_BITMAP_MAKE_FLAG(6)
+#define FLAG_ARENA                          CORE_BITMAP_MAKE_FLAG(7)
+#define FLAG_HUGE_PAGES                     CORE_BITMAP_MAKE_FLAG(8)
+#define FLAG_LOCAL_NUMA_NODE                CORE_BITMAP_MAKE_FLAG(9)
 
 #define OPERATION_ALLOCATE  0
 #define OPERATION_FREE      1
@@ -46,6 +52,29 @@
 
 #define MINIMUM_SIZE (sizeof(void *))
 
+/*
+ * The size class of buffers that do not fit in a block.
+ */
+#define SLAB_LARGE_CLASS ((size_t)-1)
+
+/*
+ * The header of large arena buffers. It is 16 bytes to keep
+ * the alignment of the memory system.
+ */
+#define ARENA_HEADER_SIZE 16
+
+/*
+ * The header of the buffers that do not fit in a block in slab mode.
+ * They are chained so that core_memory_pool_free_all can release them.
+ * The last field is the size class, like for the other slab buffers.
+ */
+struct core_memory_pool_large_slab {
+    struct core_memory_pool_large_slab *previous;
+    struct core_memory_pool_large_slab *next;
+    size_t size;
+    size_t size_class;
+};
+
 /*
  * Private
  */
@@ -63,6 +92,16 @@ size_t core_memory_pool_load_size(void *pointer);
 void *core_memory_pool_move_right(void *pointer);
 void *core_memory_pool_move_left(void *pointer);
 
+static int core_memory_pool_uses_slabs(struct core_memory_pool *self);
+static void *core_memory_pool_allocate_slab(struct core_memory_pool *self, size_t size);
+static void core_memory_pool_free_slab(struct core_memory_pool *self, void *pointer);
+static size_t core_memory_pool_get_slab_size(void *pointer);
+static void *core_memory_pool_take_remote_frees(struct core_memory_pool *self);
+static void *core_memory_pool_allocate_from_block(struct core_memory_pool *self, size_t size);
+static void core_memory_pool_free_arena_large_blocks(struct core_memory_pool *self, void *last);
+static int core_memory_pool_get_map_flags(struct core_memory_pool *self);
+static void core_memory_pool_print_numa_nodes(struct core_memory_pool *self);
+
 void core_memory_pool_init(struct core_memory_pool *self, int block_size, int name)
 {
     core_map_init(&self->recycle_bin, sizeof(size_t), sizeof(struct core_free_list));
@@ -94,6 +133,18 @@ void core_memory_pool_init(struct core_memory_pool *self, int block_size, int na
     CORE_BITMAP_CLEAR_FLAG(self->flags, FLAG_EPHEMERAL);
 
     CORE_BITMAP_CLEAR_FLAG(self->flags, FLAG_ENABLE_TRACEPOINTS);
+    CORE_BITMAP_CLEAR_FLAG(self->flags, FLAG_SLAB);
+
+    self->slab_free_lists = NULL;
+    self->remote_free_list = NULL;
+    self->slab_large_blocks = NULL;
+
+    self->arena_large_blocks = NULL;
+    self->arena_scope_count = 0;
+    self->arena_high_water_mark = 0;
+
+    self->numa_node = CORE_MEMORY_NUMA_NODE_NONE;
+    memset(self->numa_node_byte_counts, 0, sizeof(self->numa_node_byte_counts));
 
     self->profile_allocated_byte_count = 0;
     self->profile_freed_byte_count = 0;
@@ -109,6 +160,12 @@ void core_memory_pool_destroy(struct core_memory_pool *self)
     struct core_map_iterator iterator;
     struct core_memory_block *block;
 
+    /*
+     * Buffers freed by other threads are accounted for before
+     * looking for leaks.
+     */
+    core_memory_pool_collect_remote_frees(self);
+
     self->final = 1;
 
 #ifdef CORE_MEMORY_POOL_EXAMINE
@@ -170,6 +227,12 @@ void core_memory_pool_destroy(struct core_memory_pool *self)
     }
 
     core_set_destroy(&self->large_blocks);
+    core_memory_pool_free_arena_large_blocks(self, NULL);
+
+    if (self->slab_free_lists != NULL) {
+        core_memory_free(self->slab_free_lists, self->name);
+        self->slab_free_lists = NULL;
+    }
 }
 
 void *core_memory_pool_allocate(struct core_memory_pool *self, size_t size)
@@ -228,8 +291,10 @@ void *core_memory_pool_allocate(struct core_memory_pool *self, size_t size)
     /*
      * Normalize the length of the segment to be a power of 2
      * if the flag FLAG_ENABLE_SEGMENT_NORMALIZATION is set.
+     * In slab mode, the size classes already do this with less waste.
      */
-    if (CORE_BITMAP_GET_FLAG(self->flags, FLAG_ENABLE_SEGMENT_NORMALIZATION)) {
+    if (CORE_BITMAP_GET_FLAG(self->flags, FLAG_ENABLE_SEGMENT_NORMALIZATION)
+                    && !CORE_BITMAP_GET_FLAG(self->flags, FLAG_SLAB)) {
         normalize = 1;
     }
 
@@ -309,6 +374,16 @@ void *core_memory_pool_allocate(struct core_memory_pool *self, size_t size)
         core_exit_with_error();
     }
 
+    /*
+     * Slab buffers have their size class in front of them.
+     */
+    if (core_memory_pool_uses_slabs(self)) {
+        size = core_memory_pool_get_slab_size(pointer);
+        core_memory_pool_profile(self, OPERATION_ALLOCATE, size);
+
+        return pointer;
+    }
+
 #ifdef CORE_MEMORY_USE_MAP_FOR_TRACKING
     if (CORE_BITMAP_GET_FLAG(self->flags, FLAG_ENABLE_TRACKING)) {
 
@@ -355,6 +430,10 @@ void *core_memory_pool_allocate_private(struct core_memory_pool *self, size_t si
         return core_memory_allocate(size, self->name);
     }
 
+    if (CORE_BITMAP_GET_FLAG(self->flags, FLAG_SLAB)) {
+        return core_memory_pool_allocate_slab(self, size);
+    }
+
     /*
      * First, check if the size is larger than the maximum size.
      * If memory blocks can not fulfil the need, use the memory system
@@ -362,6 +441,15 @@ void *core_memory_pool_allocate_private(struct core_memory_pool *self, size_t si
      */
 
     if (size >= self->block_size) {
+
+        if (CORE_BITMAP_GET_FLAG(self->flags, FLAG_ARENA)) {
+            pointer = core_memory_allocate(size + ARENA_HEADER_SIZE, self->name);
+            *(void **)pointer = self->arena_large_blocks;
+            self->arena_large_blocks = pointer;
+
+            return (char *)pointer + ARENA_HEADER_SIZE;
+        }
+
         pointer = core_memory_allocate(size, self->name);
 
         core_set_add(&self->large_blocks, &pointer);
@@ -407,15 +495,32 @@ void *core_memory_pool_allocate_private(struct core_memory_pool *self, size_t si
         return pointer;
     }
 
+    pointer = core_memory_pool_allocate_from_block(self, size + metadata);
+
+    /*
+     * Store size.
+     */
+    if (metadata) {
+        pointer = core_memory_pool_move_right(pointer);
+        core_memory_pool_store_size(pointer, size);
+    }
+
+    return pointer;
+}
+
+static void *core_memory_pool_allocate_from_block(struct core_memory_pool *self, size_t size)
+{
+    void *pointer;
+
     if (self->current_block == NULL) {
 
         core_memory_pool_add_block(self);
     }
 
-    pointer = core_memory_block_allocate(self->current_block, size + metadata);
+    pointer = core_memory_block_allocate(self->current_block, size);
 
     if (CORE_BITMAP_GET_FLAG(self->flags, FLAG_ENABLE_TRACEPOINTS))
-        printf("TRACEPOINT_EVENT memory_block:allocate size %zu\n", size + metadata);
+        printf("TRACEPOINT_EVENT memory_block:allocate size %zu\n", size);
 
     /* the current block is exausted...
      */
@@ -425,10 +530,10 @@ void *core_memory_pool_allocate_private(struct core_memory_pool *self, size_t si
 
         core_memory_pool_add_block(self);
 
-        pointer = core_memory_block_allocate(self->current_block, size + metadata);
+        pointer = core_memory_block_allocate(self->current_block, size);
 
         if (CORE_BITMAP_GET_FLAG(self->flags, FLAG_ENABLE_TRACEPOINTS))
-            printf("TRACEPOINT_EVENT memory_block:allocate size %zu\n", size + metadata);
+            printf("TRACEPOINT_EVENT memory_block:allocate size %zu\n", size);
 
 #ifdef DEBUG_MEMORY_POOL_ALLOCATE
         printf("DEBUG pool_allocate_private from block size %zu pointer %p\n",
@@ -436,19 +541,14 @@ void *core_memory_pool_allocate_private(struct core_memory_pool *self, size_t si
 #endif
     }
 
-    /*
-     * Store size.
-     */
-    if (metadata) {
-        pointer = core_memory_pool_move_right(pointer);
-        core_memory_pool_store_size(pointer, size);
-    }
-
     return pointer;
 }
 
 void core_memory_pool_add_block(struct core_memory_pool *self)
 {
+    int map_flags;
+    int node;
+
     /* Try to pick a block in the ready block list.
      * Otherwise, create one on-demand today.
      */
@@ -456,6 +556,25 @@ void core_memory_pool_add_block(struct core_memory_pool *self)
         self->current_block = core_memory_allocate(sizeof(struct core_memory_block), self->name);
         core_memory_block_init(self->current_block, self->block_size,
                         self->name);
+
+        map_flags = core_memory_pool_get_map_flags(self);
+
+        /*
+         * The memory is mapped now so that its node is known.
+         */
+        if (map_flags) {
+            core_memory_block_set_map_flags(self->current_block, map_flags,
+                            self->numa_node);
+            core_memory_block_allocate_memory(self->current_block);
+
+            node = core_memory_block_numa_node(self->current_block);
+
+            if (node < 0 || node >= CORE_MEMORY_POOL_NUMA_NODE_COUNT) {
+                node = CORE_MEMORY_POOL_NUMA_NODE_COUNT;
+            }
+
+            self->numa_node_byte_counts[node] += self->block_size;
+        }
     }
 }
 
@@ -480,6 +599,17 @@ int core_memory_pool_free(struct core_memory_pool *self, void *pointer)
     printf("pool_free self= %p name= %d pointer= %p\n", (void *)self, self->name, pointer);
 #endif
 
+    /*
+     * There is no lookup in slab mode.
+     */
+    if (core_memory_pool_uses_slabs(self)) {
+        size = core_memory_pool_get_slab_size(pointer);
+        core_memory_pool_free_slab(self, pointer);
+        core_memory_pool_profile(self, OPERATION_FREE, size);
+
+        return 1;
+    }
+
     size = 0;
     value = 0;
 
@@ -597,6 +727,18 @@ void core_memory_pool_free_private(struct core_memory_pool *self, void *pointer)
         return;
     }
 
+    if (CORE_BITMAP_GET_FLAG(self->flags, FLAG_SLAB)) {
+        core_memory_pool_free_slab(self, pointer);
+        return;
+    }
+
+    /*
+     * Arena memory is released with scopes.
+     */
+    if (CORE_BITMAP_GET_FLAG(self->flags, FLAG_ARENA)) {
+        return;
+    }
+
     /* Verify if the pointer is a large block not managed by one of the memory
      * blocks
      */
@@ -697,6 +839,7 @@ void core_memory_pool_enable_tracking(struct core_memory_pool *self)
 void core_memory_pool_free_all(struct core_memory_pool *self)
 {
     struct core_memory_block *block;
+    struct core_memory_pool_large_slab *large_block;
     int i;
     int size;
 
@@ -747,9 +890,28 @@ void core_memory_pool_free_all(struct core_memory_pool *self)
         core_map_clear(&self->recycle_bin);
     }
 
+    if (CORE_BITMAP_GET_FLAG(self->flags, FLAG_SLAB)) {
+
+        /*
+         * The buffers given back by other threads are in the blocks or
+         * in the large buffers, which are all released here.
+         */
+        core_memory_pool_take_remote_frees(self);
+
+        while (self->slab_large_blocks != NULL) {
+            large_block = self->slab_large_blocks;
+            self->slab_large_blocks = large_block->next;
+            core_memory_free(large_block, self->name);
+        }
+
+        memset(self->slab_free_lists, 0, CORE_MEMORY_POOL_SLAB_CLASS_COUNT * sizeof(void *));
+    }
+
     if (!CORE_BITMAP_GET_FLAG(self->flags, FLAG_DISABLED)) {
         core_set_clear(&self->large_blocks);
     }
+
+    core_memory_pool_free_arena_large_blocks(self, NULL);
 }
 
 void core_memory_pool_disable(struct core_memory_pool *self)
@@ -778,6 +940,8 @@ void core_memory_pool_print(struct core_memory_pool *self)
                     (int)self->block_size,
                     block_count,
                     byte_count);
+
+    core_memory_pool_print_numa_nodes(self);
 }
 
 void core_memory_pool_enable_ephemeral_mode(struct core_memory_pool *self)
@@ -810,6 +974,13 @@ void core_memory_pool_examine(struct core_memory_pool *self)
                     self->profile_allocated_byte_count - self->profile_freed_byte_count,
                     self->profile_allocated_byte_count, self->profile_freed_byte_count);
 
+    core_memory_pool_print_numa_nodes(self);
+
+    if (CORE_BITMAP_GET_FLAG(self->flags, FLAG_ARENA)) {
+        printf("DEBUG_POOL Name= 0x%x ScopeCount= %" PRIu64 " ScopeHighWaterMark= %" PRIu64 " bytes\n",
+                        self->name, self->arena_scope_count, self->arena_high_water_mark);
+    }
+
 #if 0
     core_memory_pool_print(self);
 #endif
@@ -847,6 +1018,9 @@ int core_memory_pool_has_leaks(struct core_memory_pool *self)
     if (!core_set_empty(&self->large_blocks))
         return 1;
 
+    if (self->slab_large_blocks != NULL)
+        return 1;
+
 #ifdef CORE_MEMORY_USE_MAP_FOR_TRACKING
     if (!core_map_empty(&self->allocated_blocks))
         return 1;
@@ -976,3 +1150,378 @@ void core_memory_pool_enable_tracepoints(struct core_memory_pool *self)
     CORE_BITMAP_SET_FLAG(self->flags, FLAG_ENABLE_TRACEPOINTS);
 }
 
+
+void core_memory_pool_enable_slab_mode(struct core_memory_pool *self)
+{
+    CORE_DEBUGGER_ASSERT(self->profile_allocate_calls == 0);
+
+    if (self->slab_free_lists == NULL) {
+        self->slab_free_lists = core_memory_allocate(CORE_MEMORY_POOL_SLAB_CLASS_COUNT * sizeof(void *),
+                        self->name);
+        memset(self->slab_free_lists, 0, CORE_MEMORY_POOL_SLAB_CLASS_COUNT * sizeof(void *));
+    }
+
+    CORE_BITMAP_SET_FLAG(self->flags, FLAG_SLAB);
+}
+
+int core_memory_pool_get_size_class(size_t size)
+{
+    int power;
+    size_t value;
+
+    CORE_DEBUGGER_ASSERT(size > 0);
+
+    if (size <= 128) {
+        return (size + 15) / 16 - 1;
+    }
+
+    /*
+     * power is floor(log2(size - 1)), so that a size that is
+     * a power of 2 is the last class of the previous power.
+     */
+    value = (size - 1) >> 7;
+    power = 7;
+
+    while (value > 1) {
+        value >>= 1;
+        ++power;
+    }
+
+    return 8 + (power - 7) * 4 + (int)((size - 1 - ((size_t)1 << power)) >> (power - 2));
+}
+
+size_t core_memory_pool_get_class_size(int size_class)
+{
+    int power;
+    int step;
+
+    CORE_DEBUGGER_ASSERT(size_class >= 0);
+    CORE_DEBUGGER_ASSERT(size_class < CORE_MEMORY_POOL_SLAB_CLASS_COUNT);
+
+    if (size_class < 8) {
+        return (size_class + 1) * 16;
+    }
+
+    power = 7 + (size_class - 8) / 4;
+    step = (size_class - 8) % 4;
+
+    return ((size_t)1 << power) + (step + 1) * ((size_t)1 << (power - 2));
+}
+
+static int core_memory_pool_uses_slabs(struct core_memory_pool *self)
+{
+    return CORE_BITMAP_GET_FLAG(self->flags, FLAG_SLAB)
+            && !CORE_BITMAP_GET_FLAG(self->flags, FLAG_DISABLED);
+}
+
+static void *core_memory_pool_allocate_slab(struct core_memory_pool *self, size_t size)
+{
+    struct core_memory_pool_large_slab *large_block;
+    void *pointer;
+    int size_class;
+    size_t class_size;
+
+    size_class = -1;
+    class_size = 0;
+
+    if (size <= CORE_MEMORY_POOL_SLAB_MAXIMUM_SIZE) {
+        size_class = core_memory_pool_get_size_class(size);
+        class_size = core_memory_pool_get_class_size(size_class);
+    }
+
+    /*
+     * Buffers that do not fit in a block go to the memory system.
+     */
+    if (size_class < 0 || class_size + sizeof(size_t) > self->block_size) {
+        large_block = core_memory_allocate(sizeof(struct core_memory_pool_large_slab) + size,
+                        self->name);
+        large_block->previous = NULL;
+        large_block->next = self->slab_large_blocks;
+        large_block->size = size;
+        large_block->size_class = SLAB_LARGE_CLASS;
+
+        if (self->slab_large_blocks != NULL) {
+            self->slab_large_blocks->previous = large_block;
+        }
+
+        self->slab_large_blocks = large_block;
+
+        return large_block + 1;
+    }
+
+    pointer = self->slab_free_lists[size_class];
+
+    if (pointer == NULL && self->remote_free_list != NULL) {
+        core_memory_pool_collect_remote_frees(self);
+        pointer = self->slab_free_lists[size_class];
+    }
+
+    if (pointer != NULL) {
+        self->slab_free_lists[size_class] = *(void **)pointer;
+        return pointer;
+    }
+
+    pointer = core_memory_pool_allocate_from_block(self, class_size + sizeof(size_t));
+    pointer = core_memory_pool_move_right(pointer);
+    core_memory_pool_store_size(pointer, size_class);
+
+    return pointer;
+}
+
+static void core_memory_pool_free_slab(struct core_memory_pool *self, void *pointer)
+{
+    struct core_memory_pool_large_slab *large_block;
+    size_t size_class;
+
+    size_class = core_memory_pool_load_size(pointer);
+
+    if (size_class == SLAB_LARGE_CLASS) {
+        large_block = (struct core_memory_pool_large_slab *)pointer - 1;
+
+        if (large_block->previous != NULL) {
+            large_block->previous->next = large_block->next;
+        } else {
+            self->slab_large_blocks = large_block->next;
+        }
+
+        if (large_block->next != NULL) {
+            large_block->next->previous = large_block->previous;
+        }
+
+        core_memory_free(large_block, self->name);
+        return;
+    }
+
+    CORE_DEBUGGER_ASSERT(size_class < CORE_MEMORY_POOL_SLAB_CLASS_COUNT);
+
+    *(void **)pointer = self->slab_free_lists[size_class];
+    self->slab_free_lists[size_class] = pointer;
+}
+
+static size_t core_memory_pool_get_slab_size(void *pointer)
+{
+    size_t size_class;
+
+    size_class = core_memory_pool_load_size(pointer);
+
+    if (size_class == SLAB_LARGE_CLASS) {
+        return ((struct core_memory_pool_large_slab *)pointer - 1)->size;
+    }
+
+    return core_memory_pool_get_class_size(size_class);
+}
+
+int core_memory_pool_free_remote(struct core_memory_pool *self, void *pointer)
+{
+    void *head;
+
+    if (self == NULL
+                    || !CORE_BITMAP_GET_FLAG(self->flags, FLAG_SLAB)
+                    || CORE_BITMAP_GET_FLAG(self->flags, FLAG_DISABLED)) {
+        return 0;
+    }
+
+    /*
+     * Push on the Treiber stack. There is no ABA problem because
+     * only the owner pops, and it takes the whole stack at once.
+     */
+    do {
+        head = self->remote_free_list;
+        *(void **)pointer = head;
+    } while (!core_atomic_compare_and_swap_pointer(&self->remote_free_list, head, pointer));
+
+    return 1;
+}
+
+/*
+ * Take the whole stack of buffers freed by other threads.
+ */
+static void *core_memory_pool_take_remote_frees(struct core_memory_pool *self)
+{
+    void *list;
+
+    do {
+        list = self->remote_free_list;
+    } while (list != NULL
+                    && !core_atomic_compare_and_swap_pointer(&self->remote_free_list, list, NULL));
+
+    return list;
+}
+
+void core_memory_pool_collect_remote_frees(struct core_memory_pool *self)
+{
+    void *list;
+    void *next;
+
+    list = core_memory_pool_take_remote_frees(self);
+
+    while (list != NULL) {
+        next = *(void **)list;
+        core_memory_pool_free(self, list);
+        list = next;
+    }
+}
+
+void core_memory_pool_enable_arena_mode(struct core_memory_pool *self)
+{
+    CORE_DEBUGGER_ASSERT(!CORE_BITMAP_GET_FLAG(self->flags, FLAG_ENABLE_TRACKING));
+    CORE_DEBUGGER_ASSERT(!CORE_BITMAP_GET_FLAG(self->flags, FLAG_SLAB));
+    CORE_DEBUGGER_ASSERT(core_set_empty(&self->large_blocks));
+
+    CORE_BITMAP_SET_FLAG(self->flags, FLAG_ARENA);
+}
+
+void core_memory_pool_begin_scope(struct core_memory_pool *self, struct core_memory_pool_scope *scope)
+{
+    CORE_DEBUGGER_ASSERT(CORE_BITMAP_GET_FLAG(self->flags, FLAG_ARENA));
+
+    scope->block = self->current_block;
+    scope->offset = 0;
+
+    if (scope->block != NULL) {
+        scope->offset = core_memory_block_offset(scope->block);
+    }
+
+    scope->dried_block_count = core_queue_size(&self->dried_blocks);
+    scope->large_blocks = self->arena_large_blocks;
+    scope->allocated_byte_count = self->profile_allocated_byte_count;
+}
+
+void core_memory_pool_end_scope(struct core_memory_pool *self, struct core_memory_pool_scope *scope)
+{
+    struct core_memory_block *block;
+    uint64_t byte_count;
+    int size;
+    int i;
+
+    byte_count = self->profile_allocated_byte_count - scope->allocated_byte_count;
+
+    ++self->arena_scope_count;
+
+    if (byte_count > self->arena_high_water_mark) {
+        self->arena_high_water_mark = byte_count;
+    }
+
+    core_memory_pool_free_arena_large_blocks(self, scope->large_blocks);
+
+    /*
+     * The usual case: the scope fits in the current block.
+     */
+    if (self->current_block == scope->block) {
+        if (scope->block != NULL) {
+            core_memory_block_set_offset(scope->block, scope->offset);
+        }
+        return;
+    }
+
+    /*
+     * Otherwise, the blocks dried in the scope are the last ones in
+     * the queue. The first of them is the block of the mark.
+     */
+    if (self->current_block != NULL) {
+        core_memory_block_free_all(self->current_block);
+        core_queue_enqueue(&self->ready_blocks, &self->current_block);
+        self->current_block = NULL;
+    }
+
+    size = core_queue_size(&self->dried_blocks);
+
+    for (i = 0; i < size; ++i) {
+        core_queue_dequeue(&self->dried_blocks, &block);
+
+        if (i < scope->dried_block_count) {
+            core_queue_enqueue(&self->dried_blocks, &block);
+
+        } else if (block == scope->block) {
+            core_memory_block_set_offset(block, scope->offset);
+            self->current_block = block;
+
+        } else {
+            core_memory_block_free_all(block);
+            core_queue_enqueue(&self->ready_blocks, &block);
+        }
+    }
+}
+
+uint64_t core_memory_pool_scope_count(struct core_memory_pool *self)
+{
+    return self->arena_scope_count;
+}
+
+uint64_t core_memory_pool_scope_high_water_mark(struct core_memory_pool *self)
+{
+    return self->arena_high_water_mark;
+}
+
+static void core_memory_pool_free_arena_large_blocks(struct core_memory_pool *self, void *last)
+{
+    void *pointer;
+
+    while (self->arena_large_blocks != last) {
+        pointer = self->arena_large_blocks;
+        self->arena_large_blocks = *(void **)pointer;
+        core_memory_free(pointer, self->name);
+    }
+}
+
+void core_memory_pool_enable_huge_pages(struct core_memory_pool *self)
+{
+    CORE_BITMAP_SET_FLAG(self->flags, FLAG_HUGE_PAGES);
+}
+
+void core_memory_pool_set_numa_node(struct core_memory_pool *self, int numa_node)
+{
+    self->numa_node = numa_node;
+
+    if (numa_node == CORE_MEMORY_NUMA_NODE_NONE) {
+        CORE_BITMAP_CLEAR_FLAG(self->flags, FLAG_LOCAL_NUMA_NODE);
+    } else {
+        CORE_BITMAP_SET_FLAG(self->flags, FLAG_LOCAL_NUMA_NODE);
+    }
+}
+
+static int core_memory_pool_get_map_flags(struct core_memory_pool *self)
+{
+    int flags;
+
+    flags = 0;
+
+    if (CORE_BITMAP_GET_FLAG(self->flags, FLAG_HUGE_PAGES)) {
+        flags |= CORE_MEMORY_MAP_HUGE_PAGES;
+    }
+
+    if (CORE_BITMAP_GET_FLAG(self->flags, FLAG_LOCAL_NUMA_NODE)) {
+        flags |= CORE_MEMORY_MAP_LOCAL_NODE;
+    }
+
+    return flags;
+}
+
+uint64_t core_memory_pool_numa_node_byte_count(struct core_memory_pool *self, int node)
+{
+    if (node < 0 || node >= CORE_MEMORY_POOL_NUMA_NODE_COUNT) {
+        node = CORE_MEMORY_POOL_NUMA_NODE_COUNT;
+    }
+
+    return self->numa_node_byte_counts[node];
+}
+
+static void core_memory_pool_print_numa_nodes(struct core_memory_pool *self)
+{
+    int node;
+
+    if (!core_memory_pool_get_map_flags(self)) {
+        return;
+    }
+
+    printf("PRINT POOL Name= 0x%x NUMA", self->name);
+
+    for (node = 0; node < CORE_MEMORY_POOL_NUMA_NODE_COUNT; ++node) {
+        if (self->numa_node_byte_counts[node] > 0) {
+            printf(" Node%d= %" PRIu64, node, self->numa_node_byte_counts[node]);
+        }
+    }
+
+    printf(" Unknown= %" PRIu64 " bytes\n",
+                    self->numa_node_byte_counts[CORE_MEMORY_POOL_NUMA_NODE_COUNT]);
+}
@@ -50,11 +50,37 @@
  */
 #define CORE_MEMORY_POOL_MESSAGE_BUFFER_BLOCK_SIZE (2 * 1024 * 1024)
 
+/*
+ * Size classes of the slab mode: 16-byte steps up to 128 bytes,
+ * and then 4 classes for each power of 2 up to 1 MiB.
+ */
+#define CORE_MEMORY_POOL_SLAB_CLASS_COUNT 60
+#define CORE_MEMORY_POOL_SLAB_MAXIMUM_SIZE (1024 * 1024)
+
+/*
+ * Blocks on other NUMA nodes are counted in the last bucket.
+ */
+#define CORE_MEMORY_POOL_NUMA_NODE_COUNT 8
+
+struct core_memory_pool_large_slab;
+
 struct core_memory_pool_state {
     int test_profile_allocate_calls;
     int test_profile_free_calls;
 };
 
+/*
+ * A mark in an arena. Everything allocated after the mark is released
+ * when the scope ends.
+ */
+struct core_memory_pool_scope {
+    struct core_memory_block *block;
+    int offset;
+    int dried_block_count;
+    void *large_blocks;
+    uint64_t allocated_byte_count;
+};
+
 /*
  * A memory pool for genomics.
  *
@@ -83,6 +109,26 @@ struct core_memory_pool {
     int profile_allocate_calls;
     int profile_free_calls;
 
+    /*
+     * Slab mode: one intrusive free list per size class, and a
+     * lock-free stack for buffers freed by other threads. Buffers
+     * that do not fit in a block are chained.
+     */
+    void **slab_free_lists;
+    void * volatile remote_free_list;
+    struct core_memory_pool_large_slab *slab_large_blocks;
+
+    /*
+     * Arena mode: buffers larger than a block are chained, and
+     * scopes record how many bytes they used.
+     */
+    void *arena_large_blocks;
+    uint64_t arena_scope_count;
+    uint64_t arena_high_water_mark;
+
+    int numa_node;
+    uint64_t numa_node_byte_counts[CORE_MEMORY_POOL_NUMA_NODE_COUNT + 1];
+
     int final;
 };
 
@@ -102,6 +148,65 @@ void core_memory_pool_disable_normalization(struct core_memory_pool *self);
 void core_memory_pool_enable_normalization(struct core_memory_pool *self);
 void core_memory_pool_enable_ephemeral_mode(struct core_memory_pool *self);
 
+/*
+ * Round sizes up to size classes and recycle buffers with one free
+ * list per class. This must be called before any allocation.
+ *
+ * The size class of a buffer is stored in front of it, so buffers are
+ * not tracked in a map in this mode.
+ */
+void core_memory_pool_enable_slab_mode(struct core_memory_pool *self);
+
+/*
+ * Give back a buffer from a thread that does not own the pool.
+ * The owner collects these buffers when a free list is empty.
+ *
+ * \return 1 if the buffer was taken, 0 if the pool is not in slab mode
+ */
+int core_memory_pool_free_remote(struct core_memory_pool *self, void *pointer);
+void core_memory_pool_collect_remote_frees(struct core_memory_pool *self);
+
+int core_memory_pool_get_size_class(size_t size);
+size_t core_memory_pool_get_class_size(int size_class);
+
+/*
+ * Turn an ephemeral pool without tracking into a bump-pointer arena.
+ * core_memory_pool_free() does not release anything in this mode: memory
+ * is released in O(1) by core_memory_pool_end_scope() or by
+ * core_memory_pool_free_all().
+ */
+void core_memory_pool_enable_arena_mode(struct core_memory_pool *self);
+
+/*
+ * Scopes can be nested, and they must end in the reverse order.
+ */
+void core_memory_pool_begin_scope(struct core_memory_pool *self, struct core_memory_pool_scope *scope);
+void core_memory_pool_end_scope(struct core_memory_pool *self, struct core_memory_pool_scope *scope);
+
+uint64_t core_memory_pool_scope_count(struct core_memory_pool *self);
+
+/*
+ * \return the largest number of bytes allocated in one scope
+ */
+uint64_t core_memory_pool_scope_high_water_mark(struct core_memory_pool *self);
+
+/*
+ * Map the blocks with core_memory_map_pages, using huge pages and/or
+ * binding them to a NUMA node. The node is given by the owner of the
+ * pool (for a worker, the node of its processor) since blocks can be
+ * created by another thread, like the node thread during the start.
+ * Nothing is bound for CORE_MEMORY_NUMA_NODE_NONE. The bytes of these
+ * blocks are counted for each NUMA node.
+ */
+void core_memory_pool_enable_huge_pages(struct core_memory_pool *self);
+void core_memory_pool_set_numa_node(struct core_memory_pool *self, int numa_node);
+
+/*
+ * \return the bytes of the mapped blocks on a NUMA node, or on an
+ * unknown node if node is CORE_MEMORY_NUMA_NODE_NONE
+ */
+uint64_t core_memory_pool_numa_node_byte_count(struct core_memory_pool *self, int node);
+
 void core_memory_pool_disable_alignment(struct core_memory_pool *self);
 void core_memory_pool_enable_alignment(struct core_memory_pool *self);
 void core_memory_pool_print(struct core_memory_pool *self);
@@ -15,6 +15,8 @@ THORIUM_OBJECTS += engine/thorium/dispatcher.o
 THORIUM_OBJECTS += engine/thorium/route.o
 THORIUM_OBJECTS += engine/thorium/worker_buffer.o
 THORIUM_OBJECTS += engine/thorium/actor_profiler.o
+THORIUM_OBJECTS += engine/thorium/actor_name_codec.o
+THORIUM_OBJECTS += engine/thorium/action_profiler.o
 
 # actor modules. These are mostly traits.
 THORIUM_OBJECTS += engine/thorium/modules/binomial_tree_message.o
@@ -35,6 +37,7 @@ include engine/thorium/transport/Makefile.mk
 
 THORIUM_OBJECTS += engine/thorium/cache/cache_tag.o
 THORIUM_OBJECTS += engine/thorium/cache/message_cache.o
+THORIUM_OBJECTS += engine/thorium/cache/node_message_cache.o
 THORIUM_OBJECTS += engine/thorium/cache/cache_actor_adapter.o
 
 THORIUM_OBJECTS += engine/thorium/topology/router.o
@@ -0,0 +1,227 @@
+
+#include "action_profiler.h"
+
+#include <core/structures/vector.h>
+
+#include <core/helpers/vector_helper.h>
+
+#include <core/system/memory.h>
+#include <core/system/debugger.h>
+
+#define MEMORY_ACTION_PROFILER 0x1c138681
+
+#define INDEX_MASK (THORIUM_ACTION_PROFILER_CAPACITY - 1)
+
+/*
+ * Keep some slots empty so that probing stays short.
+ */
+#define MAXIMUM_SIZE (THORIUM_ACTION_PROFILER_CAPACITY / 4 * 3)
+
+static struct thorium_action_profile *thorium_action_profiler_get(struct thorium_action_profiler *self,
+                int script, int action);
+static int thorium_action_profiler_compare(const void *a, const void *b);
+
+void thorium_action_profiler_init(struct thorium_action_profiler *self)
+{
+    self->enabled = 0;
+    self->size = 0;
+    self->lost_event_count = 0;
+    self->profiles = NULL;
+}
+
+void thorium_action_profiler_destroy(struct thorium_action_profiler *self)
+{
+    int i;
+
+    if (self->profiles != NULL) {
+        for (i = 0; i < THORIUM_ACTION_PROFILER_CAPACITY; ++i) {
+            if (self->profiles[i] != NULL)
+                core_memory_free(self->profiles[i], MEMORY_ACTION_PROFILER);
+        }
+
+        core_memory_free((void *)self->profiles, MEMORY_ACTION_PROFILER);
+        self->profiles = NULL;
+    }
+
+    self->enabled = 0;
+    self->size = 0;
+}
+
+/*
+ * This must be done before the worker starts.
+ */
+void thorium_action_profiler_enable(struct thorium_action_profiler *self)
+{
+    int i;
+
+    if (self->profiles == NULL) {
+        self->profiles = core_memory_allocate(THORIUM_ACTION_PROFILER_CAPACITY * sizeof(struct thorium_action_profile *),
+                        MEMORY_ACTION_PROFILER);
+
+        for (i = 0; i < THORIUM_ACTION_PROFILER_CAPACITY; ++i) {
+            self->profiles[i] = NULL;
+        }
+    }
+
+    self->enabled = 1;
+}
+
+int thorium_action_profiler_is_enabled(struct thorium_action_profiler *self)
+{
+    return self->enabled;
+}
+
+void thorium_action_profiler_add(struct thorium_action_profiler *self, int script, int action,
+                int count, uint64_t time)
+{
+    struct thorium_action_profile *profile;
+
+    profile = thorium_action_profiler_get(self, script, action);
+
+    if (profile == NULL) {
+        ++self->lost_event_count;
+        return;
+    }
+
+    core_log_histogram_add(&profile->times, time);
+    core_log_histogram_add(&profile->sizes, count);
+}
+
+void thorium_action_profiler_merge(struct thorium_action_profiler *self,
+                struct thorium_action_profiler *other)
+{
+    struct thorium_action_profile *profile;
+    struct thorium_action_profile *other_profile;
+    int i;
+
+    if (other->profiles == NULL)
+        return;
+
+    for (i = 0; i < THORIUM_ACTION_PROFILER_CAPACITY; ++i) {
+        other_profile = other->profiles[i];
+
+        if (other_profile == NULL)
+            continue;
+
+        /*
+         * Read the profile after reading its pointer.
+         */
+        core_memory_load_fence();
+
+        profile = thorium_action_profiler_get(self, other_profile->script, other_profile->action);
+
+        if (profile == NULL) {
+            self->lost_event_count += core_log_histogram_count(&other_profile->times);
+            continue;
+        }
+
+        core_log_histogram_merge(&profile->times, &other_profile->times);
+        core_log_histogram_merge(&profile->sizes, &other_profile->sizes);
+    }
+
+    self->lost_event_count += other->lost_event_count;
+}
+
+void thorium_action_profiler_get_profiles(struct thorium_action_profiler *self,
+                struct core_vector *profiles)
+{
+    struct thorium_action_profile *profile;
+    int i;
+
+    if (self->profiles == NULL)
+        return;
+
+    for (i = 0; i < THORIUM_ACTION_PROFILER_CAPACITY; ++i) {
+        profile = self->profiles[i];
+
+        if (profile != NULL)
+            core_vector_push_back(profiles, &profile);
+    }
+
+    core_vector_sort(profiles, thorium_action_profiler_compare);
+}
+
+int thorium_action_profiler_size(struct thorium_action_profiler *self)
+{
+    return self->size;
+}
+
+uint64_t thorium_action_profiler_lost_event_count(struct thorium_action_profiler *self)
+{
+    return self->lost_event_count;
+}
+
+/*
+ * Find the profile of (script, action) with linear probing, or
+ * publish a new one.
+ *
+ * \return the profile, or NULL if the profiler is full
+ */
+static struct thorium_action_profile *thorium_action_profiler_get(struct thorium_action_profiler *self,
+                int script, int action)
+{
+    struct thorium_action_profile *profile;
+    uint32_t hash;
+    int index;
+
+    CORE_DEBUGGER_ASSERT(self->profiles != NULL);
+
+    hash = (uint32_t)script * 0x9e3779b1 ^ (uint32_t)action * 0x85ebca6b;
+    index = (hash ^ (hash >> 15)) & INDEX_MASK;
+
+    while (1) {
+        profile = self->profiles[index];
+
+        if (profile == NULL)
+            break;
+
+        if (profile->script == script && profile->action == action)
+            return profile;
+
+        index = (index + 1) & INDEX_MASK;
+    }
+
+    if (self->size == MAXIMUM_SIZE)
+        return NULL;
+
+    profile = core_memory_allocate(sizeof(struct thorium_action_profile), MEMORY_ACTION_PROFILER);
+
+    profile->script = script;
+    profile->action = action;
+    core_log_histogram_init(&profile->times);
+    core_log_histogram_init(&profile->sizes);
+
+    /*
+     * The profile must be visible before its pointer.
+     */
+    core_memory_store_fence();
+    self->profiles[index] = profile;
+
+    ++self->size;
+
+    return profile;
+}
+
+/*
+ * By decreasing total time.
+ */
+static int thorium_action_profiler_compare(const void *a, const void *b)
+{
+    struct thorium_action_profile *profile_a;
+    struct thorium_action_profile *profile_b;
+    uint64_t time_a;
+    uint64_t time_b;
+
+    profile_a = *(struct thorium_action_profile **)a;
+    profile_b = *(struct thorium_action_profile **)b;
+
+    time_a = core_log_histogram_sum(&profile_a->times);
+    time_b = core_log_histogram_sum(&profile_b->times);
+
+    if (time_a > time_b)
+        return -1;
+    else if (time_a < time_b)
+        return 1;
+
+    return 0;
+}
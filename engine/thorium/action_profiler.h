@@ -0,0 +1,75 @@
+
+#ifndef THORIUM_ACTION_PROFILER_H
+#define THORIUM_ACTION_PROFILER_H
+
+#include <core/structures/log_histogram.h>
+
+#include <stdint.h>
+
+struct core_vector;
+
+/*
+ * Number of (script, action) pairs for each worker (must be a power of 2).
+ */
+#define THORIUM_ACTION_PROFILER_CAPACITY 512
+
+/*
+ * The profile of an action of a script.
+ */
+struct thorium_action_profile {
+    int script;
+    int action;
+
+    /*
+     * Handler times in nanoseconds.
+     */
+    struct core_log_histogram times;
+
+    /*
+     * Message sizes in bytes.
+     */
+    struct core_log_histogram sizes;
+};
+
+/*
+ * Profiles of the receive events of the actors of a worker,
+ * for each (script, action).
+ *
+ * The memory does not depend on the number of events. The worker is the
+ * only writer. A profile is published once and never moves, so the node
+ * can merge the profiles of the workers without locks while they run.
+ */
+struct thorium_action_profiler {
+    int enabled;
+    int size;
+    uint64_t lost_event_count;
+
+    struct thorium_action_profile *volatile *profiles;
+};
+
+void thorium_action_profiler_init(struct thorium_action_profiler *self);
+void thorium_action_profiler_destroy(struct thorium_action_profiler *self);
+
+void thorium_action_profiler_enable(struct thorium_action_profiler *self);
+int thorium_action_profiler_is_enabled(struct thorium_action_profiler *self);
+
+void thorium_action_profiler_add(struct thorium_action_profiler *self, int script, int action,
+                int count, uint64_t time);
+
+/*
+ * Add the profiles of <other> to <self>.
+ */
+void thorium_action_profiler_merge(struct thorium_action_profiler *self,
+                struct thorium_action_profiler *other);
+
+/*
+ * Get the profiles, by decreasing total time.
+ * The vector contains pointers (struct thorium_action_profile *).
+ */
+void thorium_action_profiler_get_profiles(struct thorium_action_profiler *self,
+                struct core_vector *profiles);
+
+int thorium_action_profiler_size(struct thorium_action_profiler *self);
+uint64_t thorium_action_profiler_lost_event_count(struct thorium_action_profiler *self);
+
+#endif
@@ -16,6 +16,7 @@
 
 #include <core/system/memory.h>
 #include <core/system/debugger.h>
+#include <core/system/atomic.h>
 
 #include <stdlib.h>
 #include <stdio.h>
@@ -192,6 +193,7 @@ void thorium_actor_init(struct thorium_actor *self, void *concrete_actor,
 
     CORE_BITMAP_CLEAR_FLAG(self->flags, THORIUM_ACTOR_FLAG_ENABLE_MULTIPLEXER);
     CORE_BITMAP_CLEAR_FLAG(self->flags, THORIUM_ACTOR_FLAG_ENABLE_MESSAGE_CACHE);
+    CORE_BITMAP_CLEAR_FLAG(self->flags, THORIUM_ACTOR_FLAG_TRACK_SOURCES);
 /*
 */
 #ifdef THORIUM_ACTOR_STORE_CHILDREN
@@ -502,6 +504,11 @@ int thorium_actor_send_system_self(struct thorium_actor *self, struct thorium_me
 
         thorium_actor_clear_message_cache(self, message);
         return 1;
+
+    } else if (action == ACTION_ADD_MESSAGE_CACHE_INVALIDATION) {
+
+        thorium_actor_add_message_cache_invalidation(self, message);
+        return 1;
 #endif
     } else if (action == ACTION_ENABLE_LOG_LEVEL) {
 
@@ -672,6 +679,16 @@ void thorium_actor_send(struct thorium_actor *self, int name, struct thorium_mes
         return;
     }
 
+#ifdef THORIUM_ENABLE_MESSAGE_CACHE
+    /*
+     * A message that changes a value drops the cached replies of the
+     * node message cache for this value.
+     */
+    if (self->message_cache.shared != NULL) {
+        thorium_node_message_cache_invalidate(self->message_cache.shared, name, message);
+    }
+#endif
+
     if (CORE_BITMAP_GET_FLAG(self->flags, THORIUM_ACTOR_FLAG_ENABLE_MESSAGE_CACHE)) {
 
         /*
@@ -1272,14 +1289,20 @@ void thorium_actor_receive(struct thorium_actor *self, struct thorium_message *m
     uint64_t start;
     uint64_t end;
     uint64_t consumed_virtual_runtime;
+    struct thorium_event_tracer *event_tracer;
+    struct thorium_action_profiler *action_profiler;
+    int action;
+    int count;
 
     /*
      * Update the last message identifier.
      */
-    int id = thorium_message_get_identifier(message);
-    int source = SOURCE(message);
-    if (!core_map_update_value(&self->last_message_identifiers, &source, &id))
-        core_map_add_value(&self->last_message_identifiers, &source, &id);
+    if (CORE_BITMAP_GET_FLAG(self->flags, THORIUM_ACTOR_FLAG_TRACK_SOURCES)) {
+        int id = thorium_message_get_identifier(message);
+        int source = SOURCE(message);
+        if (!core_map_update_value(&self->last_message_identifiers, &source, &id))
+            core_map_add_value(&self->last_message_identifiers, &source, &id);
+    }
 
     /*
     CORE_DEBUGGER_ASSERT(thorium_message_get_identifier(message) >= 0);
@@ -1295,6 +1318,15 @@ void thorium_actor_receive(struct thorium_actor *self, struct thorium_message *m
     /* thorium_actor:receive_enter */
     tracepoint(thorium_actor, receive_enter, self, message);
 
+    /*
+     * The actor runs on this worker, so its ring has only one producer.
+     */
+    event_tracer = &self->worker->event_tracer;
+
+    THORIUM_EVENT_TRACER_RECORD(event_tracer, THORIUM_TRACE_EVENT_ACTOR_RECEIVE_ENTER,
+                    self->name, thorium_message_source(message),
+                    thorium_message_action(message), thorium_message_count(message));
+
     /*
      * Save the reply message in the caching system if necessary.
      */
@@ -1302,6 +1334,13 @@ void thorium_actor_receive(struct thorium_actor *self, struct thorium_message *m
         thorium_actor_save_reply_message_in_cache(self, message);
     }
 
+    /*
+     * The message can be changed by the handler.
+     */
+    action_profiler = &self->worker->action_profiler;
+    action = thorium_message_action(message);
+    count = thorium_message_count(message);
+
     start = core_timer_get_nanoseconds(&self->timer);
 
     if (CORE_BITMAP_GET_FLAG(self->flags, THORIUM_ACTOR_FLAG_ENABLE_LOAD_PROFILER)) {
@@ -1317,9 +1356,18 @@ void thorium_actor_receive(struct thorium_actor *self, struct thorium_message *m
     /* thorium_actor:receive_enter */
     tracepoint(thorium_actor, receive_exit, self, message);
 
+    THORIUM_EVENT_TRACER_RECORD(event_tracer, THORIUM_TRACE_EVENT_ACTOR_RECEIVE_EXIT,
+                    self->name, thorium_message_source(message),
+                    thorium_message_action(message), thorium_message_count(message));
+
     end = core_timer_get_nanoseconds(&self->timer);
     consumed_virtual_runtime = end - start;
     self->virtual_runtime += consumed_virtual_runtime;
+
+    if (thorium_action_profiler_is_enabled(action_profiler)) {
+        thorium_action_profiler_add(action_profiler, thorium_actor_script(self),
+                        action, count, consumed_virtual_runtime);
+    }
 }
 
 static void thorium_actor_receive_private(struct thorium_actor *self, struct thorium_message *message)
@@ -2612,6 +2660,13 @@ int thorium_actor_assigned_worker(struct thorium_actor *self)
     return self->assigned_worker;
 }
 
+int thorium_actor_place_on_worker(struct thorium_actor *self, int worker)
+{
+    core_atomic_compare_and_swap_int(&self->assigned_worker, THORIUM_WORKER_NONE, worker);
+
+    return core_atomic_read_int(&self->assigned_worker);
+}
+
 int thorium_actor_get_random_number(struct thorium_actor *self)
 {
     /*
@@ -2794,7 +2849,8 @@ int thorium_actor_get_last_message_id_from(struct thorium_actor *self, int name)
 {
     int id = -1;
 
-    core_map_get_value(&self->last_message_identifiers, &name, &id);
+    if (CORE_BITMAP_GET_FLAG(self->flags, THORIUM_ACTOR_FLAG_TRACK_SOURCES))
+        core_map_get_value(&self->last_message_identifiers, &name, &id);
 
     return id;
 }
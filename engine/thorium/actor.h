@@ -258,6 +258,15 @@ new name.
 #define THORIUM_ACTOR_FLAG_ENABLE_MESSAGE_CACHE           CORE_BITMAP_MAKE_FLAG(10)
 #define THORIUM_ACTOR_FLAG_DEFAULT_LOG_LEVEL              CORE_BITMAP_MAKE_FLAG(11)
 
+/*
+ * Remember the identifier of the last message received from each
+ * source. A message sent to an actor that is not the source of the
+ * current message then gets the last message from that actor as its
+ * parent. This costs a map update for each received message, so
+ * scripts that need it set this flag in their init function.
+ */
+#define THORIUM_ACTOR_FLAG_TRACK_SOURCES                  CORE_BITMAP_MAKE_FLAG(12)
+
 struct thorium_node;
 struct thorium_worker;
 struct core_memory_pool;
@@ -523,6 +532,15 @@ void thorium_actor_synchronize(struct thorium_actor *self, struct core_vector *a
 int thorium_actor_assigned_worker(struct thorium_actor *self);
 void thorium_actor_set_assigned_worker(struct thorium_actor *self, int worker);
 
+/*
+ * Give a worker to an actor that has none. Several threads can do this
+ * at the same time (the node and the workers with
+ * -direct-local-delivery): only the first one wins.
+ *
+ * \return the worker of the actor
+ */
+int thorium_actor_place_on_worker(struct thorium_actor *self, int worker);
+
 int thorium_actor_get_random_number(struct thorium_actor *self);
 int thorium_actor_multiplexer_is_enabled(struct thorium_actor *self);
 
@@ -0,0 +1,98 @@
+
+#include "actor_name_codec.h"
+
+#include <core/system/debugger.h>
+
+#include <limits.h>
+
+int thorium_actor_name_codec_init(struct thorium_actor_name_codec *self, int node, int nodes)
+{
+    int names_per_node;
+    int slots;
+
+    self->node = node;
+    self->nodes = nodes;
+    self->slots = 0;
+    self->maximum_generation = 0;
+
+    if (nodes <= 0 || node < 0 || node >= nodes) {
+        return 0;
+    }
+
+    /*
+     * The names of a node are node + nodes * k with 0 <= k < names_per_node.
+     */
+    names_per_node = INT_MAX / nodes;
+
+    slots = names_per_node / (THORIUM_ACTOR_NAME_CODEC_FIRST_GENERATION
+                    + THORIUM_ACTOR_NAME_CODEC_MINIMUM_GENERATIONS);
+
+    if (slots > THORIUM_ACTOR_NAME_CODEC_MAXIMUM_SLOTS) {
+        slots = THORIUM_ACTOR_NAME_CODEC_MAXIMUM_SLOTS;
+    }
+
+    if (slots < THORIUM_ACTOR_NAME_CODEC_MINIMUM_SLOTS) {
+        return 0;
+    }
+
+    self->slots = slots;
+    self->maximum_generation = names_per_node / slots - 1;
+
+    CORE_DEBUGGER_ASSERT(thorium_actor_name_codec_generation_count(self)
+                    >= THORIUM_ACTOR_NAME_CODEC_MINIMUM_GENERATIONS);
+
+    return 1;
+}
+
+void thorium_actor_name_codec_destroy(struct thorium_actor_name_codec *self)
+{
+    self->slots = 0;
+    self->maximum_generation = 0;
+}
+
+int thorium_actor_name_codec_slots(struct thorium_actor_name_codec *self)
+{
+    return self->slots;
+}
+
+int thorium_actor_name_codec_generation_count(struct thorium_actor_name_codec *self)
+{
+    return self->maximum_generation - THORIUM_ACTOR_NAME_CODEC_FIRST_GENERATION + 1;
+}
+
+int thorium_actor_name_codec_encode(struct thorium_actor_name_codec *self, int slot, int generation)
+{
+    CORE_DEBUGGER_ASSERT(slot >= 0 && slot < self->slots);
+    CORE_DEBUGGER_ASSERT(generation >= THORIUM_ACTOR_NAME_CODEC_FIRST_GENERATION);
+    CORE_DEBUGGER_ASSERT(generation <= self->maximum_generation);
+
+    /*
+     * (slot + slots * generation) < names_per_node, so nothing overflows.
+     */
+    return self->node + self->nodes * (slot + self->slots * generation);
+}
+
+int thorium_actor_name_codec_decode(struct thorium_actor_name_codec *self, int name,
+                int *slot, int *generation)
+{
+    int quotient;
+
+    if (name < 0 || name % self->nodes != self->node) {
+        return 0;
+    }
+
+    quotient = name / self->nodes;
+    *slot = quotient % self->slots;
+    *generation = quotient / self->slots;
+
+    return 1;
+}
+
+int thorium_actor_name_codec_next_generation(struct thorium_actor_name_codec *self, int generation)
+{
+    if (generation >= self->maximum_generation) {
+        return THORIUM_ACTOR_NAME_CODEC_FIRST_GENERATION;
+    }
+
+    return generation + 1;
+}
@@ -0,0 +1,55 @@
+
+#ifndef THORIUM_ACTOR_NAME_CODEC_H
+#define THORIUM_ACTOR_NAME_CODEC_H
+
+/*
+ * An actor name encodes the node, the slot of the actor in the node
+ * and the generation of the slot:
+ *
+ * name = node + nodes * (slot + slots * generation)
+ *
+ * So name % nodes is still the node of the actor, and the slot is
+ * found without a lookup. The generation of a slot is incremented when
+ * its actor dies, so a stale name does not resolve to the next actor
+ * in that slot until the generations wrap around.
+ *
+ * Names are non-negative int values, so the number of slots is derived
+ * from the number of nodes to keep at least
+ * THORIUM_ACTOR_NAME_CODEC_MINIMUM_GENERATIONS generations.
+ */
+#define THORIUM_ACTOR_NAME_CODEC_MAXIMUM_SLOTS 131072
+#define THORIUM_ACTOR_NAME_CODEC_MINIMUM_SLOTS 256
+#define THORIUM_ACTOR_NAME_CODEC_MINIMUM_GENERATIONS 64
+#define THORIUM_ACTOR_NAME_CODEC_FIRST_GENERATION 1
+
+struct thorium_actor_name_codec {
+    int node;
+    int nodes;
+    int slots;
+    int maximum_generation;
+};
+
+/*
+ * \return 1 if the names of <nodes> nodes fit in an int, 0 otherwise
+ */
+int thorium_actor_name_codec_init(struct thorium_actor_name_codec *self, int node, int nodes);
+void thorium_actor_name_codec_destroy(struct thorium_actor_name_codec *self);
+
+int thorium_actor_name_codec_slots(struct thorium_actor_name_codec *self);
+int thorium_actor_name_codec_generation_count(struct thorium_actor_name_codec *self);
+
+int thorium_actor_name_codec_encode(struct thorium_actor_name_codec *self, int slot, int generation);
+
+/*
+ * \return 1 if <name> is a name of this node, 0 otherwise
+ */
+int thorium_actor_name_codec_decode(struct thorium_actor_name_codec *self, int name,
+                int *slot, int *generation);
+
+/*
+ * \return the generation after <generation>, wrapping around to
+ * THORIUM_ACTOR_NAME_CODEC_FIRST_GENERATION
+ */
+int thorium_actor_name_codec_next_generation(struct thorium_actor_name_codec *self, int generation);
+
+#endif
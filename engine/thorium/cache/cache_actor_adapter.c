@@ -4,6 +4,7 @@
 #include <engine/thorium/actor.h>
 #include <engine/thorium/message.h>
 #include <engine/thorium/worker.h>
+#include <engine/thorium/node.h>
 
 #include <core/helpers/bitmap.h>
 
@@ -20,6 +21,11 @@ void thorium_actor_init_message_cache(struct thorium_actor *self)
     thorium_message_cache_init(&self->message_cache);
     thorium_message_cache_set_memory_pool(&self->message_cache,
                     &self->abstract_memory_pool);
+
+    if (self->node != NULL) {
+        thorium_message_cache_set_shared(&self->message_cache,
+                        thorium_node_get_message_cache(self->node));
+    }
 }
 
 void thorium_actor_destroy_message_cache(struct thorium_actor *self)
@@ -82,29 +88,67 @@ void thorium_actor_clear_message_cache(struct thorium_actor *self, struct thoriu
     thorium_message_cache_clear(&self->message_cache);
 }
 
+void thorium_actor_add_message_cache_invalidation(struct thorium_actor *self,
+                struct thorium_message *message)
+{
+    int invalidating_action;
+    int request_action;
+    int ignored_bytes;
+    int offset;
+
+    if (self->message_cache.shared == NULL) {
+        return;
+    }
+
+    offset = 0;
+    offset += thorium_message_unpack_int(message, offset, &invalidating_action);
+    offset += thorium_message_unpack_int(message, offset, &request_action);
+    offset += thorium_message_unpack_int(message, offset, &ignored_bytes);
+
+    thorium_node_message_cache_add_rule(self->message_cache.shared, invalidating_action,
+                    request_action, ignored_bytes);
+}
+
+void thorium_actor_invalidate_message_cache(struct thorium_actor *self, int destination,
+                int request_action, int count, void *buffer)
+{
+    if (self->message_cache.shared == NULL) {
+        return;
+    }
+
+    thorium_node_message_cache_invalidate_request(self->message_cache.shared, destination,
+                    request_action, count, buffer);
+}
+
 int thorium_actor_fetch_reply_message_from_cache(struct thorium_actor *self,
                 struct thorium_message *message)
 {
-    struct thorium_message *reply_message;
     struct thorium_message new_message;
-    int count;
-    void *buffer;
-    void *new_buffer;
     struct thorium_worker *worker;
     int worker_name;
     struct core_memory_pool *pool;
+    int found;
+
+    worker = thorium_actor_worker(self);
+
+    /*
+     * Use the outbound message allocator from the worker.
+     */
+    pool = thorium_worker_get_memory_pool(worker,
+                    MEMORY_POOL_NAME_WORKER_OUTBOUND);
 
     /*
-     * Try to get the reply message from the message cache using the request
-     * message.
+     * Try to get a copy of the reply message from the message cache using
+     * the request message.
      */
 #ifdef CONFIG_INJECT_CACHED_REPLY_MESSAGE
-    reply_message = thorium_message_cache_get_reply_message(&self->message_cache, message);
+    found = thorium_message_cache_copy_reply_message(&self->message_cache, message,
+                    &new_message, pool);
 #else
-    reply_message = NULL;
+    found = 0;
 #endif
 
-    if (reply_message != NULL) {
+    if (found) {
         /*
          * Inject the reply message and return 1.
          */
@@ -114,42 +158,22 @@ int thorium_actor_fetch_reply_message_from_cache(struct thorium_actor *self,
         printf("Request: ");
         thorium_message_print(message);
         printf("Reply: ");
-        thorium_message_print(reply_message);
+        thorium_message_print(&new_message);
 #endif
 
-        /*
-         * Make a copy of the reply_message.
-         */
-        core_memory_copy(&new_message, reply_message, sizeof(new_message));
-
         /*
          * Set the worker name for this message so that if there is
          * a buffer allocated, it can be eventually routed back here to be
          * freed.
          */
-        worker = thorium_actor_worker(self);
         worker_name = thorium_worker_name(worker);
         thorium_message_set_worker(&new_message, worker_name);
 
         /*
-         * Allocate a outbound buffer and
-         * copy the data.
+         * With a node message cache, the reply was maybe saved by
+         * another actor.
          */
-        buffer = thorium_message_buffer(reply_message);
-
-        if (buffer != NULL) {
-            count = thorium_message_count(reply_message);
-
-            /*
-             * Use the outbound message allocator from the worker.
-             */
-            pool = thorium_worker_get_memory_pool(worker,
-                            MEMORY_POOL_NAME_WORKER_OUTBOUND);
-            new_buffer = core_memory_pool_allocate(pool, count);
-            core_memory_copy(new_buffer, buffer, count);
-
-            thorium_message_set_buffer(&new_message, new_buffer);
-        }
+        thorium_message_set_destination(&new_message, thorium_actor_name(self));
 
         /*
          * And inject the message. To do so,
@@ -13,6 +13,15 @@
 #define ACTION_DISABLE_MESSAGE_CACHE (THORIUM_CACHE_BASE + 2)
 #define ACTION_CLEAR_MESSAGE_CACHE (THORIUM_CACHE_BASE + 3)
 
+/*
+ * The buffer contains 3 int: the invalidating action, the request
+ * action and the number of bytes at the end of the invalidating
+ * message that are not in the request message.
+ *
+ * This only applies to the node message cache (-node-message-cache-size).
+ */
+#define ACTION_ADD_MESSAGE_CACHE_INVALIDATION (THORIUM_CACHE_BASE + 4)
+
 struct thorium_actor;
 struct thorium_message;
 
@@ -35,6 +44,21 @@ void thorium_actor_disable_message_cache(struct thorium_actor *self,
  */
 void thorium_actor_clear_message_cache(struct thorium_actor *self, struct thorium_message *message);
 
+/**
+ * Invoked by ACTION_ADD_MESSAGE_CACHE_INVALIDATION.
+ */
+void thorium_actor_add_message_cache_invalidation(struct thorium_actor *self,
+                struct thorium_message *message);
+
+/**
+ * Drop the reply to a request (destination, request action, buffer)
+ * from the node message cache. This is for changes that the
+ * invalidation rules can not see, like a change made by the handler of
+ * another request. Nothing is done without a node message cache.
+ */
+void thorium_actor_invalidate_message_cache(struct thorium_actor *self, int destination,
+                int request_action, int count, void *buffer);
+
 /**
  * This hook is called in thorium_actor_receive()
  * to cache the reply message, if desired.
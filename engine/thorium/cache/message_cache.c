@@ -40,6 +40,8 @@ void thorium_message_cache_init(struct thorium_message_cache *self)
     thorium_cache_tag_init(&self->saved_reply_message_cache_tag);
 
     self->pool = NULL;
+    self->shared = NULL;
+    self->saved_reply_message_epoch = 0;
 
     self->profile_cache_miss_count = 0;
     self->profile_cache_hit_count = 0;
@@ -63,6 +65,12 @@ void thorium_message_cache_set_memory_pool(struct thorium_message_cache *self,
     core_map_set_memory_pool(&self->actions, pool);
 }
 
+void thorium_message_cache_set_shared(struct thorium_message_cache *self,
+                struct thorium_node_message_cache *shared)
+{
+    self->shared = shared;
+}
+
 void thorium_message_cache_clear(struct thorium_message_cache *self)
 {
     struct core_map_iterator iterator;
@@ -75,6 +83,15 @@ void thorium_message_cache_clear(struct thorium_message_cache *self)
                     (int)core_map_size(&self->entries));
 #endif
 
+    /*
+     * The entries of a node message cache are used by other actors too.
+     * They are invalidated instead.
+     */
+    if (self->shared != NULL) {
+        thorium_cache_tag_reset(&self->saved_reply_message_cache_tag);
+        return;
+    }
+
     core_map_iterator_init(&iterator, &self->entries);
 
     while (core_map_iterator_next(&iterator, (void **)&request_tag,
@@ -181,6 +198,57 @@ struct thorium_message *thorium_message_cache_get_reply_message(struct thorium_m
     return reply_message;
 }
 
+int thorium_message_cache_copy_reply_message(struct thorium_message_cache *self,
+                struct thorium_message *request_message, struct thorium_message *reply_message,
+                struct core_memory_pool *pool)
+{
+    struct thorium_message *stored_message;
+    struct thorium_cache_tag cache_tag;
+    void *buffer;
+    int count;
+    int action;
+
+    if (self->shared == NULL) {
+        stored_message = thorium_message_cache_get_reply_message(self, request_message);
+
+        if (stored_message == NULL) {
+            return 0;
+        }
+
+        core_memory_copy(reply_message, stored_message, sizeof(*reply_message));
+
+        buffer = thorium_message_buffer(stored_message);
+
+        if (buffer != NULL) {
+            count = thorium_message_count(stored_message);
+            thorium_message_set_buffer(reply_message, core_memory_pool_allocate(pool, count));
+            core_memory_copy(thorium_message_buffer(reply_message), buffer, count);
+        }
+
+        return 1;
+    }
+
+    action = thorium_message_action(request_message);
+
+    if (core_map_get(&self->actions, &action) == NULL) {
+        return 0;
+    }
+
+    thorium_cache_tag_set(&cache_tag, request_message);
+
+    if (thorium_node_message_cache_get(self->shared, &cache_tag, reply_message, pool)) {
+        ++self->profile_cache_hit_count;
+        return 1;
+    }
+
+    thorium_message_cache_save_request_message(self, request_message);
+    self->saved_reply_message_epoch = thorium_node_message_cache_get_epoch(self->shared,
+                    &cache_tag);
+    ++self->profile_cache_miss_count;
+
+    return 0;
+}
+
 void thorium_message_cache_save_reply_message(struct thorium_message_cache *self,
                 struct thorium_message *message)
 {
@@ -234,6 +302,13 @@ void thorium_message_cache_save_reply_message(struct thorium_message_cache *self
         return;
     }
 
+    if (self->shared != NULL) {
+        thorium_node_message_cache_put(self->shared, &self->saved_reply_message_cache_tag,
+                        message, self->saved_reply_message_epoch);
+        thorium_cache_tag_reset(&self->saved_reply_message_cache_tag);
+        return;
+    }
+
     /*
      * The saved_reply_message_cache_tag is already in the cache entries.
      * This code path should not actually happen...
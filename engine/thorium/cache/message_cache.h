@@ -3,6 +3,7 @@
 #define THORIUM_MESSAGE_CACHE_H_
 
 #include "cache_tag.h"
+#include "node_message_cache.h"
 
 #include <core/structures/map.h>
 #include <core/structures/set.h>
@@ -18,8 +19,20 @@ struct thorium_message_cache {
     struct core_map entries;
     struct core_memory_pool *pool;
 
+    /*
+     * With a node message cache, the replies are saved there instead
+     * of in entries.
+     */
+    struct thorium_node_message_cache *shared;
+
     struct thorium_cache_tag saved_reply_message_cache_tag;
 
+    /*
+     * The invalidation epoch of the node message cache when the
+     * request was sent.
+     */
+    uint64_t saved_reply_message_epoch;
+
     int profile_cache_miss_count;
     int profile_cache_hit_count;
 };
@@ -31,6 +44,12 @@ void thorium_message_cache_set_memory_pool(struct thorium_message_cache *self,
                 struct core_memory_pool *pool);
 void thorium_message_cache_clear(struct thorium_message_cache *self);
 
+/**
+ * Use a node message cache (shared by the actors of a node).
+ */
+void thorium_message_cache_set_shared(struct thorium_message_cache *self,
+                struct thorium_node_message_cache *shared);
+
 /**
  * Obtain a reply message associated to a request message (from the message
  * cache).
@@ -38,6 +57,16 @@ void thorium_message_cache_clear(struct thorium_message_cache *self);
 struct thorium_message *thorium_message_cache_get_reply_message(struct thorium_message_cache *self,
                 struct thorium_message *request_message);
 
+/**
+ * Copy the reply message associated to a request message in
+ * reply_message. The buffer is allocated with the pool.
+ *
+ * @return 1 if a reply message was found
+ */
+int thorium_message_cache_copy_reply_message(struct thorium_message_cache *self,
+                struct thorium_message *request_message, struct thorium_message *reply_message,
+                struct core_memory_pool *pool);
+
 /**
  * This is called in the ACTION_ENABLE_MESSAGE_CACHE code path.
  */
@@ -0,0 +1,477 @@
+
+#include "node_message_cache.h"
+
+#include <engine/thorium/message.h>
+
+#include <core/system/memory.h>
+#include <core/system/memory_pool.h>
+#include <core/system/debugger.h>
+
+#define MEMORY_NODE_MESSAGE_CACHE 0x3f1c84d2
+
+static struct thorium_node_message_cache_shard *thorium_node_message_cache_get_shard(
+                struct thorium_node_message_cache *self, struct thorium_cache_tag *tag);
+static void thorium_node_message_cache_shard_init(struct thorium_node_message_cache_shard *self);
+static void thorium_node_message_cache_shard_destroy(struct thorium_node_message_cache_shard *self);
+static void thorium_node_message_cache_shard_remove(struct thorium_node_message_cache_shard *self,
+                int slot);
+static int thorium_node_message_cache_shard_evict(struct thorium_node_message_cache_shard *self);
+static uint64_t thorium_node_message_cache_entry_cost(int count);
+
+void thorium_node_message_cache_init(struct thorium_node_message_cache *self,
+                uint64_t maximum_byte_count)
+{
+    int i;
+
+    for (i = 0; i < THORIUM_NODE_MESSAGE_CACHE_SHARDS; ++i) {
+        thorium_node_message_cache_shard_init(self->shards + i);
+    }
+
+    self->maximum_shard_byte_count = maximum_byte_count / THORIUM_NODE_MESSAGE_CACHE_SHARDS;
+
+    core_spinlock_init(&self->rule_lock);
+    self->rule_count = 0;
+}
+
+void thorium_node_message_cache_destroy(struct thorium_node_message_cache *self)
+{
+    int i;
+
+    for (i = 0; i < THORIUM_NODE_MESSAGE_CACHE_SHARDS; ++i) {
+        thorium_node_message_cache_shard_destroy(self->shards + i);
+    }
+
+    self->maximum_shard_byte_count = 0;
+
+    core_spinlock_destroy(&self->rule_lock);
+    self->rule_count = 0;
+}
+
+int thorium_node_message_cache_get(struct thorium_node_message_cache *self,
+                struct thorium_cache_tag *tag, struct thorium_message *reply_message,
+                struct core_memory_pool *pool)
+{
+    struct thorium_node_message_cache_shard *shard;
+    struct thorium_node_message_cache_entry *entry;
+    int *slot;
+    void *buffer;
+    int count;
+
+    shard = thorium_node_message_cache_get_shard(self, tag);
+
+    core_spinlock_lock(&shard->lock);
+
+    slot = core_map_get(&shard->slots, tag);
+
+    if (slot == NULL) {
+        ++shard->miss_count;
+        core_spinlock_unlock(&shard->lock);
+        return 0;
+    }
+
+    entry = core_vector_at(&shard->entries, *slot);
+    entry->referenced = 1;
+    ++shard->hit_count;
+
+    /*
+     * The copy is done with the lock since the entry can be evicted
+     * by another worker after that.
+     */
+    core_memory_copy(reply_message, &entry->message, sizeof(entry->message));
+
+    buffer = thorium_message_buffer(&entry->message);
+
+    if (buffer != NULL) {
+        count = thorium_message_count(&entry->message);
+        thorium_message_set_buffer(reply_message, core_memory_pool_allocate(pool, count));
+        core_memory_copy(thorium_message_buffer(reply_message), buffer, count);
+    }
+
+    core_spinlock_unlock(&shard->lock);
+
+    return 1;
+}
+
+uint64_t thorium_node_message_cache_get_epoch(struct thorium_node_message_cache *self,
+                struct thorium_cache_tag *tag)
+{
+    struct thorium_node_message_cache_shard *shard;
+    uint64_t epoch;
+
+    shard = thorium_node_message_cache_get_shard(self, tag);
+
+    core_spinlock_lock(&shard->lock);
+    epoch = shard->invalidation_epoch;
+    core_spinlock_unlock(&shard->lock);
+
+    return epoch;
+}
+
+void thorium_node_message_cache_put(struct thorium_node_message_cache *self,
+                struct thorium_cache_tag *tag, struct thorium_message *reply_message,
+                uint64_t epoch)
+{
+    struct thorium_node_message_cache_shard *shard;
+    struct thorium_node_message_cache_entry *entry;
+    uint64_t cost;
+    void *buffer;
+    int count;
+    int slot;
+
+    count = thorium_message_count(reply_message);
+    cost = thorium_node_message_cache_entry_cost(count);
+
+    /*
+     * This reply would evict too many entries.
+     */
+    if (cost > self->maximum_shard_byte_count / 4) {
+        return;
+    }
+
+    shard = thorium_node_message_cache_get_shard(self, tag);
+
+    core_spinlock_lock(&shard->lock);
+
+    /*
+     * The reply may have been made before a change that was
+     * invalidated after the request was sent.
+     */
+    if (shard->invalidation_epoch != epoch) {
+        ++shard->stale_reply_count;
+        core_spinlock_unlock(&shard->lock);
+        return;
+    }
+
+    /*
+     * Another actor of the node already saved this reply.
+     */
+    if (core_map_get(&shard->slots, tag) != NULL) {
+        core_spinlock_unlock(&shard->lock);
+        return;
+    }
+
+    while (shard->byte_count + cost > self->maximum_shard_byte_count
+                    && thorium_node_message_cache_shard_evict(shard)) {
+    }
+
+    if (core_vector_size(&shard->free_slots) > 0) {
+        slot = core_vector_at_as_int(&shard->free_slots, core_vector_size(&shard->free_slots) - 1);
+        core_vector_resize(&shard->free_slots, core_vector_size(&shard->free_slots) - 1);
+    } else {
+        slot = core_vector_size(&shard->entries);
+        core_vector_resize(&shard->entries, slot + 1);
+    }
+
+    entry = core_vector_at(&shard->entries, slot);
+
+    core_memory_copy(&entry->tag, tag, sizeof(entry->tag));
+    core_memory_copy(&entry->message, reply_message, sizeof(entry->message));
+
+    if (thorium_message_buffer(reply_message) != NULL) {
+        buffer = core_memory_allocate(count, MEMORY_NODE_MESSAGE_CACHE);
+        core_memory_copy(buffer, thorium_message_buffer(reply_message), count);
+        thorium_message_set_buffer(&entry->message, buffer);
+    }
+
+    /*
+     * A new entry gets a second chance only after being used.
+     */
+    entry->referenced = 0;
+    entry->used = 1;
+
+    core_map_add_value(&shard->slots, tag, &slot);
+    shard->byte_count += cost;
+
+    core_spinlock_unlock(&shard->lock);
+}
+
+void thorium_node_message_cache_add_rule(struct thorium_node_message_cache *self,
+                int invalidating_action, int request_action, int ignored_bytes)
+{
+    struct thorium_node_message_cache_rule *rule;
+    int i;
+
+    core_spinlock_lock(&self->rule_lock);
+
+    for (i = 0; i < self->rule_count; ++i) {
+        rule = self->rules + i;
+
+        if (rule->invalidating_action == invalidating_action
+                        && rule->request_action == request_action
+                        && rule->ignored_bytes == ignored_bytes) {
+            core_spinlock_unlock(&self->rule_lock);
+            return;
+        }
+    }
+
+    CORE_DEBUGGER_ASSERT(self->rule_count < THORIUM_NODE_MESSAGE_CACHE_MAXIMUM_RULES);
+
+    if (self->rule_count < THORIUM_NODE_MESSAGE_CACHE_MAXIMUM_RULES) {
+        rule = self->rules + self->rule_count;
+        rule->invalidating_action = invalidating_action;
+        rule->request_action = request_action;
+        rule->ignored_bytes = ignored_bytes;
+
+        /*
+         * Rules are read without the lock.
+         */
+        core_memory_fence();
+        ++self->rule_count;
+    }
+
+    core_spinlock_unlock(&self->rule_lock);
+}
+
+void thorium_node_message_cache_invalidate(struct thorium_node_message_cache *self,
+                int destination, struct thorium_message *message)
+{
+    struct thorium_node_message_cache_rule *rule;
+    int action;
+    int count;
+    int rule_count;
+    int i;
+
+    rule_count = *(volatile int *)&self->rule_count;
+
+    if (rule_count == 0) {
+        return;
+    }
+
+    action = thorium_message_action(message);
+
+    for (i = 0; i < rule_count; ++i) {
+        rule = self->rules + i;
+
+        if (rule->invalidating_action != action) {
+            continue;
+        }
+
+        count = thorium_message_count(message) - rule->ignored_bytes;
+
+        if (count < 0) {
+            continue;
+        }
+
+        thorium_node_message_cache_invalidate_request(self, destination,
+                        rule->request_action, count, thorium_message_buffer(message));
+    }
+}
+
+void thorium_node_message_cache_invalidate_request(struct thorium_node_message_cache *self,
+                int destination, int request_action, int count, void *buffer)
+{
+    struct thorium_node_message_cache_shard *shard;
+    struct thorium_message request_message;
+    struct thorium_cache_tag tag;
+    int *slot;
+
+    thorium_message_init(&request_message, request_action, count, buffer);
+    thorium_message_set_destination(&request_message, destination);
+    thorium_cache_tag_set(&tag, &request_message);
+    thorium_message_destroy(&request_message);
+
+    shard = thorium_node_message_cache_get_shard(self, &tag);
+
+    core_spinlock_lock(&shard->lock);
+
+    slot = core_map_get(&shard->slots, &tag);
+
+    if (slot != NULL) {
+        thorium_node_message_cache_shard_remove(shard, *slot);
+        ++shard->invalidation_count;
+    }
+
+    /*
+     * This is done even without an entry: the reply of a request
+     * that is in flight must not be saved.
+     */
+    ++shard->invalidation_epoch;
+
+    core_spinlock_unlock(&shard->lock);
+}
+
+uint64_t thorium_node_message_cache_size(struct thorium_node_message_cache *self)
+{
+    uint64_t size;
+    int i;
+
+    size = 0;
+
+    for (i = 0; i < THORIUM_NODE_MESSAGE_CACHE_SHARDS; ++i) {
+        size += core_map_size(&self->shards[i].slots);
+    }
+
+    return size;
+}
+
+uint64_t thorium_node_message_cache_byte_count(struct thorium_node_message_cache *self)
+{
+    uint64_t byte_count;
+    int i;
+
+    byte_count = 0;
+
+    for (i = 0; i < THORIUM_NODE_MESSAGE_CACHE_SHARDS; ++i) {
+        byte_count += self->shards[i].byte_count;
+    }
+
+    return byte_count;
+}
+
+uint64_t thorium_node_message_cache_stale_reply_count(struct thorium_node_message_cache *self)
+{
+    uint64_t count;
+    int i;
+
+    count = 0;
+
+    for (i = 0; i < THORIUM_NODE_MESSAGE_CACHE_SHARDS; ++i) {
+        count += self->shards[i].stale_reply_count;
+    }
+
+    return count;
+}
+
+void thorium_node_message_cache_get_profile(struct thorium_node_message_cache *self,
+                uint64_t *hit_count, uint64_t *miss_count,
+                uint64_t *eviction_count, uint64_t *invalidation_count)
+{
+    struct thorium_node_message_cache_shard *shard;
+    int i;
+
+    *hit_count = 0;
+    *miss_count = 0;
+    *eviction_count = 0;
+    *invalidation_count = 0;
+
+    for (i = 0; i < THORIUM_NODE_MESSAGE_CACHE_SHARDS; ++i) {
+        shard = self->shards + i;
+
+        *hit_count += shard->hit_count;
+        *miss_count += shard->miss_count;
+        *eviction_count += shard->eviction_count;
+        *invalidation_count += shard->invalidation_count;
+    }
+}
+
+static struct thorium_node_message_cache_shard *thorium_node_message_cache_get_shard(
+                struct thorium_node_message_cache *self, struct thorium_cache_tag *tag)
+{
+    uint64_t hash;
+
+    hash = thorium_cache_tag_signature(tag);
+    hash ^= (uint64_t)thorium_cache_tag_destination(tag) * 0x9e3779b97f4a7c15ULL;
+    hash ^= hash >> 32;
+
+    return self->shards + (hash % THORIUM_NODE_MESSAGE_CACHE_SHARDS);
+}
+
+static void thorium_node_message_cache_shard_init(struct thorium_node_message_cache_shard *self)
+{
+    core_spinlock_init(&self->lock);
+    core_map_init(&self->slots, sizeof(struct thorium_cache_tag), sizeof(int));
+    core_vector_init(&self->entries, sizeof(struct thorium_node_message_cache_entry));
+    core_vector_init(&self->free_slots, sizeof(int));
+
+    self->hand = 0;
+    self->byte_count = 0;
+    self->invalidation_epoch = 0;
+
+    self->hit_count = 0;
+    self->miss_count = 0;
+    self->eviction_count = 0;
+    self->invalidation_count = 0;
+    self->stale_reply_count = 0;
+}
+
+static void thorium_node_message_cache_shard_destroy(struct thorium_node_message_cache_shard *self)
+{
+    struct thorium_node_message_cache_entry *entry;
+    int i;
+
+    for (i = 0; i < core_vector_size(&self->entries); ++i) {
+        entry = core_vector_at(&self->entries, i);
+
+        if (entry->used && thorium_message_buffer(&entry->message) != NULL) {
+            core_memory_free(thorium_message_buffer(&entry->message), MEMORY_NODE_MESSAGE_CACHE);
+        }
+    }
+
+    core_map_destroy(&self->slots);
+    core_vector_destroy(&self->entries);
+    core_vector_destroy(&self->free_slots);
+    core_spinlock_destroy(&self->lock);
+
+    self->byte_count = 0;
+}
+
+static void thorium_node_message_cache_shard_remove(struct thorium_node_message_cache_shard *self,
+                int slot)
+{
+    struct thorium_node_message_cache_entry *entry;
+
+    entry = core_vector_at(&self->entries, slot);
+
+    CORE_DEBUGGER_ASSERT(entry->used);
+
+    core_map_delete(&self->slots, &entry->tag);
+
+    if (thorium_message_buffer(&entry->message) != NULL) {
+        core_memory_free(thorium_message_buffer(&entry->message), MEMORY_NODE_MESSAGE_CACHE);
+    }
+
+    self->byte_count -= thorium_node_message_cache_entry_cost(thorium_message_count(&entry->message));
+    thorium_message_destroy(&entry->message);
+    entry->used = 0;
+
+    core_vector_push_back_int(&self->free_slots, slot);
+}
+
+/*
+ * CLOCK: the hand clears the reference bit of the entries that were
+ * used since its last visit and evicts the first entry that was not.
+ *
+ * \return 1 if an entry was evicted
+ */
+static int thorium_node_message_cache_shard_evict(struct thorium_node_message_cache_shard *self)
+{
+    struct thorium_node_message_cache_entry *entry;
+    int size;
+    int steps;
+
+    size = core_vector_size(&self->entries);
+
+    /*
+     * Two turns are enough to find an entry without a reference bit.
+     */
+    for (steps = 0; steps < 2 * size; ++steps) {
+
+        if (self->hand >= size) {
+            self->hand = 0;
+        }
+
+        entry = core_vector_at(&self->entries, self->hand);
+        ++self->hand;
+
+        if (!entry->used) {
+            continue;
+        }
+
+        if (entry->referenced) {
+            entry->referenced = 0;
+            continue;
+        }
+
+        thorium_node_message_cache_shard_remove(self, self->hand - 1);
+        ++self->eviction_count;
+
+        return 1;
+    }
+
+    return 0;
+}
+
+static uint64_t thorium_node_message_cache_entry_cost(int count)
+{
+    return count + sizeof(struct thorium_node_message_cache_entry) + sizeof(struct thorium_cache_tag);
+}
@@ -0,0 +1,150 @@
+
+#ifndef THORIUM_NODE_MESSAGE_CACHE_H_
+#define THORIUM_NODE_MESSAGE_CACHE_H_
+
+#include "cache_tag.h"
+
+#include <engine/thorium/message.h>
+
+#include <core/structures/map.h>
+#include <core/structures/vector.h>
+
+#include <core/system/spinlock.h>
+
+#include <stdint.h>
+
+struct core_memory_pool;
+
+#define THORIUM_NODE_MESSAGE_CACHE_SHARDS 16
+#define THORIUM_NODE_MESSAGE_CACHE_MAXIMUM_RULES 8
+
+/*
+ * A reply message in the node message cache.
+ */
+struct thorium_node_message_cache_entry {
+    struct thorium_cache_tag tag;
+    struct thorium_message message;
+    int referenced;
+    int used;
+};
+
+/*
+ * The entries are split in shards so that workers rarely wait for
+ * each other. Each shard has its own lock and its own CLOCK hand.
+ *
+ * The invalidation epoch of a shard changes with each invalidation
+ * in it. A reply is only saved if the epoch has not changed since its
+ * request was sent.
+ */
+struct thorium_node_message_cache_shard {
+    struct core_spinlock lock;
+    struct core_map slots;
+    struct core_vector entries;
+    struct core_vector free_slots;
+    int hand;
+    uint64_t byte_count;
+    uint64_t invalidation_epoch;
+
+    uint64_t hit_count;
+    uint64_t miss_count;
+    uint64_t eviction_count;
+    uint64_t invalidation_count;
+    uint64_t stale_reply_count;
+};
+
+/*
+ * A message with action invalidating_action invalidates the cached
+ * reply of the request with action request_action sent to the
+ * same destination with the same buffer (without its last
+ * ignored_bytes bytes).
+ */
+struct thorium_node_message_cache_rule {
+    int invalidating_action;
+    int request_action;
+    int ignored_bytes;
+};
+
+/*
+ * A message cache shared by all the actors of a node. A reply fetched
+ * by one actor is a cache hit for the other actors of the node that
+ * send the same request.
+ *
+ * Only the actors that enable their message cache with
+ * ACTION_ENABLE_MESSAGE_CACHE read from it (for biosal, the unitig
+ * visitors). The other actors of the node, like the unitig walkers,
+ * only drop the entries for the values that they change.
+ *
+ * The memory is bounded and entries are evicted with the CLOCK
+ * algorithm (second chance). Invalidation is done when the
+ * invalidating message is sent by an actor of the node, so a change
+ * made by an actor of another node is not seen.
+ */
+struct thorium_node_message_cache {
+    struct thorium_node_message_cache_shard shards[THORIUM_NODE_MESSAGE_CACHE_SHARDS];
+    uint64_t maximum_shard_byte_count;
+
+    struct core_spinlock rule_lock;
+    struct thorium_node_message_cache_rule rules[THORIUM_NODE_MESSAGE_CACHE_MAXIMUM_RULES];
+    int rule_count;
+};
+
+void thorium_node_message_cache_init(struct thorium_node_message_cache *self,
+                uint64_t maximum_byte_count);
+void thorium_node_message_cache_destroy(struct thorium_node_message_cache *self);
+
+/*
+ * Copy the reply for a request tag in a new message. The buffer is
+ * allocated with the pool.
+ *
+ * \return 1 on a cache hit, 0 otherwise
+ */
+int thorium_node_message_cache_get(struct thorium_node_message_cache *self,
+                struct thorium_cache_tag *tag, struct thorium_message *reply_message,
+                struct core_memory_pool *pool);
+
+/*
+ * \return the invalidation epoch for a request tag, to be recorded
+ * when the request is sent
+ */
+uint64_t thorium_node_message_cache_get_epoch(struct thorium_node_message_cache *self,
+                struct thorium_cache_tag *tag);
+
+/*
+ * Save a copy of a reply message for a request tag. The reply is
+ * dropped if an invalidation happened after the request was sent
+ * (epoch is from thorium_node_message_cache_get_epoch), since it may
+ * have been made before the change.
+ */
+void thorium_node_message_cache_put(struct thorium_node_message_cache *self,
+                struct thorium_cache_tag *tag, struct thorium_message *reply_message,
+                uint64_t epoch);
+
+void thorium_node_message_cache_add_rule(struct thorium_node_message_cache *self,
+                int invalidating_action, int request_action, int ignored_bytes);
+
+/*
+ * Apply the invalidation rules to a message sent to a destination.
+ */
+void thorium_node_message_cache_invalidate(struct thorium_node_message_cache *self,
+                int destination, struct thorium_message *message);
+
+/*
+ * Drop the cached reply of the request with action request_action and
+ * buffer buffer sent to a destination.
+ */
+void thorium_node_message_cache_invalidate_request(struct thorium_node_message_cache *self,
+                int destination, int request_action, int count, void *buffer);
+
+uint64_t thorium_node_message_cache_size(struct thorium_node_message_cache *self);
+uint64_t thorium_node_message_cache_byte_count(struct thorium_node_message_cache *self);
+
+/*
+ * \return the number of replies that were not saved because of an
+ * invalidation after their request
+ */
+uint64_t thorium_node_message_cache_stale_reply_count(struct thorium_node_message_cache *self);
+void thorium_node_message_cache_get_profile(struct thorium_node_message_cache *self,
+                uint64_t *hit_count, uint64_t *miss_count,
+                uint64_t *eviction_count, uint64_t *invalidation_count);
+
+#endif
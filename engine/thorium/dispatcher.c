@@ -10,6 +10,8 @@
 #include <core/structures/map_iterator.h>
 
 #include <core/system/debugger.h>
+#include <core/system/memory.h>
+#include <core/system/memory_pool.h>
 
 #include <stdlib.h>
 #include <stdio.h>
@@ -20,6 +22,8 @@
 #define DISPATCHER_IS_VERBOSE
 */
 
+#define THORIUM_DISPATCHER_INITIAL_ENTRY_CAPACITY 16
+
 
 struct thorium_parent_key {
     int parent_actor;
@@ -37,6 +41,10 @@ thorium_actor_receive_fn_t thorium_dispatcher_get(struct thorium_dispatcher *sel
 thorium_actor_receive_fn_t thorium_dispatcher_get_with_parent(struct thorium_dispatcher *self,
                 struct thorium_message *message);
 
+static struct thorium_dispatcher_entry *thorium_dispatcher_find_entry(struct thorium_dispatcher *self,
+                int action);
+static void thorium_dispatcher_update_entry(struct thorium_dispatcher *self, int action);
+
 void thorium_dispatcher_init(struct thorium_dispatcher *self,
                 struct core_memory_pool *pool)
 {
@@ -47,6 +55,10 @@ void thorium_dispatcher_init(struct thorium_dispatcher *self,
     core_map_init(&self->parent_routes, sizeof(struct thorium_parent_key),
                     sizeof(thorium_actor_receive_fn_t));
     core_map_set_memory_pool(&self->routes, self->pool);
+
+    self->entries = NULL;
+    self->entry_count = 0;
+    self->entry_capacity = 0;
 }
 
 void thorium_dispatcher_destroy(struct thorium_dispatcher *self)
@@ -85,6 +97,14 @@ void thorium_dispatcher_destroy(struct thorium_dispatcher *self)
 
     core_map_destroy(&self->routes);
     core_map_destroy(&self->parent_routes);
+
+    if (self->entries != NULL) {
+        core_memory_pool_free(self->pool, self->entries);
+        self->entries = NULL;
+    }
+
+    self->entry_count = 0;
+    self->entry_capacity = 0;
 }
 
 void thorium_dispatcher_add_action(struct thorium_dispatcher *self, int tag,
@@ -150,12 +170,15 @@ void thorium_dispatcher_add_action(struct thorium_dispatcher *self, int tag,
     }
 
     thorium_route_destroy(&new_route);
+
+    thorium_dispatcher_update_entry(self, tag);
 }
 
 int thorium_dispatcher_dispatch(struct thorium_dispatcher *self, struct thorium_actor *actor,
                 struct thorium_message *message)
 {
     thorium_actor_receive_fn_t handler;
+    struct thorium_dispatcher_entry *entry;
     int tag;
     int source;
 
@@ -184,10 +207,23 @@ int thorium_dispatcher_dispatch(struct thorium_dispatcher *self, struct thorium_
      *
      * This look-up is performed first.
      */
-    if (handler == NULL) {
+    if (core_map_size(&self->parent_routes) > 0) {
         handler = thorium_dispatcher_get_with_parent(self, message);
     }
 
+    /*
+     * Most actions have one route for any source.
+     */
+    if (handler == NULL) {
+        entry = thorium_dispatcher_find_entry(self, tag);
+
+        if (entry == NULL) {
+            return 0;
+        }
+
+        handler = entry->handler;
+    }
+
 
     /*
      * First try to get a route using
@@ -305,6 +341,106 @@ void thorium_dispatcher_print(struct thorium_dispatcher *self)
 {
 }
 
+static struct thorium_dispatcher_entry *thorium_dispatcher_find_entry(struct thorium_dispatcher *self,
+                int action)
+{
+    struct thorium_dispatcher_entry *entries;
+    int first;
+    int last;
+    int middle;
+
+    entries = self->entries;
+    first = 0;
+    last = self->entry_count - 1;
+
+    while (first <= last) {
+        middle = first + (last - first) / 2;
+
+        if (entries[middle].action == action) {
+            return entries + middle;
+        } else if (entries[middle].action < action) {
+            first = middle + 1;
+        } else {
+            last = middle - 1;
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * Add the action to the sorted array, or update its handler.
+ */
+static void thorium_dispatcher_update_entry(struct thorium_dispatcher *self, int action)
+{
+    struct thorium_dispatcher_entry *entry;
+    struct thorium_dispatcher_entry *new_entries;
+    struct core_map *map;
+    struct core_vector *vector;
+    struct thorium_route *route;
+    thorium_actor_receive_fn_t handler;
+    int position;
+    int source;
+
+    /*
+     * The handler can be used directly only if there is one route for
+     * any source and without a condition.
+     */
+    handler = NULL;
+    map = core_map_get(&self->routes, &action);
+    vector = NULL;
+    source = THORIUM_ACTOR_ANYBODY;
+
+    if (map != NULL && core_map_size(map) == 1) {
+        vector = core_map_get(map, &source);
+    }
+
+    if (vector != NULL && core_vector_size(vector) == 1) {
+        route = core_vector_at(vector, 0);
+
+        if (thorium_route_test(route) == THORIUM_ROUTE_CONDITION_NONE) {
+            handler = thorium_route_handler(route);
+        }
+    }
+
+    entry = thorium_dispatcher_find_entry(self, action);
+
+    if (entry != NULL) {
+        entry->handler = handler;
+        return;
+    }
+
+    if (self->entry_count == self->entry_capacity) {
+        self->entry_capacity *= 2;
+
+        if (self->entry_capacity == 0) {
+            self->entry_capacity = THORIUM_DISPATCHER_INITIAL_ENTRY_CAPACITY;
+        }
+
+        new_entries = core_memory_pool_allocate(self->pool,
+                        self->entry_capacity * sizeof(struct thorium_dispatcher_entry));
+
+        if (self->entries != NULL) {
+            core_memory_copy(new_entries, self->entries,
+                        self->entry_count * sizeof(struct thorium_dispatcher_entry));
+            core_memory_pool_free(self->pool, self->entries);
+        }
+
+        self->entries = new_entries;
+    }
+
+    position = self->entry_count;
+
+    while (position > 0 && self->entries[position - 1].action > action) {
+        self->entries[position] = self->entries[position - 1];
+        --position;
+    }
+
+    self->entries[position].action = action;
+    self->entries[position].handler = handler;
+    ++self->entry_count;
+}
+
 void thorium_dispatcher_add_action_with_parent(struct thorium_dispatcher *self, int parent_actor, int parent_message,
                 thorium_actor_receive_fn_t handler)
 {
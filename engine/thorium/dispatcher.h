@@ -8,6 +8,15 @@
 
 struct core_memory_pool;
 
+/*
+ * An action with its handler. The handler is NULL if the
+ * action has routes for specific sources or with conditions.
+ */
+struct thorium_dispatcher_entry {
+    int action;
+    thorium_actor_receive_fn_t handler;
+};
+
 /*
  * A message dispatcher.
  *
@@ -17,11 +26,19 @@ struct core_memory_pool;
  * Check source
  * return handler
  *
+ * Registered actions are also kept in an array sorted by action.
+ * Most actions have only one route (any source, no condition), and
+ * their handler is found with a binary search in this array instead
+ * of 2 look-ups in the maps.
  */
 struct thorium_dispatcher {
     struct core_map routes;
     struct core_memory_pool *pool;
     struct core_map parent_routes;
+
+    struct thorium_dispatcher_entry *entries;
+    int entry_count;
+    int entry_capacity;
 };
 
 void thorium_dispatcher_init(struct thorium_dispatcher *self, struct core_memory_pool *pool);
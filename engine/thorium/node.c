@@ -44,6 +44,7 @@
 #include <unistd.h>
 
 #include <inttypes.h>
+#include <limits.h>
 
 #if 1
 #undef CORE_DEBUGGER_JITTER_DETECTION_START
@@ -115,9 +116,39 @@
 #define FLAG_PROFILE_MESSAGE_TRANSPORT      CORE_BITMAP_MAKE_FLAG(13)
 #define FLAG_USE_FREOPEN_FOR_STDOUT         CORE_BITMAP_MAKE_FLAG(14)
 #define FLAG_STARTED_INITIAL_ACTORS         CORE_BITMAP_MAKE_FLAG(15)
+#define FLAG_USE_NODE_MESSAGE_CACHE         CORE_BITMAP_MAKE_FLAG(16)
+#define FLAG_TRACE_EVENTS                   CORE_BITMAP_MAKE_FLAG(17)
+#define FLAG_PROFILE_ACTIONS                CORE_BITMAP_MAKE_FLAG(18)
 
 #define OPTION_USE_FREOPEN_STDOUT "-freopen-stdout"
 
+/*
+ * Size of the node message cache in MiB.
+ */
+#define OPTION_NODE_MESSAGE_CACHE_SIZE "-node-message-cache-size"
+
+/*
+ * Write binary events for each node
+ * (see scripts/event_tracer/convert-to-chrome-trace.py).
+ */
+#define OPTION_TRACE_EVENTS "-trace-events"
+
+/*
+ * The rings of events are drained every THORIUM_NODE_EVENT_DRAIN_PERIOD ticks.
+ */
+#define THORIUM_NODE_EVENT_DRAIN_PERIOD 64
+
+/*
+ * Keep histograms of handler times and message sizes
+ * for each (script, action).
+ */
+#define OPTION_PROFILE_ACTIONS "-enable-action-profiler"
+
+/*
+ * Number of actions printed in each report.
+ */
+#define THORIUM_NODE_PRINTED_ACTION_PROFILE_COUNT 10
+
 /*
  * Enable the regulator.
  */
@@ -161,12 +192,6 @@ static int thorium_node_send_system(struct thorium_node *self, struct thorium_me
 static void thorium_node_do_message_triage(struct thorium_node *self);
 static void thorium_node_recycle_message(struct thorium_node *self, struct thorium_message *message);
 
-/*
- * Generate an actor name.
- */
-static int thorium_node_generate_random_name(struct thorium_node *self,
-                int minimal_value, int maximum_value);
-
 static void thorium_node_inject_outbound_buffer(struct thorium_node *self, struct thorium_worker_buffer *worker_buffer);
 
 static void thorium_node_send_to_node_empty(struct thorium_node *self, int destination, int tag);
@@ -179,7 +204,7 @@ static void thorium_node_inject_message_in_worker_pool(struct thorium_node *self
 static void *thorium_node_main(void *node1);
 static int thorium_node_running(struct thorium_node *self);
 static void thorium_node_start_send_thread(struct thorium_node *self);
-static int thorium_node_generate_name(struct thorium_node *self);
+static int thorium_node_generate_name(struct thorium_node *self, int index);
 
 static int thorium_node_actor_node(struct thorium_node *self, int name);
 static int thorium_node_actor_index(struct thorium_node *self, int name);
@@ -229,6 +254,17 @@ void thorium_node_tracepoint(struct thorium_node *self, const char *event);
 #define MAXIMUM_ACTOR_RATIO 100
 
 void thorium_node_configure_actor_ratio(struct thorium_node *self);
+void thorium_node_configure_message_cache(struct thorium_node *self);
+static void thorium_node_print_message_cache(struct thorium_node *self);
+
+static void thorium_node_configure_event_tracer(struct thorium_node *self);
+static struct thorium_event_tracer *thorium_node_get_event_tracer(struct thorium_node *self);
+static void thorium_node_drain_events(struct thorium_node *self);
+static void thorium_node_close_event_file(struct thorium_node *self);
+
+static void thorium_node_configure_action_profiler(struct thorium_node *self);
+static void thorium_node_print_action_profiles(struct thorium_node *self);
+static void thorium_node_write_action_profiles(struct thorium_node *self);
 
 void thorium_node_init(struct thorium_node *node, int *argc, char ***argv)
 {
@@ -310,6 +346,7 @@ void thorium_node_init(struct thorium_node *node, int *argc, char ***argv)
     CORE_BITMAP_CLEAR_FLAG(node->flags, FLAG_EXAMINE);
     CORE_BITMAP_CLEAR_FLAG(node->flags, FLAG_ENABLE_ACTOR_LOAD_PROFILES);
     CORE_BITMAP_CLEAR_FLAG(node->flags, FLAG_MULTIPLEXER_IS_DISABLED);
+    CORE_BITMAP_CLEAR_FLAG(node->flags, FLAG_USE_NODE_MESSAGE_CACHE);
 
     thorium_node_global_self = node;
 
@@ -318,10 +355,6 @@ void thorium_node_init(struct thorium_node *node, int *argc, char ***argv)
     node->last_report_time = 0;
     node->last_auto_scaling = node->start_time;
 
-#ifdef THORIUM_NODE_USE_DETERMINISTIC_ACTOR_NAMES
-    node->current_actor_name = THORIUM_ACTOR_NOBODY;
-#endif
-
     /*
      * Build memory pools
      */
@@ -532,7 +565,16 @@ void thorium_node_init(struct thorium_node *node, int *argc, char ***argv)
 
     thorium_worker_pool_init(&node->worker_pool, workers, node);
 
-    actor_capacity = 131072;
+    /*
+     * The names of all the nodes must fit in an int.
+     */
+    if (!thorium_actor_name_codec_init(&node->actor_name_codec, node->name, node->nodes)) {
+        thorium_printf("Error: node %d can not name actors with %d nodes\n",
+                        node->name, node->nodes);
+        core_exit_with_error();
+    }
+
+    actor_capacity = thorium_actor_name_codec_slots(&node->actor_name_codec);
     node->dead_actors = 0;
     node->alive_actors = 0;
 
@@ -543,10 +585,8 @@ void thorium_node_init(struct thorium_node *node, int *argc, char ***argv)
      */
     core_vector_reserve(&node->actors, actor_capacity);
 
-    /*
-     * Multiply by 2 to avoid resizing
-     */
-    core_map_init_with_capacity(&node->actor_names, sizeof(int), sizeof(int), actor_capacity * 2);
+    core_vector_init(&node->actor_generations, sizeof(int));
+    core_vector_reserve(&node->actor_generations, actor_capacity);
 
     core_vector_init(&node->initial_actors, sizeof(int));
 
@@ -606,6 +646,10 @@ void thorium_node_init(struct thorium_node *node, int *argc, char ***argv)
         CORE_BITMAP_SET_FLAG(node->flags, FLAG_PROFILE_MESSAGE_TRANSPORT);
     }
 
+    thorium_node_configure_message_cache(node);
+    thorium_node_configure_event_tracer(node);
+    thorium_node_configure_action_profiler(node);
+
     if (node->name == 0
                     && thorium_node_must_print_data(node)) {
 
@@ -648,6 +692,13 @@ void thorium_node_destroy(struct thorium_node *node)
 
     thorium_transport_profiler_destroy(&node->transport_profiler);
 
+    if (CORE_BITMAP_GET_FLAG(node->flags, FLAG_USE_NODE_MESSAGE_CACHE)) {
+        thorium_node_message_cache_destroy(&node->message_cache);
+    }
+
+    thorium_event_tracer_destroy(&node->event_tracer);
+    thorium_event_tracer_destroy(&node->send_event_tracer);
+
     core_timer_destroy(&node->timer);
 
     if (CORE_BITMAP_GET_FLAG(node->flags, FLAG_EXAMINE))
@@ -677,7 +728,8 @@ void thorium_node_destroy(struct thorium_node *node)
 
     core_set_destroy(&node->auto_scaling_actors);
 
-    core_map_destroy(&node->actor_names);
+    core_vector_destroy(&node->actor_generations);
+    thorium_actor_name_codec_destroy(&node->actor_name_codec);
 
     /*printf("BEFORE DESTROY\n");*/
     core_vector_destroy(&node->initial_actors);
@@ -889,7 +941,6 @@ int thorium_node_spawn_state(struct thorium_node *node, void *state,
 {
     struct thorium_actor *actor;
     int name;
-    int *bucket;
     int index;
 
     /* can not spawn any more actor
@@ -908,10 +959,9 @@ int thorium_node_spawn_state(struct thorium_node *node, void *state,
     index = thorium_node_allocate_actor_index(node);
     actor = (struct thorium_actor *)core_vector_at(&node->actors, index);
 
-    /* actors have random names to enforce
-     * the acquaintance paradigm
+    /* the name is given by the slot and its generation
      */
-    name = thorium_node_generate_name(node);
+    name = thorium_node_generate_name(node, index);
 
     thorium_actor_init(actor, state, script, name, node);
 
@@ -919,19 +969,13 @@ int thorium_node_spawn_state(struct thorium_node *node, void *state,
         thorium_actor_enable_profiler(actor);
     }
 
-    /* register the actor name
-     */
-    bucket = core_map_add(&node->actor_names, &name);
-    *bucket = index;
-
     /*
-     * Make the name visible to all threads
+     * Make the actor visible to all threads
      */
     core_memory_fence();
 
 #ifdef THORIUM_NODE_DEBUG_SPAWN
-    thorium_printf("DEBUG added Actor %d, index is %d, bucket: %p\n", name, index,
-                    (void *)bucket);
+    thorium_printf("DEBUG added Actor %d, index is %d\n", name, index);
 #endif
 
     node->alive_actors++;
@@ -959,71 +1003,30 @@ static int thorium_node_allocate_actor_index(struct thorium_node *node)
     index = (int)core_vector_size(&node->actors);
     core_vector_resize(&node->actors, core_vector_size(&node->actors) + 1);
 
+    /*
+     * The generation of a new slot is set before its actor gets a
+     * name.
+     */
+    core_vector_resize(&node->actor_generations, index + 1);
+    core_vector_set_int(&node->actor_generations, index, THORIUM_ACTOR_NAME_CODEC_FIRST_GENERATION);
+
     return index;
 }
 
-static int thorium_node_generate_name(struct thorium_node *node)
+static int thorium_node_generate_name(struct thorium_node *node, int index)
 {
-    int minimal_value;
-    int maximum_value;
+    int generation;
     int name;
-    struct thorium_actor *actor;
-    int node_name;
-    int difference;
-    int nodes;
-
-#ifdef THORIUM_NODE_DEBUG
-    thorium_printf("DEBUG thorium_node_generate_name\n");
-#endif
-
-#ifdef THORIUM_NODE_SIMPLE_INITIAL_ACTOR_NAMES
-    if (thorium_node_actors(node) == 0) {
-        return thorium_node_name(node);
-    }
-#endif
-
-    node_name = thorium_node_name(node);
-    actor = NULL;
-    name = THORIUM_ACTOR_NOBODY;
-
-    /* reserve  the first numbers
-     */
-    minimal_value = 4 * thorium_node_nodes(node) + thorium_node_name(node) + 1000000;
-    maximum_value = 2000000000;
-
-#ifdef THORIUM_NODE_DEBUG
-    thorium_printf("DEBUG assigning name\n");
-#endif
-
-    nodes = thorium_node_nodes(node);
 
-    /*
-     * Find a name that is not already used.
-     */
-    while (actor != NULL || name < 0) {
-        name = thorium_node_generate_random_name(node, minimal_value, maximum_value);
-
-        difference = node_name - name % node->nodes;
-        /* add the difference */
-        name += difference;
-
-        /* disallow names between 0 and nodes - 1
-         */
-        if (name < nodes) {
-            continue;
-        }
+    generation = core_vector_at_as_int(&node->actor_generations, index);
 
-        actor = thorium_node_get_actor_from_name(node, name);
-
-        /*printf("DEBUG trying %d... %p\n", name, (void *)actor);*/
-    }
+    name = thorium_actor_name_codec_encode(&node->actor_name_codec, index, generation);
 
 #ifdef THORIUM_NODE_DEBUG_SPAWN
-    thorium_printf("DEBUG node %d assigned name %d\n", node->name, name);
+    thorium_printf("DEBUG node %d assigned name %d (slot %d, generation %d)\n",
+                    node->name, name, index, generation);
 #endif
 
-    /*return node->name + node->nodes * thorium_node_actors(node);*/
-
     return name;
 }
 
@@ -1096,6 +1099,17 @@ int thorium_node_run(struct thorium_node *node)
         core_thread_join(&node->thread);
     }
 
+    /*
+     * All the threads are stopped, so the rings can be drained one last time.
+     */
+    if (CORE_BITMAP_GET_FLAG(node->flags, FLAG_TRACE_EVENTS)) {
+        thorium_node_close_event_file(node);
+    }
+
+    if (CORE_BITMAP_GET_FLAG(node->flags, FLAG_PROFILE_ACTIONS)) {
+        thorium_node_write_action_profiles(node);
+    }
+
     /* Always print counters at the end, this is useful.
      */
     if (CORE_BITMAP_GET_FLAG(node->flags, FLAG_PRINT_COUNTERS)) {
@@ -1743,27 +1757,29 @@ static void thorium_node_inject_message_in_worker_pool(struct thorium_node *node
     tracepoint(thorium_node, inject_exit, node->name, node->tick);
 }
 
+/*
+ * \return the slot of a living actor, or -1 if the name is stale or
+ * is not on this node
+ */
 static int thorium_node_actor_index(struct thorium_node *node, int name)
 {
-    int *bucket;
     int index;
+    int generation;
 
-#ifdef THORIUM_NODE_DEBUG
-    thorium_printf("DEBUG calling core_map with pointer to %d, entries %d\n",
-                    name, (int)core_map_table_size(&node->actor_names));
-#endif
-
-    bucket = core_map_get(&node->actor_names, &name);
+    if (!thorium_actor_name_codec_decode(&node->actor_name_codec, name, &index, &generation)) {
+        return -1;
+    }
 
 #ifdef THORIUM_NODE_DEBUG
-    thorium_printf("DEBUG thorium_node_actor_index %d %p\n", name, (void *)bucket);
+    thorium_printf("DEBUG thorium_node_actor_index %d slot %d generation %d\n",
+                    name, index, generation);
 #endif
 
-    if (bucket == NULL) {
+    if (index >= core_vector_size(&node->actor_generations)
+                    || core_vector_at_as_int(&node->actor_generations, index) != generation) {
         return -1;
     }
 
-    index = *bucket;
     return index;
 }
 
@@ -1786,10 +1802,8 @@ void thorium_node_notify_death(struct thorium_node *node, struct thorium_actor *
 {
     void *state;
     int name;
-
-#ifdef THORIUM_NODE_REUSE_DEAD_INDICES
     int index;
-#endif
+    int generation;
 
     /* int name; */
     /*int index;*/
@@ -1812,14 +1826,11 @@ void thorium_node_notify_death(struct thorium_node *node, struct thorium_actor *
                     thorium_actor_script(actor));
 #endif
 
-#ifdef THORIUM_NODE_REUSE_DEAD_INDICES
     index = thorium_node_actor_index(node, name);
 
 #ifdef THORIUM_NODE_DEBUG_SPAWN
-    thorium_printf("DEBUG node/%d THORIUM_NODE_REUSE_DEAD_INDICES push index %d\n",
+    thorium_printf("DEBUG node/%d thorium_node_notify_death index %d\n",
                    thorium_node_name(node), index);
-#endif
-
 #endif
 
     state = thorium_actor_concrete_actor(actor);
@@ -1848,12 +1859,13 @@ void thorium_node_notify_death(struct thorium_node *node, struct thorium_actor *
     core_memory_pool_free(&node->actor_memory_pool, state);
     state = NULL;
 
-    /* remove the name from the registry */
-    /* maybe a lock is needed for this
-     * because spawn also access this attribute
+    /* make the name stale: the next actor in this slot has the
+     * next generation
      */
+    generation = core_vector_at_as_int(&node->actor_generations, index);
+    generation = thorium_actor_name_codec_next_generation(&node->actor_name_codec, generation);
 
-    core_map_delete(&node->actor_names, &name);
+    core_vector_set_int(&node->actor_generations, index, generation);
 
     /*
      * Make this change visible
@@ -1913,6 +1925,15 @@ int thorium_node_worker_count(struct thorium_node *node)
     return thorium_worker_pool_worker_count(&node->worker_pool);
 }
 
+struct thorium_node_message_cache *thorium_node_get_message_cache(struct thorium_node *self)
+{
+    if (!CORE_BITMAP_GET_FLAG(self->flags, FLAG_USE_NODE_MESSAGE_CACHE)) {
+        return NULL;
+    }
+
+    return &self->message_cache;
+}
+
 int thorium_node_argc(struct thorium_node *node)
 {
     return node->argc;
@@ -2161,19 +2182,19 @@ static void thorium_node_toggle_debug_mode(struct thorium_node *self)
 #if 0
 static void thorium_node_reset_actor_counters(struct thorium_node *node)
 {
-    struct core_map_iterator iterator;
-    int *name;
     struct thorium_actor *actor;
+    int i;
 
-    core_map_iterator_init(&iterator, &node->actor_names);
+    for (i = 0; i < core_vector_size(&node->actors); ++i) {
 
-    while (core_map_iterator_next(&iterator, (void **)&name, NULL)) {
+        actor = core_vector_at(&node->actors, i);
 
-        actor = thorium_node_get_actor_from_name(node, *name);
+        if (thorium_actor_dead(actor)) {
+            continue;
+        }
 
         thorium_actor_reset_counters(actor);
     }
-    core_map_iterator_destroy(&iterator);
 }
 #endif
 
@@ -2290,6 +2311,7 @@ static void thorium_node_run_loop(struct thorium_node *node)
     char send_in_thread;
     char use_transport;
     char run_in_main_thread;
+    int trace_events;
 
 #ifdef THORIUM_NODE_ENABLE_INSTRUMENTATION
     /*int period;*/
@@ -2311,6 +2333,7 @@ static void thorium_node_run_loop(struct thorium_node *node)
                                 FLAG_SEND_IN_THREAD);
     use_transport = CORE_BITMAP_GET_FLAG(node->flags, FLAG_USE_TRANSPORT);
     run_in_main_thread = CORE_BITMAP_GET_FLAG(node->flags, FLAG_WORKER_IN_MAIN_THREAD);
+    trace_events = CORE_BITMAP_GET_FLAG(node->flags, FLAG_TRACE_EVENTS);
 
     while (credits > 0) {
 
@@ -2452,6 +2475,10 @@ static void thorium_node_run_loop(struct thorium_node *node)
 
         tracepoint(thorium_node, run_loop_do_triage, node->name, node->tick);
 
+        if (trace_events && (node->tick % THORIUM_NODE_EVENT_DRAIN_PERIOD) == 0) {
+            thorium_node_drain_events(node);
+        }
+
         CORE_DEBUGGER_JITTER_DETECTION_END(node_test, 0);
 
         CORE_DEBUGGER_JITTER_DETECTION_END(node_main_loop, 0);
@@ -2780,48 +2807,6 @@ void thorium_node_resolve(struct thorium_node *self, struct thorium_message *mes
     thorium_message_set_routing_destination_node(message, node_name);
 }
 
-static int thorium_node_generate_random_name(struct thorium_node *self,
-                int minimal_value, int maximum_value)
-{
-#if defined(THORIUM_NODE_USE_DETERMINISTIC_ACTOR_NAMES)
-
-    int name;
-    int stride;
-
-    if (self->current_actor_name < minimal_value
-                    || self->current_actor_name > maximum_value
-                    || self->current_actor_name == THORIUM_ACTOR_NOBODY) {
-
-        self->current_actor_name = minimal_value;
-    }
-
-    stride = thorium_node_nodes(self);
-
-    name = self->current_actor_name;
-    self->current_actor_name += stride;
-
-    return name;
-
-#elif defined(USE_RANDOM_ACTOR_NAMES)
-    /*
-     * On BGQ, RAND_MAX is:
-     *
-     * > [harms@vestalac1 ~]$ echo -e "#include <stdlib.h>\nunsigned long long
-     * > rand_max = RAND_MAX;" | powerpc64-bgq-linux-gcc -E - | tail -1
-     * > unsigned long long rand_max = 2147483647;Q
-     *
-     * (thanks to Harms, Kevin N. at ALCF)
-     */
-    int name;
-    int range;
-
-    range = maximum_value - minimal_value;
-    name = rand_r(&node->random_seed) % range + minimal_value;
-    return name;
-
-#endif
-}
-
 void thorium_node_send_with_transport(struct thorium_node *self, struct thorium_message *message)
 {
 #ifdef CORE_DEBUGGER_ASSERT_ENABLED
@@ -2843,6 +2828,15 @@ void thorium_node_send_with_transport(struct thorium_node *self, struct thorium_
 
     thorium_transport_send(&self->transport, message);
 
+    if (CORE_BITMAP_GET_FLAG(self->flags, FLAG_TRACE_EVENTS)) {
+        thorium_event_tracer_record(thorium_node_get_event_tracer(self),
+                        THORIUM_TRACE_EVENT_TRANSPORT_SEND,
+                        thorium_message_source(message),
+                        thorium_message_destination_node(message),
+                        thorium_message_action(message),
+                        thorium_message_count(message));
+    }
+
 #ifdef THORIUM_NODE_USE_COUNTERS
     core_counter_add(&self->counter, CORE_COUNTER_SENT_MESSAGES_NOT_TO_SELF, 1);
     core_counter_add(&self->counter, CORE_COUNTER_SENT_BYTES_NOT_TO_SELF,
@@ -3009,6 +3003,12 @@ static void thorium_node_receive_messages(struct thorium_node *node)
 #endif
         tracepoint(thorium_message, node_receive, &message);
 
+        THORIUM_EVENT_TRACER_RECORD(&node->event_tracer, THORIUM_TRACE_EVENT_TRANSPORT_RECEIVE,
+                        thorium_message_destination(&message),
+                        thorium_message_source_node(&message),
+                        thorium_message_action(&message),
+                        thorium_message_count(&message));
+
 #ifdef THORIUM_NODE_USE_COUNTERS
         core_counter_add(&node->counter, CORE_COUNTER_RECEIVED_MESSAGES_NOT_FROM_SELF, 1);
         core_counter_add(&node->counter, CORE_COUNTER_RECEIVED_BYTES_NOT_FROM_SELF,
@@ -3207,6 +3207,9 @@ void thorium_node_print_information(struct thorium_node *self)
                     thorium_transport_get_active_request_count(&self->transport)
           );
 
+    thorium_node_print_message_cache(self);
+    thorium_node_print_action_profiles(self);
+
     /*
      * Update state.
      */
@@ -3383,3 +3386,290 @@ struct thorium_worker *thorium_node_get_exporter_worker(struct thorium_node *sel
 
     return worker_for_multiplexer;
 }
+
+void thorium_node_configure_message_cache(struct thorium_node *self)
+{
+    int mebibytes;
+    uint64_t byte_count;
+
+    if (!core_command_has_argument(self->argc, self->argv, OPTION_NODE_MESSAGE_CACHE_SIZE)) {
+        return;
+    }
+
+    mebibytes = core_command_get_argument_value_int(self->argc, self->argv,
+                    OPTION_NODE_MESSAGE_CACHE_SIZE);
+
+    if (mebibytes <= 0) {
+        return;
+    }
+
+    byte_count = mebibytes;
+    byte_count *= 1024 * 1024;
+
+    thorium_node_message_cache_init(&self->message_cache, byte_count);
+    CORE_BITMAP_SET_FLAG(self->flags, FLAG_USE_NODE_MESSAGE_CACHE);
+}
+
+static void thorium_node_print_message_cache(struct thorium_node *self)
+{
+    uint64_t hit_count;
+    uint64_t miss_count;
+    uint64_t eviction_count;
+    uint64_t invalidation_count;
+    double hit_ratio;
+
+    if (!CORE_BITMAP_GET_FLAG(self->flags, FLAG_USE_NODE_MESSAGE_CACHE)) {
+        return;
+    }
+
+    thorium_node_message_cache_get_profile(&self->message_cache, &hit_count, &miss_count,
+                    &eviction_count, &invalidation_count);
+
+    hit_ratio = 0;
+
+    if (hit_count + miss_count > 0) {
+        hit_ratio = (0.0 + hit_count) / (hit_count + miss_count);
+    }
+
+    thorium_printf("[thorium] node %d MESSAGE_CACHE"
+                    " EntryCount: %" PRIu64
+                    " ByteCount: %" PRIu64
+                    " HitCount: %" PRIu64
+                    " MissCount: %" PRIu64
+                    " HitRatio: %.4f"
+                    " EvictionCount: %" PRIu64
+                    " InvalidationCount: %" PRIu64
+                    " StaleReplyCount: %" PRIu64
+                    "\n",
+                    self->name,
+                    thorium_node_message_cache_size(&self->message_cache),
+                    thorium_node_message_cache_byte_count(&self->message_cache),
+                    hit_count, miss_count, hit_ratio,
+                    eviction_count, invalidation_count,
+                    thorium_node_message_cache_stale_reply_count(&self->message_cache));
+}
+
+static void thorium_node_configure_event_tracer(struct thorium_node *self)
+{
+    char file_name[100];
+
+    thorium_event_tracer_init(&self->event_tracer, THORIUM_TRACE_THREAD_NODE);
+    thorium_event_tracer_init(&self->send_event_tracer, THORIUM_TRACE_THREAD_NODE_SEND);
+
+    self->written_event_count = 0;
+
+    if (!core_command_has_argument(self->argc, self->argv, OPTION_TRACE_EVENTS)) {
+        return;
+    }
+
+    sprintf(file_name, "node_%d_events.bin", self->name);
+
+    core_buffered_file_writer_init(&self->event_writer, file_name);
+    thorium_event_tracer_write_header(&self->event_writer, self->name);
+
+    thorium_event_tracer_enable(&self->event_tracer);
+
+    if (CORE_BITMAP_GET_FLAG(self->flags, FLAG_SEND_IN_THREAD)) {
+        thorium_event_tracer_enable(&self->send_event_tracer);
+    }
+
+    thorium_worker_pool_enable_event_tracer(&self->worker_pool);
+
+    CORE_BITMAP_SET_FLAG(self->flags, FLAG_TRACE_EVENTS);
+}
+
+/*
+ * Transport sends happen in the send thread when there is one,
+ * but the node thread also sends.
+ */
+static struct thorium_event_tracer *thorium_node_get_event_tracer(struct thorium_node *self)
+{
+    if (CORE_BITMAP_GET_FLAG(self->flags, FLAG_SEND_IN_THREAD)
+                    && pthread_equal(pthread_self(), self->thread.thread)) {
+        return &self->send_event_tracer;
+    }
+
+    return &self->event_tracer;
+}
+
+static void thorium_node_drain_events(struct thorium_node *self)
+{
+    uint64_t count;
+
+    count = thorium_worker_pool_drain_events(&self->worker_pool, &self->event_writer);
+    count += thorium_event_tracer_drain(&self->event_tracer, &self->event_writer);
+    count += thorium_event_tracer_drain(&self->send_event_tracer, &self->event_writer);
+
+    self->written_event_count += count;
+}
+
+static void thorium_node_close_event_file(struct thorium_node *self)
+{
+    uint64_t dropped_event_count;
+
+    thorium_node_drain_events(self);
+
+    dropped_event_count = thorium_worker_pool_dropped_event_count(&self->worker_pool);
+    dropped_event_count += thorium_event_tracer_dropped_event_count(&self->event_tracer);
+    dropped_event_count += thorium_event_tracer_dropped_event_count(&self->send_event_tracer);
+
+    thorium_printf("[thorium] node %d EVENT_TRACER"
+                    " WrittenEventCount: %" PRIu64
+                    " DroppedEventCount: %" PRIu64
+                    "\n",
+                    self->name,
+                    self->written_event_count,
+                    dropped_event_count);
+
+    core_buffered_file_writer_destroy(&self->event_writer);
+}
+
+static void thorium_node_configure_action_profiler(struct thorium_node *self)
+{
+    if (!core_command_has_argument(self->argc, self->argv, OPTION_PROFILE_ACTIONS)) {
+        return;
+    }
+
+    thorium_worker_pool_enable_action_profiler(&self->worker_pool);
+
+    CORE_BITMAP_SET_FLAG(self->flags, FLAG_PROFILE_ACTIONS);
+}
+
+/*
+ * The workers keep running, so the histograms of the report
+ * can be a few events behind.
+ */
+static void thorium_node_print_action_profiles(struct thorium_node *self)
+{
+    struct thorium_action_profiler profiler;
+    struct thorium_action_profile *profile;
+    struct thorium_script *script;
+    struct core_vector profiles;
+    uint64_t total_time;
+    uint64_t time;
+    double share;
+    int size;
+    int i;
+
+    if (!CORE_BITMAP_GET_FLAG(self->flags, FLAG_PROFILE_ACTIONS)) {
+        return;
+    }
+
+    thorium_action_profiler_init(&profiler);
+    thorium_action_profiler_enable(&profiler);
+    thorium_worker_pool_merge_action_profiles(&self->worker_pool, &profiler);
+
+    core_vector_init(&profiles, sizeof(struct thorium_action_profile *));
+    thorium_action_profiler_get_profiles(&profiler, &profiles);
+
+    size = core_vector_size(&profiles);
+    total_time = 0;
+
+    for (i = 0; i < size; ++i) {
+        profile = core_vector_at_as_void_pointer(&profiles, i);
+        total_time += core_log_histogram_sum(&profile->times);
+    }
+
+    thorium_printf("[thorium] node %d ACTION_PROFILER"
+                    " ActionCount: %d"
+                    " TotalTime: %" PRIu64 " ns"
+                    " LostEventCount: %" PRIu64
+                    "\n",
+                    self->name, size, total_time,
+                    thorium_action_profiler_lost_event_count(&profiler));
+
+    for (i = 0; i < size && i < THORIUM_NODE_PRINTED_ACTION_PROFILE_COUNT; ++i) {
+        profile = core_vector_at_as_void_pointer(&profiles, i);
+        script = thorium_node_find_script(self, profile->script);
+        time = core_log_histogram_sum(&profile->times);
+
+        share = 0;
+        if (total_time > 0)
+            share = 100.0 * time / total_time;
+
+        thorium_printf("[thorium] node %d ACTION_PROFILE"
+                        " Script: %s Action: 0x%x"
+                        " Count: %" PRIu64
+                        " Time: %" PRIu64 " ns (%.2f%%)"
+                        " p50/p99/max: %" PRIu64 "/%" PRIu64 "/%" PRIu64 " ns"
+                        " Size p50/p99: %" PRIu64 "/%" PRIu64 " B"
+                        "\n",
+                        self->name,
+                        script != NULL ? thorium_script_name(script) : "?",
+                        profile->action,
+                        core_log_histogram_count(&profile->times),
+                        time, share,
+                        core_log_histogram_get_percentile(&profile->times, 50),
+                        core_log_histogram_get_percentile(&profile->times, 99),
+                        core_log_histogram_maximum(&profile->times),
+                        core_log_histogram_get_percentile(&profile->sizes, 50),
+                        core_log_histogram_get_percentile(&profile->sizes, 99));
+    }
+
+    core_vector_destroy(&profiles);
+    thorium_action_profiler_destroy(&profiler);
+}
+
+/*
+ * Write all the actions in node_<name>_action_profile.txt
+ * once the workers are stopped.
+ */
+static void thorium_node_write_action_profiles(struct thorium_node *self)
+{
+    struct thorium_action_profiler profiler;
+    struct thorium_action_profile *profile;
+    struct thorium_script *script;
+    struct core_buffered_file_writer writer;
+    struct core_vector profiles;
+    char file_name[100];
+    int size;
+    int i;
+
+    thorium_action_profiler_init(&profiler);
+    thorium_action_profiler_enable(&profiler);
+    thorium_worker_pool_merge_action_profiles(&self->worker_pool, &profiler);
+
+    core_vector_init(&profiles, sizeof(struct thorium_action_profile *));
+    thorium_action_profiler_get_profiles(&profiler, &profiles);
+
+    sprintf(file_name, "node_%d_action_profile.txt", self->name);
+
+    core_buffered_file_writer_init(&writer, file_name);
+    core_buffered_file_writer_printf(&writer, "script\taction\tcount\ttotal_time"
+                    "\ttime_p50\ttime_p90\ttime_p99\ttime_max"
+                    "\ttotal_size\tsize_p50\tsize_p99\tsize_max\n");
+
+    size = core_vector_size(&profiles);
+
+    for (i = 0; i < size; ++i) {
+        profile = core_vector_at_as_void_pointer(&profiles, i);
+        script = thorium_node_find_script(self, profile->script);
+
+        core_buffered_file_writer_printf(&writer, "%s\t0x%x\t%" PRIu64 "\t%" PRIu64
+                        "\t%" PRIu64 "\t%" PRIu64 "\t%" PRIu64 "\t%" PRIu64
+                        "\t%" PRIu64 "\t%" PRIu64 "\t%" PRIu64 "\t%" PRIu64 "\n",
+                        script != NULL ? thorium_script_name(script) : "?",
+                        profile->action,
+                        core_log_histogram_count(&profile->times),
+                        core_log_histogram_sum(&profile->times),
+                        core_log_histogram_get_percentile(&profile->times, 50),
+                        core_log_histogram_get_percentile(&profile->times, 90),
+                        core_log_histogram_get_percentile(&profile->times, 99),
+                        core_log_histogram_maximum(&profile->times),
+                        core_log_histogram_sum(&profile->sizes),
+                        core_log_histogram_get_percentile(&profile->sizes, 50),
+                        core_log_histogram_get_percentile(&profile->sizes, 99),
+                        core_log_histogram_maximum(&profile->sizes));
+    }
+
+    core_buffered_file_writer_destroy(&writer);
+
+    thorium_printf("[thorium] node %d ACTION_PROFILER ActionCount: %d"
+                    " LostEventCount: %" PRIu64 " File: %s\n",
+                    self->name, size,
+                    thorium_action_profiler_lost_event_count(&profiler),
+                    file_name);
+
+    core_vector_destroy(&profiles);
+    thorium_action_profiler_destroy(&profiler);
+}
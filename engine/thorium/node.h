@@ -4,6 +4,7 @@
 
 #include "actor.h"
 #include "worker_pool.h"
+#include "actor_name_codec.h"
 
 #ifdef THORIUM_USE_CUSTOM_TRACEPOINTS
 #include "tracepoints/tracepoint_session.h"
@@ -11,6 +12,8 @@
 
 #include "transport/transport.h"
 
+#include "cache/node_message_cache.h"
+
 #include <core/structures/vector.h>
 #include <core/structures/queue.h>
 #include <core/structures/map.h>
@@ -47,11 +50,6 @@
 #define ACTION_THORIUM_NODE_ADD_INITIAL_ACTORS_REPLY (NODE_ACTION_BASE + 2)
 #define ACTION_THORIUM_NODE_START (NODE_ACTION_BASE + 3)
 
-/*
- * Use deterministic actor names.
- */
-#define THORIUM_NODE_USE_DETERMINISTIC_ACTOR_NAMES
-
 /*
  * Thorium product branding.
  */
@@ -119,7 +117,8 @@ struct thorium_node {
     struct core_set auto_scaling_actors;
     struct thorium_worker_pool worker_pool;
     struct thorium_transport_profiler transport_profiler;
-    struct core_map actor_names;
+    struct core_vector actor_generations;
+    struct thorium_actor_name_codec actor_name_codec;
     struct core_vector initial_actors;
     int received_initial_actors;
     int ready;
@@ -206,6 +205,22 @@ struct thorium_node {
      */
     struct core_memory_pool outbound_message_memory_pool;
 
+    /*
+     * Reply messages shared by the actors of the node
+     * (-node-message-cache-size).
+     */
+    struct thorium_node_message_cache message_cache;
+
+    /*
+     * Events of the node thread and of the send thread (-trace-events).
+     * The node thread writes the events of all the threads in
+     * node_<name>_events.bin.
+     */
+    struct thorium_event_tracer event_tracer;
+    struct thorium_event_tracer send_event_tracer;
+    struct core_buffered_file_writer event_writer;
+    uint64_t written_event_count;
+
     struct core_queue dead_indices;
 
     int provided;
@@ -244,10 +259,6 @@ struct thorium_node {
     time_t last_auto_scaling;
     time_t last_transport_event_time;
 
-#ifdef THORIUM_NODE_USE_DETERMINISTIC_ACTOR_NAMES
-    int current_actor_name;
-#endif
-
 #ifdef THORIUM_NODE_DEBUG_INJECTION
     int counter_allocated_node_inbound_buffers;
     int counter_allocated_node_outbound_buffers;
@@ -293,6 +304,11 @@ void thorium_node_notify_death(struct thorium_node *self, struct thorium_actor *
 int thorium_node_worker_count(struct thorium_node *self);
 int thorium_node_thread_count(struct thorium_node *self);
 
+/*
+ * \return the node message cache, or NULL if it is disabled
+ */
+struct thorium_node_message_cache *thorium_node_get_message_cache(struct thorium_node *self);
+
 int thorium_node_argc(struct thorium_node *self);
 char **thorium_node_argv(struct thorium_node *self);
 
@@ -54,6 +54,8 @@
 #define THORIUM_SCHEDULER_ENABLE_VERBOSITY
 */
 
+static int thorium_balancer_can_migrate(struct thorium_balancer *self);
+
 void thorium_balancer_init(struct thorium_balancer *self, struct thorium_worker_pool *pool)
 {
     self->pool = pool;
@@ -145,6 +147,11 @@ void thorium_balancer_balance(struct thorium_balancer *self)
     int script;
 #endif
 
+    if (!thorium_balancer_can_migrate(self)) {
+        self->last_migrations = 0;
+        return;
+    }
+
     node = thorium_worker_pool_get_node(self->pool);
 
     spawned_actors = thorium_node_get_counter(node, CORE_COUNTER_SPAWNED_ACTORS);
@@ -637,6 +644,10 @@ void thorium_balancer_migrate(struct thorium_balancer *self, struct thorium_migr
     int actor_name;
     struct thorium_actor *actor;
 
+    if (!thorium_balancer_can_migrate(self)) {
+        return;
+    }
+
     old_worker = thorium_migration_get_old_worker(migration);
     new_worker = thorium_migration_get_new_worker(migration);
     actor_name = thorium_migration_get_actor(migration);
@@ -1076,3 +1087,18 @@ int thorium_balancer_select_worker_script_round_robin(struct thorium_balancer *s
 
     return worker;
 }
+
+/*
+ * With -work-stealing, the thieves already move the load around, and
+ * only the assigned worker of an actor can take it out of its
+ * scheduler (the deque has one owner). A migration from the node
+ * thread would let two workers run the same actor, so there is none.
+ */
+static int thorium_balancer_can_migrate(struct thorium_balancer *self)
+{
+    struct thorium_worker *worker;
+
+    worker = thorium_worker_pool_get_worker(self->pool, 0);
+
+    return !thorium_worker_uses_work_stealing(worker);
+}
@@ -3,6 +3,7 @@
 
 #include "cfs_scheduler.h"
 #include "fifo_scheduler.h"
+#include "work_stealing_scheduler.h"
 
 #include <tracepoints/tracepoints.h>
 
@@ -18,12 +19,17 @@
  *
  * - THORIUM_CFS_SCHEDULER
  * - THORIUM_FIFO_SCHEDULER
+ * - THORIUM_WORK_STEALING_SCHEDULER
  */
 #define THORIUM_DEFAULT_SCHEDULER THORIUM_CFS_SCHEDULER
 
-void thorium_scheduler_init(struct thorium_scheduler *self, int node, int worker)
+void thorium_scheduler_init(struct thorium_scheduler *self, int type, int node, int worker)
 {
-    self->scheduler = THORIUM_DEFAULT_SCHEDULER;
+    if (type == THORIUM_SCHEDULER_DEFAULT) {
+        type = THORIUM_DEFAULT_SCHEDULER;
+    }
+
+    self->scheduler = type;
     self->node = node;
     self->worker = worker;
 
@@ -37,6 +43,8 @@ void thorium_scheduler_init(struct thorium_scheduler *self, int node, int worker
         self->implementation = &thorium_fifo_scheduler_implementation;
     } else if (self->scheduler == thorium_cfs_scheduler_implementation.identifier) {
         self->implementation = &thorium_cfs_scheduler_implementation;
+    } else if (self->scheduler == thorium_work_stealing_scheduler_implementation.identifier) {
+        self->implementation = &thorium_work_stealing_scheduler_implementation;
     }
 
     CORE_DEBUGGER_ASSERT(self->implementation != NULL);
@@ -90,6 +98,20 @@ int thorium_scheduler_size(struct thorium_scheduler *self)
     return self->implementation->size(self);
 }
 
+int thorium_scheduler_steal(struct thorium_scheduler *self, struct thorium_actor **actor)
+{
+    if (self->implementation->steal == NULL) {
+        return 0;
+    }
+
+    return self->implementation->steal(self, actor);
+}
+
+int thorium_scheduler_supports_stealing(struct thorium_scheduler *self)
+{
+    return self->implementation->steal != NULL;
+}
+
 void thorium_scheduler_print(struct thorium_scheduler *self)
 {
     self->implementation->print(self);
@@ -22,6 +22,11 @@ struct thorium_actor;
 #define THORIUM_SCHEDULER_STATUS_RECEIVING      3
 #define THORIUM_SCHEDULER_STATUS_IDLE           4
 
+/*
+ * Use the scheduler selected at compile time.
+ */
+#define THORIUM_SCHEDULER_DEFAULT -1
+
 /*
  * This is an actor scheduling queue.
  * Each worker has one of these.
@@ -34,7 +39,7 @@ struct thorium_scheduler {
     int worker;
 };
 
-void thorium_scheduler_init(struct thorium_scheduler *self, int node, int worker);
+void thorium_scheduler_init(struct thorium_scheduler *self, int type, int node, int worker);
 void thorium_scheduler_destroy(struct thorium_scheduler *self);
 
 int thorium_scheduler_enqueue(struct thorium_scheduler *self, struct thorium_actor *actor);
@@ -42,6 +47,16 @@ int thorium_scheduler_dequeue(struct thorium_scheduler *self, struct thorium_act
 
 int thorium_scheduler_size(struct thorium_scheduler *self);
 
+/*
+ * Take a ready actor from the scheduler of another worker.
+ * This can be called by any worker of the node.
+ *
+ * \return 0 if there is no actor or if the scheduler does not
+ * support stealing
+ */
+int thorium_scheduler_steal(struct thorium_scheduler *self, struct thorium_actor **actor);
+int thorium_scheduler_supports_stealing(struct thorium_scheduler *self);
+
 void thorium_scheduler_print(struct thorium_scheduler *self);
 void thorium_scheduler_print_type(struct thorium_scheduler *self);
 
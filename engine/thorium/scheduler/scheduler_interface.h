@@ -18,6 +18,12 @@ struct thorium_scheduler_interface {
     int (*dequeue)(struct thorium_scheduler *self, struct thorium_actor **actor);
     int (*size)(struct thorium_scheduler *self);
     void (*print)(struct thorium_scheduler *self);
+
+    /*
+     * Optional. This is called by other workers of the same node
+     * to take a ready actor.
+     */
+    int (*steal)(struct thorium_scheduler *self, struct thorium_actor **actor);
 };
 
 #endif
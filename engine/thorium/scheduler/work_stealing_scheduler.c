@@ -0,0 +1,175 @@
+
+#include "work_stealing_scheduler.h"
+
+#include "scheduler.h"
+
+#include <engine/thorium/actor.h>
+
+#include <core/system/atomic.h>
+#include <core/system/debugger.h>
+
+#include <stdio.h>
+#include <inttypes.h>
+
+static void thorium_work_stealing_scheduler_init(struct thorium_scheduler *self);
+static void thorium_work_stealing_scheduler_destroy(struct thorium_scheduler *self);
+
+static int thorium_work_stealing_scheduler_enqueue(struct thorium_scheduler *self, struct thorium_actor *actor);
+static int thorium_work_stealing_scheduler_dequeue(struct thorium_scheduler *self, struct thorium_actor **actor);
+static int thorium_work_stealing_scheduler_steal(struct thorium_scheduler *self, struct thorium_actor **actor);
+
+static int thorium_work_stealing_scheduler_size(struct thorium_scheduler *self);
+static void thorium_work_stealing_scheduler_print(struct thorium_scheduler *self);
+
+static void thorium_work_stealing_scheduler_refill(struct thorium_work_stealing_scheduler *self);
+
+struct thorium_scheduler_interface thorium_work_stealing_scheduler_implementation = {
+    .identifier = THORIUM_WORK_STEALING_SCHEDULER,
+    .name = "work_stealing_scheduler",
+    .object_size = sizeof(struct thorium_work_stealing_scheduler),
+    .init = thorium_work_stealing_scheduler_init,
+    .destroy = thorium_work_stealing_scheduler_destroy,
+    .enqueue = thorium_work_stealing_scheduler_enqueue,
+    .dequeue = thorium_work_stealing_scheduler_dequeue,
+    .size = thorium_work_stealing_scheduler_size,
+    .print = thorium_work_stealing_scheduler_print,
+    .steal = thorium_work_stealing_scheduler_steal
+};
+
+static void thorium_work_stealing_scheduler_init(struct thorium_scheduler *self)
+{
+    struct thorium_work_stealing_scheduler *concrete_self;
+
+    concrete_self = self->concrete_self;
+
+    core_work_stealing_deque_init(&concrete_self->deque, THORIUM_WORK_STEALING_SCHEDULER_CAPACITY);
+    core_queue_init(&concrete_self->overflow, sizeof(struct thorium_actor *));
+
+    concrete_self->dequeue_operations = 0;
+    concrete_self->steal_operations = 0;
+}
+
+static void thorium_work_stealing_scheduler_destroy(struct thorium_scheduler *self)
+{
+    struct thorium_work_stealing_scheduler *concrete_self;
+
+    concrete_self = self->concrete_self;
+
+    core_work_stealing_deque_destroy(&concrete_self->deque);
+    core_queue_destroy(&concrete_self->overflow);
+}
+
+static int thorium_work_stealing_scheduler_enqueue(struct thorium_scheduler *self, struct thorium_actor *actor)
+{
+    struct thorium_work_stealing_scheduler *concrete_self;
+
+    CORE_DEBUGGER_ASSERT(actor != NULL);
+
+    concrete_self = self->concrete_self;
+
+    /*
+     * Keep the FIFO order when the overflow is used.
+     */
+    if (core_queue_empty(&concrete_self->overflow)
+                    && core_work_stealing_deque_push(&concrete_self->deque, actor)) {
+        return 1;
+    }
+
+    return core_queue_enqueue(&concrete_self->overflow, &actor);
+}
+
+static int thorium_work_stealing_scheduler_dequeue(struct thorium_scheduler *self, struct thorium_actor **actor)
+{
+    struct thorium_work_stealing_scheduler *concrete_self;
+    void *item;
+
+    concrete_self = self->concrete_self;
+
+    thorium_work_stealing_scheduler_refill(concrete_self);
+
+    /*
+     * Take the oldest actor. If a thief wins the race for the top,
+     * the newest actor is taken instead.
+     */
+    if (core_work_stealing_deque_steal(&concrete_self->deque, &item)
+                    || core_work_stealing_deque_pop(&concrete_self->deque, &item)) {
+
+        *actor = item;
+        ++concrete_self->dequeue_operations;
+
+        return 1;
+    }
+
+    if (core_queue_dequeue(&concrete_self->overflow, actor)) {
+        ++concrete_self->dequeue_operations;
+
+        return 1;
+    }
+
+    return 0;
+}
+
+/*
+ * This is called by other workers.
+ */
+static int thorium_work_stealing_scheduler_steal(struct thorium_scheduler *self, struct thorium_actor **actor)
+{
+    struct thorium_work_stealing_scheduler *concrete_self;
+    void *item;
+
+    concrete_self = self->concrete_self;
+
+    if (!core_work_stealing_deque_steal(&concrete_self->deque, &item)) {
+        return 0;
+    }
+
+    *actor = item;
+    core_atomic_add(&concrete_self->steal_operations, 1);
+
+    return 1;
+}
+
+static int thorium_work_stealing_scheduler_size(struct thorium_scheduler *self)
+{
+    struct thorium_work_stealing_scheduler *concrete_self;
+
+    concrete_self = self->concrete_self;
+
+    return core_work_stealing_deque_size(&concrete_self->deque)
+            + core_queue_size(&concrete_self->overflow);
+}
+
+static void thorium_work_stealing_scheduler_print(struct thorium_scheduler *self)
+{
+    struct thorium_work_stealing_scheduler *concrete_self;
+
+    concrete_self = self->concrete_self;
+
+    printf("node/%d worker/%d work_stealing_scheduler deque %d/%d overflow %d"
+                    " dequeue_operations %" PRIu64 " steal_operations %" PRIu64 "\n",
+                    self->node, self->worker,
+                    core_work_stealing_deque_size(&concrete_self->deque),
+                    core_work_stealing_deque_capacity(&concrete_self->deque),
+                    core_queue_size(&concrete_self->overflow),
+                    concrete_self->dequeue_operations,
+                    concrete_self->steal_operations);
+}
+
+/*
+ * Move actors from the overflow queue to the deque so that
+ * thieves can see them.
+ */
+static void thorium_work_stealing_scheduler_refill(struct thorium_work_stealing_scheduler *self)
+{
+    struct thorium_actor **bucket;
+    struct thorium_actor *actor;
+
+    while ((bucket = core_queue_peek(&self->overflow)) != NULL) {
+
+        if (!core_work_stealing_deque_push(&self->deque, *bucket)) {
+            break;
+        }
+
+        core_queue_dequeue(&self->overflow, &actor);
+    }
+}
@@ -0,0 +1,38 @@
+
+#ifndef THORIUM_WORK_STEALING_SCHEDULER_H
+#define THORIUM_WORK_STEALING_SCHEDULER_H
+
+#include <core/structures/work_stealing_deque.h>
+#include <core/structures/queue.h>
+
+#include <stdint.h>
+
+#define THORIUM_WORK_STEALING_SCHEDULER 3
+
+#define THORIUM_WORK_STEALING_SCHEDULER_CAPACITY 1024
+
+struct thorium_scheduler;
+struct thorium_actor;
+
+/*
+ * A scheduler where idle sibling workers can take ready actors.
+ *
+ * Actors are in a Chase-Lev deque. The worker that owns the scheduler
+ * pushes at the bottom and takes actors at the top, so the order is
+ * FIFO like in the other schedulers. Thieves also take actors at the
+ * top with thorium_scheduler_steal. When the deque is full, actors
+ * go in an overflow queue that only the owner reads.
+ *
+ * Priorities are ignored.
+ */
+struct thorium_work_stealing_scheduler {
+    struct core_work_stealing_deque deque;
+    struct core_queue overflow;
+
+    uint64_t dequeue_operations;
+    uint64_t steal_operations;
+};
+
+extern struct thorium_scheduler_interface thorium_work_stealing_scheduler_implementation;
+
+#endif
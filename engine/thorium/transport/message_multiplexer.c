@@ -242,7 +242,9 @@ void thorium_message_multiplexer_destroy(struct thorium_message_multiplexer *sel
 
     core_timer_destroy(&self->timer);
 
-#ifdef THORIUM_MULTIPLEXER_USE_TREE
+#ifdef THORIUM_MULTIPLEXER_USE_TIMING_WHEEL
+    core_timing_wheel_destroy(&self->timeline);
+#elif defined(THORIUM_MULTIPLEXER_USE_TREE)
     core_red_black_tree_destroy(&self->timeline);
 #elif defined(THORIUM_MULTIPLEXER_USE_HEAP)
     core_binary_heap_destroy(&self->timeline);
@@ -276,14 +278,12 @@ int thorium_message_multiplexer_multiplex(struct thorium_message_multiplexer *se
      * return 0
      */
 
-    int count;
     int current_size;
     int maximum_size;
     int action;
     struct core_memory_pool *pool;
     void *new_buffer;
     int new_count;
-    void *buffer;
     int destination_node;
     int destination_actor;
     int new_size;
@@ -322,8 +322,6 @@ int thorium_message_multiplexer_multiplex(struct thorium_message_multiplexer *se
 
     ++self->original_message_count;
 
-    count = thorium_message_count(message);
-
     destination_node = thorium_message_destination_node(message);
 
     source_node = message->routing_source;
@@ -353,14 +351,13 @@ int thorium_message_multiplexer_multiplex(struct thorium_message_multiplexer *se
 
     CORE_DEBUGGER_ASSERT(real_multiplexed_buffer != NULL);
 
-    required_size = thorium_multiplexed_buffer_required_size(real_multiplexed_buffer, count);
+    required_size = thorium_multiplexed_buffer_required_size(real_multiplexed_buffer, message);
 
-    buffer = thorium_message_buffer(message);
     destination_actor = thorium_message_destination(message);
 
 #ifdef DEBUG_MULTIPLEXER
-    thorium_printf("DEBUG multiplex count %d required_size %d action %x\n",
-                    count, required_size, action);
+    thorium_printf("DEBUG multiplex required_size %d action %x\n",
+                    required_size, action);
 #endif
 
     /*
@@ -411,6 +408,15 @@ int thorium_message_multiplexer_multiplex(struct thorium_message_multiplexer *se
         current_size = thorium_multiplexed_buffer_current_size(real_multiplexed_buffer);
 
         CORE_DEBUGGER_ASSERT(current_size == 0);
+
+        /*
+         * The header is encoded against the previous message in the
+         * buffer, so its size changes with an empty buffer.
+         */
+        required_size = thorium_multiplexed_buffer_required_size(real_multiplexed_buffer, message);
+
+        if (required_size > maximum_size)
+            return 0;
     }
 
     time = core_timer_get_nanoseconds(&self->timer);
@@ -431,7 +437,10 @@ int thorium_message_multiplexer_multiplex(struct thorium_message_multiplexer *se
          * Add it to the timeline.
          */
 
-#ifdef THORIUM_MULTIPLEXER_USE_TREE
+#ifdef THORIUM_MULTIPLEXER_USE_TIMING_WHEEL
+        core_timing_wheel_add(&self->timeline, time, &destination_node);
+
+#elif defined(THORIUM_MULTIPLEXER_USE_TREE)
         core_red_black_tree_add_key_and_value(&self->timeline, &time, &destination_node);
 
 #elif defined(THORIUM_MULTIPLEXER_USE_HEAP)
@@ -461,7 +470,7 @@ int thorium_message_multiplexer_multiplex(struct thorium_message_multiplexer *se
                     thorium_worker_latency(self->worker));
                     */
 
-    thorium_multiplexed_buffer_append(real_multiplexed_buffer, count, buffer, time);
+    thorium_multiplexed_buffer_append(real_multiplexed_buffer, message, time);
 
     /*
      * Try to flush. This only flushes something if the buffer is full.
@@ -526,6 +535,8 @@ int thorium_message_multiplexer_demultiplex(struct thorium_message_multiplexer *
     int destination_node;
     int current_node;
     int routing_destination;
+    int payload_count;
+    int previous_header[THORIUM_MULTIPLEXED_BUFFER_HEADER_FIELDS];
 
 #ifdef DEBUG_MULTIPLEXER
     thorium_printf("demultiplex message\n");
@@ -565,21 +576,31 @@ int thorium_message_multiplexer_demultiplex(struct thorium_message_multiplexer *
     pool = thorium_worker_get_outbound_message_memory_pool(self->worker);
 
     position = 0;
+    thorium_multiplexed_buffer_clear_header(previous_header);
 
     /*
      * Inject a message for each enclosed message.
      */
     while (position < count) {
-        core_memory_copy(&new_count, buffer + position, sizeof(new_count));
-        position += sizeof(new_count);
+        thorium_message_init_with_nodes(&new_message, 0, NULL,
+                        source_node, destination_node);
 
+        position += thorium_multiplexed_buffer_read_header(previous_header,
+                        buffer + position, &new_message, &payload_count);
+
+        /*
+         * Restore the metadata after the payload so that the message
+         * looks like any other received message.
+         */
+        new_count = payload_count + THORIUM_MESSAGE_METADATA_SIZE;
         new_buffer = core_memory_pool_allocate(pool, new_count);
-        core_memory_copy(new_buffer, buffer + position, new_count);
+        core_memory_copy(new_buffer, buffer + position, payload_count);
 
-        thorium_message_init_with_nodes(&new_message, new_count, new_buffer,
-                        source_node, destination_node);
+        thorium_message_set_buffer(&new_message, new_buffer);
+        thorium_message_set_count(&new_message, new_count);
 
-        thorium_node_prepare_received_message(self->node, &new_message);
+        thorium_node_resolve(self->node, &new_message);
+        thorium_message_write_metadata(&new_message);
 
         /*
          * For these demultiplexed messages, there are 2 outcomes:
@@ -647,7 +668,7 @@ int thorium_message_multiplexer_demultiplex(struct thorium_message_multiplexer *
         thorium_message_destroy(&new_message);
         */
 
-        position += new_count;
+        position += payload_count;
         ++messages;
     }
 
@@ -682,6 +703,12 @@ void thorium_message_multiplexer_test(struct thorium_message_multiplexer *self)
     int *index_bucket;
 #endif
 
+#ifdef THORIUM_MULTIPLEXER_USE_TIMING_WHEEL
+    uint64_t time;
+    uint64_t deadline;
+    int timeout;
+#endif
+
     if (CORE_BITMAP_GET_FLAG(self->flags, FLAG_DISABLED)) {
         return;
     }
@@ -724,6 +751,45 @@ void thorium_message_multiplexer_test(struct thorium_message_multiplexer *self)
     acceptable_traffic_reduction = 0.90;
 #endif
 
+#ifdef THORIUM_MULTIPLEXER_USE_TIMING_WHEEL
+    /*
+     * Only the buffers that are older than the timeout are expired by
+     * the timing wheel.
+     */
+    time = core_timer_get_nanoseconds(&self->timer);
+    timeout = self->timeout_in_nanoseconds;
+    deadline = 0;
+
+    if (timeout >= 0 && time > (uint64_t)timeout)
+        deadline = time - timeout;
+
+    while (core_timing_wheel_pop(&self->timeline, deadline, &time, &index)) {
+
+        multiplexed_buffer = core_vector_at(&self->buffers, index);
+
+        /*
+         * The buffer was flushed elsewhere (and maybe has new content
+         * with its own entry in the timeline).
+         */
+        if (thorium_multiplexed_buffer_current_size(multiplexed_buffer) == 0
+                        || thorium_multiplexed_buffer_time(multiplexed_buffer) != time) {
+            continue;
+        }
+
+        buffer_is_ready = thorium_message_multiplexer_buffer_is_ready(self, multiplexed_buffer);
+
+        /*
+         * Ticks are coarser than nanoseconds, so the buffer may be a little
+         * too recent.
+         */
+        if (!buffer_is_ready) {
+            core_timing_wheel_add(&self->timeline, time, &index);
+            return;
+        }
+
+        thorium_message_multiplexer_flush(self, index, FORCE_YES_TIME);
+    }
+#else
     /*
      * Get the destination with the oldest buffer.
      * If this one has not waited enough, then any other more recent
@@ -836,6 +902,7 @@ void thorium_message_multiplexer_test(struct thorium_message_multiplexer *self)
          * This will eventually end anyway.
          */
     }
+#endif
 }
 
 void thorium_message_multiplexer_flush(struct thorium_message_multiplexer *self, int index, int force)
@@ -947,6 +1014,9 @@ void thorium_message_multiplexer_flush(struct thorium_message_multiplexer *self,
 
     CORE_DEBUGGER_ASSERT_NOT_NULL(self->worker);
 
+    THORIUM_EVENT_TRACER_RECORD(&self->worker->event_tracer, THORIUM_TRACE_EVENT_MULTIPLEXER_FLUSH,
+                    multiplexed_buffer->message_count_, destination_node, force, count);
+
     /*
      * Make a copy of the buffer because the multiplexer does not have communication buffers.
      */
@@ -980,7 +1050,11 @@ void thorium_message_multiplexer_set_worker(struct thorium_message_multiplexer *
     pool = thorium_worker_get_memory_pool(self->worker,
                             MEMORY_POOL_NAME_WORKER_PERSISTENT);
 
-#ifdef THORIUM_MULTIPLEXER_USE_TREE
+#ifdef THORIUM_MULTIPLEXER_USE_TIMING_WHEEL
+    core_timing_wheel_init(&self->timeline, sizeof(int),
+                    THORIUM_MULTIPLEXER_TIMING_WHEEL_TICK, pool);
+
+#elif defined(THORIUM_MULTIPLEXER_USE_TREE)
     core_red_black_tree_init(&self->timeline, sizeof(uint64_t), sizeof(int),
                     pool);
     core_red_black_tree_use_uint64_t_keys(&self->timeline);
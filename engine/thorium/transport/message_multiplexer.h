@@ -13,6 +13,7 @@ struct thorium_message;
 #include <core/structures/vector.h>
 
 #include <core/structures/ordered/red_black_tree.h>
+#include <core/structures/ordered/timing_wheel.h>
 #include <core/structures/unordered/binary_heap.h>
 
 #include <core/structures/set.h>
@@ -24,10 +25,14 @@ struct thorium_message;
 
 /*
 #define THORIUM_MULTIPLEXER_USE_HEAP
-*/
 #define THORIUM_MULTIPLEXER_USE_TREE
-/*
 */
+#define THORIUM_MULTIPLEXER_USE_TIMING_WHEEL
+
+/*
+ * Resolution of the timing wheel in nanoseconds.
+ */
+#define THORIUM_MULTIPLEXER_TIMING_WHEEL_TICK 1024
 /*
  * The multiplexer needs its own action
  */
@@ -75,7 +80,10 @@ struct thorium_message_multiplexer {
 #endif
 
 
-#ifdef THORIUM_MULTIPLEXER_USE_TREE
+#ifdef THORIUM_MULTIPLEXER_USE_TIMING_WHEEL
+    struct core_timing_wheel timeline;
+
+#elif defined(THORIUM_MULTIPLEXER_USE_TREE)
     struct core_red_black_tree timeline;
 
 #elif defined(THORIUM_MULTIPLEXER_USE_HEAP)
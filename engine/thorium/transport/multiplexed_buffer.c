@@ -1,6 +1,8 @@
 
 #include "multiplexed_buffer.h"
 
+#include <engine/thorium/message.h>
+
 #include <core/system/debugger.h>
 #include <core/system/memory.h>
 
@@ -38,6 +40,11 @@
 #define PRINT_TIMEOUT_UPDATE
 */
 
+static int thorium_multiplexed_buffer_write_header(int *previous_header,
+                struct thorium_message *message, int count, char *buffer);
+static int thorium_multiplexed_buffer_write_varint(char *buffer, uint32_t value);
+static int thorium_multiplexed_buffer_read_varint(char *buffer, uint32_t *value);
+
 void thorium_multiplexed_buffer_print_history(struct thorium_multiplexed_buffer *self);
 void thorium_multiplexed_buffer_predict(struct thorium_multiplexed_buffer *self);
 
@@ -118,38 +125,42 @@ int thorium_multiplexed_buffer_maximum_size(struct thorium_multiplexed_buffer *s
 }
 
 void thorium_multiplexed_buffer_append(struct thorium_multiplexed_buffer *self,
-                int count, void *buffer, uint64_t time)
+                struct thorium_message *message, uint64_t time)
 {
-    void *multiplexed_buffer;
-    void *destination_in_buffer;
-    int required_size;
+    char *destination_in_buffer;
+    int count;
+    int header_size;
 
     ++self->counter_original_message_count;
 
     CORE_DEBUGGER_ASSERT(self->buffer_ != NULL);
 
-    required_size = thorium_multiplexed_buffer_required_size(self, count);
-
     /*
      * Make sure there is enough space.
      */
-    CORE_DEBUGGER_ASSERT(self->maximum_size_ - self->current_size_ >= required_size);
+    CORE_DEBUGGER_ASSERT(self->maximum_size_ - self->current_size_ >=
+                    thorium_multiplexed_buffer_required_size(self, message));
 
-    multiplexed_buffer = self->buffer_;
-    destination_in_buffer = ((char *)multiplexed_buffer) + self->current_size_;
+    destination_in_buffer = (char *)self->buffer_ + self->current_size_;
 
     /*
-     * Append <count><buffer> to the <multiplexed_buffer>
+     * The metadata at the end of the buffer is replaced by the header.
      */
-    core_memory_copy(destination_in_buffer, &count, sizeof(count));
-    core_memory_copy((char *)destination_in_buffer + sizeof(count),
-                    buffer, count);
+    count = thorium_message_count(message) - THORIUM_MESSAGE_METADATA_SIZE;
+
+    /*
+     * Append <header><buffer> to the <multiplexed_buffer>
+     */
+    header_size = thorium_multiplexed_buffer_write_header(self->previous_header_, message,
+                    count, destination_in_buffer);
+    core_memory_copy(destination_in_buffer + header_size,
+                    thorium_message_buffer(message), count);
 
     /*
      * Add the message.
      */
     CORE_DEBUGGER_ASSERT(self->current_size_ <= self->maximum_size_);
-    self->current_size_ += required_size;
+    self->current_size_ += header_size + count;
     ++self->message_count_;
 
     CORE_DEBUGGER_ASSERT(self->message_count_ >= 1);
@@ -158,9 +169,61 @@ void thorium_multiplexed_buffer_append(struct thorium_multiplexed_buffer *self,
 }
 
 int thorium_multiplexed_buffer_required_size(struct thorium_multiplexed_buffer *self,
-                int count)
+                struct thorium_message *message)
+{
+    int count;
+
+    count = thorium_message_count(message) - THORIUM_MESSAGE_METADATA_SIZE;
+
+    CORE_DEBUGGER_ASSERT(count >= 0);
+
+    return thorium_multiplexed_buffer_write_header(self->previous_header_, message,
+                    count, NULL) + count;
+}
+
+int thorium_multiplexed_buffer_read_header(int *previous_header, void *buffer,
+                struct thorium_message *message, int *count)
+{
+    char *position;
+    uint32_t value;
+    int i;
+
+    position = buffer;
+
+    position += thorium_multiplexed_buffer_read_varint(position, &value);
+    *count = value;
+
+    for (i = 0; i < THORIUM_MULTIPLEXED_BUFFER_HEADER_FIELDS; ++i) {
+        position += thorium_multiplexed_buffer_read_varint(position, &value);
+
+        /*
+         * Undo the zigzag encoding.
+         */
+        value = (value >> 1) ^ (~(value & 1) + 1);
+        previous_header[i] = (int)((uint32_t)previous_header[i] + value);
+    }
+
+    message->action = previous_header[0];
+    message->source_actor = previous_header[1];
+    message->destination_actor = previous_header[2];
+    message->_message_identifier = previous_header[3];
+    message->_parent_message_actor = previous_header[4];
+    message->_parent_message_identifier = previous_header[5];
+
+#ifdef THORIUM_MESSAGE_ENABLE_TRACEPOINTS
+    core_memory_copy(message->tracepoint_times, position, TRACEPOINT_SIZE);
+    position += TRACEPOINT_SIZE;
+#endif
+
+    return position - (char *)buffer;
+}
+
+void thorium_multiplexed_buffer_clear_header(int *previous_header)
 {
-    return sizeof(count) + count;
+    int i;
+
+    for (i = 0; i < THORIUM_MULTIPLEXED_BUFFER_HEADER_FIELDS; ++i)
+        previous_header[i] = 0;
 }
 
 void thorium_multiplexed_buffer_set_time(struct thorium_multiplexed_buffer *self,
@@ -182,6 +245,8 @@ void thorium_multiplexed_buffer_reset(struct thorium_multiplexed_buffer *self)
 
     self->buffer_ = NULL;
 
+    thorium_multiplexed_buffer_clear_header(self->previous_header_);
+
     /*
      * Assume that this generated a network message.
      */
@@ -426,3 +491,95 @@ double thorium_multiplexed_buffer_get_traffic_reduction(struct thorium_multiplex
 
     return value;
 }
+
+/*
+ * Write the header of an enclosed message. Only the size is computed if
+ * <buffer> is NULL.
+ */
+static int thorium_multiplexed_buffer_write_header(int *previous_header,
+                struct thorium_message *message, int count, char *buffer)
+{
+    int header[THORIUM_MULTIPLEXED_BUFFER_HEADER_FIELDS];
+    char bytes[5];
+    char *position;
+    int size;
+    int i;
+    uint32_t delta;
+
+    header[0] = message->action;
+    header[1] = message->source_actor;
+    header[2] = message->destination_actor;
+    header[3] = message->_message_identifier;
+    header[4] = message->_parent_message_actor;
+    header[5] = message->_parent_message_identifier;
+
+    position = buffer;
+
+    if (position == NULL)
+        position = bytes;
+
+    size = thorium_multiplexed_buffer_write_varint(position, count);
+
+    for (i = 0; i < THORIUM_MULTIPLEXED_BUFFER_HEADER_FIELDS; ++i) {
+        if (buffer != NULL)
+            position = buffer + size;
+
+        delta = (uint32_t)header[i] - (uint32_t)previous_header[i];
+
+        /*
+         * Zigzag encoding: small negative deltas are small too.
+         */
+        delta = (delta << 1) ^ (~(delta >> 31) + 1);
+
+        size += thorium_multiplexed_buffer_write_varint(position, delta);
+    }
+
+#ifdef THORIUM_MESSAGE_ENABLE_TRACEPOINTS
+    if (buffer != NULL)
+        core_memory_copy(buffer + size, message->tracepoint_times, TRACEPOINT_SIZE);
+
+    size += TRACEPOINT_SIZE;
+#endif
+
+    if (buffer != NULL) {
+        for (i = 0; i < THORIUM_MULTIPLEXED_BUFFER_HEADER_FIELDS; ++i)
+            previous_header[i] = header[i];
+    }
+
+    return size;
+}
+
+static int thorium_multiplexed_buffer_write_varint(char *buffer, uint32_t value)
+{
+    int size;
+
+    size = 0;
+
+    while (value >= 0x80) {
+        buffer[size++] = (char)(value | 0x80);
+        value >>= 7;
+    }
+
+    buffer[size++] = (char)value;
+
+    return size;
+}
+
+static int thorium_multiplexed_buffer_read_varint(char *buffer, uint32_t *value)
+{
+    int size;
+    int shift;
+    uint8_t byte;
+
+    size = 0;
+    shift = 0;
+    *value = 0;
+
+    do {
+        byte = buffer[size++];
+        *value |= ((uint32_t)(byte & 0x7f)) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+
+    return size;
+}
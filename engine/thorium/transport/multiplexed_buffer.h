@@ -4,6 +4,19 @@
 
 #include <stdint.h>
 
+struct thorium_message;
+
+/*
+ * The header of an enclosed message stores the action, the source,
+ * the destination, the message identifier, the parent actor and the
+ * parent message identifier as deltas against the previous enclosed
+ * message of the same buffer. The deltas are zigzag-encoded varints.
+ *
+ * The routing nodes are not stored since they are resolved from the actor
+ * names on the receiving node.
+ */
+#define THORIUM_MULTIPLEXED_BUFFER_HEADER_FIELDS 6
+
 #ifdef THORIUM_MULTIPLEXED_BUFFER_PREDICT_MESSAGE_COUNT
 #define PREDICTION_EVENT_COUNT 16
 #endif
@@ -17,6 +30,7 @@ struct thorium_multiplexed_buffer {
     int current_size_;
     int maximum_size_;
     int message_count_;
+    int previous_header_[THORIUM_MULTIPLEXED_BUFFER_HEADER_FIELDS];
     int timeout_;
     int configured_timeout;
 
@@ -50,9 +64,20 @@ int thorium_multiplexed_buffer_maximum_size(struct thorium_multiplexed_buffer *s
  * All small actor messages go through this function.
  */
 void thorium_multiplexed_buffer_append(struct thorium_multiplexed_buffer *self,
-                int count, void *buffer, uint64_t time);
+                struct thorium_message *message, uint64_t time);
 int thorium_multiplexed_buffer_required_size(struct thorium_multiplexed_buffer *self,
-                int count);
+                struct thorium_message *message);
+
+/*
+ * Read the header of an enclosed message into <message> and its payload
+ * size into <count>. <previous_header> must be cleared with
+ * thorium_multiplexed_buffer_clear_header before the first enclosed message.
+ *
+ * \return the number of bytes in the header
+ */
+int thorium_multiplexed_buffer_read_header(int *previous_header, void *buffer,
+                struct thorium_message *message, int *count);
+void thorium_multiplexed_buffer_clear_header(int *previous_header);
 void thorium_multiplexed_buffer_set_time(struct thorium_multiplexed_buffer *self,
                 uint64_t time);
 
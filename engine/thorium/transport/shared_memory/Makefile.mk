@@ -0,0 +1,9 @@
+
+CONFIG_SHARED_MEMORY=y
+
+SHARED_MEMORY_CFLAGS-$(CONFIG_SHARED_MEMORY)=-DCONFIG_SHARED_MEMORY
+SHARED_MEMORY_LDFLAGS-$(CONFIG_SHARED_MEMORY)=-lrt
+CONFIG_CFLAGS+=$(SHARED_MEMORY_CFLAGS-y)
+CONFIG_LDFLAGS+=$(SHARED_MEMORY_LDFLAGS-y)
+
+THORIUM_OBJECTS-$(CONFIG_SHARED_MEMORY) += engine/thorium/transport/shared_memory/shared_memory_transport.o
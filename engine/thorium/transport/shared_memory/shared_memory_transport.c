@@ -0,0 +1,805 @@
+
+#include "shared_memory_transport.h"
+
+#include <engine/thorium/transport/transport.h>
+
+#include <engine/thorium/worker_buffer.h>
+#include <engine/thorium/message.h>
+
+#include <core/system/command.h>
+#include <core/system/memory.h>
+#include <core/system/memory_pool.h>
+#include <core/system/atomic.h>
+#include <core/system/debugger.h>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#define MEMORY_SHARED_MEMORY_TRANSPORT 0x4b1c7e25
+
+#define OPTION_SHARED_MEMORY_KEY "-shared-memory-key"
+
+#define SEGMENT_MAGIC 0x7468736d
+
+#define HEADER_SIZE 4096
+#define CACHE_LINE_SIZE 64
+
+#define RECORD_INLINE 0
+#define RECORD_SLAB 1
+#define RECORD_FRAGMENT 2
+
+#define BLOCK_FREE 0
+#define BLOCK_USED 1
+
+/*
+ * Larger messages go in the slab or are split in fragments.
+ */
+#define MAXIMUM_INLINE_SIZE (THORIUM_SHARED_MEMORY_RING_SIZE / 4)
+
+/*
+ * Don't write a fragment smaller than this unless it is the last one.
+ */
+#define MINIMUM_FRAGMENT_SIZE 4096
+
+#define ATTACH_TIMEOUT_IN_MICROSECONDS (60 * 1000 * 1000)
+#define ATTACH_PERIOD_IN_MICROSECONDS 1000
+
+#define ALIGN(count) (((count) + 7) & ~7)
+
+/*
+ * The first page of the segment.
+ */
+struct thorium_shared_memory_header {
+    volatile uint32_t magic;
+    volatile int attached;
+    int size;
+};
+
+/*
+ * The consumer owns head and the producer owns tail.
+ * The data follows the structure.
+ */
+struct thorium_shared_memory_ring {
+    volatile uint64_t head;
+    char padding1[CACHE_LINE_SIZE - sizeof(uint64_t)];
+    volatile uint64_t tail;
+    char padding2[CACHE_LINE_SIZE - sizeof(uint64_t)];
+};
+
+/*
+ * A slab block is claimed by its owner (the sender) and released
+ * by the receiver. The data follows the structure.
+ */
+struct thorium_shared_memory_block {
+    volatile int state;
+    char padding[CACHE_LINE_SIZE - sizeof(int)];
+};
+
+struct thorium_shared_memory_record {
+    int type;
+    int count;
+    int total;
+    int block;
+};
+
+struct thorium_shared_memory_send {
+    char *buffer;
+    int count;
+    int worker;
+    int offset;
+};
+
+struct thorium_shared_memory_peer {
+    /*
+     * Outbound messages for this peer, in order.
+     */
+    struct thorium_shared_memory_send current;
+    int has_current;
+    struct core_queue pending;
+
+    /*
+     * Inbound message being reassembled from fragments.
+     */
+    char *partial_buffer;
+    int partial_count;
+    int partial_total;
+};
+
+#define RING_STRIDE (sizeof(struct thorium_shared_memory_ring) + THORIUM_SHARED_MEMORY_RING_SIZE)
+#define BLOCK_STRIDE (sizeof(struct thorium_shared_memory_block) + THORIUM_SHARED_MEMORY_SLAB_BLOCK_SIZE)
+
+static void thorium_shared_memory_transport_init(struct thorium_transport *self, int *argc, char ***argv);
+static void thorium_shared_memory_transport_destroy(struct thorium_transport *self);
+
+static int thorium_shared_memory_transport_send(struct thorium_transport *self, struct thorium_message *message);
+static int thorium_shared_memory_transport_receive(struct thorium_transport *self, struct thorium_message *message);
+
+static int thorium_shared_memory_transport_test(struct thorium_transport *self, struct thorium_worker_buffer *worker_buffer);
+
+static int thorium_shared_memory_transport_get_environment(const char **names, int default_value);
+static void thorium_shared_memory_transport_attach(struct thorium_transport *self);
+static struct thorium_shared_memory_ring *thorium_shared_memory_transport_get_ring(struct thorium_transport *self,
+                int source, int destination);
+static struct thorium_shared_memory_block *thorium_shared_memory_transport_get_block(struct thorium_transport *self,
+                int owner, int index);
+static int thorium_shared_memory_transport_free_space(struct thorium_transport *self, int destination);
+static void thorium_shared_memory_transport_write(struct thorium_transport *self, int destination,
+                struct thorium_shared_memory_record *record, char *payload);
+static void thorium_shared_memory_transport_copy_in(struct thorium_shared_memory_ring *ring,
+                uint64_t position, char *source, int count);
+static void thorium_shared_memory_transport_copy_out(struct thorium_shared_memory_ring *ring,
+                uint64_t position, char *destination, int count);
+static int thorium_shared_memory_transport_claim_block(struct thorium_transport *self);
+static int thorium_shared_memory_transport_push(struct thorium_transport *self, int destination,
+                struct thorium_shared_memory_send *send);
+static void thorium_shared_memory_transport_complete(struct thorium_transport *self,
+                struct thorium_shared_memory_send *send);
+static void thorium_shared_memory_transport_make_progress(struct thorium_transport *self);
+
+struct thorium_transport_interface thorium_shared_memory_transport_implementation = {
+    .name = "shared_memory_transport",
+    .size = sizeof(struct thorium_shared_memory_transport),
+    .init = thorium_shared_memory_transport_init,
+    .destroy = thorium_shared_memory_transport_destroy,
+    .send = thorium_shared_memory_transport_send,
+    .receive = thorium_shared_memory_transport_receive,
+    .test = thorium_shared_memory_transport_test
+};
+
+static void thorium_shared_memory_transport_init(struct thorium_transport *self, int *argc, char ***argv)
+{
+    struct thorium_shared_memory_transport *concrete_self;
+    struct thorium_shared_memory_peer *peer;
+    const char *rank_names[] = { "THORIUM_RANK", "OMPI_COMM_WORLD_RANK", "PMI_RANK", NULL };
+    const char *size_names[] = { "THORIUM_SIZE", "OMPI_COMM_WORLD_SIZE", "PMI_SIZE", NULL };
+    char *key;
+    int i;
+
+    concrete_self = thorium_transport_get_concrete_transport(self);
+
+    self->rank = thorium_shared_memory_transport_get_environment(rank_names, 0);
+    self->size = thorium_shared_memory_transport_get_environment(size_names, 1);
+    self->provided = THORIUM_THREAD_FUNNELED;
+
+    CORE_DEBUGGER_ASSERT(self->rank >= 0 && self->rank < self->size);
+
+    /*
+     * Processes started together (by mpiexec or by a shell) have
+     * the same parent.
+     */
+    key = core_command_get_argument_value(*argc, *argv, OPTION_SHARED_MEMORY_KEY);
+
+    if (key != NULL) {
+        snprintf(concrete_self->name, sizeof(concrete_self->name), "/thorium-%s", key);
+    } else {
+        snprintf(concrete_self->name, sizeof(concrete_self->name), "/thorium-%d", (int)getppid());
+    }
+
+    concrete_self->segment_size = HEADER_SIZE;
+    concrete_self->segment_size += (size_t)self->size * self->size * RING_STRIDE;
+    concrete_self->segment_size += (size_t)self->size * THORIUM_SHARED_MEMORY_SLAB_BLOCKS * BLOCK_STRIDE;
+
+    thorium_shared_memory_transport_attach(self);
+
+    concrete_self->peers = core_memory_allocate(self->size * sizeof(struct thorium_shared_memory_peer),
+                    MEMORY_SHARED_MEMORY_TRANSPORT);
+
+    for (i = 0; i < self->size; ++i) {
+        peer = concrete_self->peers + i;
+
+        peer->has_current = 0;
+        core_queue_init(&peer->pending, sizeof(struct thorium_shared_memory_send));
+
+        peer->partial_buffer = NULL;
+        peer->partial_count = 0;
+        peer->partial_total = 0;
+    }
+
+    core_queue_init(&concrete_self->completed_buffers, sizeof(struct thorium_worker_buffer));
+
+    concrete_self->pending_message_count = 0;
+    concrete_self->slab_cursor = 0;
+    concrete_self->next_source = 0;
+}
+
+static void thorium_shared_memory_transport_destroy(struct thorium_transport *self)
+{
+    struct thorium_shared_memory_transport *concrete_self;
+    struct thorium_shared_memory_peer *peer;
+    int i;
+
+    concrete_self = thorium_transport_get_concrete_transport(self);
+
+    CORE_DEBUGGER_ASSERT(concrete_self->pending_message_count == 0);
+
+    for (i = 0; i < self->size; ++i) {
+        peer = concrete_self->peers + i;
+
+        if (peer->partial_buffer != NULL)
+            core_memory_pool_free(self->inbound_message_memory_pool, peer->partial_buffer);
+
+        core_queue_destroy(&peer->pending);
+    }
+
+    core_memory_free(concrete_self->peers, MEMORY_SHARED_MEMORY_TRANSPORT);
+    concrete_self->peers = NULL;
+
+    core_queue_destroy(&concrete_self->completed_buffers);
+
+    munmap(concrete_self->segment, concrete_self->segment_size);
+    close(concrete_self->file_descriptor);
+
+    concrete_self->segment = NULL;
+
+    self->rank = -1;
+    self->size = -1;
+    self->provided = -1;
+}
+
+/*
+ * The message is always accepted. If the ring is full, it is sent later
+ * when the transport makes progress.
+ */
+static int thorium_shared_memory_transport_send(struct thorium_transport *self, struct thorium_message *message)
+{
+    struct thorium_shared_memory_transport *concrete_self;
+    struct thorium_shared_memory_peer *peer;
+    struct thorium_shared_memory_send send;
+    int destination;
+
+    concrete_self = thorium_transport_get_concrete_transport(self);
+
+    send.buffer = thorium_message_buffer(message);
+    send.count = thorium_message_count(message);
+    send.worker = thorium_message_worker(message);
+    send.offset = 0;
+
+    destination = thorium_message_destination_node(message);
+
+    CORE_DEBUGGER_ASSERT(destination >= 0 && destination < self->size);
+    CORE_DEBUGGER_ASSERT(send.buffer == NULL || send.count > 0);
+
+    peer = concrete_self->peers + destination;
+
+    /*
+     * Keep the order of the messages for each peer.
+     */
+    if (peer->has_current) {
+        core_queue_enqueue(&peer->pending, &send);
+        ++concrete_self->pending_message_count;
+
+        thorium_shared_memory_transport_make_progress(self);
+        return 1;
+    }
+
+    if (thorium_shared_memory_transport_push(self, destination, &send)) {
+        thorium_shared_memory_transport_complete(self, &send);
+        return 1;
+    }
+
+    peer->current = send;
+    peer->has_current = 1;
+    ++concrete_self->pending_message_count;
+
+    return 1;
+}
+
+static int thorium_shared_memory_transport_receive(struct thorium_transport *self, struct thorium_message *message)
+{
+    struct thorium_shared_memory_transport *concrete_self;
+    struct thorium_shared_memory_peer *peer;
+    struct thorium_shared_memory_ring *ring;
+    struct thorium_shared_memory_record record;
+    struct thorium_shared_memory_block *block;
+    uint64_t head;
+    char *buffer;
+    int source;
+    int count;
+    int i;
+
+    concrete_self = thorium_transport_get_concrete_transport(self);
+
+    thorium_shared_memory_transport_make_progress(self);
+
+    for (i = 0; i < self->size; ++i) {
+        source = (concrete_self->next_source + i) % self->size;
+        ring = thorium_shared_memory_transport_get_ring(self, source, self->rank);
+        peer = concrete_self->peers + source;
+
+        while (1) {
+            head = ring->head;
+
+            if (ring->tail == head)
+                break;
+
+            /*
+             * Read the record after reading the tail.
+             */
+            core_memory_load_fence();
+
+            thorium_shared_memory_transport_copy_out(ring, head, (char *)&record, sizeof(record));
+            head += sizeof(record);
+
+            buffer = NULL;
+            count = record.count;
+
+            if (record.type == RECORD_INLINE) {
+
+                if (count > 0) {
+                    buffer = core_memory_pool_allocate(self->inbound_message_memory_pool, count);
+                    thorium_shared_memory_transport_copy_out(ring, head, buffer, count);
+                }
+
+                head += ALIGN(count);
+
+            } else if (record.type == RECORD_SLAB) {
+
+                block = thorium_shared_memory_transport_get_block(self, source, record.block);
+                buffer = core_memory_pool_allocate(self->inbound_message_memory_pool, count);
+                core_memory_copy(buffer, block + 1, count);
+
+                /*
+                 * Give the block back to its owner.
+                 */
+                core_memory_fence();
+                block->state = BLOCK_FREE;
+
+            } else {
+
+                CORE_DEBUGGER_ASSERT(record.type == RECORD_FRAGMENT);
+
+                if (peer->partial_buffer == NULL) {
+                    peer->partial_buffer = core_memory_pool_allocate(self->inbound_message_memory_pool,
+                                    record.total);
+                    peer->partial_count = 0;
+                    peer->partial_total = record.total;
+                }
+
+                thorium_shared_memory_transport_copy_out(ring, head,
+                                peer->partial_buffer + peer->partial_count, count);
+                peer->partial_count += count;
+                head += ALIGN(count);
+
+                if (peer->partial_count == peer->partial_total) {
+                    buffer = peer->partial_buffer;
+                    count = peer->partial_total;
+                    peer->partial_buffer = NULL;
+                }
+            }
+
+            /*
+             * The bytes were read before the producer can reuse them.
+             */
+            core_memory_fence();
+            ring->head = head;
+
+            if (record.type != RECORD_FRAGMENT || buffer != NULL) {
+                thorium_message_init_with_nodes(message, count, buffer, source, self->rank);
+
+                concrete_self->next_source = (source + 1) % self->size;
+                return 1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+static int thorium_shared_memory_transport_test(struct thorium_transport *self, struct thorium_worker_buffer *worker_buffer)
+{
+    struct thorium_shared_memory_transport *concrete_self;
+
+    concrete_self = thorium_transport_get_concrete_transport(self);
+
+    thorium_shared_memory_transport_make_progress(self);
+
+    return core_queue_dequeue(&concrete_self->completed_buffers, worker_buffer);
+}
+
+static int thorium_shared_memory_transport_get_environment(const char **names, int default_value)
+{
+    char *value;
+
+    while (*names != NULL) {
+        value = getenv(*names);
+
+        if (value != NULL)
+            return atoi(value);
+
+        ++names;
+    }
+
+    return default_value;
+}
+
+/*
+ * Rank 0 creates the segment. The other processes wait for it.
+ * The name is removed once every process has mapped the segment so that
+ * nothing is left behind in /dev/shm.
+ */
+static void thorium_shared_memory_transport_attach(struct thorium_transport *self)
+{
+    struct thorium_shared_memory_transport *concrete_self;
+    struct thorium_shared_memory_header *header;
+    struct stat status;
+    int waited;
+    int file_descriptor;
+
+    concrete_self = thorium_transport_get_concrete_transport(self);
+
+    file_descriptor = -1;
+    waited = 0;
+
+    if (self->rank == 0) {
+        shm_unlink(concrete_self->name);
+
+        file_descriptor = shm_open(concrete_self->name, O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+
+        if (file_descriptor >= 0
+                    && ftruncate(file_descriptor, concrete_self->segment_size) != 0) {
+            close(file_descriptor);
+            file_descriptor = -1;
+        }
+
+    } else {
+        while (waited < ATTACH_TIMEOUT_IN_MICROSECONDS) {
+            file_descriptor = shm_open(concrete_self->name, O_RDWR, 0);
+
+            if (file_descriptor >= 0) {
+                if (fstat(file_descriptor, &status) == 0
+                            && (size_t)status.st_size == concrete_self->segment_size)
+                    break;
+
+                close(file_descriptor);
+                file_descriptor = -1;
+            }
+
+            usleep(ATTACH_PERIOD_IN_MICROSECONDS);
+            waited += ATTACH_PERIOD_IN_MICROSECONDS;
+        }
+    }
+
+    if (file_descriptor < 0) {
+        printf("Error: thorium_shared_memory_transport rank %d can not open %s\n",
+                        self->rank, concrete_self->name);
+        core_exit_with_error();
+    }
+
+    concrete_self->file_descriptor = file_descriptor;
+    concrete_self->segment = mmap(NULL, concrete_self->segment_size, PROT_READ | PROT_WRITE,
+                    MAP_SHARED, file_descriptor, 0);
+
+    if (concrete_self->segment == MAP_FAILED) {
+        printf("Error: thorium_shared_memory_transport rank %d can not map %s\n",
+                        self->rank, concrete_self->name);
+        core_exit_with_error();
+    }
+
+    header = (struct thorium_shared_memory_header *)concrete_self->segment;
+
+    /*
+     * The pages of the new segment are filled with zeros, so the rings
+     * are empty and the blocks are free.
+     */
+    if (self->rank == 0) {
+        header->size = self->size;
+        core_memory_store_fence();
+        header->magic = SEGMENT_MAGIC;
+    }
+
+    while (header->magic != SEGMENT_MAGIC && waited < ATTACH_TIMEOUT_IN_MICROSECONDS) {
+        usleep(ATTACH_PERIOD_IN_MICROSECONDS);
+        waited += ATTACH_PERIOD_IN_MICROSECONDS;
+    }
+
+    if (header->magic != SEGMENT_MAGIC || header->size != self->size) {
+        printf("Error: thorium_shared_memory_transport rank %d found an invalid segment %s\n",
+                        self->rank, concrete_self->name);
+        core_exit_with_error();
+    }
+
+    core_atomic_increment(&header->attached);
+
+    /*
+     * A process that dies before it attaches must not keep rank 0
+     * waiting forever.
+     */
+    if (self->rank == 0) {
+        waited = 0;
+
+        while (header->attached != self->size && waited < ATTACH_TIMEOUT_IN_MICROSECONDS) {
+            usleep(ATTACH_PERIOD_IN_MICROSECONDS);
+            waited += ATTACH_PERIOD_IN_MICROSECONDS;
+        }
+
+        shm_unlink(concrete_self->name);
+
+        if (header->attached != self->size) {
+            printf("Error: thorium_shared_memory_transport rank %d found %d of %d processes attached to %s\n",
+                            self->rank, (int)header->attached, self->size, concrete_self->name);
+
+            munmap(concrete_self->segment, concrete_self->segment_size);
+            close(file_descriptor);
+            concrete_self->segment = NULL;
+
+            core_exit_with_error();
+        }
+    }
+}
+
+static struct thorium_shared_memory_ring *thorium_shared_memory_transport_get_ring(struct thorium_transport *self,
+                int source, int destination)
+{
+    struct thorium_shared_memory_transport *concrete_self;
+    size_t offset;
+
+    concrete_self = thorium_transport_get_concrete_transport(self);
+
+    offset = HEADER_SIZE + ((size_t)source * self->size + destination) * RING_STRIDE;
+
+    return (struct thorium_shared_memory_ring *)(concrete_self->segment + offset);
+}
+
+static struct thorium_shared_memory_block *thorium_shared_memory_transport_get_block(struct thorium_transport *self,
+                int owner, int index)
+{
+    struct thorium_shared_memory_transport *concrete_self;
+    size_t offset;
+
+    concrete_self = thorium_transport_get_concrete_transport(self);
+
+    offset = HEADER_SIZE + (size_t)self->size * self->size * RING_STRIDE;
+    offset += ((size_t)owner * THORIUM_SHARED_MEMORY_SLAB_BLOCKS + index) * BLOCK_STRIDE;
+
+    return (struct thorium_shared_memory_block *)(concrete_self->segment + offset);
+}
+
+/*
+ * \return the number of payload bytes that fit in the ring with a record
+ */
+static int thorium_shared_memory_transport_free_space(struct thorium_transport *self, int destination)
+{
+    struct thorium_shared_memory_ring *ring;
+    uint64_t used;
+    int space;
+
+    ring = thorium_shared_memory_transport_get_ring(self, self->rank, destination);
+
+    used = ring->tail - ring->head;
+
+    /*
+     * The bytes must not be overwritten before the head is read.
+     */
+    core_memory_load_fence();
+
+    space = THORIUM_SHARED_MEMORY_RING_SIZE - (int)used - (int)sizeof(struct thorium_shared_memory_record);
+
+    return space & ~7;
+}
+
+static void thorium_shared_memory_transport_write(struct thorium_transport *self, int destination,
+                struct thorium_shared_memory_record *record, char *payload)
+{
+    struct thorium_shared_memory_ring *ring;
+    uint64_t tail;
+    int count;
+
+    ring = thorium_shared_memory_transport_get_ring(self, self->rank, destination);
+    tail = ring->tail;
+
+    thorium_shared_memory_transport_copy_in(ring, tail, (char *)record, sizeof(*record));
+    tail += sizeof(*record);
+
+    count = 0;
+
+    if (record->type != RECORD_SLAB)
+        count = record->count;
+
+    if (count > 0)
+        thorium_shared_memory_transport_copy_in(ring, tail, payload, count);
+
+    tail += ALIGN(count);
+
+    /*
+     * The record must be visible before the tail is moved.
+     */
+    core_memory_store_fence();
+    ring->tail = tail;
+}
+
+static void thorium_shared_memory_transport_copy_in(struct thorium_shared_memory_ring *ring,
+                uint64_t position, char *source, int count)
+{
+    char *data;
+    int offset;
+    int first;
+
+    data = (char *)(ring + 1);
+    offset = position & (THORIUM_SHARED_MEMORY_RING_SIZE - 1);
+    first = THORIUM_SHARED_MEMORY_RING_SIZE - offset;
+
+    if (first > count)
+        first = count;
+
+    core_memory_copy(data + offset, source, first);
+
+    if (count > first)
+        core_memory_copy(data, source + first, count - first);
+}
+
+static void thorium_shared_memory_transport_copy_out(struct thorium_shared_memory_ring *ring,
+                uint64_t position, char *destination, int count)
+{
+    char *data;
+    int offset;
+    int first;
+
+    data = (char *)(ring + 1);
+    offset = position & (THORIUM_SHARED_MEMORY_RING_SIZE - 1);
+    first = THORIUM_SHARED_MEMORY_RING_SIZE - offset;
+
+    if (first > count)
+        first = count;
+
+    core_memory_copy(destination, data + offset, first);
+
+    if (count > first)
+        core_memory_copy(destination + first, data, count - first);
+}
+
+/*
+ * \return a free block of the slab of this process, or -1
+ */
+static int thorium_shared_memory_transport_claim_block(struct thorium_transport *self)
+{
+    struct thorium_shared_memory_transport *concrete_self;
+    struct thorium_shared_memory_block *block;
+    int index;
+    int i;
+
+    concrete_self = thorium_transport_get_concrete_transport(self);
+
+    for (i = 0; i < THORIUM_SHARED_MEMORY_SLAB_BLOCKS; ++i) {
+        index = (concrete_self->slab_cursor + i) % THORIUM_SHARED_MEMORY_SLAB_BLOCKS;
+        block = thorium_shared_memory_transport_get_block(self, self->rank, index);
+
+        if (block->state == BLOCK_FREE) {
+
+            /*
+             * The receiver is done with the block.
+             */
+            core_memory_fence();
+            block->state = BLOCK_USED;
+
+            concrete_self->slab_cursor = (index + 1) % THORIUM_SHARED_MEMORY_SLAB_BLOCKS;
+            return index;
+        }
+    }
+
+    return -1;
+}
+
+/*
+ * \return 1 if the whole message was written
+ */
+static int thorium_shared_memory_transport_push(struct thorium_transport *self, int destination,
+                struct thorium_shared_memory_send *send)
+{
+    struct thorium_shared_memory_record record;
+    struct thorium_shared_memory_block *block;
+    int space;
+    int fragment;
+    int index;
+
+    space = thorium_shared_memory_transport_free_space(self, destination);
+
+    if (send->offset == 0 && send->count <= MAXIMUM_INLINE_SIZE) {
+
+        if (space < send->count)
+            return 0;
+
+        record.type = RECORD_INLINE;
+        record.count = send->count;
+        record.total = send->count;
+        record.block = -1;
+
+        thorium_shared_memory_transport_write(self, destination, &record, send->buffer);
+        send->offset = send->count;
+        return 1;
+    }
+
+    /*
+     * Hand off the buffer with a block of the slab.
+     */
+    if (send->offset == 0 && send->count <= THORIUM_SHARED_MEMORY_SLAB_BLOCK_SIZE
+                    && space >= 0) {
+
+        index = thorium_shared_memory_transport_claim_block(self);
+
+        if (index >= 0) {
+            block = thorium_shared_memory_transport_get_block(self, self->rank, index);
+            core_memory_copy(block + 1, send->buffer, send->count);
+
+            record.type = RECORD_SLAB;
+            record.count = send->count;
+            record.total = send->count;
+            record.block = index;
+
+            thorium_shared_memory_transport_write(self, destination, &record, NULL);
+            send->offset = send->count;
+            return 1;
+        }
+    }
+
+    /*
+     * Otherwise, stream the message in fragments.
+     */
+    while (send->offset < send->count) {
+        fragment = send->count - send->offset;
+
+        if (fragment > MAXIMUM_INLINE_SIZE)
+            fragment = MAXIMUM_INLINE_SIZE;
+
+        if (fragment > space)
+            fragment = space;
+
+        if (fragment < send->count - send->offset && fragment < MINIMUM_FRAGMENT_SIZE)
+            return 0;
+
+        record.type = RECORD_FRAGMENT;
+        record.count = fragment;
+        record.total = send->count;
+        record.block = -1;
+
+        thorium_shared_memory_transport_write(self, destination, &record, send->buffer + send->offset);
+        send->offset += fragment;
+
+        space = thorium_shared_memory_transport_free_space(self, destination);
+    }
+
+    return 1;
+}
+
+static void thorium_shared_memory_transport_complete(struct thorium_transport *self,
+                struct thorium_shared_memory_send *send)
+{
+    struct thorium_shared_memory_transport *concrete_self;
+    struct thorium_worker_buffer worker_buffer;
+
+    concrete_self = thorium_transport_get_concrete_transport(self);
+
+    thorium_worker_buffer_init(&worker_buffer, send->worker, send->buffer);
+    core_queue_enqueue(&concrete_self->completed_buffers, &worker_buffer);
+}
+
+static void thorium_shared_memory_transport_make_progress(struct thorium_transport *self)
+{
+    struct thorium_shared_memory_transport *concrete_self;
+    struct thorium_shared_memory_peer *peer;
+    int destination;
+
+    concrete_self = thorium_transport_get_concrete_transport(self);
+
+    if (concrete_self->pending_message_count == 0)
+        return;
+
+    for (destination = 0; destination < self->size; ++destination) {
+        peer = concrete_self->peers + destination;
+
+        while (peer->has_current
+                   && thorium_shared_memory_transport_push(self, destination, &peer->current)) {
+
+            thorium_shared_memory_transport_complete(self, &peer->current);
+            --concrete_self->pending_message_count;
+
+            peer->has_current = core_queue_dequeue(&peer->pending, &peer->current);
+        }
+    }
+}
@@ -0,0 +1,63 @@
+
+#ifndef THORIUM_SHARED_MEMORY_TRANSPORT_H
+#define THORIUM_SHARED_MEMORY_TRANSPORT_H
+
+#include <engine/thorium/transport/transport_interface.h>
+
+#include <core/structures/queue.h>
+
+#include <stddef.h>
+
+struct thorium_shared_memory_peer;
+
+/*
+ * Bytes in each ring (must be a power of 2).
+ */
+#define THORIUM_SHARED_MEMORY_RING_SIZE (256 * 1024)
+
+/*
+ * Each process owns THORIUM_SHARED_MEMORY_SLAB_BLOCKS blocks of
+ * THORIUM_SHARED_MEMORY_SLAB_BLOCK_SIZE bytes for large messages.
+ */
+#define THORIUM_SHARED_MEMORY_SLAB_BLOCK_SIZE (1024 * 1024)
+#define THORIUM_SHARED_MEMORY_SLAB_BLOCKS 8
+
+/*
+ * Transport for the thorium processes of one host.
+ *
+ * All the processes map one POSIX shared memory segment with a
+ * single-producer single-consumer byte ring for each pair of processes.
+ * Small messages are copied in the ring. Large messages are handed off
+ * with a descriptor in the ring that points to a block of the slab
+ * of the sender. When the slab has no free block, a large message is
+ * streamed in fragments through the ring.
+ *
+ * The rank and the number of processes are read from the environment
+ * (THORIUM_RANK and THORIUM_SIZE, or the variables set by Open-MPI or
+ * by Hydra), so the processes can be started with mpiexec or by hand.
+ * The segment name is derived from -shared-memory-key or, by default,
+ * from the parent process.
+ *
+ * Usage: -transport shared_memory_transport
+ */
+struct thorium_shared_memory_transport {
+    char name[64];
+    int file_descriptor;
+    char *segment;
+    size_t segment_size;
+
+    struct thorium_shared_memory_peer *peers;
+
+    /*
+     * Buffers that can be given back to their workers.
+     */
+    struct core_queue completed_buffers;
+
+    int pending_message_count;
+    int slab_cursor;
+    int next_source;
+};
+
+extern struct thorium_transport_interface thorium_shared_memory_transport_implementation;
+
+#endif
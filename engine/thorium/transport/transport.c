@@ -16,6 +16,10 @@
 #include "mpi1_pt2pt_nonblocking/mpi1_pt2pt_nonblocking_transport.h"
 #endif
 
+#ifdef CONFIG_SHARED_MEMORY
+#include "shared_memory/shared_memory_transport.h"
+#endif
+
 /*
  * The mock transport does nothing. It is required however when
  * no other transport implementation is available.
@@ -308,6 +312,14 @@ void thorium_transport_select_implementation(struct thorium_transport *self, int
 #endif
 #endif
 
+#ifdef CONFIG_SHARED_MEMORY
+    /*
+     * POSIX shared memory between the processes of one host.
+     */
+    component = &thorium_shared_memory_transport_implementation;
+    core_vector_push_back(&implementations, &component);
+#endif
+
 #if defined(_CRA__disabled__YC) && 0
     component = &thorium_gni_transport_implementation;
     core_vector_push_back(&implementations, &component);
@@ -366,6 +378,7 @@ void thorium_transport_select_implementation(struct thorium_transport *self, int
      *
      * -transport mpi1_pt2pt_nonblocking_transport
      * -transport mpi1_pt2pt_transport
+     * -transport shared_memory_transport
      * -transport thorium_pami_transport_implementation
      */
     if (requested_implementation_name != NULL) {
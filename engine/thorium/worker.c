@@ -12,6 +12,7 @@
 #include "worker_debugger.h"
 
 #include "scheduler/balancer.h"
+#include "scheduler/work_stealing_scheduler.h"
 
 #include <core/structures/map.h>
 #include <core/structures/vector.h>
@@ -36,6 +37,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <inttypes.h>
 
 #include <unistd.h> /*getpid */
 
@@ -90,9 +92,38 @@
 #define FLAG_ENABLE_WAIT                            CORE_BITMAP_MAKE_FLAG(5)
 #define FLAG_OUTPUT_OUTBOUND_MESSAGE_RING_IS_FULL   CORE_BITMAP_MAKE_FLAG(6)
 #define FLAG_USE_MULTIPLEXER                        CORE_BITMAP_MAKE_FLAG(7)
+#define FLAG_DIRECT_LOCAL_DELIVERY                  CORE_BITMAP_MAKE_FLAG(8)
+#define FLAG_WORK_STEALING                          CORE_BITMAP_MAKE_FLAG(9)
 
 #define DEBUG_WORKER_OPTION "-debug-worker"
 
+/*
+ * Placement of the memory of the pools of workers.
+ */
+#define OPTION_HUGE_PAGES "-huge-pages"
+#define OPTION_LOCAL_NUMA_NODE "-numa-local-memory"
+
+/*
+ * Never give messages for local actors to the node.
+ */
+#define OPTION_DIRECT_LOCAL_DELIVERY "-direct-local-delivery"
+
+/*
+ * Let idle workers take ready actors from their siblings.
+ */
+#define OPTION_WORK_STEALING "-work-stealing"
+
+#define THORIUM_WORKER_RETURNED_ACTOR_RING_CAPACITY 64
+
+/*
+ * A stolen actor receives at most this number of messages
+ * before going back to its worker.
+ */
+#define THORIUM_WORKER_STEAL_BATCH_SIZE 16
+#define THORIUM_WORKER_STEAL_ATTEMPTS 2
+
+#define MEMORY_WORKER_KEY 0x7c1e52a9
+
 /*
 #define THORIUM_WORKER_DEBUG_WAIT_SIGNAL
 */
@@ -145,16 +176,32 @@ static int thorium_worker_enqueue_message_for_triage(struct thorium_worker *work
 static int thorium_worker_dequeue_message_for_triage(struct thorium_worker *worker, struct thorium_message *message);
 */
 
+static int thorium_worker_push_local_delivery(struct thorium_worker *self,
+                struct thorium_actor *actor, struct thorium_message *message);
+
+static int thorium_worker_dequeue_actor_with_stealing(struct thorium_worker *self,
+                struct thorium_actor **actor);
+static void thorium_worker_work_on_stolen_actor(struct thorium_worker *self,
+                struct thorium_actor *actor);
+static void thorium_worker_return_stolen_actor(struct thorium_worker *self,
+                struct thorium_actor *actor);
+static void thorium_worker_flush_returned_actors(struct thorium_worker *self);
+static void thorium_worker_receive_returned_actor(struct thorium_worker *self,
+                struct thorium_actor *actor);
+
 static void thorium_worker_send_to_other_node(struct thorium_worker *self,
                 struct thorium_message *message);
 
-void thorium_worker_init(struct thorium_worker *worker, int name, struct thorium_node *node)
+void thorium_worker_init(struct thorium_worker *worker, int name, struct thorium_node *node,
+                int processor)
 {
     int capacity;
+    int numa_node;
     int ephemeral_memory_block_size;
     int injected_buffer_ring_size;
     int argc;
     char **argv;
+    int scheduler_type;
 #ifndef THORIUM_WORKER_USE_MULTIPLE_PRODUCER_RING
     int outbound_ring_capacity;
 #endif
@@ -165,6 +212,9 @@ void thorium_worker_init(struct thorium_worker *worker, int name, struct thorium
     worker->current_actor = NULL;
     worker->tick_count = 0;
 
+    thorium_event_tracer_init(&worker->event_tracer, name);
+    thorium_action_profiler_init(&worker->action_profiler);
+
     argc = thorium_node_argc(node);
     argv = thorium_node_argv(node);
 
@@ -229,7 +279,21 @@ void thorium_worker_init(struct thorium_worker *worker, int name, struct thorium
                     sizeof(struct thorium_message));
 #endif
 
-    thorium_scheduler_init(&worker->scheduler, thorium_node_name(worker->node),
+    core_fast_ring_init(&worker->input_returned_actor_ring, THORIUM_WORKER_RETURNED_ACTOR_RING_CAPACITY,
+                    sizeof(struct thorium_actor *));
+    core_fast_ring_use_multiple_producers(&worker->input_returned_actor_ring);
+    core_queue_init(&worker->output_returned_actor_queue, sizeof(struct thorium_actor *));
+    worker->stolen_actor_count = 0;
+    worker->stolen_message_count = 0;
+
+    scheduler_type = THORIUM_SCHEDULER_DEFAULT;
+
+    if (core_command_has_argument(argc, argv, OPTION_WORK_STEALING)) {
+        CORE_BITMAP_SET_FLAG(worker->flags, FLAG_WORK_STEALING);
+        scheduler_type = THORIUM_WORK_STEALING_SCHEDULER;
+    }
+
+    thorium_scheduler_init(&worker->scheduler, scheduler_type, thorium_node_name(worker->node),
                     worker->name);
 
     if (thorium_node_must_print_data(worker->node)) {
@@ -252,6 +316,11 @@ void thorium_worker_init(struct thorium_worker *worker, int name, struct thorium
 
     core_queue_init(&worker->output_outbound_message_queue, sizeof(struct thorium_message));
 
+    core_queue_init(&worker->local_delivery_queue, sizeof(struct thorium_message));
+    worker->next_placement = name;
+    worker->direct_local_delivery_count = 0;
+    worker->node_local_delivery_count = 0;
+
     CORE_BITMAP_CLEAR_FLAG(worker->flags, FLAG_DEBUG);
     CORE_BITMAP_CLEAR_FLAG(worker->flags, FLAG_BUSY);
     CORE_BITMAP_CLEAR_FLAG(worker->flags, FLAG_ENABLE_ACTOR_LOAD_PROFILER);
@@ -295,6 +364,7 @@ void thorium_worker_init(struct thorium_worker *worker, int name, struct thorium
 
     core_memory_pool_disable_tracking(&worker->ephemeral_memory);
     core_memory_pool_enable_ephemeral_mode(&worker->ephemeral_memory);
+    core_memory_pool_enable_arena_mode(&worker->ephemeral_memory);
 
 #ifdef THORIUM_WORKER_ENABLE_LOCK
     core_lock_init(&worker->lock);
@@ -322,6 +392,38 @@ void thorium_worker_init(struct thorium_worker *worker, int name, struct thorium
     core_memory_pool_enable_normalization(&worker->outbound_message_memory_pool);
     core_memory_pool_enable_alignment(&worker->outbound_message_memory_pool);
 
+    /*
+     * Use size classes for the pools that recycle buffers. Buffers sent
+     * to other workers come back through the remote free list of the
+     * pool instead of the ring of clean outbound buffers.
+     */
+    core_memory_pool_enable_slab_mode(&worker->outbound_message_memory_pool);
+    core_memory_pool_enable_slab_mode(&worker->persistent_memory);
+
+    if (core_command_has_argument(argc, argv, OPTION_HUGE_PAGES)) {
+        core_memory_pool_enable_huge_pages(&worker->ephemeral_memory);
+        core_memory_pool_enable_huge_pages(&worker->outbound_message_memory_pool);
+        core_memory_pool_enable_huge_pages(&worker->persistent_memory);
+    }
+
+    /*
+     * Some blocks are created by the node thread (for example, the
+     * multiplexer allocates its timing wheel in the persistent pool of
+     * the worker), so the node is the one of the processor of the worker,
+     * not the one of the thread that creates the block.
+     */
+    if (core_command_has_argument(argc, argv, OPTION_LOCAL_NUMA_NODE)) {
+        numa_node = core_memory_get_processor_numa_node(processor);
+
+        core_memory_pool_set_numa_node(&worker->ephemeral_memory, numa_node);
+        core_memory_pool_set_numa_node(&worker->outbound_message_memory_pool, numa_node);
+        core_memory_pool_set_numa_node(&worker->persistent_memory, numa_node);
+    }
+
+    if (core_command_has_argument(argc, argv, OPTION_DIRECT_LOCAL_DELIVERY)) {
+        CORE_BITMAP_SET_FLAG(worker->flags, FLAG_DIRECT_LOCAL_DELIVERY);
+    }
+
     worker->ticks_without_production = 0;
 
     thorium_priority_assigner_init(&worker->assigner, thorium_worker_name(worker));
@@ -400,6 +502,9 @@ void thorium_worker_destroy(struct thorium_worker *worker)
         core_buffered_file_writer_destroy(&worker->load_profile_writer);
     }
 
+    thorium_event_tracer_destroy(&worker->event_tracer);
+    thorium_action_profiler_destroy(&worker->action_profiler);
+
     core_map_destroy(&worker->actor_received_messages);
 
     /*
@@ -453,12 +558,17 @@ void thorium_worker_destroy(struct thorium_worker *worker)
 
     thorium_scheduler_destroy(&worker->scheduler);
 
+    core_fast_ring_destroy(&worker->input_returned_actor_ring);
+    core_queue_destroy(&worker->output_returned_actor_queue);
+
 #ifndef THORIUM_WORKER_USE_MULTIPLE_PRODUCER_RING
     core_fast_ring_destroy(&worker->output_outbound_message_ring);
 #endif
 
     core_queue_destroy(&worker->output_outbound_message_queue);
 
+    core_queue_destroy(&worker->local_delivery_queue);
+
     core_map_destroy(&worker->actors);
     core_map_iterator_destroy(&worker->actor_iterator);
     core_set_destroy(&worker->evicted_actors);
@@ -512,6 +622,10 @@ void thorium_worker_send(struct thorium_worker *worker, struct thorium_message *
 
     tracepoint(thorium_message, worker_send, message);
 
+    THORIUM_EVENT_TRACER_RECORD(&self->event_tracer, THORIUM_TRACE_EVENT_ACTOR_SEND,
+                    thorium_message_source(message), thorium_message_destination(message),
+                    thorium_message_action(message), thorium_message_count(message));
+
     action = thorium_message_action(message);
 
     /*
@@ -1019,6 +1133,10 @@ int thorium_worker_dequeue_actor(struct thorium_worker *worker, struct thorium_a
 #endif
     }
 
+    if (CORE_BITMAP_GET_FLAG(worker->flags, FLAG_WORK_STEALING)) {
+        return thorium_worker_dequeue_actor_with_stealing(worker, actor);
+    }
+
     /* Now, dequeue an actor from the real queue.
      * If it has more than 1 message, re-enqueue it
      */
@@ -1199,6 +1317,8 @@ void thorium_worker_evict_actor(struct thorium_worker *worker, int actor_name)
     int value;
     */
 
+    CORE_DEBUGGER_ASSERT(!CORE_BITMAP_GET_FLAG(worker->flags, FLAG_WORK_STEALING));
+
     core_set_add(&worker->evicted_actors, &actor_name);
     core_map_delete(&worker->actors, &actor_name);
     core_queue_init(&saved_actors, sizeof(struct thorium_actor *));
@@ -1262,6 +1382,11 @@ void thorium_worker_unlock(struct thorium_worker *worker)
 }
 #endif
 
+int thorium_worker_uses_work_stealing(struct thorium_worker *self)
+{
+    return CORE_BITMAP_GET_FLAG(self->flags, FLAG_WORK_STEALING);
+}
+
 struct core_map *thorium_worker_get_actors(struct thorium_worker *worker)
 {
     return &worker->actors;
@@ -1739,6 +1864,10 @@ void thorium_worker_run(struct thorium_worker *worker)
         thorium_worker_send_to_other_node(worker, &other_message);
     }
 
+    if (!core_queue_empty(&worker->local_delivery_queue)) {
+        thorium_worker_flush_local_delivery(worker);
+    }
+
 #ifdef THORIUM_NODE_INJECT_CLEAN_WORKER_BUFFERS
     /*
      * Free outbound buffers, if any
@@ -1866,6 +1995,7 @@ static void thorium_worker_work(struct thorium_worker *worker, struct thorium_ac
     int dead;
     int actor_name;
     int status;
+    struct core_memory_pool_scope scope;
 
 #ifdef THORIUM_WORKER_DEBUG
     int tag;
@@ -1914,6 +2044,15 @@ static void thorium_worker_work(struct thorium_worker *worker, struct thorium_ac
         return;
     }
 
+    /*
+     * The actor was taken from the scheduler of a sibling.
+     */
+    if (CORE_BITMAP_GET_FLAG(worker->flags, FLAG_WORK_STEALING)
+                    && thorium_actor_assigned_worker(actor) != worker->name) {
+        thorium_worker_work_on_stolen_actor(worker, actor);
+        return;
+    }
+
     /* call the actor receive code
      */
     thorium_actor_set_worker(actor, worker);
@@ -1923,13 +2062,19 @@ static void thorium_worker_work(struct thorium_worker *worker, struct thorium_ac
         CORE_BITMAP_SET_FLAG(worker->flags, FLAG_USE_MULTIPLEXER);
     }
 
+    /*
+     * Everything allocated in the ephemeral memory while the
+     * message is received is released at the end of the scope.
+     */
+    core_memory_pool_begin_scope(&worker->ephemeral_memory, &scope);
+
     thorium_actor_work(actor);
 
     CORE_BITMAP_CLEAR_FLAG(worker->flags, FLAG_USE_MULTIPLEXER);
 
     /* Free ephemeral memory
      */
-    core_memory_pool_free_all(&worker->ephemeral_memory);
+    core_memory_pool_end_scope(&worker->ephemeral_memory, &scope);
 
     dead = thorium_actor_dead(actor);
 
@@ -1954,11 +2099,20 @@ static void thorium_worker_work(struct thorium_worker *worker, struct thorium_ac
     }
 #endif
 
+    /*
+     * With work stealing, the status does not change before the
+     * actor runs.
+     */
+    if (CORE_BITMAP_GET_FLAG(worker->flags, FLAG_WORK_STEALING)) {
+        if (!dead) {
+            thorium_worker_receive_returned_actor(worker, actor);
+        }
+
     /*
      * If the actor still has messages, schedule it again.
      */
-    core_map_get_value(&worker->actors, &actor_name, &status);
-    if (status == THORIUM_SCHEDULER_STATUS_IDLE
+    } else if (core_map_get_value(&worker->actors, &actor_name, &status)
+                    && status == THORIUM_SCHEDULER_STATUS_IDLE
                     && thorium_actor_get_mailbox_size(actor) > 0) {
 
         status = THORIUM_SCHEDULER_STATUS_SCHEDULED;
@@ -2140,6 +2294,13 @@ int thorium_worker_inject_clean_outbound_buffer(struct thorium_worker *self, voi
 {
     int value;
 
+    /*
+     * This does not need the ring if the pool takes remote frees.
+     */
+    if (core_memory_pool_free_remote(&self->outbound_message_memory_pool, buffer)) {
+        return 1;
+    }
+
     value = core_fast_ring_push_from_producer(&self->input_clean_outbound_buffer_ring,
                     &buffer);
 
@@ -2190,6 +2351,7 @@ void thorium_worker_examine(struct thorium_worker *self)
 
     core_memory_pool_examine(&self->ephemeral_memory);
     core_memory_pool_examine(&self->outbound_message_memory_pool);
+    core_memory_pool_examine(&self->persistent_memory);
 
 #ifndef THORIUM_WORKER_USE_MULTIPLE_PRODUCER_RING
     printf("RING (producer)= output_outbound_message_ring size= %d\n",
@@ -2197,6 +2359,16 @@ void thorium_worker_examine(struct thorium_worker *self)
 #endif
     printf("QUEUE= output_outbound_message_queue size= %d\n",
                     core_queue_size(&self->output_outbound_message_queue));
+    printf("LOCAL_DELIVERY direct= %" PRIu64 " node= %" PRIu64 " queued= %d\n",
+                    self->direct_local_delivery_count,
+                    self->node_local_delivery_count,
+                    core_queue_size(&self->local_delivery_queue));
+
+    printf("WORK_STEALING stolen_actors= %" PRIu64 " stolen_messages= %" PRIu64
+                    " returned_actor_queue= %d\n",
+                    self->stolen_actor_count,
+                    self->stolen_message_count,
+                    core_queue_size(&self->output_returned_actor_queue));
 
     printf("RING (consumer)= input_inbound_message_ring size= %d\n",
                     core_fast_ring_size_from_producer(&self->input_inbound_message_ring));
@@ -2239,6 +2411,26 @@ void thorium_worker_enable_profiler(struct thorium_worker *self)
     core_buffered_file_writer_printf(&self->load_profile_writer, THORIUM_ACTOR_PROFILER_HEADER);
 }
 
+void thorium_worker_enable_event_tracer(struct thorium_worker *self)
+{
+    thorium_event_tracer_enable(&self->event_tracer);
+}
+
+struct thorium_event_tracer *thorium_worker_get_event_tracer(struct thorium_worker *self)
+{
+    return &self->event_tracer;
+}
+
+void thorium_worker_enable_action_profiler(struct thorium_worker *self)
+{
+    thorium_action_profiler_enable(&self->action_profiler);
+}
+
+struct thorium_action_profiler *thorium_worker_get_action_profiler(struct thorium_worker *self)
+{
+    return &self->action_profiler;
+}
+
 void *thorium_worker_allocate(struct thorium_worker *self, size_t count)
 {
     void *buffer;
@@ -2570,6 +2762,25 @@ void thorium_worker_send_local_delivery(struct thorium_worker *self, struct thor
     destination_actor = thorium_node_get_actor_from_name(self->node, destination);
     message_was_pushed = 0;
 
+    /*
+     * With direct delivery, the node is never used for a living actor.
+     * A message waits behind the messages already waiting, even if its
+     * destination is another actor, so that the messages of this worker
+     * to an actor stay in order.
+     */
+    if (CORE_BITMAP_GET_FLAG(self->flags, FLAG_DIRECT_LOCAL_DELIVERY)
+                    && destination_actor != NULL) {
+
+        if (core_queue_empty(&self->local_delivery_queue)
+                    && thorium_worker_push_local_delivery(self, destination_actor, message)) {
+            ++self->direct_local_delivery_count;
+        } else {
+            core_queue_enqueue(&self->local_delivery_queue, message);
+        }
+
+        return;
+    }
+
     if (option_use_fast_delivery && destination_actor != NULL) {
 
         worker_index = thorium_actor_assigned_worker(destination_actor);
@@ -2577,17 +2788,76 @@ void thorium_worker_send_local_delivery(struct thorium_worker *self, struct thor
         if (worker_index != THORIUM_WORKER_NONE) {
             destination_worker = self->workers + worker_index;
 
-            if (thorium_worker_enqueue_inbound_message(destination_worker, message))
+            if (thorium_worker_enqueue_inbound_message(destination_worker, message)) {
                 message_was_pushed = 1;
+                ++self->direct_local_delivery_count;
+            }
         }
     }
 
     /*
      * Use the regular route if the fast path code path failed.
+     *
+     * An actor that never received a message has no worker yet,
+     * and the node places it.
      */
-    if (!message_was_pushed)
+    if (!message_was_pushed) {
         core_queue_enqueue(&self->output_outbound_message_queue,
                     message);
+        ++self->node_local_delivery_count;
+    }
+}
+
+/*
+ * The worker of the actor is read at the time of the push. An actor
+ * without a worker gets one here (round-robin over the workers),
+ * unless the node or another worker placed it first.
+ */
+static int thorium_worker_push_local_delivery(struct thorium_worker *self,
+                struct thorium_actor *actor, struct thorium_message *message)
+{
+    int worker_index;
+
+    worker_index = thorium_actor_assigned_worker(actor);
+
+    if (worker_index == THORIUM_WORKER_NONE) {
+        worker_index = thorium_actor_place_on_worker(actor, self->next_placement);
+
+        self->next_placement = (self->next_placement + 1) % self->worker_count;
+    }
+
+    return thorium_worker_enqueue_inbound_message(self->workers + worker_index, message);
+}
+
+void thorium_worker_flush_local_delivery(struct thorium_worker *self)
+{
+    struct thorium_message *message;
+    struct thorium_message delivered_message;
+    struct thorium_actor *actor;
+
+    while ((message = core_queue_peek(&self->local_delivery_queue)) != NULL) {
+
+        actor = thorium_node_get_actor_from_name(self->node,
+                        thorium_message_destination(message));
+
+        /*
+         * The actor died in the mean time: the node recycles the message.
+         */
+        if (actor == NULL) {
+            core_queue_dequeue(&self->local_delivery_queue, &delivered_message);
+            core_queue_enqueue(&self->output_outbound_message_queue, &delivered_message);
+            ++self->node_local_delivery_count;
+            continue;
+        }
+
+        if (!thorium_worker_push_local_delivery(self, actor, message)) {
+            break;
+        }
+
+        core_queue_dequeue(&self->local_delivery_queue, &delivered_message);
+
+        ++self->direct_local_delivery_count;
+    }
 }
 
 int thorium_worker_send_for_multiplexer(struct thorium_worker *self,
@@ -2643,6 +2913,178 @@ int thorium_worker_send_for_multiplexer(struct thorium_worker *self,
     return 1;
 }
 
+/*
+ * With work stealing, the assigned worker of an actor is still the
+ * only producer for its mailbox and the only owner of its status in
+ * worker->actors. An actor keeps the status
+ * THORIUM_SCHEDULER_STATUS_SCHEDULED while it is in a scheduler
+ * or running, so it is never in 2 schedulers at the same time.
+ */
+static int thorium_worker_dequeue_actor_with_stealing(struct thorium_worker *self,
+                struct thorium_actor **actor)
+{
+    struct thorium_actor *returned_actor;
+    struct thorium_worker *victim;
+    int attempts;
+    int name;
+    int status;
+
+    thorium_worker_flush_returned_actors(self);
+
+    while (core_fast_ring_pop_from_consumer(&self->input_returned_actor_ring, &returned_actor)) {
+        thorium_worker_receive_returned_actor(self, returned_actor);
+    }
+
+    if (thorium_scheduler_dequeue(&self->scheduler, actor)) {
+
+        if (thorium_actor_get_mailbox_size(*actor) > 0) {
+            return 1;
+        }
+
+        name = thorium_actor_name(*actor);
+        status = THORIUM_SCHEDULER_STATUS_IDLE;
+        core_map_update_value(&self->actors, &name, &status);
+
+        return 0;
+    }
+
+    if (self->worker_count < 2) {
+        return 0;
+    }
+
+    attempts = THORIUM_WORKER_STEAL_ATTEMPTS;
+
+    while (attempts--) {
+        victim = self->workers + thorium_worker_get_random_number(self) % self->worker_count;
+
+        if (victim == self) {
+            continue;
+        }
+
+        if (thorium_scheduler_steal(&victim->scheduler, actor)) {
+            ++self->stolen_actor_count;
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * Receive a batch of messages and give the actor back to its
+ * worker. Its worker destroys it if it died.
+ */
+static void thorium_worker_work_on_stolen_actor(struct thorium_worker *self,
+                struct thorium_actor *actor)
+{
+    struct core_memory_pool_scope scope;
+    int count;
+
+    count = thorium_actor_get_mailbox_size(actor);
+
+    if (count > THORIUM_WORKER_STEAL_BATCH_SIZE) {
+        count = THORIUM_WORKER_STEAL_BATCH_SIZE;
+    }
+
+    thorium_actor_set_worker(actor, self);
+    self->current_actor = actor;
+
+    if (thorium_actor_multiplexer_is_enabled(actor)) {
+        CORE_BITMAP_SET_FLAG(self->flags, FLAG_USE_MULTIPLEXER);
+    }
+
+    while (count-- && !thorium_actor_dead(actor)) {
+        core_memory_pool_begin_scope(&self->ephemeral_memory, &scope);
+
+        thorium_actor_work(actor);
+
+        core_memory_pool_end_scope(&self->ephemeral_memory, &scope);
+
+        ++self->stolen_message_count;
+    }
+
+    CORE_BITMAP_CLEAR_FLAG(self->flags, FLAG_USE_MULTIPLEXER);
+
+    thorium_actor_set_worker(actor, NULL);
+    self->current_actor = NULL;
+
+    thorium_worker_return_stolen_actor(self, actor);
+}
+
+static void thorium_worker_return_stolen_actor(struct thorium_worker *self,
+                struct thorium_actor *actor)
+{
+    struct thorium_worker *owner;
+
+    owner = self->workers + thorium_actor_assigned_worker(actor);
+
+    if (!core_queue_empty(&self->output_returned_actor_queue)
+                    || !core_fast_ring_push_from_producer(&owner->input_returned_actor_ring, &actor)) {
+        core_queue_enqueue(&self->output_returned_actor_queue, &actor);
+    }
+}
+
+static void thorium_worker_flush_returned_actors(struct thorium_worker *self)
+{
+    struct thorium_actor **bucket;
+    struct thorium_actor *actor;
+    struct thorium_worker *owner;
+
+    while ((bucket = core_queue_peek(&self->output_returned_actor_queue)) != NULL) {
+
+        owner = self->workers + thorium_actor_assigned_worker(*bucket);
+
+        if (!core_fast_ring_push_from_producer(&owner->input_returned_actor_ring, bucket)) {
+            break;
+        }
+
+        core_queue_dequeue(&self->output_returned_actor_queue, &actor);
+    }
+}
+
+/*
+ * This is called by the assigned worker of the actor after the actor
+ * received messages.
+ */
+static void thorium_worker_receive_returned_actor(struct thorium_worker *self,
+                struct thorium_actor *actor)
+{
+    struct thorium_message message;
+    int name;
+    int status;
+
+    name = thorium_actor_name(actor);
+
+    if (thorium_actor_dead(actor)) {
+
+        /*
+         * Messages that arrived after the death.
+         */
+        while (thorium_actor_dequeue_mailbox_message(actor, &message)) {
+            thorium_worker_free_message(self, &message);
+        }
+
+        core_map_delete(&self->actors, &name);
+
+        thorium_actor_set_worker(actor, self);
+
+        if (CORE_BITMAP_GET_FLAG(self->flags, FLAG_ENABLE_ACTOR_LOAD_PROFILER)) {
+            thorium_actor_write_profile(actor, &self->load_profile_writer);
+        }
+
+        thorium_node_notify_death(self->node, actor);
+
+        return;
+    }
+
+    if (thorium_actor_get_mailbox_size(actor) > 0) {
+        thorium_scheduler_enqueue(&self->scheduler, actor);
+    } else {
+        status = THORIUM_SCHEDULER_STATUS_IDLE;
+        core_map_update_value(&self->actors, &name, &status);
+    }
+}
+
 static void thorium_worker_send_to_other_node(struct thorium_worker *self,
                 struct thorium_message *message)
 {
@@ -11,6 +11,7 @@
 */
 
 #include "actor_profiler.h"
+#include "action_profiler.h"
 
 #include "scheduler/scheduler.h"
 #include "scheduler/priority_assigner.h"
@@ -18,6 +19,8 @@
 #include "transport/message_multiplexer.h"
 #include "transport/multiplexer_policy.h"
 
+#include <tracepoints/event_tracer.h>
+
 #include <core/structures/fast_ring.h>
 #include <core/structures/fast_queue.h>
 #include <core/structures/set.h>
@@ -119,6 +122,8 @@ struct thorium_worker {
 
     struct thorium_actor *current_actor;
     struct core_buffered_file_writer load_profile_writer;
+    struct thorium_event_tracer event_tracer;
+    struct thorium_action_profiler action_profiler;
     struct thorium_node *node;
 
     struct thorium_worker *workers;
@@ -186,6 +191,28 @@ struct thorium_worker {
      */
     struct core_queue output_outbound_message_queue;
 
+    /*
+     * With -direct-local-delivery, messages for actors of this node
+     * that do not fit in the inbound ring of their worker wait here, in
+     * the order in which they were sent, instead of going through the
+     * node. The worker of the destination is looked up when a message
+     * leaves the queue, so a migration does not reorder them.
+     */
+    struct core_queue local_delivery_queue;
+    int next_placement;
+    uint64_t direct_local_delivery_count;
+    uint64_t node_local_delivery_count;
+
+    /*
+     * With -work-stealing, actors taken by other workers come
+     * back to their assigned worker in this ring. Actors that do not
+     * fit in the ring of their worker wait in the queue.
+     */
+    struct core_fast_ring input_returned_actor_ring;
+    struct core_queue output_returned_actor_queue;
+    uint64_t stolen_actor_count;
+    uint64_t stolen_message_count;
+
     struct thorium_scheduler scheduler;
 
     struct core_set evicted_actors;
@@ -254,7 +281,13 @@ struct thorium_worker {
     uint64_t last_event_counters[THORIUM_EVENT_COUNT];
 };
 
-void thorium_worker_init(struct thorium_worker *self, int name, struct thorium_node *node);
+/*
+ * The processor is the one given later to thorium_worker_start (-1 for
+ * none). With -numa-local-memory, the blocks of the pools of the worker
+ * are bound to its NUMA node.
+ */
+void thorium_worker_init(struct thorium_worker *self, int name, struct thorium_node *node,
+                int processor);
 void thorium_worker_destroy(struct thorium_worker *self);
 
 void thorium_worker_start(struct thorium_worker *self, int processor);
@@ -289,7 +322,14 @@ int thorium_worker_enqueue_actor_special(struct thorium_worker *self, struct tho
 int thorium_worker_enqueue_message(struct thorium_worker *self, struct thorium_message *message);
 int thorium_worker_dequeue_message(struct thorium_worker *self, struct thorium_message *message);
 
+/*
+ * Remove an actor from the worker. This is called by the node thread
+ * (the balancer), so it is not available with -work-stealing: a thief
+ * can be running the actor or taking it from the scheduler at the same
+ * time.
+ */
 void thorium_worker_evict_actor(struct thorium_worker *self, int actor_name);
+int thorium_worker_uses_work_stealing(struct thorium_worker *self);
 
 #ifdef THORIUM_WORKER_ENABLE_LOCK
 void thorium_worker_lock(struct thorium_worker *self);
@@ -340,6 +380,12 @@ int thorium_worker_enqueue_outbound_message(struct thorium_worker *self,
 struct core_memory_pool *thorium_worker_get_outbound_message_memory_pool(struct thorium_worker *self);
 void thorium_worker_send_local_delivery(struct thorium_worker *self, struct thorium_message *message);
 
+/*
+ * Push the messages waiting for local delivery, in order. This is done
+ * by the worker loop.
+ */
+void thorium_worker_flush_local_delivery(struct thorium_worker *self);
+
 int thorium_worker_get_random_number(struct thorium_worker *self);
 
 int thorium_worker_latency(struct thorium_worker *self);
@@ -376,4 +422,10 @@ int thorium_worker_enqueue_message_for_multiplexer(struct thorium_worker *self,
 int thorium_worker_send_for_multiplexer(struct thorium_worker *self,
                 struct thorium_message *message);
 
+void thorium_worker_enable_event_tracer(struct thorium_worker *self);
+struct thorium_event_tracer *thorium_worker_get_event_tracer(struct thorium_worker *self);
+
+void thorium_worker_enable_action_profiler(struct thorium_worker *self);
+struct thorium_action_profiler *thorium_worker_get_action_profiler(struct thorium_worker *self);
+
 #endif
@@ -91,6 +91,7 @@ static void thorium_worker_pool_wake_up_workers(struct thorium_worker_pool *self
 static void thorium_worker_pool_examine_inbound_queue(struct thorium_worker_pool *self);
 
 static int thorium_worker_pool_give_message_to_worker(struct thorium_worker_pool *self, struct thorium_message *message);
+static int thorium_worker_pool_get_processor(struct thorium_worker_pool *self, int index);
 
 void thorium_worker_pool_init(struct thorium_worker_pool *pool, int workers,
                 struct thorium_node *node)
@@ -247,7 +248,8 @@ void thorium_worker_pool_create_workers(struct thorium_worker_pool *pool)
     for (i = 0; i < pool->worker_count; i++) {
 
         worker = thorium_worker_pool_get_worker(pool, i);
-        thorium_worker_init(worker, i, pool->node);
+        thorium_worker_init(worker, i, pool->node,
+                        thorium_worker_pool_get_processor(pool, i));
 
 #ifdef THORIUM_WORKER_USE_MULTIPLE_PRODUCER_RING
         /*
@@ -283,11 +285,7 @@ void thorium_worker_pool_start(struct thorium_worker_pool *pool)
      * used by the main thread...
      */
     for (i = 0; i < pool->worker_count; i++) {
-        processor = i;
-
-        if (thorium_node_nodes(pool->node) != 1) {
-            processor = -1;
-        }
+        processor = thorium_worker_pool_get_processor(pool, i);
 
         thorium_worker_start(thorium_worker_pool_get_worker(pool, i), processor);
     }
@@ -575,6 +573,18 @@ struct thorium_node *thorium_worker_pool_get_node(struct thorium_worker_pool *po
     return pool->node;
 }
 
+/*
+ * Workers are pinned to processors only when there is one node.
+ */
+static int thorium_worker_pool_get_processor(struct thorium_worker_pool *self, int index)
+{
+    if (thorium_node_nodes(self->node) != 1) {
+        return -1;
+    }
+
+    return index;
+}
+
 static int thorium_worker_pool_give_message_to_worker(struct thorium_worker_pool *pool, struct thorium_message *message)
 {
     struct thorium_worker *affinity_worker;
@@ -846,8 +856,8 @@ void thorium_worker_pool_assign_worker_to_actor(struct thorium_worker_pool *pool
 
 #ifdef THORIUM_WORKER_POOL_USE_SCRIPT_ROUND_ROBIN
     int script;
-    struct thorium_actor *actor;
 #endif
+    struct thorium_actor *actor;
 
                 /*
     thorium_printf("DEBUG Needs to do actor placement\n");
@@ -889,7 +899,15 @@ void thorium_worker_pool_assign_worker_to_actor(struct thorium_worker_pool *pool
     thorium_printf("ASSIGNING %d to %d\n", name, worker_index);
 #endif
 
-    thorium_balancer_set_actor_worker(&pool->balancer, name, worker_index);
+    /*
+     * With -direct-local-delivery, a worker can place the actor at the
+     * same time, and the first placement is kept.
+     */
+    actor = thorium_node_get_actor_from_name(pool->node, name);
+
+    if (actor != NULL) {
+        thorium_actor_place_on_worker(actor, worker_index);
+    }
 }
 
 float thorium_worker_pool_get_current_load(struct thorium_worker_pool *pool)
@@ -1189,6 +1207,96 @@ void thorium_worker_pool_enable_profiler(struct thorium_worker_pool *self)
     }
 }
 
+void thorium_worker_pool_enable_event_tracer(struct thorium_worker_pool *self)
+{
+    int i;
+    int size;
+    struct thorium_worker *worker;
+
+    size = thorium_worker_pool_worker_count(self);
+
+    for (i = 0; i < size; ++i) {
+
+        worker = thorium_worker_pool_get_worker(self, i);
+
+        thorium_worker_enable_event_tracer(worker);
+    }
+}
+
+int thorium_worker_pool_drain_events(struct thorium_worker_pool *self,
+                struct core_buffered_file_writer *writer)
+{
+    int i;
+    int size;
+    int count;
+    struct thorium_worker *worker;
+
+    size = thorium_worker_pool_worker_count(self);
+    count = 0;
+
+    for (i = 0; i < size; ++i) {
+
+        worker = thorium_worker_pool_get_worker(self, i);
+
+        count += thorium_event_tracer_drain(thorium_worker_get_event_tracer(worker), writer);
+    }
+
+    return count;
+}
+
+uint64_t thorium_worker_pool_dropped_event_count(struct thorium_worker_pool *self)
+{
+    int i;
+    int size;
+    uint64_t count;
+    struct thorium_worker *worker;
+
+    size = thorium_worker_pool_worker_count(self);
+    count = 0;
+
+    for (i = 0; i < size; ++i) {
+
+        worker = thorium_worker_pool_get_worker(self, i);
+
+        count += thorium_event_tracer_dropped_event_count(thorium_worker_get_event_tracer(worker));
+    }
+
+    return count;
+}
+
+void thorium_worker_pool_enable_action_profiler(struct thorium_worker_pool *self)
+{
+    int i;
+    int size;
+    struct thorium_worker *worker;
+
+    size = thorium_worker_pool_worker_count(self);
+
+    for (i = 0; i < size; ++i) {
+
+        worker = thorium_worker_pool_get_worker(self, i);
+
+        thorium_worker_enable_action_profiler(worker);
+    }
+}
+
+void thorium_worker_pool_merge_action_profiles(struct thorium_worker_pool *self,
+                struct thorium_action_profiler *profiler)
+{
+    int i;
+    int size;
+    struct thorium_worker *worker;
+
+    size = thorium_worker_pool_worker_count(self);
+
+    for (i = 0; i < size; ++i) {
+
+        worker = thorium_worker_pool_get_worker(self, i);
+
+        thorium_action_profiler_merge(profiler, thorium_worker_get_action_profiler(worker));
+    }
+}
+
 int thorium_worker_pool_buffered_message_count(struct thorium_worker_pool *self)
 {
     return core_queue_size(&self->inbound_message_queue_buffer);
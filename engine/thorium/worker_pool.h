@@ -121,6 +121,24 @@ int thorium_worker_pool_dequeue_message_for_triage(struct thorium_worker_pool *s
 
 void thorium_worker_pool_examine(struct thorium_worker_pool *self);
 void thorium_worker_pool_enable_profiler(struct thorium_worker_pool *self);
+void thorium_worker_pool_enable_event_tracer(struct thorium_worker_pool *self);
+
+/*
+ * Write the events of the workers.
+ *
+ * \return the number of events written
+ */
+int thorium_worker_pool_drain_events(struct thorium_worker_pool *self,
+                struct core_buffered_file_writer *writer);
+uint64_t thorium_worker_pool_dropped_event_count(struct thorium_worker_pool *self);
+
+void thorium_worker_pool_enable_action_profiler(struct thorium_worker_pool *self);
+
+/*
+ * Add the action profiles of the workers to <profiler>.
+ */
+void thorium_worker_pool_merge_action_profiles(struct thorium_worker_pool *self,
+                struct thorium_action_profiler *profiler);
 
 int thorium_worker_pool_buffered_message_count(struct thorium_worker_pool *self);
 int thorium_worker_pool_outbound_ring_size(struct thorium_worker_pool *self);
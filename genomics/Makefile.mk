@@ -12,6 +12,11 @@ GENOMICS_OBJECTS += genomics/storage/sequence_store.o
 GENOMICS_OBJECTS += genomics/storage/partition_command.o
 GENOMICS_OBJECTS += genomics/storage/sequence_partitioner.o
 GENOMICS_OBJECTS += genomics/storage/kmer_store.o
+GENOMICS_OBJECTS += genomics/storage/kmer_table.o
+GENOMICS_OBJECTS += genomics/storage/kmer_table_iterator.o
+GENOMICS_OBJECTS += genomics/storage/sharded_kmer_table.o
+GENOMICS_OBJECTS += genomics/storage/compact_kmer_table.o
+GENOMICS_OBJECTS += genomics/storage/compact_kmer_table_iterator.o
 
 include genomics/assembly/Makefile.mk
 
@@ -22,10 +27,15 @@ GENOMICS_OBJECTS += genomics/input/mega_block.o
 
 GENOMICS_OBJECTS += genomics/data/dna_sequence.o
 GENOMICS_OBJECTS += genomics/data/dna_kmer.o
+GENOMICS_OBJECTS += genomics/data/dna_kmer_extractor.o
+GENOMICS_OBJECTS += genomics/data/dna_minimizer.o
 GENOMICS_OBJECTS += genomics/data/dna_kmer_block.o
+GENOMICS_OBJECTS += genomics/data/dna_super_kmer_block.o
 GENOMICS_OBJECTS += genomics/data/dna_kmer_frequency_block.o
 GENOMICS_OBJECTS += genomics/data/coverage_distribution.o
 GENOMICS_OBJECTS += genomics/data/dna_codec.o
+GENOMICS_OBJECTS += genomics/data/dna_codec_word.o
+GENOMICS_OBJECTS += genomics/data/dna_codec_vector.o
 
 # formats
 GENOMICS_OBJECTS += genomics/formats/input_proxy.o
@@ -33,6 +43,7 @@ GENOMICS_OBJECTS += genomics/formats/input_format.o
 GENOMICS_OBJECTS += genomics/formats/input_format_interface.o
 GENOMICS_OBJECTS += genomics/formats/fastq_input.o
 GENOMICS_OBJECTS += genomics/formats/fasta_input.o
+GENOMICS_OBJECTS += genomics/formats/record_splitter.o
 
 LIBRARY_OBJECTS += $(GENOMICS_OBJECTS)
 
@@ -11,5 +11,6 @@ GENOMICS_OBJECTS += genomics/assembly/assembly_arc_classifier.o
 GENOMICS_OBJECTS += genomics/assembly/assembly_arc_block.o
 GENOMICS_OBJECTS += genomics/assembly/assembly_graph_summary.o
 GENOMICS_OBJECTS += genomics/assembly/vertex_neighborhood.o
+GENOMICS_OBJECTS += genomics/assembly/assembly_path_extension.o
 
 include genomics/assembly/unitig/Makefile.mk
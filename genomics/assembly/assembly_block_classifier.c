@@ -3,8 +3,14 @@
 
 #include <genomics/data/dna_kmer_block.h>
 #include <genomics/data/dna_kmer_frequency_block.h>
+#include <genomics/data/dna_kmer_extractor.h>
+#include <genomics/data/dna_super_kmer_block.h>
 #include <genomics/data/dna_kmer.h>
 
+#include <genomics/assembly/assembly_connectivity.h>
+
+#include <genomics/helpers/command.h>
+
 /*
  * For the message tags
  */
@@ -61,6 +67,10 @@ int biosal_assembly_block_classifier_pack(struct thorium_actor *actor, void *buf
 int biosal_assembly_block_classifier_unpack(struct thorium_actor *actor, void *buffer);
 int biosal_assembly_block_classifier_pack_size(struct thorium_actor *actor);
 
+static int biosal_assembly_block_classifier_get_arcs(struct thorium_actor *self,
+                void *encoded_sequence, int length, int position,
+                struct biosal_dna_kmer_extractor *extractor);
+
 struct thorium_script biosal_assembly_block_classifier_script = {
     .identifier = SCRIPT_ASSEMBLY_BLOCK_CLASSIFIER,
     .name = "biosal_assembly_block_classifier",
@@ -101,6 +111,9 @@ void biosal_assembly_block_classifier_init(struct thorium_actor *self)
     concrete_actor->active_requests = 0;
     concrete_actor->forced = 0;
 
+    concrete_actor->fused_graph_construction = biosal_command_use_fused_graph_construction(
+                    thorium_actor_argc(self), thorium_actor_argv(self));
+
     /* Enable cloning stuff
      */
     thorium_actor_send_to_self_empty(self, ACTION_PACK_ENABLE);
@@ -330,6 +343,10 @@ void biosal_assembly_block_classifier_flush(struct thorium_actor *self, int cust
                     &concrete_actor->persistent_pool, &concrete_actor->codec,
                         concrete_actor->customer_block_size);
 
+    if (concrete_actor->fused_graph_construction) {
+        biosal_dna_kmer_frequency_block_enable_arcs(customer_block_pointer);
+    }
+
     concrete_actor->flushed++;
 }
 
@@ -394,15 +411,24 @@ void biosal_assembly_block_classifier_aggregate_kernel_output(struct thorium_act
     int customer_count;
     struct biosal_dna_kmer_frequency_block *customer_block_pointer;
     int entries;
-    struct biosal_dna_kmer_block input_block;
+    struct biosal_dna_super_kmer_block input_block;
     struct biosal_dna_kmer_frequency_block *output_block;
-    struct core_vector *kmers;
     struct core_memory_pool *ephemeral_memory;
-    struct biosal_dna_kmer *kmer;
+    struct biosal_dna_kmer_extractor extractor;
+    struct biosal_dna_kmer kmer;
     int source;
     void *buffer;
     int customer_index;
     struct core_vector_iterator iterator;
+    int offset;
+    uint64_t minimizer;
+    int length;
+    int flanks;
+    int first;
+    int last;
+    int position;
+    int arcs;
+    void *encoded_sequence;
 
     concrete_actor = (struct biosal_assembly_block_classifier *)thorium_actor_concrete_actor(self);
 
@@ -432,9 +458,7 @@ void biosal_assembly_block_classifier_aggregate_kernel_output(struct thorium_act
 
     CORE_DEBUGGER_LEAK_DETECTION_BEGIN(ephemeral_memory, input);
 
-    biosal_dna_kmer_block_init_empty(&input_block);
-    biosal_dna_kmer_block_unpack(&input_block, buffer, ephemeral_memory,
-                        &concrete_actor->codec);
+    biosal_dna_super_kmer_block_unpack(&input_block, buffer);
 
 #ifdef BIOSAL_ASSEMBLY_BLOCK_CLASSIFIER_DEBUG
         BIOSAL_DEBUG_MARKER("assembly_block_classifier before loop");
@@ -442,29 +466,35 @@ void biosal_assembly_block_classifier_aggregate_kernel_output(struct thorium_act
 
     /*
      * classify the kmers according to their ownership
+     *
+     * All the kmers of a super kmer have the same minimizer, so they
+     * go in the same buffer (this is the store index given by
+     * biosal_dna_kmer_store_index).
      */
 
-    kmers = biosal_dna_kmer_block_kmers(&input_block);
-    entries = core_vector_size(kmers);
+    entries = biosal_dna_super_kmer_block_size(&input_block);
 
     customer_count = core_vector_size(&concrete_actor->consumers);
 
+    biosal_dna_kmer_extractor_init(&extractor, concrete_actor->kmer_length,
+                    &concrete_actor->codec, ephemeral_memory);
+
+    kmer.encoded_data = core_memory_pool_allocate(ephemeral_memory,
+                    biosal_dna_kmer_extractor_encoded_length(&extractor));
+
     /*
      * Actually populate buffers.
      */
-    for (i = 0; i < entries; i++) {
+    offset = 0;
 
-        CORE_DEBUGGER_LEAK_DETECTION_BEGIN(ephemeral_memory, iteration);
+    for (i = 0; i < entries; i++) {
 
-        kmer = (struct biosal_dna_kmer *)core_vector_at(kmers, i);
+        CORE_DEBUGGER_ASSERT(offset < biosal_dna_super_kmer_block_data_size(&input_block));
 
-        /*
-        biosal_dna_kmer_print(kmer);
-        biosal_dna_kmer_length(kmer);
-        */
+        offset = biosal_dna_super_kmer_block_get(&input_block, offset, &minimizer,
+                        &length, &flanks, &encoded_sequence, &concrete_actor->codec);
 
-        customer_index = biosal_dna_kmer_store_index(kmer, customer_count, concrete_actor->kmer_length,
-                        &concrete_actor->codec, ephemeral_memory);
+        customer_index = minimizer % customer_count;
 
         customer_block_pointer = (struct biosal_dna_kmer_frequency_block *)core_vector_at(&concrete_actor->buffers,
                         customer_index);
@@ -477,40 +507,55 @@ void biosal_assembly_block_classifier_aggregate_kernel_output(struct thorium_act
 #endif
 
         /*
-         * add kmer to buffer and try to flush
+         * The kmers that start on a flanking nucleotide belong to
+         * another super kmer.
          */
+        first = 0;
+        last = length - concrete_actor->kmer_length;
 
-        CORE_DEBUGGER_LEAK_DETECTION_BEGIN(ephemeral_memory, add);
+        if (flanks & BIOSAL_DNA_SUPER_KMER_FLANK_PARENT) {
+            ++first;
+        }
 
-        /* classify the kmer and put it in the good buffer.
-         */
-        biosal_dna_kmer_frequency_block_add_kmer(customer_block_pointer, kmer,
-                        &concrete_actor->persistent_pool,
-                        &concrete_actor->codec);
+        if (flanks & BIOSAL_DNA_SUPER_KMER_FLANK_CHILD) {
+            --last;
+        }
 
-        CORE_DEBUGGER_LEAK_DETECTION_END(ephemeral_memory, add);
+        biosal_dna_kmer_extractor_set_encoded_sequence(&extractor, length, encoded_sequence);
 
-        /*
-         * The Flush() action below is only required when using
-         * biosal_dna_kmer_block.
-         * biosal_dna_kmer_frequency_block does not require this
-         * flush operation.
+        /* classify the kmers and put them in the good buffer.
          */
-#if 0
-        /* Flush if necessary to avoid having very big buffers
-         */
-        if (0 && i % 32 == 0) {
-            biosal_assembly_block_classifier_flush(self, customer_index, &buffers, 0);
-        }
-#endif
+        position = 0;
 
-#ifdef BIOSAL_ASSEMBLY_BLOCK_CLASSIFIER_DEBUG
-        BIOSAL_DEBUG_MARKER("assembly_block_classifier before flush");
-#endif
+        while (biosal_dna_kmer_extractor_next(&extractor)) {
 
-        CORE_DEBUGGER_LEAK_DETECTION_END(ephemeral_memory, iteration);
+            if (position >= first && position <= last) {
+
+                biosal_dna_kmer_extractor_get_canonical_kmer(&extractor, kmer.encoded_data);
+
+                if (concrete_actor->fused_graph_construction) {
+                    arcs = biosal_assembly_block_classifier_get_arcs(self, encoded_sequence,
+                                    length, position, &extractor);
+
+                    biosal_dna_kmer_frequency_block_add_kmer_with_arcs(customer_block_pointer,
+                                    &kmer, arcs, &concrete_actor->persistent_pool,
+                                    &concrete_actor->codec);
+                } else {
+                    biosal_dna_kmer_frequency_block_add_kmer(customer_block_pointer, &kmer,
+                                    &concrete_actor->persistent_pool,
+                                    &concrete_actor->codec);
+                }
+            }
+
+            ++position;
+        }
     }
 
+    CORE_DEBUGGER_ASSERT(offset == biosal_dna_super_kmer_block_data_size(&input_block));
+
+    core_memory_pool_free(ephemeral_memory, kmer.encoded_data);
+    biosal_dna_kmer_extractor_destroy(&extractor);
+
 #ifdef BIOSAL_ASSEMBLY_BLOCK_CLASSIFIER_DEBUG
     BIOSAL_DEBUG_MARKER("assembly_block_classifier after loop");
 #endif
@@ -527,7 +572,7 @@ void biosal_assembly_block_classifier_aggregate_kernel_output(struct thorium_act
 
     /* destroy the local copy of the block
      */
-    biosal_dna_kmer_block_destroy(&input_block, ephemeral_memory);
+    biosal_dna_super_kmer_block_destroy(&input_block);
 
     CORE_DEBUGGER_LEAK_DETECTION_END(ephemeral_memory, input);
 
@@ -663,6 +708,10 @@ int biosal_assembly_block_classifier_set_consumers(struct thorium_actor *actor,
         biosal_dna_kmer_frequency_block_init(customer_block_pointer, concrete_actor->kmer_length,
                         &concrete_actor->persistent_pool, &concrete_actor->codec,
                         concrete_actor->customer_block_size);
+
+        if (concrete_actor->fused_graph_construction) {
+            biosal_dna_kmer_frequency_block_enable_arcs(customer_block_pointer);
+        }
     }
 
     return bytes;
@@ -758,3 +807,40 @@ void biosal_assembly_block_classifier_flush_all(struct thorium_actor *self)
 
     core_vector_iterator_destroy(&iterator);
 }
+
+/*
+ * Get the arcs of the kmer at @position in a super kmer, for the
+ * canonical kmer (biosal_assembly_graph_store_add_arc does the same
+ * thing with the arcs of arc kernels).
+ */
+static int biosal_assembly_block_classifier_get_arcs(struct thorium_actor *self,
+                void *encoded_sequence, int length, int position,
+                struct biosal_dna_kmer_extractor *extractor)
+{
+    struct biosal_assembly_block_classifier *concrete_self;
+    struct biosal_assembly_connectivity connectivity;
+    int parent;
+    int child;
+
+    concrete_self = thorium_actor_concrete_actor(self);
+
+    connectivity.bitmap = 0;
+    parent = BIOSAL_ASSEMBLY_CONNECTIVITY_NO_SYMBOL;
+    child = BIOSAL_ASSEMBLY_CONNECTIVITY_NO_SYMBOL;
+
+    if (position > 0) {
+        parent = biosal_dna_codec_get_nucleotide_code(&concrete_self->codec,
+                        encoded_sequence, position - 1);
+    }
+
+    if (position + concrete_self->kmer_length < length) {
+        child = biosal_dna_codec_get_nucleotide_code(&concrete_self->codec,
+                        encoded_sequence, position + concrete_self->kmer_length);
+    }
+
+    biosal_assembly_connectivity_add_read_arcs(&connectivity, parent, child,
+                    biosal_dna_kmer_extractor_is_canonical(extractor),
+                    biosal_dna_kmer_extractor_is_palindrome(extractor));
+
+    return connectivity.bitmap;
+}
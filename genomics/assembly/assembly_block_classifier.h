@@ -43,6 +43,12 @@ struct biosal_assembly_block_classifier {
 
     int consumer_count_with_maximum;
 
+    /*
+     * Send the arcs of the vertices too
+     * (with -fused-graph-construction).
+     */
+    int fused_graph_construction;
+
     /*
      * bins
      */
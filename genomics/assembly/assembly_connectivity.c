@@ -286,3 +286,36 @@ void biosal_assembly_connectivity_invert_arcs(struct biosal_assembly_connectivit
 
     biosal_assembly_connectivity_destroy(&copy);
 }
+
+void biosal_assembly_connectivity_add_arcs(struct biosal_assembly_connectivity *self, int bitmap)
+{
+    self->bitmap |= (uint8_t)bitmap;
+}
+
+void biosal_assembly_connectivity_add_read_arcs(struct biosal_assembly_connectivity *self,
+                int parent, int child, int is_canonical, int is_palindrome)
+{
+    if (is_canonical || is_palindrome) {
+
+        if (parent != BIOSAL_ASSEMBLY_CONNECTIVITY_NO_SYMBOL) {
+            biosal_assembly_connectivity_add_parent(self, parent);
+        }
+
+        if (child != BIOSAL_ASSEMBLY_CONNECTIVITY_NO_SYMBOL) {
+            biosal_assembly_connectivity_add_child(self, child);
+        }
+    }
+
+    if (!is_canonical || is_palindrome) {
+
+        if (parent != BIOSAL_ASSEMBLY_CONNECTIVITY_NO_SYMBOL) {
+            biosal_assembly_connectivity_add_child(self,
+                            biosal_dna_codec_get_complement(parent));
+        }
+
+        if (child != BIOSAL_ASSEMBLY_CONNECTIVITY_NO_SYMBOL) {
+            biosal_assembly_connectivity_add_parent(self,
+                            biosal_dna_codec_get_complement(child));
+        }
+    }
+}
@@ -16,6 +16,11 @@
  */
 #define BIOSAL_ASSEMBLY_CONNECTIVITY_OFFSET_CHILDREN BIOSAL_DNA_ALPHABET_SIZE
 
+/*
+ * No parent or no child in biosal_assembly_connectivity_add_read_arcs
+ */
+#define BIOSAL_ASSEMBLY_CONNECTIVITY_NO_SYMBOL -1
+
 /*
  * Connectivity
  */
@@ -62,4 +67,21 @@ void biosal_assembly_connectivity_init_copy(struct biosal_assembly_connectivity
                 struct biosal_assembly_connectivity *connectivity);
 void biosal_assembly_connectivity_invert_arcs(struct biosal_assembly_connectivity *self);
 
+/*
+ * Add all the arcs of a bitmap.
+ */
+void biosal_assembly_connectivity_add_arcs(struct biosal_assembly_connectivity *self, int bitmap);
+
+/*
+ * Add the arcs of a kmer seen in a read, with the symbol before it
+ * (parent) and the symbol after it (child), to the connectivity of the
+ * canonical kmer.
+ *
+ * The arcs are inverted (swapped and complemented) when the kmer is not
+ * canonical. A palindromic kmer is its own reverse complement, so it is
+ * seen in both orientations and gets the arcs of both.
+ */
+void biosal_assembly_connectivity_add_read_arcs(struct biosal_assembly_connectivity *self,
+                int parent, int child, int is_canonical, int is_palindrome);
+
 #endif
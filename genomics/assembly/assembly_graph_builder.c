@@ -179,6 +179,9 @@ void biosal_assembly_graph_builder_init(struct thorium_actor *self)
 
     concrete_self->expected_arc_count = 0;
 
+    concrete_self->fused_graph_construction = biosal_command_use_fused_graph_construction(
+                    thorium_actor_argc(self), thorium_actor_argv(self));
+
     biosal_assembly_graph_summary_init(&concrete_self->graph_summary);
 }
 
@@ -909,16 +912,19 @@ void biosal_assembly_graph_builder_tell_source(struct thorium_actor *self)
      * The current actor can not stop arc kernels directly.
      */
 
-    thorium_actor_send_empty(self, concrete_self->manager_for_arc_kernels, ACTION_ASK_TO_STOP);
-    thorium_actor_send_empty(self, concrete_self->manager_for_arc_classifiers, ACTION_ASK_TO_STOP);
+    if (!concrete_self->fused_graph_construction) {
+        thorium_actor_send_empty(self, concrete_self->manager_for_arc_kernels, ACTION_ASK_TO_STOP);
+        thorium_actor_send_empty(self, concrete_self->manager_for_arc_classifiers, ACTION_ASK_TO_STOP);
+
+        core_timer_stop(&concrete_self->arc_timer);
+        core_timer_print_with_description(&concrete_self->arc_timer,
+                        "Build assembly graph / Distribute arcs");
+    }
 
     /*
      * Show timer
      */
-    core_timer_stop(&concrete_self->arc_timer);
     core_timer_stop(&concrete_self->timer);
-    core_timer_print_with_description(&concrete_self->arc_timer,
-                    "Build assembly graph / Distribute arcs");
     core_timer_print_with_description(&concrete_self->timer,
                     "Build assembly graph");
 
@@ -1086,6 +1092,21 @@ void biosal_assembly_graph_builder_notify_from_distribution(struct thorium_actor
 
     core_timer_stop(&concrete_self->vertex_timer);
 
+    /*
+     * The graph stores already have the arcs, so there is no
+     * second pass on the sequences.
+     */
+    if (concrete_self->fused_graph_construction) {
+        core_timer_print_with_description(&concrete_self->vertex_timer,
+                        "Build assembly graph / Distribute vertices and arcs");
+
+        thorium_actor_add_action(self, ACTION_VERIFY_ARCS,
+                        biosal_assembly_graph_builder_verify_arcs);
+
+        thorium_actor_send_to_self_empty(self, ACTION_VERIFY_ARCS);
+        return;
+    }
+
     core_timer_start(&concrete_self->arc_timer);
     core_timer_print_with_description(&concrete_self->vertex_timer,
                     "Build assembly graph / Distribute vertices");
@@ -71,6 +71,12 @@ struct biosal_assembly_graph_builder {
 
     uint64_t expected_arc_count;
 
+    /*
+     * Vertices and arcs are distributed in one pass
+     * (with -fused-graph-construction).
+     */
+    int fused_graph_construction;
+
     /*
      * Summary data
      */
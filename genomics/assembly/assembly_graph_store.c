@@ -3,6 +3,7 @@
 
 #include "assembly_arc_kernel.h"
 #include "assembly_arc_block.h"
+#include "assembly_path_extension.h"
 
 #include "assembly_vertex.h"
 
@@ -17,7 +18,6 @@
 
 #include <genomics/data/dna_kmer.h>
 #include <genomics/data/dna_kmer_block.h>
-#include <genomics/data/dna_kmer_frequency_block.h>
 
 #include <genomics/helpers/command.h>
 
@@ -28,6 +28,7 @@
 #include <core/structures/vector_iterator.h>
 
 #include <core/system/debugger.h>
+#include <core/system/atomic.h>
 
 /*
 #include <engine/thorium/scheduler/fifo_scheduler.h>
@@ -44,6 +45,26 @@
 #define MEMORY_POOL_NAME_OTHER             0x8b5b96d6
 #define MEMORY_POOL_NAME_GRAPH_STORE       0x89e9235d
 
+/*
+ * States of the table of the node.
+ */
+#define NODE_TABLE_NONE 0
+#define NODE_TABLE_INITIALIZING 1
+#define NODE_TABLE_READY 2
+#define NODE_TABLE_CLOSING 3
+
+/*
+ * With -node-graph-store, the graph stores of a node (a process) have
+ * their shard in this table.
+ *
+ * The users are the graph stores and the readers are the actors in
+ * biosal_assembly_graph_store_read_vertex.
+ */
+static struct biosal_sharded_kmer_table biosal_assembly_graph_store_node_table;
+static int biosal_assembly_graph_store_node_table_state = NODE_TABLE_NONE;
+static int biosal_assembly_graph_store_node_table_users = 0;
+static int biosal_assembly_graph_store_node_table_readers = 0;
+
 void biosal_assembly_graph_store_init(struct thorium_actor *actor);
 void biosal_assembly_graph_store_destroy(struct thorium_actor *actor);
 void biosal_assembly_graph_store_receive(struct thorium_actor *actor, struct thorium_message *message);
@@ -69,10 +90,22 @@ void biosal_assembly_graph_store_yield_reply_summary(struct thorium_actor *self,
 void biosal_assembly_graph_store_get_vertex(struct thorium_actor *self, struct thorium_message *message);
 void biosal_assembly_graph_store_get_starting_vertex(struct thorium_actor *self, struct thorium_message *message);
 
+/*
+ * This is the route for ACTION_ASSEMBLY_GET_PATH_EXTENSION.
+ */
+void biosal_assembly_graph_store_get_path_extension(struct thorium_actor *self, struct thorium_message *message);
+
+/*
+ * This is the route for ACTION_ASSEMBLY_RELEASE_PATH_EXTENSION.
+ */
+void biosal_assembly_graph_store_release_path_extension(struct thorium_actor *self, struct thorium_message *message);
+
 void biosal_assembly_graph_store_print_progress(struct thorium_actor *self);
 
 void biosal_assembly_graph_store_mark_as_used(struct thorium_actor *self,
                 struct biosal_assembly_vertex *vertex, int source, int path);
+void biosal_assembly_graph_store_release(struct thorium_actor *self,
+                struct biosal_assembly_vertex *vertex, int source, int path);
 void biosal_assembly_graph_store_mark_vertex_as_visited(struct thorium_actor *self, struct thorium_message *message);
 
 void biosal_assembly_graph_store_set_vertex_flag(struct thorium_actor *self,
@@ -80,6 +113,10 @@ void biosal_assembly_graph_store_set_vertex_flag(struct thorium_actor *self,
 struct biosal_assembly_vertex *biosal_assembly_graph_store_find_vertex(struct thorium_actor *self,
                 struct biosal_dna_kmer *kmer);
 
+static struct biosal_kmer_table_shard *biosal_assembly_graph_store_acquire_node_shard(struct thorium_actor *self,
+                int key_size, int value_size);
+static void biosal_assembly_graph_store_release_node_shard(struct thorium_actor *self);
+
 struct thorium_script biosal_assembly_graph_store_script = {
     .identifier = SCRIPT_ASSEMBLY_GRAPH_STORE,
     .name = "biosal_assembly_graph_store",
@@ -110,6 +147,11 @@ void biosal_assembly_graph_store_init(struct thorium_actor *self)
     concrete_self->kmer_length = -1;
     concrete_self->received = 0;
 
+    concrete_self->shard = NULL;
+    concrete_self->table = NULL;
+    concrete_self->node_graph_store = biosal_command_use_node_graph_store(thorium_actor_argc(self),
+                    thorium_actor_argv(self));
+
     biosal_assembly_graph_summary_init(&concrete_self->graph_summary);
 
     biosal_dna_codec_init(&concrete_self->transport_codec);
@@ -153,6 +195,12 @@ void biosal_assembly_graph_store_init(struct thorium_actor *self)
     thorium_actor_add_action(self, ACTION_ASSEMBLY_GET_STARTING_KMER,
                     biosal_assembly_graph_store_get_starting_vertex);
 
+    thorium_actor_add_action(self, ACTION_ASSEMBLY_GET_PATH_EXTENSION,
+                    biosal_assembly_graph_store_get_path_extension);
+
+    thorium_actor_add_action(self, ACTION_ASSEMBLY_RELEASE_PATH_EXTENSION,
+                    biosal_assembly_graph_store_release_path_extension);
+
     thorium_actor_add_action(self, ACTION_MARK_VERTEX_AS_VISITED,
                     biosal_assembly_graph_store_mark_vertex_as_visited);
     thorium_actor_add_action(self, ACTION_SET_VERTEX_FLAG,
@@ -180,7 +228,14 @@ void biosal_assembly_graph_store_destroy(struct thorium_actor *self)
     biosal_assembly_graph_summary_destroy(&concrete_self->graph_summary);
 
     if (concrete_self->kmer_length != -1) {
-        core_map_destroy(&concrete_self->table);
+        if (concrete_self->node_graph_store) {
+            biosal_assembly_graph_store_release_node_shard(self);
+        } else {
+            biosal_kmer_table_shard_destroy(&concrete_self->local_shard);
+        }
+
+        concrete_self->shard = NULL;
+        concrete_self->table = NULL;
     }
 
     biosal_dna_codec_destroy(&concrete_self->transport_codec);
@@ -226,26 +281,20 @@ void biosal_assembly_graph_store_receive(struct thorium_actor *self, struct thor
         big_key_size = concrete_self->key_length_in_bytes;
         big_value_size = sizeof(struct biosal_assembly_vertex);
 
-        core_map_init(&concrete_self->table, big_key_size,
-                        big_value_size);
-        core_map_set_memory_pool(&concrete_self->table,
-                        &concrete_self->persistent_memory);
+        if (concrete_self->node_graph_store) {
+            concrete_self->shard = biosal_assembly_graph_store_acquire_node_shard(self,
+                            big_key_size, big_value_size);
+        } else {
+            biosal_kmer_table_shard_init(&concrete_self->local_shard, thorium_actor_name(self),
+                            big_key_size, big_value_size);
+            concrete_self->shard = &concrete_self->local_shard;
+        }
+
+        concrete_self->table = biosal_kmer_table_shard_table(concrete_self->shard);
 
         thorium_actor_log(self, "DEBUG big_key_size %d big_value_size %d\n", big_key_size, big_value_size);
         thorium_actor_log(self, " node %d", thorium_actor_node_name(self));
 
-        /*
-         * Configure the map for better performance.
-         */
-        core_map_disable_deletion_support(&concrete_self->table);
-
-        /*
-         * The threshold of the map is not very important because
-         * requests that hit the map have to first arrive as messages,
-         * which are slow.
-         */
-        core_map_set_threshold(&concrete_self->table, 0.95);
-
         /*
         if (NAME() == 1000066) {
             printf("DEBUG849 graph store ");
@@ -265,15 +314,15 @@ void biosal_assembly_graph_store_receive(struct thorium_actor *self, struct thor
         /*
          * Make sure the iterator is at the end of the line.
          */
-        CORE_DEBUGGER_ASSERT(!core_map_iterator_has_next(&concrete_self->iterator));
+        CORE_DEBUGGER_ASSERT(!biosal_kmer_table_iterator_has_next(&concrete_self->iterator));
 
         /*
          * Reset the iterator.
          */
-        core_map_iterator_init(&concrete_self->iterator, &concrete_self->table);
+        biosal_kmer_table_iterator_init(&concrete_self->iterator, concrete_self->table);
 
         CORE_DEBUGGER_ASSERT_IS_EQUAL_INT(concrete_self->iterated_vertex_count,
-                        (int)core_map_size(&concrete_self->table));
+                        (int)biosal_kmer_table_size(concrete_self->table));
 
         thorium_actor_log(self, "iterated_vertex_count %d unitig_vertex_count %d",
                         concrete_self->iterated_vertex_count,
@@ -287,7 +336,7 @@ void biosal_assembly_graph_store_receive(struct thorium_actor *self, struct thor
 
         thorium_message_unpack_double(message, 0, &value);
 
-        core_map_set_current_size_estimate(&concrete_self->table, value);
+        biosal_kmer_table_set_current_size_estimate(concrete_self->table, value);
 
     } else if (tag == ACTION_ASK_TO_STOP) {
 
@@ -344,7 +393,7 @@ void biosal_assembly_graph_store_receive(struct thorium_actor *self, struct thor
 
 void biosal_assembly_graph_store_print(struct thorium_actor *self)
 {
-    struct core_map_iterator iterator;
+    struct biosal_kmer_table_iterator iterator;
     struct biosal_dna_kmer kmer;
     void *key;
     struct biosal_assembly_vertex *value;
@@ -358,14 +407,14 @@ void biosal_assembly_graph_store_print(struct thorium_actor *self)
     ephemeral_memory = thorium_actor_get_ephemeral_memory(self);
     concrete_self = thorium_actor_concrete_actor(self);
 
-    core_map_iterator_init(&iterator, &concrete_self->table);
+    biosal_kmer_table_iterator_init(&iterator, concrete_self->table);
 
-    thorium_actor_log(self, "map size %d\n", (int)core_map_size(&concrete_self->table));
+    thorium_actor_log(self, "map size %d\n", (int)biosal_kmer_table_size(concrete_self->table));
 
     maximum_length = 0;
 
-    while (core_map_iterator_has_next(&iterator)) {
-        core_map_iterator_next(&iterator, (void **)&key, (void **)&value);
+    while (biosal_kmer_table_iterator_has_next(&iterator)) {
+        biosal_kmer_table_iterator_next(&iterator, (void **)&key, (void **)&value);
 
         biosal_dna_kmer_init_empty(&kmer);
         biosal_dna_kmer_unpack(&kmer, key, concrete_self->kmer_length,
@@ -389,11 +438,11 @@ void biosal_assembly_graph_store_print(struct thorium_actor *self)
 
     sequence = core_memory_pool_allocate(ephemeral_memory, maximum_length + 1);
     sequence[0] = '\0';
-    core_map_iterator_destroy(&iterator);
-    core_map_iterator_init(&iterator, &concrete_self->table);
+    biosal_kmer_table_iterator_destroy(&iterator);
+    biosal_kmer_table_iterator_init(&iterator, concrete_self->table);
 
-    while (core_map_iterator_has_next(&iterator)) {
-        core_map_iterator_next(&iterator, (void **)&key, (void **)&value);
+    while (biosal_kmer_table_iterator_has_next(&iterator)) {
+        biosal_kmer_table_iterator_next(&iterator, (void **)&key, (void **)&value);
 
         biosal_dna_kmer_init_empty(&kmer);
         biosal_dna_kmer_unpack(&kmer, key, concrete_self->kmer_length,
@@ -410,7 +459,7 @@ void biosal_assembly_graph_store_print(struct thorium_actor *self)
         biosal_dna_kmer_destroy(&kmer, thorium_actor_get_ephemeral_memory(self));
     }
 
-    core_map_iterator_destroy(&iterator);
+    biosal_kmer_table_iterator_destroy(&iterator);
     core_memory_pool_free(ephemeral_memory, sequence);
 }
 
@@ -429,14 +478,14 @@ void biosal_assembly_graph_store_push_data(struct thorium_actor *self, struct th
 
     thorium_actor_log(self, "%s/%d: local table has %" PRIu64" canonical kmers (%" PRIu64 " kmers)\n",
                         thorium_actor_script_name(self),
-                    name, core_map_size(&concrete_self->table),
-                    2 * core_map_size(&concrete_self->table));
+                    name, biosal_kmer_table_size(concrete_self->table),
+                    2 * biosal_kmer_table_size(concrete_self->table));
 
 #ifdef SHOW_MEMORY_POOL_STATUS
     core_memory_pool_examine(&concrete_self->persistent_memory);
 #endif
 
-    core_map_iterator_init(&concrete_self->iterator, &concrete_self->table);
+    biosal_kmer_table_iterator_init(&concrete_self->iterator, concrete_self->table);
 
     thorium_actor_send_to_self_empty(self, ACTION_YIELD);
 }
@@ -472,9 +521,9 @@ void biosal_assembly_graph_store_yield_reply(struct thorium_actor *self, struct
     value = NULL;
 
     while (i < max
-                    && core_map_iterator_has_next(&concrete_self->iterator)) {
+                    && biosal_kmer_table_iterator_has_next(&concrete_self->iterator)) {
 
-        core_map_iterator_next(&concrete_self->iterator, (void **)&key, (void **)&value);
+        biosal_kmer_table_iterator_next(&concrete_self->iterator, (void **)&key, (void **)&value);
 
         biosal_dna_kmer_init_empty(&kmer);
         biosal_dna_kmer_unpack(&kmer, key, concrete_self->kmer_length,
@@ -502,7 +551,7 @@ void biosal_assembly_graph_store_yield_reply(struct thorium_actor *self, struct
 
     /* yield again if the iterator is not at the end
      */
-    if (core_map_iterator_has_next(&concrete_self->iterator)) {
+    if (biosal_kmer_table_iterator_has_next(&concrete_self->iterator)) {
 
 #if 0
         thorium_actor_log(self, "yield ! %d\n", i);
@@ -517,7 +566,7 @@ void biosal_assembly_graph_store_yield_reply(struct thorium_actor *self, struct
     thorium_actor_log(self, "ready...\n");
     */
 
-    core_map_iterator_destroy(&concrete_self->iterator);
+    biosal_kmer_table_iterator_destroy(&concrete_self->iterator);
 
     new_count = core_map_pack_size(&concrete_self->coverage_distribution);
 
@@ -545,14 +594,13 @@ void biosal_assembly_graph_store_yield_reply(struct thorium_actor *self, struct
 void biosal_assembly_graph_store_push_kmer_block(struct thorium_actor *self, struct thorium_message *message)
 {
     struct core_memory_pool *ephemeral_memory;
-    struct biosal_dna_kmer_frequency_block block;
+    struct biosal_dna_kmer_block block;
     struct biosal_assembly_vertex *bucket;
-    void *packed_kmer;
-    struct core_map_iterator iterator;
     struct biosal_assembly_graph_store *concrete_self;
     /*int tag;*/
     void *key;
-    struct core_map *kmers;
+    int entries;
+    int i;
     struct biosal_dna_kmer kmer;
     void *buffer;
     int count;
@@ -560,8 +608,8 @@ void biosal_assembly_graph_store_push_kmer_block(struct thorium_actor *self, str
     char *raw_kmer;
     int period;
     struct biosal_dna_kmer *kmer_pointer;
-    int *frequency;
     int kmer_frequency;
+    int inserted;
 
     ephemeral_memory = thorium_actor_get_ephemeral_memory(self);
     concrete_self = thorium_actor_concrete_actor(self);
@@ -573,16 +621,12 @@ void biosal_assembly_graph_store_push_kmer_block(struct thorium_actor *self, str
      * Handler for PUSH_DATA
      */
 
-    biosal_dna_kmer_frequency_block_init(&block, concrete_self->kmer_length,
-                    ephemeral_memory, &concrete_self->transport_codec, 0);
-
-    biosal_dna_kmer_frequency_block_unpack(&block, buffer, ephemeral_memory,
+    biosal_dna_kmer_block_unpack(&block, buffer, ephemeral_memory,
                     &concrete_self->transport_codec);
 
     key = core_memory_pool_allocate(ephemeral_memory, concrete_self->key_length_in_bytes);
 
-    kmers = biosal_dna_kmer_frequency_block_kmers(&block);
-    core_map_iterator_init(&iterator, kmers);
+    entries = biosal_dna_kmer_block_size(&block);
 
     period = 2500000;
 
@@ -596,22 +640,21 @@ void biosal_assembly_graph_store_push_kmer_block(struct thorium_actor *self, str
         concrete_self->printed_vertex_size = 1;
     }
 
-    while (core_map_iterator_has_next(&iterator)) {
+    CORE_DEBUGGER_ASSERT(!biosal_kmer_table_shard_is_frozen(concrete_self->shard));
+
+    biosal_kmer_table_shard_begin_write(concrete_self->shard);
+
+    for (i = 0; i < entries; ++i) {
 
         /*
          * add kmers to store
          */
-        core_map_iterator_next(&iterator, (void **)&packed_kmer, (void **)&frequency);
-        kmer_frequency = *frequency;
+        biosal_dna_kmer_block_get_kmer(&block, i, &kmer);
+        kmer_frequency = biosal_dna_kmer_block_get_count(&block, i);
 
         /* Store the kmer in 2 bit encoding
          */
 
-        biosal_dna_kmer_init_empty(&kmer);
-        biosal_dna_kmer_unpack(&kmer, packed_kmer, concrete_self->kmer_length,
-                    ephemeral_memory,
-                    &concrete_self->transport_codec);
-
         kmer_pointer = &kmer;
 
         if (concrete_self->codec_are_different) {
@@ -640,13 +683,11 @@ void biosal_assembly_graph_store_push_kmer_block(struct thorium_actor *self, str
         }
 #endif
 
-        bucket = core_map_get(&concrete_self->table, key);
+        bucket = biosal_kmer_table_add(concrete_self->table, key, &inserted);
 
-        if (bucket == NULL) {
+        if (inserted) {
             /* This is the first time that this kmer is seen.
              */
-            bucket = core_map_add(&concrete_self->table, key);
-
             biosal_assembly_vertex_init(bucket);
 
 #if 0
@@ -661,17 +702,22 @@ void biosal_assembly_graph_store_push_kmer_block(struct thorium_actor *self, str
                         thorium_actor_get_ephemeral_memory(self));
         }
 
-        biosal_dna_kmer_destroy(&kmer, ephemeral_memory);
-
         biosal_assembly_vertex_increase_coverage_depth(bucket, kmer_frequency);
 
+        /*
+         * With -fused-graph-construction, the arcs come with the vertex.
+         */
+        if (biosal_dna_kmer_block_has_arcs(&block)) {
+            biosal_assembly_vertex_add_arcs(bucket, biosal_dna_kmer_block_get_arcs(&block, i));
+        }
+
         if (concrete_self->received >= concrete_self->last_received + period) {
             thorium_actor_log(self, "%s/%d received %" PRIu64 " kmers so far,"
                             " store has %" PRIu64 " canonical kmers, %" PRIu64 " kmers\n",
                         thorium_actor_script_name(self),
                             thorium_actor_name(self), concrete_self->received,
-                            core_map_size(&concrete_self->table),
-                            2 * core_map_size(&concrete_self->table));
+                            biosal_kmer_table_size(concrete_self->table),
+                            2 * biosal_kmer_table_size(concrete_self->table));
 
             concrete_self->last_received = concrete_self->received;
         }
@@ -679,11 +725,12 @@ void biosal_assembly_graph_store_push_kmer_block(struct thorium_actor *self, str
         concrete_self->received += kmer_frequency;
     }
 
+    biosal_kmer_table_shard_end_write(concrete_self->shard);
+
     core_memory_pool_free(ephemeral_memory, key);
     core_memory_pool_free(ephemeral_memory, raw_kmer);
 
-    core_map_iterator_destroy(&iterator);
-    biosal_dna_kmer_frequency_block_destroy(&block, thorium_actor_get_ephemeral_memory(self));
+    biosal_dna_kmer_block_destroy(&block, ephemeral_memory);
 
     thorium_actor_send_reply_empty(self, ACTION_PUSH_KMER_BLOCK_REPLY);
 }
@@ -738,6 +785,8 @@ void biosal_assembly_graph_store_push_arc_block(struct thorium_actor *self, stru
 
     key = core_memory_pool_allocate(ephemeral_memory, concrete_self->key_length_in_bytes);
 
+    biosal_kmer_table_shard_begin_write(concrete_self->shard);
+
     for (i = 0; i < size; i++) {
 
         arc = core_vector_at(input_arcs, i);
@@ -749,6 +798,8 @@ void biosal_assembly_graph_store_push_arc_block(struct thorium_actor *self, stru
         ++concrete_self->received_arc_count;
     }
 
+    biosal_kmer_table_shard_end_write(concrete_self->shard);
+
     core_memory_pool_free(ephemeral_memory, key);
 
     biosal_assembly_arc_block_destroy(&input_block);
@@ -774,7 +825,9 @@ void biosal_assembly_graph_store_add_arc(struct thorium_actor *self,
     int type;
     struct biosal_assembly_vertex *vertex;
     struct core_memory_pool *ephemeral_memory;
+    struct biosal_assembly_connectivity connectivity;
     int is_canonical;
+    int is_palindrome;
 
 #if 0
     /*
@@ -828,13 +881,13 @@ void biosal_assembly_graph_store_add_arc(struct thorium_actor *self,
                         concrete_self->kmer_length, &concrete_self->storage_codec,
                         ephemeral_memory);
 
-    vertex = core_map_get(&concrete_self->table, key);
+    vertex = biosal_kmer_table_get(concrete_self->table, key);
 
 #ifdef CORE_DEBUGGER_ASSERT_ENABLED
     if (vertex == NULL) {
         thorium_actor_log(self, "Error: vertex is NULL, key_length_in_bytes %d size %" PRIu64 "\n",
                         concrete_self->key_length_in_bytes,
-                        core_map_size(&concrete_self->table));
+                        biosal_kmer_table_size(concrete_self->table));
     }
 #endif
 
@@ -848,33 +901,29 @@ void biosal_assembly_graph_store_add_arc(struct thorium_actor *self,
 #endif
 
     /*
-     * Inverse the arc if the source is not canonical
+     * Inverse the arc if the source is not canonical, and add both
+     * orientations if the source is a palindrome.
      */
     is_canonical = biosal_dna_kmer_is_canonical(source, concrete_self->kmer_length,
                     &concrete_self->storage_codec);
+    is_palindrome = biosal_dna_kmer_is_palindrome(source, concrete_self->kmer_length,
+                    &concrete_self->storage_codec);
 
-    if (!is_canonical) {
-
-        if (type == BIOSAL_ARC_TYPE_PARENT) {
-            type = BIOSAL_ARC_TYPE_CHILD;
-
-        } else if (type == BIOSAL_ARC_TYPE_CHILD) {
-
-            type = BIOSAL_ARC_TYPE_PARENT;
-        }
-
-        destination = biosal_dna_codec_get_complement(destination);
-    }
+    biosal_assembly_connectivity_init(&connectivity);
 
     if (type == BIOSAL_ARC_TYPE_PARENT) {
 
-        biosal_assembly_vertex_add_parent(vertex, destination);
+        biosal_assembly_connectivity_add_read_arcs(&connectivity, destination,
+                        BIOSAL_ASSEMBLY_CONNECTIVITY_NO_SYMBOL, is_canonical, is_palindrome);
 
     } else if (type == BIOSAL_ARC_TYPE_CHILD) {
 
-        biosal_assembly_vertex_add_child(vertex, destination);
+        biosal_assembly_connectivity_add_read_arcs(&connectivity,
+                        BIOSAL_ASSEMBLY_CONNECTIVITY_NO_SYMBOL, destination, is_canonical, is_palindrome);
     }
 
+    biosal_assembly_vertex_add_arcs(vertex, connectivity.bitmap);
+
 #ifdef BIOSAL_ASSEMBLY_GRAPH_STORE_DEBUG_ARC
     if (verbose) {
         thorium_actor_log(self, "DEBUG AFTER:\n");
@@ -898,11 +947,17 @@ void biosal_assembly_graph_store_get_summary(struct thorium_actor *self, struct
     concrete_self->summary_in_progress = 1;
     concrete_self->source_for_summary = source;
 
+    /*
+     * The graph is built: vertices are only changed from now on, so
+     * the other actors of the node can read them.
+     */
+    biosal_kmer_table_shard_freeze(concrete_self->shard);
+
     thorium_actor_add_action_with_condition(self, ACTION_YIELD_REPLY,
                     biosal_assembly_graph_store_yield_reply_summary,
                     &concrete_self->summary_in_progress, 1);
 
-    core_map_iterator_init(&concrete_self->iterator, &concrete_self->table);
+    biosal_kmer_table_iterator_init(&concrete_self->iterator, concrete_self->table);
 
     thorium_actor_send_to_self_empty(self, ACTION_YIELD);
 }
@@ -929,9 +984,9 @@ void biosal_assembly_graph_store_yield_reply_summary(struct thorium_actor *self,
      * This loop gather canonical information only.
      */
     while (processed < limit
-                    && core_map_iterator_has_next(&concrete_self->iterator)) {
+                    && biosal_kmer_table_iterator_has_next(&concrete_self->iterator)) {
 
-        core_map_iterator_next(&concrete_self->iterator, NULL, (void **)&vertex);
+        biosal_kmer_table_iterator_next(&concrete_self->iterator, NULL, (void **)&vertex);
 
         coverage = biosal_assembly_vertex_coverage_depth(vertex);
 
@@ -956,7 +1011,7 @@ void biosal_assembly_graph_store_yield_reply_summary(struct thorium_actor *self,
         ++processed;
     }
 
-    if (core_map_iterator_has_next(&concrete_self->iterator)) {
+    if (biosal_kmer_table_iterator_has_next(&concrete_self->iterator)) {
 
         thorium_actor_send_to_self_empty(self, ACTION_YIELD);
 
@@ -976,8 +1031,8 @@ void biosal_assembly_graph_store_yield_reply_summary(struct thorium_actor *self,
          * Reset the iterator.
          */
 
-        core_map_iterator_destroy(&concrete_self->iterator);
-        core_map_iterator_init(&concrete_self->iterator, &concrete_self->table);
+        biosal_kmer_table_iterator_destroy(&concrete_self->iterator);
+        biosal_kmer_table_iterator_init(&concrete_self->iterator, concrete_self->table);
     }
 }
 
@@ -1051,25 +1106,205 @@ void biosal_assembly_graph_store_get_vertex(struct thorium_actor *self, struct t
 
     biosal_assembly_vertex_pack(&vertex, new_buffer);
 
+    /*
+     * Set the flag of the vertex (the reply has the vertex as it was).
+     * This is done before the reply so that a direct read
+     * (biosal_assembly_graph_store_read_vertex) made after the reply
+     * sees the flag.
+     */
+    if (action == ACTION_ASSEMBLY_GET_VERTEX_AND_SET_VISITOR_FLAG) {
+
+#ifdef DEBUG_CODE_PATH_9
+        thorium_actor_log(self, "DEBUG CODE PATH 9\n");
+#endif
+
+        flag = BIOSAL_VERTEX_FLAG_PROCESSED_BY_VISITOR;
+
+        biosal_kmer_table_shard_begin_write(concrete_self->shard);
+        biosal_assembly_vertex_set_flag(canonical_vertex, flag);
+        biosal_kmer_table_shard_end_write(concrete_self->shard);
+    }
+
     thorium_message_init(&new_message, ACTION_ASSEMBLY_GET_VERTEX_REPLY,
                     new_count, new_buffer);
 
     thorium_actor_send_reply(self, &new_message);
 
     thorium_message_destroy(&new_message);
+}
+
+void biosal_assembly_graph_store_get_path_extension(struct thorium_actor *self, struct thorium_message *message)
+{
+    struct biosal_assembly_graph_store *concrete_self;
+    struct core_memory_pool *ephemeral_memory;
+    struct biosal_dna_kmer kmer;
+    struct biosal_assembly_path_extension extension;
+    char *buffer;
+    char *new_buffer;
+    int new_count;
+    int position;
+    int direction;
+    int path;
+    int store_index;
+    int store_count;
+    int source;
+    int steps;
+    int claimed_steps;
+    int i;
+    struct biosal_assembly_vertex *canonical_vertex;
+
+    concrete_self = thorium_actor_concrete_actor(self);
+    ephemeral_memory = thorium_actor_get_ephemeral_memory(self);
+    buffer = thorium_message_buffer(message);
+    source = thorium_message_source(message);
+
+    biosal_dna_kmer_init_empty(&kmer);
+
+    position = 0;
+    position += biosal_dna_kmer_unpack(&kmer, buffer, concrete_self->kmer_length,
+                ephemeral_memory, &concrete_self->transport_codec);
+    position += thorium_message_unpack_int(message, position, &direction);
+    position += thorium_message_unpack_int(message, position, &path);
+    position += thorium_message_unpack_int(message, position, &store_index);
+    position += thorium_message_unpack_int(message, position, &store_count);
+
+    CORE_DEBUGGER_ASSERT_IS_EQUAL_INT(position, thorium_message_count(message));
 
     /*
-     * Set the flag of the vertex.
+     * Walk locally. The vertices of the steps are copied before they
+     * are claimed below.
      */
-    if (action == ACTION_ASSEMBLY_GET_VERTEX_AND_SET_VISITOR_FLAG) {
+    biosal_assembly_path_extension_init(&extension, concrete_self->table,
+                    concrete_self->kmer_length, concrete_self->key_length_in_bytes,
+                    &concrete_self->transport_codec, &concrete_self->storage_codec,
+                    ephemeral_memory);
 
-#ifdef DEBUG_CODE_PATH_9
-        thorium_actor_log(self, "DEBUG CODE PATH 9\n");
-#endif
+    steps = biosal_assembly_path_extension_walk(&extension, &kmer, direction,
+                    store_index, store_count, BIOSAL_ASSEMBLY_GRAPH_STORE_MAXIMUM_EXTENSION_LENGTH);
 
-        flag = BIOSAL_VERTEX_FLAG_PROCESSED_BY_VISITOR;
-        biosal_assembly_vertex_set_flag(canonical_vertex, flag);
+    biosal_dna_kmer_destroy(&kmer, ephemeral_memory);
+
+    /*
+     * Claim the steps for the path. This stops at the first vertex
+     * that is already used, by another path or earlier in this one,
+     * and the extension ends with it. The walker releases the
+     * claimed steps that it does not accept with
+     * ACTION_ASSEMBLY_RELEASE_PATH_EXTENSION.
+     */
+    claimed_steps = 0;
+
+    while (claimed_steps < steps) {
+        canonical_vertex = biosal_assembly_path_extension_canonical_vertex(&extension,
+                        claimed_steps);
+
+        if (!biosal_assembly_vertex_get_flag(canonical_vertex, BIOSAL_VERTEX_FLAG_UNITIG)
+                        || biosal_assembly_vertex_get_flag(canonical_vertex,
+                                BIOSAL_VERTEX_FLAG_USED_BY_WALKER)) {
+            break;
+        }
+
+        biosal_assembly_graph_store_mark_as_used(self, canonical_vertex, source, path);
+        ++claimed_steps;
+    }
+
+    if (claimed_steps + 1 < steps) {
+        steps = claimed_steps + 1;
+    }
+
+    new_count = sizeof(steps) + sizeof(claimed_steps);
+
+    for (i = 0; i < steps; ++i) {
+        new_count += biosal_dna_kmer_pack_size(biosal_assembly_path_extension_kmer(&extension, i),
+                        concrete_self->kmer_length, &concrete_self->transport_codec);
+        new_count += biosal_assembly_vertex_pack_size(biosal_assembly_path_extension_vertex(&extension, i));
+    }
+
+    new_buffer = thorium_actor_allocate(self, new_count);
+
+    position = 0;
+    core_memory_copy(new_buffer + position, &steps, sizeof(steps));
+    position += sizeof(steps);
+    core_memory_copy(new_buffer + position, &claimed_steps, sizeof(claimed_steps));
+    position += sizeof(claimed_steps);
+
+    for (i = 0; i < steps; ++i) {
+        position += biosal_dna_kmer_pack(biosal_assembly_path_extension_kmer(&extension, i),
+                        new_buffer + position, concrete_self->kmer_length,
+                        &concrete_self->transport_codec);
+        position += biosal_assembly_vertex_pack(biosal_assembly_path_extension_vertex(&extension, i),
+                        new_buffer + position);
+    }
+
+    CORE_DEBUGGER_ASSERT_IS_EQUAL_INT(position, new_count);
+
+    biosal_assembly_path_extension_destroy(&extension);
+
+    thorium_actor_send_reply_buffer(self, ACTION_ASSEMBLY_GET_PATH_EXTENSION_REPLY,
+                    new_count, new_buffer);
+}
+
+void biosal_assembly_graph_store_release_path_extension(struct thorium_actor *self, struct thorium_message *message)
+{
+    struct biosal_assembly_graph_store *concrete_self;
+    struct core_memory_pool *ephemeral_memory;
+    struct biosal_dna_kmer kmer;
+    struct biosal_assembly_path_extension extension;
+    char *buffer;
+    int position;
+    int direction;
+    int path;
+    int store_index;
+    int store_count;
+    int accepted_steps;
+    int claimed_steps;
+    int source;
+    int steps;
+    int i;
+
+    concrete_self = thorium_actor_concrete_actor(self);
+    ephemeral_memory = thorium_actor_get_ephemeral_memory(self);
+    buffer = thorium_message_buffer(message);
+    source = thorium_message_source(message);
+
+    biosal_dna_kmer_init_empty(&kmer);
+
+    position = 0;
+    position += biosal_dna_kmer_unpack(&kmer, buffer, concrete_self->kmer_length,
+                ephemeral_memory, &concrete_self->transport_codec);
+    position += thorium_message_unpack_int(message, position, &direction);
+    position += thorium_message_unpack_int(message, position, &path);
+    position += thorium_message_unpack_int(message, position, &store_index);
+    position += thorium_message_unpack_int(message, position, &store_count);
+    position += thorium_message_unpack_int(message, position, &accepted_steps);
+    position += thorium_message_unpack_int(message, position, &claimed_steps);
+
+    CORE_DEBUGGER_ASSERT_IS_EQUAL_INT(position, thorium_message_count(message));
+    CORE_DEBUGGER_ASSERT(accepted_steps < claimed_steps);
+
+    /*
+     * The arcs do not change during the walks, so walking again
+     * with the claimed length gives the claimed steps.
+     */
+    biosal_assembly_path_extension_init(&extension, concrete_self->table,
+                    concrete_self->kmer_length, concrete_self->key_length_in_bytes,
+                    &concrete_self->transport_codec, &concrete_self->storage_codec,
+                    ephemeral_memory);
+
+    steps = biosal_assembly_path_extension_walk(&extension, &kmer, direction,
+                    store_index, store_count, claimed_steps);
+
+    CORE_DEBUGGER_ASSERT_IS_EQUAL_INT(steps, claimed_steps);
+
+    for (i = accepted_steps; i < steps; ++i) {
+        biosal_assembly_graph_store_release(self,
+                        biosal_assembly_path_extension_canonical_vertex(&extension, i),
+                        source, path);
     }
+
+    biosal_assembly_path_extension_destroy(&extension);
+    biosal_dna_kmer_destroy(&kmer, ephemeral_memory);
+
+    thorium_actor_send_reply_empty(self, ACTION_ASSEMBLY_RELEASE_PATH_EXTENSION_REPLY);
 }
 
 void biosal_assembly_graph_store_get_starting_vertex(struct thorium_actor *self, struct thorium_message *message)
@@ -1104,12 +1339,12 @@ void biosal_assembly_graph_store_get_starting_vertex(struct thorium_actor *self,
     ephemeral_memory = thorium_actor_get_ephemeral_memory(self);
     minimum_coverage = biosal_command_get_minimum_coverage(argc, argv);
 
-    while (core_map_iterator_has_next(&concrete_self->iterator)) {
+    while (biosal_kmer_table_iterator_has_next(&concrete_self->iterator)) {
 
         storage_key = NULL;
         vertex = NULL;
 
-        core_map_iterator_next(&concrete_self->iterator, (void **)&storage_key,
+        biosal_kmer_table_iterator_next(&concrete_self->iterator, (void **)&storage_key,
                         (void **)&vertex);
 
         ++concrete_self->iterated_vertex_count;
@@ -1218,7 +1453,7 @@ void biosal_assembly_graph_store_get_starting_vertex(struct thorium_actor *self,
     }
 
     CORE_DEBUGGER_ASSERT_IS_EQUAL_INT(concrete_self->iterated_vertex_count,
-                        (int)core_map_size(&concrete_self->table));
+                        (int)biosal_kmer_table_size(concrete_self->table));
 
     /*
      * An empty reply means that the store has nothing more to yield.
@@ -1292,7 +1527,7 @@ void biosal_assembly_graph_store_print_progress(struct thorium_actor *self)
 
     concrete_self = thorium_actor_concrete_actor(self);
 
-    total = core_map_size(&concrete_self->table);
+    total = biosal_kmer_table_size(concrete_self->table);
     steps = 20;
     stride = total / steps;
 
@@ -1326,6 +1561,8 @@ void biosal_assembly_graph_store_mark_as_used(struct thorium_actor *self,
 
     concrete_self = thorium_actor_concrete_actor(self);
 
+    biosal_kmer_table_shard_begin_write(concrete_self->shard);
+
     if (!biosal_assembly_vertex_get_flag(vertex, BIOSAL_VERTEX_FLAG_USED_BY_WALKER)) {
         biosal_assembly_vertex_set_flag(vertex, BIOSAL_VERTEX_FLAG_USED_BY_WALKER);
         ++concrete_self->consumed_canonical_vertex_count;
@@ -1339,6 +1576,31 @@ void biosal_assembly_graph_store_mark_as_used(struct thorium_actor *self,
 #endif
 
     biosal_assembly_vertex_set_last_actor(vertex, source, path);
+
+    biosal_kmer_table_shard_end_write(concrete_self->shard);
+}
+
+/*
+ * Give back a vertex claimed by a path, unless another walker marked
+ * it since then.
+ */
+void biosal_assembly_graph_store_release(struct thorium_actor *self,
+                struct biosal_assembly_vertex *vertex, int source, int path)
+{
+    struct biosal_assembly_graph_store *concrete_self;
+
+    concrete_self = thorium_actor_concrete_actor(self);
+
+    if (!biosal_assembly_vertex_get_flag(vertex, BIOSAL_VERTEX_FLAG_USED_BY_WALKER)
+                    || biosal_assembly_vertex_last_actor(vertex) != source
+                    || biosal_assembly_vertex_last_path_index(vertex) != path) {
+        return;
+    }
+
+    biosal_kmer_table_shard_begin_write(concrete_self->shard);
+    biosal_assembly_vertex_clear_flag(vertex, BIOSAL_VERTEX_FLAG_USED_BY_WALKER);
+    --concrete_self->consumed_canonical_vertex_count;
+    biosal_kmer_table_shard_end_write(concrete_self->shard);
 }
 
 void biosal_assembly_graph_store_mark_vertex_as_visited(struct thorium_actor *self, struct thorium_message *message)
@@ -1384,7 +1646,7 @@ void biosal_assembly_graph_store_mark_vertex_as_visited(struct thorium_actor *se
                         ephemeral_memory);
 
     /* Get vertex. */
-    canonical_vertex = core_map_get(&concrete_self->table, key);
+    canonical_vertex = biosal_kmer_table_get(concrete_self->table, key);
 
     biosal_dna_kmer_destroy(&kmer, ephemeral_memory);
     biosal_dna_kmer_destroy(&storage_kmer, ephemeral_memory);
@@ -1451,7 +1713,9 @@ void biosal_assembly_graph_store_set_vertex_flag(struct thorium_actor *self,
 
     biosal_dna_kmer_destroy(&transport_kmer, ephemeral_memory);
 
+    biosal_kmer_table_shard_begin_write(concrete_self->shard);
     biosal_assembly_vertex_set_flag(vertex, flag);
+    biosal_kmer_table_shard_end_write(concrete_self->shard);
 
     thorium_actor_send_reply_empty(self, ACTION_SET_VERTEX_FLAG_REPLY);
 }
@@ -1483,7 +1747,7 @@ struct biosal_assembly_vertex *biosal_assembly_graph_store_find_vertex(struct th
                         concrete_self->kmer_length, &concrete_self->storage_codec,
                         ephemeral_memory);
 
-    canonical_vertex = core_map_get(&concrete_self->table, key);
+    canonical_vertex = biosal_kmer_table_get(concrete_self->table, key);
 
 #ifdef CORE_DEBUGGER_ASSERT
     if (canonical_vertex == NULL) {
@@ -1505,3 +1769,197 @@ struct biosal_assembly_vertex *biosal_assembly_graph_store_find_vertex(struct th
 
     return canonical_vertex;
 }
+
+/*
+ * The first graph store of the node creates the table of the node
+ * and the last one destroys it.
+ */
+static struct biosal_kmer_table_shard *biosal_assembly_graph_store_acquire_node_shard(struct thorium_actor *self,
+                int key_size, int value_size)
+{
+    struct biosal_kmer_table_shard *shard;
+
+    /*
+     * A table that is closing is created again once it is destroyed.
+     */
+    while (1) {
+        if (core_atomic_compare_and_swap_int(&biosal_assembly_graph_store_node_table_state,
+                                NODE_TABLE_NONE, NODE_TABLE_INITIALIZING)) {
+
+            biosal_sharded_kmer_table_init(&biosal_assembly_graph_store_node_table,
+                            key_size, value_size);
+
+            core_atomic_compare_and_swap_int(&biosal_assembly_graph_store_node_table_state,
+                                NODE_TABLE_INITIALIZING, NODE_TABLE_READY);
+        }
+
+        if (core_atomic_read_int(&biosal_assembly_graph_store_node_table_state) == NODE_TABLE_READY) {
+            break;
+        }
+
+        core_atomic_spin();
+    }
+
+    CORE_DEBUGGER_ASSERT_IS_EQUAL_INT(key_size,
+                    biosal_sharded_kmer_table_key_size(&biosal_assembly_graph_store_node_table));
+
+    core_atomic_increment(&biosal_assembly_graph_store_node_table_users);
+
+    shard = biosal_sharded_kmer_table_add_shard(&biosal_assembly_graph_store_node_table,
+                    thorium_actor_name(self));
+
+    thorium_actor_log(self, "%s/%d uses a shard of the table of node %d\n",
+                    thorium_actor_script_name(self), thorium_actor_name(self),
+                    thorium_actor_node_name(self));
+
+    return shard;
+}
+
+/*
+ * New readers are turned away once the table is closing, and the
+ * table is destroyed after the last reader is gone.
+ */
+static void biosal_assembly_graph_store_release_node_shard(struct thorium_actor *self)
+{
+    if (core_atomic_add(&biosal_assembly_graph_store_node_table_users, -1) == 1) {
+
+        core_atomic_compare_and_swap_int(&biosal_assembly_graph_store_node_table_state,
+                            NODE_TABLE_READY, NODE_TABLE_CLOSING);
+
+        while (core_atomic_read_int(&biosal_assembly_graph_store_node_table_readers) != 0) {
+            core_atomic_spin();
+        }
+
+        biosal_sharded_kmer_table_destroy(&biosal_assembly_graph_store_node_table);
+
+        core_atomic_compare_and_swap_int(&biosal_assembly_graph_store_node_table_state,
+                            NODE_TABLE_CLOSING, NODE_TABLE_NONE);
+    }
+}
+
+/*
+ * The reader is counted before the state is checked, so the last graph
+ * store either sees it or it sees NODE_TABLE_CLOSING.
+ */
+static int biosal_assembly_graph_store_begin_node_table_read(void)
+{
+    core_atomic_increment(&biosal_assembly_graph_store_node_table_readers);
+
+    if (core_atomic_read_int(&biosal_assembly_graph_store_node_table_state) != NODE_TABLE_READY) {
+        core_atomic_add(&biosal_assembly_graph_store_node_table_readers, -1);
+        return 0;
+    }
+
+    return 1;
+}
+
+static void biosal_assembly_graph_store_end_node_table_read(void)
+{
+    core_atomic_add(&biosal_assembly_graph_store_node_table_readers, -1);
+}
+
+int biosal_assembly_graph_store_read_vertex(int store, struct biosal_dna_kmer *kmer,
+                int kmer_length, struct biosal_dna_codec *codec, struct core_memory_pool *memory,
+                struct biosal_assembly_vertex *vertex)
+{
+    struct biosal_kmer_table_shard *shard;
+    struct biosal_dna_codec storage_codec;
+    struct biosal_dna_kmer storage_kmer;
+    struct biosal_dna_kmer *storage_kmer_pointer;
+    char *sequence;
+    void *key;
+    int found;
+
+    if (!biosal_assembly_graph_store_begin_node_table_read()) {
+        return 0;
+    }
+
+    /*
+     * The store is on another node, or does not use -node-graph-store.
+     */
+    shard = biosal_sharded_kmer_table_get_shard(&biosal_assembly_graph_store_node_table, store);
+
+    if (shard == NULL) {
+        biosal_assembly_graph_store_end_node_table_read();
+        return 0;
+    }
+
+    /*
+     * The store is still adding vertices.
+     */
+    if (!biosal_kmer_table_shard_is_frozen(shard)) {
+        biosal_assembly_graph_store_end_node_table_read();
+        return 0;
+    }
+
+    /*
+     * Get the store key in the storage codec (2-bit encoding).
+     */
+    biosal_dna_codec_init(&storage_codec);
+    biosal_dna_codec_enable_two_bit_encoding(&storage_codec);
+
+    sequence = NULL;
+    storage_kmer_pointer = kmer;
+
+    if (!codec->use_two_bit_encoding) {
+        sequence = core_memory_pool_allocate(memory, kmer_length + 1);
+        biosal_dna_kmer_get_sequence(kmer, sequence, kmer_length, codec);
+        biosal_dna_kmer_init(&storage_kmer, sequence, &storage_codec, memory);
+        storage_kmer_pointer = &storage_kmer;
+    }
+
+    key = core_memory_pool_allocate(memory,
+                    biosal_sharded_kmer_table_key_size(&biosal_assembly_graph_store_node_table));
+
+    biosal_dna_kmer_pack_store_key(storage_kmer_pointer, key, kmer_length, &storage_codec,
+                    memory);
+
+    found = biosal_kmer_table_shard_read(shard, key, vertex);
+
+    biosal_assembly_graph_store_end_node_table_read();
+
+    /*
+     * A miss is not an error here: the caller sends
+     * ACTION_ASSEMBLY_GET_VERTEX and the graph store handles it.
+     */
+    if (found && !biosal_dna_kmer_is_canonical(kmer, kmer_length, codec)) {
+        biosal_assembly_vertex_invert_arcs(vertex);
+    }
+
+    core_memory_pool_free(memory, key);
+
+    if (sequence != NULL) {
+        biosal_dna_kmer_destroy(&storage_kmer, memory);
+        core_memory_pool_free(memory, sequence);
+    }
+
+    biosal_dna_codec_destroy(&storage_codec);
+
+    return found;
+}
+
+void biosal_assembly_graph_store_invalidate_cached_vertex(struct thorium_actor *self,
+                int store, struct biosal_dna_kmer *kmer, int kmer_length,
+                struct biosal_dna_codec *codec, struct core_memory_pool *memory)
+{
+    struct biosal_dna_kmer reverse_complement;
+    void *buffer;
+    int count;
+
+    count = biosal_dna_kmer_pack_size(kmer, kmer_length, codec);
+    buffer = core_memory_pool_allocate(memory, count);
+
+    biosal_dna_kmer_pack(kmer, buffer, kmer_length, codec);
+    thorium_actor_invalidate_message_cache(self, store, ACTION_ASSEMBLY_GET_VERTEX,
+                    count, buffer);
+
+    biosal_dna_kmer_init_copy(&reverse_complement, kmer, kmer_length, memory, codec);
+    biosal_dna_kmer_reverse_complement_self(&reverse_complement, kmer_length, codec, memory);
+
+    biosal_dna_kmer_pack(&reverse_complement, buffer, kmer_length, codec);
+    thorium_actor_invalidate_message_cache(self, store, ACTION_ASSEMBLY_GET_VERTEX,
+                    count, buffer);
+
+    biosal_dna_kmer_destroy(&reverse_complement, memory);
+    core_memory_pool_free(memory, buffer);
+}
@@ -12,6 +12,10 @@
 
 #include <genomics/data/coverage_distribution.h>
 
+#include <genomics/storage/kmer_table.h>
+#include <genomics/storage/kmer_table_iterator.h>
+#include <genomics/storage/sharded_kmer_table.h>
+
 #include <core/structures/map_iterator.h>
 #include <core/structures/map.h>
 
@@ -20,6 +24,7 @@
 struct biosal_assembly_vertex;
 struct biosal_assembly_arc;
 struct biosal_dna_kmer;
+struct biosal_dna_codec;
 
 #define SCRIPT_ASSEMBLY_GRAPH_STORE 0xc81a1596
 
@@ -44,6 +49,38 @@ struct biosal_dna_kmer;
 #define ACTION_ASSEMBLY_GET_VERTEX_AND_SET_VISITOR_FLAG (BIOSAL_ASSEMBLY_GRAPH_STORE_ACTION_BASE + 12)
 #define ACTION_ASSEMBLY_GET_VERTEX_REPLY 0x00007724
 
+/*
+ * Walk from a vertex as long as the path is unambiguous and stays in
+ * the same store. The request is a packed kmer followed by the
+ * direction (BIOSAL_ASSEMBLY_GRAPH_STORE_DIRECTION_*), the path index,
+ * the index of the store and the number of stores. The reply is an
+ * int with the number of steps, an int with the number of claimed
+ * steps, and the packed kmer and the packed vertex of each step.
+ *
+ * The store marks the steps as used by the path (they are claimed)
+ * as it serves them. It stops at the first vertex that is already
+ * used: this boundary vertex is returned, but not claimed, so that
+ * the walker sees the competition. The last step can also be a
+ * boundary vertex that is not a unitig vertex.
+ */
+#define ACTION_ASSEMBLY_GET_PATH_EXTENSION 0x0025a1c3
+#define ACTION_ASSEMBLY_GET_PATH_EXTENSION_REPLY 0x0011f38e
+
+/*
+ * Release the claimed steps of a path extension that the walker did
+ * not accept. The request is the request of
+ * ACTION_ASSEMBLY_GET_PATH_EXTENSION followed by an int with the
+ * number of accepted steps and an int with the number of claimed
+ * steps. The reply is empty.
+ */
+#define ACTION_ASSEMBLY_RELEASE_PATH_EXTENSION 0x003a52e9
+#define ACTION_ASSEMBLY_RELEASE_PATH_EXTENSION_REPLY 0x001d7c48
+
+#define BIOSAL_ASSEMBLY_GRAPH_STORE_DIRECTION_CHILD 0
+#define BIOSAL_ASSEMBLY_GRAPH_STORE_DIRECTION_PARENT 1
+
+#define BIOSAL_ASSEMBLY_GRAPH_STORE_MAXIMUM_EXTENSION_LENGTH 256
+
 #define ACTION_MARK_VERTEX_AS_VISITED 0x002e0b8a
 #define ACTION_MARK_VERTEX_AS_VISITED_REPLY 0x002b4b17
 
@@ -58,7 +95,16 @@ struct biosal_dna_kmer;
  * http://docs.openstack.org/openstack-ops/content/storage_decision.html
  */
 struct biosal_assembly_graph_store {
-    struct core_map table;
+
+    /*
+     * The vertices of the store. With -node-graph-store, the shard
+     * belongs to the table of the node instead of the actor.
+     */
+    struct biosal_kmer_table_shard local_shard;
+    struct biosal_kmer_table_shard *shard;
+    struct biosal_kmer_table *table;
+    int node_graph_store;
+
     struct biosal_dna_codec transport_codec;
     struct biosal_dna_codec storage_codec;
     int kmer_length;
@@ -73,7 +119,7 @@ struct biosal_assembly_graph_store {
     struct core_memory_pool persistent_memory;
 
     struct core_map coverage_distribution;
-    struct core_map_iterator iterator;
+    struct biosal_kmer_table_iterator iterator;
     int source;
 
     uint64_t received_arc_count;
@@ -103,5 +149,43 @@ extern struct thorium_script biosal_assembly_graph_store_script;
 
 int biosal_assembly_graph_store_get_store_count_per_node(struct thorium_actor *self);
 
+/*
+ * Read the vertex of a kmer directly in the table of the node, without
+ * any message, if the graph store @store is on the same node and uses
+ * -node-graph-store. The vertex is oriented like the kmer, like in
+ * ACTION_ASSEMBLY_GET_VERTEX_REPLY.
+ *
+ * Until the graph is built (the store freezes its shard with
+ * ACTION_ASSEMBLY_GET_SUMMARY), this returns 0.
+ *
+ * A direct read does not wait behind the messages already sent to the
+ * store, so it must not overtake a change made by the caller. The
+ * callers only read after the reply to their change (for the unitig
+ * walkers, ACTION_MARK_VERTEX_AS_VISITED_REPLY,
+ * ACTION_ASSEMBLY_GET_PATH_EXTENSION_REPLY and
+ * ACTION_ASSEMBLY_RELEASE_PATH_EXTENSION_REPLY; for the visitors, the
+ * reply to ACTION_ASSEMBLY_GET_VERTEX_AND_SET_VISITOR_FLAG): the store
+ * ends its write before it replies, so the flags read here include
+ * the changes of the caller. The changes of other actors can be seen
+ * sooner than with a message, which is no different from another
+ * order of delivery.
+ *
+ * \return 1 if the vertex was read, 0 if ACTION_ASSEMBLY_GET_VERTEX
+ * must be sent instead (this includes a kmer that is not in the store)
+ */
+int biosal_assembly_graph_store_read_vertex(int store, struct biosal_dna_kmer *kmer,
+                int kmer_length, struct biosal_dna_codec *codec, struct core_memory_pool *memory,
+                struct biosal_assembly_vertex *vertex);
+
+/*
+ * Drop the cached ACTION_ASSEMBLY_GET_VERTEX replies for the vertex of
+ * a kmer from the node message cache (-node-message-cache-size). The
+ * reply depends on the orientation of the kmer in the request, so the
+ * requests for the kmer and for its reverse complement are both
+ * dropped.
+ */
+void biosal_assembly_graph_store_invalidate_cached_vertex(struct thorium_actor *self,
+                int store, struct biosal_dna_kmer *kmer, int kmer_length,
+                struct biosal_dna_codec *codec, struct core_memory_pool *memory);
 
 #endif
@@ -0,0 +1,189 @@
+
+#include "assembly_path_extension.h"
+
+#include "assembly_graph_store.h"
+#include "assembly_vertex.h"
+
+#include <genomics/data/dna_kmer.h>
+#include <genomics/data/dna_codec.h>
+#include <genomics/storage/kmer_table.h>
+
+#include <core/system/memory_pool.h>
+#include <core/system/debugger.h>
+
+static struct biosal_assembly_vertex *biosal_assembly_path_extension_find_vertex(struct biosal_assembly_path_extension *self,
+                struct biosal_dna_kmer *kmer);
+
+void biosal_assembly_path_extension_init(struct biosal_assembly_path_extension *self,
+                struct biosal_kmer_table *table, int kmer_length, int key_length,
+                struct biosal_dna_codec *codec, struct biosal_dna_codec *storage_codec,
+                struct core_memory_pool *memory)
+{
+    self->table = table;
+    self->kmer_length = kmer_length;
+    self->key_length = key_length;
+    self->codec = codec;
+    self->storage_codec = storage_codec;
+    self->memory = memory;
+
+    core_vector_init(&self->kmers, sizeof(struct biosal_dna_kmer));
+    core_vector_set_memory_pool(&self->kmers, memory);
+    core_vector_init(&self->vertices, sizeof(struct biosal_assembly_vertex));
+    core_vector_set_memory_pool(&self->vertices, memory);
+    core_vector_init(&self->canonical_vertices, sizeof(struct biosal_assembly_vertex *));
+    core_vector_set_memory_pool(&self->canonical_vertices, memory);
+}
+
+void biosal_assembly_path_extension_destroy(struct biosal_assembly_path_extension *self)
+{
+    int i;
+    int size;
+
+    size = core_vector_size(&self->kmers);
+
+    for (i = 0; i < size; ++i) {
+        biosal_dna_kmer_destroy(core_vector_at(&self->kmers, i), self->memory);
+        biosal_assembly_vertex_destroy(core_vector_at(&self->vertices, i));
+    }
+
+    core_vector_destroy(&self->kmers);
+    core_vector_destroy(&self->vertices);
+    core_vector_destroy(&self->canonical_vertices);
+
+    self->table = NULL;
+    self->codec = NULL;
+    self->storage_codec = NULL;
+    self->memory = NULL;
+}
+
+int biosal_assembly_path_extension_walk(struct biosal_assembly_path_extension *self,
+                struct biosal_dna_kmer *kmer, int direction, int store_index, int store_count,
+                int maximum_length)
+{
+    struct biosal_dna_kmer current_kmer;
+    struct biosal_dna_kmer next_kmer;
+    struct biosal_assembly_vertex *canonical_vertex;
+    struct biosal_assembly_vertex vertex;
+    int arc_count;
+    int code;
+
+    CORE_DEBUGGER_ASSERT(core_vector_size(&self->kmers) == 0);
+    CORE_DEBUGGER_ASSERT(maximum_length >= 1);
+
+    biosal_dna_kmer_init_copy(&current_kmer, kmer, self->kmer_length, self->memory,
+                    self->codec);
+
+    while (1) {
+
+        canonical_vertex = biosal_assembly_path_extension_find_vertex(self, &current_kmer);
+
+        biosal_assembly_vertex_init_copy(&vertex, canonical_vertex);
+
+        if (!biosal_dna_kmer_is_canonical(&current_kmer, self->kmer_length, self->codec)) {
+            biosal_assembly_vertex_invert_arcs(&vertex);
+        }
+
+        core_vector_push_back(&self->kmers, &current_kmer);
+        core_vector_push_back(&self->vertices, &vertex);
+        core_vector_push_back(&self->canonical_vertices, &canonical_vertex);
+
+        /*
+         * The walker only picks unitig vertices.
+         */
+        if (!biosal_assembly_vertex_get_flag(&vertex, BIOSAL_VERTEX_FLAG_UNITIG)) {
+            break;
+        }
+
+        if (core_vector_size(&self->kmers) == maximum_length) {
+            break;
+        }
+
+        if (direction == BIOSAL_ASSEMBLY_GRAPH_STORE_DIRECTION_CHILD) {
+            arc_count = biosal_assembly_vertex_child_count(&vertex);
+        } else {
+            arc_count = biosal_assembly_vertex_parent_count(&vertex);
+        }
+
+        if (arc_count != 1) {
+            break;
+        }
+
+        if (direction == BIOSAL_ASSEMBLY_GRAPH_STORE_DIRECTION_CHILD) {
+            code = biosal_assembly_vertex_get_child(&vertex, 0);
+            biosal_dna_kmer_init_as_child(&next_kmer, &current_kmer, code, self->kmer_length,
+                            self->memory, self->codec);
+        } else {
+            code = biosal_assembly_vertex_get_parent(&vertex, 0);
+            biosal_dna_kmer_init_as_parent(&next_kmer, &current_kmer, code, self->kmer_length,
+                            self->memory, self->codec);
+        }
+
+        /*
+         * Stop at the partition boundary.
+         */
+        if (biosal_dna_kmer_store_index(&next_kmer, store_count, self->kmer_length,
+                                self->codec, self->memory) != store_index) {
+
+            biosal_dna_kmer_destroy(&next_kmer, self->memory);
+            break;
+        }
+
+        current_kmer = next_kmer;
+    }
+
+    return core_vector_size(&self->kmers);
+}
+
+int biosal_assembly_path_extension_size(struct biosal_assembly_path_extension *self)
+{
+    return core_vector_size(&self->kmers);
+}
+
+struct biosal_dna_kmer *biosal_assembly_path_extension_kmer(struct biosal_assembly_path_extension *self,
+                int step)
+{
+    return core_vector_at(&self->kmers, step);
+}
+
+struct biosal_assembly_vertex *biosal_assembly_path_extension_vertex(struct biosal_assembly_path_extension *self,
+                int step)
+{
+    return core_vector_at(&self->vertices, step);
+}
+
+struct biosal_assembly_vertex *biosal_assembly_path_extension_canonical_vertex(struct biosal_assembly_path_extension *self,
+                int step)
+{
+    struct biosal_assembly_vertex **bucket;
+
+    bucket = core_vector_at(&self->canonical_vertices, step);
+
+    return *bucket;
+}
+
+static struct biosal_assembly_vertex *biosal_assembly_path_extension_find_vertex(struct biosal_assembly_path_extension *self,
+                struct biosal_dna_kmer *kmer)
+{
+    struct biosal_dna_kmer storage_kmer;
+    struct biosal_assembly_vertex *canonical_vertex;
+    char *sequence;
+    void *key;
+
+    sequence = core_memory_pool_allocate(self->memory, self->kmer_length + 1);
+    biosal_dna_kmer_get_sequence(kmer, sequence, self->kmer_length, self->codec);
+    biosal_dna_kmer_init(&storage_kmer, sequence, self->storage_codec, self->memory);
+
+    key = core_memory_pool_allocate(self->memory, self->key_length);
+    biosal_dna_kmer_pack_store_key(&storage_kmer, key, self->kmer_length, self->storage_codec,
+                    self->memory);
+
+    canonical_vertex = biosal_kmer_table_get(self->table, key);
+
+    CORE_DEBUGGER_ASSERT(canonical_vertex != NULL);
+
+    core_memory_pool_free(self->memory, sequence);
+    core_memory_pool_free(self->memory, key);
+    biosal_dna_kmer_destroy(&storage_kmer, self->memory);
+
+    return canonical_vertex;
+}
@@ -0,0 +1,74 @@
+#ifndef BIOSAL_ASSEMBLY_PATH_EXTENSION_H
+#define BIOSAL_ASSEMBLY_PATH_EXTENSION_H
+
+#include <core/structures/vector.h>
+
+struct biosal_kmer_table;
+struct biosal_dna_kmer;
+struct biosal_dna_codec;
+struct biosal_assembly_vertex;
+struct core_memory_pool;
+
+/*
+ * The local walk behind ACTION_ASSEMBLY_GET_PATH_EXTENSION.
+ *
+ * From a kmer, follow the only arc in one direction
+ * (BIOSAL_ASSEMBLY_GRAPH_STORE_DIRECTION_*) in the table of a graph
+ * store. The walk stops after a vertex that is not a unitig vertex,
+ * after a vertex with more than one arc, before a kmer of another
+ * store, or after a maximum number of steps.
+ *
+ * The walk is deterministic: walking again from the same kmer with
+ * a smaller maximum gives a prefix of the same steps. The graph store
+ * uses this to release the claimed steps that the walker rejected.
+ */
+struct biosal_assembly_path_extension {
+    struct core_vector kmers;
+    struct core_vector vertices;
+    struct core_vector canonical_vertices;
+
+    struct biosal_kmer_table *table;
+    struct biosal_dna_codec *codec;
+    struct biosal_dna_codec *storage_codec;
+    struct core_memory_pool *memory;
+    int kmer_length;
+    int key_length;
+};
+
+/*
+ * \param codec the codec of the kmers of the walk
+ * \param storage_codec the codec of the keys of the table
+ */
+void biosal_assembly_path_extension_init(struct biosal_assembly_path_extension *self,
+                struct biosal_kmer_table *table, int kmer_length, int key_length,
+                struct biosal_dna_codec *codec, struct biosal_dna_codec *storage_codec,
+                struct core_memory_pool *memory);
+void biosal_assembly_path_extension_destroy(struct biosal_assembly_path_extension *self);
+
+/*
+ * Walk from @kmer (the first step).
+ *
+ * \return the number of steps
+ */
+int biosal_assembly_path_extension_walk(struct biosal_assembly_path_extension *self,
+                struct biosal_dna_kmer *kmer, int direction, int store_index, int store_count,
+                int maximum_length);
+
+int biosal_assembly_path_extension_size(struct biosal_assembly_path_extension *self);
+struct biosal_dna_kmer *biosal_assembly_path_extension_kmer(struct biosal_assembly_path_extension *self,
+                int step);
+
+/*
+ * \return a copy of the vertex of a step, oriented like its kmer
+ * (like in ACTION_ASSEMBLY_GET_VERTEX_REPLY)
+ */
+struct biosal_assembly_vertex *biosal_assembly_path_extension_vertex(struct biosal_assembly_path_extension *self,
+                int step);
+
+/*
+ * \return the vertex of a step in the table
+ */
+struct biosal_assembly_vertex *biosal_assembly_path_extension_canonical_vertex(struct biosal_assembly_path_extension *self,
+                int step);
+
+#endif
@@ -7,10 +7,13 @@
 #include <genomics/kernels/dna_kmer_counter_kernel.h>
 
 #include <genomics/data/dna_kmer.h>
-#include <genomics/data/dna_kmer_block.h>
+#include <genomics/data/dna_minimizer.h>
+#include <genomics/data/dna_super_kmer_block.h>
 #include <genomics/data/dna_sequence.h>
 #include <genomics/input/input_command.h>
 
+#include <genomics/helpers/command.h>
+
 #include <engine/thorium/modules/message_helper.h>
 
 #include <core/system/packer.h>
@@ -63,6 +66,10 @@ void biosal_assembly_sliding_window_push_sequence_data_block(struct thorium_acto
 
 void biosal_assembly_sliding_window_set_producers_for_work_stealing(struct thorium_actor *self, struct thorium_message *message);
 
+static void biosal_assembly_sliding_window_add_super_kmer(struct thorium_actor *self,
+                struct biosal_dna_super_kmer_block *block, uint64_t minimizer,
+                int first, int kmers, struct biosal_dna_sequence *sequence);
+
 struct thorium_script biosal_assembly_sliding_window_script = {
     .identifier = SCRIPT_ASSEMBLY_SLIDING_WINDOW,
     .init = biosal_assembly_sliding_window_init,
@@ -107,6 +114,9 @@ void biosal_assembly_sliding_window_init(struct thorium_actor *actor)
 
     concrete_actor->auto_scaling_in_progress = 0;
 
+    concrete_actor->fused_graph_construction = biosal_command_use_fused_graph_construction(
+                    thorium_actor_argc(self), thorium_actor_argv(self));
+
     thorium_actor_add_action(actor, ACTION_PACK,
                     biosal_assembly_sliding_window_pack_message);
     thorium_actor_add_action(actor, ACTION_UNPACK,
@@ -632,7 +642,6 @@ void biosal_assembly_sliding_window_notify_reply(struct thorium_actor *actor, st
 void biosal_assembly_sliding_window_push_sequence_data_block(struct thorium_actor *actor, struct thorium_message *message)
 {
     int source;
-    struct biosal_dna_kmer kmer;
     int name;
     struct biosal_input_command payload;
     void *buffer;
@@ -642,21 +651,21 @@ void biosal_assembly_sliding_window_push_sequence_data_block(struct thorium_acto
     int consumer;
     int i;
     struct biosal_dna_sequence *sequence;
-    char *sequence_data;
     struct core_vector *command_entries;
     int sequence_length;
     int new_count;
     void *new_buffer;
     struct thorium_message new_message;
-    int j;
-    int limit;
-    char saved;
     struct core_timer timer;
-    struct biosal_dna_kmer_block block;
+    struct biosal_dna_super_kmer_block block;
+    struct biosal_dna_minimizer minimizer;
     int to_reserve;
-    int maximum_length;
     struct core_memory_pool *ephemeral_memory;
     int kmers_for_sequence;
+    uint64_t run_minimizer;
+    uint64_t value;
+    int run_first;
+    int run_kmers;
     struct thorium_actor *self = actor;
 
     concrete_actor = (struct biosal_assembly_sliding_window *)thorium_actor_concrete_actor(actor);
@@ -698,8 +707,14 @@ void biosal_assembly_sliding_window_push_sequence_data_block(struct thorium_acto
         thorium_actor_log(self, "Error: received empty payload...\n");
     }
 
+    biosal_dna_minimizer_init(&minimizer, concrete_actor->kmer_length,
+                    &concrete_actor->codec, ephemeral_memory);
+
+    /*
+     * Super kmers overlap by k - 1 nucleotides and have a small header,
+     * so the block is usually less than twice the size of the sequences.
+     */
     to_reserve = 0;
-    maximum_length = 0;
 
     for (i = 0; i < entries; i++) {
 
@@ -707,67 +722,73 @@ void biosal_assembly_sliding_window_push_sequence_data_block(struct thorium_acto
 
         sequence_length = biosal_dna_sequence_length(sequence);
 
-        if (sequence_length > maximum_length) {
-            maximum_length = sequence_length;
-        }
-
-        to_reserve += (sequence_length - concrete_actor->kmer_length + 1);
+        to_reserve += biosal_dna_codec_encoded_length(&concrete_actor->codec, sequence_length);
     }
 
-    biosal_dna_kmer_block_init(&block, concrete_actor->kmer_length, source_index, to_reserve,
-                    ephemeral_memory);
+    to_reserve *= 2;
 
-    sequence_data = core_memory_pool_allocate(ephemeral_memory, maximum_length + 1);
+    biosal_dna_super_kmer_block_init(&block, concrete_actor->kmer_length, source_index,
+                    to_reserve, ephemeral_memory);
+
+    if (concrete_actor->fused_graph_construction) {
+        biosal_dna_super_kmer_block_enable_flanks(&block);
+    }
 
-    /* extract kmers
+    /* extract super kmers
+     *
+     * Consecutive kmers with the same minimizer go to the same
+     * graph store, so each run is shipped once as a super kmer.
+     * The classifier extracts the canonical kmers from it.
      */
     for (i = 0; i < entries; i++) {
 
         sequence = (struct biosal_dna_sequence *)core_vector_at(command_entries, i);
 
-        biosal_dna_sequence_get_sequence(sequence, sequence_data,
-                        &concrete_actor->codec);
-
-        sequence_length = biosal_dna_sequence_length(sequence);
-        limit = sequence_length - concrete_actor->kmer_length + 1;
+        biosal_dna_minimizer_set_sequence(&minimizer, sequence);
 
         kmers_for_sequence = 0;
+        run_kmers = 0;
+        run_first = 0;
+        run_minimizer = 0;
 
-        for (j = 0; j < limit; j++) {
-            saved = sequence_data[j + concrete_actor->kmer_length];
-            sequence_data[j + concrete_actor->kmer_length] = '\0';
-
-            biosal_dna_kmer_init(&kmer, sequence_data + j,
-                            &concrete_actor->codec, thorium_actor_get_ephemeral_memory(actor));
-
-#ifdef BIOSAL_WINDOW_DEBUG_LEVEL_2
-            thorium_actor_log(self, "KERNEL kmer %d,%d %s\n", i, j, sequence_data + j);
-#endif
+        while (biosal_dna_minimizer_next(&minimizer)) {
 
-            /*
-             * add kmer in block
-             */
-            biosal_dna_kmer_block_add_kmer(&block, &kmer, thorium_actor_get_ephemeral_memory(actor),
-                            &concrete_actor->codec);
+            value = biosal_dna_minimizer_get(&minimizer);
 
-            biosal_dna_kmer_destroy(&kmer, thorium_actor_get_ephemeral_memory(actor));
+            if (run_kmers > 0 && value != run_minimizer) {
+                biosal_assembly_sliding_window_add_super_kmer(self, &block, run_minimizer,
+                                run_first, run_kmers, sequence);
+                run_kmers = 0;
+            }
 
-            sequence_data[j + concrete_actor->kmer_length] = saved;
+            if (run_kmers == 0) {
+                run_minimizer = value;
+                run_first = biosal_dna_minimizer_position(&minimizer);
+            }
 
+            ++run_kmers;
             ++kmers_for_sequence;
         }
 
+        if (run_kmers > 0) {
+            biosal_assembly_sliding_window_add_super_kmer(self, &block, run_minimizer,
+                            run_first, run_kmers, sequence);
+        }
+
 #ifdef BIOSAL_PRIVATE_DEBUG_EMIT
         thorium_actor_log(self, "DEBUG EMIT KMERS INPUT: %d nucleotides, k: %d output %d kmers\n",
-                        sequence_length, concrete_actor->kmer_length,
+                        biosal_dna_sequence_length(sequence), concrete_actor->kmer_length,
                         kmers_for_sequence);
 #endif
 
         concrete_actor->kmers += kmers_for_sequence;
     }
 
-    core_memory_pool_free(ephemeral_memory, sequence_data);
-    sequence_data = NULL;
+    biosal_dna_minimizer_destroy(&minimizer);
+
+    new_count = biosal_dna_super_kmer_block_pack_size(&block);
+    new_buffer = thorium_actor_allocate(actor, new_count);
+    biosal_dna_super_kmer_block_pack(&block, new_buffer);
 
 #ifdef BIOSAL_WINDOW_DEBUG
     BIOSAL_DEBUG_MARKER("after generating kmers\n");
@@ -778,12 +799,6 @@ void biosal_assembly_sliding_window_push_sequence_data_block(struct thorium_acto
 
     biosal_input_command_destroy(&payload, thorium_actor_get_ephemeral_memory(actor));
 
-    new_count = biosal_dna_kmer_block_pack_size(&block,
-                    &concrete_actor->codec);
-    new_buffer = thorium_actor_allocate(actor, new_count);
-    biosal_dna_kmer_block_pack(&block, new_buffer,
-                        &concrete_actor->codec);
-
 #ifdef BIOSAL_WINDOW_DEBUG
     thorium_actor_log(self, "name %d destination %d PACK with %d bytes\n", name,
                        consumer, new_count);
@@ -826,7 +841,7 @@ void biosal_assembly_sliding_window_push_sequence_data_block(struct thorium_acto
 
     core_timer_destroy(&timer);
 
-    biosal_dna_kmer_block_destroy(&block, thorium_actor_get_ephemeral_memory(actor));
+    biosal_dna_super_kmer_block_destroy(&block);
 
 #ifdef BIOSAL_WINDOW_DEBUG
     BIOSAL_DEBUG_MARKER("leaving call.\n");
@@ -835,6 +850,42 @@ void biosal_assembly_sliding_window_push_sequence_data_block(struct thorium_acto
     biosal_assembly_sliding_window_verify(actor, message);
 }
 
+/*
+ * With flanks, the nucleotides before and after the run are added too,
+ * so that the classifier knows the parent of the first kmer and the child
+ * of the last kmer.
+ */
+static void biosal_assembly_sliding_window_add_super_kmer(struct thorium_actor *self,
+                struct biosal_dna_super_kmer_block *block, uint64_t minimizer,
+                int first, int kmers, struct biosal_dna_sequence *sequence)
+{
+    struct biosal_assembly_sliding_window *concrete_self;
+    int length;
+    int flanks;
+
+    concrete_self = thorium_actor_concrete_actor(self);
+
+    length = kmers + concrete_self->kmer_length - 1;
+    flanks = 0;
+
+    if (concrete_self->fused_graph_construction) {
+
+        if (first > 0) {
+            flanks |= BIOSAL_DNA_SUPER_KMER_FLANK_PARENT;
+            --first;
+            ++length;
+        }
+
+        if (first + length < biosal_dna_sequence_length(sequence)) {
+            flanks |= BIOSAL_DNA_SUPER_KMER_FLANK_CHILD;
+            ++length;
+        }
+    }
+
+    biosal_dna_super_kmer_block_add(block, minimizer, length, sequence->encoded_data,
+                    first, flanks, &concrete_self->codec);
+}
+
 void biosal_assembly_sliding_window_set_producers_for_work_stealing(struct thorium_actor *self, struct thorium_message *message)
 {
     struct biosal_assembly_sliding_window *concrete_self;
@@ -53,6 +53,12 @@ struct biosal_assembly_sliding_window {
     struct core_vector children;
 
     int flushed_payloads;
+
+    /*
+     * Ship super kmers with their flanking nucleotides
+     * (with -fused-graph-construction).
+     */
+    int fused_graph_construction;
 };
 
 extern struct thorium_script biosal_assembly_sliding_window_script;
@@ -200,3 +200,8 @@ void biosal_assembly_vertex_init_empty(struct biosal_assembly_vertex *self)
 }
 
 
+
+void biosal_assembly_vertex_add_arcs(struct biosal_assembly_vertex *self, int bitmap)
+{
+    biosal_assembly_connectivity_add_arcs(&self->connectivity, bitmap);
+}
@@ -68,6 +68,7 @@ int biosal_assembly_vertex_unpack(struct biosal_assembly_vertex *self, void *buf
 int biosal_assembly_vertex_pack_unpack(struct biosal_assembly_vertex *self, int operation, void *buffer);
 
 void biosal_assembly_vertex_invert_arcs(struct biosal_assembly_vertex *self);
+void biosal_assembly_vertex_add_arcs(struct biosal_assembly_vertex *self, int bitmap);
 
 void biosal_assembly_vertex_set_flag(struct biosal_assembly_vertex *self, int flag);
 void biosal_assembly_vertex_clear_flag(struct biosal_assembly_vertex *self, int flag);
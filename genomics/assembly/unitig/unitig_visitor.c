@@ -376,7 +376,10 @@ void biosal_unitig_visitor_execute(struct thorium_actor *self)
         /*
          * Start first one.
          */
-        biosal_vertex_neighborhood_receive(&concrete_self->main_neighborhood, NULL);
+        if (biosal_vertex_neighborhood_receive(&concrete_self->main_neighborhood, NULL)) {
+            concrete_self->step = STEP_DECIDE_MAIN;
+            biosal_unitig_visitor_execute(self);
+        }
 
 #if 0
         thorium_actor_log(self, "visitor STEP_GET_MAIN_VERTEX_DATA\n");
@@ -546,7 +549,10 @@ void biosal_unitig_visitor_execute(struct thorium_actor *self)
         /*
          * Start first one.
          */
-        biosal_vertex_neighborhood_receive(&concrete_self->parent_neighborhood, NULL);
+        if (biosal_vertex_neighborhood_receive(&concrete_self->parent_neighborhood, NULL)) {
+            concrete_self->step = STEP_DECIDE_PARENT;
+            biosal_unitig_visitor_execute(self);
+        }
 
     } else if (concrete_self->step == STEP_DECIDE_PARENT) {
 
@@ -618,7 +624,10 @@ void biosal_unitig_visitor_execute(struct thorium_actor *self)
         /*
          * Start first one.
          */
-        biosal_vertex_neighborhood_receive(&concrete_self->child_neighborhood, NULL);
+        if (biosal_vertex_neighborhood_receive(&concrete_self->child_neighborhood, NULL)) {
+            concrete_self->step = STEP_DECIDE_CHILD;
+            biosal_unitig_visitor_execute(self);
+        }
 
     } else if (concrete_self->step == STEP_DECIDE_CHILD) {
 
@@ -722,6 +731,9 @@ void biosal_unitig_visitor_mark_vertex(struct thorium_actor *self, struct biosal
     thorium_message_init(&new_message, ACTION_SET_VERTEX_FLAG, new_count, new_buffer);
     thorium_actor_send(self, store, &new_message);
     thorium_message_destroy(&new_message);
+
+    biosal_assembly_graph_store_invalidate_cached_vertex(self, store, kmer,
+                    concrete_self->kmer_length, &concrete_self->codec, ephemeral_memory);
 }
 
 void biosal_unitig_visitor_set_locality_kmer(struct thorium_actor *self,
@@ -59,6 +59,13 @@
 #define HIGHLIGH_STARTING_POINT
 */
 
+/*
+ * Ask graph stores to walk unambiguous paths locally with
+ * ACTION_ASSEMBLY_GET_PATH_EXTENSION instead of fetching one
+ * vertex at a time.
+ */
+#define BIOSAL_UNITIG_WALKER_USE_PATH_EXTENSION
+
 #define OPERATION_FETCH_FIRST       0
 #define OPERATION_FETCH_PARENTS     1
 #define OPERATION_FETCH_CHILDREN    2
@@ -110,7 +117,7 @@ void biosal_unitig_walker_begin(struct thorium_actor *self, struct thorium_messa
 int biosal_unitig_walker_select(struct thorium_actor *self, int *output_status);
 void biosal_unitig_walker_write(struct thorium_actor *self, uint64_t name,
                 char *sequence, int sequence_length, int circular, uint64_t signature);
-void biosal_unitig_walker_make_decision(struct thorium_actor *self);
+int biosal_unitig_walker_make_decision(struct thorium_actor *self);
 
 void biosal_unitig_walker_set_current(struct thorium_actor *self,
                 struct biosal_dna_kmer *kmer, struct biosal_assembly_vertex *vertex);
@@ -136,6 +143,14 @@ void biosal_unitig_walker_select_strand(struct thorium_actor *self, int length,
 
 void biosal_unitig_walker_abort(struct thorium_actor *self, struct thorium_message *message);
 
+void biosal_unitig_walker_check_competition(struct thorium_actor *self,
+                struct biosal_assembly_vertex *vertex);
+int biosal_unitig_walker_get_path_extension(struct thorium_actor *self);
+static void biosal_unitig_walker_add_vertex(struct thorium_actor *self,
+                struct biosal_assembly_vertex *vertex);
+void biosal_unitig_walker_get_path_extension_reply(struct thorium_actor *self, struct thorium_message *message);
+static void biosal_unitig_walker_send_next_action(struct thorium_actor *self, int action);
+
 struct thorium_script biosal_unitig_walker_script = {
     .identifier = SCRIPT_UNITIG_WALKER,
     .name = "biosal_unitig_walker",
@@ -212,6 +227,9 @@ void biosal_unitig_walker_init(struct thorium_actor *self)
                     biosal_unitig_walker_get_vertex_reply_starting_vertex,
                     &concrete_self->has_starting_vertex, 0);
 
+    thorium_actor_add_action(self, ACTION_ASSEMBLY_GET_PATH_EXTENSION_REPLY,
+                    biosal_unitig_walker_get_path_extension_reply);
+
     thorium_actor_add_action(self, ACTION_NOTIFY, biosal_unitig_walker_notify);
     thorium_actor_add_action(self, ACTION_NOTIFY_REPLY, biosal_unitig_walker_notify_reply);
 
@@ -273,6 +291,8 @@ void biosal_unitig_walker_init(struct thorium_actor *self)
                             thorium_actor_argv(self)));
 
     concrete_self->current_is_circular = 0;
+    concrete_self->consuming_extension = 0;
+    concrete_self->extension_action = ACTION_INVALID;
 }
 
 void biosal_unitig_walker_destroy(struct thorium_actor *self)
@@ -360,6 +380,13 @@ void biosal_unitig_walker_receive(struct thorium_actor *self, struct thorium_mes
          */
         thorium_actor_send_to_self_empty(self, ACTION_ASSEMBLY_GET_VERTICES_AND_SELECT);
 
+    } else if (tag == ACTION_ASSEMBLY_RELEASE_PATH_EXTENSION_REPLY) {
+
+        /*
+         * The rejected steps of the path extension are released.
+         */
+        thorium_actor_send_to_self_empty(self, concrete_self->extension_action);
+
     } else if (tag == ACTION_ASK_TO_STOP) {
 
         thorium_actor_send_to_self_empty(self, ACTION_STOP);
@@ -703,6 +730,7 @@ void biosal_unitig_walker_get_vertices_and_select(struct thorium_actor *self, st
     struct biosal_dna_kmer *child_kmer_to_fetch;
     struct biosal_dna_kmer parent_kmer;
     struct biosal_dna_kmer *parent_kmer_to_fetch;
+    struct biosal_assembly_vertex vertex;
 
     concrete_self = thorium_actor_concrete_actor(self);
     ephemeral_memory = thorium_actor_get_ephemeral_memory(self);
@@ -716,6 +744,12 @@ void biosal_unitig_walker_get_vertices_and_select(struct thorium_actor *self, st
      * - set current vertex
      */
 
+#ifdef BIOSAL_UNITIG_WALKER_USE_PATH_EXTENSION
+    if (biosal_unitig_walker_get_path_extension(self)) {
+        return;
+    }
+#endif
+
     /*
      * Generate child kmers and parent kmers.
      */
@@ -763,6 +797,26 @@ void biosal_unitig_walker_get_vertices_and_select(struct thorium_actor *self, st
         child_kmer_to_fetch = core_vector_at(&concrete_self->child_kmers,
                         concrete_self->current_child);
 
+        store_index = biosal_dna_kmer_store_index(child_kmer_to_fetch,
+                    core_vector_size(&concrete_self->graph_stores),
+                    concrete_self->kmer_length,
+                    &concrete_self->codec, ephemeral_memory);
+
+        store = core_vector_at_as_int(&concrete_self->graph_stores, store_index);
+
+        concrete_self->fetch_operation = OPERATION_FETCH_CHILDREN;
+
+        /*
+         * The marks of this walker were acknowledged before this point,
+         * so a direct read sees them.
+         */
+        if (biosal_assembly_graph_store_read_vertex(store, child_kmer_to_fetch,
+                                concrete_self->kmer_length, &concrete_self->codec,
+                                ephemeral_memory, &vertex)) {
+            biosal_unitig_walker_add_vertex(self, &vertex);
+            return;
+        }
+
         new_count = biosal_dna_kmer_pack_size(child_kmer_to_fetch, concrete_self->kmer_length,
                     &concrete_self->codec);
         /*new_count += sizeof(concrete_self->path_index);*/
@@ -777,15 +831,6 @@ void biosal_unitig_walker_get_vertices_and_select(struct thorium_actor *self, st
                         &concrete_self->path_index, sizeof(concrete_self->path_index));
                         */
 
-        store_index = biosal_dna_kmer_store_index(child_kmer_to_fetch,
-                    core_vector_size(&concrete_self->graph_stores),
-                    concrete_self->kmer_length,
-                    &concrete_self->codec, ephemeral_memory);
-
-        store = core_vector_at_as_int(&concrete_self->graph_stores, store_index);
-
-        concrete_self->fetch_operation = OPERATION_FETCH_CHILDREN;
-
         thorium_message_init(&new_message, ACTION_ASSEMBLY_GET_VERTEX, new_count, new_buffer);
         thorium_actor_send(self, store, &new_message);
         thorium_message_destroy(&new_message);
@@ -797,6 +842,22 @@ void biosal_unitig_walker_get_vertices_and_select(struct thorium_actor *self, st
         parent_kmer_to_fetch = core_vector_at(&concrete_self->parent_kmers,
                         concrete_self->current_parent);
 
+        store_index = biosal_dna_kmer_store_index(parent_kmer_to_fetch,
+                    core_vector_size(&concrete_self->graph_stores),
+                    concrete_self->kmer_length,
+                    &concrete_self->codec, ephemeral_memory);
+
+        store = core_vector_at_as_int(&concrete_self->graph_stores, store_index);
+
+        concrete_self->fetch_operation = OPERATION_FETCH_PARENTS;
+
+        if (biosal_assembly_graph_store_read_vertex(store, parent_kmer_to_fetch,
+                                concrete_self->kmer_length, &concrete_self->codec,
+                                ephemeral_memory, &vertex)) {
+            biosal_unitig_walker_add_vertex(self, &vertex);
+            return;
+        }
+
         new_count = biosal_dna_kmer_pack_size(parent_kmer_to_fetch, concrete_self->kmer_length,
                     &concrete_self->codec);
         /*
@@ -813,15 +874,6 @@ void biosal_unitig_walker_get_vertices_and_select(struct thorium_actor *self, st
                         &concrete_self->path_index, sizeof(concrete_self->path_index));
                         */
 
-        store_index = biosal_dna_kmer_store_index(parent_kmer_to_fetch,
-                    core_vector_size(&concrete_self->graph_stores),
-                    concrete_self->kmer_length,
-                    &concrete_self->codec, ephemeral_memory);
-
-        store = core_vector_at_as_int(&concrete_self->graph_stores, store_index);
-
-        concrete_self->fetch_operation = OPERATION_FETCH_PARENTS;
-
 #if 0
         thorium_actor_log(self, "DEBUG send %d/%d ACTION_ASSEMBLY_GET_VERTEX Parent ",
                         concrete_self->current_parent, parent_count);
@@ -876,21 +928,8 @@ void biosal_unitig_walker_get_vertices_and_select_reply(struct thorium_actor *se
 void biosal_unitig_walker_get_vertex_reply(struct thorium_actor *self, struct thorium_message *message)
 {
     void *buffer;
-    struct biosal_unitig_walker *concrete_self;
     struct biosal_assembly_vertex vertex;
-    int last_actor;
-    int name;
-    int abort_when_competing;
 
-    /*
-    int last_path_index;
-    int length;
-    int new_count;
-    char *new_buffer;
-    int position;
-    */
-
-    concrete_self = thorium_actor_concrete_actor(self);
     buffer = thorium_message_buffer(message);
 
     biosal_assembly_vertex_init(&vertex);
@@ -902,45 +941,47 @@ void biosal_unitig_walker_get_vertex_reply(struct thorium_actor *self, struct th
     biosal_assembly_vertex_print(&vertex);
 #endif
 
+    biosal_unitig_walker_add_vertex(self, &vertex);
+}
+
+/*
+ * Add a child vertex or a parent vertex, received from a graph store
+ * or read directly (-node-graph-store).
+ */
+static void biosal_unitig_walker_add_vertex(struct thorium_actor *self,
+                struct biosal_assembly_vertex *vertex)
+{
+    struct biosal_unitig_walker *concrete_self;
+
+    /*
+    int last_path_index;
+    int length;
+    int new_count;
+    char *new_buffer;
+    int position;
+    */
+
+    concrete_self = thorium_actor_concrete_actor(self);
+
     /*
      * OPERATION_FETCH_FIRST uses a different code path.
      */
     CORE_DEBUGGER_ASSERT(concrete_self->fetch_operation != OPERATION_FETCH_FIRST);
 
     if (concrete_self->fetch_operation == OPERATION_FETCH_CHILDREN) {
-        core_vector_push_back(&concrete_self->child_vertices, &vertex);
+        core_vector_push_back(&concrete_self->child_vertices, vertex);
         ++concrete_self->current_child;
 
     } else if (concrete_self->fetch_operation == OPERATION_FETCH_PARENTS) {
 
-        core_vector_push_back(&concrete_self->parent_vertices, &vertex);
+        core_vector_push_back(&concrete_self->parent_vertices, vertex);
         ++concrete_self->current_parent;
     }
 
     /*
      * Check for competition.
      */
-
-    last_actor = biosal_assembly_vertex_last_actor(&vertex);
-    name = thorium_actor_name(self);
-
-    abort_when_competing = 1;
-
-    if (biosal_assembly_vertex_get_flag(&vertex, BIOSAL_VERTEX_FLAG_USED_BY_WALKER)
-                    && last_actor != name) {
-
-        ++concrete_self->number_of_visited_vertices_in_common;
-
-        if (concrete_self->number_of_visited_vertices_in_common >= RESOLUTION
-                        && abort_when_competing) {
-            if (last_actor < name) {
-                thorium_actor_log(self, "aborting, in common: %d, other actor: %d\n",
-                                concrete_self->number_of_visited_vertices_in_common,
-                                last_actor);
-                biosal_unitig_walker_abort(self, NULL);
-            }
-        }
-    }
+    biosal_unitig_walker_check_competition(self, vertex);
 #if 0
         /* ask the other actor about it.
          */
@@ -1822,7 +1863,7 @@ void biosal_unitig_walker_write(struct thorium_actor *self, uint64_t name,
     core_memory_pool_free(ephemeral_memory, buffer);
 }
 
-void biosal_unitig_walker_make_decision(struct thorium_actor *self)
+int biosal_unitig_walker_make_decision(struct thorium_actor *self)
 {
     struct biosal_dna_kmer *kmer;
     struct biosal_assembly_vertex *vertex;
@@ -1918,9 +1959,12 @@ void biosal_unitig_walker_make_decision(struct thorium_actor *self)
         #endif
 
         /*
-         * Mark the vertex.
+         * Mark the vertex (the graph store claimed the steps of a path
+         * extension already).
          */
-        biosal_unitig_walker_mark_vertex(self, kmer);
+        if (!concrete_self->consuming_extension) {
+            biosal_unitig_walker_mark_vertex(self, kmer);
+        }
 
         /*
          * Whenever a choice is made, the vertex is marked as visited.
@@ -1930,6 +1974,8 @@ void biosal_unitig_walker_make_decision(struct thorium_actor *self)
 
         core_memory_pool_free(ephemeral_memory, key);
 
+        return 1;
+
     } else if (concrete_self->select_operation == OPERATION_SELECT_CHILD) {
 
         /*
@@ -1956,7 +2002,7 @@ void biosal_unitig_walker_make_decision(struct thorium_actor *self)
 
         biosal_unitig_walker_clear(self);
 
-        thorium_actor_send_to_self_empty(self, ACTION_ASSEMBLY_GET_VERTICES_AND_SELECT);
+        biosal_unitig_walker_send_next_action(self, ACTION_ASSEMBLY_GET_VERTICES_AND_SELECT);
 
     /* Finish
      */
@@ -1982,8 +2028,10 @@ void biosal_unitig_walker_make_decision(struct thorium_actor *self)
 
         concrete_self->select_operation = OPERATION_SELECT_CHILD;
 
-        thorium_actor_send_to_self_empty(self, ACTION_ASSEMBLY_GET_VERTICES_AND_SELECT_REPLY);
+        biosal_unitig_walker_send_next_action(self, ACTION_ASSEMBLY_GET_VERTICES_AND_SELECT_REPLY);
     }
+
+    return 0;
 }
 
 void biosal_unitig_walker_set_current(struct thorium_actor *self,
@@ -2329,6 +2377,9 @@ void biosal_unitig_walker_mark_vertex(struct thorium_actor *self, struct biosal_
     thorium_message_init(&new_message, ACTION_MARK_VERTEX_AS_VISITED, new_count, new_buffer);
     thorium_actor_send(self, store, &new_message);
     thorium_message_destroy(&new_message);
+
+    biosal_assembly_graph_store_invalidate_cached_vertex(self, store, kmer,
+                    concrete_self->kmer_length, &concrete_self->codec, ephemeral_memory);
 }
 
 void biosal_unitig_walker_normalize_cycle(struct thorium_actor *self, int length, char *sequence)
@@ -2476,3 +2527,337 @@ void biosal_unitig_walker_abort(struct thorium_actor *self, struct thorium_messa
     bucket->status = PATH_STATUS_DEFEAT_BY_FAILED_CHALLENGE;
 }
 
+void biosal_unitig_walker_check_competition(struct thorium_actor *self,
+                struct biosal_assembly_vertex *vertex)
+{
+    struct biosal_unitig_walker *concrete_self;
+    int last_actor;
+    int name;
+    int abort_when_competing;
+
+    concrete_self = thorium_actor_concrete_actor(self);
+    last_actor = biosal_assembly_vertex_last_actor(vertex);
+    name = thorium_actor_name(self);
+
+    abort_when_competing = 1;
+
+    if (biosal_assembly_vertex_get_flag(vertex, BIOSAL_VERTEX_FLAG_USED_BY_WALKER)
+                    && last_actor != name) {
+
+        ++concrete_self->number_of_visited_vertices_in_common;
+
+        if (concrete_self->number_of_visited_vertices_in_common >= RESOLUTION
+                        && abort_when_competing) {
+            if (last_actor < name) {
+                thorium_actor_log(self, "aborting, in common: %d, other actor: %d\n",
+                                concrete_self->number_of_visited_vertices_in_common,
+                                last_actor);
+                biosal_unitig_walker_abort(self, NULL);
+            }
+        }
+    }
+}
+
+/*
+ * When the current vertex has only one arc in the current direction,
+ * ask the graph store of the next vertex to walk as far as it can
+ * locally.
+ *
+ * \return 1 if ACTION_ASSEMBLY_GET_PATH_EXTENSION was sent
+ */
+int biosal_unitig_walker_get_path_extension(struct thorium_actor *self)
+{
+    struct biosal_unitig_walker *concrete_self;
+    struct core_memory_pool *ephemeral_memory;
+    struct biosal_dna_kmer next_kmer;
+    int direction;
+    int arc_count;
+    int code;
+    int store_index;
+    int store_count;
+    int store;
+    int new_count;
+    char *new_buffer;
+    int position;
+
+    concrete_self = thorium_actor_concrete_actor(self);
+
+    /*
+     * Only start a step that was not started yet.
+     */
+    if (core_vector_size(&concrete_self->child_kmers) > 0
+                    || core_vector_size(&concrete_self->parent_kmers) > 0) {
+        return 0;
+    }
+
+    if (concrete_self->select_operation == OPERATION_SELECT_CHILD) {
+        direction = BIOSAL_ASSEMBLY_GRAPH_STORE_DIRECTION_CHILD;
+        arc_count = biosal_assembly_vertex_child_count(&concrete_self->current_vertex);
+    } else {
+
+        /*
+         * biosal_unitig_walker_make_decision stops there anyway.
+         */
+        if (concrete_self->current_is_circular) {
+            return 0;
+        }
+
+        direction = BIOSAL_ASSEMBLY_GRAPH_STORE_DIRECTION_PARENT;
+        arc_count = biosal_assembly_vertex_parent_count(&concrete_self->current_vertex);
+    }
+
+    if (arc_count != 1) {
+        return 0;
+    }
+
+    ephemeral_memory = thorium_actor_get_ephemeral_memory(self);
+
+    if (direction == BIOSAL_ASSEMBLY_GRAPH_STORE_DIRECTION_CHILD) {
+        code = biosal_assembly_vertex_get_child(&concrete_self->current_vertex, 0);
+        biosal_dna_kmer_init_as_child(&next_kmer, &concrete_self->current_kmer,
+                        code, concrete_self->kmer_length, ephemeral_memory,
+                        &concrete_self->codec);
+    } else {
+        code = biosal_assembly_vertex_get_parent(&concrete_self->current_vertex, 0);
+        biosal_dna_kmer_init_as_parent(&next_kmer, &concrete_self->current_kmer,
+                        code, concrete_self->kmer_length, ephemeral_memory,
+                        &concrete_self->codec);
+    }
+
+    store_count = core_vector_size(&concrete_self->graph_stores);
+    store_index = biosal_dna_kmer_store_index(&next_kmer, store_count,
+                    concrete_self->kmer_length, &concrete_self->codec, ephemeral_memory);
+    store = core_vector_at_as_int(&concrete_self->graph_stores, store_index);
+
+    new_count = biosal_dna_kmer_pack_size(&next_kmer, concrete_self->kmer_length,
+                    &concrete_self->codec);
+    new_count += sizeof(direction);
+    new_count += sizeof(concrete_self->path_index);
+    new_count += sizeof(store_index);
+    new_count += sizeof(store_count);
+
+    new_buffer = thorium_actor_allocate(self, new_count);
+
+    position = 0;
+    position += biosal_dna_kmer_pack(&next_kmer, new_buffer, concrete_self->kmer_length,
+                    &concrete_self->codec);
+    core_memory_copy(new_buffer + position, &direction, sizeof(direction));
+    position += sizeof(direction);
+    core_memory_copy(new_buffer + position, &concrete_self->path_index,
+                    sizeof(concrete_self->path_index));
+    position += sizeof(concrete_self->path_index);
+    core_memory_copy(new_buffer + position, &store_index, sizeof(store_index));
+    position += sizeof(store_index);
+    core_memory_copy(new_buffer + position, &store_count, sizeof(store_count));
+    position += sizeof(store_count);
+
+    CORE_DEBUGGER_ASSERT_IS_EQUAL_INT(position, new_count);
+
+    biosal_dna_kmer_destroy(&next_kmer, ephemeral_memory);
+
+    thorium_actor_send_buffer(self, store, ACTION_ASSEMBLY_GET_PATH_EXTENSION,
+                    new_count, new_buffer);
+
+    return 1;
+}
+
+/*
+ * Each step of the extension is handled like a step with only one
+ * vertex to select. The claimed steps that were not accepted before
+ * the path stopped are then released with
+ * ACTION_ASSEMBLY_RELEASE_PATH_EXTENSION. A boundary step that was not
+ * claimed is handled like a vertex of ACTION_ASSEMBLY_GET_VERTEX_REPLY.
+ */
+void biosal_unitig_walker_get_path_extension_reply(struct thorium_actor *self, struct thorium_message *message)
+{
+    struct biosal_unitig_walker *concrete_self;
+    struct core_memory_pool *ephemeral_memory;
+    struct biosal_dna_kmer kmer;
+    struct biosal_dna_kmer first_kmer;
+    struct biosal_assembly_vertex vertex;
+    struct core_vector *selected_kmers;
+    struct core_vector *selected_vertices;
+    char *buffer;
+    char *new_buffer;
+    int new_count;
+    int position;
+    int steps;
+    int claimed_steps;
+    int i;
+    int active;
+    int accepted_steps;
+    int direction;
+    int path_index;
+    int store_index;
+    int store_count;
+
+    concrete_self = thorium_actor_concrete_actor(self);
+    ephemeral_memory = thorium_actor_get_ephemeral_memory(self);
+    buffer = thorium_message_buffer(message);
+
+    position = 0;
+    core_memory_copy(&steps, buffer + position, sizeof(steps));
+    position += sizeof(steps);
+    core_memory_copy(&claimed_steps, buffer + position, sizeof(claimed_steps));
+    position += sizeof(claimed_steps);
+
+    CORE_DEBUGGER_ASSERT(steps >= 1);
+    CORE_DEBUGGER_ASSERT(claimed_steps == steps || claimed_steps == steps - 1);
+
+    /*
+     * The decisions below can change these.
+     */
+    if (concrete_self->select_operation == OPERATION_SELECT_CHILD) {
+        direction = BIOSAL_ASSEMBLY_GRAPH_STORE_DIRECTION_CHILD;
+    } else {
+        direction = BIOSAL_ASSEMBLY_GRAPH_STORE_DIRECTION_PARENT;
+    }
+
+    path_index = concrete_self->path_index;
+
+    active = 1;
+    accepted_steps = 0;
+    concrete_self->consuming_extension = 1;
+    concrete_self->extension_action = ACTION_ASSEMBLY_GET_VERTICES_AND_SELECT;
+
+    for (i = 0; i < steps; ++i) {
+
+        biosal_dna_kmer_init_empty(&kmer);
+        position += biosal_dna_kmer_unpack(&kmer, buffer + position, concrete_self->kmer_length,
+                        &concrete_self->memory_pool, &concrete_self->codec);
+
+        biosal_assembly_vertex_init(&vertex);
+        position += biosal_assembly_vertex_unpack(&vertex, buffer + position);
+
+        if (i == 0) {
+            biosal_dna_kmer_init_copy(&first_kmer, &kmer, concrete_self->kmer_length,
+                            ephemeral_memory, &concrete_self->codec);
+        }
+
+        /*
+         * The graph store changed the claimed steps, and the rejected ones
+         * are released below in this call, so their cached
+         * ACTION_ASSEMBLY_GET_VERTEX replies are stale.
+         */
+        if (i < claimed_steps) {
+            biosal_assembly_graph_store_invalidate_cached_vertex(self,
+                            thorium_message_source(message), &kmer,
+                            concrete_self->kmer_length, &concrete_self->codec,
+                            ephemeral_memory);
+        }
+
+        /*
+         * The path stopped before the end of the extension
+         * (cycle, defeat).
+         */
+        if (!active) {
+            biosal_dna_kmer_destroy(&kmer, &concrete_self->memory_pool);
+            biosal_assembly_vertex_destroy(&vertex);
+            continue;
+        }
+
+        /*
+         * All the claimed steps were accepted. The decision for the
+         * boundary step marks it or sends the next action.
+         */
+        if (i == claimed_steps) {
+            concrete_self->consuming_extension = 0;
+        }
+
+        if (concrete_self->select_operation == OPERATION_SELECT_CHILD) {
+            selected_kmers = &concrete_self->child_kmers;
+            selected_vertices = &concrete_self->child_vertices;
+            concrete_self->current_child = 1;
+        } else {
+            selected_kmers = &concrete_self->parent_kmers;
+            selected_vertices = &concrete_self->parent_vertices;
+            concrete_self->current_parent = 1;
+        }
+
+        core_vector_push_back(selected_kmers, &kmer);
+        core_vector_push_back(selected_vertices, &vertex);
+
+        biosal_unitig_walker_check_competition(self, &vertex);
+
+        active = biosal_unitig_walker_make_decision(self);
+
+        if (active && i < claimed_steps) {
+            ++accepted_steps;
+        }
+    }
+
+    CORE_DEBUGGER_ASSERT_IS_EQUAL_INT(position, thorium_message_count(message));
+
+    if (!concrete_self->consuming_extension) {
+        biosal_dna_kmer_destroy(&first_kmer, ephemeral_memory);
+        return;
+    }
+
+    concrete_self->consuming_extension = 0;
+
+    /*
+     * Nothing to release. Continue from the last step if the path
+     * is still active, or with the action of the last decision.
+     */
+    if (accepted_steps == claimed_steps) {
+        biosal_dna_kmer_destroy(&first_kmer, ephemeral_memory);
+        thorium_actor_send_to_self_empty(self, concrete_self->extension_action);
+        return;
+    }
+
+    store_count = core_vector_size(&concrete_self->graph_stores);
+    store_index = biosal_dna_kmer_store_index(&first_kmer, store_count,
+                    concrete_self->kmer_length, &concrete_self->codec, ephemeral_memory);
+
+    new_count = biosal_dna_kmer_pack_size(&first_kmer, concrete_self->kmer_length,
+                    &concrete_self->codec);
+    new_count += sizeof(direction);
+    new_count += sizeof(path_index);
+    new_count += sizeof(store_index);
+    new_count += sizeof(store_count);
+    new_count += sizeof(accepted_steps);
+    new_count += sizeof(claimed_steps);
+
+    new_buffer = thorium_actor_allocate(self, new_count);
+
+    position = 0;
+    position += biosal_dna_kmer_pack(&first_kmer, new_buffer, concrete_self->kmer_length,
+                    &concrete_self->codec);
+    core_memory_copy(new_buffer + position, &direction, sizeof(direction));
+    position += sizeof(direction);
+    core_memory_copy(new_buffer + position, &path_index, sizeof(path_index));
+    position += sizeof(path_index);
+    core_memory_copy(new_buffer + position, &store_index, sizeof(store_index));
+    position += sizeof(store_index);
+    core_memory_copy(new_buffer + position, &store_count, sizeof(store_count));
+    position += sizeof(store_count);
+    core_memory_copy(new_buffer + position, &accepted_steps, sizeof(accepted_steps));
+    position += sizeof(accepted_steps);
+    core_memory_copy(new_buffer + position, &claimed_steps, sizeof(claimed_steps));
+    position += sizeof(claimed_steps);
+
+    CORE_DEBUGGER_ASSERT_IS_EQUAL_INT(position, new_count);
+
+    biosal_dna_kmer_destroy(&first_kmer, ephemeral_memory);
+
+    thorium_actor_send_buffer(self, thorium_message_source(message),
+                    ACTION_ASSEMBLY_RELEASE_PATH_EXTENSION, new_count, new_buffer);
+}
+
+/*
+ * While the claimed steps of a path extension are consumed, the
+ * action is only sent once the rejected steps are released.
+ */
+static void biosal_unitig_walker_send_next_action(struct thorium_actor *self, int action)
+{
+    struct biosal_unitig_walker *concrete_self;
+
+    concrete_self = thorium_actor_concrete_actor(self);
+
+    if (concrete_self->consuming_extension) {
+        concrete_self->extension_action = action;
+        return;
+    }
+
+    thorium_actor_send_to_self_empty(self, action);
+}
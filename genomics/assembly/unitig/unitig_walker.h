@@ -83,6 +83,16 @@ struct biosal_unitig_walker {
     int start_messages;
 
     int number_of_visited_vertices_in_common;
+
+    /*
+     * Set while the steps of ACTION_ASSEMBLY_GET_PATH_EXTENSION_REPLY
+     * claimed by the graph store are consumed. The rejected steps are
+     * released with ACTION_ASSEMBLY_RELEASE_PATH_EXTENSION, and the
+     * next action is only sent (extension_action) once the graph store
+     * replied.
+     */
+    int consuming_extension;
+    int extension_action;
 };
 
 extern struct thorium_script biosal_unitig_walker_script;
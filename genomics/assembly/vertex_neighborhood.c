@@ -14,6 +14,9 @@
 #define STEP_GET_CHILDREN 2
 #define STEP_FINISH 3
 
+static int biosal_vertex_neighborhood_add_vertex(struct biosal_vertex_neighborhood *self,
+                struct biosal_assembly_vertex *vertex);
+
 void biosal_vertex_neighborhood_init(struct biosal_vertex_neighborhood *self,
                struct biosal_dna_kmer *kmer,
                 int arcs, struct core_vector *graph_stores, int kmer_length,
@@ -93,31 +96,39 @@ int biosal_vertex_neighborhood_receive(struct biosal_vertex_neighborhood *self,
         biosal_assembly_vertex_init_empty(&vertex);
         biosal_assembly_vertex_unpack(&vertex, buffer);
 
-        if (self->step == STEP_GET_MAIN_VERTEX) {
+        return biosal_vertex_neighborhood_add_vertex(self, &vertex);
+    }
 
-            biosal_assembly_vertex_init_copy(&self->main_vertex, &vertex);
+    return 0;
+}
+
+static int biosal_vertex_neighborhood_add_vertex(struct biosal_vertex_neighborhood *self,
+                struct biosal_assembly_vertex *vertex)
+{
+    if (self->step == STEP_GET_MAIN_VERTEX) {
+
+        biosal_assembly_vertex_init_copy(&self->main_vertex, vertex);
 
 #if 0
-            printf("Main vertex: \n");
-            biosal_assembly_vertex_print(&self->main_vertex);
-            printf("\n");
+        printf("Main vertex: \n");
+        biosal_assembly_vertex_print(&self->main_vertex);
+        printf("\n");
 #endif
 
-            self->step = STEP_GET_PARENTS;
+        self->step = STEP_GET_PARENTS;
 
-            return biosal_vertex_neighborhood_execute(self);
+        return biosal_vertex_neighborhood_execute(self);
 
-        } else if (self->step == STEP_GET_PARENTS) {
+    } else if (self->step == STEP_GET_PARENTS) {
 
-            core_vector_push_back(&self->parent_vertices, &vertex);
+        core_vector_push_back(&self->parent_vertices, vertex);
 
-            return biosal_vertex_neighborhood_execute(self);
+        return biosal_vertex_neighborhood_execute(self);
 
-        } else if (self->step == STEP_GET_CHILDREN) {
-            core_vector_push_back(&self->child_vertices, &vertex);
+    } else if (self->step == STEP_GET_CHILDREN) {
+        core_vector_push_back(&self->child_vertices, vertex);
 
-            return biosal_vertex_neighborhood_execute(self);
-        }
+        return biosal_vertex_neighborhood_execute(self);
     }
 
     return 0;
@@ -150,6 +161,7 @@ void biosal_vertex_neighborhood_get_remote_memory(struct biosal_vertex_neighborh
     int store;
     int size;
     int action;
+    struct biosal_assembly_vertex vertex;
 
     action = ACTION_ASSEMBLY_GET_VERTEX;
 
@@ -166,20 +178,37 @@ void biosal_vertex_neighborhood_get_remote_memory(struct biosal_vertex_neighborh
 
     ephemeral_memory = thorium_actor_get_ephemeral_memory(self->actor);
 
-    new_count = biosal_dna_kmer_pack_size(kmer, self->kmer_length,
-                self->codec);
-    new_buffer = thorium_actor_allocate(self->actor, new_count);
-    biosal_dna_kmer_pack(kmer, new_buffer, self->kmer_length, self->codec);
-
     size = core_vector_size(self->graph_stores);
     store_index = biosal_dna_kmer_store_index(kmer, size, self->kmer_length,
                 self->codec, ephemeral_memory);
     store = core_vector_at_as_int(self->graph_stores, store_index);
 
+    /*
+     * With -node-graph-store, a vertex of a graph store on the same node
+     * is read with a function call (but setting a flag needs the store).
+     */
+    if (action == ACTION_ASSEMBLY_GET_VERTEX
+                    && biosal_assembly_graph_store_read_vertex(store, kmer, self->kmer_length,
+                            self->codec, ephemeral_memory, &vertex)) {
+
+        biosal_vertex_neighborhood_add_vertex(self, &vertex);
+        return;
+    }
+
+    new_count = biosal_dna_kmer_pack_size(kmer, self->kmer_length,
+                self->codec);
+    new_buffer = thorium_actor_allocate(self->actor, new_count);
+    biosal_dna_kmer_pack(kmer, new_buffer, self->kmer_length, self->codec);
+
     thorium_message_init(&new_message, action, new_count, new_buffer);
 
     thorium_actor_send(self->actor, store, &new_message);
     thorium_message_destroy(&new_message);
+
+    if (action == ACTION_ASSEMBLY_GET_VERTEX_AND_SET_VISITOR_FLAG) {
+        biosal_assembly_graph_store_invalidate_cached_vertex(self->actor, store, kmer,
+                        self->kmer_length, self->codec, ephemeral_memory);
+    }
 }
 
 int biosal_vertex_neighborhood_execute(struct biosal_vertex_neighborhood *self)
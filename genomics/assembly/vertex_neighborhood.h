@@ -58,6 +58,10 @@ void biosal_vertex_neighborhood_destroy(struct biosal_vertex_neighborhood *self)
 
 /*
  * Returns 1 if data is ready, 0 otherwise.
+ *
+ * With a NULL message, this starts the fetch. Vertices of graph stores on
+ * the same node can be read without messages (-node-graph-store), so the
+ * data may be ready right away.
  */
 int biosal_vertex_neighborhood_receive(struct biosal_vertex_neighborhood *self, struct thorium_message *message);
 
@@ -1,5 +1,6 @@
 
 #include "dna_codec.h"
+#include "dna_codec_interface.h"
 
 #include <genomics/helpers/dna_helper.h>
 
@@ -18,56 +19,36 @@
 
 #define BIOSAL_DNA_CODEC_MINIMUM_NODE_COUNT_FOR_TWO_BIT 2
 
-/*
- * Fast implemention of reverse complement in place
- * in 2-bit format.
- */
-/*
-*/
-#define FAST_REVERSE_COMPLEMENT
-
-#define MEMORY_CODEC 0x9687799e
-
 int biosal_dna_codec_encoded_length_default(struct biosal_dna_codec *self, int length_in_nucleotides);
 void biosal_dna_codec_decode_default(struct biosal_dna_codec *self, int length_in_nucleotides, void *encoded_sequence, char *dna_sequence);
 void biosal_dna_codec_encode_default(struct biosal_dna_codec *self, int length_in_nucleotides, char *dna_sequence, void *encoded_sequence);
+static void biosal_dna_codec_reverse_complement_default(struct biosal_dna_codec *self,
+                int length_in_nucleotides, void *encoded_sequence);
+static int biosal_dna_codec_default_is_supported(void);
+static struct biosal_dna_codec_interface *biosal_dna_codec_select_interface(void);
+
+struct biosal_dna_codec_interface biosal_dna_codec_default_implementation = {
+    .name = "default",
+    .is_supported = biosal_dna_codec_default_is_supported,
+    .encode = biosal_dna_codec_encode_default,
+    .decode = biosal_dna_codec_decode_default,
+    .reverse_complement = biosal_dna_codec_reverse_complement_default
+};
 
-#ifdef BIOSAL_DNA_CODEC_USE_TWO_BIT_BLOCK_ENCODER
-void biosal_dna_codec_encode_with_blocks(struct biosal_dna_codec *self,
-                int length_in_nucleotides, char *dna_sequence, void *encoded_sequence);
-
-void biosal_dna_codec_generate_blocks(struct biosal_dna_codec *self);
-
-void biosal_dna_codec_generate_block(struct biosal_dna_codec *self, int position, char symbol,
-                char *block);
-#endif
-
-#ifdef BIOSAL_DNA_CODEC_USE_TWO_BIT_BLOCK_DECODER
-void biosal_dna_codec_decode_with_blocks(struct biosal_dna_codec *self,
-                int length_in_nucleotides, void *encoded_sequence, char *dna_sequence);
-#endif
+/*
+ * The implementations, from the best to the worst.
+ */
+static struct biosal_dna_codec_interface *biosal_dna_codec_implementations[] = {
+    &biosal_dna_codec_avx2_implementation,
+    &biosal_dna_codec_sse41_implementation,
+    &biosal_dna_codec_word_implementation,
+    &biosal_dna_codec_default_implementation
+};
 
 void biosal_dna_codec_init(struct biosal_dna_codec *self)
 {
-    /* 4 * 2 = 8 bits = 1 byte
-     */
-    self->block_length = 4;
-
     self->use_two_bit_encoding = 0;
-
-#ifdef BIOSAL_DNA_CODEC_USE_TWO_BIT_BLOCK_ENCODER
-    core_memory_pool_init(&self->pool, 0, MEMORY_CODEC);
-
-    core_map_init(&self->encoding_lookup_table, self->block_length, 1);
-    core_map_set_memory_pool(&self->encoding_lookup_table, &self->pool);
-#endif
-
-#ifdef BIOSAL_DNA_CODEC_USE_TWO_BIT_BLOCK_DECODER
-    core_map_init(&self->decoding_lookup_table, 1, self->block_length);
-    core_map_set_memory_pool(&self->decoding_lookup_table, &self->pool);
-
-    biosal_dna_codec_generate_blocks(self);
-#endif
+    self->interface = biosal_dna_codec_select_interface();
 
 #ifdef BIOSAL_DNA_CODEC_FORCE_TWO_BIT_ENCODING_DISABLE_000
     biosal_dna_codec_enable_two_bit_encoding(self);
@@ -76,76 +57,40 @@ void biosal_dna_codec_init(struct biosal_dna_codec *self)
 
 void biosal_dna_codec_destroy(struct biosal_dna_codec *self)
 {
-#ifdef BIOSAL_DNA_CODEC_USE_TWO_BIT_BLOCK_ENCODER
-    core_map_destroy(&self->encoding_lookup_table);
-#endif
-#ifdef BIOSAL_DNA_CODEC_USE_TWO_BIT_BLOCK_DECODER
-    core_map_destroy(&self->decoding_lookup_table);
-
-    core_memory_pool_destroy(&self->pool);
-#endif
-
-    self->block_length = 0;
+    self->interface = NULL;
 }
 
-#ifdef BIOSAL_DNA_CODEC_USE_TWO_BIT_BLOCK_ENCODER
-void biosal_dna_codec_generate_blocks(struct biosal_dna_codec *self)
+static struct biosal_dna_codec_interface *biosal_dna_codec_select_interface(void)
 {
-    char *block;
+    int i;
+    int count;
 
-    block = core_memory_allocate(self->block_length + 1, MEMORY_CODEC);
+    count = sizeof(biosal_dna_codec_implementations) / sizeof(biosal_dna_codec_implementations[0]);
 
-    biosal_dna_codec_generate_block(self, -1, 'X', block);
+    for (i = 0; i < count; ++i) {
+        if (biosal_dna_codec_implementations[i]->is_supported()) {
+            return biosal_dna_codec_implementations[i];
+        }
+    }
 
-    core_memory_free(block, MEMORY_CODEC);
+    return &biosal_dna_codec_default_implementation;
 }
 
-void biosal_dna_codec_generate_block(struct biosal_dna_codec *self, int position, char symbol,
-                char *block)
+void biosal_dna_codec_set_interface(struct biosal_dna_codec *self,
+                struct biosal_dna_codec_interface *interface)
 {
-    char buffer[10];
-    void *bucket;
-
-#ifdef BIOSAL_DNA_CODEC_DEBUG
-    printf("DEBUG position %d symbol %c\n", position, symbol);
-#endif
-
-    if (position >= 0) {
-        block[position] = symbol;
-    }
-
-    position++;
-
-    if (position < self->block_length && symbol != '\0') {
-
-        biosal_dna_codec_generate_block(self, position, 'A', block);
-        biosal_dna_codec_generate_block(self, position, 'T', block);
-        biosal_dna_codec_generate_block(self, position, 'G', block);
-        biosal_dna_codec_generate_block(self, position, 'C', block);
-        /*biosal_dna_codec_generate_block(self, position, '\0', block);*/
-    } else {
-
-        while (position < self->block_length + 1) {
-
-            block[position] = '\0';
-            position++;
-        }
-
-        biosal_dna_codec_encode_default(self, self->block_length, block, buffer);
-
-#ifdef BIOSAL_DNA_CODEC_DEBUG
-        printf("BLOCK %s (%d) value %d\n", block, self->block_length, (int)buffer[0]);
-#endif
-
-        bucket = core_map_add(&self->encoding_lookup_table, block);
-        core_memory_copy(bucket, buffer, 1);
+    self->interface = interface;
+}
 
-        bucket = core_map_add(&self->decoding_lookup_table, buffer);
-        core_memory_copy(bucket, block, self->block_length);
-    }
+struct biosal_dna_codec_interface *biosal_dna_codec_get_interface(struct biosal_dna_codec *self)
+{
+    return self->interface;
+}
 
+static int biosal_dna_codec_default_is_supported(void)
+{
+    return 1;
 }
-#endif
 
 int biosal_dna_codec_encoded_length(struct biosal_dna_codec *self, int length_in_nucleotides)
 {
@@ -176,75 +121,12 @@ void biosal_dna_codec_encode(struct biosal_dna_codec *self,
                 int length_in_nucleotides, char *dna_sequence, void *encoded_sequence)
 {
     if (self->use_two_bit_encoding) {
-
-#ifdef BIOSAL_DNA_CODEC_USE_TWO_BIT_BLOCK_ENCODER
-        biosal_dna_codec_encode_with_blocks(self, length_in_nucleotides, dna_sequence, encoded_sequence);
-#else
-        biosal_dna_codec_encode_default(self, length_in_nucleotides, dna_sequence, encoded_sequence);
-#endif
+        self->interface->encode(self, length_in_nucleotides, dna_sequence, encoded_sequence);
     } else {
         strcpy(encoded_sequence, dna_sequence);
     }
 }
 
-#ifdef BIOSAL_DNA_CODEC_USE_TWO_BIT_BLOCK_ENCODER
-void biosal_dna_codec_encode_with_blocks(struct biosal_dna_codec *self,
-                int length_in_nucleotides, char *dna_sequence, void *encoded_sequence)
-{
-
-#if 0
-    biosal_dna_codec_encode_default(length_in_nucleotides, dna_sequence, encoded_sequence);
-#endif
-    int position;
-    uint8_t byte;
-    char data[5];
-    int remaining;
-    char *block;
-    int byte_position;
-
-    byte_position = 0;
-    position = 0;
-
-#ifdef BIOSAL_DNA_CODEC_DEBUG
-    printf("DEBUG encoding %s\n", dna_sequence);
-#endif
-
-    while (position < length_in_nucleotides) {
-
-
-        remaining = length_in_nucleotides - position;
-        block = dna_sequence + position;
-
-#ifdef BIOSAL_DNA_CODEC_DEBUG
-        printf("DEBUG position %d remaining %d block_length %d\n",
-                        position, remaining, self->block_length);
-#endif
-
-        /* a buffer is required when less than block size
-         * nucleotides remain
-         */
-        if (remaining < self->block_length) {
-
-            /* A is 00, so it is the same as nothing
-             */
-            memset(data, 'A', self->block_length);
-            core_memory_copy(data, block, remaining);
-            block = data;
-        }
-
-#ifdef BIOSAL_DNA_CODEC_DEBUG
-        printf("DEBUG block %c%c%c%c\n", block[0], block[1], block[2], block[3]);
-#endif
-
-        byte = *(char *)core_map_get(&self->encoding_lookup_table, block);
-        ((char *)encoded_sequence)[byte_position] = byte;
-
-        byte_position++;
-        position += self->block_length;
-    }
-}
-#endif
-
 void biosal_dna_codec_encode_default(struct biosal_dna_codec *codec,
                 int length_in_nucleotides, char *dna_sequence, void *encoded_sequence)
 {
@@ -278,51 +160,12 @@ void biosal_dna_codec_decode(struct biosal_dna_codec *codec,
                 int length_in_nucleotides, void *encoded_sequence, char *dna_sequence)
 {
     if (codec->use_two_bit_encoding) {
-#ifdef BIOSAL_DNA_CODEC_USE_TWO_BIT_BLOCK_DECODER
-        biosal_dna_codec_decode_with_blocks(codec, length_in_nucleotides, encoded_sequence, dna_sequence);
-#else
-        biosal_dna_codec_decode_default(codec, length_in_nucleotides, encoded_sequence, dna_sequence);
-
-#endif
+        codec->interface->decode(codec, length_in_nucleotides, encoded_sequence, dna_sequence);
     } else {
         strcpy(dna_sequence, encoded_sequence);
     }
 }
 
-#ifdef BIOSAL_DNA_CODEC_USE_TWO_BIT_BLOCK_DECODER
-void biosal_dna_codec_decode_with_blocks(struct biosal_dna_codec *self,
-                int length_in_nucleotides, void *encoded_sequence, char *dna_sequence)
-{
-    char byte;
-    int nucleotide_position;
-    int encoded_position;
-    int remaining;
-    void *encoded_block;
-    int to_copy;
-
-    encoded_position = 0;
-    nucleotide_position = 0;
-
-    while (nucleotide_position < length_in_nucleotides) {
-
-        remaining = length_in_nucleotides - nucleotide_position;
-        byte = ((char *)encoded_sequence)[encoded_position];
-        encoded_block = core_map_get(&self->decoding_lookup_table, &byte);
-        to_copy = self->block_length;
-
-        if (to_copy > remaining) {
-            to_copy = remaining;
-        }
-        core_memory_copy(dna_sequence + nucleotide_position, encoded_block, to_copy);
-
-        nucleotide_position += self->block_length;
-        encoded_position++;
-    }
-
-    dna_sequence[length_in_nucleotides] = '\0';
-}
-#endif
-
 void biosal_dna_codec_decode_default(struct biosal_dna_codec *codec, int length_in_nucleotides, void *encoded_sequence, char *dna_sequence)
 {
     int i;
@@ -488,7 +331,17 @@ char biosal_dna_codec_get_nucleotide_from_code(uint64_t code)
 void biosal_dna_codec_reverse_complement_in_place(struct biosal_dna_codec *codec,
                 int length_in_nucleotides, void *encoded_sequence)
 {
-#ifdef FAST_REVERSE_COMPLEMENT
+    if (!codec->use_two_bit_encoding) {
+        biosal_dna_helper_reverse_complement_in_place(encoded_sequence);
+        return;
+    }
+
+    codec->interface->reverse_complement(codec, length_in_nucleotides, encoded_sequence);
+}
+
+static void biosal_dna_codec_reverse_complement_default(struct biosal_dna_codec *codec,
+                int length_in_nucleotides, void *encoded_sequence)
+{
     int encoded_length;
     int i;
     uint64_t byte_value;
@@ -501,14 +354,6 @@ void biosal_dna_codec_reverse_complement_in_place(struct biosal_dna_codec *codec
     char blank;
     int total_length;
 
-    /* Abort if the 2 bit encoding is not being used.
-     */
-    if (!codec->use_two_bit_encoding) {
-        biosal_dna_helper_reverse_complement_in_place(encoded_sequence);
-        return;
-    }
-
-
 #if 0
     char *sequence;
 
@@ -594,19 +439,6 @@ void biosal_dna_codec_reverse_complement_in_place(struct biosal_dna_codec *codec
 #endif
 
 
-#else
-    char *sequence;
-
-    sequence = core_memory_allocate(length_in_nucleotides + 1);
-
-    biosal_dna_codec_decode(codec, length_in_nucleotides, encoded_sequence, sequence);
-
-    biosal_dna_helper_reverse_complement_in_place(sequence);
-
-    biosal_dna_codec_encode(codec, length_in_nucleotides, sequence, encoded_sequence);
-
-    core_memory_free(sequence);
-#endif
 }
 
 void biosal_dna_codec_enable_two_bit_encoding(struct biosal_dna_codec *codec)
@@ -660,6 +492,35 @@ int biosal_dna_codec_is_canonical(struct biosal_dna_codec *codec,
     return 1;
 }
 
+/*
+ * A palindromic sequence is equal to its reverse complement.
+ */
+int biosal_dna_codec_is_palindrome(struct biosal_dna_codec *codec,
+                int length_in_nucleotides, void *encoded_sequence)
+{
+    int i;
+    char nucleotide;
+    char other_nucleotide;
+
+    for (i = 0; i < length_in_nucleotides / 2; ++i) {
+
+        nucleotide = biosal_dna_codec_get_nucleotide(codec, encoded_sequence, i);
+
+        other_nucleotide = biosal_dna_codec_get_nucleotide(codec, encoded_sequence,
+                        length_in_nucleotides - 1 - i);
+
+        if (nucleotide != biosal_dna_helper_complement_nucleotide(other_nucleotide)) {
+            return 0;
+        }
+    }
+
+    /*
+     * The middle nucleotide of an odd length is never its own
+     * complement.
+     */
+    return length_in_nucleotides % 2 == 0;
+}
+
 int biosal_dna_codec_get_complement(int code)
 {
     if (code == BIOSAL_NUCLEOTIDE_CODE_A) {
@@ -22,30 +22,18 @@
 #define BIOSAL_NUCLEOTIDE_SYMBOL_G 'G'
 #define BIOSAL_NUCLEOTIDE_SYMBOL_T 'T'
 
-/*
- * use block encoder (faster or not ?)
-#define BIOSAL_DNA_CODEC_USE_TWO_BIT_BLOCK_ENCODER
- */
-
-/*
- * use block decoder (faster or not ?)
-#define BIOSAL_DNA_CODEC_USE_TWO_BIT_BLOCK_DECODER
- */
+struct biosal_dna_codec_interface;
 
 /*
  * A class to encode and decode DNA data.
+ *
+ * The 2-bit kernels are provided by a biosal_dna_codec_interface
+ * selected at run time (vector kernels if the processor has them).
  */
 struct biosal_dna_codec {
-#ifdef BIOSAL_DNA_CODEC_USE_TWO_BIT_BLOCK_ENCODER
-    struct core_map encoding_lookup_table;
-#endif
-#ifdef BIOSAL_DNA_CODEC_USE_TWO_BIT_BLOCK_DECODER
-    struct core_map decoding_lookup_table;
-#endif
-    int block_length;
+    struct biosal_dna_codec_interface *interface;
 
     int use_two_bit_encoding;
-    struct core_memory_pool pool;
 };
 
 void biosal_dna_codec_init(struct biosal_dna_codec *self);
@@ -71,6 +59,8 @@ void biosal_dna_codec_disable_two_bit_encoding(struct biosal_dna_codec *codec);
 
 int biosal_dna_codec_is_canonical(struct biosal_dna_codec *codec,
                 int length_in_nucleotides, void *encoded_sequence);
+int biosal_dna_codec_is_palindrome(struct biosal_dna_codec *codec,
+                int length_in_nucleotides, void *encoded_sequence);
 int biosal_dna_codec_get_complement(int code);
 
 void biosal_dna_codec_mutate_as_child(struct biosal_dna_codec *self,
@@ -80,4 +70,12 @@ void biosal_dna_codec_mutate_as_parent(struct biosal_dna_codec *self,
 int biosal_dna_codec_must_use_two_bit_encoding(struct biosal_dna_codec *self,
                 int node_count);
 
+/*
+ * Select the implementation of the 2-bit kernels. This is only
+ * useful for tests and benchmarks.
+ */
+void biosal_dna_codec_set_interface(struct biosal_dna_codec *self,
+                struct biosal_dna_codec_interface *interface);
+struct biosal_dna_codec_interface *biosal_dna_codec_get_interface(struct biosal_dna_codec *self);
+
 #endif
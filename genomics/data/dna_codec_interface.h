@@ -0,0 +1,44 @@
+
+#ifndef BIOSAL_DNA_CODEC_INTERFACE_H
+#define BIOSAL_DNA_CODEC_INTERFACE_H
+
+struct biosal_dna_codec;
+
+/*
+ * An interface for the 2-bit kernels of the codec.
+ *
+ * All the implementations produce exactly the same bytes:
+ * nucleotide i is stored at bit 2 * (i % 4) of byte i / 4, symbols
+ * other than A, C, G and T are encoded as A, and the padding is 0.
+ *
+ * The codec picks the best supported implementation at run time.
+ */
+struct biosal_dna_codec_interface {
+    const char *name;
+    int (*is_supported)(void);
+    void (*encode)(struct biosal_dna_codec *self, int length_in_nucleotides,
+                    char *dna_sequence, void *encoded_sequence);
+    void (*decode)(struct biosal_dna_codec *self, int length_in_nucleotides,
+                    void *encoded_sequence, char *dna_sequence);
+    void (*reverse_complement)(struct biosal_dna_codec *self, int length_in_nucleotides,
+                    void *encoded_sequence);
+};
+
+/*
+ * One nucleotide at a time.
+ */
+extern struct biosal_dna_codec_interface biosal_dna_codec_default_implementation;
+
+/*
+ * Portable 64-bit word kernels.
+ */
+extern struct biosal_dna_codec_interface biosal_dna_codec_word_implementation;
+
+/*
+ * x86 vector kernels, only supported if the processor
+ * has the instructions.
+ */
+extern struct biosal_dna_codec_interface biosal_dna_codec_sse41_implementation;
+extern struct biosal_dna_codec_interface biosal_dna_codec_avx2_implementation;
+
+#endif
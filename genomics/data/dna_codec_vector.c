@@ -0,0 +1,409 @@
+
+#include "dna_codec_interface.h"
+#include "dna_codec_word.h"
+
+#include "dna_codec.h"
+
+#include <string.h>
+#include <stdint.h>
+
+/*
+ * The x86 kernels are compiled with target attributes so that the
+ * library does not need -msse4.1 or -mavx2. They are only called if
+ * the processor supports the instructions (checked at run time).
+ */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) \
+        && !defined(BIOSAL_DNA_CODEC_DISABLE_VECTOR_KERNELS)
+#define BIOSAL_DNA_CODEC_HAS_X86_KERNELS
+#endif
+
+#ifdef BIOSAL_DNA_CODEC_HAS_X86_KERNELS
+
+#include <immintrin.h>
+
+#define SSE41 __attribute__((target("sse4.1")))
+#define AVX2 __attribute__((target("avx2")))
+
+#define NUCLEOTIDES_PER_BYTE 4
+
+/*
+ * Tables for _mm_shuffle_epi8 indexed by 4 bits (2 nucleotides).
+ */
+#define EVEN_SYMBOLS \
+    'A', 'C', 'G', 'T', 'A', 'C', 'G', 'T', 'A', 'C', 'G', 'T', 'A', 'C', 'G', 'T'
+#define ODD_SYMBOLS \
+    'A', 'A', 'A', 'A', 'C', 'C', 'C', 'C', 'G', 'G', 'G', 'G', 'T', 'T', 'T', 'T'
+
+/*
+ * Swap the 2 nucleotides of 4 bits.
+ */
+#define SWAPPED_PAIRS \
+    0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15
+
+#define DECODER_SHUFFLE \
+    0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3
+#define HIGH_NIBBLE_MASK \
+    0, 0, -1, -1, 0, 0, -1, -1, 0, 0, -1, -1, 0, 0, -1, -1
+#define ODD_MASK \
+    0, -1, 0, -1, 0, -1, 0, -1, 0, -1, 0, -1, 0, -1, 0, -1
+#define ENCODER_SHUFFLE \
+    0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+#define REVERSE_SHUFFLE \
+    15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0
+
+/*
+ * SSE4.1
+ */
+
+SSE41 static inline __m128i biosal_dna_codec_sse41_encode_vector(__m128i symbols)
+{
+    __m128i codes;
+
+    codes = _mm_and_si128(_mm_cmpeq_epi8(symbols, _mm_set1_epi8(BIOSAL_NUCLEOTIDE_SYMBOL_C)),
+                    _mm_set1_epi8(BIOSAL_NUCLEOTIDE_CODE_C));
+    codes = _mm_or_si128(codes,
+                    _mm_and_si128(_mm_cmpeq_epi8(symbols, _mm_set1_epi8(BIOSAL_NUCLEOTIDE_SYMBOL_G)),
+                    _mm_set1_epi8(BIOSAL_NUCLEOTIDE_CODE_G)));
+    codes = _mm_or_si128(codes,
+                    _mm_and_si128(_mm_cmpeq_epi8(symbols, _mm_set1_epi8(BIOSAL_NUCLEOTIDE_SYMBOL_T)),
+                    _mm_set1_epi8(BIOSAL_NUCLEOTIDE_CODE_T)));
+
+    /*
+     * c0 + 4 * c1 in 16 bits, and then (c0 + 4 * c1) + 16 * (c2 + 4 * c3)
+     * in 32 bits.
+     */
+    codes = _mm_maddubs_epi16(codes, _mm_set1_epi16(0x0401));
+    codes = _mm_madd_epi16(codes, _mm_set1_epi32(0x00100001));
+
+    return _mm_shuffle_epi8(codes, _mm_setr_epi8(ENCODER_SHUFFLE));
+}
+
+SSE41 static void biosal_dna_codec_sse41_encode(struct biosal_dna_codec *self,
+                int length_in_nucleotides, char *dna_sequence, void *encoded_sequence)
+{
+    int i;
+    int value;
+    uint8_t *bytes;
+    __m128i packed;
+
+    bytes = encoded_sequence;
+    i = 0;
+
+    while (i + 16 <= length_in_nucleotides) {
+
+        packed = biosal_dna_codec_sse41_encode_vector(
+                        _mm_loadu_si128((__m128i *)(dna_sequence + i)));
+
+        value = _mm_cvtsi128_si32(packed);
+        memcpy(bytes + i / NUCLEOTIDES_PER_BYTE, &value, sizeof(value));
+
+        i += 16;
+    }
+
+    biosal_dna_codec_word_encode(self, length_in_nucleotides - i, dna_sequence + i,
+                    bytes + i / NUCLEOTIDES_PER_BYTE);
+}
+
+SSE41 static void biosal_dna_codec_sse41_decode(struct biosal_dna_codec *self,
+                int length_in_nucleotides, void *encoded_sequence, char *dna_sequence)
+{
+    int i;
+    int value;
+    uint8_t *bytes;
+    __m128i codes;
+    __m128i nibbles;
+    __m128i symbols;
+    __m128i odd_mask;
+
+    bytes = encoded_sequence;
+    odd_mask = _mm_setr_epi8(ODD_MASK);
+    i = 0;
+
+    while (i + 16 <= length_in_nucleotides) {
+
+        memcpy(&value, bytes + i / NUCLEOTIDES_PER_BYTE, sizeof(value));
+
+        /*
+         * Byte j goes to the 4 symbols 4 * j ... 4 * j + 3, and each symbol
+         * keeps the nibble that contains its nucleotide.
+         */
+        codes = _mm_shuffle_epi8(_mm_cvtsi32_si128(value), _mm_setr_epi8(DECODER_SHUFFLE));
+        nibbles = _mm_blendv_epi8(_mm_and_si128(codes, _mm_set1_epi8(0x0F)),
+                        _mm_and_si128(_mm_srli_epi16(codes, 4), _mm_set1_epi8(0x0F)),
+                        _mm_setr_epi8(HIGH_NIBBLE_MASK));
+
+        symbols = _mm_blendv_epi8(_mm_shuffle_epi8(_mm_setr_epi8(EVEN_SYMBOLS), nibbles),
+                        _mm_shuffle_epi8(_mm_setr_epi8(ODD_SYMBOLS), nibbles),
+                        odd_mask);
+
+        _mm_storeu_si128((__m128i *)(dna_sequence + i), symbols);
+
+        i += 16;
+    }
+
+    biosal_dna_codec_word_decode(self, length_in_nucleotides - i,
+                    bytes + i / NUCLEOTIDES_PER_BYTE, dna_sequence + i);
+}
+
+SSE41 static inline __m128i biosal_dna_codec_sse41_reverse_complement_vector(__m128i bytes)
+{
+    __m128i swapped_pairs;
+    __m128i low;
+    __m128i high;
+
+    swapped_pairs = _mm_setr_epi8(SWAPPED_PAIRS);
+
+    bytes = _mm_xor_si128(bytes, _mm_set1_epi8(-1));
+
+    low = _mm_shuffle_epi8(swapped_pairs, _mm_and_si128(bytes, _mm_set1_epi8(0x0F)));
+    high = _mm_shuffle_epi8(swapped_pairs,
+                    _mm_and_si128(_mm_srli_epi16(bytes, 4), _mm_set1_epi8(0x0F)));
+
+    bytes = _mm_or_si128(_mm_slli_epi16(low, 4), high);
+
+    return _mm_shuffle_epi8(bytes, _mm_setr_epi8(REVERSE_SHUFFLE));
+}
+
+SSE41 static void biosal_dna_codec_sse41_reverse_complement(struct biosal_dna_codec *self,
+                int length_in_nucleotides, void *encoded_sequence)
+{
+    int encoded_length;
+    int left;
+    int right;
+    uint8_t *bytes;
+    __m128i left_vector;
+    __m128i right_vector;
+
+    bytes = encoded_sequence;
+    encoded_length = length_in_nucleotides / NUCLEOTIDES_PER_BYTE + 1;
+    left = 0;
+    right = encoded_length;
+
+    while (right - left >= 32) {
+
+        left_vector = _mm_loadu_si128((__m128i *)(bytes + left));
+        right_vector = _mm_loadu_si128((__m128i *)(bytes + right - 16));
+
+        _mm_storeu_si128((__m128i *)(bytes + left),
+                        biosal_dna_codec_sse41_reverse_complement_vector(right_vector));
+        _mm_storeu_si128((__m128i *)(bytes + right - 16),
+                        biosal_dna_codec_sse41_reverse_complement_vector(left_vector));
+
+        left += 16;
+        right -= 16;
+    }
+
+    biosal_dna_codec_word_reverse_complement_bytes(bytes, left, right);
+    biosal_dna_codec_word_shift_down(bytes, encoded_length,
+                    encoded_length * NUCLEOTIDES_PER_BYTE - length_in_nucleotides);
+}
+
+static int biosal_dna_codec_sse41_is_supported(void)
+{
+    __builtin_cpu_init();
+
+    return __builtin_cpu_supports("sse4.1");
+}
+
+/*
+ * AVX2
+ *
+ * _mm256_shuffle_epi8 works inside each 128-bit lane, so the
+ * 128-bit constants are used in both lanes.
+ */
+
+AVX2 static inline __m256i biosal_dna_codec_avx2_set(__m128i lane)
+{
+    return _mm256_broadcastsi128_si256(lane);
+}
+
+AVX2 static void biosal_dna_codec_avx2_encode(struct biosal_dna_codec *self,
+                int length_in_nucleotides, char *dna_sequence, void *encoded_sequence)
+{
+    int i;
+    uint8_t *bytes;
+    __m256i symbols;
+    __m256i codes;
+
+    bytes = encoded_sequence;
+    i = 0;
+
+    while (i + 32 <= length_in_nucleotides) {
+
+        symbols = _mm256_loadu_si256((__m256i *)(dna_sequence + i));
+
+        codes = _mm256_and_si256(_mm256_cmpeq_epi8(symbols, _mm256_set1_epi8(BIOSAL_NUCLEOTIDE_SYMBOL_C)),
+                        _mm256_set1_epi8(BIOSAL_NUCLEOTIDE_CODE_C));
+        codes = _mm256_or_si256(codes,
+                        _mm256_and_si256(_mm256_cmpeq_epi8(symbols, _mm256_set1_epi8(BIOSAL_NUCLEOTIDE_SYMBOL_G)),
+                        _mm256_set1_epi8(BIOSAL_NUCLEOTIDE_CODE_G)));
+        codes = _mm256_or_si256(codes,
+                        _mm256_and_si256(_mm256_cmpeq_epi8(symbols, _mm256_set1_epi8(BIOSAL_NUCLEOTIDE_SYMBOL_T)),
+                        _mm256_set1_epi8(BIOSAL_NUCLEOTIDE_CODE_T)));
+
+        codes = _mm256_maddubs_epi16(codes, _mm256_set1_epi16(0x0401));
+        codes = _mm256_madd_epi16(codes, _mm256_set1_epi32(0x00100001));
+        codes = _mm256_shuffle_epi8(codes, biosal_dna_codec_avx2_set(_mm_setr_epi8(ENCODER_SHUFFLE)));
+
+        /*
+         * Bytes 0-3 of lane 0 and bytes 0-3 of lane 1 (32-bit element 4).
+         */
+        codes = _mm256_permutevar8x32_epi32(codes, _mm256_setr_epi32(0, 4, 0, 0, 0, 0, 0, 0));
+
+        _mm_storel_epi64((__m128i *)(bytes + i / NUCLEOTIDES_PER_BYTE),
+                        _mm256_castsi256_si128(codes));
+
+        i += 32;
+    }
+
+    biosal_dna_codec_sse41_encode(self, length_in_nucleotides - i, dna_sequence + i,
+                    bytes + i / NUCLEOTIDES_PER_BYTE);
+}
+
+AVX2 static void biosal_dna_codec_avx2_decode(struct biosal_dna_codec *self,
+                int length_in_nucleotides, void *encoded_sequence, char *dna_sequence)
+{
+    int i;
+    uint8_t *bytes;
+    __m256i codes;
+    __m256i nibbles;
+    __m256i symbols;
+    __m256i decoder_shuffle;
+
+    bytes = encoded_sequence;
+
+    /*
+     * Lane 0 uses bytes 0-3 and lane 1 uses bytes 4-7.
+     */
+    decoder_shuffle = _mm256_add_epi8(biosal_dna_codec_avx2_set(_mm_setr_epi8(DECODER_SHUFFLE)),
+                    _mm256_setr_epi64x(0, 0, 0x0404040404040404LL, 0x0404040404040404LL));
+    i = 0;
+
+    while (i + 32 <= length_in_nucleotides) {
+
+        codes = biosal_dna_codec_avx2_set(
+                        _mm_loadl_epi64((__m128i *)(bytes + i / NUCLEOTIDES_PER_BYTE)));
+        codes = _mm256_shuffle_epi8(codes, decoder_shuffle);
+
+        nibbles = _mm256_blendv_epi8(_mm256_and_si256(codes, _mm256_set1_epi8(0x0F)),
+                        _mm256_and_si256(_mm256_srli_epi16(codes, 4), _mm256_set1_epi8(0x0F)),
+                        biosal_dna_codec_avx2_set(_mm_setr_epi8(HIGH_NIBBLE_MASK)));
+
+        symbols = _mm256_blendv_epi8(
+                        _mm256_shuffle_epi8(biosal_dna_codec_avx2_set(_mm_setr_epi8(EVEN_SYMBOLS)), nibbles),
+                        _mm256_shuffle_epi8(biosal_dna_codec_avx2_set(_mm_setr_epi8(ODD_SYMBOLS)), nibbles),
+                        biosal_dna_codec_avx2_set(_mm_setr_epi8(ODD_MASK)));
+
+        _mm256_storeu_si256((__m256i *)(dna_sequence + i), symbols);
+
+        i += 32;
+    }
+
+    biosal_dna_codec_sse41_decode(self, length_in_nucleotides - i,
+                    bytes + i / NUCLEOTIDES_PER_BYTE, dna_sequence + i);
+}
+
+AVX2 static inline __m256i biosal_dna_codec_avx2_reverse_complement_vector(__m256i bytes)
+{
+    __m256i swapped_pairs;
+    __m256i low;
+    __m256i high;
+
+    swapped_pairs = biosal_dna_codec_avx2_set(_mm_setr_epi8(SWAPPED_PAIRS));
+
+    bytes = _mm256_xor_si256(bytes, _mm256_set1_epi8(-1));
+
+    low = _mm256_shuffle_epi8(swapped_pairs, _mm256_and_si256(bytes, _mm256_set1_epi8(0x0F)));
+    high = _mm256_shuffle_epi8(swapped_pairs,
+                    _mm256_and_si256(_mm256_srli_epi16(bytes, 4), _mm256_set1_epi8(0x0F)));
+
+    bytes = _mm256_or_si256(_mm256_slli_epi16(low, 4), high);
+    bytes = _mm256_shuffle_epi8(bytes, biosal_dna_codec_avx2_set(_mm_setr_epi8(REVERSE_SHUFFLE)));
+
+    return _mm256_permute2x128_si256(bytes, bytes, 0x01);
+}
+
+AVX2 static void biosal_dna_codec_avx2_reverse_complement(struct biosal_dna_codec *self,
+                int length_in_nucleotides, void *encoded_sequence)
+{
+    int encoded_length;
+    int left;
+    int right;
+    uint8_t *bytes;
+    __m256i left_vector;
+    __m256i right_vector;
+
+    bytes = encoded_sequence;
+    encoded_length = length_in_nucleotides / NUCLEOTIDES_PER_BYTE + 1;
+    left = 0;
+    right = encoded_length;
+
+    while (right - left >= 64) {
+
+        left_vector = _mm256_loadu_si256((__m256i *)(bytes + left));
+        right_vector = _mm256_loadu_si256((__m256i *)(bytes + right - 32));
+
+        _mm256_storeu_si256((__m256i *)(bytes + left),
+                        biosal_dna_codec_avx2_reverse_complement_vector(right_vector));
+        _mm256_storeu_si256((__m256i *)(bytes + right - 32),
+                        biosal_dna_codec_avx2_reverse_complement_vector(left_vector));
+
+        left += 32;
+        right -= 32;
+    }
+
+    biosal_dna_codec_word_reverse_complement_bytes(bytes, left, right);
+    biosal_dna_codec_word_shift_down(bytes, encoded_length,
+                    encoded_length * NUCLEOTIDES_PER_BYTE - length_in_nucleotides);
+}
+
+static int biosal_dna_codec_avx2_is_supported(void)
+{
+    __builtin_cpu_init();
+
+    return __builtin_cpu_supports("avx2");
+}
+
+struct biosal_dna_codec_interface biosal_dna_codec_sse41_implementation = {
+    .name = "sse4.1",
+    .is_supported = biosal_dna_codec_sse41_is_supported,
+    .encode = biosal_dna_codec_sse41_encode,
+    .decode = biosal_dna_codec_sse41_decode,
+    .reverse_complement = biosal_dna_codec_sse41_reverse_complement
+};
+
+struct biosal_dna_codec_interface biosal_dna_codec_avx2_implementation = {
+    .name = "avx2",
+    .is_supported = biosal_dna_codec_avx2_is_supported,
+    .encode = biosal_dna_codec_avx2_encode,
+    .decode = biosal_dna_codec_avx2_decode,
+    .reverse_complement = biosal_dna_codec_avx2_reverse_complement
+};
+
+#else
+
+/*
+ * Other systems (Blue Gene/Q, ...) use the word kernels.
+ */
+static int biosal_dna_codec_vector_is_supported(void)
+{
+    return 0;
+}
+
+struct biosal_dna_codec_interface biosal_dna_codec_sse41_implementation = {
+    .name = "sse4.1",
+    .is_supported = biosal_dna_codec_vector_is_supported,
+    .encode = biosal_dna_codec_word_encode,
+    .decode = biosal_dna_codec_word_decode,
+    .reverse_complement = biosal_dna_codec_word_reverse_complement
+};
+
+struct biosal_dna_codec_interface biosal_dna_codec_avx2_implementation = {
+    .name = "avx2",
+    .is_supported = biosal_dna_codec_vector_is_supported,
+    .encode = biosal_dna_codec_word_encode,
+    .decode = biosal_dna_codec_word_decode,
+    .reverse_complement = biosal_dna_codec_word_reverse_complement
+};
+
+#endif
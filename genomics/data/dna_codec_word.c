@@ -0,0 +1,307 @@
+
+#include "dna_codec_word.h"
+
+#include "dna_codec.h"
+
+#include <string.h>
+
+#define WORD_ONES ((uint64_t)0x0101010101010101ULL)
+#define WORD_LOW_SEVEN_BITS ((uint64_t)0x7F7F7F7F7F7F7F7FULL)
+#define WORD_PAIRS ((uint64_t)0x3333333333333333ULL)
+#define WORD_NIBBLES ((uint64_t)0x0F0F0F0F0F0F0F0FULL)
+
+#define NUCLEOTIDES_PER_BYTE 4
+#define NUCLEOTIDES_PER_WORD 8
+#define BYTES_PER_WORD 8
+
+static int biosal_dna_codec_word_is_supported(void);
+static inline uint64_t biosal_dna_codec_word_load(uint8_t *bytes);
+static inline void biosal_dna_codec_word_store(uint8_t *bytes, uint64_t word);
+static inline void biosal_dna_codec_word_store_reversed(uint8_t *bytes, uint64_t word);
+static inline uint64_t biosal_dna_codec_word_find_symbol(uint64_t word, char symbol);
+static inline uint64_t biosal_dna_codec_word_encode_word(uint64_t symbols);
+static inline uint64_t biosal_dna_codec_word_decode_word(uint64_t codes);
+static inline uint64_t biosal_dna_codec_word_reverse_complement_word(uint64_t word);
+static inline uint8_t biosal_dna_codec_word_reverse_complement_byte(uint8_t byte);
+
+struct biosal_dna_codec_interface biosal_dna_codec_word_implementation = {
+    .name = "word",
+    .is_supported = biosal_dna_codec_word_is_supported,
+    .encode = biosal_dna_codec_word_encode,
+    .decode = biosal_dna_codec_word_decode,
+    .reverse_complement = biosal_dna_codec_word_reverse_complement
+};
+
+static int biosal_dna_codec_word_is_supported(void)
+{
+    return 1;
+}
+
+/*
+ * Byte i of the sequence is byte i of the word (little endian order).
+ * Compilers turn this into one load on little endian systems.
+ */
+static inline uint64_t biosal_dna_codec_word_load(uint8_t *bytes)
+{
+    return ((uint64_t)bytes[0])
+            | ((uint64_t)bytes[1] << 8)
+            | ((uint64_t)bytes[2] << 16)
+            | ((uint64_t)bytes[3] << 24)
+            | ((uint64_t)bytes[4] << 32)
+            | ((uint64_t)bytes[5] << 40)
+            | ((uint64_t)bytes[6] << 48)
+            | ((uint64_t)bytes[7] << 56);
+}
+
+static inline void biosal_dna_codec_word_store(uint8_t *bytes, uint64_t word)
+{
+    int i;
+
+    for (i = 0; i < BYTES_PER_WORD; ++i) {
+        bytes[i] = (uint8_t)(word >> (i * 8));
+    }
+}
+
+static inline void biosal_dna_codec_word_store_reversed(uint8_t *bytes, uint64_t word)
+{
+    int i;
+
+    for (i = 0; i < BYTES_PER_WORD; ++i) {
+        bytes[BYTES_PER_WORD - 1 - i] = (uint8_t)(word >> (i * 8));
+    }
+}
+
+/*
+ * \return 1 in each byte equal to symbol, 0 elsewhere
+ *
+ * \see https://graphics.stanford.edu/~seander/bithacks.html#ZeroInWord
+ */
+static inline uint64_t biosal_dna_codec_word_find_symbol(uint64_t word, char symbol)
+{
+    uint64_t difference;
+
+    difference = word ^ (WORD_ONES * (uint8_t)symbol);
+
+    return (~(((difference & WORD_LOW_SEVEN_BITS) + WORD_LOW_SEVEN_BITS)
+                            | difference | WORD_LOW_SEVEN_BITS)) >> 7;
+}
+
+/*
+ * 8 symbols -> 16 bits
+ */
+static inline uint64_t biosal_dna_codec_word_encode_word(uint64_t symbols)
+{
+    uint64_t codes;
+
+    /*
+     * One code per byte. Any other symbol is A (0), like
+     * biosal_dna_codec_get_code.
+     */
+    codes = biosal_dna_codec_word_find_symbol(symbols, BIOSAL_NUCLEOTIDE_SYMBOL_C) * BIOSAL_NUCLEOTIDE_CODE_C;
+    codes |= biosal_dna_codec_word_find_symbol(symbols, BIOSAL_NUCLEOTIDE_SYMBOL_G) * BIOSAL_NUCLEOTIDE_CODE_G;
+    codes |= biosal_dna_codec_word_find_symbol(symbols, BIOSAL_NUCLEOTIDE_SYMBOL_T) * BIOSAL_NUCLEOTIDE_CODE_T;
+
+    /*
+     * Gather the 2-bit codes: 8 bytes -> 4 x 4 bits -> 2 x 8 bits -> 16 bits
+     */
+    codes = (codes | (codes >> 6)) & 0x000F000F000F000FULL;
+    codes = (codes | (codes >> 12)) & 0x000000FF000000FFULL;
+    codes = (codes | (codes >> 24)) & 0xFFFFULL;
+
+    return codes;
+}
+
+/*
+ * 16 bits -> 8 symbols
+ */
+static inline uint64_t biosal_dna_codec_word_decode_word(uint64_t codes)
+{
+    uint64_t high;
+    uint64_t both;
+
+    codes = (codes | (codes << 24)) & 0x000000FF000000FFULL;
+    codes = (codes | (codes << 12)) & 0x000F000F000F000FULL;
+    codes = (codes | (codes << 6)) & 0x0303030303030303ULL;
+
+    /*
+     * A, C, G, T are 'A' + 0, 2, 6, 19
+     */
+    high = (codes >> 1) & WORD_ONES;
+    both = codes & high;
+
+    return WORD_ONES * BIOSAL_NUCLEOTIDE_SYMBOL_A + (codes << 1) + (high << 1) + both * 11;
+}
+
+void biosal_dna_codec_word_encode(struct biosal_dna_codec *self,
+                int length_in_nucleotides, char *dna_sequence, void *encoded_sequence)
+{
+    int i;
+    int encoded_length;
+    uint64_t codes;
+    uint8_t *bytes;
+
+    bytes = encoded_sequence;
+    encoded_length = length_in_nucleotides / NUCLEOTIDES_PER_BYTE + 1;
+
+    i = 0;
+
+    while (i + NUCLEOTIDES_PER_WORD <= length_in_nucleotides) {
+
+        codes = biosal_dna_codec_word_encode_word(
+                        biosal_dna_codec_word_load((uint8_t *)dna_sequence + i));
+
+        bytes[i / NUCLEOTIDES_PER_BYTE] = (uint8_t)codes;
+        bytes[i / NUCLEOTIDES_PER_BYTE + 1] = (uint8_t)(codes >> 8);
+
+        i += NUCLEOTIDES_PER_WORD;
+    }
+
+    memset(bytes + i / NUCLEOTIDES_PER_BYTE, 0, encoded_length - i / NUCLEOTIDES_PER_BYTE);
+
+    while (i < length_in_nucleotides) {
+        bytes[i / NUCLEOTIDES_PER_BYTE] |= biosal_dna_codec_get_code(dna_sequence[i])
+                << ((i % NUCLEOTIDES_PER_BYTE) * 2);
+        ++i;
+    }
+}
+
+void biosal_dna_codec_word_decode(struct biosal_dna_codec *self,
+                int length_in_nucleotides, void *encoded_sequence, char *dna_sequence)
+{
+    int i;
+    uint64_t codes;
+    uint8_t *bytes;
+
+    bytes = encoded_sequence;
+    i = 0;
+
+    while (i + NUCLEOTIDES_PER_WORD <= length_in_nucleotides) {
+
+        codes = bytes[i / NUCLEOTIDES_PER_BYTE]
+                | ((uint64_t)bytes[i / NUCLEOTIDES_PER_BYTE + 1] << 8);
+
+        biosal_dna_codec_word_store((uint8_t *)dna_sequence + i,
+                        biosal_dna_codec_word_decode_word(codes));
+
+        i += NUCLEOTIDES_PER_WORD;
+    }
+
+    while (i < length_in_nucleotides) {
+        dna_sequence[i] = biosal_dna_codec_get_nucleotide_from_code(
+                        (bytes[i / NUCLEOTIDES_PER_BYTE] >> ((i % NUCLEOTIDES_PER_BYTE) * 2)) & 3);
+        ++i;
+    }
+
+    dna_sequence[length_in_nucleotides] = '\0';
+}
+
+/*
+ * Complement all the nucleotides (~), and reverse the 4 nucleotides
+ * of each byte. The caller reverses the bytes.
+ */
+static inline uint64_t biosal_dna_codec_word_reverse_complement_word(uint64_t word)
+{
+    word = ~word;
+    word = ((word >> 2) & WORD_PAIRS) | ((word & WORD_PAIRS) << 2);
+    word = ((word >> 4) & WORD_NIBBLES) | ((word & WORD_NIBBLES) << 4);
+
+    return word;
+}
+
+static inline uint8_t biosal_dna_codec_word_reverse_complement_byte(uint8_t byte)
+{
+    return (uint8_t)biosal_dna_codec_word_reverse_complement_word(byte);
+}
+
+void biosal_dna_codec_word_reverse_complement_bytes(uint8_t *bytes, int left, int right)
+{
+    uint64_t left_word;
+    uint64_t right_word;
+    uint8_t left_byte;
+    uint8_t right_byte;
+
+    while (right - left >= 2 * BYTES_PER_WORD) {
+
+        left_word = biosal_dna_codec_word_load(bytes + left);
+        right_word = biosal_dna_codec_word_load(bytes + right - BYTES_PER_WORD);
+
+        biosal_dna_codec_word_store_reversed(bytes + left,
+                        biosal_dna_codec_word_reverse_complement_word(right_word));
+        biosal_dna_codec_word_store_reversed(bytes + right - BYTES_PER_WORD,
+                        biosal_dna_codec_word_reverse_complement_word(left_word));
+
+        left += BYTES_PER_WORD;
+        right -= BYTES_PER_WORD;
+    }
+
+    while (right - left >= 2) {
+
+        left_byte = bytes[left];
+        right_byte = bytes[right - 1];
+
+        bytes[left] = biosal_dna_codec_word_reverse_complement_byte(right_byte);
+        bytes[right - 1] = biosal_dna_codec_word_reverse_complement_byte(left_byte);
+
+        ++left;
+        --right;
+    }
+
+    if (right - left == 1) {
+        bytes[left] = biosal_dna_codec_word_reverse_complement_byte(bytes[left]);
+    }
+}
+
+void biosal_dna_codec_word_shift_down(uint8_t *bytes, int encoded_length, int padding)
+{
+    int i;
+    int shift;
+    uint64_t word;
+    uint8_t next;
+
+    if (padding == NUCLEOTIDES_PER_BYTE) {
+        memmove(bytes, bytes + 1, encoded_length - 1);
+        bytes[encoded_length - 1] = 0;
+        return;
+    }
+
+    shift = padding * 2;
+    i = 0;
+
+    while (i + BYTES_PER_WORD < encoded_length) {
+
+        word = biosal_dna_codec_word_load(bytes + i);
+        word = (word >> shift) | ((uint64_t)bytes[i + BYTES_PER_WORD] << (64 - shift));
+        biosal_dna_codec_word_store(bytes + i, word);
+
+        i += BYTES_PER_WORD;
+    }
+
+    while (i < encoded_length) {
+
+        next = 0;
+
+        if (i + 1 < encoded_length) {
+            next = bytes[i + 1];
+        }
+
+        bytes[i] = (uint8_t)((bytes[i] >> shift) | (next << (8 - shift)));
+        ++i;
+    }
+}
+
+/*
+ * After reversing all the bytes, the padding (at least one nucleotide)
+ * is at the beginning, so everything is moved down by the padding.
+ */
+void biosal_dna_codec_word_reverse_complement(struct biosal_dna_codec *self,
+                int length_in_nucleotides, void *encoded_sequence)
+{
+    int encoded_length;
+    int padding;
+
+    encoded_length = length_in_nucleotides / NUCLEOTIDES_PER_BYTE + 1;
+    padding = encoded_length * NUCLEOTIDES_PER_BYTE - length_in_nucleotides;
+
+    biosal_dna_codec_word_reverse_complement_bytes(encoded_sequence, 0, encoded_length);
+    biosal_dna_codec_word_shift_down(encoded_sequence, encoded_length, padding);
+}
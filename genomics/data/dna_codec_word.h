@@ -0,0 +1,40 @@
+
+#ifndef BIOSAL_DNA_CODEC_WORD_H
+#define BIOSAL_DNA_CODEC_WORD_H
+
+#include "dna_codec_interface.h"
+
+#include <stdint.h>
+
+struct biosal_dna_codec;
+
+/*
+ * Portable 64-bit word kernels for the 2-bit codec.
+ *
+ * 8 symbols are encoded or decoded at once with bit tricks
+ * on 64-bit words (SIMD within a register). Words are loaded and
+ * stored byte by byte so that the kernels are the same on big endian
+ * systems.
+ *
+ * The vector kernels use these for the tails.
+ */
+void biosal_dna_codec_word_encode(struct biosal_dna_codec *self,
+                int length_in_nucleotides, char *dna_sequence, void *encoded_sequence);
+void biosal_dna_codec_word_decode(struct biosal_dna_codec *self,
+                int length_in_nucleotides, void *encoded_sequence, char *dna_sequence);
+void biosal_dna_codec_word_reverse_complement(struct biosal_dna_codec *self,
+                int length_in_nucleotides, void *encoded_sequence);
+
+/*
+ * Complement the bytes in [left, right) and reverse their order,
+ * including the order of the nucleotides inside each byte.
+ */
+void biosal_dna_codec_word_reverse_complement_bytes(uint8_t *bytes, int left, int right);
+
+/*
+ * Move all the nucleotides down by @padding positions (1 to 4).
+ * The nucleotides that come in at the end are A (0).
+ */
+void biosal_dna_codec_word_shift_down(uint8_t *bytes, int encoded_length, int padding);
+
+#endif
@@ -2,6 +2,7 @@
 #include "dna_kmer.h"
 
 #include "dna_codec.h"
+#include "dna_minimizer.h"
 
 #include <genomics/helpers/dna_helper.h>
 
@@ -223,7 +224,7 @@ uint64_t biosal_dna_kmer_hash(struct biosal_dna_kmer *self, int kmer_length,
     uint64_t hash;
 
     encoded_length = biosal_dna_codec_encoded_length(codec, kmer_length);
-    seed = 0xcaa9cfcf;
+    seed = BIOSAL_DNA_KMER_HASH_SEED;
 
     /*
      * comment this block
@@ -275,66 +276,21 @@ int biosal_dna_kmer_store_index_poor_locality(struct biosal_dna_kmer *self, int
     return store_index;
 }
 
+/*
+ * The store is selected with the minimizer of the k-mer: the lowest hash
+ * value of its canonical shingles (substrings of 19 nucleotides).
+ * Overlapping k-mers often have the same minimizer, so they end up in
+ * the same store.
+ */
 int biosal_dna_kmer_store_index_lsh(struct biosal_dna_kmer *self, int stores, int kmer_length,
                 struct biosal_dna_codec *codec, struct core_memory_pool *memory)
 {
-    uint64_t hash;
-    int store_index;
-    int i;
-    int w;
-    uint64_t minimal_hash_value;
-    struct biosal_dna_kmer shingle;
-    char *substring;
-    char *sequence;
-    char character;
-
-    sequence = core_memory_pool_allocate(memory, kmer_length + 1);
-
-    biosal_dna_kmer_get_sequence(self, sequence, kmer_length,
-        codec);
+    uint64_t minimizer;
 
-    /*
-     * Generate a sketch of shingles for the kmer, and
-     * select the one with the minimal hash value.
-     */
-    w = 19;
-
-    if (kmer_length < w) {
-        w = kmer_length - 3;
-    }
-
-    minimal_hash_value = 0;
-    minimal_hash_value--;
-
-    /*
-     * Generate shingles, hash them, and pick up the best one.
-     */
-    for (i = 0; i < kmer_length - w + 1; ++i) {
+    minimizer = biosal_dna_minimizer_get_kmer_minimizer(kmer_length, codec,
+                    self->encoded_data);
 
-        substring = sequence + i;
-        character = substring[w];
-        substring[w] = '\0';
-
-        biosal_dna_kmer_init(&shingle, substring, codec, memory);
-        substring[w] = character;
-
-        hash = biosal_dna_kmer_canonical_hash(&shingle, w, codec, memory);
-
-        biosal_dna_kmer_destroy(&shingle, memory);
-
-        if (hash < minimal_hash_value)
-            minimal_hash_value = hash;
-    }
-
-    core_memory_pool_free(memory, sequence);
-
-    /*
-     * Determine the store index using the hash of the shingle that has
-     * the minimal hash value.
-     */
-    store_index = minimal_hash_value % stores;
-
-    return store_index;
+    return minimizer % stores;
 }
 
 uint64_t biosal_dna_kmer_canonical_hash(struct biosal_dna_kmer *self, int kmer_length,
@@ -453,6 +409,12 @@ int biosal_dna_kmer_is_canonical(struct biosal_dna_kmer *self, int kmer_length,
     return biosal_dna_codec_is_canonical(codec, kmer_length, self->encoded_data);
 }
 
+int biosal_dna_kmer_is_palindrome(struct biosal_dna_kmer *self, int kmer_length,
+                struct biosal_dna_codec *codec)
+{
+    return biosal_dna_codec_is_palindrome(codec, kmer_length, self->encoded_data);
+}
+
 void biosal_dna_kmer_init_empty(struct biosal_dna_kmer *sequence)
 {
     sequence->encoded_data = NULL;
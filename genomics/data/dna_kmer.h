@@ -8,6 +8,11 @@
 
 #include <stdint.h>
 
+/*
+ * Seed of biosal_dna_kmer_hash.
+ */
+#define BIOSAL_DNA_KMER_HASH_SEED 0xcaa9cfcf
+
 struct biosal_dna_kmer {
     void *encoded_data;
 };
@@ -68,6 +73,8 @@ int biosal_dna_kmer_compare(struct biosal_dna_kmer *self, struct biosal_dna_kmer
                 struct biosal_dna_codec *codec);
 int biosal_dna_kmer_is_canonical(struct biosal_dna_kmer *self, int kmer_length,
                 struct biosal_dna_codec *codec);
+int biosal_dna_kmer_is_palindrome(struct biosal_dna_kmer *self, int kmer_length,
+                struct biosal_dna_codec *codec);
 
 int biosal_dna_kmer_equals(struct biosal_dna_kmer *self, struct biosal_dna_kmer *kmer,
                 int kmer_length, struct biosal_dna_codec *codec);
@@ -1,10 +1,9 @@
-
 #include "dna_kmer_block.h"
 
 #include "dna_kmer.h"
 
-#include <core/structures/vector_iterator.h>
 #include <core/system/packer.h>
+#include <core/system/memory.h>
 
 #include <core/system/debugger.h>
 
@@ -14,51 +13,215 @@
 #define BIOSAL_DNA_KMER_BLOCK_DEBUG
 */
 
+#define BIOSAL_DNA_KMER_BLOCK_MINIMUM_CAPACITY 16
+
+static void biosal_dna_kmer_block_reserve(struct biosal_dna_kmer_block *self, int capacity);
+static int biosal_dna_kmer_block_pack_unpack_header(struct biosal_dna_kmer_block *self, void *buffer,
+                int operation);
+static void biosal_dna_kmer_block_use_buffer(struct biosal_dna_kmer_block *self, void *buffer);
+
 void biosal_dna_kmer_block_init(struct biosal_dna_kmer_block *self, int kmer_length, int source_index, int kmers,
-                struct core_memory_pool *pool)
+                struct biosal_dna_codec *codec, struct core_memory_pool *pool)
 {
+    biosal_dna_kmer_block_init_empty(self);
+
     self->source_index = source_index;
     self->kmer_length = kmer_length;
-    core_vector_init(&self->kmers, sizeof(struct biosal_dna_kmer));
-
-    if (pool != NULL)
-        core_vector_set_memory_pool(&self->kmers, pool);
+    self->bytes_per_kmer = biosal_dna_codec_encoded_length(codec, kmer_length);
+    self->memory = pool;
+    self->owns_storage = 1;
 
     if (kmers > 0)
-        core_vector_reserve(&self->kmers, kmers);
+        biosal_dna_kmer_block_reserve(self, kmers);
+}
+
+void biosal_dna_kmer_block_init_empty(struct biosal_dna_kmer_block *self)
+{
+    self->source_index = -1;
+    self->kmer_length = -1;
+    self->bytes_per_kmer = 0;
+    self->size = 0;
+    self->capacity = 0;
+    self->kmers = NULL;
+    self->counts = NULL;
+    self->arcs = NULL;
+    self->has_counts = 0;
+    self->has_arcs = 0;
+    self->owns_storage = 0;
+    self->memory = NULL;
+}
+
+void biosal_dna_kmer_block_init_with_buffer(struct biosal_dna_kmer_block *self, void *buffer,
+                int kmer_length, int source_index, int kmers, int options,
+                struct biosal_dna_codec *codec)
+{
+    biosal_dna_kmer_block_init_empty(self);
+
+    self->kmer_length = kmer_length;
+    self->source_index = source_index;
+    self->bytes_per_kmer = biosal_dna_codec_encoded_length(codec, kmer_length);
+    self->has_counts = (options & BIOSAL_DNA_KMER_BLOCK_COUNTS) != 0;
+    self->has_arcs = (options & BIOSAL_DNA_KMER_BLOCK_ARCS) != 0;
+
+    /*
+     * Write the header with the final size, and then use the
+     * arrays in the buffer for the k-mers that will be added.
+     */
+    self->size = kmers;
+    biosal_dna_kmer_block_pack_unpack_header(self, buffer, CORE_PACKER_OPERATION_PACK);
+    biosal_dna_kmer_block_use_buffer(self, buffer);
+    self->size = 0;
+}
+
+int biosal_dna_kmer_block_get_packed_size(int kmer_length, int kmers, int options,
+                struct biosal_dna_codec *codec)
+{
+    struct biosal_dna_kmer_block block;
+
+    biosal_dna_kmer_block_init_empty(&block);
+
+    block.kmer_length = kmer_length;
+    block.bytes_per_kmer = biosal_dna_codec_encoded_length(codec, kmer_length);
+    block.size = kmers;
+    block.has_counts = (options & BIOSAL_DNA_KMER_BLOCK_COUNTS) != 0;
+    block.has_arcs = (options & BIOSAL_DNA_KMER_BLOCK_ARCS) != 0;
+
+    return biosal_dna_kmer_block_pack_size(&block, codec);
 }
 
 void biosal_dna_kmer_block_destroy(struct biosal_dna_kmer_block *self,
                 struct core_memory_pool *memory)
 {
-    struct core_vector_iterator iterator;
-    struct biosal_dna_kmer *kmer;
+    if (self->owns_storage) {
+        if (self->kmers != NULL) {
+            core_memory_pool_free(self->memory, self->kmers);
+        }
 
-    /* destroy kmers
-     */
-    core_vector_iterator_init(&iterator, &self->kmers);
+        if (self->counts != NULL) {
+            core_memory_pool_free(self->memory, self->counts);
+        }
 
-    while (core_vector_iterator_has_next(&iterator)) {
+        if (self->arcs != NULL) {
+            core_memory_pool_free(self->memory, self->arcs);
+        }
+    }
+
+    biosal_dna_kmer_block_init_empty(self);
+}
+
+void biosal_dna_kmer_block_enable_counts(struct biosal_dna_kmer_block *self)
+{
+    CORE_DEBUGGER_ASSERT(self->size == 0);
 
-        core_vector_iterator_next(&iterator, (void **)&kmer);
+    self->has_counts = 1;
 
-        biosal_dna_kmer_destroy(kmer, memory);
+    if (self->capacity > 0) {
+        self->counts = core_memory_pool_allocate(self->memory, self->capacity * sizeof(int));
     }
+}
 
-    core_vector_iterator_destroy(&iterator);
-    self->source_index = -1;
-    self->kmer_length = -1;
-    core_vector_destroy(&self->kmers);
+int biosal_dna_kmer_block_has_counts(struct biosal_dna_kmer_block *self)
+{
+    return self->has_counts;
+}
+
+void biosal_dna_kmer_block_enable_arcs(struct biosal_dna_kmer_block *self)
+{
+    CORE_DEBUGGER_ASSERT(self->size == 0);
+
+    self->has_arcs = 1;
+
+    if (self->capacity > 0) {
+        self->arcs = core_memory_pool_allocate(self->memory, self->capacity * sizeof(uint8_t));
+    }
+}
+
+int biosal_dna_kmer_block_has_arcs(struct biosal_dna_kmer_block *self)
+{
+    return self->has_arcs;
+}
+
+static void biosal_dna_kmer_block_reserve(struct biosal_dna_kmer_block *self, int capacity)
+{
+    char *kmers;
+    int *counts;
+    uint8_t *arcs;
+
+    CORE_DEBUGGER_ASSERT(self->owns_storage);
+
+    if (capacity <= self->capacity) {
+        return;
+    }
+
+    kmers = core_memory_pool_allocate(self->memory, (size_t)capacity * self->bytes_per_kmer);
+
+    if (self->kmers != NULL) {
+        core_memory_copy(kmers, self->kmers, (size_t)self->size * self->bytes_per_kmer);
+        core_memory_pool_free(self->memory, self->kmers);
+    }
+
+    self->kmers = kmers;
+
+    if (self->has_counts) {
+        counts = core_memory_pool_allocate(self->memory, capacity * sizeof(int));
+
+        if (self->counts != NULL) {
+            core_memory_copy(counts, self->counts, self->size * sizeof(int));
+            core_memory_pool_free(self->memory, self->counts);
+        }
+
+        self->counts = counts;
+    }
+
+    if (self->has_arcs) {
+        arcs = core_memory_pool_allocate(self->memory, capacity * sizeof(uint8_t));
+
+        if (self->arcs != NULL) {
+            core_memory_copy(arcs, self->arcs, self->size * sizeof(uint8_t));
+            core_memory_pool_free(self->memory, self->arcs);
+        }
+
+        self->arcs = arcs;
+    }
+
+    self->capacity = capacity;
 }
 
 void biosal_dna_kmer_block_add_kmer(struct biosal_dna_kmer_block *self, struct biosal_dna_kmer *kmer,
                 struct core_memory_pool *memory, struct biosal_dna_codec *codec)
 {
-    struct biosal_dna_kmer copy;
+    void *encoded_data;
+
+    encoded_data = biosal_dna_kmer_block_add_encoded_kmer(self, memory, codec);
+
+    core_memory_copy(encoded_data, kmer->encoded_data, self->bytes_per_kmer);
+}
+
+void *biosal_dna_kmer_block_add_encoded_kmer(struct biosal_dna_kmer_block *self,
+                struct core_memory_pool *memory, struct biosal_dna_codec *codec)
+{
+    int capacity;
+
+    if (self->size == self->capacity) {
+        capacity = self->capacity * 2;
+
+        if (capacity < BIOSAL_DNA_KMER_BLOCK_MINIMUM_CAPACITY)
+            capacity = BIOSAL_DNA_KMER_BLOCK_MINIMUM_CAPACITY;
+
+        biosal_dna_kmer_block_reserve(self, capacity);
+    }
 
-    biosal_dna_kmer_init_copy(&copy, kmer, self->kmer_length, memory, codec);
+    if (self->has_counts) {
+        self->counts[self->size] = 0;
+    }
+
+    if (self->has_arcs) {
+        self->arcs[self->size] = 0;
+    }
 
-    core_vector_push_back(&self->kmers, &copy);
+    ++self->size;
+
+    return self->kmers + (size_t)(self->size - 1) * self->bytes_per_kmer;
 }
 
 int biosal_dna_kmer_block_pack_size(struct biosal_dna_kmer_block *self, struct biosal_dna_codec *codec)
@@ -86,76 +249,112 @@ int biosal_dna_kmer_block_unpack(struct biosal_dna_kmer_block *self, void *buffe
 int biosal_dna_kmer_block_pack_unpack(struct biosal_dna_kmer_block *self, void *buffer,
                 int operation, struct core_memory_pool *memory, struct biosal_dna_codec *codec)
 {
-    struct core_packer packer;
     int offset;
-    int elements;
-    int i = 0;
-    struct biosal_dna_kmer *kmer;
-    struct biosal_dna_kmer new_kmer;
+    int counts_bytes;
+    int kmers_bytes;
+    int arcs_bytes;
 
-    core_packer_init(&packer, operation, buffer);
+    if (operation == CORE_PACKER_OPERATION_UNPACK) {
+        biosal_dna_kmer_block_init_empty(self);
+    }
+
+    offset = biosal_dna_kmer_block_pack_unpack_header(self, buffer, operation);
 
 #ifdef BIOSAL_DNA_KMER_BLOCK_DEBUG
-    BIOSAL_DEBUG_MARKER("pack unpack 1");
+    printf("DEBUG kmer_length %d source_index %d elements %d\n", self->kmer_length,
+                    self->source_index, self->size);
 #endif
 
-    core_packer_process(&packer, &self->kmer_length, sizeof(self->kmer_length));
-    core_packer_process(&packer, &self->source_index, sizeof(self->source_index));
+    counts_bytes = 0;
 
-    if (operation != CORE_PACKER_OPERATION_UNPACK) {
-        elements = core_vector_size(&self->kmers);
+    if (self->has_counts) {
+        counts_bytes = self->size * sizeof(int);
     }
 
-#ifdef BIOSAL_DNA_KMER_BLOCK_DEBUG
-    BIOSAL_DEBUG_MARKER("pack unpack 2");
-#endif
+    kmers_bytes = self->size * self->bytes_per_kmer;
+
+    arcs_bytes = 0;
 
-    core_packer_process(&packer, &elements, sizeof(elements));
+    if (self->has_arcs) {
+        arcs_bytes = self->size * sizeof(uint8_t);
+    }
 
+    /*
+     * The arrays are not copied when unpacking.
+     * Instead, the block uses the buffer directly.
+     */
     if (operation == CORE_PACKER_OPERATION_UNPACK) {
 
-        biosal_dna_kmer_block_init(self, self->kmer_length, self->source_index, elements, memory);
+        biosal_dna_kmer_block_use_buffer(self, buffer);
+        self->memory = memory;
+
+    } else if (operation == CORE_PACKER_OPERATION_PACK) {
+
+        if (counts_bytes > 0) {
+            core_memory_copy((char *)buffer + offset, self->counts, counts_bytes);
+        }
+
+        if (kmers_bytes > 0) {
+            core_memory_copy((char *)buffer + offset + counts_bytes, self->kmers, kmers_bytes);
+        }
+
+        if (arcs_bytes > 0) {
+            core_memory_copy((char *)buffer + offset + counts_bytes + kmers_bytes,
+                            self->arcs, arcs_bytes);
+        }
     }
 
-#ifdef BIOSAL_DNA_KMER_BLOCK_DEBUG
-    printf("DEBUG kmer_length %d source_index %d elements %d\n", self->kmer_length,
-                    self->source_index, elements);
-#endif
+    offset += counts_bytes + kmers_bytes + arcs_bytes;
 
-    offset = core_packer_get_byte_count(&packer);
-    core_packer_destroy(&packer);
+    return offset;
+}
 
-    /* do the rest manually
-     */
+static int biosal_dna_kmer_block_pack_unpack_header(struct biosal_dna_kmer_block *self, void *buffer,
+                int operation)
+{
+    struct core_packer packer;
+    int offset;
 
-#ifdef BIOSAL_DNA_KMER_BLOCK_DEBUG
-    BIOSAL_DEBUG_MARKER("pack unpack 3");
-#endif
+    core_packer_init(&packer, operation, buffer);
 
-    if (operation == CORE_PACKER_OPERATION_UNPACK) {
+    core_packer_process(&packer, &self->kmer_length, sizeof(self->kmer_length));
+    core_packer_process(&packer, &self->source_index, sizeof(self->source_index));
+    core_packer_process(&packer, &self->size, sizeof(self->size));
+    core_packer_process(&packer, &self->bytes_per_kmer, sizeof(self->bytes_per_kmer));
+    core_packer_process(&packer, &self->has_counts, sizeof(self->has_counts));
+    core_packer_process(&packer, &self->has_arcs, sizeof(self->has_arcs));
 
-        for (i = 0; i < elements; i++) {
-            offset += biosal_dna_kmer_pack_unpack(&new_kmer, (char *)buffer + offset, operation,
-                            self->kmer_length, memory, codec);
+    offset = core_packer_get_byte_count(&packer);
+    core_packer_destroy(&packer);
 
-            biosal_dna_kmer_block_add_kmer(self, &new_kmer, memory, codec);
+    return offset;
+}
 
-            biosal_dna_kmer_destroy(&new_kmer, memory);
-        }
-    } else {
-        for (i = 0; i < elements; i++) {
-            kmer = (struct biosal_dna_kmer *)core_vector_at(&self->kmers, i);
+/*
+ * Point the arrays of the block to a packed buffer.
+ */
+static void biosal_dna_kmer_block_use_buffer(struct biosal_dna_kmer_block *self, void *buffer)
+{
+    int offset;
 
-            offset += biosal_dna_kmer_pack_unpack(kmer, (char *)buffer + offset, operation,
-                            self->kmer_length, memory, codec);
-        }
+    offset = biosal_dna_kmer_block_pack_unpack_header(self, NULL, CORE_PACKER_OPERATION_PACK_SIZE);
+
+    self->capacity = self->size;
+    self->owns_storage = 0;
+    self->counts = NULL;
+    self->arcs = NULL;
+
+    if (self->has_counts) {
+        self->counts = (int *)((char *)buffer + offset);
+        offset += self->size * sizeof(int);
     }
 
-#ifdef BIOSAL_DNA_KMER_BLOCK_DEBUG
-    BIOSAL_DEBUG_MARKER("pack unpack EXIT");
-#endif
+    self->kmers = (char *)buffer + offset;
+    offset += self->size * self->bytes_per_kmer;
 
-    return offset;
+    if (self->has_arcs) {
+        self->arcs = (uint8_t *)buffer + offset;
+    }
 }
 
 int biosal_dna_kmer_block_source_index(struct biosal_dna_kmer_block *self)
@@ -163,17 +362,58 @@ int biosal_dna_kmer_block_source_index(struct biosal_dna_kmer_block *self)
     return self->source_index;
 }
 
-struct core_vector *biosal_dna_kmer_block_kmers(struct biosal_dna_kmer_block *self)
+void biosal_dna_kmer_block_get_kmer(struct biosal_dna_kmer_block *self, int index,
+                struct biosal_dna_kmer *kmer)
 {
-    return &self->kmers;
+    kmer->encoded_data = biosal_dna_kmer_block_get_encoded_kmer(self, index);
 }
 
-int biosal_dna_kmer_block_size(struct biosal_dna_kmer_block *self)
+void *biosal_dna_kmer_block_get_encoded_kmer(struct biosal_dna_kmer_block *self, int index)
 {
-    return core_vector_size(&self->kmers);
+    CORE_DEBUGGER_ASSERT(index >= 0 && index < self->size);
+
+    return self->kmers + (size_t)index * self->bytes_per_kmer;
 }
 
-void biosal_dna_kmer_block_init_empty(struct biosal_dna_kmer_block *self)
+int biosal_dna_kmer_block_get_count(struct biosal_dna_kmer_block *self, int index)
+{
+    CORE_DEBUGGER_ASSERT(index >= 0 && index < self->size);
+
+    if (!self->has_counts) {
+        return 1;
+    }
+
+    return self->counts[index];
+}
+
+void biosal_dna_kmer_block_set_count(struct biosal_dna_kmer_block *self, int index, int count)
+{
+    CORE_DEBUGGER_ASSERT(self->has_counts);
+    CORE_DEBUGGER_ASSERT(index >= 0 && index < self->size);
+
+    self->counts[index] = count;
+}
+
+int biosal_dna_kmer_block_get_arcs(struct biosal_dna_kmer_block *self, int index)
+{
+    CORE_DEBUGGER_ASSERT(index >= 0 && index < self->size);
+
+    if (!self->has_arcs) {
+        return 0;
+    }
+
+    return self->arcs[index];
+}
+
+void biosal_dna_kmer_block_set_arcs(struct biosal_dna_kmer_block *self, int index, int arcs)
+{
+    CORE_DEBUGGER_ASSERT(self->has_arcs);
+    CORE_DEBUGGER_ASSERT(index >= 0 && index < self->size);
+
+    self->arcs[index] = arcs;
+}
+
+int biosal_dna_kmer_block_size(struct biosal_dna_kmer_block *self)
 {
-    biosal_dna_kmer_block_init(self, -1, -1, -1, NULL);
+    return self->size;
 }
@@ -2,30 +2,92 @@
 #ifndef BIOSAL_DNA_KMER_BLOCK
 #define BIOSAL_DNA_KMER_BLOCK
 
-#include <core/structures/vector.h>
-
 #include <genomics/data/dna_codec.h>
 
 #include <core/system/memory_pool.h>
 
+#include <stdint.h>
+
 struct biosal_dna_kmer;
 
+/*
+ * Options for biosal_dna_kmer_block_init_with_buffer.
+ */
+#define BIOSAL_DNA_KMER_BLOCK_COUNTS 1
+#define BIOSAL_DNA_KMER_BLOCK_ARCS 2
+
+/*
+ * A block of k-mers.
+ *
+ * The encoded k-mers are stored contiguously in one arena of
+ * size * bytes_per_kmer bytes. A parallel array of counts can be
+ * enabled too, and so can a parallel array of arcs (one byte per k-mer
+ * with the bitmap of a biosal_assembly_connectivity).
+ *
+ * The packed form is the same as the in-memory form:
+ *
+ * [kmer_length][source_index][size][bytes_per_kmer][has_counts][has_arcs][counts][kmers][arcs]
+ *
+ * so packing is a memory copy and unpacking only points the block
+ * to the buffer (the block does not own the buffer in that case).
+ */
 struct biosal_dna_kmer_block {
 
     int source_index;
     int kmer_length;
+    int bytes_per_kmer;
 
-    struct core_vector kmers;
+    int size;
+    int capacity;
+    char *kmers;
+    int *counts;
+    uint8_t *arcs;
+
+    int has_counts;
+    int has_arcs;
+    int owns_storage;
+    struct core_memory_pool *memory;
 };
 
 void biosal_dna_kmer_block_init(struct biosal_dna_kmer_block *self, int kmer_length,
-                int source_index, int kmers, struct core_memory_pool *pool);
+                int source_index, int kmers, struct biosal_dna_codec *codec,
+                struct core_memory_pool *pool);
 void biosal_dna_kmer_block_init_empty(struct biosal_dna_kmer_block *self);
 
+/*
+ * Use a buffer of biosal_dna_kmer_block_get_packed_size bytes as the storage
+ * of the block. The block can hold exactly @kmers k-mers, and once they are all
+ * added the buffer is a packed block (for example the buffer of a message).
+ */
+void biosal_dna_kmer_block_init_with_buffer(struct biosal_dna_kmer_block *self, void *buffer,
+                int kmer_length, int source_index, int kmers, int options,
+                struct biosal_dna_codec *codec);
+int biosal_dna_kmer_block_get_packed_size(int kmer_length, int kmers, int options,
+                struct biosal_dna_codec *codec);
+
 void biosal_dna_kmer_block_destroy(struct biosal_dna_kmer_block *self, struct core_memory_pool *memory);
 void biosal_dna_kmer_block_add_kmer(struct biosal_dna_kmer_block *self, struct biosal_dna_kmer *kmer,
                 struct core_memory_pool *memory, struct biosal_dna_codec *codec);
 
+/*
+ * Add a k-mer to the block and return its encoded storage
+ * so that the caller can write the encoded k-mer in place.
+ */
+void *biosal_dna_kmer_block_add_encoded_kmer(struct biosal_dna_kmer_block *self,
+                struct core_memory_pool *memory, struct biosal_dna_codec *codec);
+
+/*
+ * Enable the array of counts. This must be called before adding k-mers.
+ */
+void biosal_dna_kmer_block_enable_counts(struct biosal_dna_kmer_block *self);
+int biosal_dna_kmer_block_has_counts(struct biosal_dna_kmer_block *self);
+
+/*
+ * Enable the array of arcs. This must be called before adding k-mers.
+ */
+void biosal_dna_kmer_block_enable_arcs(struct biosal_dna_kmer_block *self);
+int biosal_dna_kmer_block_has_arcs(struct biosal_dna_kmer_block *self);
+
 int biosal_dna_kmer_block_pack_size(struct biosal_dna_kmer_block *self, struct biosal_dna_codec *codec);
 int biosal_dna_kmer_block_pack(struct biosal_dna_kmer_block *self, void *buffer, struct biosal_dna_codec *codec);
 int biosal_dna_kmer_block_unpack(struct biosal_dna_kmer_block *self, void *buffer, struct core_memory_pool *memory,
@@ -36,7 +98,18 @@ int biosal_dna_kmer_block_pack_unpack(struct biosal_dna_kmer_block *self, void *
                 struct biosal_dna_codec *codec);
 
 int biosal_dna_kmer_block_source_index(struct biosal_dna_kmer_block *self);
-struct core_vector *biosal_dna_kmer_block_kmers(struct biosal_dna_kmer_block *self);
+
+/*
+ * Get a view on a k-mer of the block. The k-mer points inside the
+ * block and must not be destroyed.
+ */
+void biosal_dna_kmer_block_get_kmer(struct biosal_dna_kmer_block *self, int index,
+                struct biosal_dna_kmer *kmer);
+void *biosal_dna_kmer_block_get_encoded_kmer(struct biosal_dna_kmer_block *self, int index);
+int biosal_dna_kmer_block_get_count(struct biosal_dna_kmer_block *self, int index);
+void biosal_dna_kmer_block_set_count(struct biosal_dna_kmer_block *self, int index, int count);
+int biosal_dna_kmer_block_get_arcs(struct biosal_dna_kmer_block *self, int index);
+void biosal_dna_kmer_block_set_arcs(struct biosal_dna_kmer_block *self, int index, int arcs);
 
 int biosal_dna_kmer_block_size(struct biosal_dna_kmer_block *self);
 
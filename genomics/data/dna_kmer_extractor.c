@@ -0,0 +1,304 @@
+
+#include "dna_kmer_extractor.h"
+
+#include "dna_codec.h"
+#include "dna_sequence.h"
+
+#include <core/system/memory_pool.h>
+#include <core/system/debugger.h>
+
+#include <string.h>
+
+#define BITS_PER_NUCLEOTIDE 2
+#define NUCLEOTIDES_PER_WORD 32
+#define BITS_PER_WORD 64
+#define BYTES_PER_WORD 8
+#define BITS_PER_BYTE 8
+
+#define NUCLEOTIDE_MASK ((uint64_t)3)
+
+static char biosal_dna_kmer_extractor_symbols[] = {
+    BIOSAL_NUCLEOTIDE_SYMBOL_A,
+    BIOSAL_NUCLEOTIDE_SYMBOL_C,
+    BIOSAL_NUCLEOTIDE_SYMBOL_G,
+    BIOSAL_NUCLEOTIDE_SYMBOL_T
+};
+
+static inline uint64_t biosal_dna_kmer_extractor_get_code(struct biosal_dna_kmer_extractor *self,
+                int position);
+static inline void biosal_dna_kmer_extractor_push(struct biosal_dna_kmer_extractor *self,
+                uint64_t code);
+static void biosal_dna_kmer_extractor_write(struct biosal_dna_kmer_extractor *self,
+                uint64_t *words, void *encoded_data);
+static inline int biosal_dna_kmer_extractor_lowest_bit(uint64_t value);
+
+void biosal_dna_kmer_extractor_init(struct biosal_dna_kmer_extractor *self,
+                int kmer_length, struct biosal_dna_codec *codec,
+                struct core_memory_pool *memory)
+{
+    int bits;
+
+    CORE_DEBUGGER_ASSERT(kmer_length > 0);
+
+    self->codec = codec;
+    self->memory = memory;
+    self->kmer_length = kmer_length;
+    self->encoded_length = biosal_dna_codec_encoded_length(codec, kmer_length);
+
+    /*
+     * The words must cover the padding of the codec too, which is at
+     * least one nucleotide wide.
+     */
+    self->words = (kmer_length + NUCLEOTIDES_PER_WORD - 1) / NUCLEOTIDES_PER_WORD;
+
+    if (self->words * BYTES_PER_WORD < self->encoded_length
+                    && codec->use_two_bit_encoding) {
+        ++self->words;
+    }
+
+    self->forward = core_memory_pool_allocate(memory, 2 * self->words * sizeof(uint64_t));
+    self->reverse = self->forward + self->words;
+
+    bits = ((kmer_length - 1) % NUCLEOTIDES_PER_WORD) * BITS_PER_NUCLEOTIDE;
+    self->last_shift = bits;
+
+    /*
+     * Keep the bits up to (and including) the last nucleotide.
+     */
+    self->last_mask = 0;
+    --self->last_mask;
+
+    if (bits + BITS_PER_NUCLEOTIDE < BITS_PER_WORD) {
+        self->last_mask >>= (BITS_PER_WORD - bits - BITS_PER_NUCLEOTIDE);
+    }
+
+    biosal_dna_kmer_extractor_set_encoded_sequence(self, 0, NULL);
+}
+
+void biosal_dna_kmer_extractor_destroy(struct biosal_dna_kmer_extractor *self)
+{
+    core_memory_pool_free(self->memory, self->forward);
+
+    self->forward = NULL;
+    self->reverse = NULL;
+    self->codec = NULL;
+    self->memory = NULL;
+    self->kmer_length = -1;
+    self->words = 0;
+}
+
+void biosal_dna_kmer_extractor_set_sequence(struct biosal_dna_kmer_extractor *self,
+                struct biosal_dna_sequence *sequence)
+{
+    biosal_dna_kmer_extractor_set_encoded_sequence(self,
+                    biosal_dna_sequence_length(sequence), sequence->encoded_data);
+}
+
+void biosal_dna_kmer_extractor_set_encoded_sequence(struct biosal_dna_kmer_extractor *self,
+                int length_in_nucleotides, void *encoded_sequence)
+{
+    self->sequence_data = encoded_sequence;
+    self->sequence_length = length_in_nucleotides;
+    self->position = 0;
+    self->valid_length = 0;
+
+    memset(self->forward, 0, 2 * self->words * sizeof(uint64_t));
+}
+
+int biosal_dna_kmer_extractor_next(struct biosal_dna_kmer_extractor *self)
+{
+    while (self->position < self->sequence_length) {
+
+        biosal_dna_kmer_extractor_push(self,
+                        biosal_dna_kmer_extractor_get_code(self, self->position));
+
+        ++self->position;
+        ++self->valid_length;
+
+        if (self->valid_length >= self->kmer_length) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+int biosal_dna_kmer_extractor_count(struct biosal_dna_kmer_extractor *self,
+                int length_in_nucleotides)
+{
+    if (length_in_nucleotides < self->kmer_length) {
+        return 0;
+    }
+
+    return length_in_nucleotides - self->kmer_length + 1;
+}
+
+static inline uint64_t biosal_dna_kmer_extractor_get_code(struct biosal_dna_kmer_extractor *self,
+                int position)
+{
+    uint8_t byte;
+
+    if (self->codec->use_two_bit_encoding) {
+        byte = ((uint8_t *)self->sequence_data)[position >> 2];
+
+        return (byte >> ((position & 3) * BITS_PER_NUCLEOTIDE)) & NUCLEOTIDE_MASK;
+    }
+
+    return biosal_dna_codec_get_code(((char *)self->sequence_data)[position]);
+}
+
+/*
+ * The forward k-mer drops its first nucleotide (the lowest bits) and
+ * receives the new one at position k - 1. The reverse complement receives
+ * the complement of the new nucleotide at position 0 and drops the
+ * nucleotide that goes beyond position k - 1.
+ */
+static inline void biosal_dna_kmer_extractor_push(struct biosal_dna_kmer_extractor *self,
+                uint64_t code)
+{
+    int i;
+    int last;
+    uint64_t *forward;
+    uint64_t *reverse;
+
+    forward = self->forward;
+    reverse = self->reverse;
+    last = (self->kmer_length - 1) / NUCLEOTIDES_PER_WORD;
+
+    /*
+     * Fast path for k <= 32.
+     */
+    if (last == 0) {
+        forward[0] = (forward[0] >> BITS_PER_NUCLEOTIDE) | (code << self->last_shift);
+        reverse[0] = ((reverse[0] << BITS_PER_NUCLEOTIDE) | (NUCLEOTIDE_MASK ^ code))
+                & self->last_mask;
+        return;
+    }
+
+    for (i = 0; i < last; ++i) {
+        forward[i] = (forward[i] >> BITS_PER_NUCLEOTIDE)
+                | (forward[i + 1] << (BITS_PER_WORD - BITS_PER_NUCLEOTIDE));
+    }
+
+    forward[last] = (forward[last] >> BITS_PER_NUCLEOTIDE) | (code << self->last_shift);
+
+    for (i = last; i > 0; --i) {
+        reverse[i] = (reverse[i] << BITS_PER_NUCLEOTIDE)
+                | (reverse[i - 1] >> (BITS_PER_WORD - BITS_PER_NUCLEOTIDE));
+    }
+
+    reverse[last] &= self->last_mask;
+    reverse[0] = (reverse[0] << BITS_PER_NUCLEOTIDE) | (NUCLEOTIDE_MASK ^ code);
+}
+
+static inline int biosal_dna_kmer_extractor_lowest_bit(uint64_t value)
+{
+#if defined(__GNUC__)
+    return __builtin_ctzll(value);
+#else
+    int bit;
+
+    bit = 0;
+
+    while (!(value & 1)) {
+        value >>= 1;
+        ++bit;
+    }
+
+    return bit;
+#endif
+}
+
+/*
+ * This is the same order as biosal_dna_codec_is_canonical: the k-mer is
+ * canonical if it is lower than or equal to its reverse complement when
+ * comparing nucleotides from the first one.
+ */
+int biosal_dna_kmer_extractor_is_canonical(struct biosal_dna_kmer_extractor *self)
+{
+    int i;
+    int bit;
+    uint64_t difference;
+
+    for (i = 0; i < self->words; ++i) {
+
+        difference = self->forward[i] ^ self->reverse[i];
+
+        if (difference == 0) {
+            continue;
+        }
+
+        bit = biosal_dna_kmer_extractor_lowest_bit(difference) & ~1;
+
+        return ((self->forward[i] >> bit) & NUCLEOTIDE_MASK)
+                < ((self->reverse[i] >> bit) & NUCLEOTIDE_MASK);
+    }
+
+    return 1;
+}
+
+int biosal_dna_kmer_extractor_is_palindrome(struct biosal_dna_kmer_extractor *self)
+{
+    int i;
+
+    for (i = 0; i < self->words; ++i) {
+
+        if (self->forward[i] != self->reverse[i]) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+void biosal_dna_kmer_extractor_get_kmer(struct biosal_dna_kmer_extractor *self,
+                void *encoded_data)
+{
+    biosal_dna_kmer_extractor_write(self, self->forward, encoded_data);
+}
+
+void biosal_dna_kmer_extractor_get_canonical_kmer(struct biosal_dna_kmer_extractor *self,
+                void *encoded_data)
+{
+    if (biosal_dna_kmer_extractor_is_canonical(self)) {
+        biosal_dna_kmer_extractor_write(self, self->forward, encoded_data);
+    } else {
+        biosal_dna_kmer_extractor_write(self, self->reverse, encoded_data);
+    }
+}
+
+int biosal_dna_kmer_extractor_encoded_length(struct biosal_dna_kmer_extractor *self)
+{
+    return self->encoded_length;
+}
+
+static void biosal_dna_kmer_extractor_write(struct biosal_dna_kmer_extractor *self,
+                uint64_t *words, void *encoded_data)
+{
+    int i;
+    uint8_t *bytes;
+    char *symbols;
+
+    /*
+     * The bytes are written one by one so that the result is the same
+     * on big endian systems (Blue Gene/Q for instance).
+     */
+    if (self->codec->use_two_bit_encoding) {
+        bytes = encoded_data;
+
+        for (i = 0; i < self->encoded_length; ++i) {
+            bytes[i] = (uint8_t)(words[i / BYTES_PER_WORD] >> ((i % BYTES_PER_WORD) * BITS_PER_BYTE));
+        }
+
+        return;
+    }
+
+    symbols = encoded_data;
+
+    for (i = 0; i < self->kmer_length; ++i) {
+        symbols[i] = biosal_dna_kmer_extractor_symbols[(words[i / NUCLEOTIDES_PER_WORD]
+                        >> ((i % NUCLEOTIDES_PER_WORD) * BITS_PER_NUCLEOTIDE)) & NUCLEOTIDE_MASK];
+    }
+
+    symbols[self->kmer_length] = '\0';
+}
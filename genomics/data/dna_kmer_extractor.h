@@ -0,0 +1,91 @@
+
+#ifndef BIOSAL_DNA_KMER_EXTRACTOR_H
+#define BIOSAL_DNA_KMER_EXTRACTOR_H
+
+#include <stdint.h>
+
+struct biosal_dna_codec;
+struct biosal_dna_sequence;
+struct core_memory_pool;
+
+/*
+ * A streaming k-mer extractor.
+ *
+ * The extractor reads an encoded DNA sequence (2-bit or not) and
+ * keeps the current k-mer and its reverse complement in 64-bit words
+ * using the same layout as the 2-bit codec (nucleotide i is stored
+ * at bit 2 * i). Each call to biosal_dna_kmer_extractor_next shifts in
+ * one nucleotide, so extraction is O(n) for a sequence of length n
+ * instead of O(n * k), and no memory is allocated per k-mer.
+ *
+ * The k-mer can then be written directly, in the format of the codec,
+ * into caller-provided storage (for example a biosal_dna_kmer_block).
+ */
+struct biosal_dna_kmer_extractor {
+    struct biosal_dna_codec *codec;
+    struct core_memory_pool *memory;
+    int kmer_length;
+    int encoded_length;
+    int words;
+
+    uint64_t *forward;
+    uint64_t *reverse;
+
+    /*
+     * Position of the last nucleotide of the k-mer in the
+     * last word, and mask for the bits of the last word.
+     */
+    int last_shift;
+    uint64_t last_mask;
+
+    void *sequence_data;
+    int sequence_length;
+    int position;
+    int valid_length;
+};
+
+void biosal_dna_kmer_extractor_init(struct biosal_dna_kmer_extractor *self,
+                int kmer_length, struct biosal_dna_codec *codec,
+                struct core_memory_pool *memory);
+void biosal_dna_kmer_extractor_destroy(struct biosal_dna_kmer_extractor *self);
+
+/*
+ * Start the extraction for a new sequence.
+ */
+void biosal_dna_kmer_extractor_set_sequence(struct biosal_dna_kmer_extractor *self,
+                struct biosal_dna_sequence *sequence);
+void biosal_dna_kmer_extractor_set_encoded_sequence(struct biosal_dna_kmer_extractor *self,
+                int length_in_nucleotides, void *encoded_sequence);
+
+/*
+ * Advance to the next k-mer.
+ *
+ * @return 1 if a k-mer is available, 0 at the end of the sequence
+ */
+int biosal_dna_kmer_extractor_next(struct biosal_dna_kmer_extractor *self);
+
+/*
+ * @return the number of k-mers in a sequence
+ */
+int biosal_dna_kmer_extractor_count(struct biosal_dna_kmer_extractor *self,
+                int length_in_nucleotides);
+
+int biosal_dna_kmer_extractor_is_canonical(struct biosal_dna_kmer_extractor *self);
+
+/*
+ * @return 1 if the k-mer is its own reverse complement
+ */
+int biosal_dna_kmer_extractor_is_palindrome(struct biosal_dna_kmer_extractor *self);
+
+/*
+ * Write the current k-mer (or its canonical form) in the format of the codec.
+ * The buffer must have room for biosal_dna_kmer_extractor_encoded_length bytes.
+ */
+void biosal_dna_kmer_extractor_get_kmer(struct biosal_dna_kmer_extractor *self,
+                void *encoded_data);
+void biosal_dna_kmer_extractor_get_canonical_kmer(struct biosal_dna_kmer_extractor *self,
+                void *encoded_data);
+
+int biosal_dna_kmer_extractor_encoded_length(struct biosal_dna_kmer_extractor *self);
+
+#endif
@@ -2,11 +2,23 @@
 #include "dna_kmer_frequency_block.h"
 
 #include "dna_kmer.h"
+#include "dna_kmer_block.h"
+
+#include <core/structures/map_iterator.h>
 
 #include <core/system/packer.h>
+#include <core/system/memory.h>
+
+#include <core/system/debugger.h>
 
 #include <stdio.h>
 
+/*
+ * With arcs, a value is [count][arcs].
+ */
+#define BIOSAL_DNA_KMER_FREQUENCY_BLOCK_COUNT 0
+#define BIOSAL_DNA_KMER_FREQUENCY_BLOCK_ARCS 1
+
 void biosal_dna_kmer_frequency_block_init(struct biosal_dna_kmer_frequency_block *self, int kmer_length,
                 struct core_memory_pool *memory, struct biosal_dna_codec *codec,
                 int estimated_kmer_count)
@@ -23,6 +35,7 @@ void biosal_dna_kmer_frequency_block_init(struct biosal_dna_kmer_frequency_block
     core_map_set_memory_pool(&self->kmers, memory);
 
     self->kmer_length = kmer_length;
+    self->has_arcs = 0;
 }
 
 void biosal_dna_kmer_frequency_block_destroy(struct biosal_dna_kmer_frequency_block *self, struct core_memory_pool *memory)
@@ -30,8 +43,36 @@ void biosal_dna_kmer_frequency_block_destroy(struct biosal_dna_kmer_frequency_bl
     core_map_destroy(&self->kmers);
 }
 
+void biosal_dna_kmer_frequency_block_enable_arcs(struct biosal_dna_kmer_frequency_block *self)
+{
+    struct core_memory_pool *memory;
+    int key_size;
+
+    CORE_DEBUGGER_ASSERT(core_map_empty(&self->kmers));
+
+    if (self->has_arcs) {
+        return;
+    }
+
+    memory = core_map_memory_pool(&self->kmers);
+    key_size = core_map_get_key_size(&self->kmers);
+
+    core_map_destroy(&self->kmers);
+    core_map_init(&self->kmers, key_size, 2 * sizeof(int));
+    core_map_set_memory_pool(&self->kmers, memory);
+
+    self->has_arcs = 1;
+}
+
 void biosal_dna_kmer_frequency_block_add_kmer(struct biosal_dna_kmer_frequency_block *self, struct biosal_dna_kmer *kmer,
                 struct core_memory_pool *memory, struct biosal_dna_codec *codec)
+{
+    biosal_dna_kmer_frequency_block_add_kmer_with_arcs(self, kmer, 0, memory, codec);
+}
+
+void biosal_dna_kmer_frequency_block_add_kmer_with_arcs(struct biosal_dna_kmer_frequency_block *self,
+                struct biosal_dna_kmer *kmer, int arcs,
+                struct core_memory_pool *memory, struct biosal_dna_codec *codec)
 {
     void *encoded_kmer;
     int size;
@@ -48,10 +89,18 @@ void biosal_dna_kmer_frequency_block_add_kmer(struct biosal_dna_kmer_frequency_b
     if (bucket == NULL) {
 
         bucket = (int *)core_map_add(&self->kmers, encoded_kmer);
-        (*bucket) = 0;
+        bucket[BIOSAL_DNA_KMER_FREQUENCY_BLOCK_COUNT] = 0;
+
+        if (self->has_arcs) {
+            bucket[BIOSAL_DNA_KMER_FREQUENCY_BLOCK_ARCS] = 0;
+        }
     }
 
-    ++(*bucket);
+    ++bucket[BIOSAL_DNA_KMER_FREQUENCY_BLOCK_COUNT];
+
+    if (self->has_arcs) {
+        bucket[BIOSAL_DNA_KMER_FREQUENCY_BLOCK_ARCS] |= arcs;
+    }
 
     core_memory_pool_free(memory, encoded_kmer);
 }
@@ -78,24 +127,98 @@ int biosal_dna_kmer_frequency_block_unpack(struct biosal_dna_kmer_frequency_bloc
                     memory, codec);
 }
 
+/*
+ * The packed form is a biosal_dna_kmer_block with counts, so that
+ * receivers can read k-mers and counts without building a map.
+ */
 int biosal_dna_kmer_frequency_block_pack_unpack(struct biosal_dna_kmer_frequency_block *self, void *buffer,
                 int operation, struct core_memory_pool *memory,
                 struct biosal_dna_codec *codec)
 {
     int bytes;
-    struct core_packer packer;
+    int i;
+    int size;
+    int key_size;
+    int *frequency;
+    int *bucket;
+    int options;
+    void *key;
+    void *encoded_kmer;
+    struct biosal_dna_kmer_block block;
+    struct core_map_iterator iterator;
+
+    options = BIOSAL_DNA_KMER_BLOCK_COUNTS;
+
+    if (self->has_arcs) {
+        options |= BIOSAL_DNA_KMER_BLOCK_ARCS;
+    }
+
+    if (operation == CORE_PACKER_OPERATION_PACK_SIZE) {
+        return biosal_dna_kmer_block_get_packed_size(self->kmer_length,
+                        core_map_size(&self->kmers), options, codec);
+    }
+
+    key_size = core_map_get_key_size(&self->kmers);
+
+    if (operation == CORE_PACKER_OPERATION_PACK) {
+
+        size = core_map_size(&self->kmers);
+
+        biosal_dna_kmer_block_init_with_buffer(&block, buffer, self->kmer_length, -1,
+                        size, options, codec);
+
+        core_map_iterator_init(&iterator, &self->kmers);
 
-    core_packer_init(&packer, operation, buffer);
+        i = 0;
+        while (core_map_iterator_next(&iterator, &key, (void **)&frequency)) {
 
-    bytes = 0;
+            encoded_kmer = biosal_dna_kmer_block_add_encoded_kmer(&block, NULL, codec);
+            core_memory_copy(encoded_kmer, key, key_size);
+            biosal_dna_kmer_block_set_count(&block, i,
+                            frequency[BIOSAL_DNA_KMER_FREQUENCY_BLOCK_COUNT]);
 
-    core_packer_process(&packer, &self->kmer_length, sizeof(self->kmer_length));
+            if (self->has_arcs) {
+                biosal_dna_kmer_block_set_arcs(&block, i,
+                                frequency[BIOSAL_DNA_KMER_FREQUENCY_BLOCK_ARCS]);
+            }
 
-    bytes += core_packer_get_byte_count(&packer);
+            ++i;
+        }
+
+        core_map_iterator_destroy(&iterator);
+
+    } else {
+
+        biosal_dna_kmer_block_unpack(&block, buffer, memory, codec);
+
+        self->kmer_length = block.kmer_length;
+        size = biosal_dna_kmer_block_size(&block);
+
+        for (i = 0; i < size; ++i) {
+
+            key = biosal_dna_kmer_block_get_encoded_kmer(&block, i);
+            bucket = (int *)core_map_get(&self->kmers, key);
+
+            if (bucket == NULL) {
+                bucket = (int *)core_map_add(&self->kmers, key);
+                bucket[BIOSAL_DNA_KMER_FREQUENCY_BLOCK_COUNT] = 0;
+
+                if (self->has_arcs) {
+                    bucket[BIOSAL_DNA_KMER_FREQUENCY_BLOCK_ARCS] = 0;
+                }
+            }
+
+            bucket[BIOSAL_DNA_KMER_FREQUENCY_BLOCK_COUNT] += biosal_dna_kmer_block_get_count(&block, i);
+
+            if (self->has_arcs) {
+                bucket[BIOSAL_DNA_KMER_FREQUENCY_BLOCK_ARCS] |= biosal_dna_kmer_block_get_arcs(&block, i);
+            }
+        }
+    }
 
-    bytes += core_map_pack_unpack(&self->kmers, operation, ((char *) buffer) + bytes);
+    bytes = biosal_dna_kmer_block_pack_size(&block, codec);
 
-    core_packer_destroy(&packer);
+    biosal_dna_kmer_block_destroy(&block, memory);
 
 #if 0
     printf("packed %d\n", bytes);
@@ -10,9 +10,17 @@
 
 struct biosal_dna_kmer;
 
+/*
+ * A map from k-mers to counts.
+ *
+ * With arcs enabled, each k-mer also has the bitmap of its
+ * arcs (see biosal_assembly_connectivity), so that a graph store can
+ * update coverage and connectivity with one insertion.
+ */
 struct biosal_dna_kmer_frequency_block {
 
     int kmer_length;
+    int has_arcs;
 
     struct core_map kmers;
 };
@@ -23,8 +31,16 @@ void biosal_dna_kmer_frequency_block_init(struct biosal_dna_kmer_frequency_block
 
 void biosal_dna_kmer_frequency_block_destroy(struct biosal_dna_kmer_frequency_block *self, struct core_memory_pool *memory);
 
+/*
+ * Enable arcs. This must be called before adding k-mers.
+ */
+void biosal_dna_kmer_frequency_block_enable_arcs(struct biosal_dna_kmer_frequency_block *self);
+
 void biosal_dna_kmer_frequency_block_add_kmer(struct biosal_dna_kmer_frequency_block *self, struct biosal_dna_kmer *kmer,
                 struct core_memory_pool *memory, struct biosal_dna_codec *codec);
+void biosal_dna_kmer_frequency_block_add_kmer_with_arcs(struct biosal_dna_kmer_frequency_block *self,
+                struct biosal_dna_kmer *kmer, int arcs,
+                struct core_memory_pool *memory, struct biosal_dna_codec *codec);
 
 int biosal_dna_kmer_frequency_block_pack_size(struct biosal_dna_kmer_frequency_block *self, struct biosal_dna_codec *codec);
 int biosal_dna_kmer_frequency_block_pack(struct biosal_dna_kmer_frequency_block *self, void *buffer, struct biosal_dna_codec *codec);
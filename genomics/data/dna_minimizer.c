@@ -0,0 +1,301 @@
+
+#include "dna_minimizer.h"
+
+#include "dna_codec.h"
+#include "dna_kmer.h"
+#include "dna_sequence.h"
+
+#include <core/hash/hash.h>
+
+#include <core/system/memory_pool.h>
+#include <core/system/debugger.h>
+
+#define BITS_PER_NUCLEOTIDE 2
+#define BITS_PER_BYTE 8
+
+#define NUCLEOTIDE_MASK ((uint64_t)3)
+
+static char biosal_dna_minimizer_symbols[] = {
+    BIOSAL_NUCLEOTIDE_SYMBOL_A,
+    BIOSAL_NUCLEOTIDE_SYMBOL_C,
+    BIOSAL_NUCLEOTIDE_SYMBOL_G,
+    BIOSAL_NUCLEOTIDE_SYMBOL_T
+};
+
+static inline uint64_t biosal_dna_minimizer_get_code(struct biosal_dna_codec *codec,
+                void *encoded_sequence, int position);
+static inline uint64_t biosal_dna_minimizer_hash_shingle(struct biosal_dna_codec *codec,
+                int shingle_length, uint64_t forward, uint64_t reverse);
+static inline int biosal_dna_minimizer_lowest_bit(uint64_t value);
+
+void biosal_dna_minimizer_init(struct biosal_dna_minimizer *self,
+                int kmer_length, struct biosal_dna_codec *codec,
+                struct core_memory_pool *memory)
+{
+    int window;
+
+    self->codec = codec;
+    self->memory = memory;
+    self->kmer_length = kmer_length;
+    self->shingle_length = biosal_dna_minimizer_shingle_length(kmer_length);
+
+    CORE_DEBUGGER_ASSERT(self->shingle_length > 0);
+
+    self->last_shift = (self->shingle_length - 1) * BITS_PER_NUCLEOTIDE;
+    self->mask = ((uint64_t)1 << (self->shingle_length * BITS_PER_NUCLEOTIDE)) - 1;
+
+    /*
+     * A k-mer has k - w + 1 shingles.
+     */
+    window = kmer_length - self->shingle_length + 1;
+    self->capacity = 1;
+
+    while (self->capacity < window + 1) {
+        self->capacity *= 2;
+    }
+
+    self->hashes = core_memory_pool_allocate(memory, self->capacity * sizeof(uint64_t));
+    self->positions = core_memory_pool_allocate(memory, self->capacity * sizeof(int));
+
+    biosal_dna_minimizer_set_encoded_sequence(self, 0, NULL);
+}
+
+void biosal_dna_minimizer_destroy(struct biosal_dna_minimizer *self)
+{
+    core_memory_pool_free(self->memory, self->hashes);
+    core_memory_pool_free(self->memory, self->positions);
+
+    self->hashes = NULL;
+    self->positions = NULL;
+    self->codec = NULL;
+    self->memory = NULL;
+    self->kmer_length = -1;
+    self->capacity = 0;
+}
+
+void biosal_dna_minimizer_set_sequence(struct biosal_dna_minimizer *self,
+                struct biosal_dna_sequence *sequence)
+{
+    biosal_dna_minimizer_set_encoded_sequence(self,
+                    biosal_dna_sequence_length(sequence), sequence->encoded_data);
+}
+
+void biosal_dna_minimizer_set_encoded_sequence(struct biosal_dna_minimizer *self,
+                int length_in_nucleotides, void *encoded_sequence)
+{
+    self->sequence_data = encoded_sequence;
+    self->sequence_length = length_in_nucleotides;
+    self->position = 0;
+    self->valid_length = 0;
+    self->forward = 0;
+    self->reverse = 0;
+    self->head = 0;
+    self->tail = 0;
+}
+
+int biosal_dna_minimizer_next(struct biosal_dna_minimizer *self)
+{
+    uint64_t code;
+    uint64_t hash;
+    int mask;
+    int first;
+
+    mask = self->capacity - 1;
+
+    while (self->position < self->sequence_length) {
+
+        code = biosal_dna_minimizer_get_code(self->codec, self->sequence_data, self->position);
+
+        self->forward = (self->forward >> BITS_PER_NUCLEOTIDE) | (code << self->last_shift);
+        self->reverse = ((self->reverse << BITS_PER_NUCLEOTIDE) | (NUCLEOTIDE_MASK ^ code))
+                & self->mask;
+
+        ++self->position;
+        ++self->valid_length;
+
+        if (self->valid_length >= self->shingle_length) {
+
+            hash = biosal_dna_minimizer_hash_shingle(self->codec, self->shingle_length,
+                            self->forward, self->reverse);
+
+            /*
+             * The shingles with a higher hash value will never be the
+             * minimizer again.
+             */
+            while (self->tail > self->head
+                            && self->hashes[(self->tail - 1) & mask] >= hash) {
+                --self->tail;
+            }
+
+            self->hashes[self->tail & mask] = hash;
+            self->positions[self->tail & mask] = self->position - self->shingle_length;
+            ++self->tail;
+        }
+
+        if (self->valid_length >= self->kmer_length) {
+
+            /*
+             * Drop the shingles that start before the k-mer.
+             */
+            first = self->position - self->kmer_length;
+
+            while (self->positions[self->head & mask] < first) {
+                ++self->head;
+            }
+
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+uint64_t biosal_dna_minimizer_get(struct biosal_dna_minimizer *self)
+{
+    CORE_DEBUGGER_ASSERT(self->tail > self->head);
+
+    return self->hashes[self->head & (self->capacity - 1)];
+}
+
+int biosal_dna_minimizer_position(struct biosal_dna_minimizer *self)
+{
+    return self->position - self->kmer_length;
+}
+
+uint64_t biosal_dna_minimizer_get_kmer_minimizer(int kmer_length,
+                struct biosal_dna_codec *codec, void *encoded_kmer)
+{
+    int shingle_length;
+    int last_shift;
+    uint64_t mask;
+    uint64_t forward;
+    uint64_t reverse;
+    uint64_t code;
+    uint64_t hash;
+    uint64_t minimum;
+    int i;
+
+    shingle_length = biosal_dna_minimizer_shingle_length(kmer_length);
+
+    CORE_DEBUGGER_ASSERT(shingle_length > 0);
+
+    last_shift = (shingle_length - 1) * BITS_PER_NUCLEOTIDE;
+    mask = ((uint64_t)1 << (shingle_length * BITS_PER_NUCLEOTIDE)) - 1;
+
+    forward = 0;
+    reverse = 0;
+    minimum = 0;
+    --minimum;
+
+    for (i = 0; i < kmer_length; ++i) {
+
+        code = biosal_dna_minimizer_get_code(codec, encoded_kmer, i);
+
+        forward = (forward >> BITS_PER_NUCLEOTIDE) | (code << last_shift);
+        reverse = ((reverse << BITS_PER_NUCLEOTIDE) | (NUCLEOTIDE_MASK ^ code)) & mask;
+
+        if (i + 1 < shingle_length) {
+            continue;
+        }
+
+        hash = biosal_dna_minimizer_hash_shingle(codec, shingle_length, forward, reverse);
+
+        if (hash < minimum) {
+            minimum = hash;
+        }
+    }
+
+    return minimum;
+}
+
+int biosal_dna_minimizer_shingle_length(int kmer_length)
+{
+    int shingle_length;
+
+    shingle_length = BIOSAL_DNA_MINIMIZER_SHINGLE_LENGTH;
+
+    if (kmer_length < shingle_length) {
+        shingle_length = kmer_length - 3;
+    }
+
+    return shingle_length;
+}
+
+static inline uint64_t biosal_dna_minimizer_get_code(struct biosal_dna_codec *codec,
+                void *encoded_sequence, int position)
+{
+    uint8_t byte;
+
+    if (codec->use_two_bit_encoding) {
+        byte = ((uint8_t *)encoded_sequence)[position >> 2];
+
+        return (byte >> ((position & 3) * BITS_PER_NUCLEOTIDE)) & NUCLEOTIDE_MASK;
+    }
+
+    return biosal_dna_codec_get_code(((char *)encoded_sequence)[position]);
+}
+
+static inline int biosal_dna_minimizer_lowest_bit(uint64_t value)
+{
+#if defined(__GNUC__)
+    return __builtin_ctzll(value);
+#else
+    int bit;
+
+    bit = 0;
+
+    while (!(value & 1)) {
+        value >>= 1;
+        ++bit;
+    }
+
+    return bit;
+#endif
+}
+
+/*
+ * Write the canonical shingle in the format of the codec (like
+ * biosal_dna_kmer_canonical_hash does with a copy of the shingle)
+ * and hash it.
+ */
+static inline uint64_t biosal_dna_minimizer_hash_shingle(struct biosal_dna_codec *codec,
+                int shingle_length, uint64_t forward, uint64_t reverse)
+{
+    char buffer[BIOSAL_DNA_MINIMIZER_SHINGLE_LENGTH + 1];
+    uint64_t difference;
+    uint64_t word;
+    int encoded_length;
+    int bit;
+    int i;
+
+    word = forward;
+    difference = forward ^ reverse;
+
+    if (difference != 0) {
+        bit = biosal_dna_minimizer_lowest_bit(difference) & ~1;
+
+        if (((reverse >> bit) & NUCLEOTIDE_MASK) < ((forward >> bit) & NUCLEOTIDE_MASK)) {
+            word = reverse;
+        }
+    }
+
+    if (codec->use_two_bit_encoding) {
+        encoded_length = biosal_dna_codec_encoded_length(codec, shingle_length);
+
+        for (i = 0; i < encoded_length; ++i) {
+            buffer[i] = (char)(uint8_t)(word >> (i * BITS_PER_BYTE));
+        }
+
+    } else {
+        encoded_length = shingle_length + 1;
+
+        for (i = 0; i < shingle_length; ++i) {
+            buffer[i] = biosal_dna_minimizer_symbols[(word >> (i * BITS_PER_NUCLEOTIDE))
+                    & NUCLEOTIDE_MASK];
+        }
+
+        buffer[shingle_length] = '\0';
+    }
+
+    return core_hash_data_uint64_t(buffer, encoded_length, BIOSAL_DNA_KMER_HASH_SEED);
+}
@@ -0,0 +1,98 @@
+
+#ifndef BIOSAL_DNA_MINIMIZER_H
+#define BIOSAL_DNA_MINIMIZER_H
+
+#include <stdint.h>
+
+struct biosal_dna_codec;
+struct biosal_dna_sequence;
+struct core_memory_pool;
+
+/*
+ * Length of the shingles (the substrings of a k-mer that are hashed).
+ * Shorter k-mers use shingles of k - 3 nucleotides.
+ */
+#define BIOSAL_DNA_MINIMIZER_SHINGLE_LENGTH 19
+
+/*
+ * A rolling canonical minimizer.
+ *
+ * The minimizer of a k-mer is the lowest hash value of its canonical
+ * shingles, with the same hash function as biosal_dna_kmer_hash, so it is
+ * the same for a k-mer and for its reverse complement. This is the value
+ * used by biosal_dna_kmer_store_index to select a store.
+ *
+ * When reading a sequence, each nucleotide adds one shingle and the
+ * hash values of the shingles of the current k-mer are kept in a
+ * monotone deque, so the minimizer of each k-mer is found in O(1)
+ * amortized time and no memory is allocated per k-mer.
+ *
+ * Consecutive k-mers with the same minimizer go to the same store
+ * (they form a super k-mer).
+ */
+struct biosal_dna_minimizer {
+    struct biosal_dna_codec *codec;
+    struct core_memory_pool *memory;
+    int kmer_length;
+    int shingle_length;
+
+    uint64_t forward;
+    uint64_t reverse;
+    uint64_t mask;
+    int last_shift;
+
+    /*
+     * The deque of (hash, position) with increasing hash values.
+     */
+    uint64_t *hashes;
+    int *positions;
+    int capacity;
+    int head;
+    int tail;
+
+    void *sequence_data;
+    int sequence_length;
+    int position;
+    int valid_length;
+};
+
+void biosal_dna_minimizer_init(struct biosal_dna_minimizer *self,
+                int kmer_length, struct biosal_dna_codec *codec,
+                struct core_memory_pool *memory);
+void biosal_dna_minimizer_destroy(struct biosal_dna_minimizer *self);
+
+/*
+ * Start a new sequence.
+ */
+void biosal_dna_minimizer_set_sequence(struct biosal_dna_minimizer *self,
+                struct biosal_dna_sequence *sequence);
+void biosal_dna_minimizer_set_encoded_sequence(struct biosal_dna_minimizer *self,
+                int length_in_nucleotides, void *encoded_sequence);
+
+/*
+ * Advance to the next k-mer.
+ *
+ * @return 1 if a k-mer is available, 0 at the end of the sequence
+ */
+int biosal_dna_minimizer_next(struct biosal_dna_minimizer *self);
+
+/*
+ * @return the minimizer of the current k-mer
+ */
+uint64_t biosal_dna_minimizer_get(struct biosal_dna_minimizer *self);
+
+/*
+ * @return the position of the first nucleotide of the current k-mer
+ */
+int biosal_dna_minimizer_position(struct biosal_dna_minimizer *self);
+
+/*
+ * Compute the minimizer of one encoded k-mer (in the format of the codec)
+ * without any memory allocation.
+ */
+uint64_t biosal_dna_minimizer_get_kmer_minimizer(int kmer_length,
+                struct biosal_dna_codec *codec, void *encoded_kmer);
+
+int biosal_dna_minimizer_shingle_length(int kmer_length);
+
+#endif
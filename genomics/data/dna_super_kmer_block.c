@@ -0,0 +1,276 @@
+
+#include "dna_super_kmer_block.h"
+
+#include "dna_codec.h"
+
+#include <core/system/packer.h>
+#include <core/system/memory.h>
+#include <core/system/memory_pool.h>
+#include <core/system/debugger.h>
+
+#include <string.h>
+
+#define BITS_PER_NUCLEOTIDE 2
+#define NUCLEOTIDE_MASK 3
+
+#define BIOSAL_DNA_SUPER_KMER_BLOCK_MINIMUM_CAPACITY 256
+
+static int biosal_dna_super_kmer_block_pack_unpack_header(struct biosal_dna_super_kmer_block *self,
+                void *buffer, int operation);
+static void biosal_dna_super_kmer_block_reserve(struct biosal_dna_super_kmer_block *self,
+                int capacity);
+
+void biosal_dna_super_kmer_block_init(struct biosal_dna_super_kmer_block *self, int kmer_length,
+                int source_index, int capacity, struct core_memory_pool *memory)
+{
+    biosal_dna_super_kmer_block_init_empty(self);
+
+    self->kmer_length = kmer_length;
+    self->source_index = source_index;
+    self->memory = memory;
+    self->owns_storage = 1;
+
+    if (capacity > 0) {
+        biosal_dna_super_kmer_block_reserve(self, capacity);
+    }
+}
+
+void biosal_dna_super_kmer_block_init_empty(struct biosal_dna_super_kmer_block *self)
+{
+    self->kmer_length = -1;
+    self->source_index = -1;
+    self->size = 0;
+    self->kmer_count = 0;
+    self->has_flanks = 0;
+    self->data_size = 0;
+    self->data_capacity = 0;
+    self->data = NULL;
+    self->owns_storage = 0;
+    self->memory = NULL;
+}
+
+void biosal_dna_super_kmer_block_destroy(struct biosal_dna_super_kmer_block *self)
+{
+    if (self->owns_storage && self->data != NULL) {
+        core_memory_pool_free(self->memory, self->data);
+    }
+
+    biosal_dna_super_kmer_block_init_empty(self);
+}
+
+void biosal_dna_super_kmer_block_enable_flanks(struct biosal_dna_super_kmer_block *self)
+{
+    CORE_DEBUGGER_ASSERT(self->size == 0);
+
+    self->has_flanks = 1;
+}
+
+int biosal_dna_super_kmer_block_has_flanks(struct biosal_dna_super_kmer_block *self)
+{
+    return self->has_flanks;
+}
+
+static void biosal_dna_super_kmer_block_reserve(struct biosal_dna_super_kmer_block *self,
+                int capacity)
+{
+    char *data;
+
+    CORE_DEBUGGER_ASSERT(self->owns_storage);
+
+    if (capacity <= self->data_capacity) {
+        return;
+    }
+
+    data = core_memory_pool_allocate(self->memory, capacity);
+
+    if (self->data != NULL) {
+        core_memory_copy(data, self->data, self->data_size);
+        core_memory_pool_free(self->memory, self->data);
+    }
+
+    self->data = data;
+    self->data_capacity = capacity;
+}
+
+void biosal_dna_super_kmer_block_add(struct biosal_dna_super_kmer_block *self,
+                uint64_t minimizer, int length, void *encoded_sequence, int first,
+                int flanks, struct biosal_dna_codec *codec)
+{
+    int encoded_length;
+    int needed;
+    int capacity;
+    uint8_t *destination;
+    uint8_t *source;
+    int position;
+    int code;
+    int kmers;
+    int i;
+
+    CORE_DEBUGGER_ASSERT(length >= self->kmer_length);
+
+    encoded_length = biosal_dna_codec_encoded_length(codec, length);
+    needed = self->data_size + sizeof(minimizer) + sizeof(length) + sizeof(flanks)
+            + encoded_length;
+
+    if (needed > self->data_capacity) {
+        capacity = self->data_capacity * 2;
+
+        if (capacity < BIOSAL_DNA_SUPER_KMER_BLOCK_MINIMUM_CAPACITY) {
+            capacity = BIOSAL_DNA_SUPER_KMER_BLOCK_MINIMUM_CAPACITY;
+        }
+
+        if (capacity < needed) {
+            capacity = needed;
+        }
+
+        biosal_dna_super_kmer_block_reserve(self, capacity);
+    }
+
+    core_memory_copy(self->data + self->data_size, &minimizer, sizeof(minimizer));
+    self->data_size += sizeof(minimizer);
+    core_memory_copy(self->data + self->data_size, &length, sizeof(length));
+    self->data_size += sizeof(length);
+
+    kmers = length - self->kmer_length + 1;
+
+    if (self->has_flanks) {
+        core_memory_copy(self->data + self->data_size, &flanks, sizeof(flanks));
+        self->data_size += sizeof(flanks);
+
+        if (flanks & BIOSAL_DNA_SUPER_KMER_FLANK_PARENT) {
+            --kmers;
+        }
+
+        if (flanks & BIOSAL_DNA_SUPER_KMER_FLANK_CHILD) {
+            --kmers;
+        }
+
+        CORE_DEBUGGER_ASSERT(kmers > 0);
+    }
+
+    destination = (uint8_t *)self->data + self->data_size;
+    source = encoded_sequence;
+
+    /*
+     * The nucleotides are shifted to start at the beginning of a byte.
+     */
+    if (codec->use_two_bit_encoding) {
+        memset(destination, 0, encoded_length);
+
+        for (i = 0; i < length; ++i) {
+            position = first + i;
+            code = (source[position / 4] >> ((position % 4) * BITS_PER_NUCLEOTIDE))
+                    & NUCLEOTIDE_MASK;
+            destination[i / 4] |= code << ((i % 4) * BITS_PER_NUCLEOTIDE);
+        }
+    } else {
+        core_memory_copy(destination, source + first, length);
+        destination[length] = '\0';
+    }
+
+    self->data_size += encoded_length;
+
+    ++self->size;
+    self->kmer_count += kmers;
+}
+
+int biosal_dna_super_kmer_block_get(struct biosal_dna_super_kmer_block *self, int offset,
+                uint64_t *minimizer, int *length, int *flanks, void **encoded_sequence,
+                struct biosal_dna_codec *codec)
+{
+    CORE_DEBUGGER_ASSERT(offset >= 0 && offset < self->data_size);
+
+    core_memory_copy(minimizer, self->data + offset, sizeof(*minimizer));
+    offset += sizeof(*minimizer);
+    core_memory_copy(length, self->data + offset, sizeof(*length));
+    offset += sizeof(*length);
+
+    *flanks = 0;
+
+    if (self->has_flanks) {
+        core_memory_copy(flanks, self->data + offset, sizeof(*flanks));
+        offset += sizeof(*flanks);
+    }
+
+    *encoded_sequence = self->data + offset;
+    offset += biosal_dna_codec_encoded_length(codec, *length);
+
+    return offset;
+}
+
+int biosal_dna_super_kmer_block_size(struct biosal_dna_super_kmer_block *self)
+{
+    return self->size;
+}
+
+int biosal_dna_super_kmer_block_kmer_count(struct biosal_dna_super_kmer_block *self)
+{
+    return self->kmer_count;
+}
+
+int biosal_dna_super_kmer_block_data_size(struct biosal_dna_super_kmer_block *self)
+{
+    return self->data_size;
+}
+
+int biosal_dna_super_kmer_block_source_index(struct biosal_dna_super_kmer_block *self)
+{
+    return self->source_index;
+}
+
+int biosal_dna_super_kmer_block_pack_size(struct biosal_dna_super_kmer_block *self)
+{
+    return biosal_dna_super_kmer_block_pack_unpack_header(self, NULL,
+                    CORE_PACKER_OPERATION_PACK_SIZE) + self->data_size;
+}
+
+int biosal_dna_super_kmer_block_pack(struct biosal_dna_super_kmer_block *self, void *buffer)
+{
+    int offset;
+
+    offset = biosal_dna_super_kmer_block_pack_unpack_header(self, buffer,
+                    CORE_PACKER_OPERATION_PACK);
+
+    if (self->data_size > 0) {
+        core_memory_copy((char *)buffer + offset, self->data, self->data_size);
+    }
+
+    return offset + self->data_size;
+}
+
+int biosal_dna_super_kmer_block_unpack(struct biosal_dna_super_kmer_block *self, void *buffer)
+{
+    int offset;
+
+    biosal_dna_super_kmer_block_init_empty(self);
+
+    offset = biosal_dna_super_kmer_block_pack_unpack_header(self, buffer,
+                    CORE_PACKER_OPERATION_UNPACK);
+
+    self->data = (char *)buffer + offset;
+    self->data_capacity = self->data_size;
+    self->owns_storage = 0;
+
+    return offset + self->data_size;
+}
+
+static int biosal_dna_super_kmer_block_pack_unpack_header(struct biosal_dna_super_kmer_block *self,
+                void *buffer, int operation)
+{
+    struct core_packer packer;
+    int offset;
+
+    core_packer_init(&packer, operation, buffer);
+
+    core_packer_process(&packer, &self->kmer_length, sizeof(self->kmer_length));
+    core_packer_process(&packer, &self->source_index, sizeof(self->source_index));
+    core_packer_process(&packer, &self->size, sizeof(self->size));
+    core_packer_process(&packer, &self->kmer_count, sizeof(self->kmer_count));
+    core_packer_process(&packer, &self->has_flanks, sizeof(self->has_flanks));
+    core_packer_process(&packer, &self->data_size, sizeof(self->data_size));
+
+    offset = core_packer_get_byte_count(&packer);
+    core_packer_destroy(&packer);
+
+    return offset;
+}
@@ -0,0 +1,98 @@
+
+#ifndef BIOSAL_DNA_SUPER_KMER_BLOCK_H
+#define BIOSAL_DNA_SUPER_KMER_BLOCK_H
+
+#include <stdint.h>
+
+struct biosal_dna_codec;
+struct core_memory_pool;
+
+/*
+ * Flanking nucleotides of a super k-mer.
+ */
+#define BIOSAL_DNA_SUPER_KMER_FLANK_PARENT 1
+#define BIOSAL_DNA_SUPER_KMER_FLANK_CHILD 2
+
+/*
+ * A block of super k-mers.
+ *
+ * A super k-mer is a run of consecutive k-mers of a sequence that have
+ * the same minimizer (see biosal_dna_minimizer), so they all belong to
+ * the same store. It is stored once as its k + n - 1 nucleotides (in
+ * the format of the codec) along with the minimizer, instead of n
+ * separate k-mers.
+ *
+ * With flanks enabled, a super k-mer also has the nucleotide before its
+ * first k-mer and the one after its last k-mer (when the sequence has
+ * them), so that the arcs of all its k-mers are known.
+ *
+ * The packed form is the same as the in-memory form:
+ *
+ * [kmer_length][source_index][size][kmer_count][has_flanks][data_size][data]
+ *
+ * where data has [minimizer][length_in_nucleotides][flanks][nucleotides]
+ * for each super k-mer ([flanks] is only there with flanks enabled and the
+ * length includes the flanking nucleotides).
+ */
+struct biosal_dna_super_kmer_block {
+    int kmer_length;
+    int source_index;
+    int size;
+    int kmer_count;
+    int has_flanks;
+
+    int data_size;
+    int data_capacity;
+    char *data;
+
+    int owns_storage;
+    struct core_memory_pool *memory;
+};
+
+void biosal_dna_super_kmer_block_init(struct biosal_dna_super_kmer_block *self, int kmer_length,
+                int source_index, int capacity, struct core_memory_pool *memory);
+void biosal_dna_super_kmer_block_init_empty(struct biosal_dna_super_kmer_block *self);
+void biosal_dna_super_kmer_block_destroy(struct biosal_dna_super_kmer_block *self);
+
+/*
+ * Enable flanks. This must be called before adding super k-mers.
+ */
+void biosal_dna_super_kmer_block_enable_flanks(struct biosal_dna_super_kmer_block *self);
+int biosal_dna_super_kmer_block_has_flanks(struct biosal_dna_super_kmer_block *self);
+
+/*
+ * Add the super k-mer made of the @length nucleotides starting at @first
+ * in an encoded sequence. @flanks tells which flanking nucleotides are
+ * included in these nucleotides (it is ignored without flanks).
+ */
+void biosal_dna_super_kmer_block_add(struct biosal_dna_super_kmer_block *self,
+                uint64_t minimizer, int length, void *encoded_sequence, int first,
+                int flanks, struct biosal_dna_codec *codec);
+
+/*
+ * Read the super k-mer at @offset in the data. The encoded nucleotides
+ * point inside the block.
+ *
+ * @return the offset of the next super k-mer
+ */
+int biosal_dna_super_kmer_block_get(struct biosal_dna_super_kmer_block *self, int offset,
+                uint64_t *minimizer, int *length, int *flanks, void **encoded_sequence,
+                struct biosal_dna_codec *codec);
+
+/*
+ * @return the number of super k-mers
+ */
+int biosal_dna_super_kmer_block_size(struct biosal_dna_super_kmer_block *self);
+int biosal_dna_super_kmer_block_kmer_count(struct biosal_dna_super_kmer_block *self);
+int biosal_dna_super_kmer_block_data_size(struct biosal_dna_super_kmer_block *self);
+int biosal_dna_super_kmer_block_source_index(struct biosal_dna_super_kmer_block *self);
+
+int biosal_dna_super_kmer_block_pack_size(struct biosal_dna_super_kmer_block *self);
+int biosal_dna_super_kmer_block_pack(struct biosal_dna_super_kmer_block *self, void *buffer);
+
+/*
+ * The block uses the buffer directly.
+ */
+int biosal_dna_super_kmer_block_unpack(struct biosal_dna_super_kmer_block *self, void *buffer);
+
+#endif
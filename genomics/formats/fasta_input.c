@@ -84,6 +84,7 @@ uint64_t core_fasta_input_get_sequence(struct biosal_input_format *input,
     int position_in_sequence;
     int is_header;
     int block_length;
+    const char *line;
 
     fasta = (struct core_fasta_input *)biosal_input_format_implementation(input);
 
@@ -147,8 +148,18 @@ uint64_t core_fasta_input_get_sequence(struct biosal_input_format *input,
     position_in_sequence = 0;
 
     while (1) {
-        value = core_buffered_reader_read_line(&fasta->reader, fasta->buffer,
+
+        /*
+         * Readers with line views do not copy the line.
+         */
+        if (core_buffered_reader_has_line_views(&fasta->reader)) {
+            value = core_buffered_reader_read_line_view(&fasta->reader, &line);
+        } else {
+            value = core_buffered_reader_read_line(&fasta->reader, fasta->buffer,
                     maximum_sequence_length);
+            line = fasta->buffer;
+            value = strlen(fasta->buffer);
+        }
 
         if (value == 0) {
             break;
@@ -156,8 +167,7 @@ uint64_t core_fasta_input_get_sequence(struct biosal_input_format *input,
 
         is_header = 0;
 
-        if (strlen(fasta->buffer) > 0
-                        && fasta->buffer[0] == '>') {
+        if (line[0] == '>') {
 
             is_header = 1;
         }
@@ -165,7 +175,8 @@ uint64_t core_fasta_input_get_sequence(struct biosal_input_format *input,
         if (is_header) {
             sequence[position_in_sequence] = '\0';
 
-            strcpy(fasta->next_header, fasta->buffer);
+            core_memory_copy(fasta->next_header, line, value);
+            fasta->next_header[value] = '\0';
             fasta->has_header = 1;
             break;
         }
@@ -178,17 +189,17 @@ uint64_t core_fasta_input_get_sequence(struct biosal_input_format *input,
             ++lines;
         }
 
-        block_length = strlen(fasta->buffer);
+        block_length = value;
 
         /*
          * Remove the new line.
          */
-        if (fasta->buffer[block_length - 1] == '\n') {
+        if (line[block_length - 1] == '\n') {
             --block_length;
         }
 
         core_memory_copy(sequence + position_in_sequence,
-                        fasta->buffer,
+                        line,
                         block_length);
 
         position_in_sequence += block_length;
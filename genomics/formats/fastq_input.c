@@ -28,6 +28,10 @@ uint64_t core_fastq_input_get_offset(struct biosal_input_format *self);
 int core_fastq_input_is_identifier(struct biosal_input_format *self, const char *line);
 int core_fastq_input_is_identifier_mock(struct biosal_input_format *self, const char *line);
 
+static int core_fastq_input_skip_line(struct core_fastq_input *self, int maximum_length);
+static int core_fastq_input_read_sequence(struct core_fastq_input *self, char *sequence,
+                int maximum_length);
+
 struct biosal_input_format_interface core_fastq_input_operations = {
     .init = core_fastq_input_init,
     .destroy = core_fastq_input_destroy,
@@ -97,9 +101,6 @@ uint64_t core_fastq_input_get_sequence(struct biosal_input_format *input,
     /*
      * Read name
      */
-    value += core_buffered_reader_read_line(&fastq->reader, fastq->buffer,
-                    maximum_sequence_length);
-
 #ifdef FIND_IDENTIFIER
     /*
      * If we do not have the first entry yet,
@@ -107,6 +108,9 @@ uint64_t core_fastq_input_get_sequence(struct biosal_input_format *input,
      */
     if (!fastq->has_first) {
 
+        value += core_buffered_reader_read_line(&fastq->reader, fastq->buffer,
+                    maximum_sequence_length);
+
         while (!core_fastq_input_is_identifier(input, fastq->buffer)) {
 
             value += core_buffered_reader_read_line(&fastq->reader, fastq->buffer,
@@ -114,26 +118,22 @@ uint64_t core_fastq_input_get_sequence(struct biosal_input_format *input,
         }
 
         fastq->has_first = 1;
+    } else {
+        value += core_fastq_input_skip_line(fastq, maximum_sequence_length);
     }
+#else
+    value += core_fastq_input_skip_line(fastq, maximum_sequence_length);
 #endif
 
     /*
      * Read DNA sequence
      */
-    length = core_buffered_reader_read_line(&fastq->reader, sequence,
-                    maximum_sequence_length);
+    length = core_fastq_input_read_sequence(fastq, sequence, maximum_sequence_length);
 
 #ifdef BIOSAL_FASTQ_INPUT_DEBUG_READ_LINE
     printf("FASTQ ReadLine <<%s>>\n", sequence);
 #endif
 
-    if (sequence[length - 1] == '\n') {
-        /*
-         * Remove new line symbol.
-         */
-        sequence[length - 1] = '\0';
-    }
-
     value += length;
 
 #ifdef BIOSAL_FASTQ_INPUT_DEBUG2
@@ -143,18 +143,66 @@ uint64_t core_fastq_input_get_sequence(struct biosal_input_format *input,
     /*
      * Read the + symbol
      */
-    value += core_buffered_reader_read_line(&fastq->reader, fastq->buffer,
-                    maximum_sequence_length);
+    value += core_fastq_input_skip_line(fastq, maximum_sequence_length);
 
     /*
      * Read quality string.
      */
-    value += core_buffered_reader_read_line(&fastq->reader, fastq->buffer,
-                    maximum_sequence_length);
+    value += core_fastq_input_skip_line(fastq, maximum_sequence_length);
 
     return value;
 }
 
+/*
+ * Skip a line. Readers with line views do not copy it.
+ */
+static int core_fastq_input_skip_line(struct core_fastq_input *self, int maximum_length)
+{
+    const char *line;
+
+    if (core_buffered_reader_has_line_views(&self->reader)) {
+        return core_buffered_reader_read_line_view(&self->reader, &line);
+    }
+
+    return core_buffered_reader_read_line(&self->reader, self->buffer,
+                    maximum_length);
+}
+
+/*
+ * Read a line in sequence, without the new line symbol.
+ *
+ * \return the number of bytes read, with the new line symbol
+ */
+static int core_fastq_input_read_sequence(struct core_fastq_input *self, char *sequence,
+                int maximum_length)
+{
+    const char *line;
+    int length;
+
+    if (core_buffered_reader_has_line_views(&self->reader)) {
+        length = core_buffered_reader_read_line_view(&self->reader, &line);
+
+        if (length > 0) {
+            core_memory_copy(sequence, line, length);
+        }
+
+        sequence[length] = '\0';
+
+    } else {
+        length = core_buffered_reader_read_line(&self->reader, sequence,
+                        maximum_length);
+    }
+
+    /*
+     * Remove new line symbol.
+     */
+    if (length > 0 && sequence[length - 1] == '\n') {
+        sequence[length - 1] = '\0';
+    }
+
+    return length;
+}
+
 int core_fastq_input_detect(struct biosal_input_format *input)
 {
     if (biosal_input_format_has_suffix(input, ".fastq")) {
@@ -188,7 +236,7 @@ uint64_t core_fastq_input_get_offset(struct biosal_input_format *self)
 int core_fastq_input_is_identifier(struct biosal_input_format *self, const char *line)
 {
     int length;
-    char buffer[2];
+    char buffer[3];
     int read;
     struct core_fastq_input *fastq;
 
@@ -0,0 +1,241 @@
+#include "record_splitter.h"
+
+#include "input_format.h"
+
+#include <core/file_storage/input/buffered_reader.h>
+#include <core/file_storage/file.h>
+
+#include <core/structures/vector.h>
+
+#include <core/system/memory.h>
+
+#include <string.h>
+#include <inttypes.h>
+
+#define FORMAT_UNKNOWN 0
+#define FORMAT_FASTQ 1
+#define FORMAT_FASTA 2
+
+/*
+ * FASTQ needs the first symbols of 3 consecutive lines.
+ */
+#define LINE_COUNT 3
+
+#define MEMORY_RECORD_SPLITTER 0x7a0e5c41
+
+static int biosal_record_splitter_get_format(const char *file);
+static int biosal_record_splitter_has_suffix(const char *file, const char *suffix);
+static uint64_t biosal_record_splitter_find_record(const char *file, int format,
+                uint64_t offset, uint64_t file_size, char *buffer);
+static int biosal_record_splitter_read_line(struct core_buffered_reader *reader,
+                char *buffer, char *first_symbol);
+
+void biosal_record_splitter_split(const char *file, int range_count,
+                struct core_vector *start_offsets, struct core_vector *end_offsets)
+{
+    uint64_t file_size;
+    uint64_t offset;
+    uint64_t start_offset;
+    uint64_t end_offset;
+    int format;
+    int i;
+    int size;
+    char *buffer;
+
+    if (range_count < 1) {
+        return;
+    }
+
+    /*
+     * A gzip file can only be split if it is a BGZF file. Otherwise,
+     * one stream reads all of it.
+     */
+    if (!core_buffered_reader_get_content_size(file, &file_size)) {
+
+        if (core_file_get_size(file) > 0) {
+            end_offset = 0;
+            --end_offset;
+
+            core_vector_push_back_uint64_t(start_offsets, 0);
+            core_vector_push_back_uint64_t(end_offsets, end_offset);
+        }
+
+        return;
+    }
+
+    if (file_size == 0) {
+        return;
+    }
+
+    format = biosal_record_splitter_get_format(file);
+    buffer = NULL;
+
+    if (format != FORMAT_UNKNOWN) {
+        buffer = core_memory_allocate(BIOSAL_INPUT_MAXIMUM_SEQUENCE_LENGTH + 1, MEMORY_RECORD_SPLITTER);
+    }
+
+    for (i = 0; i < range_count; ++i) {
+
+        offset = file_size / range_count * i;
+
+        if (i > 0 && format != FORMAT_UNKNOWN) {
+            offset = biosal_record_splitter_find_record(file, format, offset, file_size,
+                            buffer);
+        }
+
+        size = core_vector_size(start_offsets);
+
+        /*
+         * A record may cover more than one range.
+         */
+        if (offset >= file_size
+                        || (size > 0 && offset <= core_vector_at_as_uint64_t(start_offsets, size - 1))) {
+            continue;
+        }
+
+        core_vector_push_back_uint64_t(start_offsets, offset);
+    }
+
+    size = core_vector_size(start_offsets);
+
+    for (i = 0; i < size; ++i) {
+        end_offset = file_size - 1;
+
+        if (i + 1 < size) {
+            start_offset = core_vector_at_as_uint64_t(start_offsets, i + 1);
+            end_offset = start_offset - 1;
+        }
+
+        core_vector_push_back_uint64_t(end_offsets, end_offset);
+    }
+
+    if (buffer != NULL) {
+        core_memory_free(buffer, MEMORY_RECORD_SPLITTER);
+    }
+}
+
+/*
+ * \return the offset of the first record starting at or after offset,
+ * or the end of the file
+ */
+static uint64_t biosal_record_splitter_find_record(const char *file, int format,
+                uint64_t offset, uint64_t file_size, char *buffer)
+{
+    struct core_buffered_reader reader;
+    uint64_t line_offsets[LINE_COUNT];
+    char first_symbols[LINE_COUNT];
+    int lines;
+    int first;
+    int last;
+    uint64_t record_offset;
+
+    /*
+     * The reader starts on the byte before the offset, so that the first
+     * line that is read ends right before the first line starting at or
+     * after the offset.
+     */
+    core_buffered_reader_init(&reader, file, offset - 1);
+    biosal_record_splitter_read_line(&reader, buffer, first_symbols);
+
+    lines = 0;
+    record_offset = file_size;
+
+    while (1) {
+        last = lines % LINE_COUNT;
+        line_offsets[last] = core_buffered_reader_get_offset(&reader);
+
+        if (!biosal_record_splitter_read_line(&reader, buffer, first_symbols + last)) {
+            break;
+        }
+
+        ++lines;
+
+        if (format == FORMAT_FASTA) {
+            if (first_symbols[last] == '>') {
+                record_offset = line_offsets[last];
+                break;
+            }
+
+            continue;
+        }
+
+        /*
+         * A FASTQ line starting with a '@' is either a header or a
+         * quality string. It is a header if the line 2 lines after it
+         * starts with a '+' (the line after a quality string is a header,
+         * and the one after that is a DNA sequence).
+         */
+        if (lines < LINE_COUNT) {
+            continue;
+        }
+
+        first = lines % LINE_COUNT;
+
+        if (first_symbols[first] == '@' && first_symbols[last] == '+') {
+            record_offset = line_offsets[first];
+            break;
+        }
+    }
+
+    core_buffered_reader_destroy(&reader);
+
+    return record_offset;
+}
+
+/*
+ * \return the number of bytes in the line
+ */
+static int biosal_record_splitter_read_line(struct core_buffered_reader *reader,
+                char *buffer, char *first_symbol)
+{
+    const char *line;
+    int length;
+
+    if (core_buffered_reader_has_line_views(reader)) {
+        length = core_buffered_reader_read_line_view(reader, &line);
+    } else {
+        length = core_buffered_reader_read_line(reader, buffer,
+                        BIOSAL_INPUT_MAXIMUM_SEQUENCE_LENGTH);
+        line = buffer;
+    }
+
+    if (length > 0) {
+        *first_symbol = line[0];
+    }
+
+    return length;
+}
+
+static int biosal_record_splitter_get_format(const char *file)
+{
+    if (biosal_record_splitter_has_suffix(file, ".fastq")
+                    || biosal_record_splitter_has_suffix(file, ".fq")
+                    || biosal_record_splitter_has_suffix(file, ".fastq.gz")
+                    || biosal_record_splitter_has_suffix(file, ".fq.gz")) {
+        return FORMAT_FASTQ;
+    }
+
+    if (biosal_record_splitter_has_suffix(file, ".fasta")
+                    || biosal_record_splitter_has_suffix(file, ".fa")
+                    || biosal_record_splitter_has_suffix(file, ".fasta.gz")
+                    || biosal_record_splitter_has_suffix(file, ".fa.gz")) {
+        return FORMAT_FASTA;
+    }
+
+    return FORMAT_UNKNOWN;
+}
+
+static int biosal_record_splitter_has_suffix(const char *file, const char *suffix)
+{
+    int length;
+    int suffix_length;
+
+    length = strlen(file);
+    suffix_length = strlen(suffix);
+
+    if (suffix_length > length) {
+        return 0;
+    }
+
+    return strcmp(file + length - suffix_length, suffix) == 0;
+}
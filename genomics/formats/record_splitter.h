@@ -0,0 +1,24 @@
+
+#ifndef BIOSAL_RECORD_SPLITTER_H
+#define BIOSAL_RECORD_SPLITTER_H
+
+struct core_vector;
+
+/*
+ * Split a file in ranges of bytes that start on records, so that
+ * several input streams can parse one file in parallel.
+ *
+ * FASTQ files (4 lines per record) and FASTA files are supported,
+ * compressed with BGZF or not (offsets are then in uncompressed bytes).
+ * Other files are split at the requested offsets, and their readers
+ * have to find their first record. A gzip file that is not a BGZF
+ * file is not split.
+ *
+ * The ranges are inclusive and stored as uint64_t values. A range
+ * that would contain no record is dropped, so there may be less
+ * than range_count ranges.
+ */
+void biosal_record_splitter_split(const char *file, int range_count,
+                struct core_vector *start_offsets, struct core_vector *end_offsets);
+
+#endif
@@ -63,3 +63,40 @@ int biosal_command_get_minimum_coverage(int argc, char **argv)
 
     return value;
 }
+
+int biosal_command_use_compact_kmer_store(int argc, char **argv)
+{
+    return core_command_has_argument(argc, argv, "-compact-kmer-store");
+}
+
+int biosal_command_get_singleton_filter_bits(int argc, char **argv)
+{
+    int value;
+
+    value = 0;
+
+    if (core_command_has_argument(argc, argv, "-singleton-filter-bits")) {
+        value = core_command_get_argument_value_int(argc, argv, "-singleton-filter-bits");
+    }
+
+    if (value < 0) {
+        value = 0;
+    }
+
+    return value;
+}
+
+int biosal_command_use_fused_graph_construction(int argc, char **argv)
+{
+    return core_command_has_argument(argc, argv, "-fused-graph-construction");
+}
+
+int biosal_command_use_node_graph_store(int argc, char **argv)
+{
+    return core_command_has_argument(argc, argv, "-node-graph-store");
+}
+
+int biosal_command_use_single_pass_input(int argc, char **argv)
+{
+    return core_command_has_argument(argc, argv, "-single-pass-input");
+}
@@ -23,4 +23,42 @@ char *biosal_command_get_output_directory(int argc, char **argv);
  */
 int biosal_command_get_minimum_coverage(int argc, char **argv);
 
+/*
+ * Kmer stores use biosal_compact_kmer_table (with -compact-kmer-store),
+ * which needs less memory per kmer.
+ */
+int biosal_command_use_compact_kmer_store(int argc, char **argv);
+
+/*
+ * With -singleton-filter-bits bits_per_kmer, kmer stores keep the first
+ * occurrence of each kmer in a Bloom filter and add kmers to their
+ * table only when they are seen again.
+ *
+ * \return the memory budget of the filter in bits per kmer, or 0 if
+ * there is no filter
+ */
+int biosal_command_get_singleton_filter_bits(int argc, char **argv);
+
+/*
+ * With -fused-graph-construction, the assembly graph builder reads the
+ * sequences only once: sliding windows ship each vertex with its arcs
+ * and graph stores update coverage and connectivity in one insertion
+ * (there is no arc kernel pass).
+ */
+int biosal_command_use_fused_graph_construction(int argc, char **argv);
+
+/*
+ * With -node-graph-store, the graph stores of a node keep their vertices
+ * in one table shared by the node, and actors on the same node read
+ * vertices with a function call instead of ACTION_ASSEMBLY_GET_VERTEX.
+ */
+int biosal_command_use_node_graph_store(int argc, char **argv);
+
+/*
+ * With -single-pass-input, the input controller does not count the
+ * sequences before distributing them: input streams parse ranges of
+ * files and push the sequences to the sequence stores as they go.
+ */
+int biosal_command_use_single_pass_input(int argc, char **argv);
+
 #endif
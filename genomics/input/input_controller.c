@@ -8,6 +8,12 @@
 #include <genomics/storage/sequence_partitioner.h>
 #include <genomics/storage/partition_command.h>
 #include <genomics/input/input_command.h>
+#include <genomics/formats/record_splitter.h>
+#include <genomics/formats/input_proxy.h>
+#include <genomics/helpers/command.h>
+
+#include <core/file_storage/input/buffered_reader.h>
+#include <core/file_storage/file.h>
 
 #include <core/structures/vector.h>
 #include <core/structures/vector_iterator.h>
@@ -16,6 +22,7 @@
 #include <core/helpers/vector_helper.h>
 #include <core/helpers/map_helper.h>
 #include <core/system/memory.h>
+#include <core/system/packer.h>
 
 #include <engine/thorium/modules/message_helper.h>
 #include <engine/thorium/actor.h>
@@ -45,6 +52,14 @@
 #define BIOSAL_INPUT_CONTROLLER_STATE_SPAWN_STORES 3
 #define BIOSAL_INPUT_CONTROLLER_STATE_SPAWN_PARTITIONER 4
 #define BIOSAL_INPUT_CONTROLLER_STATE_SPAWN_READING_STREAMS 5
+#define BIOSAL_INPUT_CONTROLLER_STATE_SPAWN_STREAMING_STREAMS 6
+
+/*
+ * Single-pass input: size of a range in bytes and number of streams
+ * per spawner.
+ */
+#define SINGLE_PASS_RANGE_SIZE 67108864
+#define SINGLE_PASS_STREAMS_PER_SPAWNER 4
 
 void biosal_input_controller_init(struct thorium_actor *actor);
 void biosal_input_controller_destroy(struct thorium_actor *actor);
@@ -62,6 +77,12 @@ void biosal_input_controller_spawn_streams(struct thorium_actor *actor, struct t
 void biosal_input_controller_set_offset_reply(struct thorium_actor *self, struct thorium_message *message);
 void biosal_input_controller_verify_requests(struct thorium_actor *self, struct thorium_message *message);
 
+void biosal_input_controller_distribute_in_one_pass(struct thorium_actor *self, struct thorium_message *message);
+void biosal_input_controller_assign_range(struct thorium_actor *self, struct thorium_message *message);
+void biosal_input_controller_push_range_reply(struct thorium_actor *self, struct thorium_message *message);
+static void biosal_input_controller_send_next_range(struct thorium_actor *self, int stream);
+static void biosal_input_controller_seal_stores(struct thorium_actor *self);
+
 struct thorium_script biosal_input_controller_script = {
     .identifier = SCRIPT_INPUT_CONTROLLER,
     .init = biosal_input_controller_init,
@@ -129,6 +150,11 @@ void biosal_input_controller_init(struct thorium_actor *actor)
 
     thorium_actor_add_action(actor, ACTION_INPUT_STREAM_SET_START_OFFSET_REPLY,
                     biosal_input_controller_set_offset_reply);
+
+    thorium_actor_add_action(actor, ACTION_SET_CONSUMERS_REPLY,
+                    biosal_input_controller_assign_range);
+    thorium_actor_add_action(actor, ACTION_INPUT_STREAM_PUSH_RANGE_REPLY,
+                    biosal_input_controller_push_range_reply);
     thorium_actor_add_script(actor, SCRIPT_INPUT_STREAM, &biosal_input_stream_script);
     thorium_actor_add_script(actor, SCRIPT_SEQUENCE_STORE, &biosal_sequence_store_script);
     thorium_actor_add_script(actor, SCRIPT_SEQUENCE_PARTITIONER,
@@ -153,6 +179,16 @@ void biosal_input_controller_init(struct thorium_actor *actor)
     concrete_actor->filled_consumers = 0;
 
     concrete_actor->counted = 0;
+
+    concrete_actor->single_pass = biosal_command_use_single_pass_input(thorium_actor_argc(actor),
+                    thorium_actor_argv(actor));
+
+    core_vector_init(&concrete_actor->range_files, sizeof(int));
+    core_vector_init(&concrete_actor->range_starts, sizeof(uint64_t));
+    core_vector_init(&concrete_actor->range_ends, sizeof(uint64_t));
+    core_vector_init(&concrete_actor->range_entries, sizeof(uint64_t));
+    concrete_actor->next_range = 0;
+    concrete_actor->finished_streams = 0;
 }
 
 void biosal_input_controller_destroy(struct thorium_actor *actor)
@@ -198,6 +234,11 @@ void biosal_input_controller_destroy(struct thorium_actor *actor)
     core_map_iterator_destroy(&iterator);
     core_map_destroy(&concrete_actor->mega_blocks);
     core_map_destroy(&concrete_actor->assigned_blocks);
+
+    core_vector_destroy(&concrete_actor->range_files);
+    core_vector_destroy(&concrete_actor->range_starts);
+    core_vector_destroy(&concrete_actor->range_ends);
+    core_vector_destroy(&concrete_actor->range_entries);
 }
 
 void biosal_input_controller_receive(struct thorium_actor *actor, struct thorium_message *message)
@@ -375,6 +416,19 @@ void biosal_input_controller_receive(struct thorium_actor *actor, struct thorium
 
             return;
 
+        } else if (concrete_actor->state == BIOSAL_INPUT_CONTROLLER_STATE_SPAWN_STREAMING_STREAMS) {
+
+            /*
+             * The stream gets its first range once it knows the stores.
+             */
+            thorium_message_unpack_int(message, 0, &stream);
+            core_vector_push_back_int(&concrete_actor->reading_streams, stream);
+
+            thorium_actor_send_vector(actor, stream, ACTION_SET_CONSUMERS,
+                            &concrete_actor->consumers);
+
+            return;
+
         } else if (concrete_actor->state == BIOSAL_INPUT_CONTROLLER_STATE_SPAWN_READING_STREAMS) {
 
             thorium_message_unpack_int(message, 0, &stream);
@@ -569,6 +623,11 @@ void biosal_input_controller_receive(struct thorium_actor *actor, struct thorium
 
     } else if (tag == ACTION_INPUT_DISTRIBUTE) {
 
+        if (concrete_actor->single_pass) {
+            biosal_input_controller_distribute_in_one_pass(actor, message);
+            return;
+        }
+
         core_timer_start(&concrete_actor->input_timer);
         core_timer_start(&concrete_actor->counting_timer);
 
@@ -1362,3 +1421,229 @@ void biosal_input_controller_verify_requests(struct thorium_actor *self, struct
     if (active == 0) {
     }
 }
+
+/*
+ * Single-pass input: the streams push their sequences to the stores
+ * while they parse, so there is no counting pass and no partition.
+ * Each file is split in ranges and a stream gets a new range when it
+ * is done with its previous one.
+ */
+void biosal_input_controller_distribute_in_one_pass(struct thorium_actor *self, struct thorium_message *message)
+{
+    struct biosal_input_controller *concrete_self;
+    struct core_vector start_offsets;
+    struct core_vector end_offsets;
+    struct biosal_input_proxy proxy;
+    char *file;
+    uint64_t file_size;
+    int error;
+    int range_count;
+    int stream_count;
+    int spawner;
+    int i;
+    int j;
+
+    concrete_self = thorium_actor_concrete_actor(self);
+
+    core_timer_start(&concrete_self->input_timer);
+    core_timer_start(&concrete_self->distribution_timer);
+
+    core_vector_init(&start_offsets, sizeof(uint64_t));
+    core_vector_init(&end_offsets, sizeof(uint64_t));
+
+    for (i = 0; i < core_vector_size(&concrete_self->files); i++) {
+        file = core_vector_at_as_char_pointer(&concrete_self->files, i);
+
+        /*
+         * Skip the files that the streams can not read.
+         */
+        biosal_input_proxy_init(&proxy, file, 0, 0);
+        error = biosal_input_proxy_error(&proxy);
+        biosal_input_proxy_destroy(&proxy);
+
+        if (error != BIOSAL_INPUT_ERROR_NO_ERROR) {
+            thorium_actor_log(self, "skipping %s (error %d)\n", file, error);
+            continue;
+        }
+
+        if (!core_buffered_reader_get_content_size(file, &file_size)) {
+            file_size = core_file_get_size(file);
+        }
+
+        if (file_size == 0) {
+            thorium_actor_log(self, "Error: file %s is empty or does not exist\n", file);
+            continue;
+        }
+
+        core_vector_clear(&start_offsets);
+        core_vector_clear(&end_offsets);
+
+        biosal_record_splitter_split(file, (file_size + SINGLE_PASS_RANGE_SIZE - 1) / SINGLE_PASS_RANGE_SIZE,
+                        &start_offsets, &end_offsets);
+
+        for (j = 0; j < core_vector_size(&start_offsets); j++) {
+            core_vector_push_back_int(&concrete_self->range_files, i);
+            core_vector_push_back_uint64_t(&concrete_self->range_starts,
+                            core_vector_at_as_uint64_t(&start_offsets, j));
+            core_vector_push_back_uint64_t(&concrete_self->range_ends,
+                            core_vector_at_as_uint64_t(&end_offsets, j));
+            core_vector_push_back_uint64_t(&concrete_self->range_entries, 0);
+        }
+    }
+
+    core_vector_destroy(&start_offsets);
+    core_vector_destroy(&end_offsets);
+
+    range_count = core_vector_size(&concrete_self->range_files);
+
+    thorium_actor_log(self, "single-pass input: %d files, %d ranges\n",
+                    (int)core_vector_size(&concrete_self->files), range_count);
+
+    if (range_count == 0) {
+        thorium_actor_log(self, "Error: no file to distribute...\n");
+        thorium_actor_send_reply_empty(self, ACTION_INPUT_DISTRIBUTE_REPLY);
+        return;
+    }
+
+    stream_count = core_vector_size(&concrete_self->spawners) * SINGLE_PASS_STREAMS_PER_SPAWNER;
+
+    if (stream_count > range_count) {
+        stream_count = range_count;
+    }
+
+    concrete_self->state = BIOSAL_INPUT_CONTROLLER_STATE_SPAWN_STREAMING_STREAMS;
+    concrete_self->next_range = 0;
+    concrete_self->finished_streams = 0;
+
+    for (i = 0; i < stream_count; i++) {
+        spawner = core_vector_at_as_int(&concrete_self->spawners,
+                        i % core_vector_size(&concrete_self->spawners));
+
+        thorium_actor_send_int(self, spawner, ACTION_SPAWN, SCRIPT_INPUT_STREAM);
+    }
+}
+
+void biosal_input_controller_assign_range(struct thorium_actor *self, struct thorium_message *message)
+{
+    biosal_input_controller_send_next_range(self, thorium_message_source(message));
+}
+
+void biosal_input_controller_push_range_reply(struct thorium_actor *self, struct thorium_message *message)
+{
+    struct biosal_input_controller *concrete_self;
+    struct core_packer packer;
+    int range_index;
+    uint64_t entries;
+
+    concrete_self = thorium_actor_concrete_actor(self);
+
+    core_packer_init(&packer, CORE_PACKER_OPERATION_UNPACK, thorium_message_buffer(message));
+    core_packer_process_int(&packer, &range_index);
+    core_packer_process_uint64_t(&packer, &entries);
+    core_packer_destroy(&packer);
+
+    core_vector_set(&concrete_self->range_entries, range_index, &entries);
+
+    biosal_input_controller_send_next_range(self, thorium_message_source(message));
+}
+
+static void biosal_input_controller_send_next_range(struct thorium_actor *self, int stream)
+{
+    struct biosal_input_controller *concrete_self;
+    struct core_packer packer;
+    struct thorium_message new_message;
+    char *file;
+    char *new_buffer;
+    int new_count;
+    int range_index;
+    int file_index;
+    uint64_t start;
+    uint64_t end;
+
+    concrete_self = thorium_actor_concrete_actor(self);
+
+    if (concrete_self->next_range == core_vector_size(&concrete_self->range_files)) {
+        ++concrete_self->finished_streams;
+
+        if (concrete_self->finished_streams == core_vector_size(&concrete_self->reading_streams)
+                        && concrete_self->state == BIOSAL_INPUT_CONTROLLER_STATE_SPAWN_STREAMING_STREAMS) {
+            biosal_input_controller_seal_stores(self);
+        }
+
+        return;
+    }
+
+    range_index = concrete_self->next_range++;
+    file_index = core_vector_at_as_int(&concrete_self->range_files, range_index);
+    file = core_vector_at_as_char_pointer(&concrete_self->files, file_index);
+    start = core_vector_at_as_uint64_t(&concrete_self->range_starts, range_index);
+    end = core_vector_at_as_uint64_t(&concrete_self->range_ends, range_index);
+
+    core_packer_init(&packer, CORE_PACKER_OPERATION_PACK_SIZE, NULL);
+    core_packer_process_int(&packer, &range_index);
+    core_packer_process_uint64_t(&packer, &start);
+    core_packer_process_uint64_t(&packer, &end);
+    core_packer_process_int(&packer, &concrete_self->block_size);
+    new_count = core_packer_get_byte_count(&packer) + strlen(file) + 1;
+    core_packer_destroy(&packer);
+
+    new_buffer = thorium_actor_allocate(self, new_count);
+
+    core_packer_init(&packer, CORE_PACKER_OPERATION_PACK, new_buffer);
+    core_packer_process_int(&packer, &range_index);
+    core_packer_process_uint64_t(&packer, &start);
+    core_packer_process_uint64_t(&packer, &end);
+    core_packer_process_int(&packer, &concrete_self->block_size);
+    strcpy(new_buffer + core_packer_get_byte_count(&packer), file);
+    core_packer_destroy(&packer);
+
+    thorium_message_init(&new_message, ACTION_INPUT_STREAM_PUSH_RANGE, new_count, new_buffer);
+    thorium_actor_send(self, stream, &new_message);
+    thorium_message_destroy(&new_message);
+}
+
+/*
+ * All the ranges are in the stores. The global index of the first
+ * sequence of each range is the sum of the sequences in the ranges
+ * before it, so it is only computed now.
+ */
+static void biosal_input_controller_seal_stores(struct thorium_actor *self)
+{
+    struct biosal_input_controller *concrete_self;
+    uint64_t first;
+    uint64_t entries;
+    int file_index;
+    int i;
+
+    concrete_self = thorium_actor_concrete_actor(self);
+    concrete_self->state = BIOSAL_INPUT_CONTROLLER_STATE_NONE;
+
+    first = 0;
+
+    for (i = 0; i < core_vector_size(&concrete_self->range_entries); i++) {
+        file_index = core_vector_at_as_int(&concrete_self->range_files, i);
+        entries = core_vector_at_as_uint64_t(&concrete_self->range_entries, i);
+
+        thorium_actor_log(self, "range %d file %s first sequence %" PRIu64 " sequences %" PRIu64 "\n",
+                        i, core_vector_at_as_char_pointer(&concrete_self->files, file_index),
+                        first, entries);
+
+        first += entries;
+    }
+
+    thorium_actor_log(self, "single-pass input: %" PRIu64 " sequences\n", first);
+
+    if (first == 0) {
+        core_timer_stop(&concrete_self->input_timer);
+        core_timer_stop(&concrete_self->distribution_timer);
+
+        thorium_actor_log(self, "Error: no sequence in the input files\n");
+        thorium_actor_send_to_supervisor_empty(self, ACTION_INPUT_DISTRIBUTE_REPLY);
+        return;
+    }
+
+    /*
+     * Each store replies with ACTION_SEQUENCE_STORE_READY.
+     */
+    thorium_actor_send_range_empty(self, &concrete_self->consumers, ACTION_SEQUENCE_STORE_SEAL);
+}
@@ -52,6 +52,18 @@ struct biosal_input_controller {
     struct core_timer distribution_timer;
 
     struct core_vector consumer_active_requests;
+
+    /*
+     * Single-pass input: the files are split in ranges that are
+     * given to the streams on demand.
+     */
+    int single_pass;
+    struct core_vector range_files;
+    struct core_vector range_starts;
+    struct core_vector range_ends;
+    struct core_vector range_entries;
+    int next_range;
+    int finished_streams;
 };
 
 #define ACTION_INPUT_DISTRIBUTE 0x00003cbe
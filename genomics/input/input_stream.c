@@ -4,14 +4,18 @@
 #include "input_command.h"
 #include "mega_block.h"
 
+#include <genomics/formats/record_splitter.h>
+
 #include <genomics/data/dna_sequence.h>
 #include <genomics/storage/sequence_store.h>
 
 #include <core/file_storage/file.h>
+#include <core/file_storage/input/buffered_reader.h>
 
 #include <engine/thorium/modules/message_helper.h>
 
 #include <core/system/memory.h>
+#include <core/system/packer.h>
 
 #include <stdlib.h>
 #include <stdio.h>
@@ -30,6 +34,12 @@
 
 #define MEMORY_INPUT_STREAM SCRIPT_INPUT_STREAM
 
+/*
+ * Single-pass input: number of blocks that a stream can have in
+ * flight (sent to stores, not acknowledged yet).
+ */
+#define SINGLE_PASS_CREDITS 4
+
 void biosal_input_stream_init(struct thorium_actor *actor);
 void biosal_input_stream_destroy(struct thorium_actor *actor);
 void biosal_input_stream_receive(struct thorium_actor *actor, struct thorium_message *message);
@@ -57,6 +67,12 @@ void biosal_input_stream_spawn_reply(struct thorium_actor *self, struct thorium_
 void biosal_input_stream_open_reply(struct thorium_actor *self, struct thorium_message *message);
 void biosal_input_stream_set_offset_reply(struct thorium_actor *self, struct thorium_message *message);
 
+void biosal_input_stream_set_consumers(struct thorium_actor *self, struct thorium_message *message);
+void biosal_input_stream_push_range(struct thorium_actor *self, struct thorium_message *message);
+void biosal_input_stream_append_reply(struct thorium_actor *self, struct thorium_message *message);
+static void biosal_input_stream_append_block(struct thorium_actor *self);
+static void biosal_input_stream_finish_range(struct thorium_actor *self);
+
 struct thorium_script biosal_input_stream_script = {
     .identifier = SCRIPT_INPUT_STREAM,
     .init = biosal_input_stream_init,
@@ -147,6 +163,22 @@ void biosal_input_stream_init(struct thorium_actor *actor)
 
     core_vector_init(&concrete_self->parallel_mega_blocks, sizeof(struct core_vector));
 
+    /*
+     * Single-pass input.
+     */
+    core_vector_init(&concrete_self->stores, sizeof(int));
+    concrete_self->next_store = 0;
+    concrete_self->block_size = 0;
+    concrete_self->credits = SINGLE_PASS_CREDITS;
+    concrete_self->range_index = -1;
+    concrete_self->range_done = 1;
+    concrete_self->range_entries = 0;
+
+    thorium_actor_add_action(actor, ACTION_SET_CONSUMERS, biosal_input_stream_set_consumers);
+    thorium_actor_add_action(actor, ACTION_INPUT_STREAM_PUSH_RANGE, biosal_input_stream_push_range);
+    thorium_actor_add_action(actor, ACTION_SEQUENCE_STORE_APPEND_REPLY,
+                    biosal_input_stream_append_reply);
+
     thorium_actor_log(self, "is now online on node %d",
                     thorium_actor_node_name(actor));
 }
@@ -192,6 +224,8 @@ void biosal_input_stream_destroy(struct thorium_actor *actor)
     core_vector_destroy(&concrete_self->start_offsets);
     core_vector_destroy(&concrete_self->end_offsets);
     core_vector_destroy(&concrete_self->parallel_mega_blocks);
+
+    core_vector_destroy(&concrete_self->stores);
 }
 
 void biosal_input_stream_receive(struct thorium_actor *actor, struct thorium_message *message)
@@ -764,38 +798,36 @@ void biosal_input_stream_count_in_parallel(struct thorium_actor *self, struct th
 
     file = concrete_self->file_name;
 
-    file_size = core_file_get_size(file);
+    /*
+     * Compressed files are split in uncompressed bytes (BGZF files only).
+     */
+    if (!core_buffered_reader_get_content_size(file, &file_size)) {
+        file_size = core_file_get_size(file);
+    }
 
     thorium_actor_log(self, "COUNT_IN_PARALLEL %s %" PRIu64 "",
                     file, file_size);
 
-    start_offset = 0;
-
-    i = 0;
-    while (start_offset < file_size) {
-
-        end_offset = start_offset + parallel_block_size - 1;
-
-        if (end_offset > file_size - 1 || end_offset < start_offset) {
-            end_offset = file_size - 1;
-        }
+    /*
+     * The ranges start on records, so that each stream parses
+     * a disjoint set of records.
+     */
+    biosal_record_splitter_split(file, (file_size + parallel_block_size - 1) / parallel_block_size,
+                    &concrete_self->start_offsets, &concrete_self->end_offsets);
 
+    size = core_vector_size(&concrete_self->start_offsets);
 
-        core_vector_push_back_uint64_t(&concrete_self->start_offsets, start_offset);
-        core_vector_push_back_uint64_t(&concrete_self->end_offsets, end_offset);
+    for (i = 0; i < size; i++) {
+        start_offset = core_vector_at_as_uint64_t(&concrete_self->start_offsets, i);
+        end_offset = core_vector_at_as_uint64_t(&concrete_self->end_offsets, i);
 
         thorium_actor_log(self, "DEBUG PARALLEL BLOCK %s %i %" PRIu64 " %" PRIu64 "",
                         file,
                         i,
                         start_offset,
                         end_offset);
-
-        start_offset = end_offset + 1;
-        ++i;
     }
 
-    size = core_vector_size(&concrete_self->start_offsets);
-
     thorium_actor_add_action(self, ACTION_SPAWN_REPLY, biosal_input_stream_spawn_reply);
 
     thorium_actor_log(self, "DEBUG spawns %d streams for counting",
@@ -1117,3 +1149,196 @@ void biosal_input_stream_set_offset_reply(struct thorium_actor *self, struct tho
                         concrete_self->file_name);
     }
 }
+
+void biosal_input_stream_set_consumers(struct thorium_actor *self, struct thorium_message *message)
+{
+    struct biosal_input_stream *concrete_self;
+
+    concrete_self = thorium_actor_concrete_actor(self);
+
+    core_vector_clear(&concrete_self->stores);
+    core_vector_unpack(&concrete_self->stores, thorium_message_buffer(message));
+
+    /*
+     * Streams do not all start with the same store.
+     */
+    concrete_self->next_store = 0;
+
+    if (core_vector_size(&concrete_self->stores) > 0) {
+        concrete_self->next_store = thorium_actor_name(self) % core_vector_size(&concrete_self->stores);
+    }
+
+    thorium_actor_send_reply_empty(self, ACTION_SET_CONSUMERS_REPLY);
+}
+
+void biosal_input_stream_push_range(struct thorium_actor *self, struct thorium_message *message)
+{
+    struct biosal_input_stream *concrete_self;
+    struct core_packer packer;
+    char *file_name;
+
+    concrete_self = thorium_actor_concrete_actor(self);
+
+    core_packer_init(&packer, CORE_PACKER_OPERATION_UNPACK, thorium_message_buffer(message));
+    core_packer_process_int(&packer, &concrete_self->range_index);
+    core_packer_process_uint64_t(&packer, &concrete_self->starting_offset);
+    core_packer_process_uint64_t(&packer, &concrete_self->ending_offset);
+    core_packer_process_int(&packer, &concrete_self->block_size);
+    file_name = (char *)thorium_message_buffer(message) + core_packer_get_byte_count(&packer);
+    core_packer_destroy(&packer);
+
+    if (concrete_self->file_name != NULL) {
+        core_memory_free(concrete_self->file_name, MEMORY_INPUT_STREAM);
+    }
+
+    concrete_self->file_name = core_memory_allocate(strlen(file_name) + 1, MEMORY_INPUT_STREAM);
+    strcpy(concrete_self->file_name, file_name);
+
+    if (concrete_self->buffer_for_sequence == NULL) {
+        concrete_self->maximum_sequence_length = BIOSAL_INPUT_MAXIMUM_SEQUENCE_LENGTH;
+        concrete_self->buffer_for_sequence = core_memory_allocate(concrete_self->maximum_sequence_length,
+                        MEMORY_INPUT_STREAM);
+    }
+
+    if (concrete_self->proxy_ready) {
+        biosal_input_proxy_destroy(&concrete_self->proxy);
+    }
+
+    biosal_input_proxy_init(&concrete_self->proxy, concrete_self->file_name,
+                    concrete_self->starting_offset, concrete_self->ending_offset);
+
+    concrete_self->proxy_ready = 1;
+    concrete_self->open = 1;
+    concrete_self->controller = thorium_message_source(message);
+
+    concrete_self->range_done = 0;
+    concrete_self->range_entries = 0;
+
+    thorium_actor_log(self, "(node/%d) pushes range %d of file %s (%" PRIu64 " to %" PRIu64 ")",
+                    thorium_actor_node_name(self), concrete_self->range_index,
+                    concrete_self->file_name, concrete_self->starting_offset,
+                    concrete_self->ending_offset);
+
+    if (biosal_input_stream_has_error(self, message)) {
+        thorium_actor_log(self, "Error: can not read file %s (error %d)",
+                        concrete_self->file_name, concrete_self->error);
+
+        concrete_self->range_done = 1;
+    }
+
+    /*
+     * Send up to one block per credit. The next blocks are
+     * sent when the stores acknowledge these ones.
+     */
+    while (!concrete_self->range_done && concrete_self->credits > 0) {
+        biosal_input_stream_append_block(self);
+    }
+
+    if (concrete_self->range_done && concrete_self->credits == SINGLE_PASS_CREDITS) {
+        biosal_input_stream_finish_range(self);
+    }
+}
+
+void biosal_input_stream_append_reply(struct thorium_actor *self, struct thorium_message *message)
+{
+    struct biosal_input_stream *concrete_self;
+
+    concrete_self = thorium_actor_concrete_actor(self);
+
+    ++concrete_self->credits;
+
+    if (!concrete_self->range_done) {
+        biosal_input_stream_append_block(self);
+    }
+
+    if (concrete_self->range_done && concrete_self->credits == SINGLE_PASS_CREDITS) {
+        biosal_input_stream_finish_range(self);
+    }
+}
+
+/*
+ * Parse at most block_size sequences and append them to the next store.
+ */
+static void biosal_input_stream_append_block(struct thorium_actor *self)
+{
+    struct biosal_input_stream *concrete_self;
+    struct biosal_input_command command;
+    struct biosal_dna_sequence dna_sequence;
+    struct core_memory_pool *ephemeral_memory;
+    struct thorium_message new_message;
+    void *new_buffer;
+    int new_count;
+    int store;
+    int entries;
+
+    concrete_self = thorium_actor_concrete_actor(self);
+    ephemeral_memory = thorium_actor_get_ephemeral_memory(self);
+
+    store = core_vector_at_as_int(&concrete_self->stores, concrete_self->next_store);
+
+    biosal_input_command_init(&command, store, 0, 0, ephemeral_memory);
+
+    entries = 0;
+
+    while (entries < concrete_self->block_size) {
+
+        if (!biosal_input_proxy_get_sequence(&concrete_self->proxy,
+                                concrete_self->buffer_for_sequence)) {
+            concrete_self->range_done = 1;
+            break;
+        }
+
+        biosal_dna_sequence_init(&dna_sequence, concrete_self->buffer_for_sequence,
+                        &concrete_self->codec, ephemeral_memory);
+
+        biosal_input_command_add_entry(&command, &dna_sequence, &concrete_self->codec,
+                        ephemeral_memory);
+
+        biosal_dna_sequence_destroy(&dna_sequence, ephemeral_memory);
+
+        ++entries;
+    }
+
+    if (entries > 0) {
+        new_count = biosal_input_command_pack_size(&command, &concrete_self->codec);
+        new_buffer = thorium_actor_allocate(self, new_count);
+        biosal_input_command_pack(&command, new_buffer, &concrete_self->codec);
+
+        thorium_message_init(&new_message, ACTION_SEQUENCE_STORE_APPEND, new_count, new_buffer);
+        thorium_actor_send(self, store, &new_message);
+        thorium_message_destroy(&new_message);
+
+        --concrete_self->credits;
+        concrete_self->range_entries += entries;
+
+        ++concrete_self->next_store;
+        concrete_self->next_store %= core_vector_size(&concrete_self->stores);
+    }
+
+    biosal_input_command_destroy(&command, ephemeral_memory);
+}
+
+/*
+ * All the sequences of the range are in the stores.
+ */
+static void biosal_input_stream_finish_range(struct thorium_actor *self)
+{
+    struct biosal_input_stream *concrete_self;
+    struct core_packer packer;
+    char buffer[sizeof(int) + sizeof(uint64_t)];
+    int count;
+
+    concrete_self = thorium_actor_concrete_actor(self);
+
+    core_packer_init(&packer, CORE_PACKER_OPERATION_PACK, buffer);
+    core_packer_process_int(&packer, &concrete_self->range_index);
+    core_packer_process_uint64_t(&packer, &concrete_self->range_entries);
+    count = core_packer_get_byte_count(&packer);
+    core_packer_destroy(&packer);
+
+    thorium_actor_log(self, "pushed %" PRIu64 " sequences for range %d",
+                    concrete_self->range_entries, concrete_self->range_index);
+
+    thorium_actor_send_buffer(self, concrete_self->controller,
+                    ACTION_INPUT_STREAM_PUSH_RANGE_REPLY, count, buffer);
+}
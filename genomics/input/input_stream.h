@@ -56,6 +56,18 @@ struct biosal_input_stream {
     struct core_vector start_offsets;
     struct core_vector end_offsets;
     struct core_vector parallel_mega_blocks;
+
+    /*
+     * Single-pass input: sequences are appended to the stores
+     * while the ranges are parsed.
+     */
+    struct core_vector stores;
+    int next_store;
+    int block_size;
+    int credits;
+    int range_index;
+    int range_done;
+    uint64_t range_entries;
 };
 
 #define ACTION_INPUT_OPEN 0x000075fa
@@ -86,6 +98,18 @@ struct biosal_input_stream {
 #define ACTION_INPUT_COUNT_IN_PARALLEL 0x00001ce9
 #define ACTION_INPUT_COUNT_IN_PARALLEL_REPLY 0x000058ea
 
+/*
+ * Parse a range of a file and append its sequences to the stores
+ * (set with ACTION_SET_CONSUMERS).
+ *
+ * The buffer contains the range index (int), the start and end
+ * offsets (uint64_t), the block size in sequences (int) and the file
+ * name. The reply contains the range index (int) and the number of
+ * sequences in the range (uint64_t).
+ */
+#define ACTION_INPUT_STREAM_PUSH_RANGE 0x00002d9b
+#define ACTION_INPUT_STREAM_PUSH_RANGE_REPLY 0x000077c4
+
 extern struct thorium_script biosal_input_stream_script;
 
 #endif
@@ -312,8 +312,8 @@ void biosal_aggregator_aggregate_kernel_output(struct thorium_actor *self, struc
     int entries;
     struct biosal_dna_kmer_block input_block;
     struct biosal_dna_kmer_frequency_block *output_block;
-    struct core_vector *kmers;
     struct core_memory_pool *ephemeral_memory;
+    struct biosal_dna_kmer kmer_view;
     struct biosal_dna_kmer *kmer;
     int source;
     void *buffer;
@@ -362,8 +362,7 @@ void biosal_aggregator_aggregate_kernel_output(struct thorium_actor *self, struc
      * classify the kmers according to their ownership
      */
 
-    kmers = biosal_dna_kmer_block_kmers(&input_block);
-    entries = core_vector_size(kmers);
+    entries = biosal_dna_kmer_block_size(&input_block);
 
     customer_count = core_vector_size(&concrete_actor->consumers);
 
@@ -385,7 +384,8 @@ void biosal_aggregator_aggregate_kernel_output(struct thorium_actor *self, struc
 
 
     for (i = 0; i < entries; i++) {
-        kmer = (struct biosal_dna_kmer *)core_vector_at(kmers, i);
+        biosal_dna_kmer_block_get_kmer(&input_block, i, &kmer_view);
+        kmer = &kmer_view;
 
         /*
         biosal_dna_kmer_print(kmer);
@@ -7,6 +7,7 @@
 
 #include <genomics/data/dna_kmer.h>
 #include <genomics/data/dna_kmer_block.h>
+#include <genomics/data/dna_kmer_extractor.h>
 #include <genomics/data/dna_sequence.h>
 
 #include <genomics/input/input_command.h>
@@ -598,7 +599,6 @@ void biosal_dna_kmer_counter_kernel_notify_reply(struct thorium_actor *actor, st
 void biosal_dna_kmer_counter_kernel_push_sequence_data_block(struct thorium_actor *actor, struct thorium_message *message)
 {
     int source;
-    struct biosal_dna_kmer kmer;
     int name;
     struct biosal_input_command payload;
     void *buffer;
@@ -608,19 +608,16 @@ void biosal_dna_kmer_counter_kernel_push_sequence_data_block(struct thorium_acto
     int consumer;
     int i;
     struct biosal_dna_sequence *sequence;
-    char *sequence_data;
     struct core_vector *command_entries;
     int sequence_length;
     int new_count;
     void *new_buffer;
     struct thorium_message new_message;
-    int j;
-    int limit;
-    char saved;
     struct core_timer timer;
     struct biosal_dna_kmer_block block;
+    struct biosal_dna_kmer_extractor extractor;
+    void *encoded_kmer;
     int to_reserve;
-    int maximum_length;
     struct core_memory_pool *ephemeral_memory;
     int kmers_for_sequence;
 
@@ -670,9 +667,10 @@ void biosal_dna_kmer_counter_kernel_push_sequence_data_block(struct thorium_acto
                         concrete_actor->bytes_per_kmer);
 #endif
 
-    to_reserve = 0;
+    biosal_dna_kmer_extractor_init(&extractor, concrete_actor->kmer_length,
+                    &concrete_actor->codec, ephemeral_memory);
 
-    maximum_length = 0;
+    to_reserve = 0;
 
     for (i = 0; i < entries; i++) {
 
@@ -680,68 +678,52 @@ void biosal_dna_kmer_counter_kernel_push_sequence_data_block(struct thorium_acto
 
         sequence_length = biosal_dna_sequence_length(sequence);
 
-        if (sequence_length > maximum_length) {
-            maximum_length = sequence_length;
-        }
-
-        to_reserve += (sequence_length - concrete_actor->kmer_length + 1);
+        to_reserve += biosal_dna_kmer_extractor_count(&extractor, sequence_length);
     }
 
-    biosal_dna_kmer_block_init(&block, concrete_actor->kmer_length, source_index, to_reserve,
-                    ephemeral_memory);
+    /*
+     * The block is written directly in the buffer of the outbound message.
+     */
+    new_count = biosal_dna_kmer_block_get_packed_size(concrete_actor->kmer_length,
+                    to_reserve, 0, &concrete_actor->codec);
+    new_buffer = thorium_actor_allocate(actor, new_count);
 
-    sequence_data = core_memory_pool_allocate(ephemeral_memory, maximum_length + 1);
+    biosal_dna_kmer_block_init_with_buffer(&block, new_buffer, concrete_actor->kmer_length,
+                    source_index, to_reserve, 0, &concrete_actor->codec);
 
     /* extract kmers
+     *
+     * The extractor works directly on the encoded sequence and
+     * writes each canonical kmer in the message buffer.
      */
     for (i = 0; i < entries; i++) {
 
-        /* TODO improve this */
         sequence = (struct biosal_dna_sequence *)core_vector_at(command_entries, i);
 
-        biosal_dna_sequence_get_sequence(sequence, sequence_data,
-                        &concrete_actor->codec);
-
-        sequence_length = biosal_dna_sequence_length(sequence);
-        limit = sequence_length - concrete_actor->kmer_length + 1;
+        biosal_dna_kmer_extractor_set_sequence(&extractor, sequence);
 
         kmers_for_sequence = 0;
 
-        for (j = 0; j < limit; j++) {
-            saved = sequence_data[j + concrete_actor->kmer_length];
-            sequence_data[j + concrete_actor->kmer_length] = '\0';
-
-            biosal_dna_kmer_init(&kmer, sequence_data + j,
-                            &concrete_actor->codec, thorium_actor_get_ephemeral_memory(actor));
+        while (biosal_dna_kmer_extractor_next(&extractor)) {
 
-#ifdef BIOSAL_KMER_COUNTER_KERNEL_DEBUG_LEVEL_2
-            printf("KERNEL kmer %d,%d %s\n", i, j, sequence_data + j);
-#endif
-
-            /*
-             * add kmer in block
-             */
-            biosal_dna_kmer_block_add_kmer(&block, &kmer, thorium_actor_get_ephemeral_memory(actor),
+            encoded_kmer = biosal_dna_kmer_block_add_encoded_kmer(&block, ephemeral_memory,
                             &concrete_actor->codec);
 
-            biosal_dna_kmer_destroy(&kmer, thorium_actor_get_ephemeral_memory(actor));
-
-            sequence_data[j + concrete_actor->kmer_length] = saved;
+            biosal_dna_kmer_extractor_get_canonical_kmer(&extractor, encoded_kmer);
 
             ++kmers_for_sequence;
         }
 
 #ifdef BIOSAL_PRIVATE_DEBUG_EMIT
         printf("DEBUG EMIT KMERS INPUT: %d nucleotides, k: %d output %d kmers\n",
-                        sequence_length, concrete_actor->kmer_length,
+                        biosal_dna_sequence_length(sequence), concrete_actor->kmer_length,
                         kmers_for_sequence);
 #endif
 
         concrete_actor->kmers += kmers_for_sequence;
     }
 
-    core_memory_pool_free(ephemeral_memory, sequence_data);
-    sequence_data = NULL;
+    biosal_dna_kmer_extractor_destroy(&extractor);
 
 #ifdef BIOSAL_KMER_COUNTER_KERNEL_DEBUG
     BIOSAL_DEBUG_MARKER("after generating kmers\n");
@@ -762,12 +744,6 @@ void biosal_dna_kmer_counter_kernel_push_sequence_data_block(struct thorium_acto
         printf("consumer is %d\n", consumer);
 #endif
 
-    new_count = biosal_dna_kmer_block_pack_size(&block,
-                    &concrete_actor->codec);
-    new_buffer = thorium_actor_allocate(actor, new_count);
-    biosal_dna_kmer_block_pack(&block, new_buffer,
-                        &concrete_actor->codec);
-
 #ifdef BIOSAL_KMER_COUNTER_KERNEL_DEBUG
     printf("name %d destination %d PACK with %d bytes\n", name,
                        consumer, new_count);
@@ -0,0 +1,596 @@
+
+#include "compact_kmer_table.h"
+
+#include <core/system/memory_pool.h>
+#include <core/system/memory.h>
+#include <core/system/debugger.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+#define BIOSAL_COMPACT_KMER_TABLE_INITIAL_CAPACITY 1024
+#define BIOSAL_COMPACT_KMER_TABLE_DEFAULT_THRESHOLD 0.9
+
+/*
+ * A distance byte is 0 for an empty slot, or 1 + the distance
+ * to the home slot.
+ */
+#define BIOSAL_COMPACT_KMER_TABLE_EMPTY 0
+#define BIOSAL_COMPACT_KMER_TABLE_MAXIMUM_DISTANCE 254
+
+/*
+ * A counter with this value means that the count is in the
+ * overflow table.
+ */
+#define BIOSAL_COMPACT_KMER_TABLE_SATURATED 255
+
+#define BIOSAL_COMPACT_KMER_TABLE_MAXIMUM_KEY_SIZE 512
+
+#define BYTES_PER_WORD 8
+
+static void biosal_compact_kmer_table_allocate(struct biosal_compact_kmer_table *self,
+                uint64_t capacity);
+static void biosal_compact_kmer_table_free(struct biosal_compact_kmer_table *self);
+static void biosal_compact_kmer_table_grow(struct biosal_compact_kmer_table *self);
+static inline uint64_t biosal_compact_kmer_table_load(uint8_t *bytes, int size);
+static inline void biosal_compact_kmer_table_store(uint8_t *bytes, int size, uint64_t value);
+static inline uint64_t biosal_compact_kmer_table_mix(uint64_t value);
+static inline uint64_t biosal_compact_kmer_table_unmix(uint64_t value);
+static inline uint64_t biosal_compact_kmer_table_hash_rest(uint8_t *rest, int size);
+static inline uint64_t biosal_compact_kmer_table_hash(struct biosal_compact_kmer_table *self,
+                uint8_t *key);
+static inline uint64_t biosal_compact_kmer_table_slot_hash(struct biosal_compact_kmer_table *self,
+                uint64_t slot);
+static int biosal_compact_kmer_table_find(struct biosal_compact_kmer_table *self, uint64_t hash,
+                uint8_t *rest, uint64_t *slot);
+static void biosal_compact_kmer_table_insert(struct biosal_compact_kmer_table *self, uint64_t hash,
+                uint8_t *rest, uint8_t counter);
+static int biosal_compact_kmer_table_add_to_slot(struct biosal_compact_kmer_table *self,
+                uint64_t slot, void *key, int count);
+
+void biosal_compact_kmer_table_init(struct biosal_compact_kmer_table *self, int key_size,
+                struct core_memory_pool *memory)
+{
+    CORE_DEBUGGER_ASSERT(key_size > 0);
+    CORE_DEBUGGER_ASSERT(key_size <= BIOSAL_COMPACT_KMER_TABLE_MAXIMUM_KEY_SIZE);
+
+    self->key_size = key_size;
+    self->rest_size = 0;
+
+    if (key_size > BYTES_PER_WORD) {
+        self->rest_size = key_size - BYTES_PER_WORD;
+    }
+
+    self->memory = memory;
+    self->threshold = BIOSAL_COMPACT_KMER_TABLE_DEFAULT_THRESHOLD;
+    self->next_capacity = 0;
+    self->size = 0;
+
+    biosal_compact_kmer_table_allocate(self, BIOSAL_COMPACT_KMER_TABLE_INITIAL_CAPACITY);
+
+    biosal_kmer_table_init(&self->overflow, key_size, sizeof(int), memory);
+}
+
+void biosal_compact_kmer_table_destroy(struct biosal_compact_kmer_table *self)
+{
+    biosal_compact_kmer_table_free(self);
+    biosal_kmer_table_destroy(&self->overflow);
+
+    self->size = 0;
+    self->capacity = 0;
+    self->resize_size = 0;
+}
+
+static void biosal_compact_kmer_table_allocate(struct biosal_compact_kmer_table *self,
+                uint64_t capacity)
+{
+    CORE_DEBUGGER_ASSERT((capacity & (capacity - 1)) == 0);
+
+    self->capacity = capacity;
+    self->mask = capacity - 1;
+    self->resize_size = (uint64_t)(capacity * self->threshold);
+
+    self->quotient_bits = 0;
+
+    while (((uint64_t)1 << self->quotient_bits) < capacity) {
+        ++self->quotient_bits;
+    }
+
+    self->remainder_size = (64 - self->quotient_bits + 7) / 8;
+    self->entry_size = self->remainder_size + self->rest_size;
+
+    self->distances = core_memory_pool_allocate(self->memory, capacity);
+    memset(self->distances, BIOSAL_COMPACT_KMER_TABLE_EMPTY, capacity);
+
+    self->counters = core_memory_pool_allocate(self->memory, capacity);
+    self->entries = core_memory_pool_allocate(self->memory, capacity * self->entry_size);
+}
+
+static void biosal_compact_kmer_table_free(struct biosal_compact_kmer_table *self)
+{
+    if (self->distances == NULL) {
+        return;
+    }
+
+    core_memory_pool_free(self->memory, self->distances);
+    core_memory_pool_free(self->memory, self->counters);
+    core_memory_pool_free(self->memory, self->entries);
+
+    self->distances = NULL;
+    self->counters = NULL;
+    self->entries = NULL;
+}
+
+/*
+ * The hash of an entry is rebuilt from its slot and its remainder,
+ * so the keys are not needed to move the entries.
+ */
+static void biosal_compact_kmer_table_grow(struct biosal_compact_kmer_table *self)
+{
+    struct biosal_compact_kmer_table old_table;
+    uint64_t capacity;
+    uint64_t slot;
+
+    old_table = *self;
+
+    capacity = self->capacity * 2;
+
+    while (capacity < self->next_capacity) {
+        capacity *= 2;
+    }
+
+    biosal_compact_kmer_table_allocate(self, capacity);
+
+    for (slot = 0; slot < old_table.capacity; ++slot) {
+
+        if (old_table.distances[slot] == BIOSAL_COMPACT_KMER_TABLE_EMPTY) {
+            continue;
+        }
+
+        biosal_compact_kmer_table_insert(self,
+                        biosal_compact_kmer_table_slot_hash(&old_table, slot),
+                        old_table.entries + slot * old_table.entry_size + old_table.remainder_size,
+                        old_table.counters[slot]);
+    }
+
+    biosal_compact_kmer_table_free(&old_table);
+}
+
+static inline uint64_t biosal_compact_kmer_table_load(uint8_t *bytes, int size)
+{
+    uint64_t value;
+    int i;
+
+    value = 0;
+
+    for (i = 0; i < size; ++i) {
+        value |= (uint64_t)bytes[i] << (i * 8);
+    }
+
+    return value;
+}
+
+static inline void biosal_compact_kmer_table_store(uint8_t *bytes, int size, uint64_t value)
+{
+    int i;
+
+    for (i = 0; i < size; ++i) {
+        bytes[i] = (uint8_t)(value >> (i * 8));
+    }
+}
+
+/*
+ * The 64-bit finalizer of MurmurHash3, which is a bijection.
+ */
+static inline uint64_t biosal_compact_kmer_table_mix(uint64_t value)
+{
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdULL;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53ULL;
+    value ^= value >> 33;
+
+    return value;
+}
+
+/*
+ * The inverse of biosal_compact_kmer_table_mix. The multipliers are
+ * the inverses modulo 2^64 of the ones above, and x ^ (x >> 33) is
+ * its own inverse.
+ */
+static inline uint64_t biosal_compact_kmer_table_unmix(uint64_t value)
+{
+    value ^= value >> 33;
+    value *= 0x9cb4b2f8129337dbULL;
+    value ^= value >> 33;
+    value *= 0x4f74430c22a54005ULL;
+    value ^= value >> 33;
+
+    return value;
+}
+
+static inline uint64_t biosal_compact_kmer_table_hash_rest(uint8_t *rest, int size)
+{
+    uint64_t hash;
+    int i;
+    int length;
+
+    hash = 0x9ae16a3b2f90404fULL;
+
+    for (i = 0; i < size; i += BYTES_PER_WORD) {
+
+        length = size - i;
+
+        if (length > BYTES_PER_WORD) {
+            length = BYTES_PER_WORD;
+        }
+
+        hash = (hash ^ biosal_compact_kmer_table_load(rest + i, length)) * 0x87c37b91114253d5ULL;
+        hash = (hash << 31) | (hash >> 33);
+    }
+
+    return biosal_compact_kmer_table_mix(hash);
+}
+
+/*
+ * The hash is invertible when the rest of the key is known.
+ */
+static inline uint64_t biosal_compact_kmer_table_hash(struct biosal_compact_kmer_table *self,
+                uint8_t *key)
+{
+    uint64_t first;
+
+    if (self->rest_size == 0) {
+        return biosal_compact_kmer_table_mix(biosal_compact_kmer_table_load(key, self->key_size));
+    }
+
+    first = biosal_compact_kmer_table_load(key, BYTES_PER_WORD);
+    first ^= biosal_compact_kmer_table_hash_rest(key + BYTES_PER_WORD, self->rest_size);
+
+    return biosal_compact_kmer_table_mix(first);
+}
+
+static inline uint64_t biosal_compact_kmer_table_slot_hash(struct biosal_compact_kmer_table *self,
+                uint64_t slot)
+{
+    uint64_t home;
+    uint64_t remainder;
+
+    home = (slot - (self->distances[slot] - 1)) & self->mask;
+    remainder = biosal_compact_kmer_table_load(self->entries + slot * self->entry_size,
+                    self->remainder_size);
+
+    return (remainder << self->quotient_bits) | home;
+}
+
+/*
+ * With Robin Hood insertion, the search stops at the first entry
+ * that is closer to its home slot than the key would be.
+ */
+static int biosal_compact_kmer_table_find(struct biosal_compact_kmer_table *self, uint64_t hash,
+                uint8_t *rest, uint64_t *slot)
+{
+    uint8_t entry[BIOSAL_COMPACT_KMER_TABLE_MAXIMUM_KEY_SIZE];
+    uint64_t index;
+    int distance;
+    int stored;
+
+    biosal_compact_kmer_table_store(entry, self->remainder_size, hash >> self->quotient_bits);
+
+    if (self->rest_size > 0) {
+        memcpy(entry + self->remainder_size, rest, self->rest_size);
+    }
+
+    index = hash & self->mask;
+    distance = 0;
+
+    while (1) {
+
+        stored = self->distances[index];
+
+        if (stored == BIOSAL_COMPACT_KMER_TABLE_EMPTY || stored - 1 < distance) {
+            return 0;
+        }
+
+        if (stored - 1 == distance
+                && memcmp(self->entries + index * self->entry_size, entry, self->entry_size) == 0) {
+            *slot = index;
+            return 1;
+        }
+
+        index = (index + 1) & self->mask;
+        ++distance;
+    }
+
+    return 0;
+}
+
+/*
+ * Robin Hood insertion: the entry takes the slot of any entry that is
+ * closer to its home slot, and that entry is inserted further.
+ * The table grows if an entry would be too far from its home slot.
+ */
+static void biosal_compact_kmer_table_insert(struct biosal_compact_kmer_table *self, uint64_t hash,
+                uint8_t *rest, uint8_t counter)
+{
+    uint8_t carried_rest[BIOSAL_COMPACT_KMER_TABLE_MAXIMUM_KEY_SIZE];
+    uint8_t displaced_rest[BIOSAL_COMPACT_KMER_TABLE_MAXIMUM_KEY_SIZE];
+    uint64_t index;
+    uint64_t displaced_hash;
+    uint8_t displaced_counter;
+    uint8_t *entry;
+    int distance;
+    int stored;
+
+    if (self->rest_size > 0) {
+        memcpy(carried_rest, rest, self->rest_size);
+    }
+
+    index = hash & self->mask;
+    distance = 0;
+
+    while (1) {
+
+        stored = self->distances[index];
+        entry = self->entries + index * self->entry_size;
+
+        if (stored == BIOSAL_COMPACT_KMER_TABLE_EMPTY || stored - 1 < distance) {
+
+            displaced_hash = 0;
+            displaced_counter = 0;
+
+            if (stored != BIOSAL_COMPACT_KMER_TABLE_EMPTY) {
+                displaced_hash = biosal_compact_kmer_table_slot_hash(self, index);
+                displaced_counter = self->counters[index];
+
+                if (self->rest_size > 0) {
+                    memcpy(displaced_rest, entry + self->remainder_size, self->rest_size);
+                }
+            }
+
+            self->distances[index] = (uint8_t)(distance + 1);
+            self->counters[index] = counter;
+            biosal_compact_kmer_table_store(entry, self->remainder_size,
+                            hash >> self->quotient_bits);
+
+            if (self->rest_size > 0) {
+                memcpy(entry + self->remainder_size, carried_rest, self->rest_size);
+            }
+
+            if (stored == BIOSAL_COMPACT_KMER_TABLE_EMPTY) {
+                return;
+            }
+
+            hash = displaced_hash;
+            counter = displaced_counter;
+            distance = stored - 1;
+
+            if (self->rest_size > 0) {
+                memcpy(carried_rest, displaced_rest, self->rest_size);
+            }
+        }
+
+        index = (index + 1) & self->mask;
+        ++distance;
+
+        /*
+         * The carried entry is inserted again after the resize.
+         */
+        if (distance > BIOSAL_COMPACT_KMER_TABLE_MAXIMUM_DISTANCE) {
+            biosal_compact_kmer_table_grow(self);
+
+            index = hash & self->mask;
+            distance = 0;
+        }
+    }
+}
+
+/*
+ * Counts that do not fit in the counter go to the overflow table.
+ */
+static int biosal_compact_kmer_table_add_to_slot(struct biosal_compact_kmer_table *self,
+                uint64_t slot, void *key, int count)
+{
+    int counter;
+
+    counter = self->counters[slot];
+
+    if (counter == BIOSAL_COMPACT_KMER_TABLE_SATURATED) {
+        return biosal_kmer_table_increment(&self->overflow, key, count);
+    }
+
+    if (counter + count < BIOSAL_COMPACT_KMER_TABLE_SATURATED) {
+        self->counters[slot] = (uint8_t)(counter + count);
+        return counter + count;
+    }
+
+    self->counters[slot] = BIOSAL_COMPACT_KMER_TABLE_SATURATED;
+
+    return biosal_kmer_table_increment(&self->overflow, key, counter + count);
+}
+
+int biosal_compact_kmer_table_increment(struct biosal_compact_kmer_table *self, void *key, int count)
+{
+    uint64_t hash;
+    uint64_t slot;
+    uint8_t *rest;
+
+    CORE_DEBUGGER_ASSERT(count >= 0);
+
+    hash = biosal_compact_kmer_table_hash(self, key);
+    rest = (uint8_t *)key + BYTES_PER_WORD;
+
+    if (biosal_compact_kmer_table_find(self, hash, rest, &slot)) {
+        return biosal_compact_kmer_table_add_to_slot(self, slot, key, count);
+    }
+
+    if (self->size >= self->resize_size) {
+        biosal_compact_kmer_table_grow(self);
+    }
+
+    ++self->size;
+
+    if (count < BIOSAL_COMPACT_KMER_TABLE_SATURATED) {
+        biosal_compact_kmer_table_insert(self, hash, rest, (uint8_t)count);
+        return count;
+    }
+
+    biosal_compact_kmer_table_insert(self, hash, rest, BIOSAL_COMPACT_KMER_TABLE_SATURATED);
+
+    return biosal_kmer_table_increment(&self->overflow, key, count);
+}
+
+int biosal_compact_kmer_table_increment_existing(struct biosal_compact_kmer_table *self,
+                void *key, int count)
+{
+    uint64_t slot;
+
+    CORE_DEBUGGER_ASSERT(count >= 0);
+
+    if (!biosal_compact_kmer_table_find(self, biosal_compact_kmer_table_hash(self, key),
+                            (uint8_t *)key + BYTES_PER_WORD, &slot)) {
+        return 0;
+    }
+
+    return biosal_compact_kmer_table_add_to_slot(self, slot, key, count);
+}
+
+int biosal_compact_kmer_table_get(struct biosal_compact_kmer_table *self, void *key)
+{
+    uint64_t slot;
+    int *count;
+
+    if (!biosal_compact_kmer_table_find(self, biosal_compact_kmer_table_hash(self, key),
+                            (uint8_t *)key + BYTES_PER_WORD, &slot)) {
+        return 0;
+    }
+
+    if (self->counters[slot] != BIOSAL_COMPACT_KMER_TABLE_SATURATED) {
+        return self->counters[slot];
+    }
+
+    count = biosal_kmer_table_get(&self->overflow, key);
+
+    CORE_DEBUGGER_ASSERT(count != NULL);
+
+    return *count;
+}
+
+uint64_t biosal_compact_kmer_table_size(struct biosal_compact_kmer_table *self)
+{
+    return self->size;
+}
+
+uint64_t biosal_compact_kmer_table_capacity(struct biosal_compact_kmer_table *self)
+{
+    return self->capacity;
+}
+
+int biosal_compact_kmer_table_key_size(struct biosal_compact_kmer_table *self)
+{
+    return self->key_size;
+}
+
+uint64_t biosal_compact_kmer_table_memory_usage(struct biosal_compact_kmer_table *self)
+{
+    return self->capacity * (2 + self->entry_size)
+            + biosal_kmer_table_memory_usage(&self->overflow);
+}
+
+double biosal_compact_kmer_table_bytes_per_kmer(struct biosal_compact_kmer_table *self)
+{
+    if (self->size == 0) {
+        return 0;
+    }
+
+    return (double)biosal_compact_kmer_table_memory_usage(self) / self->size;
+}
+
+void biosal_compact_kmer_table_set_current_size_estimate(struct biosal_compact_kmer_table *self,
+                double value)
+{
+    uint64_t required;
+    uint64_t capacity;
+
+    if (value <= 0 || value > 1) {
+        return;
+    }
+
+    required = (uint64_t)((self->size / value) / self->threshold);
+    capacity = self->capacity;
+
+    while (capacity < required) {
+        capacity *= 2;
+    }
+
+    if (capacity > self->next_capacity) {
+        self->next_capacity = capacity;
+    }
+}
+
+void biosal_compact_kmer_table_set_threshold(struct biosal_compact_kmer_table *self, double threshold)
+{
+    self->threshold = threshold;
+    self->resize_size = (uint64_t)(self->capacity * self->threshold);
+}
+
+void biosal_compact_kmer_table_examine(struct biosal_compact_kmer_table *self)
+{
+    printf("biosal_compact_kmer_table: size %" PRIu64 " capacity %" PRIu64 " load %f"
+                    " entry_size %d (remainder %d bytes) overflow %" PRIu64
+                    " memory %" PRIu64 " bytes (%.2f bytes per kmer)\n",
+                    self->size, self->capacity,
+                    self->capacity > 0 ? (double)self->size / self->capacity : 0.0,
+                    2 + self->entry_size, self->remainder_size,
+                    biosal_kmer_table_size(&self->overflow),
+                    biosal_compact_kmer_table_memory_usage(self),
+                    biosal_compact_kmer_table_bytes_per_kmer(self));
+}
+
+uint64_t biosal_compact_kmer_table_next_slot(struct biosal_compact_kmer_table *self, uint64_t slot)
+{
+    while (slot < self->capacity
+                    && self->distances[slot] == BIOSAL_COMPACT_KMER_TABLE_EMPTY) {
+        ++slot;
+    }
+
+    return slot;
+}
+
+void biosal_compact_kmer_table_slot_key(struct biosal_compact_kmer_table *self, uint64_t slot,
+                void *key)
+{
+    uint64_t first;
+    uint8_t *rest;
+
+    first = biosal_compact_kmer_table_unmix(biosal_compact_kmer_table_slot_hash(self, slot));
+
+    if (self->rest_size == 0) {
+        biosal_compact_kmer_table_store(key, self->key_size, first);
+        return;
+    }
+
+    rest = self->entries + slot * self->entry_size + self->remainder_size;
+    first ^= biosal_compact_kmer_table_hash_rest(rest, self->rest_size);
+
+    biosal_compact_kmer_table_store(key, BYTES_PER_WORD, first);
+    memcpy((uint8_t *)key + BYTES_PER_WORD, rest, self->rest_size);
+}
+
+int biosal_compact_kmer_table_slot_count(struct biosal_compact_kmer_table *self, uint64_t slot)
+{
+    uint8_t key[BIOSAL_COMPACT_KMER_TABLE_MAXIMUM_KEY_SIZE];
+    int *count;
+
+    if (self->counters[slot] != BIOSAL_COMPACT_KMER_TABLE_SATURATED) {
+        return self->counters[slot];
+    }
+
+    biosal_compact_kmer_table_slot_key(self, slot, key);
+    count = biosal_kmer_table_get(&self->overflow, key);
+
+    CORE_DEBUGGER_ASSERT(count != NULL);
+
+    return *count;
+}
@@ -0,0 +1,105 @@
+
+#ifndef BIOSAL_COMPACT_KMER_TABLE_H
+#define BIOSAL_COMPACT_KMER_TABLE_H
+
+#include "kmer_table.h"
+
+#include <stdint.h>
+
+struct core_memory_pool;
+
+/*
+ * A memory-compact counting table for packed k-mer keys.
+ *
+ * The first 8 bytes of a key go through an invertible hash. The low
+ * bits of the hash (the quotient) select the home slot and only the
+ * other bits (the remainder) are stored, along with the bytes of the
+ * key after the first 8. The key is rebuilt from the home slot and
+ * the remainder when iterating.
+ *
+ * Slots are probed linearly with Robin Hood insertion, so the table
+ * stays fast at a load factor of 0.9. Each slot has one byte for the
+ * distance to its home slot and one byte for a saturating counter.
+ * Counts that do not fit in the counter are kept in a small
+ * biosal_kmer_table on the side.
+ *
+ * With k = 31 and 2^27 slots, an entry uses 7 bytes instead of 13
+ * in biosal_kmer_table (with an int value).
+ */
+struct biosal_compact_kmer_table {
+    uint8_t *distances;
+    uint8_t *counters;
+    uint8_t *entries;
+
+    uint64_t size;
+    uint64_t capacity;
+    uint64_t mask;
+    uint64_t resize_size;
+    uint64_t next_capacity;
+    double threshold;
+
+    int quotient_bits;
+    int remainder_size;
+    int rest_size;
+    int entry_size;
+    int key_size;
+
+    struct biosal_kmer_table overflow;
+    struct core_memory_pool *memory;
+};
+
+void biosal_compact_kmer_table_init(struct biosal_compact_kmer_table *self, int key_size,
+                struct core_memory_pool *memory);
+void biosal_compact_kmer_table_destroy(struct biosal_compact_kmer_table *self);
+
+/*
+ * Add @count to the counter of the key, adding the key if needed.
+ *
+ * \return the new count
+ */
+int biosal_compact_kmer_table_increment(struct biosal_compact_kmer_table *self, void *key, int count);
+
+/*
+ * Same as biosal_compact_kmer_table_increment, for a key that may
+ * not be there.
+ *
+ * \return the new count, or 0 if the key is not there
+ */
+int biosal_compact_kmer_table_increment_existing(struct biosal_compact_kmer_table *self,
+                void *key, int count);
+
+/*
+ * \return the count of the key, or 0 if the key is not there
+ */
+int biosal_compact_kmer_table_get(struct biosal_compact_kmer_table *self, void *key);
+
+uint64_t biosal_compact_kmer_table_size(struct biosal_compact_kmer_table *self);
+uint64_t biosal_compact_kmer_table_capacity(struct biosal_compact_kmer_table *self);
+int biosal_compact_kmer_table_key_size(struct biosal_compact_kmer_table *self);
+
+/*
+ * \return the number of bytes used by the slots and the overflow table
+ */
+uint64_t biosal_compact_kmer_table_memory_usage(struct biosal_compact_kmer_table *self);
+double biosal_compact_kmer_table_bytes_per_kmer(struct biosal_compact_kmer_table *self);
+
+/*
+ * Same as biosal_kmer_table_set_current_size_estimate.
+ */
+void biosal_compact_kmer_table_set_current_size_estimate(struct biosal_compact_kmer_table *self,
+                double value);
+void biosal_compact_kmer_table_set_threshold(struct biosal_compact_kmer_table *self, double threshold);
+
+void biosal_compact_kmer_table_examine(struct biosal_compact_kmer_table *self);
+
+/*
+ * Iteration over the slots, used by biosal_compact_kmer_table_iterator.
+ *
+ * \return the next occupied slot starting at @slot, or the capacity
+ */
+uint64_t biosal_compact_kmer_table_next_slot(struct biosal_compact_kmer_table *self, uint64_t slot);
+void biosal_compact_kmer_table_slot_key(struct biosal_compact_kmer_table *self, uint64_t slot,
+                void *key);
+int biosal_compact_kmer_table_slot_count(struct biosal_compact_kmer_table *self, uint64_t slot);
+
+#endif
@@ -0,0 +1,59 @@
+
+#include "compact_kmer_table_iterator.h"
+
+#include "compact_kmer_table.h"
+
+#include <core/system/memory_pool.h>
+
+#include <stdlib.h>
+
+void biosal_compact_kmer_table_iterator_init(struct biosal_compact_kmer_table_iterator *self,
+                struct biosal_compact_kmer_table *table)
+{
+    self->table = table;
+    self->slot = biosal_compact_kmer_table_next_slot(table, 0);
+    self->key = core_memory_pool_allocate(table->memory,
+                    biosal_compact_kmer_table_key_size(table));
+}
+
+void biosal_compact_kmer_table_iterator_destroy(struct biosal_compact_kmer_table_iterator *self)
+{
+    if (self->table != NULL) {
+        core_memory_pool_free(self->table->memory, self->key);
+    }
+
+    self->table = NULL;
+    self->slot = 0;
+    self->key = NULL;
+}
+
+int biosal_compact_kmer_table_iterator_has_next(struct biosal_compact_kmer_table_iterator *self)
+{
+    if (self->table == NULL) {
+        return 0;
+    }
+
+    return self->slot < biosal_compact_kmer_table_capacity(self->table);
+}
+
+int biosal_compact_kmer_table_iterator_next(struct biosal_compact_kmer_table_iterator *self,
+                void **key, int *count)
+{
+    if (!biosal_compact_kmer_table_iterator_has_next(self)) {
+        return 0;
+    }
+
+    biosal_compact_kmer_table_slot_key(self->table, self->slot, self->key);
+
+    if (key != NULL) {
+        *key = self->key;
+    }
+
+    if (count != NULL) {
+        *count = biosal_compact_kmer_table_slot_count(self->table, self->slot);
+    }
+
+    self->slot = biosal_compact_kmer_table_next_slot(self->table, self->slot + 1);
+
+    return 1;
+}
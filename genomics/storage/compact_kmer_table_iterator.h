@@ -0,0 +1,31 @@
+
+#ifndef BIOSAL_COMPACT_KMER_TABLE_ITERATOR_H
+#define BIOSAL_COMPACT_KMER_TABLE_ITERATOR_H
+
+#include <stdint.h>
+
+struct biosal_compact_kmer_table;
+
+/*
+ * An iterator for biosal_compact_kmer_table. The table must not
+ * receive new keys during the iteration.
+ *
+ * Keys are rebuilt in a buffer owned by the iterator, which is
+ * overwritten by the next call to
+ * biosal_compact_kmer_table_iterator_next.
+ */
+struct biosal_compact_kmer_table_iterator {
+    struct biosal_compact_kmer_table *table;
+    uint64_t slot;
+    void *key;
+};
+
+void biosal_compact_kmer_table_iterator_init(struct biosal_compact_kmer_table_iterator *self,
+                struct biosal_compact_kmer_table *table);
+void biosal_compact_kmer_table_iterator_destroy(struct biosal_compact_kmer_table_iterator *self);
+
+int biosal_compact_kmer_table_iterator_has_next(struct biosal_compact_kmer_table_iterator *self);
+int biosal_compact_kmer_table_iterator_next(struct biosal_compact_kmer_table_iterator *self,
+                void **key, int *count);
+
+#endif
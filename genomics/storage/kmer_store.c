@@ -7,7 +7,8 @@
 
 #include <genomics/data/dna_kmer.h>
 #include <genomics/data/dna_kmer_block.h>
-#include <genomics/data/dna_kmer_frequency_block.h>
+
+#include <genomics/helpers/command.h>
 
 #include <engine/thorium/modules/message_helper.h>
 
@@ -23,6 +24,11 @@
 
 #define MEMORY_KMER_STORE 0x51daca18
 
+/*
+ * Kmers in the first generation of the singleton filter.
+ */
+#define BIOSAL_KMER_STORE_SINGLETON_FILTER_CAPACITY 1048576
+
 void biosal_kmer_store_init(struct thorium_actor *actor);
 void biosal_kmer_store_destroy(struct thorium_actor *actor);
 void biosal_kmer_store_receive(struct thorium_actor *actor, struct thorium_message *message);
@@ -31,6 +37,19 @@ void biosal_kmer_store_print(struct thorium_actor *self);
 void biosal_kmer_store_push_data(struct thorium_actor *self, struct thorium_message *message);
 void biosal_kmer_store_yield_reply(struct thorium_actor *self, struct thorium_message *message);
 
+static void biosal_kmer_store_table_init(struct biosal_kmer_store *self);
+static void biosal_kmer_store_table_destroy(struct biosal_kmer_store *self);
+static void biosal_kmer_store_table_increment(struct biosal_kmer_store *self, void *key, int count);
+static int biosal_kmer_store_table_increment_existing(struct biosal_kmer_store *self, void *key,
+                int count);
+static void biosal_kmer_store_add_kmer(struct biosal_kmer_store *self, void *key, int count);
+static uint64_t biosal_kmer_store_table_size(struct biosal_kmer_store *self);
+static double biosal_kmer_store_table_bytes_per_kmer(struct biosal_kmer_store *self);
+static void biosal_kmer_store_iterator_init(struct biosal_kmer_store *self);
+static void biosal_kmer_store_iterator_destroy(struct biosal_kmer_store *self);
+static int biosal_kmer_store_iterator_has_next(struct biosal_kmer_store *self);
+static void biosal_kmer_store_iterator_next(struct biosal_kmer_store *self, void **key, int *coverage);
+
 struct thorium_script biosal_kmer_store_script = {
     .identifier = SCRIPT_KMER_STORE,
     .init = biosal_kmer_store_init,
@@ -59,15 +78,27 @@ void biosal_kmer_store_init(struct thorium_actor *self)
 
     biosal_dna_codec_init(&concrete_actor->storage_codec);
 
-/* This option enables 2-bit encoding
- * for kmers.
- */
-#ifdef BIOSAL_DNA_CODEC_USE_TWO_BIT_ENCODING_FOR_STORAGE
+    /*
+     * Keys are stored in 2-bit encoding so that they fit
+     * in 1, 2 or 4 words in the kmer table.
+     */
     biosal_dna_codec_enable_two_bit_encoding(&concrete_actor->storage_codec);
-#endif
+
+    concrete_actor->codec_are_different = 1;
+
+    if (concrete_actor->transport_codec.use_two_bit_encoding
+                    == concrete_actor->storage_codec.use_two_bit_encoding) {
+        concrete_actor->codec_are_different = 0;
+    }
 
     concrete_actor->last_received = 0;
 
+    concrete_actor->use_compact_table = biosal_command_use_compact_kmer_store(
+                    thorium_actor_argc(self), thorium_actor_argv(self));
+    concrete_actor->singleton_filter_bits = biosal_command_get_singleton_filter_bits(
+                    thorium_actor_argc(self), thorium_actor_argv(self));
+    concrete_actor->singleton_count = 0;
+
     thorium_actor_add_action(self, ACTION_YIELD_REPLY, biosal_kmer_store_yield_reply);
 }
 
@@ -85,10 +116,8 @@ void biosal_kmer_store_destroy(struct thorium_actor *self)
     core_memory_pool_examine(&concrete_actor->persistent_memory);
 #endif
 
-    core_map_examine(&concrete_actor->table);
-
     if (concrete_actor->kmer_length != -1) {
-        core_map_destroy(&concrete_actor->table);
+        biosal_kmer_store_table_destroy(concrete_actor);
     }
 
     biosal_dna_codec_destroy(&concrete_actor->transport_codec);
@@ -104,16 +133,14 @@ void biosal_kmer_store_receive(struct thorium_actor *self, struct thorium_messag
     int tag;
     void *buffer;
     struct biosal_kmer_store *concrete_actor;
-    struct biosal_dna_kmer_frequency_block block;
+    struct biosal_dna_kmer_block block;
     void *key;
-    struct core_map *kmers;
-    struct core_map_iterator iterator;
+    int entries;
+    int i;
     double value;
     struct biosal_dna_kmer kmer;
     struct biosal_dna_kmer *kmer_pointer;
-    void *packed_kmer;
-    int *frequency;
-    int *bucket;
+    int frequency;
     struct core_memory_pool *ephemeral_memory;
     int customer;
     int period;
@@ -150,31 +177,16 @@ void biosal_kmer_store_receive(struct thorium_actor *self, struct thorium_messag
                         concrete_actor->kmer_length);
 #endif
 
-        core_map_init(&concrete_actor->table, concrete_actor->key_length_in_bytes,
-                        sizeof(int));
-        core_map_set_memory_pool(&concrete_actor->table,
-                        &concrete_actor->persistent_memory);
-
-        /*
-         * Configure the map for better performance.
-         */
-        core_map_disable_deletion_support(&concrete_actor->table);
-
-        /*
-         * The threshold of the map is not very important because
-         * requests that hit the map have to first arrive as messages,
-         * which are slow.
-         */
-        core_map_set_threshold(&concrete_actor->table, 0.95);
+        biosal_kmer_store_table_init(concrete_actor);
 
         thorium_actor_send_reply_empty(self, ACTION_SET_KMER_LENGTH_REPLY);
 
     } else if (tag == ACTION_PUSH_KMER_BLOCK) {
 
-        biosal_dna_kmer_frequency_block_init(&block, concrete_actor->kmer_length,
-                        ephemeral_memory, &concrete_actor->transport_codec, 0);
-
-        biosal_dna_kmer_frequency_block_unpack(&block, buffer, thorium_actor_get_ephemeral_memory(self),
+        /*
+         * The block is read in place from the message buffer.
+         */
+        biosal_dna_kmer_block_unpack(&block, buffer, ephemeral_memory,
                         &concrete_actor->transport_codec);
 
         key = core_memory_pool_allocate(ephemeral_memory, concrete_actor->key_length_in_bytes);
@@ -183,85 +195,73 @@ void biosal_kmer_store_receive(struct thorium_actor *self, struct thorium_messag
         printf("Allocating key %d bytes\n", concrete_actor->key_length_in_bytes);
 
         printf("kmer store receives block, kmers in table %" PRIu64 "\n",
-                        core_map_size(&concrete_actor->table));
+                        biosal_kmer_store_table_size(concrete_actor));
 #endif
 
-        kmers = biosal_dna_kmer_frequency_block_kmers(&block);
-        core_map_iterator_init(&iterator, kmers);
+        entries = biosal_dna_kmer_block_size(&block);
 
         period = 2500000;
 
         raw_kmer = core_memory_pool_allocate(thorium_actor_get_ephemeral_memory(self),
                         concrete_actor->kmer_length + 1);
 
-        while (core_map_iterator_has_next(&iterator)) {
+        for (i = 0; i < entries; ++i) {
 
             /*
              * add kmers to store
              */
-            core_map_iterator_next(&iterator, (void **)&packed_kmer, (void **)&frequency);
+            biosal_dna_kmer_block_get_kmer(&block, i, &kmer);
+            frequency = biosal_dna_kmer_block_get_count(&block, i);
 
             /* Store the kmer in 2 bit encoding
              */
 
-            biosal_dna_kmer_init_empty(&kmer);
-            biosal_dna_kmer_unpack(&kmer, packed_kmer, concrete_actor->kmer_length,
-                        ephemeral_memory,
-                        &concrete_actor->transport_codec);
-
             kmer_pointer = &kmer;
 
-            /*
-             * Get a copy of the sequence
-             */
-            biosal_dna_kmer_get_sequence(kmer_pointer, raw_kmer, concrete_actor->kmer_length,
-                            &concrete_actor->transport_codec);
+            if (concrete_actor->codec_are_different) {
+                /*
+                 * Get a copy of the sequence
+                 */
+                biosal_dna_kmer_get_sequence(kmer_pointer, raw_kmer, concrete_actor->kmer_length,
+                                &concrete_actor->transport_codec);
 
 #if 0
-            printf("DEBUG raw_kmer %s\n", raw_kmer);
+                printf("DEBUG raw_kmer %s\n", raw_kmer);
 #endif
 
-            biosal_dna_kmer_destroy(&kmer, ephemeral_memory);
-
-            biosal_dna_kmer_init(&encoded_kmer, raw_kmer, &concrete_actor->storage_codec,
-                            thorium_actor_get_ephemeral_memory(self));
+                biosal_dna_kmer_init(&encoded_kmer, raw_kmer, &concrete_actor->storage_codec,
+                                thorium_actor_get_ephemeral_memory(self));
+                kmer_pointer = &encoded_kmer;
+            }
 
-            biosal_dna_kmer_pack_store_key(&encoded_kmer, key,
+            biosal_dna_kmer_pack_store_key(kmer_pointer, key,
                             concrete_actor->kmer_length, &concrete_actor->storage_codec,
                             thorium_actor_get_ephemeral_memory(self));
 
-            biosal_dna_kmer_destroy(&encoded_kmer,
-                            thorium_actor_get_ephemeral_memory(self));
-
-            bucket = (int *)core_map_get(&concrete_actor->table, key);
-
-            if (bucket == NULL) {
-                /* This is the first time that this kmer is seen.
-                 */
-                bucket = (int *)core_map_add(&concrete_actor->table, key);
-                *bucket = 0;
+            if (concrete_actor->codec_are_different) {
+                biosal_dna_kmer_destroy(&encoded_kmer,
+                                thorium_actor_get_ephemeral_memory(self));
             }
 
-            (*bucket) += *frequency;
+            biosal_kmer_store_add_kmer(concrete_actor, key, frequency);
 
             if (concrete_actor->received >= concrete_actor->last_received + period) {
                 printf("kmer store %d received %" PRIu64 " kmers so far,"
                                 " store has %" PRIu64 " canonical kmers, %" PRIu64 " kmers\n",
                                 thorium_actor_name(self), concrete_actor->received,
-                                core_map_size(&concrete_actor->table),
-                                2 * core_map_size(&concrete_actor->table));
+                                biosal_kmer_store_table_size(concrete_actor),
+                                2 * biosal_kmer_store_table_size(concrete_actor));
 
                 concrete_actor->last_received = concrete_actor->received;
             }
 
-            concrete_actor->received += *frequency;
+            concrete_actor->received += frequency;
         }
 
         core_memory_pool_free(ephemeral_memory, key);
         core_memory_pool_free(ephemeral_memory, raw_kmer);
 
-        core_map_iterator_destroy(&iterator);
-        biosal_dna_kmer_frequency_block_destroy(&block, thorium_actor_get_ephemeral_memory(self));
+        biosal_dna_kmer_block_destroy(&block, ephemeral_memory);
 
         thorium_actor_send_reply_empty(self, ACTION_PUSH_KMER_BLOCK_REPLY);
 
@@ -269,7 +269,12 @@ void biosal_kmer_store_receive(struct thorium_actor *self, struct thorium_messag
 
         thorium_message_unpack_double(message, 0, &value);
 
-        core_map_set_current_size_estimate(&concrete_actor->table, value);
+        if (concrete_actor->use_compact_table) {
+            biosal_compact_kmer_table_set_current_size_estimate(&concrete_actor->compact_table,
+                            value);
+        } else {
+            biosal_kmer_table_set_current_size_estimate(&concrete_actor->table, value);
+        }
 
     } else if (tag == ACTION_ASK_TO_STOP) {
 
@@ -308,10 +313,8 @@ void biosal_kmer_store_receive(struct thorium_actor *self, struct thorium_messag
 
 void biosal_kmer_store_print(struct thorium_actor *self)
 {
-    struct core_map_iterator iterator;
     struct biosal_dna_kmer kmer;
     void *key;
-    int *value;
     int coverage;
     char *sequence;
     struct biosal_kmer_store *concrete_actor;
@@ -321,14 +324,14 @@ void biosal_kmer_store_print(struct thorium_actor *self)
 
     ephemeral_memory = thorium_actor_get_ephemeral_memory(self);
     concrete_actor = (struct biosal_kmer_store *)thorium_actor_concrete_actor(self);
-    core_map_iterator_init(&iterator, &concrete_actor->table);
+    biosal_kmer_store_iterator_init(concrete_actor);
 
-    printf("map size %d\n", (int)core_map_size(&concrete_actor->table));
+    printf("map size %d\n", (int)biosal_kmer_store_table_size(concrete_actor));
 
     maximum_length = 0;
 
-    while (core_map_iterator_has_next(&iterator)) {
-        core_map_iterator_next(&iterator, (void **)&key, (void **)&value);
+    while (biosal_kmer_store_iterator_has_next(concrete_actor)) {
+        biosal_kmer_store_iterator_next(concrete_actor, &key, &coverage);
 
         biosal_dna_kmer_init_empty(&kmer);
         biosal_dna_kmer_unpack(&kmer, key, concrete_actor->kmer_length,
@@ -352,11 +355,11 @@ void biosal_kmer_store_print(struct thorium_actor *self)
 
     sequence = core_memory_pool_allocate(ephemeral_memory, maximum_length + 1);
     sequence[0] = '\0';
-    core_map_iterator_destroy(&iterator);
-    core_map_iterator_init(&iterator, &concrete_actor->table);
+    biosal_kmer_store_iterator_destroy(concrete_actor);
+    biosal_kmer_store_iterator_init(concrete_actor);
 
-    while (core_map_iterator_has_next(&iterator)) {
-        core_map_iterator_next(&iterator, (void **)&key, (void **)&value);
+    while (biosal_kmer_store_iterator_has_next(concrete_actor)) {
+        biosal_kmer_store_iterator_next(concrete_actor, &key, &coverage);
 
         biosal_dna_kmer_init_empty(&kmer);
         biosal_dna_kmer_unpack(&kmer, key, concrete_actor->kmer_length,
@@ -365,14 +368,13 @@ void biosal_kmer_store_print(struct thorium_actor *self)
 
         biosal_dna_kmer_get_sequence(&kmer, sequence, concrete_actor->kmer_length,
                         &concrete_actor->storage_codec);
-        coverage = *value;
 
         printf("Sequence %s Coverage %d\n", sequence, coverage);
 
         biosal_dna_kmer_destroy(&kmer, thorium_actor_get_ephemeral_memory(self));
     }
 
-    core_map_iterator_destroy(&iterator);
+    biosal_kmer_store_iterator_destroy(concrete_actor);
     core_memory_pool_free(ephemeral_memory, sequence);
 }
 
@@ -381,6 +383,8 @@ void biosal_kmer_store_push_data(struct thorium_actor *self, struct thorium_mess
     struct biosal_kmer_store *concrete_actor;
     int name;
     int source;
+    int coverage;
+    uint64_t *count;
 
     concrete_actor = (struct biosal_kmer_store *)thorium_actor_concrete_actor(self);
     source = thorium_message_source(message);
@@ -389,11 +393,30 @@ void biosal_kmer_store_push_data(struct thorium_actor *self, struct thorium_mess
 
     core_map_init(&concrete_actor->coverage_distribution, sizeof(int), sizeof(uint64_t));
 
-    printf("kmer store %d: local table has %" PRIu64" canonical kmers (%" PRIu64 " kmers)\n",
-                    name, core_map_size(&concrete_actor->table),
-                    2 * core_map_size(&concrete_actor->table));
+    printf("kmer store %d: local table has %" PRIu64" canonical kmers (%" PRIu64 " kmers),"
+                    " %.2f bytes per canonical kmer\n",
+                    name, biosal_kmer_store_table_size(concrete_actor),
+                    2 * biosal_kmer_store_table_size(concrete_actor),
+                    biosal_kmer_store_table_bytes_per_kmer(concrete_actor));
 
-    core_map_iterator_init(&concrete_actor->iterator, &concrete_actor->table);
+    /*
+     * Kmers that were seen only once are not in the table.
+     */
+    if (concrete_actor->singleton_filter_bits > 0) {
+
+        if (concrete_actor->singleton_count > 0) {
+            coverage = 1;
+            count = core_map_add(&concrete_actor->coverage_distribution, &coverage);
+            *count = concrete_actor->singleton_count;
+        }
+
+        printf("kmer store %d: singleton filter has %" PRId64 " canonical kmers seen once,"
+                        " %" PRIu64 " bytes\n",
+                        name, concrete_actor->singleton_count,
+                        core_bloom_filter_memory_usage(&concrete_actor->singleton_filter));
+    }
+
+    biosal_kmer_store_iterator_init(concrete_actor);
 
 #ifdef BIOSAL_KMER_STORE_DEBUG
     printf("yield 1\n");
@@ -406,7 +429,6 @@ void biosal_kmer_store_yield_reply(struct thorium_actor *self, struct thorium_me
 {
     struct biosal_dna_kmer kmer;
     void *key;
-    int *value;
     int coverage;
     struct biosal_kmer_store *concrete_actor;
     int customer;
@@ -430,20 +452,17 @@ void biosal_kmer_store_yield_reply(struct thorium_actor *self, struct thorium_me
     max = 1024;
 
     key = NULL;
-    value = NULL;
 
     while (i < max
-                    && core_map_iterator_has_next(&concrete_actor->iterator)) {
+                    && biosal_kmer_store_iterator_has_next(concrete_actor)) {
 
-        core_map_iterator_next(&concrete_actor->iterator, (void **)&key, (void **)&value);
+        biosal_kmer_store_iterator_next(concrete_actor, &key, &coverage);
 
         biosal_dna_kmer_init_empty(&kmer);
         biosal_dna_kmer_unpack(&kmer, key, concrete_actor->kmer_length,
                         ephemeral_memory,
                         &concrete_actor->storage_codec);
 
-        coverage = *value;
-
         count = (uint64_t *)core_map_get(&concrete_actor->coverage_distribution, &coverage);
 
         if (count == NULL) {
@@ -463,7 +482,7 @@ void biosal_kmer_store_yield_reply(struct thorium_actor *self, struct thorium_me
 
     /* yield again if the iterator is not at the end
      */
-    if (core_map_iterator_has_next(&concrete_actor->iterator)) {
+    if (biosal_kmer_store_iterator_has_next(concrete_actor)) {
 
 #if 0
         printf("yield ! %d\n", i);
@@ -478,7 +497,7 @@ void biosal_kmer_store_yield_reply(struct thorium_actor *self, struct thorium_me
     printf("ready...\n");
     */
 
-    core_map_iterator_destroy(&concrete_actor->iterator);
+    biosal_kmer_store_iterator_destroy(concrete_actor);
 
     new_count = core_map_pack_size(&concrete_actor->coverage_distribution);
 
@@ -503,3 +522,166 @@ void biosal_kmer_store_yield_reply(struct thorium_actor *self, struct thorium_me
     thorium_actor_send_empty(self, concrete_actor->source,
                             ACTION_PUSH_DATA_REPLY);
 }
+
+static void biosal_kmer_store_table_init(struct biosal_kmer_store *self)
+{
+    if (self->use_compact_table) {
+        biosal_compact_kmer_table_init(&self->compact_table, self->key_length_in_bytes,
+                        &self->persistent_memory);
+    } else {
+        biosal_kmer_table_init(&self->table, self->key_length_in_bytes,
+                        sizeof(int), &self->persistent_memory);
+    }
+
+    if (self->singleton_filter_bits > 0) {
+        core_bloom_filter_init(&self->singleton_filter, self->key_length_in_bytes,
+                        self->singleton_filter_bits, BIOSAL_KMER_STORE_SINGLETON_FILTER_CAPACITY,
+                        &self->persistent_memory);
+    }
+}
+
+static void biosal_kmer_store_table_destroy(struct biosal_kmer_store *self)
+{
+    if (self->use_compact_table) {
+        biosal_compact_kmer_table_examine(&self->compact_table);
+        biosal_compact_kmer_table_destroy(&self->compact_table);
+    } else {
+        biosal_kmer_table_examine(&self->table);
+        biosal_kmer_table_destroy(&self->table);
+    }
+
+    if (self->singleton_filter_bits > 0) {
+        core_bloom_filter_print(&self->singleton_filter);
+        core_bloom_filter_destroy(&self->singleton_filter);
+    }
+}
+
+static void biosal_kmer_store_table_increment(struct biosal_kmer_store *self, void *key, int count)
+{
+    if (self->use_compact_table) {
+        biosal_compact_kmer_table_increment(&self->compact_table, key, count);
+    } else {
+        biosal_kmer_table_increment(&self->table, key, count);
+    }
+}
+
+/*
+ * \return 1 if the key was in the table
+ */
+static int biosal_kmer_store_table_increment_existing(struct biosal_kmer_store *self, void *key,
+                int count)
+{
+    int *value;
+
+    if (self->use_compact_table) {
+        return biosal_compact_kmer_table_increment_existing(&self->compact_table, key, count) > 0;
+    }
+
+    value = biosal_kmer_table_get(&self->table, key);
+
+    if (value == NULL) {
+        return 0;
+    }
+
+    *value += count;
+
+    return 1;
+}
+
+/*
+ * Without the singleton filter, there is only one lookup: the key
+ * is added if this is the first time that it is seen.
+ *
+ * With the filter, a new kmer seen once goes only in the filter. It is
+ * added to the table with the count of its first occurrence when it
+ * is seen again. A false positive of the filter adds 1 to the count of
+ * a new kmer.
+ */
+static void biosal_kmer_store_add_kmer(struct biosal_kmer_store *self, void *key, int count)
+{
+    if (self->singleton_filter_bits == 0) {
+        biosal_kmer_store_table_increment(self, key, count);
+        return;
+    }
+
+    if (biosal_kmer_store_table_increment_existing(self, key, count)) {
+        return;
+    }
+
+    if (core_bloom_filter_add(&self->singleton_filter, key)) {
+        ++count;
+        --self->singleton_count;
+
+    } else if (count == 1) {
+        ++self->singleton_count;
+        return;
+    }
+
+    biosal_kmer_store_table_increment(self, key, count);
+}
+
+static uint64_t biosal_kmer_store_table_size(struct biosal_kmer_store *self)
+{
+    if (self->use_compact_table) {
+        return biosal_compact_kmer_table_size(&self->compact_table);
+    }
+
+    return biosal_kmer_table_size(&self->table);
+}
+
+static double biosal_kmer_store_table_bytes_per_kmer(struct biosal_kmer_store *self)
+{
+    uint64_t size;
+
+    if (self->use_compact_table) {
+        return biosal_compact_kmer_table_bytes_per_kmer(&self->compact_table);
+    }
+
+    size = biosal_kmer_table_size(&self->table);
+
+    if (size == 0) {
+        return 0;
+    }
+
+    return (double)biosal_kmer_table_memory_usage(&self->table) / size;
+}
+
+static void biosal_kmer_store_iterator_init(struct biosal_kmer_store *self)
+{
+    if (self->use_compact_table) {
+        biosal_compact_kmer_table_iterator_init(&self->compact_iterator, &self->compact_table);
+    } else {
+        biosal_kmer_table_iterator_init(&self->iterator, &self->table);
+    }
+}
+
+static void biosal_kmer_store_iterator_destroy(struct biosal_kmer_store *self)
+{
+    if (self->use_compact_table) {
+        biosal_compact_kmer_table_iterator_destroy(&self->compact_iterator);
+    } else {
+        biosal_kmer_table_iterator_destroy(&self->iterator);
+    }
+}
+
+static int biosal_kmer_store_iterator_has_next(struct biosal_kmer_store *self)
+{
+    if (self->use_compact_table) {
+        return biosal_compact_kmer_table_iterator_has_next(&self->compact_iterator);
+    }
+
+    return biosal_kmer_table_iterator_has_next(&self->iterator);
+}
+
+static void biosal_kmer_store_iterator_next(struct biosal_kmer_store *self, void **key, int *coverage)
+{
+    int *value;
+
+    if (self->use_compact_table) {
+        biosal_compact_kmer_table_iterator_next(&self->compact_iterator, key, coverage);
+        return;
+    }
+
+    biosal_kmer_table_iterator_next(&self->iterator, key, (void **)&value);
+    *coverage = *value;
+}
@@ -8,8 +8,13 @@
 
 #include <genomics/data/coverage_distribution.h>
 
-#include <core/structures/map_iterator.h>
+#include <genomics/storage/kmer_table.h>
+#include <genomics/storage/kmer_table_iterator.h>
+#include <genomics/storage/compact_kmer_table.h>
+#include <genomics/storage/compact_kmer_table_iterator.h>
+
 #include <core/structures/map.h>
+#include <core/structures/bloom_filter.h>
 
 #include <core/system/memory_pool.h>
 
@@ -20,9 +25,26 @@
  * http://docs.openstack.org/openstack-ops/content/storage_decision.html
  */
 struct biosal_kmer_store {
-    struct core_map table;
+    struct biosal_kmer_table table;
+
+    /*
+     * Used instead of table with -compact-kmer-store
+     */
+    int use_compact_table;
+    struct biosal_compact_kmer_table compact_table;
+    struct biosal_compact_kmer_table_iterator compact_iterator;
+
+    /*
+     * Kmers seen once are only in this filter
+     * (with -singleton-filter-bits).
+     */
+    int singleton_filter_bits;
+    struct core_bloom_filter singleton_filter;
+    int64_t singleton_count;
+
     struct biosal_dna_codec transport_codec;
     struct biosal_dna_codec storage_codec;
+    int codec_are_different;
     int kmer_length;
     int key_length_in_bytes;
 
@@ -34,7 +56,7 @@ struct biosal_kmer_store {
     struct core_memory_pool persistent_memory;
 
     struct core_map coverage_distribution;
-    struct core_map_iterator iterator;
+    struct biosal_kmer_table_iterator iterator;
     int source;
 };
 
@@ -0,0 +1,475 @@
+
+#include "kmer_table.h"
+
+#include <core/system/memory_pool.h>
+#include <core/system/memory.h>
+#include <core/system/debugger.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define BIOSAL_KMER_TABLE_GROUP_SIZE 16
+#define BIOSAL_KMER_TABLE_INITIAL_CAPACITY 1024
+#define BIOSAL_KMER_TABLE_DEFAULT_THRESHOLD 0.875
+
+#define BIOSAL_KMER_TABLE_EMPTY 0
+#define BIOSAL_KMER_TABLE_USED 0x80
+
+/*
+ * 2048 nucleotides in 2-bit encoding.
+ */
+#define BIOSAL_KMER_TABLE_MAXIMUM_KEY_WORDS 64
+
+#define BYTES_PER_WORD 8
+
+static void biosal_kmer_table_allocate(struct biosal_kmer_table *self, uint64_t capacity);
+static void biosal_kmer_table_grow(struct biosal_kmer_table *self);
+static inline uint64_t biosal_kmer_table_hash(uint64_t *key, int words);
+static inline void biosal_kmer_table_pack_key(struct biosal_kmer_table *self, void *key,
+                uint64_t *packed_key);
+static inline int biosal_kmer_table_key_equals(uint64_t *key1, uint64_t *key2, int words);
+static inline uint32_t biosal_kmer_table_match(uint8_t *tags, uint8_t tag);
+static inline int biosal_kmer_table_lowest_bit(uint32_t mask);
+static inline int biosal_kmer_table_probe(struct biosal_kmer_table *self, uint64_t *key,
+                uint64_t hash, int words, uint64_t *slot);
+static int biosal_kmer_table_find(struct biosal_kmer_table *self, uint64_t *key,
+                uint64_t hash, uint64_t *slot);
+
+void biosal_kmer_table_init(struct biosal_kmer_table *self, int key_size, int value_size,
+                struct core_memory_pool *memory)
+{
+    CORE_DEBUGGER_ASSERT(key_size > 0);
+
+    self->key_size = key_size;
+    self->key_words = (key_size + BYTES_PER_WORD - 1) / BYTES_PER_WORD;
+
+    /*
+     * 3 words are stored as 4 words to use the
+     * specialized comparison.
+     */
+    if (self->key_words == 3) {
+        self->key_words = 4;
+    }
+
+    CORE_DEBUGGER_ASSERT(self->key_words <= BIOSAL_KMER_TABLE_MAXIMUM_KEY_WORDS);
+
+    self->value_size = value_size;
+    self->memory = memory;
+    self->threshold = BIOSAL_KMER_TABLE_DEFAULT_THRESHOLD;
+    self->next_capacity = 0;
+
+    self->tags = NULL;
+    self->keys = NULL;
+    self->values = NULL;
+
+    biosal_kmer_table_allocate(self, BIOSAL_KMER_TABLE_INITIAL_CAPACITY);
+}
+
+void biosal_kmer_table_destroy(struct biosal_kmer_table *self)
+{
+    if (self->tags != NULL) {
+        core_memory_pool_free(self->memory, self->tags);
+        core_memory_pool_free(self->memory, self->keys);
+
+        if (self->values != NULL) {
+            core_memory_pool_free(self->memory, self->values);
+        }
+    }
+
+    self->tags = NULL;
+    self->keys = NULL;
+    self->values = NULL;
+    self->size = 0;
+    self->capacity = 0;
+    self->resize_size = 0;
+}
+
+static void biosal_kmer_table_allocate(struct biosal_kmer_table *self, uint64_t capacity)
+{
+    self->capacity = capacity;
+    self->size = 0;
+    self->resize_size = (uint64_t)(capacity * self->threshold);
+
+    self->tags = core_memory_pool_allocate(self->memory, capacity);
+    memset(self->tags, BIOSAL_KMER_TABLE_EMPTY, capacity);
+
+    self->keys = core_memory_pool_allocate(self->memory,
+                    capacity * self->key_words * sizeof(uint64_t));
+
+    self->values = NULL;
+
+    if (self->value_size > 0) {
+        self->values = core_memory_pool_allocate(self->memory, capacity * self->value_size);
+    }
+}
+
+/*
+ * Move every entry to a table with twice the capacity (or more,
+ * see biosal_kmer_table_set_current_size_estimate).
+ */
+static void biosal_kmer_table_grow(struct biosal_kmer_table *self)
+{
+    struct biosal_kmer_table old_table;
+    uint64_t capacity;
+    uint64_t slot;
+    uint64_t new_slot;
+    uint64_t *key;
+
+    old_table = *self;
+
+    capacity = self->capacity * 2;
+
+    while (capacity < self->next_capacity) {
+        capacity *= 2;
+    }
+
+    biosal_kmer_table_allocate(self, capacity);
+
+    for (slot = 0; slot < old_table.capacity; ++slot) {
+
+        if (old_table.tags[slot] == BIOSAL_KMER_TABLE_EMPTY) {
+            continue;
+        }
+
+        key = old_table.keys + slot * old_table.key_words;
+
+        /*
+         * The keys are all different, so only the empty slot is needed.
+         */
+        biosal_kmer_table_find(self, key, biosal_kmer_table_hash(key, self->key_words), &new_slot);
+
+        self->tags[new_slot] = old_table.tags[slot];
+        core_memory_copy(self->keys + new_slot * self->key_words, key,
+                        self->key_words * sizeof(uint64_t));
+
+        if (self->value_size > 0) {
+            core_memory_copy(self->values + new_slot * self->value_size,
+                            old_table.values + slot * old_table.value_size, self->value_size);
+        }
+
+        ++self->size;
+    }
+
+    biosal_kmer_table_destroy(&old_table);
+}
+
+/*
+ * Mix the words with the 64-bit finalizer of MurmurHash3.
+ */
+static inline uint64_t biosal_kmer_table_hash(uint64_t *key, int words)
+{
+    uint64_t hash;
+    int i;
+
+    hash = 0x9ae16a3b2f90404fULL;
+
+    for (i = 0; i < words; ++i) {
+        hash = (hash ^ key[i]) * 0x87c37b91114253d5ULL;
+        hash = (hash << 31) | (hash >> 33);
+    }
+
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+
+    return hash;
+}
+
+static inline void biosal_kmer_table_pack_key(struct biosal_kmer_table *self, void *key,
+                uint64_t *packed_key)
+{
+    if (self->key_size != self->key_words * BYTES_PER_WORD) {
+        memset(packed_key, 0, self->key_words * sizeof(uint64_t));
+    }
+
+    memcpy(packed_key, key, self->key_size);
+}
+
+static inline int biosal_kmer_table_key_equals(uint64_t *key1, uint64_t *key2, int words)
+{
+    switch (words) {
+        case 1:
+            return key1[0] == key2[0];
+        case 2:
+            return ((key1[0] ^ key2[0]) | (key1[1] ^ key2[1])) == 0;
+        case 4:
+            return ((key1[0] ^ key2[0]) | (key1[1] ^ key2[1])
+                        | (key1[2] ^ key2[2]) | (key1[3] ^ key2[3])) == 0;
+    }
+
+    return memcmp(key1, key2, words * sizeof(uint64_t)) == 0;
+}
+
+/*
+ * \return a mask with bit i set if tags[i] is equal to tag
+ */
+static inline uint32_t biosal_kmer_table_match(uint8_t *tags, uint8_t tag)
+{
+#if defined(__SSE2__)
+    return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((__m128i *)tags),
+                            _mm_set1_epi8((char)tag)));
+#else
+    uint32_t mask;
+    int i;
+
+    mask = 0;
+
+    for (i = 0; i < BIOSAL_KMER_TABLE_GROUP_SIZE; ++i) {
+        if (tags[i] == tag) {
+            mask |= (uint32_t)1 << i;
+        }
+    }
+
+    return mask;
+#endif
+}
+
+static inline int biosal_kmer_table_lowest_bit(uint32_t mask)
+{
+#if defined(__GNUC__)
+    return __builtin_ctz(mask);
+#else
+    int bit;
+
+    bit = 0;
+
+    while (!(mask & 1)) {
+        mask >>= 1;
+        ++bit;
+    }
+
+    return bit;
+#endif
+}
+
+/*
+ * \return 1 if the key is in the table (at @slot), 0 otherwise
+ * (@slot is then the empty slot for the key)
+ *
+ * @words is a constant at each call site so that the comparison
+ * of keys is specialized by the compiler.
+ */
+static inline int biosal_kmer_table_probe(struct biosal_kmer_table *self, uint64_t *key,
+                uint64_t hash, int words, uint64_t *slot)
+{
+    uint64_t group;
+    uint64_t group_mask;
+    uint64_t first;
+    uint8_t tag;
+    uint32_t matches;
+    uint32_t empty_slots;
+    uint64_t index;
+
+    group_mask = self->capacity / BIOSAL_KMER_TABLE_GROUP_SIZE - 1;
+    group = hash & group_mask;
+    tag = BIOSAL_KMER_TABLE_USED | (uint8_t)(hash >> 57);
+
+    while (1) {
+
+        first = group * BIOSAL_KMER_TABLE_GROUP_SIZE;
+        matches = biosal_kmer_table_match(self->tags + first, tag);
+
+        while (matches) {
+            index = first + biosal_kmer_table_lowest_bit(matches);
+
+            if (biosal_kmer_table_key_equals(self->keys + index * words, key, words)) {
+                *slot = index;
+                return 1;
+            }
+
+            matches &= matches - 1;
+        }
+
+        empty_slots = biosal_kmer_table_match(self->tags + first, BIOSAL_KMER_TABLE_EMPTY);
+
+        if (empty_slots) {
+            *slot = first + biosal_kmer_table_lowest_bit(empty_slots);
+            return 0;
+        }
+
+        group = (group + 1) & group_mask;
+    }
+
+    return 0;
+}
+
+static int biosal_kmer_table_find(struct biosal_kmer_table *self, uint64_t *key,
+                uint64_t hash, uint64_t *slot)
+{
+    switch (self->key_words) {
+        case 1:
+            return biosal_kmer_table_probe(self, key, hash, 1, slot);
+        case 2:
+            return biosal_kmer_table_probe(self, key, hash, 2, slot);
+        case 4:
+            return biosal_kmer_table_probe(self, key, hash, 4, slot);
+    }
+
+    return biosal_kmer_table_probe(self, key, hash, self->key_words, slot);
+}
+
+void *biosal_kmer_table_get(struct biosal_kmer_table *self, void *key)
+{
+    uint64_t packed_key[BIOSAL_KMER_TABLE_MAXIMUM_KEY_WORDS];
+    uint64_t slot;
+
+    biosal_kmer_table_pack_key(self, key, packed_key);
+
+    if (!biosal_kmer_table_find(self, packed_key,
+                            biosal_kmer_table_hash(packed_key, self->key_words), &slot)) {
+        return NULL;
+    }
+
+    return biosal_kmer_table_slot_value(self, slot);
+}
+
+void *biosal_kmer_table_add(struct biosal_kmer_table *self, void *key, int *inserted)
+{
+    uint64_t packed_key[BIOSAL_KMER_TABLE_MAXIMUM_KEY_WORDS];
+    uint64_t hash;
+    uint64_t slot;
+    void *value;
+
+    biosal_kmer_table_pack_key(self, key, packed_key);
+    hash = biosal_kmer_table_hash(packed_key, self->key_words);
+
+    if (biosal_kmer_table_find(self, packed_key, hash, &slot)) {
+
+        if (inserted != NULL) {
+            *inserted = 0;
+        }
+
+        return biosal_kmer_table_slot_value(self, slot);
+    }
+
+    /*
+     * The slot is not valid anymore after a resize.
+     */
+    if (self->size >= self->resize_size) {
+        biosal_kmer_table_grow(self);
+        biosal_kmer_table_find(self, packed_key, hash, &slot);
+    }
+
+    self->tags[slot] = BIOSAL_KMER_TABLE_USED | (uint8_t)(hash >> 57);
+    core_memory_copy(self->keys + slot * self->key_words, packed_key,
+                    self->key_words * sizeof(uint64_t));
+
+    value = biosal_kmer_table_slot_value(self, slot);
+
+    if (value != NULL) {
+        memset(value, 0, self->value_size);
+    }
+
+    ++self->size;
+
+    if (inserted != NULL) {
+        *inserted = 1;
+    }
+
+    return value;
+}
+
+int biosal_kmer_table_increment(struct biosal_kmer_table *self, void *key, int count)
+{
+    int *value;
+
+    CORE_DEBUGGER_ASSERT(self->value_size == sizeof(int));
+
+    value = biosal_kmer_table_add(self, key, NULL);
+    *value += count;
+
+    return *value;
+}
+
+uint64_t biosal_kmer_table_size(struct biosal_kmer_table *self)
+{
+    return self->size;
+}
+
+uint64_t biosal_kmer_table_capacity(struct biosal_kmer_table *self)
+{
+    return self->capacity;
+}
+
+int biosal_kmer_table_key_size(struct biosal_kmer_table *self)
+{
+    return self->key_size;
+}
+
+int biosal_kmer_table_value_size(struct biosal_kmer_table *self)
+{
+    return self->value_size;
+}
+
+uint64_t biosal_kmer_table_memory_usage(struct biosal_kmer_table *self)
+{
+    return self->capacity * (1 + self->key_words * sizeof(uint64_t) + self->value_size);
+}
+
+void biosal_kmer_table_set_current_size_estimate(struct biosal_kmer_table *self, double value)
+{
+    uint64_t required;
+    uint64_t capacity;
+
+    if (value <= 0 || value > 1) {
+        return;
+    }
+
+    required = (uint64_t)((self->size / value) / self->threshold);
+    capacity = self->capacity;
+
+    while (capacity < required) {
+        capacity *= 2;
+    }
+
+    if (capacity > self->next_capacity) {
+        self->next_capacity = capacity;
+    }
+}
+
+void biosal_kmer_table_set_threshold(struct biosal_kmer_table *self, double threshold)
+{
+    self->threshold = threshold;
+    self->resize_size = (uint64_t)(self->capacity * self->threshold);
+}
+
+void biosal_kmer_table_examine(struct biosal_kmer_table *self)
+{
+    printf("biosal_kmer_table: size %" PRIu64 " capacity %" PRIu64 " load %f key_size %d (%d words) value_size %d"
+                    " memory %" PRIu64 " bytes (%.2f bytes per kmer)\n",
+                    self->size, self->capacity,
+                    self->capacity > 0 ? (double)self->size / self->capacity : 0.0,
+                    self->key_size, self->key_words, self->value_size,
+                    biosal_kmer_table_memory_usage(self),
+                    self->size > 0 ? (double)biosal_kmer_table_memory_usage(self) / self->size : 0.0);
+}
+
+uint64_t biosal_kmer_table_next_slot(struct biosal_kmer_table *self, uint64_t slot)
+{
+    while (slot < self->capacity && self->tags[slot] == BIOSAL_KMER_TABLE_EMPTY) {
+        ++slot;
+    }
+
+    return slot;
+}
+
+void *biosal_kmer_table_slot_key(struct biosal_kmer_table *self, uint64_t slot)
+{
+    return self->keys + slot * self->key_words;
+}
+
+void *biosal_kmer_table_slot_value(struct biosal_kmer_table *self, uint64_t slot)
+{
+    if (self->values == NULL) {
+        return NULL;
+    }
+
+    return self->values + slot * self->value_size;
+}
@@ -0,0 +1,98 @@
+
+#ifndef BIOSAL_KMER_TABLE_H
+#define BIOSAL_KMER_TABLE_H
+
+#include <stdint.h>
+
+struct core_memory_pool;
+
+/*
+ * A hash table for packed k-mer keys.
+ *
+ * Compared to core_map, the key is stored in 64-bit words and the
+ * lookup is specialized for keys of 1, 2 and 4 words (up to 31, 63 and
+ * 127 nucleotides in 2-bit encoding). Other key sizes work too, with a
+ * generic comparison.
+ *
+ * This is open addressing with linear probing on groups of 16 slots.
+ * Each slot has one metadata byte (0 for empty, or 7 bits of the hash),
+ * so that a group is checked with one SIMD compare before looking at
+ * any key. There is no deletion.
+ *
+ * biosal_kmer_table_add and biosal_kmer_table_increment hash and probe
+ * only once when the key is already there (the usual case when counting
+ * k-mers), instead of a get followed by an add.
+ *
+ * Values are zeroed when a key is added. Pointers to values are
+ * invalidated when a key is added.
+ */
+struct biosal_kmer_table {
+    uint8_t *tags;
+    uint64_t *keys;
+    char *values;
+
+    uint64_t size;
+    uint64_t capacity;
+    uint64_t resize_size;
+    uint64_t next_capacity;
+    double threshold;
+
+    int key_size;
+    int key_words;
+    int value_size;
+
+    struct core_memory_pool *memory;
+};
+
+void biosal_kmer_table_init(struct biosal_kmer_table *self, int key_size, int value_size,
+                struct core_memory_pool *memory);
+void biosal_kmer_table_destroy(struct biosal_kmer_table *self);
+
+/*
+ * \return the value for the key, or NULL
+ */
+void *biosal_kmer_table_get(struct biosal_kmer_table *self, void *key);
+
+/*
+ * Get the value for the key, adding the key if it is not there.
+ *
+ * \param inserted set to 1 if the key was added (can be NULL)
+ */
+void *biosal_kmer_table_add(struct biosal_kmer_table *self, void *key, int *inserted);
+
+/*
+ * Add @count to the counter of the key. The value size must be sizeof(int).
+ *
+ * \return the new count
+ */
+int biosal_kmer_table_increment(struct biosal_kmer_table *self, void *key, int count);
+
+uint64_t biosal_kmer_table_size(struct biosal_kmer_table *self);
+uint64_t biosal_kmer_table_capacity(struct biosal_kmer_table *self);
+int biosal_kmer_table_key_size(struct biosal_kmer_table *self);
+int biosal_kmer_table_value_size(struct biosal_kmer_table *self);
+
+/*
+ * \return the number of bytes used by the slots
+ */
+uint64_t biosal_kmer_table_memory_usage(struct biosal_kmer_table *self);
+
+/*
+ * Use the fraction of the input already seen (0 to 1) to pick the
+ * capacity of the next resize.
+ */
+void biosal_kmer_table_set_current_size_estimate(struct biosal_kmer_table *self, double value);
+void biosal_kmer_table_set_threshold(struct biosal_kmer_table *self, double threshold);
+
+void biosal_kmer_table_examine(struct biosal_kmer_table *self);
+
+/*
+ * Iteration over the slots, used by biosal_kmer_table_iterator.
+ *
+ * \return the next occupied slot starting at @slot, or the capacity
+ */
+uint64_t biosal_kmer_table_next_slot(struct biosal_kmer_table *self, uint64_t slot);
+void *biosal_kmer_table_slot_key(struct biosal_kmer_table *self, uint64_t slot);
+void *biosal_kmer_table_slot_value(struct biosal_kmer_table *self, uint64_t slot);
+
+#endif
@@ -0,0 +1,48 @@
+
+#include "kmer_table_iterator.h"
+
+#include "kmer_table.h"
+
+#include <stdlib.h>
+
+void biosal_kmer_table_iterator_init(struct biosal_kmer_table_iterator *self,
+                struct biosal_kmer_table *table)
+{
+    self->table = table;
+    self->slot = biosal_kmer_table_next_slot(table, 0);
+}
+
+void biosal_kmer_table_iterator_destroy(struct biosal_kmer_table_iterator *self)
+{
+    self->table = NULL;
+    self->slot = 0;
+}
+
+int biosal_kmer_table_iterator_has_next(struct biosal_kmer_table_iterator *self)
+{
+    if (self->table == NULL) {
+        return 0;
+    }
+
+    return self->slot < biosal_kmer_table_capacity(self->table);
+}
+
+int biosal_kmer_table_iterator_next(struct biosal_kmer_table_iterator *self, void **key,
+                void **value)
+{
+    if (!biosal_kmer_table_iterator_has_next(self)) {
+        return 0;
+    }
+
+    if (key != NULL) {
+        *key = biosal_kmer_table_slot_key(self->table, self->slot);
+    }
+
+    if (value != NULL) {
+        *value = biosal_kmer_table_slot_value(self->table, self->slot);
+    }
+
+    self->slot = biosal_kmer_table_next_slot(self->table, self->slot + 1);
+
+    return 1;
+}
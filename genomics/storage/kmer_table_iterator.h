@@ -0,0 +1,31 @@
+
+#ifndef BIOSAL_KMER_TABLE_ITERATOR_H
+#define BIOSAL_KMER_TABLE_ITERATOR_H
+
+#include <stdint.h>
+
+struct biosal_kmer_table;
+
+/*
+ * An iterator for biosal_kmer_table. The table must not
+ * receive new keys during the iteration.
+ */
+struct biosal_kmer_table_iterator {
+    struct biosal_kmer_table *table;
+    uint64_t slot;
+};
+
+void biosal_kmer_table_iterator_init(struct biosal_kmer_table_iterator *self,
+                struct biosal_kmer_table *table);
+void biosal_kmer_table_iterator_destroy(struct biosal_kmer_table_iterator *self);
+
+int biosal_kmer_table_iterator_has_next(struct biosal_kmer_table_iterator *self);
+
+/*
+ * The key is packed in 64-bit words, so its first key_size bytes
+ * are the original key.
+ */
+int biosal_kmer_table_iterator_next(struct biosal_kmer_table_iterator *self, void **key,
+                void **value);
+
+#endif
@@ -41,6 +41,8 @@ int biosal_sequence_store_check_open_error(struct thorium_actor *actor,
                 struct thorium_message *message);
 void biosal_sequence_store_push_sequence_data_block(struct thorium_actor *actor, struct thorium_message *message);
 void biosal_sequence_store_reserve(struct thorium_actor *actor, struct thorium_message *message);
+void biosal_sequence_store_append(struct thorium_actor *self, struct thorium_message *message);
+void biosal_sequence_store_seal(struct thorium_actor *self, struct thorium_message *message);
 void biosal_sequence_store_show_progress(struct thorium_actor *actor, struct thorium_message *message);
 
 void biosal_sequence_store_ask(struct thorium_actor *self, struct thorium_message *message);
@@ -94,6 +96,10 @@ void biosal_sequence_store_init(struct thorium_actor *actor)
 
     thorium_actor_add_action(actor, ACTION_SEQUENCE_STORE_ASK,
                     biosal_sequence_store_ask);
+    thorium_actor_add_action(actor, ACTION_SEQUENCE_STORE_APPEND,
+                    biosal_sequence_store_append);
+    thorium_actor_add_action(actor, ACTION_SEQUENCE_STORE_SEAL,
+                    biosal_sequence_store_seal);
 
     concrete_actor->iterator_started = 0;
     concrete_actor->reservation_producer = -1;
@@ -413,6 +419,70 @@ void biosal_sequence_store_reserve(struct thorium_actor *actor, struct thorium_m
     }
 }
 
+/*
+ * Append sequences (single-pass input). There is no reservation: the
+ * stores do not know how many sequences they will get.
+ */
+void biosal_sequence_store_append(struct thorium_actor *self, struct thorium_message *message)
+{
+    struct biosal_input_command payload;
+    struct biosal_sequence_store *concrete_self;
+    struct core_vector *new_entries;
+    struct biosal_dna_sequence *bucket_in_message;
+    struct biosal_dna_sequence *bucket_in_store;
+    int64_t first;
+    int64_t i;
+
+    concrete_self = thorium_actor_concrete_actor(self);
+
+    biosal_input_command_init_empty(&payload);
+    biosal_input_command_unpack(&payload, thorium_message_buffer(message),
+                    thorium_actor_get_ephemeral_memory(self), &concrete_self->codec);
+
+    new_entries = biosal_input_command_entries(&payload);
+    first = core_vector_size(&concrete_self->sequences);
+
+    core_vector_resize(&concrete_self->sequences, first + core_vector_size(new_entries));
+
+    for (i = 0; i < core_vector_size(new_entries); i++) {
+
+        if (concrete_self->received % 1000000 == 0) {
+            thorium_actor_log(self, "sequence store %d has %" PRId64 " entries\n",
+                            thorium_actor_name(self), concrete_self->received);
+        }
+
+        bucket_in_message = core_vector_at(new_entries, i);
+        bucket_in_store = core_vector_at(&concrete_self->sequences, first + i);
+
+        biosal_dna_sequence_init_copy(bucket_in_store, bucket_in_message,
+                        &concrete_self->codec, &concrete_self->persistent_memory);
+
+        concrete_self->received++;
+    }
+
+    biosal_input_command_destroy(&payload, thorium_actor_get_ephemeral_memory(self));
+
+    thorium_actor_send_reply_empty(self, ACTION_SEQUENCE_STORE_APPEND_REPLY);
+}
+
+/*
+ * All the appended sequences have been received, so the store is ready.
+ */
+void biosal_sequence_store_seal(struct thorium_actor *self, struct thorium_message *message)
+{
+    struct biosal_sequence_store *concrete_self;
+
+    concrete_self = thorium_actor_concrete_actor(self);
+
+    concrete_self->expected = concrete_self->received;
+    concrete_self->reservation_producer = thorium_message_source(message);
+
+    concrete_self->left = concrete_self->received;
+    concrete_self->last = 0;
+
+    biosal_sequence_store_show_progress(self, message);
+}
+
 void biosal_sequence_store_show_progress(struct thorium_actor *actor, struct thorium_message *message)
 {
     struct biosal_sequence_store *concrete_actor;
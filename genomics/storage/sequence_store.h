@@ -48,6 +48,15 @@ struct biosal_sequence_store {
 
 #define ACTION_SEQUENCE_STORE_READY 0x00002c00
 
+/*
+ * Single-pass input: streams append sequences without a reservation
+ * and the store becomes ready (ACTION_SEQUENCE_STORE_READY) when it
+ * is sealed.
+ */
+#define ACTION_SEQUENCE_STORE_APPEND 0x00003f71
+#define ACTION_SEQUENCE_STORE_APPEND_REPLY 0x00006c1e
+#define ACTION_SEQUENCE_STORE_SEAL 0x0000520d
+
 #define ACTION_SEQUENCE_STORE_ASK 0x00006b99
 #define ACTION_SEQUENCE_STORE_ASK_REPLY 0x00007b13
 
@@ -0,0 +1,251 @@
+
+#include "sharded_kmer_table.h"
+
+#include "kmer_table_iterator.h"
+
+#include <core/system/memory.h>
+#include <core/system/atomic.h>
+#include <core/system/debugger.h>
+
+#define MEMORY_POOL_NAME_SHARDED_KMER_TABLE 0x2d0c8e61
+#define MEMORY_POOL_NAME_KMER_TABLE_SHARD 0x6b41f0a3
+
+static inline uint32_t biosal_kmer_table_shard_sequence(struct biosal_kmer_table_shard *self);
+
+void biosal_kmer_table_shard_init(struct biosal_kmer_table_shard *self, int owner,
+                int key_size, int value_size)
+{
+    core_memory_pool_init(&self->memory, 0, MEMORY_POOL_NAME_KMER_TABLE_SHARD);
+    biosal_kmer_table_init(&self->table, key_size, value_size, &self->memory);
+
+    self->owner = owner;
+    self->sequence = 0;
+    self->frozen = 0;
+}
+
+void biosal_kmer_table_shard_destroy(struct biosal_kmer_table_shard *self)
+{
+    CORE_DEBUGGER_ASSERT(!(self->sequence & 1));
+
+    biosal_kmer_table_destroy(&self->table);
+    core_memory_pool_destroy(&self->memory);
+
+    self->owner = -1;
+}
+
+struct biosal_kmer_table *biosal_kmer_table_shard_table(struct biosal_kmer_table_shard *self)
+{
+    return &self->table;
+}
+
+int biosal_kmer_table_shard_owner(struct biosal_kmer_table_shard *self)
+{
+    return self->owner;
+}
+
+/*
+ * The sequence is odd while a write is in progress.
+ */
+void biosal_kmer_table_shard_begin_write(struct biosal_kmer_table_shard *self)
+{
+    CORE_DEBUGGER_ASSERT(!(self->sequence & 1));
+
+    core_atomic_increment(&self->sequence);
+}
+
+void biosal_kmer_table_shard_end_write(struct biosal_kmer_table_shard *self)
+{
+    CORE_DEBUGGER_ASSERT(self->sequence & 1);
+
+    core_atomic_increment(&self->sequence);
+}
+
+/*
+ * The keys added before are visible to the threads that see the flag.
+ */
+void biosal_kmer_table_shard_freeze(struct biosal_kmer_table_shard *self)
+{
+    CORE_DEBUGGER_ASSERT(!(self->sequence & 1));
+
+    core_memory_fence();
+    core_atomic_compare_and_swap_int(&self->frozen, 0, 1);
+}
+
+int biosal_kmer_table_shard_is_frozen(struct biosal_kmer_table_shard *self)
+{
+    return *(volatile int *)&self->frozen;
+}
+
+static inline uint32_t biosal_kmer_table_shard_sequence(struct biosal_kmer_table_shard *self)
+{
+    return *(volatile uint32_t *)&self->sequence;
+}
+
+int biosal_kmer_table_shard_read(struct biosal_kmer_table_shard *self, void *key, void *value)
+{
+    uint32_t before;
+    void *bucket;
+    int found;
+
+    /*
+     * The slots can still be freed by a resize.
+     */
+    if (!biosal_kmer_table_shard_is_frozen(self)) {
+        return 0;
+    }
+
+    while (1) {
+        before = biosal_kmer_table_shard_sequence(self);
+
+        if (before & 1) {
+            core_atomic_spin();
+            continue;
+        }
+
+        core_memory_fence();
+
+        found = 0;
+        bucket = biosal_kmer_table_get(&self->table, key);
+
+        if (bucket != NULL) {
+            core_memory_copy(value, bucket, biosal_kmer_table_value_size(&self->table));
+            found = 1;
+        }
+
+        core_memory_fence();
+
+        if (biosal_kmer_table_shard_sequence(self) == before) {
+            return found;
+        }
+    }
+
+    return 0;
+}
+
+void biosal_sharded_kmer_table_init(struct biosal_sharded_kmer_table *self, int key_size,
+                int value_size)
+{
+    core_memory_pool_init(&self->memory, 0, MEMORY_POOL_NAME_SHARDED_KMER_TABLE);
+    biosal_kmer_table_init(&self->shards, sizeof(int), sizeof(struct biosal_kmer_table_shard *),
+                    &self->memory);
+    core_spinlock_init(&self->lock);
+
+    self->key_size = key_size;
+    self->value_size = value_size;
+}
+
+void biosal_sharded_kmer_table_destroy(struct biosal_sharded_kmer_table *self)
+{
+    struct biosal_kmer_table_iterator iterator;
+    struct biosal_kmer_table_shard **bucket;
+
+    biosal_kmer_table_iterator_init(&iterator, &self->shards);
+
+    while (biosal_kmer_table_iterator_has_next(&iterator)) {
+        biosal_kmer_table_iterator_next(&iterator, NULL, (void **)&bucket);
+
+        biosal_kmer_table_shard_destroy(*bucket);
+        core_memory_pool_free(&self->memory, *bucket);
+    }
+
+    biosal_kmer_table_iterator_destroy(&iterator);
+
+    biosal_kmer_table_destroy(&self->shards);
+    core_spinlock_destroy(&self->lock);
+    core_memory_pool_destroy(&self->memory);
+
+    self->key_size = -1;
+    self->value_size = -1;
+}
+
+struct biosal_kmer_table_shard *biosal_sharded_kmer_table_add_shard(struct biosal_sharded_kmer_table *self,
+                int owner)
+{
+    struct biosal_kmer_table_shard **bucket;
+    struct biosal_kmer_table_shard *shard;
+    int inserted;
+
+    core_spinlock_lock(&self->lock);
+
+    bucket = biosal_kmer_table_add(&self->shards, &owner, &inserted);
+
+    CORE_DEBUGGER_ASSERT(inserted);
+
+    if (inserted) {
+        *bucket = core_memory_pool_allocate(&self->memory, sizeof(struct biosal_kmer_table_shard));
+        biosal_kmer_table_shard_init(*bucket, owner, self->key_size, self->value_size);
+    }
+
+    shard = *bucket;
+
+    core_spinlock_unlock(&self->lock);
+
+    return shard;
+}
+
+struct biosal_kmer_table_shard *biosal_sharded_kmer_table_get_shard(struct biosal_sharded_kmer_table *self,
+                int owner)
+{
+    struct biosal_kmer_table_shard **bucket;
+    struct biosal_kmer_table_shard *shard;
+
+    /*
+     * A shard added by another thread can resize the directory.
+     */
+    core_spinlock_lock(&self->lock);
+
+    shard = NULL;
+    bucket = biosal_kmer_table_get(&self->shards, &owner);
+
+    if (bucket != NULL) {
+        shard = *bucket;
+    }
+
+    core_spinlock_unlock(&self->lock);
+
+    return shard;
+}
+
+int biosal_sharded_kmer_table_read(struct biosal_sharded_kmer_table *self, int owner,
+                void *key, void *value)
+{
+    struct biosal_kmer_table_shard *shard;
+
+    shard = biosal_sharded_kmer_table_get_shard(self, owner);
+
+    if (shard == NULL) {
+        return 0;
+    }
+
+    return biosal_kmer_table_shard_read(shard, key, value);
+}
+
+int biosal_sharded_kmer_table_shard_count(struct biosal_sharded_kmer_table *self)
+{
+    return (int)biosal_kmer_table_size(&self->shards);
+}
+
+uint64_t biosal_sharded_kmer_table_size(struct biosal_sharded_kmer_table *self)
+{
+    struct biosal_kmer_table_iterator iterator;
+    struct biosal_kmer_table_shard **bucket;
+    uint64_t size;
+
+    size = 0;
+    biosal_kmer_table_iterator_init(&iterator, &self->shards);
+
+    while (biosal_kmer_table_iterator_has_next(&iterator)) {
+        biosal_kmer_table_iterator_next(&iterator, NULL, (void **)&bucket);
+
+        size += biosal_kmer_table_size(&(*bucket)->table);
+    }
+
+    biosal_kmer_table_iterator_destroy(&iterator);
+
+    return size;
+}
+
+int biosal_sharded_kmer_table_key_size(struct biosal_sharded_kmer_table *self)
+{
+    return self->key_size;
+}
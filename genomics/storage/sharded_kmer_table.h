@@ -0,0 +1,105 @@
+
+#ifndef BIOSAL_SHARDED_KMER_TABLE_H
+#define BIOSAL_SHARDED_KMER_TABLE_H
+
+#include "kmer_table.h"
+
+#include <core/system/memory_pool.h>
+#include <core/system/spinlock.h>
+
+#include <stdint.h>
+
+/*
+ * A shard of a biosal_sharded_kmer_table.
+ *
+ * A shard has exactly one writer, its owner. The owner brackets its
+ * changes with biosal_kmer_table_shard_begin_write and
+ * biosal_kmer_table_shard_end_write (a sequence lock), so that other
+ * threads read values with biosal_kmer_table_shard_read without taking
+ * any lock: a read is retried if a write happened during the copy.
+ *
+ * A resize frees the old slots, so the owner freezes the shard with
+ * biosal_kmer_table_shard_freeze once it stops adding keys, and reads
+ * are rejected before that. Values can still change after.
+ */
+struct biosal_kmer_table_shard {
+    struct biosal_kmer_table table;
+    struct core_memory_pool memory;
+    int owner;
+    uint32_t sequence;
+    int frozen;
+};
+
+void biosal_kmer_table_shard_init(struct biosal_kmer_table_shard *self, int owner,
+                int key_size, int value_size);
+void biosal_kmer_table_shard_destroy(struct biosal_kmer_table_shard *self);
+
+struct biosal_kmer_table *biosal_kmer_table_shard_table(struct biosal_kmer_table_shard *self);
+int biosal_kmer_table_shard_owner(struct biosal_kmer_table_shard *self);
+
+void biosal_kmer_table_shard_begin_write(struct biosal_kmer_table_shard *self);
+void biosal_kmer_table_shard_end_write(struct biosal_kmer_table_shard *self);
+
+/*
+ * No key is added after this. This is called by the owner.
+ */
+void biosal_kmer_table_shard_freeze(struct biosal_kmer_table_shard *self);
+int biosal_kmer_table_shard_is_frozen(struct biosal_kmer_table_shard *self);
+
+/*
+ * Copy the value of a key.
+ *
+ * \return 1 if the key was found, 0 otherwise (or if the shard is not
+ * frozen yet)
+ */
+int biosal_kmer_table_shard_read(struct biosal_kmer_table_shard *self, void *key, void *value);
+
+/*
+ * A k-mer table shared by the threads of a process, made of one shard
+ * per owner. The owner of a key is decided by the caller, so each
+ * shard only receives the keys of its owner and inserts never contend.
+ *
+ * The directory of shards is protected by a lock, so shards can be
+ * added while other threads find shards. A shard is read without a
+ * lock. The table is destroyed only after all the readers have
+ * stopped: the caller keeps track of them.
+ */
+struct biosal_sharded_kmer_table {
+    struct biosal_kmer_table shards;
+    struct core_memory_pool memory;
+    struct core_spinlock lock;
+    int key_size;
+    int value_size;
+};
+
+void biosal_sharded_kmer_table_init(struct biosal_sharded_kmer_table *self, int key_size,
+                int value_size);
+void biosal_sharded_kmer_table_destroy(struct biosal_sharded_kmer_table *self);
+
+/*
+ * Add a shard for @owner. This is thread-safe.
+ */
+struct biosal_kmer_table_shard *biosal_sharded_kmer_table_add_shard(struct biosal_sharded_kmer_table *self,
+                int owner);
+
+/*
+ * Find the shard of @owner. This is thread-safe.
+ *
+ * \return the shard of @owner, or NULL if @owner has no shard here
+ */
+struct biosal_kmer_table_shard *biosal_sharded_kmer_table_get_shard(struct biosal_sharded_kmer_table *self,
+                int owner);
+
+/*
+ * Read the value of a key in the shard of @owner.
+ *
+ * \return 1 if the key was found, 0 otherwise (or if there is no shard)
+ */
+int biosal_sharded_kmer_table_read(struct biosal_sharded_kmer_table *self, int owner,
+                void *key, void *value);
+
+int biosal_sharded_kmer_table_shard_count(struct biosal_sharded_kmer_table *self);
+uint64_t biosal_sharded_kmer_table_size(struct biosal_sharded_kmer_table *self);
+int biosal_sharded_kmer_table_key_size(struct biosal_sharded_kmer_table *self);
+
+#endif
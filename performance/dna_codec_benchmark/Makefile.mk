@@ -0,0 +1,9 @@
+APPLICATION_DNA_CODEC_BENCHMARK_PRODUCT=performance/dna_codec_benchmark/dna_codec_benchmark
+APPLICATION_DNA_CODEC_BENCHMARK_OBJECTS=performance/dna_codec_benchmark/main.o
+
+APPLICATION_EXECUTABLES+=$(APPLICATION_DNA_CODEC_BENCHMARK_PRODUCT)
+APPLICATION_OBJECTS+=$(APPLICATION_DNA_CODEC_BENCHMARK_OBJECTS)
+
+$(APPLICATION_DNA_CODEC_BENCHMARK_PRODUCT): $(APPLICATION_DNA_CODEC_BENCHMARK_OBJECTS) $(LIBRARY_OBJECTS)
+	$(Q)$(ECHO) "  LD $@"
+	$(Q)$(CC) $(CFLAGS) $^ -o $@ $(LDFLAGS) $(CONFIG_LDFLAGS)
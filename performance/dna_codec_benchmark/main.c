@@ -0,0 +1,216 @@
+
+#include <genomics/data/dna_codec.h>
+#include <genomics/data/dna_codec_interface.h>
+
+#include <core/system/timer.h>
+#include <core/system/memory.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+/*
+ * Microbenchmark for the 2-bit kernels of the DNA codec.
+ *
+ * Usage:
+ *
+ * performance/dna_codec_benchmark/dna_codec_benchmark [-length 150] [-sequences 100000] [-rounds 10]
+ *
+ * Each implementation encodes, decodes and reverse-complements the same
+ * random sequences, and the output bytes are checked against the default
+ * implementation.
+ */
+
+#define MEMORY_BENCHMARK -1
+
+static int get_option(int argc, char **argv, const char *name, int default_value);
+static double get_rate(uint64_t nucleotides, uint64_t nanoseconds);
+
+int main(int argc, char **argv)
+{
+    struct biosal_dna_codec_interface *implementations[] = {
+        &biosal_dna_codec_default_implementation,
+        &biosal_dna_codec_word_implementation,
+        &biosal_dna_codec_sse41_implementation,
+        &biosal_dna_codec_avx2_implementation
+    };
+    struct biosal_dna_codec codec;
+    struct biosal_dna_codec_interface *implementation;
+    struct core_timer timer;
+    char symbols[] = "ACGT";
+    int length;
+    int sequences;
+    int rounds;
+    int encoded_length;
+    int i;
+    int j;
+    int round;
+    char *dna;
+    char *decoded;
+    uint8_t *encoded;
+    uint8_t *expected;
+    uint64_t nucleotides;
+    uint64_t encode_time;
+    uint64_t decode_time;
+    uint64_t reverse_complement_time;
+    double default_encode_rate;
+    double default_decode_rate;
+    double default_reverse_complement_rate;
+    double encode_rate;
+    double decode_rate;
+    double reverse_complement_rate;
+    int correct;
+
+    length = get_option(argc, argv, "-length", 150);
+    sequences = get_option(argc, argv, "-sequences", 100000);
+    rounds = get_option(argc, argv, "-rounds", 10);
+
+    biosal_dna_codec_init(&codec);
+    biosal_dna_codec_enable_two_bit_encoding(&codec);
+
+    encoded_length = biosal_dna_codec_encoded_length(&codec, length);
+
+    dna = core_memory_allocate((size_t)sequences * (length + 1), MEMORY_BENCHMARK);
+    decoded = core_memory_allocate((size_t)sequences * (length + 1), MEMORY_BENCHMARK);
+    encoded = core_memory_allocate((size_t)sequences * encoded_length, MEMORY_BENCHMARK);
+    expected = core_memory_allocate((size_t)sequences * encoded_length, MEMORY_BENCHMARK);
+
+    srand(42);
+
+    for (i = 0; i < sequences; ++i) {
+        for (j = 0; j < length; ++j) {
+            dna[(size_t)i * (length + 1) + j] = symbols[rand() % 4];
+        }
+
+        dna[(size_t)i * (length + 1) + length] = '\0';
+    }
+
+    nucleotides = (uint64_t)sequences * length * rounds;
+
+    printf("DNA codec benchmark: %d sequences of %d nucleotides, %d rounds, selected implementation: %s\n",
+                    sequences, length, rounds,
+                    biosal_dna_codec_get_interface(&codec)->name);
+    printf("%-10s %14s %14s %14s %s\n", "kernel", "encode (Mnt/s)", "decode (Mnt/s)",
+                    "revcomp (Mnt/s)", "speedup (encode/decode/revcomp)");
+
+    default_encode_rate = 0;
+    default_decode_rate = 0;
+    default_reverse_complement_rate = 0;
+
+    core_timer_init(&timer);
+
+    for (j = 0; j < (int)(sizeof(implementations) / sizeof(implementations[0])); ++j) {
+
+        implementation = implementations[j];
+
+        if (!implementation->is_supported()) {
+            printf("%-10s not supported\n", implementation->name);
+            continue;
+        }
+
+        biosal_dna_codec_set_interface(&codec, implementation);
+
+        core_timer_start(&timer);
+
+        for (round = 0; round < rounds; ++round) {
+            for (i = 0; i < sequences; ++i) {
+                biosal_dna_codec_encode(&codec, length, dna + (size_t)i * (length + 1),
+                                encoded + (size_t)i * encoded_length);
+            }
+        }
+
+        core_timer_stop(&timer);
+        encode_time = core_timer_get_elapsed_nanoseconds(&timer);
+
+        core_timer_start(&timer);
+
+        for (round = 0; round < rounds; ++round) {
+            for (i = 0; i < sequences; ++i) {
+                biosal_dna_codec_decode(&codec, length, encoded + (size_t)i * encoded_length,
+                                decoded + (size_t)i * (length + 1));
+            }
+        }
+
+        core_timer_stop(&timer);
+        decode_time = core_timer_get_elapsed_nanoseconds(&timer);
+
+        correct = memcmp(dna, decoded, (size_t)sequences * (length + 1)) == 0;
+
+        /*
+         * An even number of reverse complements gives back the
+         * encoded sequences.
+         */
+        core_timer_start(&timer);
+
+        for (round = 0; round < 2 * ((rounds + 1) / 2); ++round) {
+            for (i = 0; i < sequences; ++i) {
+                biosal_dna_codec_reverse_complement_in_place(&codec, length,
+                                encoded + (size_t)i * encoded_length);
+            }
+        }
+
+        core_timer_stop(&timer);
+        reverse_complement_time = core_timer_get_elapsed_nanoseconds(&timer);
+
+        if (j == 0) {
+            memcpy(expected, encoded, (size_t)sequences * encoded_length);
+        } else if (memcmp(expected, encoded, (size_t)sequences * encoded_length) != 0) {
+            correct = 0;
+        }
+
+        encode_rate = get_rate(nucleotides, encode_time);
+        decode_rate = get_rate(nucleotides, decode_time);
+        reverse_complement_rate = get_rate((uint64_t)sequences * length * 2 * ((rounds + 1) / 2),
+                        reverse_complement_time);
+
+        if (j == 0) {
+            default_encode_rate = encode_rate;
+            default_decode_rate = decode_rate;
+            default_reverse_complement_rate = reverse_complement_rate;
+        }
+
+        printf("%-10s %14.1f %14.1f %14.1f %.1fx %.1fx %.1fx%s\n", implementation->name,
+                        encode_rate, decode_rate, reverse_complement_rate,
+                        encode_rate / default_encode_rate,
+                        decode_rate / default_decode_rate,
+                        reverse_complement_rate / default_reverse_complement_rate,
+                        correct ? "" : " (WRONG RESULT)");
+    }
+
+    core_timer_destroy(&timer);
+
+    core_memory_free(dna, MEMORY_BENCHMARK);
+    core_memory_free(decoded, MEMORY_BENCHMARK);
+    core_memory_free(encoded, MEMORY_BENCHMARK);
+    core_memory_free(expected, MEMORY_BENCHMARK);
+
+    biosal_dna_codec_destroy(&codec);
+
+    return 0;
+}
+
+static int get_option(int argc, char **argv, const char *name, int default_value)
+{
+    int i;
+
+    for (i = 1; i < argc - 1; ++i) {
+        if (strcmp(argv[i], name) == 0) {
+            return atoi(argv[i + 1]);
+        }
+    }
+
+    return default_value;
+}
+
+/*
+ * \return millions of nucleotides per second
+ */
+static double get_rate(uint64_t nucleotides, uint64_t nanoseconds)
+{
+    if (nanoseconds == 0) {
+        return 0;
+    }
+
+    return (nucleotides * 1000.0) / nanoseconds;
+}
@@ -0,0 +1,177 @@
+#!/usr/bin/env python
+
+# Convert the files written with -trace-events (node_<name>_events.bin)
+# to the Chrome trace event format (JSON).
+#
+# The output can be loaded in chrome://tracing or in https://ui.perfetto.dev
+#
+# usage: convert-to-chrome-trace.py node_0_events.bin node_1_events.bin ... > trace.json
+#
+# \see tracepoints/event_tracer.h
+# \see https://docs.google.com/document/d/1CvAClvFfyA5R-PhYUmn5OOQtYMH4h6I0nSsKchNAySU
+
+import json
+import struct
+import sys
+
+MAGIC = 0x544e5645
+VERSION = 1
+
+HEADER_FORMAT = "<IIII"
+EVENT_FORMAT = "<Qiiiiii"
+
+ACTOR_RECEIVE_ENTER = 0
+ACTOR_RECEIVE_EXIT = 1
+ACTOR_SEND = 2
+MULTIPLEXER_FLUSH = 3
+TRANSPORT_SEND = 4
+TRANSPORT_RECEIVE = 5
+
+THREAD_NODE = -1
+THREAD_NODE_SEND = -2
+
+FLUSH_REASONS = {1: "size", 2: "timeout", 3: "degree of aggregation"}
+
+def get_thread_identifier(thread):
+    if thread == THREAD_NODE:
+        return 1000
+    elif thread == THREAD_NODE_SEND:
+        return 1001
+    return thread
+
+def get_thread_name(thread):
+    if thread == THREAD_NODE:
+        return "node"
+    elif thread == THREAD_NODE_SEND:
+        return "node send"
+    return "worker " + str(thread)
+
+def get_action(action):
+    return "0x%x" % (action & 0xffffffff)
+
+def read_events(file_name):
+    stream = open(file_name, "rb")
+    data = stream.read()
+    stream.close()
+
+    header_size = struct.calcsize(HEADER_FORMAT)
+
+    if len(data) < header_size:
+        sys.stderr.write("Error: " + file_name + " is too small\n")
+        sys.exit(1)
+
+    magic, version, node, event_size = struct.unpack_from(HEADER_FORMAT, data, 0)
+
+    if magic != MAGIC or version != VERSION or event_size < struct.calcsize(EVENT_FORMAT):
+        sys.stderr.write("Error: " + file_name + " is not an event file\n")
+        sys.exit(1)
+
+    events = []
+    offset = header_size
+
+    while offset + event_size <= len(data):
+        events.append(struct.unpack_from(EVENT_FORMAT, data, offset))
+        offset += event_size
+
+    return node, events
+
+def convert(node, events, origin, output):
+    threads = set()
+
+    # Open receive events, for each thread.
+    stacks = {}
+
+    # The events of a ring are in order, but the rings are drained together.
+    events.sort(key=lambda event: event[0])
+
+    for time, kind, thread, actor, peer, action, count in events:
+        threads.add(thread)
+
+        timestamp = (time - origin) / 1000.0
+        base = {"pid": node, "tid": get_thread_identifier(thread), "ts": timestamp}
+
+        if kind == ACTOR_RECEIVE_ENTER:
+            stacks.setdefault(thread, []).append((time, actor, peer, action, count))
+
+        elif kind == ACTOR_RECEIVE_EXIT:
+            stack = stacks.get(thread, [])
+
+            if len(stack) == 0:
+                continue
+
+            start, actor, peer, action, count = stack.pop()
+
+            event = dict(base)
+            event["ts"] = (start - origin) / 1000.0
+            event["ph"] = "X"
+            event["dur"] = (time - start) / 1000.0
+            event["name"] = "receive " + get_action(action)
+            event["cat"] = "actor"
+            event["args"] = {"actor": actor, "source": peer, "count": count}
+            output.append(event)
+
+        else:
+            event = dict(base)
+            event["ph"] = "i"
+            event["s"] = "t"
+
+            if kind == ACTOR_SEND:
+                event["name"] = "send " + get_action(action)
+                event["cat"] = "actor"
+                event["args"] = {"source": actor, "destination": peer, "count": count}
+
+            elif kind == MULTIPLEXER_FLUSH:
+                event["name"] = "multiplexer flush"
+                event["cat"] = "multiplexer"
+                event["args"] = {"messages": actor, "destination_node": peer,
+                                "reason": FLUSH_REASONS.get(action, action), "count": count}
+
+            elif kind == TRANSPORT_SEND:
+                event["name"] = "transport send " + get_action(action)
+                event["cat"] = "transport"
+                event["args"] = {"source": actor, "destination_node": peer, "count": count}
+
+            elif kind == TRANSPORT_RECEIVE:
+                event["name"] = "transport receive " + get_action(action)
+                event["cat"] = "transport"
+                event["args"] = {"destination": actor, "source_node": peer, "count": count}
+
+            else:
+                continue
+
+            output.append(event)
+
+    output.append({"pid": node, "ph": "M", "name": "process_name",
+                    "args": {"name": "node " + str(node)}})
+
+    for thread in threads:
+        output.append({"pid": node, "tid": get_thread_identifier(thread), "ph": "M",
+                        "name": "thread_name", "args": {"name": get_thread_name(thread)}})
+
+def main():
+    if len(sys.argv) < 2:
+        sys.stderr.write("usage: " + sys.argv[0] + " node_0_events.bin ... > trace.json\n")
+        sys.exit(1)
+
+    files = []
+
+    for file_name in sys.argv[1:]:
+        files.append(read_events(file_name))
+
+    # The clock is the same for the processes of a host.
+    origin = None
+
+    for node, events in files:
+        for event in events:
+            if origin is None or event[0] < origin:
+                origin = event[0]
+
+    output = []
+
+    for node, events in files:
+        convert(node, events, origin, output)
+
+    json.dump({"traceEvents": output, "displayTimeUnit": "ns"}, sys.stdout)
+    sys.stdout.write("\n")
+
+main()
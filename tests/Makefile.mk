@@ -15,6 +15,9 @@ test: tests
 # - application-tests
 #   Run applications in applications/
 #
+# - single-pass-input-test
+#   Compare -single-pass-input with the two-pass input (argonnite)
+#
 # - all-tests				(synonym: qa, this runs all tests)
 #
 # Test results are generated in standard output.
@@ -59,6 +62,9 @@ example-tests: examples
 application-tests:
 	tests/run-application-tests.sh
 
+single-pass-input-test: applications/argonnite_kmer_counter/argonnite
+	tests/test_single_pass_input.sh
+
 examples: mock_examples
 	tests/run-examples.sh
 
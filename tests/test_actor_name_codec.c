@@ -0,0 +1,118 @@
+
+#include <engine/thorium/actor_name_codec.h>
+
+#include "test.h"
+
+#include <limits.h>
+
+int main(int argc, char **argv)
+{
+    struct thorium_actor_name_codec codec;
+    int node_counts[] = { 1, 2, 3, 64, 4096, 8192, 100000 };
+    int node_count_size;
+    int nodes;
+    int node;
+    int name;
+    int stale_name;
+    int slot;
+    int generation;
+    int decoded_slot;
+    int decoded_generation;
+    int slots;
+    int i;
+    int j;
+
+    BEGIN_TESTS();
+
+    node_count_size = sizeof(node_counts) / sizeof(int);
+
+    for (i = 0; i < node_count_size; ++i) {
+        nodes = node_counts[i];
+        node = nodes - 1;
+
+        TEST_INT_EQUALS(thorium_actor_name_codec_init(&codec, node, nodes), 1);
+
+        slots = thorium_actor_name_codec_slots(&codec);
+
+        TEST_INT_IS_GREATER_THAN_OR_EQUAL(slots, THORIUM_ACTOR_NAME_CODEC_MINIMUM_SLOTS);
+        TEST_INT_IS_LOWER_THAN_OR_EQUAL(slots, THORIUM_ACTOR_NAME_CODEC_MAXIMUM_SLOTS);
+        TEST_INT_IS_GREATER_THAN_OR_EQUAL(thorium_actor_name_codec_generation_count(&codec),
+                        THORIUM_ACTOR_NAME_CODEC_MINIMUM_GENERATIONS);
+
+        /*
+         * Round trip, including the largest name of the last node.
+         */
+        for (j = 0; j < 3; ++j) {
+            slot = (j == 0) ? 0 : ((j == 1) ? slots / 2 : slots - 1);
+
+            generation = THORIUM_ACTOR_NAME_CODEC_FIRST_GENERATION;
+
+            do {
+                name = thorium_actor_name_codec_encode(&codec, slot, generation);
+
+                TEST_INT_IS_GREATER_THAN_OR_EQUAL(name, 0);
+                TEST_INT_EQUALS(name % nodes, node);
+                TEST_INT_EQUALS(thorium_actor_name_codec_decode(&codec, name,
+                                        &decoded_slot, &decoded_generation), 1);
+                TEST_INT_EQUALS(decoded_slot, slot);
+                TEST_INT_EQUALS(decoded_generation, generation);
+
+                generation = thorium_actor_name_codec_next_generation(&codec, generation);
+
+            } while (generation != THORIUM_ACTOR_NAME_CODEC_FIRST_GENERATION);
+        }
+
+        /*
+         * Names of other nodes are rejected.
+         */
+        if (nodes > 1) {
+            TEST_INT_EQUALS(thorium_actor_name_codec_decode(&codec, node - 1,
+                                    &decoded_slot, &decoded_generation), 0);
+        }
+
+        TEST_INT_EQUALS(thorium_actor_name_codec_decode(&codec, -1,
+                                &decoded_slot, &decoded_generation), 0);
+
+        thorium_actor_name_codec_destroy(&codec);
+    }
+
+    /*
+     * With too many nodes, there is no layout that fits in an int.
+     */
+    TEST_INT_EQUALS(thorium_actor_name_codec_init(&codec, 0, 1000000), 0);
+    TEST_INT_EQUALS(thorium_actor_name_codec_init(&codec, 0, INT_MAX), 0);
+    TEST_INT_EQUALS(thorium_actor_name_codec_init(&codec, 4, 4), 0);
+
+    /*
+     * A stale name does not resolve to the next actors of its slot
+     * before the generations wrap around.
+     */
+    thorium_actor_name_codec_init(&codec, 5, 4096);
+
+    slot = 17;
+    generation = THORIUM_ACTOR_NAME_CODEC_FIRST_GENERATION;
+    stale_name = thorium_actor_name_codec_encode(&codec, slot, generation);
+
+    for (i = 1; i < thorium_actor_name_codec_generation_count(&codec); ++i) {
+        /*
+         * The actor in the slot dies and the slot is reused.
+         */
+        generation = thorium_actor_name_codec_next_generation(&codec, generation);
+        name = thorium_actor_name_codec_encode(&codec, slot, generation);
+
+        TEST_INT_NOT_EQUALS(name, stale_name);
+
+        thorium_actor_name_codec_decode(&codec, stale_name, &decoded_slot, &decoded_generation);
+        TEST_INT_EQUALS(decoded_slot, slot);
+        TEST_INT_NOT_EQUALS(decoded_generation, generation);
+    }
+
+    generation = thorium_actor_name_codec_next_generation(&codec, generation);
+    TEST_INT_EQUALS(generation, THORIUM_ACTOR_NAME_CODEC_FIRST_GENERATION);
+
+    thorium_actor_name_codec_destroy(&codec);
+
+    END_TESTS();
+
+    return 0;
+}
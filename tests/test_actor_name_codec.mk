@@ -0,0 +1,13 @@
+TEST_ACTOR_NAME_CODEC_NAME=actor_name_codec
+TEST_ACTOR_NAME_CODEC_EXECUTABLE=tests/test_$(TEST_ACTOR_NAME_CODEC_NAME)
+TEST_ACTOR_NAME_CODEC_OBJECTS=tests/test_$(TEST_ACTOR_NAME_CODEC_NAME).o
+TEST_EXECUTABLES+=$(TEST_ACTOR_NAME_CODEC_EXECUTABLE)
+TEST_OBJECTS+=$(TEST_ACTOR_NAME_CODEC_OBJECTS)
+$(TEST_ACTOR_NAME_CODEC_EXECUTABLE): $(LIBRARY_OBJECTS) $(TEST_ACTOR_NAME_CODEC_OBJECTS) $(TEST_LIBRARY_OBJECTS)
+	$(Q)$(ECHO) "  LD $@"
+	$(Q)$(CC) $(CFLAGS) $^ -o $@ $(LDFLAGS) $(CONFIG_LDFLAGS)
+TEST_ACTOR_NAME_CODEC_RUN=test_run_$(TEST_ACTOR_NAME_CODEC_NAME)
+$(TEST_ACTOR_NAME_CODEC_RUN): $(TEST_ACTOR_NAME_CODEC_EXECUTABLE)
+	./$^
+TEST_RUNS+=$(TEST_ACTOR_NAME_CODEC_RUN)
+
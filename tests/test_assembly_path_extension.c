@@ -0,0 +1,251 @@
+
+#include "test.h"
+
+#include <genomics/assembly/assembly_path_extension.h>
+#include <genomics/assembly/assembly_graph_store.h>
+#include <genomics/assembly/assembly_vertex.h>
+
+#include <genomics/storage/kmer_table.h>
+#include <genomics/data/dna_kmer.h>
+#include <genomics/data/dna_codec.h>
+
+#include <core/system/memory_pool.h>
+
+#include <string.h>
+
+#define KMER_LENGTH 15
+
+/*
+ * Get the vertex of the kmer at @position in @sequence, in the table.
+ */
+static struct biosal_assembly_vertex *get_vertex(struct biosal_kmer_table *table, char *sequence,
+                int position, struct biosal_dna_codec *codec, struct core_memory_pool *pool,
+                int add)
+{
+    char kmer_sequence[KMER_LENGTH + 1];
+    char key[64];
+    struct biosal_dna_kmer kmer;
+    struct biosal_assembly_vertex *vertex;
+
+    memcpy(kmer_sequence, sequence + position, KMER_LENGTH);
+    kmer_sequence[KMER_LENGTH] = '\0';
+
+    biosal_dna_kmer_init(&kmer, kmer_sequence, codec, pool);
+    biosal_dna_kmer_pack_store_key(&kmer, key, KMER_LENGTH, codec, pool);
+
+    if (add) {
+        vertex = biosal_kmer_table_add(table, key, NULL);
+    } else {
+        vertex = biosal_kmer_table_get(table, key);
+    }
+
+    biosal_dna_kmer_destroy(&kmer, pool);
+
+    return vertex;
+}
+
+int main(int argc, char **argv)
+{
+    char sequence[] = "ATGATCTGCAGTACTGACCGTTAGCATTCGGATCCAAGT";
+    char kmer_sequence[KMER_LENGTH + 1];
+    char step_sequence[KMER_LENGTH + 1];
+    struct biosal_dna_codec codec;
+    struct core_memory_pool pool;
+    struct biosal_kmer_table table;
+    struct biosal_assembly_path_extension extension;
+    struct biosal_assembly_vertex oriented_vertex;
+    struct biosal_assembly_vertex *vertex;
+    struct biosal_dna_kmer kmer;
+    struct biosal_dna_kmer last_kmer;
+    struct biosal_dna_kmer step_kmer;
+    int kmer_count;
+    int key_length;
+    int steps;
+    int used;
+    int store_index;
+    int step_store_index;
+    int i;
+
+    BEGIN_TESTS();
+
+    biosal_dna_codec_init(&codec);
+    biosal_dna_codec_enable_two_bit_encoding(&codec);
+    core_memory_pool_init(&pool, 1000000, -1);
+
+    kmer_count = strlen(sequence) - KMER_LENGTH + 1;
+
+    memcpy(kmer_sequence, sequence, KMER_LENGTH);
+    kmer_sequence[KMER_LENGTH] = '\0';
+    biosal_dna_kmer_init(&kmer, kmer_sequence, &codec, &pool);
+
+    memcpy(kmer_sequence, sequence + kmer_count - 1, KMER_LENGTH);
+    biosal_dna_kmer_init(&last_kmer, kmer_sequence, &codec, &pool);
+
+    key_length = biosal_dna_kmer_pack_size(&kmer, KMER_LENGTH, &codec);
+    biosal_kmer_table_init(&table, key_length, sizeof(struct biosal_assembly_vertex), NULL);
+
+    /*
+     * One linear path of unitig vertices. Like in the graph store, the
+     * table has the vertex of the canonical kmer.
+     */
+    for (i = 0; i < kmer_count; ++i) {
+
+        biosal_assembly_vertex_init(&oriented_vertex);
+
+        if (i > 0) {
+            biosal_assembly_vertex_add_parent(&oriented_vertex,
+                            biosal_dna_codec_get_code(sequence[i - 1]));
+        }
+        if (i < kmer_count - 1) {
+            biosal_assembly_vertex_add_child(&oriented_vertex,
+                            biosal_dna_codec_get_code(sequence[i + KMER_LENGTH]));
+        }
+
+        biosal_assembly_vertex_set_flag(&oriented_vertex, BIOSAL_VERTEX_FLAG_UNITIG);
+
+        memcpy(kmer_sequence, sequence + i, KMER_LENGTH);
+        biosal_dna_kmer_init(&step_kmer, kmer_sequence, &codec, &pool);
+
+        if (!biosal_dna_kmer_is_canonical(&step_kmer, KMER_LENGTH, &codec)) {
+            biosal_assembly_vertex_invert_arcs(&oriented_vertex);
+        }
+
+        biosal_dna_kmer_destroy(&step_kmer, &pool);
+
+        vertex = get_vertex(&table, sequence, i, &codec, &pool, 1);
+        *vertex = oriented_vertex;
+    }
+
+    TEST_INT_EQUALS(biosal_kmer_table_size(&table), kmer_count);
+
+    /*
+     * The whole path, in both directions.
+     */
+    biosal_assembly_path_extension_init(&extension, &table, KMER_LENGTH, key_length,
+                    &codec, &codec, &pool);
+    steps = biosal_assembly_path_extension_walk(&extension, &kmer,
+                    BIOSAL_ASSEMBLY_GRAPH_STORE_DIRECTION_CHILD, 0, 1,
+                    BIOSAL_ASSEMBLY_GRAPH_STORE_MAXIMUM_EXTENSION_LENGTH);
+    TEST_INT_EQUALS(steps, kmer_count);
+
+    for (i = 0; i < steps; ++i) {
+        biosal_dna_kmer_get_sequence(biosal_assembly_path_extension_kmer(&extension, i),
+                        step_sequence, KMER_LENGTH, &codec);
+        TEST_INT_EQUALS(memcmp(step_sequence, sequence + i, KMER_LENGTH), 0);
+
+        vertex = biosal_assembly_path_extension_vertex(&extension, i);
+        if (i < steps - 1) {
+            TEST_INT_EQUALS(biosal_assembly_vertex_child_count(vertex), 1);
+        }
+        TEST_POINTER_EQUALS(biosal_assembly_path_extension_canonical_vertex(&extension, i),
+                        get_vertex(&table, sequence, i, &codec, &pool, 0));
+    }
+    biosal_assembly_path_extension_destroy(&extension);
+
+    biosal_assembly_path_extension_init(&extension, &table, KMER_LENGTH, key_length,
+                    &codec, &codec, &pool);
+    steps = biosal_assembly_path_extension_walk(&extension, &last_kmer,
+                    BIOSAL_ASSEMBLY_GRAPH_STORE_DIRECTION_PARENT, 0, 1,
+                    BIOSAL_ASSEMBLY_GRAPH_STORE_MAXIMUM_EXTENSION_LENGTH);
+    TEST_INT_EQUALS(steps, kmer_count);
+    biosal_assembly_path_extension_destroy(&extension);
+
+    /*
+     * An extension cut short: the graph store claimed all the steps,
+     * the walker accepted 3 of them, and walking again releases the
+     * others (like ACTION_ASSEMBLY_RELEASE_PATH_EXTENSION).
+     */
+    biosal_assembly_path_extension_init(&extension, &table, KMER_LENGTH, key_length,
+                    &codec, &codec, &pool);
+    steps = biosal_assembly_path_extension_walk(&extension, &kmer,
+                    BIOSAL_ASSEMBLY_GRAPH_STORE_DIRECTION_CHILD, 0, 1,
+                    BIOSAL_ASSEMBLY_GRAPH_STORE_MAXIMUM_EXTENSION_LENGTH);
+    TEST_INT_EQUALS(steps, kmer_count);
+
+    for (i = 0; i < steps; ++i) {
+        biosal_assembly_vertex_set_flag(biosal_assembly_path_extension_canonical_vertex(&extension, i),
+                        BIOSAL_VERTEX_FLAG_USED_BY_WALKER);
+    }
+    biosal_assembly_path_extension_destroy(&extension);
+
+    biosal_assembly_path_extension_init(&extension, &table, KMER_LENGTH, key_length,
+                    &codec, &codec, &pool);
+    steps = biosal_assembly_path_extension_walk(&extension, &kmer,
+                    BIOSAL_ASSEMBLY_GRAPH_STORE_DIRECTION_CHILD, 0, 1, kmer_count);
+    TEST_INT_EQUALS(steps, kmer_count);
+
+    for (i = 0; i < steps; ++i) {
+        biosal_dna_kmer_get_sequence(biosal_assembly_path_extension_kmer(&extension, i),
+                        step_sequence, KMER_LENGTH, &codec);
+        TEST_INT_EQUALS(memcmp(step_sequence, sequence + i, KMER_LENGTH), 0);
+
+        if (i >= 3) {
+            biosal_assembly_vertex_clear_flag(biosal_assembly_path_extension_canonical_vertex(&extension, i),
+                            BIOSAL_VERTEX_FLAG_USED_BY_WALKER);
+        }
+    }
+    biosal_assembly_path_extension_destroy(&extension);
+
+    for (i = 0; i < kmer_count; ++i) {
+        vertex = get_vertex(&table, sequence, i, &codec, &pool, 0);
+        used = biosal_assembly_vertex_get_flag(vertex, BIOSAL_VERTEX_FLAG_USED_BY_WALKER);
+
+        if (i < 3) {
+            TEST_INT_NOT_EQUALS(used, 0);
+        } else {
+            TEST_INT_EQUALS(used, 0);
+        }
+    }
+
+    /*
+     * The walk stops after the first vertex that is not a unitig vertex.
+     */
+    vertex = get_vertex(&table, sequence, 5, &codec, &pool, 0);
+    biosal_assembly_vertex_clear_flag(vertex, BIOSAL_VERTEX_FLAG_UNITIG);
+
+    biosal_assembly_path_extension_init(&extension, &table, KMER_LENGTH, key_length,
+                    &codec, &codec, &pool);
+    steps = biosal_assembly_path_extension_walk(&extension, &kmer,
+                    BIOSAL_ASSEMBLY_GRAPH_STORE_DIRECTION_CHILD, 0, 1,
+                    BIOSAL_ASSEMBLY_GRAPH_STORE_MAXIMUM_EXTENSION_LENGTH);
+    TEST_INT_EQUALS(steps, 6);
+    biosal_assembly_path_extension_destroy(&extension);
+
+    biosal_assembly_vertex_set_flag(vertex, BIOSAL_VERTEX_FLAG_UNITIG);
+
+    /*
+     * With 4 stores, the walk stops before the first kmer of another
+     * store.
+     */
+    store_index = biosal_dna_kmer_store_index(&kmer, 4, KMER_LENGTH, &codec, &pool);
+
+    biosal_assembly_path_extension_init(&extension, &table, KMER_LENGTH, key_length,
+                    &codec, &codec, &pool);
+    steps = biosal_assembly_path_extension_walk(&extension, &kmer,
+                    BIOSAL_ASSEMBLY_GRAPH_STORE_DIRECTION_CHILD, store_index, 4,
+                    BIOSAL_ASSEMBLY_GRAPH_STORE_MAXIMUM_EXTENSION_LENGTH);
+    TEST_INT_IS_LOWER_THAN(steps, kmer_count);
+
+    for (i = 0; i < steps; ++i) {
+        step_store_index = biosal_dna_kmer_store_index(biosal_assembly_path_extension_kmer(&extension, i),
+                        4, KMER_LENGTH, &codec, &pool);
+        TEST_INT_EQUALS(step_store_index, store_index);
+    }
+    biosal_assembly_path_extension_destroy(&extension);
+
+    memcpy(kmer_sequence, sequence + steps, KMER_LENGTH);
+    biosal_dna_kmer_init(&step_kmer, kmer_sequence, &codec, &pool);
+    step_store_index = biosal_dna_kmer_store_index(&step_kmer, 4, KMER_LENGTH, &codec, &pool);
+    TEST_INT_NOT_EQUALS(step_store_index, store_index);
+    biosal_dna_kmer_destroy(&step_kmer, &pool);
+
+    biosal_kmer_table_destroy(&table);
+    biosal_dna_kmer_destroy(&kmer, &pool);
+    biosal_dna_kmer_destroy(&last_kmer, &pool);
+    core_memory_pool_destroy(&pool);
+    biosal_dna_codec_destroy(&codec);
+
+    END_TESTS();
+
+    return 0;
+}
@@ -0,0 +1,13 @@
+TEST_ASSEMBLY_PATH_EXTENSION_NAME=assembly_path_extension
+TEST_ASSEMBLY_PATH_EXTENSION_EXECUTABLE=tests/test_$(TEST_ASSEMBLY_PATH_EXTENSION_NAME)
+TEST_ASSEMBLY_PATH_EXTENSION_OBJECTS=tests/test_$(TEST_ASSEMBLY_PATH_EXTENSION_NAME).o
+TEST_EXECUTABLES+=$(TEST_ASSEMBLY_PATH_EXTENSION_EXECUTABLE)
+TEST_OBJECTS+=$(TEST_ASSEMBLY_PATH_EXTENSION_OBJECTS)
+$(TEST_ASSEMBLY_PATH_EXTENSION_EXECUTABLE): $(LIBRARY_OBJECTS) $(TEST_ASSEMBLY_PATH_EXTENSION_OBJECTS) $(TEST_LIBRARY_OBJECTS)
+	$(Q)$(ECHO) "  LD $@"
+	$(Q)$(CC) $(CFLAGS) $^ -o $@ $(LDFLAGS) $(CONFIG_LDFLAGS)
+TEST_ASSEMBLY_PATH_EXTENSION_RUN=test_run_$(TEST_ASSEMBLY_PATH_EXTENSION_NAME)
+$(TEST_ASSEMBLY_PATH_EXTENSION_RUN): $(TEST_ASSEMBLY_PATH_EXTENSION_EXECUTABLE)
+	./$^
+TEST_RUNS+=$(TEST_ASSEMBLY_PATH_EXTENSION_RUN)
+
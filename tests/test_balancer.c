@@ -0,0 +1,102 @@
+
+#include "test.h"
+
+#include <engine/thorium/scheduler/balancer.h>
+#include <engine/thorium/scheduler/migration.h>
+
+#include <engine/thorium/worker_pool.h>
+#include <engine/thorium/worker.h>
+#include <engine/thorium/node.h>
+
+#include <core/structures/map.h>
+#include <core/structures/set.h>
+
+#include <string.h>
+
+#define WORKERS 2
+#define TEST_ACTOR 1000
+
+/*
+ * The node is not started: the workers only read the name and the
+ * arguments of the node in thorium_worker_init.
+ */
+static void test_init_pool(struct thorium_worker_pool *pool, struct thorium_node *node,
+                int argc, char **argv);
+
+int main(int argc, char **argv)
+{
+    BEGIN_TESTS();
+
+    struct thorium_node node;
+    struct thorium_worker_pool pool;
+    struct thorium_worker *worker;
+    struct thorium_migration migration;
+    char *stealing_argv[] = { "test_balancer", "-work-stealing" };
+    char *default_argv[] = { "test_balancer" };
+    int status;
+    int i;
+
+    /*
+     * Without -work-stealing, the workers do not steal.
+     */
+    test_init_pool(&pool, &node, 1, default_argv);
+
+    for (i = 0; i < WORKERS; ++i) {
+        worker = thorium_worker_pool_get_worker(&pool, i);
+        TEST_INT_EQUALS(thorium_worker_uses_work_stealing(worker), 0);
+    }
+
+    thorium_worker_pool_destroy(&pool);
+
+    /*
+     * With -work-stealing, the actor stays with the worker that owns
+     * it: a balancer migration would let the node thread dequeue from
+     * the deque of the worker while thieves steal from it.
+     */
+    test_init_pool(&pool, &node, 2, stealing_argv);
+
+    for (i = 0; i < WORKERS; ++i) {
+        worker = thorium_worker_pool_get_worker(&pool, i);
+        TEST_INT_NOT_EQUALS(thorium_worker_uses_work_stealing(worker), 0);
+    }
+
+    worker = thorium_worker_pool_get_worker(&pool, 0);
+
+    i = TEST_ACTOR;
+    status = 0;
+    core_map_add_value(thorium_worker_get_actors(worker), &i, &status);
+
+    thorium_migration_init(&migration, TEST_ACTOR, 0, 1);
+    thorium_balancer_migrate(&pool.balancer, &migration);
+    thorium_migration_destroy(&migration);
+
+    TEST_INT_EQUALS(core_map_size(thorium_worker_get_actors(worker)), 1);
+    TEST_POINTER_NOT_EQUALS(core_map_get(thorium_worker_get_actors(worker), &i), NULL);
+
+    /*
+     * A balancing period does not produce any migration either.
+     */
+    thorium_balancer_balance(&pool.balancer);
+
+    TEST_INT_EQUALS(pool.balancer.last_migrations, 0);
+    TEST_INT_EQUALS(core_map_size(thorium_worker_get_actors(worker)), 1);
+
+    thorium_worker_pool_destroy(&pool);
+
+    END_TESTS();
+
+    return 0;
+}
+
+static void test_init_pool(struct thorium_worker_pool *pool, struct thorium_node *node,
+                int argc, char **argv)
+{
+    memset(node, 0, sizeof(*node));
+
+    node->name = 0;
+    node->nodes = 1;
+    node->argc = argc;
+    node->argv = argv;
+
+    thorium_worker_pool_init(pool, WORKERS, node);
+}
@@ -0,0 +1,13 @@
+TEST_BALANCER_NAME=balancer
+TEST_BALANCER_EXECUTABLE=tests/test_$(TEST_BALANCER_NAME)
+TEST_BALANCER_OBJECTS=tests/test_$(TEST_BALANCER_NAME).o
+TEST_EXECUTABLES+=$(TEST_BALANCER_EXECUTABLE)
+TEST_OBJECTS+=$(TEST_BALANCER_OBJECTS)
+$(TEST_BALANCER_EXECUTABLE): $(LIBRARY_OBJECTS) $(TEST_BALANCER_OBJECTS) $(TEST_LIBRARY_OBJECTS)
+	$(Q)$(ECHO) "  LD $@"
+	$(Q)$(CC) $(CFLAGS) $^ -o $@ $(LDFLAGS) $(CONFIG_LDFLAGS)
+TEST_BALANCER_RUN=test_run_$(TEST_BALANCER_NAME)
+$(TEST_BALANCER_RUN): $(TEST_BALANCER_EXECUTABLE)
+	./$^
+TEST_RUNS+=$(TEST_BALANCER_RUN)
+
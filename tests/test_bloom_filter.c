@@ -0,0 +1,91 @@
+#include <core/structures/bloom_filter.h>
+
+#include "test.h"
+
+#include <stdint.h>
+
+int main(int argc, char **argv)
+{
+    BEGIN_TESTS();
+
+    struct core_bloom_filter filter;
+    uint64_t key;
+    int i;
+    int keys;
+    int missing;
+    int false_positives;
+    int already_there;
+
+    keys = 100000;
+
+    /*
+     * The first generation has room for 1000 keys, so there are
+     * several generations.
+     */
+    core_bloom_filter_init(&filter, sizeof(key), 8, 1000, NULL);
+
+    TEST_UINT64_T_EQUALS(core_bloom_filter_size(&filter), 0);
+    TEST_INT_EQUALS(core_bloom_filter_generations(&filter), 1);
+
+    already_there = 0;
+
+    for (i = 0; i < keys; ++i) {
+        key = (uint64_t)i * 2;
+
+        if (core_bloom_filter_add(&filter, &key)) {
+            ++already_there;
+        }
+    }
+
+    TEST_UINT64_T_EQUALS(core_bloom_filter_size(&filter) + already_there, (uint64_t)keys);
+    TEST_INT_IS_GREATER_THAN(core_bloom_filter_generations(&filter), 1);
+
+    /*
+     * No false negatives.
+     */
+    missing = 0;
+
+    for (i = 0; i < keys; ++i) {
+        key = (uint64_t)i * 2;
+
+        if (!core_bloom_filter_find(&filter, &key)) {
+            ++missing;
+        }
+
+        if (!core_bloom_filter_add(&filter, &key)) {
+            ++missing;
+        }
+    }
+
+    TEST_INT_EQUALS(missing, 0);
+
+    /*
+     * With 8 bits per key, the first generation has about 3% of false
+     * positives, and the other ones have less.
+     */
+    false_positives = 0;
+
+    for (i = 0; i < keys; ++i) {
+        key = (uint64_t)i * 2 + 1;
+
+        if (core_bloom_filter_find(&filter, &key)) {
+            ++false_positives;
+        }
+    }
+
+    TEST_INT_IS_LOWER_THAN(false_positives, keys / 10);
+    TEST_INT_IS_LOWER_THAN(already_there, keys / 10);
+
+    /*
+     * The last generation is not full, so this is more than
+     * 8 bits per key, but not more than 8 times that.
+     */
+    TEST_INT_IS_LOWER_THAN(core_bloom_filter_memory_usage(&filter),
+                    8 * core_bloom_filter_size(&filter));
+
+    core_bloom_filter_destroy(&filter);
+
+    END_TESTS();
+
+    return 0;
+}
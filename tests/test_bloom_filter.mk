@@ -0,0 +1,13 @@
+TEST_BLOOM_FILTER_NAME=bloom_filter
+TEST_BLOOM_FILTER_EXECUTABLE=tests/test_$(TEST_BLOOM_FILTER_NAME)
+TEST_BLOOM_FILTER_OBJECTS=tests/test_$(TEST_BLOOM_FILTER_NAME).o
+TEST_EXECUTABLES+=$(TEST_BLOOM_FILTER_EXECUTABLE)
+TEST_OBJECTS+=$(TEST_BLOOM_FILTER_OBJECTS)
+$(TEST_BLOOM_FILTER_EXECUTABLE): $(LIBRARY_OBJECTS) $(TEST_BLOOM_FILTER_OBJECTS) $(TEST_LIBRARY_OBJECTS)
+	$(Q)$(ECHO) "  LD $@"
+	$(Q)$(CC) $(CFLAGS) $^ -o $@ $(LDFLAGS) $(CONFIG_LDFLAGS)
+TEST_BLOOM_FILTER_RUN=test_run_$(TEST_BLOOM_FILTER_NAME)
+$(TEST_BLOOM_FILTER_RUN): $(TEST_BLOOM_FILTER_EXECUTABLE)
+	./$^
+TEST_RUNS+=$(TEST_BLOOM_FILTER_RUN)
+
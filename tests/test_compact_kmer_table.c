@@ -0,0 +1,132 @@
+
+#include "test.h"
+
+#include <genomics/storage/compact_kmer_table.h>
+#include <genomics/storage/compact_kmer_table_iterator.h>
+#include <genomics/storage/kmer_table.h>
+
+#include <core/system/memory_pool.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+int main(int argc, char **argv)
+{
+    struct biosal_compact_kmer_table table;
+    struct biosal_compact_kmer_table_iterator iterator;
+    struct biosal_kmer_table expected_table;
+    struct core_memory_pool pool;
+    int key_sizes[] = { 4, 8, 9, 16, 17 };
+    uint8_t key[64];
+    void *iterator_key;
+    int *expected;
+    int key_size;
+    int keys;
+    int i;
+    int j;
+    int k;
+    int count;
+    int coverage;
+    int errors;
+    uint64_t iterated;
+
+    BEGIN_TESTS();
+
+    core_memory_pool_init(&pool, 1000000, -1);
+
+    for (k = 0; k < (int)(sizeof(key_sizes) / sizeof(key_sizes[0])); ++k) {
+
+        key_size = key_sizes[k];
+        keys = 40000;
+
+        biosal_compact_kmer_table_init(&table, key_size, &pool);
+        biosal_kmer_table_init(&expected_table, key_size, sizeof(int), &pool);
+
+        TEST_INT_EQUALS(biosal_compact_kmer_table_key_size(&table), key_size);
+        TEST_UINT64_T_EQUALS(biosal_compact_kmer_table_size(&table), 0);
+
+        srand(k);
+        errors = 0;
+
+        /*
+         * Some keys are seen often enough to use the overflow table.
+         */
+        for (i = 0; i < 4 * keys; ++i) {
+
+            for (j = 0; j < key_size; ++j) {
+                key[j] = rand() % 256;
+            }
+
+            count = 1 + rand() % 3;
+
+            if (i % 3 == 0) {
+                memset(key, 0, key_size);
+                key[0] = rand() % 8;
+            }
+
+            if (i % 1000 == 0) {
+                count = 300;
+            }
+
+            expected = biosal_kmer_table_add(&expected_table, key, NULL);
+            *expected += count;
+
+            if (biosal_compact_kmer_table_increment(&table, key, count) != *expected) {
+                ++errors;
+            }
+        }
+
+        TEST_INT_EQUALS(errors, 0);
+        TEST_UINT64_T_EQUALS(biosal_compact_kmer_table_size(&table),
+                        biosal_kmer_table_size(&expected_table));
+
+        /*
+         * Every key is rebuilt from its slot with the same count.
+         */
+        biosal_compact_kmer_table_iterator_init(&iterator, &table);
+
+        iterated = 0;
+        errors = 0;
+
+        while (biosal_compact_kmer_table_iterator_has_next(&iterator)) {
+            biosal_compact_kmer_table_iterator_next(&iterator, &iterator_key, &coverage);
+
+            expected = biosal_kmer_table_get(&expected_table, iterator_key);
+
+            if (expected == NULL || *expected != coverage) {
+                ++errors;
+            }
+
+            if (biosal_compact_kmer_table_get(&table, iterator_key) != coverage) {
+                ++errors;
+            }
+
+            ++iterated;
+        }
+
+        biosal_compact_kmer_table_iterator_destroy(&iterator);
+
+        TEST_INT_EQUALS(errors, 0);
+        TEST_UINT64_T_EQUALS(iterated, biosal_kmer_table_size(&expected_table));
+
+        memset(key, 0xff, sizeof(key));
+        TEST_INT_EQUALS(biosal_compact_kmer_table_get(&table, key), 0);
+
+        TEST_INT_IS_GREATER_THAN(biosal_compact_kmer_table_bytes_per_kmer(&table), 0);
+
+        if (key_size == 8) {
+            TEST_INT_IS_GREATER_THAN(biosal_kmer_table_memory_usage(&expected_table),
+                        biosal_compact_kmer_table_memory_usage(&table));
+        }
+
+        biosal_kmer_table_destroy(&expected_table);
+        biosal_compact_kmer_table_destroy(&table);
+    }
+
+    core_memory_pool_destroy(&pool);
+
+    END_TESTS();
+
+    return 0;
+}
@@ -0,0 +1,13 @@
+TEST_COMPACT_KMER_TABLE_NAME=compact_kmer_table
+TEST_COMPACT_KMER_TABLE_EXECUTABLE=tests/test_$(TEST_COMPACT_KMER_TABLE_NAME)
+TEST_COMPACT_KMER_TABLE_OBJECTS=tests/test_$(TEST_COMPACT_KMER_TABLE_NAME).o
+TEST_EXECUTABLES+=$(TEST_COMPACT_KMER_TABLE_EXECUTABLE)
+TEST_OBJECTS+=$(TEST_COMPACT_KMER_TABLE_OBJECTS)
+$(TEST_COMPACT_KMER_TABLE_EXECUTABLE): $(LIBRARY_OBJECTS) $(TEST_COMPACT_KMER_TABLE_OBJECTS) $(TEST_LIBRARY_OBJECTS)
+	$(Q)$(ECHO) "  LD $@"
+	$(Q)$(CC) $(CFLAGS) $^ -o $@ $(LDFLAGS) $(CONFIG_LDFLAGS)
+TEST_COMPACT_KMER_TABLE_RUN=test_run_$(TEST_COMPACT_KMER_TABLE_NAME)
+$(TEST_COMPACT_KMER_TABLE_RUN): $(TEST_COMPACT_KMER_TABLE_EXECUTABLE)
+	./$^
+TEST_RUNS+=$(TEST_COMPACT_KMER_TABLE_RUN)
+
@@ -0,0 +1,116 @@
+
+#include <engine/thorium/dispatcher.h>
+#include <engine/thorium/message.h>
+#include <engine/thorium/actor.h>
+
+#include <core/system/memory_pool.h>
+
+#include "test.h"
+
+static int last_handler;
+
+static void handler_1(struct thorium_actor *self, struct thorium_message *message)
+{
+    last_handler = 1;
+}
+
+static void handler_2(struct thorium_actor *self, struct thorium_message *message)
+{
+    last_handler = 2;
+}
+
+static void handler_3(struct thorium_actor *self, struct thorium_message *message)
+{
+    last_handler = 3;
+}
+
+static int dispatch(struct thorium_dispatcher *dispatcher, int action, int source)
+{
+    struct thorium_message message;
+    int value;
+
+    thorium_message_init(&message, action, 0, NULL);
+    thorium_message_set_source(&message, source);
+    thorium_message_set_parent_actor(&message, THORIUM_ACTOR_NO_VALUE);
+    thorium_message_set_parent_identifier(&message, THORIUM_ACTOR_NO_VALUE);
+
+    last_handler = 0;
+    value = thorium_dispatcher_dispatch(dispatcher, NULL, &message);
+
+    thorium_message_destroy(&message);
+
+    if (!value) {
+        return -1;
+    }
+
+    return last_handler;
+}
+
+int main(int argc, char **argv)
+{
+    BEGIN_TESTS();
+
+    {
+        struct thorium_dispatcher dispatcher;
+        struct core_memory_pool pool;
+        int condition;
+        int action;
+
+        core_memory_pool_init(&pool, 131072, MEMORY_POOL_NAME_ABSTRACT_ACTOR);
+        thorium_dispatcher_init(&dispatcher, &pool);
+
+        TEST_INT_EQUALS(dispatch(&dispatcher, 100, 7), -1);
+
+        /*
+         * Add actions in any order.
+         */
+        for (action = 1000; action >= 0; action -= 40) {
+            thorium_dispatcher_add_action(&dispatcher, action, handler_1, THORIUM_ACTOR_ANYBODY, NULL, -1);
+        }
+
+        TEST_INT_EQUALS(dispatcher.entry_count, 26);
+
+        for (action = 0; action <= 1000; action += 40) {
+            TEST_INT_EQUALS(dispatch(&dispatcher, action, 7), 1);
+            TEST_INT_EQUALS(dispatch(&dispatcher, action + 1, 7), -1);
+        }
+
+        TEST_INT_EQUALS(dispatch(&dispatcher, -10, 7), -1);
+
+        /*
+         * A route for a source has priority.
+         */
+        thorium_dispatcher_add_action(&dispatcher, 520, handler_2, 9, NULL, -1);
+
+        TEST_INT_EQUALS(dispatch(&dispatcher, 520, 9), 2);
+        TEST_INT_EQUALS(dispatch(&dispatcher, 520, 7), 1);
+        TEST_INT_EQUALS(dispatcher.entry_count, 26);
+
+        /*
+         * A route with a true condition has priority.
+         */
+        condition = 0;
+        thorium_dispatcher_add_action(&dispatcher, 600, handler_3, THORIUM_ACTOR_ANYBODY,
+                        &condition, 1);
+
+        TEST_INT_EQUALS(dispatch(&dispatcher, 600, 7), 1);
+        condition = 1;
+        TEST_INT_EQUALS(dispatch(&dispatcher, 600, 7), 3);
+
+        /*
+         * A source alone.
+         */
+        thorium_dispatcher_add_action(&dispatcher, 5, handler_2, 9, NULL, -1);
+
+        TEST_INT_EQUALS(dispatch(&dispatcher, 5, 9), 2);
+        TEST_INT_EQUALS(dispatch(&dispatcher, 5, 7), -1);
+        TEST_INT_EQUALS(dispatcher.entry_count, 27);
+
+        thorium_dispatcher_destroy(&dispatcher);
+        core_memory_pool_destroy(&pool);
+    }
+
+    END_TESTS();
+
+    return 0;
+}
@@ -0,0 +1,13 @@
+TEST_DISPATCHER_NAME=dispatcher
+TEST_DISPATCHER_EXECUTABLE=tests/test_$(TEST_DISPATCHER_NAME)
+TEST_DISPATCHER_OBJECTS=tests/test_$(TEST_DISPATCHER_NAME).o
+TEST_EXECUTABLES+=$(TEST_DISPATCHER_EXECUTABLE)
+TEST_OBJECTS+=$(TEST_DISPATCHER_OBJECTS)
+$(TEST_DISPATCHER_EXECUTABLE): $(LIBRARY_OBJECTS) $(TEST_DISPATCHER_OBJECTS) $(TEST_LIBRARY_OBJECTS)
+	$(Q)$(ECHO) "  LD $@"
+	$(Q)$(CC) $(CFLAGS) $^ -o $@ $(LDFLAGS) $(CONFIG_LDFLAGS)
+TEST_DISPATCHER_RUN=test_run_$(TEST_DISPATCHER_NAME)
+$(TEST_DISPATCHER_RUN): $(TEST_DISPATCHER_EXECUTABLE)
+	./$^
+TEST_RUNS+=$(TEST_DISPATCHER_RUN)
+
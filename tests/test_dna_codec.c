@@ -3,6 +3,7 @@
 
 #include <genomics/helpers/dna_helper.h>
 #include <genomics/data/dna_codec.h>
+#include <genomics/data/dna_codec_interface.h>
 
 #include <core/system/memory.h>
 #include <core/system/debugger.h>
@@ -146,6 +147,81 @@ int main(int argc, char **argv)
 
     }
 
+    /*
+     * All the 2-bit implementations must give the same bytes
+     * as the default implementation.
+     */
+    {
+        struct biosal_dna_codec codec;
+        struct biosal_dna_codec_interface *implementations[] = {
+            &biosal_dna_codec_word_implementation,
+            &biosal_dna_codec_sse41_implementation,
+            &biosal_dna_codec_avx2_implementation
+        };
+        char symbols[] = "ACGTACGTACGTACGTN";
+        char sequence[301];
+        char decoded[301];
+        char expected_decoded[301];
+        uint8_t encoded[80];
+        uint8_t expected[80];
+        int length;
+        int encoded_length;
+        int i;
+        int j;
+        int failures;
+
+        biosal_dna_codec_init(&codec);
+        biosal_dna_codec_enable_two_bit_encoding(&codec);
+
+        for (j = 0; j < (int)(sizeof(implementations) / sizeof(implementations[0])); ++j) {
+
+            if (!implementations[j]->is_supported()) {
+                continue;
+            }
+
+            srand(42);
+            failures = 0;
+
+            for (length = 0; length <= 300; ++length) {
+
+                for (i = 0; i < length; ++i) {
+                    sequence[i] = symbols[rand() % (sizeof(symbols) - 1)];
+                }
+
+                sequence[length] = '\0';
+                encoded_length = biosal_dna_codec_encoded_length(&codec, length);
+
+                biosal_dna_codec_set_interface(&codec, &biosal_dna_codec_default_implementation);
+                biosal_dna_codec_encode(&codec, length, sequence, expected);
+                biosal_dna_codec_decode(&codec, length, expected, expected_decoded);
+
+                memset(encoded, 0xff, sizeof(encoded));
+                biosal_dna_codec_set_interface(&codec, implementations[j]);
+                biosal_dna_codec_encode(&codec, length, sequence, encoded);
+                biosal_dna_codec_decode(&codec, length, encoded, decoded);
+
+                if (memcmp(encoded, expected, encoded_length) != 0
+                                || strcmp(decoded, expected_decoded) != 0) {
+                    ++failures;
+                }
+
+                biosal_dna_codec_set_interface(&codec, &biosal_dna_codec_default_implementation);
+                biosal_dna_codec_reverse_complement_in_place(&codec, length, expected);
+
+                biosal_dna_codec_set_interface(&codec, implementations[j]);
+                biosal_dna_codec_reverse_complement_in_place(&codec, length, encoded);
+
+                if (memcmp(encoded, expected, encoded_length) != 0) {
+                    ++failures;
+                }
+            }
+
+            TEST_INT_EQUALS(failures, 0);
+        }
+
+        biosal_dna_codec_destroy(&codec);
+    }
+
     END_TESTS();
 
     return 0;
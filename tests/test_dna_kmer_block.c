@@ -0,0 +1,151 @@
+
+#include "test.h"
+
+#include <genomics/data/dna_kmer_block.h>
+#include <genomics/data/dna_kmer.h>
+#include <genomics/data/dna_codec.h>
+
+#include <core/system/memory_pool.h>
+
+#include <string.h>
+
+int main(int argc, char **argv)
+{
+    struct biosal_dna_kmer_block block;
+    struct biosal_dna_kmer_block other_block;
+    struct biosal_dna_kmer kmer;
+    struct biosal_dna_kmer view;
+    struct biosal_dna_codec codec;
+    struct core_memory_pool pool;
+    char *sequences[] = {
+        "ATCGATCGAGTACTGCGTAGTCGTCGTACTG",
+        "GCGTCGTCGGCTGCAGTCTGCGTACTGCGTT",
+        "AGCTGCAGTTCAGTCGAGTACTGCATGCAGT"
+    };
+    int kmer_length;
+    int encoded_length;
+    int kmers;
+    int two_bit;
+    int i;
+    int j;
+    int size;
+    int packed_size;
+    void *buffer;
+    void *encoded_kmer;
+
+    BEGIN_TESTS();
+
+    core_memory_pool_init(&pool, 1000000, -1);
+
+    kmer_length = strlen(sequences[0]);
+    kmers = 100;
+
+    for (two_bit = 0; two_bit < 2; ++two_bit) {
+
+        biosal_dna_codec_init(&codec);
+
+        if (two_bit) {
+            biosal_dna_codec_enable_two_bit_encoding(&codec);
+        }
+
+        encoded_length = biosal_dna_codec_encoded_length(&codec, kmer_length);
+
+        /*
+         * A block that owns its storage grows as k-mers are added.
+         */
+        biosal_dna_kmer_block_init(&block, kmer_length, 42, 0, &codec, &pool);
+        biosal_dna_kmer_block_enable_counts(&block);
+        biosal_dna_kmer_block_enable_arcs(&block);
+
+        for (i = 0; i < kmers; ++i) {
+            biosal_dna_kmer_init(&kmer, sequences[i % 3], &codec, &pool);
+            biosal_dna_kmer_block_add_kmer(&block, &kmer, &pool, &codec);
+            biosal_dna_kmer_block_set_count(&block, i, i + 1);
+            biosal_dna_kmer_block_set_arcs(&block, i, (i * 7) % 256);
+            biosal_dna_kmer_destroy(&kmer, &pool);
+        }
+
+        TEST_INT_EQUALS(biosal_dna_kmer_block_size(&block), kmers);
+        TEST_INT_EQUALS(biosal_dna_kmer_block_source_index(&block), 42);
+
+        /*
+         * The packed block is read in place.
+         */
+        size = biosal_dna_kmer_block_pack_size(&block, &codec);
+        packed_size = biosal_dna_kmer_block_get_packed_size(kmer_length, kmers,
+                        BIOSAL_DNA_KMER_BLOCK_COUNTS | BIOSAL_DNA_KMER_BLOCK_ARCS, &codec);
+        TEST_INT_EQUALS(size, packed_size);
+
+        buffer = core_memory_pool_allocate(&pool, size);
+        TEST_INT_EQUALS(biosal_dna_kmer_block_pack(&block, buffer, &codec), size);
+
+        TEST_INT_EQUALS(biosal_dna_kmer_block_unpack(&other_block, buffer, &pool, &codec), size);
+        TEST_INT_EQUALS(biosal_dna_kmer_block_size(&other_block), kmers);
+        TEST_INT_EQUALS(biosal_dna_kmer_block_source_index(&other_block), 42);
+        TEST_BOOLEAN_EQUALS(biosal_dna_kmer_block_has_counts(&other_block), 1);
+        TEST_BOOLEAN_EQUALS(biosal_dna_kmer_block_has_arcs(&other_block), 1);
+
+        for (i = 0; i < kmers; ++i) {
+            biosal_dna_kmer_init(&kmer, sequences[i % 3], &codec, &pool);
+            biosal_dna_kmer_block_get_kmer(&other_block, i, &view);
+
+            TEST_INT_EQUALS(memcmp(view.encoded_data, kmer.encoded_data, encoded_length), 0);
+            TEST_INT_EQUALS(biosal_dna_kmer_block_get_count(&other_block, i), i + 1);
+            TEST_INT_EQUALS(biosal_dna_kmer_block_get_arcs(&other_block, i), (i * 7) % 256);
+
+            biosal_dna_kmer_destroy(&kmer, &pool);
+        }
+
+        biosal_dna_kmer_block_destroy(&other_block, &pool);
+        core_memory_pool_free(&pool, buffer);
+        biosal_dna_kmer_block_destroy(&block, &pool);
+
+        /*
+         * A block can also be written directly into a buffer
+         * (for example the buffer of a message).
+         */
+        size = biosal_dna_kmer_block_get_packed_size(kmer_length, 3,
+                        BIOSAL_DNA_KMER_BLOCK_ARCS, &codec);
+        buffer = core_memory_pool_allocate(&pool, size);
+
+        biosal_dna_kmer_block_init_with_buffer(&block, buffer, kmer_length, 7, 3,
+                        BIOSAL_DNA_KMER_BLOCK_ARCS, &codec);
+
+        for (i = 0; i < 3; ++i) {
+            biosal_dna_kmer_init(&kmer, sequences[i], &codec, &pool);
+            encoded_kmer = biosal_dna_kmer_block_add_encoded_kmer(&block, &pool, &codec);
+            memcpy(encoded_kmer, kmer.encoded_data, encoded_length);
+            biosal_dna_kmer_block_set_arcs(&block, i, 1 << i);
+            biosal_dna_kmer_destroy(&kmer, &pool);
+        }
+
+        biosal_dna_kmer_block_destroy(&block, &pool);
+
+        TEST_INT_EQUALS(biosal_dna_kmer_block_unpack(&other_block, buffer, &pool, &codec), size);
+        TEST_INT_EQUALS(biosal_dna_kmer_block_size(&other_block), 3);
+        TEST_INT_EQUALS(biosal_dna_kmer_block_source_index(&other_block), 7);
+        TEST_BOOLEAN_EQUALS(biosal_dna_kmer_block_has_counts(&other_block), 0);
+
+        for (i = 0; i < 3; ++i) {
+            biosal_dna_kmer_init(&kmer, sequences[i], &codec, &pool);
+            biosal_dna_kmer_block_get_kmer(&other_block, i, &view);
+
+            j = memcmp(view.encoded_data, kmer.encoded_data, encoded_length);
+            TEST_INT_EQUALS(j, 0);
+            TEST_INT_EQUALS(biosal_dna_kmer_block_get_count(&other_block, i), 1);
+            TEST_INT_EQUALS(biosal_dna_kmer_block_get_arcs(&other_block, i), 1 << i);
+
+            biosal_dna_kmer_destroy(&kmer, &pool);
+        }
+
+        biosal_dna_kmer_block_destroy(&other_block, &pool);
+        core_memory_pool_free(&pool, buffer);
+        biosal_dna_codec_destroy(&codec);
+    }
+
+    core_memory_pool_destroy(&pool);
+
+    END_TESTS();
+
+    return 0;
+}
@@ -0,0 +1,129 @@
+
+#include "test.h"
+
+#include <genomics/data/dna_kmer_extractor.h>
+#include <genomics/data/dna_kmer.h>
+#include <genomics/data/dna_sequence.h>
+#include <genomics/data/dna_codec.h>
+
+#include <core/system/memory_pool.h>
+
+#include <string.h>
+
+int main(int argc, char **argv)
+{
+    struct biosal_dna_kmer_extractor extractor;
+    struct biosal_dna_kmer kmer;
+    struct biosal_dna_sequence sequence;
+    struct biosal_dna_codec codec;
+    struct core_memory_pool pool;
+    char data[] = "ATCGATCGAGTACTGCGTAGTCGTCGTACTGTGCGTCGTCGGCTGCAGTCTGCGTACTGCGTTAGCTGCAGTTCAGTCGAGTACTGCATGCAGTACATGGTAGACTACATCTGCATGACTGCATGACTGCATGCTGATGCATGCAGTAAGTCATCGAGTCTCAGATCGATGCACTGACTGTACGTGACTGACTGACTGACTG";
+    char *copy;
+    char saved;
+    int kmer_lengths[] = { 3, 21, 31, 32, 33, 63, 64, 65, 97 };
+    int kmer_length;
+    int length;
+    int encoded_length;
+    int position;
+    int two_bit;
+    int i;
+    int found;
+    int equal;
+    int canonical;
+    void *encoded_kmer;
+
+    BEGIN_TESTS();
+
+    core_memory_pool_init(&pool, 1000000, -1);
+
+    length = strlen(data);
+    copy = core_memory_pool_allocate(&pool, length + 1);
+
+    for (two_bit = 0; two_bit < 2; ++two_bit) {
+
+        biosal_dna_codec_init(&codec);
+
+        if (two_bit) {
+            biosal_dna_codec_enable_two_bit_encoding(&codec);
+        }
+
+        strcpy(copy, data);
+        biosal_dna_sequence_init(&sequence, copy, &codec, &pool);
+
+        for (i = 0; i < (int)(sizeof(kmer_lengths) / sizeof(kmer_lengths[0])); ++i) {
+
+            kmer_length = kmer_lengths[i];
+            encoded_length = biosal_dna_codec_encoded_length(&codec, kmer_length);
+
+            biosal_dna_kmer_extractor_init(&extractor, kmer_length, &codec, &pool);
+            biosal_dna_kmer_extractor_set_sequence(&extractor, &sequence);
+
+            TEST_INT_EQUALS(biosal_dna_kmer_extractor_encoded_length(&extractor), encoded_length);
+
+            encoded_kmer = core_memory_pool_allocate(&pool, encoded_length);
+
+            found = 0;
+            equal = 0;
+            canonical = 0;
+            position = 0;
+
+            while (biosal_dna_kmer_extractor_next(&extractor)) {
+
+                strcpy(copy, data);
+                saved = copy[position + kmer_length];
+                copy[position + kmer_length] = '\0';
+
+                biosal_dna_kmer_init(&kmer, copy + position, &codec, &pool);
+                copy[position + kmer_length] = saved;
+
+                biosal_dna_kmer_extractor_get_kmer(&extractor, encoded_kmer);
+
+                if (memcmp(encoded_kmer, kmer.encoded_data, encoded_length) == 0) {
+                    ++equal;
+                }
+
+                if (biosal_dna_kmer_extractor_is_canonical(&extractor)
+                                == biosal_dna_kmer_is_canonical(&kmer, kmer_length, &codec)) {
+                    ++canonical;
+                }
+
+                /*
+                 * The canonical kmer is the same as the one obtained
+                 * with the reverse complement implementation of the codec.
+                 */
+                if (!biosal_dna_kmer_is_canonical(&kmer, kmer_length, &codec)) {
+                    biosal_dna_kmer_reverse_complement_self(&kmer, kmer_length, &codec, &pool);
+                }
+
+                biosal_dna_kmer_extractor_get_canonical_kmer(&extractor, encoded_kmer);
+
+                if (memcmp(encoded_kmer, kmer.encoded_data, encoded_length) == 0) {
+                    ++equal;
+                }
+
+                biosal_dna_kmer_destroy(&kmer, &pool);
+
+                ++found;
+                ++position;
+            }
+
+            TEST_INT_EQUALS(found, length - kmer_length + 1);
+            TEST_INT_EQUALS(found, biosal_dna_kmer_extractor_count(&extractor, length));
+            TEST_INT_EQUALS(equal, 2 * found);
+            TEST_INT_EQUALS(canonical, found);
+
+            core_memory_pool_free(&pool, encoded_kmer);
+            biosal_dna_kmer_extractor_destroy(&extractor);
+        }
+
+        biosal_dna_sequence_destroy(&sequence, &pool);
+        biosal_dna_codec_destroy(&codec);
+    }
+
+    core_memory_pool_free(&pool, copy);
+    core_memory_pool_destroy(&pool);
+
+    END_TESTS();
+
+    return 0;
+}
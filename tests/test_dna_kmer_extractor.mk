@@ -0,0 +1,13 @@
+TEST_DNA_KMER_EXTRACTOR_NAME=dna_kmer_extractor
+TEST_DNA_KMER_EXTRACTOR_EXECUTABLE=tests/test_$(TEST_DNA_KMER_EXTRACTOR_NAME)
+TEST_DNA_KMER_EXTRACTOR_OBJECTS=tests/test_$(TEST_DNA_KMER_EXTRACTOR_NAME).o
+TEST_EXECUTABLES+=$(TEST_DNA_KMER_EXTRACTOR_EXECUTABLE)
+TEST_OBJECTS+=$(TEST_DNA_KMER_EXTRACTOR_OBJECTS)
+$(TEST_DNA_KMER_EXTRACTOR_EXECUTABLE): $(LIBRARY_OBJECTS) $(TEST_DNA_KMER_EXTRACTOR_OBJECTS) $(TEST_LIBRARY_OBJECTS)
+	$(Q)$(ECHO) "  LD $@"
+	$(Q)$(CC) $(CFLAGS) $^ -o $@ $(LDFLAGS) $(CONFIG_LDFLAGS)
+TEST_DNA_KMER_EXTRACTOR_RUN=test_run_$(TEST_DNA_KMER_EXTRACTOR_NAME)
+$(TEST_DNA_KMER_EXTRACTOR_RUN): $(TEST_DNA_KMER_EXTRACTOR_EXECUTABLE)
+	./$^
+TEST_RUNS+=$(TEST_DNA_KMER_EXTRACTOR_RUN)
+
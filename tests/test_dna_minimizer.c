@@ -0,0 +1,180 @@
+
+#include "test.h"
+
+#include <genomics/data/dna_minimizer.h>
+#include <genomics/data/dna_kmer.h>
+#include <genomics/data/dna_sequence.h>
+#include <genomics/data/dna_codec.h>
+
+#include <core/system/memory_pool.h>
+
+#include <string.h>
+
+/*
+ * The minimizer computed with one shingle object per position.
+ */
+static uint64_t get_minimizer_with_shingles(char *sequence, int kmer_length,
+                struct biosal_dna_codec *codec, struct core_memory_pool *pool)
+{
+    struct biosal_dna_kmer shingle;
+    uint64_t minimum;
+    uint64_t hash;
+    int shingle_length;
+    char saved;
+    int i;
+
+    shingle_length = biosal_dna_minimizer_shingle_length(kmer_length);
+    minimum = 0;
+    --minimum;
+
+    for (i = 0; i < kmer_length - shingle_length + 1; ++i) {
+        saved = sequence[i + shingle_length];
+        sequence[i + shingle_length] = '\0';
+        biosal_dna_kmer_init(&shingle, sequence + i, codec, pool);
+        sequence[i + shingle_length] = saved;
+
+        hash = biosal_dna_kmer_canonical_hash(&shingle, shingle_length, codec, pool);
+        biosal_dna_kmer_destroy(&shingle, pool);
+
+        if (hash < minimum) {
+            minimum = hash;
+        }
+    }
+
+    return minimum;
+}
+
+int main(int argc, char **argv)
+{
+    struct biosal_dna_minimizer minimizer;
+    struct biosal_dna_kmer kmer;
+    struct biosal_dna_sequence sequence;
+    struct biosal_dna_codec codec;
+    struct core_memory_pool pool;
+    char data[] = "ATCGATCGAGTACTGCGTAGTCGTCGTACTGTGCGTCGTCGGCTGCAGTCTGCGTACTGCGTTAGCTGCAGTTCAGTCGAGTACTGCATGCAGTACATGGTAGACTACATCTGCATGACTGCATGACTGCATGCTGATGCATGCAGTAAGTCATCGAGTCTCAGATCGATGCACTGACTGTACGTGACTGACTGACTGACTG";
+    char *copy;
+    char saved;
+    int kmer_lengths[] = { 7, 15, 19, 21, 31, 32, 33, 63 };
+    int kmer_length;
+    int length;
+    int two_bit;
+    int i;
+    int found;
+    int same_as_shingles;
+    int same_as_kmer;
+    int same_as_reverse_complement;
+    int same_as_store_index;
+    int runs;
+    uint64_t value;
+    uint64_t last_value;
+
+    BEGIN_TESTS();
+
+    core_memory_pool_init(&pool, 1000000, -1);
+
+    length = strlen(data);
+    copy = core_memory_pool_allocate(&pool, length + 1);
+
+    TEST_INT_EQUALS(biosal_dna_minimizer_shingle_length(31), BIOSAL_DNA_MINIMIZER_SHINGLE_LENGTH);
+    TEST_INT_EQUALS(biosal_dna_minimizer_shingle_length(15), 12);
+
+    for (two_bit = 0; two_bit < 2; ++two_bit) {
+
+        biosal_dna_codec_init(&codec);
+
+        if (two_bit) {
+            biosal_dna_codec_enable_two_bit_encoding(&codec);
+        }
+
+        strcpy(copy, data);
+        biosal_dna_sequence_init(&sequence, copy, &codec, &pool);
+
+        for (i = 0; i < (int)(sizeof(kmer_lengths) / sizeof(kmer_lengths[0])); ++i) {
+
+            kmer_length = kmer_lengths[i];
+
+            biosal_dna_minimizer_init(&minimizer, kmer_length, &codec, &pool);
+            biosal_dna_minimizer_set_sequence(&minimizer, &sequence);
+
+            found = 0;
+            same_as_shingles = 0;
+            same_as_kmer = 0;
+            same_as_reverse_complement = 0;
+            same_as_store_index = 0;
+            runs = 0;
+            last_value = 0;
+
+            while (biosal_dna_minimizer_next(&minimizer)) {
+
+                TEST_INT_EQUALS(biosal_dna_minimizer_position(&minimizer), found);
+
+                value = biosal_dna_minimizer_get(&minimizer);
+
+                strcpy(copy, data);
+
+                if (value == get_minimizer_with_shingles(copy + found, kmer_length, &codec, &pool)) {
+                    ++same_as_shingles;
+                }
+
+                saved = copy[found + kmer_length];
+                copy[found + kmer_length] = '\0';
+                biosal_dna_kmer_init(&kmer, copy + found, &codec, &pool);
+                copy[found + kmer_length] = saved;
+
+                if (value == biosal_dna_minimizer_get_kmer_minimizer(kmer_length, &codec,
+                                        kmer.encoded_data)) {
+                    ++same_as_kmer;
+                }
+
+                if ((int)(value % 13) == biosal_dna_kmer_store_index(&kmer, 13, kmer_length,
+                                        &codec, &pool)) {
+                    ++same_as_store_index;
+                }
+
+                /*
+                 * The minimizer does not depend on the strand.
+                 */
+                biosal_dna_kmer_reverse_complement_self(&kmer, kmer_length, &codec, &pool);
+
+                if (value == biosal_dna_minimizer_get_kmer_minimizer(kmer_length, &codec,
+                                        kmer.encoded_data)) {
+                    ++same_as_reverse_complement;
+                }
+
+                biosal_dna_kmer_destroy(&kmer, &pool);
+
+                if (found == 0 || value != last_value) {
+                    ++runs;
+                }
+
+                last_value = value;
+                ++found;
+            }
+
+            TEST_INT_EQUALS(found, length - kmer_length + 1);
+            TEST_INT_EQUALS(same_as_shingles, found);
+            TEST_INT_EQUALS(same_as_kmer, found);
+            TEST_INT_EQUALS(same_as_reverse_complement, found);
+            TEST_INT_EQUALS(same_as_store_index, found);
+
+            /*
+             * Consecutive k-mers share their minimizer most of the time.
+             */
+            if (kmer_length >= 31) {
+                TEST_INT_IS_LOWER_THAN(runs, found / 2);
+            }
+
+            biosal_dna_minimizer_destroy(&minimizer);
+        }
+
+        biosal_dna_sequence_destroy(&sequence, &pool);
+        biosal_dna_codec_destroy(&codec);
+    }
+
+    core_memory_pool_free(&pool, copy);
+    core_memory_pool_destroy(&pool);
+
+    END_TESTS();
+
+    return 0;
+}
@@ -0,0 +1,13 @@
+TEST_DNA_MINIMIZER_NAME=dna_minimizer
+TEST_DNA_MINIMIZER_EXECUTABLE=tests/test_$(TEST_DNA_MINIMIZER_NAME)
+TEST_DNA_MINIMIZER_OBJECTS=tests/test_$(TEST_DNA_MINIMIZER_NAME).o
+TEST_EXECUTABLES+=$(TEST_DNA_MINIMIZER_EXECUTABLE)
+TEST_OBJECTS+=$(TEST_DNA_MINIMIZER_OBJECTS)
+$(TEST_DNA_MINIMIZER_EXECUTABLE): $(LIBRARY_OBJECTS) $(TEST_DNA_MINIMIZER_OBJECTS) $(TEST_LIBRARY_OBJECTS)
+	$(Q)$(ECHO) "  LD $@"
+	$(Q)$(CC) $(CFLAGS) $^ -o $@ $(LDFLAGS) $(CONFIG_LDFLAGS)
+TEST_DNA_MINIMIZER_RUN=test_run_$(TEST_DNA_MINIMIZER_NAME)
+$(TEST_DNA_MINIMIZER_RUN): $(TEST_DNA_MINIMIZER_EXECUTABLE)
+	./$^
+TEST_RUNS+=$(TEST_DNA_MINIMIZER_RUN)
+
@@ -0,0 +1,102 @@
+
+#include <tracepoints/event_tracer.h>
+
+#include <core/file_storage/output/buffered_file_writer.h>
+
+#include "test.h"
+
+#include <stdio.h>
+
+#define FILE_NAME "test_event_tracer.bin"
+
+int main(int argc, char **argv)
+{
+    struct thorium_event_tracer tracer;
+    struct core_buffered_file_writer writer;
+    struct thorium_trace_file_header header;
+    struct thorium_trace_event event;
+    uint64_t last_time;
+    FILE *file;
+    int count;
+    int i;
+
+    BEGIN_TESTS();
+
+    thorium_event_tracer_init(&tracer, 3);
+
+    /*
+     * A disabled tracer records nothing.
+     */
+    THORIUM_EVENT_TRACER_RECORD(&tracer, THORIUM_TRACE_EVENT_ACTOR_SEND, 1, 2, 3, 4);
+    TEST_BOOLEAN_EQUALS(thorium_event_tracer_is_enabled(&tracer), FALSE);
+    TEST_UINT64_T_EQUALS(tracer.tail, 0);
+
+    thorium_event_tracer_enable(&tracer);
+
+    core_buffered_file_writer_init(&writer, FILE_NAME);
+    thorium_event_tracer_write_header(&writer, 7);
+
+    /*
+     * Drain the ring several times so that the events wrap around.
+     */
+    count = 0;
+
+    for (i = 0; i < 3 * THORIUM_EVENT_TRACER_CAPACITY / 2; ++i) {
+        THORIUM_EVENT_TRACER_RECORD(&tracer, THORIUM_TRACE_EVENT_ACTOR_SEND, i, i + 1, 99, 1000);
+
+        if (i % 1000 == 999)
+            count += thorium_event_tracer_drain(&tracer, &writer);
+    }
+
+    count += thorium_event_tracer_drain(&tracer, &writer);
+
+    TEST_INT_EQUALS(count, 3 * THORIUM_EVENT_TRACER_CAPACITY / 2);
+    TEST_INT_EQUALS(thorium_event_tracer_drain(&tracer, &writer), 0);
+    TEST_UINT64_T_EQUALS(thorium_event_tracer_dropped_event_count(&tracer), 0);
+
+    core_buffered_file_writer_destroy(&writer);
+
+    /*
+     * Read the events back.
+     */
+    file = fopen(FILE_NAME, "rb");
+
+    TEST_INT_EQUALS(fread(&header, sizeof(header), 1, file), 1);
+    TEST_INT_EQUALS(header.magic, THORIUM_EVENT_TRACER_MAGIC);
+    TEST_INT_EQUALS(header.node, 7);
+    TEST_INT_EQUALS(header.event_size, sizeof(struct thorium_trace_event));
+
+    i = 0;
+    last_time = 0;
+
+    while (fread(&event, sizeof(event), 1, file) == 1) {
+        TEST_INT_EQUALS(event.type, THORIUM_TRACE_EVENT_ACTOR_SEND);
+        TEST_INT_EQUALS(event.thread, 3);
+        TEST_INT_EQUALS(event.actor, i);
+        TEST_INT_EQUALS(event.peer, i + 1);
+        TEST_INT_IS_LOWER_THAN_OR_EQUAL(last_time, event.time);
+
+        last_time = event.time;
+        ++i;
+    }
+
+    TEST_INT_EQUALS(i, count);
+
+    fclose(file);
+    remove(FILE_NAME);
+
+    /*
+     * A full ring drops events.
+     */
+    for (i = 0; i < THORIUM_EVENT_TRACER_CAPACITY + 10; ++i) {
+        THORIUM_EVENT_TRACER_RECORD(&tracer, THORIUM_TRACE_EVENT_ACTOR_RECEIVE_ENTER, i, 0, 0, 0);
+    }
+
+    TEST_UINT64_T_EQUALS(thorium_event_tracer_dropped_event_count(&tracer), 10);
+
+    thorium_event_tracer_destroy(&tracer);
+
+    END_TESTS();
+
+    return 0;
+}
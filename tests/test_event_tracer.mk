@@ -0,0 +1,13 @@
+TEST_EVENT_TRACER_NAME=event_tracer
+TEST_EVENT_TRACER_EXECUTABLE=tests/test_$(TEST_EVENT_TRACER_NAME)
+TEST_EVENT_TRACER_OBJECTS=tests/test_$(TEST_EVENT_TRACER_NAME).o
+TEST_EXECUTABLES+=$(TEST_EVENT_TRACER_EXECUTABLE)
+TEST_OBJECTS+=$(TEST_EVENT_TRACER_OBJECTS)
+$(TEST_EVENT_TRACER_EXECUTABLE): $(LIBRARY_OBJECTS) $(TEST_EVENT_TRACER_OBJECTS) $(TEST_LIBRARY_OBJECTS)
+	$(Q)$(ECHO) "  LD $@"
+	$(Q)$(CC) $(CFLAGS) $^ -o $@ $(LDFLAGS) $(CONFIG_LDFLAGS)
+TEST_EVENT_TRACER_RUN=test_run_$(TEST_EVENT_TRACER_NAME)
+$(TEST_EVENT_TRACER_RUN): $(TEST_EVENT_TRACER_EXECUTABLE)
+	./$^
+TEST_RUNS+=$(TEST_EVENT_TRACER_RUN)
+
@@ -0,0 +1,331 @@
+
+#include "test.h"
+
+#include <genomics/assembly/assembly_arc.h>
+#include <genomics/assembly/assembly_connectivity.h>
+
+#include <genomics/data/dna_kmer_extractor.h>
+#include <genomics/data/dna_kmer.h>
+#include <genomics/data/dna_codec.h>
+
+#include <genomics/helpers/dna_helper.h>
+
+#include <core/system/memory_pool.h>
+
+#include <string.h>
+
+/*
+ * An even kmer length, so that some kmers are palindromes.
+ */
+#define KMER_LENGTH 6
+#define MAXIMUM_VERTICES 256
+
+#define PALINDROME "ACGCGT"
+
+struct test_vertex {
+    char sequence[KMER_LENGTH + 1];
+    struct biosal_assembly_connectivity connectivity;
+};
+
+struct test_graph {
+    struct test_vertex vertices[MAXIMUM_VERTICES];
+    int size;
+};
+
+static struct biosal_assembly_connectivity *test_graph_get(struct test_graph *self,
+                char *canonical_sequence);
+static void test_build_two_pass(struct test_graph *self, char **reads, int count,
+                struct biosal_dna_codec *codec, struct core_memory_pool *pool);
+static void test_add_arc(struct test_graph *self, struct biosal_assembly_arc *arc,
+                struct biosal_dna_codec *codec);
+static void test_build_fused(struct test_graph *self, char **reads, int count,
+                struct biosal_dna_codec *codec, struct core_memory_pool *pool);
+
+/*
+ * With -fused-graph-construction, block classifiers compute the arcs of
+ * each kmer from its flanking nucleotides
+ * (biosal_assembly_block_classifier_get_arcs). Otherwise, arc kernels
+ * send the arcs of the reads and graph stores add them to the canonical
+ * kmers (biosal_assembly_graph_store_add_arc).
+ *
+ * Both must build the same graph, palindromic kmers included.
+ */
+int main(int argc, char **argv)
+{
+    BEGIN_TESTS();
+
+    struct test_graph two_pass;
+    struct test_graph fused;
+    struct biosal_assembly_connectivity *connectivity;
+    struct biosal_assembly_connectivity *other_connectivity;
+    struct biosal_assembly_connectivity inverted;
+    struct biosal_dna_kmer kmer;
+    struct biosal_dna_codec codec;
+    struct core_memory_pool pool;
+    char *reads[] = {
+        "TGACGCGTAG",
+        "CACGCGTG",
+        "GATTACAGATCCATTGACCA",
+        "TGGTCAATGGATCTGTAATC",
+        "CCATTGACGCGTCAAT"
+    };
+    int count;
+    int errors;
+    int two_bit;
+    int i;
+
+    core_memory_pool_init(&pool, 1000000, -1);
+
+    count = sizeof(reads) / sizeof(reads[0]);
+
+    for (two_bit = 0; two_bit < 2; ++two_bit) {
+
+        biosal_dna_codec_init(&codec);
+
+        if (two_bit) {
+            biosal_dna_codec_enable_two_bit_encoding(&codec);
+        }
+
+        test_build_two_pass(&two_pass, reads, count, &codec, &pool);
+        test_build_fused(&fused, reads, count, &codec, &pool);
+
+        TEST_INT_IS_GREATER_THAN(two_pass.size, 0);
+        TEST_INT_EQUALS(fused.size, two_pass.size);
+
+        errors = 0;
+
+        for (i = 0; i < two_pass.size; ++i) {
+            connectivity = &two_pass.vertices[i].connectivity;
+            other_connectivity = test_graph_get(&fused, two_pass.vertices[i].sequence);
+
+            if (other_connectivity->bitmap != connectivity->bitmap) {
+                ++errors;
+            }
+        }
+
+        TEST_INT_EQUALS(errors, 0);
+        TEST_INT_EQUALS(fused.size, two_pass.size);
+
+        /*
+         * The palindrome is seen in the reads with the parents G, C
+         * and the children A, G, C. Its reverse complement is itself,
+         * so it also gets the inverted arcs (parents T, C, G and
+         * children C, G).
+         */
+        biosal_dna_kmer_init(&kmer, PALINDROME, &codec, &pool);
+        TEST_INT_EQUALS(biosal_dna_kmer_is_palindrome(&kmer, KMER_LENGTH, &codec), 1);
+        TEST_INT_EQUALS(biosal_dna_kmer_is_canonical(&kmer, KMER_LENGTH, &codec), 1);
+        biosal_dna_kmer_destroy(&kmer, &pool);
+
+        connectivity = test_graph_get(&fused, PALINDROME);
+
+        TEST_INT_EQUALS(biosal_assembly_connectivity_parent_count(connectivity), 3);
+        TEST_INT_EQUALS(biosal_assembly_connectivity_child_count(connectivity), 3);
+
+        connectivity = test_graph_get(&two_pass, PALINDROME);
+
+        biosal_assembly_connectivity_init_copy(&inverted, connectivity);
+        biosal_assembly_connectivity_invert_arcs(&inverted);
+
+        TEST_INT_EQUALS(inverted.bitmap, connectivity->bitmap);
+
+        biosal_dna_codec_destroy(&codec);
+    }
+
+    core_memory_pool_destroy(&pool);
+
+    END_TESTS();
+
+    return 0;
+}
+
+static struct biosal_assembly_connectivity *test_graph_get(struct test_graph *self,
+                char *canonical_sequence)
+{
+    struct test_vertex *vertex;
+    int i;
+
+    for (i = 0; i < self->size; ++i) {
+        vertex = self->vertices + i;
+
+        if (strcmp(vertex->sequence, canonical_sequence) == 0) {
+            return &vertex->connectivity;
+        }
+    }
+
+    vertex = self->vertices + self->size;
+    ++self->size;
+
+    strcpy(vertex->sequence, canonical_sequence);
+    biosal_assembly_connectivity_init(&vertex->connectivity);
+
+    return &vertex->connectivity;
+}
+
+/*
+ * The arcs of biosal_assembly_arc_kernel_push_sequence_data_block.
+ */
+static void test_build_two_pass(struct test_graph *self, char **reads, int count,
+                struct biosal_dna_codec *codec, struct core_memory_pool *pool)
+{
+    struct biosal_dna_kmer previous_kmer;
+    struct biosal_dna_kmer current_kmer;
+    struct biosal_assembly_arc arc;
+    char sequence[KMER_LENGTH + 1];
+    int limit;
+    int position;
+    int symbol;
+    int i;
+
+    self->size = 0;
+
+    for (i = 0; i < count; ++i) {
+
+        limit = strlen(reads[i]) - KMER_LENGTH + 1;
+
+        for (position = 0; position < limit; ++position) {
+
+            memcpy(sequence, reads[i] + position, KMER_LENGTH);
+            sequence[KMER_LENGTH] = '\0';
+
+            biosal_dna_kmer_init(&current_kmer, sequence, codec, pool);
+
+            if (position > 0) {
+                symbol = biosal_dna_kmer_last_symbol(&current_kmer, KMER_LENGTH, codec);
+                biosal_assembly_arc_init(&arc, BIOSAL_ARC_TYPE_CHILD, &previous_kmer,
+                                symbol, KMER_LENGTH, pool, codec);
+                test_add_arc(self, &arc, codec);
+                biosal_assembly_arc_destroy(&arc, pool);
+
+                symbol = biosal_dna_kmer_first_symbol(&previous_kmer, KMER_LENGTH, codec);
+                biosal_assembly_arc_init(&arc, BIOSAL_ARC_TYPE_PARENT, &current_kmer,
+                                symbol, KMER_LENGTH, pool, codec);
+                test_add_arc(self, &arc, codec);
+                biosal_assembly_arc_destroy(&arc, pool);
+
+                biosal_dna_kmer_destroy(&previous_kmer, pool);
+            }
+
+            previous_kmer = current_kmer;
+        }
+
+        biosal_dna_kmer_destroy(&previous_kmer, pool);
+    }
+}
+
+/*
+ * What biosal_assembly_graph_store_add_arc does with an arc.
+ */
+static void test_add_arc(struct test_graph *self, struct biosal_assembly_arc *arc,
+                struct biosal_dna_codec *codec)
+{
+    struct biosal_dna_kmer *source;
+    struct biosal_assembly_connectivity *connectivity;
+    char sequence[KMER_LENGTH + 1];
+    char canonical_sequence[KMER_LENGTH + 1];
+    int is_canonical;
+    int is_palindrome;
+
+    source = biosal_assembly_arc_source(arc);
+
+    biosal_dna_kmer_get_sequence(source, sequence, KMER_LENGTH, codec);
+
+    is_canonical = biosal_dna_kmer_is_canonical(source, KMER_LENGTH, codec);
+    is_palindrome = biosal_dna_kmer_is_palindrome(source, KMER_LENGTH, codec);
+
+    if (is_canonical) {
+        strcpy(canonical_sequence, sequence);
+    } else {
+        biosal_dna_helper_reverse_complement(sequence, canonical_sequence);
+    }
+
+    connectivity = test_graph_get(self, canonical_sequence);
+
+    if (biosal_assembly_arc_type(arc) == BIOSAL_ARC_TYPE_PARENT) {
+        biosal_assembly_connectivity_add_read_arcs(connectivity,
+                        biosal_assembly_arc_destination(arc),
+                        BIOSAL_ASSEMBLY_CONNECTIVITY_NO_SYMBOL, is_canonical, is_palindrome);
+    } else {
+        biosal_assembly_connectivity_add_read_arcs(connectivity,
+                        BIOSAL_ASSEMBLY_CONNECTIVITY_NO_SYMBOL,
+                        biosal_assembly_arc_destination(arc), is_canonical, is_palindrome);
+    }
+}
+
+/*
+ * The arcs of biosal_assembly_block_classifier_get_arcs. A read is a
+ * super kmer with all its flanking nucleotides.
+ */
+static void test_build_fused(struct test_graph *self, char **reads, int count,
+                struct biosal_dna_codec *codec, struct core_memory_pool *pool)
+{
+    struct biosal_dna_kmer_extractor extractor;
+    struct biosal_assembly_connectivity *connectivity;
+    struct biosal_assembly_connectivity arcs;
+    char canonical_sequence[KMER_LENGTH + 1];
+    void *encoded_sequence;
+    void *encoded_kmer;
+    int length;
+    int position;
+    int parent;
+    int child;
+    int i;
+    int j;
+
+    self->size = 0;
+
+    biosal_dna_kmer_extractor_init(&extractor, KMER_LENGTH, codec, pool);
+    encoded_kmer = core_memory_pool_allocate(pool,
+                    biosal_dna_kmer_extractor_encoded_length(&extractor));
+
+    for (i = 0; i < count; ++i) {
+
+        length = strlen(reads[i]);
+        encoded_sequence = core_memory_pool_allocate(pool,
+                        biosal_dna_codec_encoded_length(codec, length));
+        biosal_dna_codec_encode(codec, length, reads[i], encoded_sequence);
+
+        biosal_dna_kmer_extractor_set_encoded_sequence(&extractor, length, encoded_sequence);
+
+        position = 0;
+
+        while (biosal_dna_kmer_extractor_next(&extractor)) {
+
+            biosal_dna_kmer_extractor_get_canonical_kmer(&extractor, encoded_kmer);
+
+            for (j = 0; j < KMER_LENGTH; ++j) {
+                canonical_sequence[j] = biosal_dna_codec_get_nucleotide(codec, encoded_kmer, j);
+            }
+
+            canonical_sequence[KMER_LENGTH] = '\0';
+
+            parent = BIOSAL_ASSEMBLY_CONNECTIVITY_NO_SYMBOL;
+            child = BIOSAL_ASSEMBLY_CONNECTIVITY_NO_SYMBOL;
+
+            if (position > 0) {
+                parent = biosal_dna_codec_get_nucleotide_code(codec, encoded_sequence,
+                                position - 1);
+            }
+
+            if (position + KMER_LENGTH < length) {
+                child = biosal_dna_codec_get_nucleotide_code(codec, encoded_sequence,
+                                position + KMER_LENGTH);
+            }
+
+            arcs.bitmap = 0;
+            biosal_assembly_connectivity_add_read_arcs(&arcs, parent, child,
+                            biosal_dna_kmer_extractor_is_canonical(&extractor),
+                            biosal_dna_kmer_extractor_is_palindrome(&extractor));
+
+            connectivity = test_graph_get(self, canonical_sequence);
+            biosal_assembly_connectivity_add_arcs(connectivity, arcs.bitmap);
+
+            ++position;
+        }
+
+        core_memory_pool_free(pool, encoded_sequence);
+    }
+
+    core_memory_pool_free(pool, encoded_kmer);
+    biosal_dna_kmer_extractor_destroy(&extractor);
+}
@@ -0,0 +1,13 @@
+TEST_FUSED_ARCS_NAME=fused_arcs
+TEST_FUSED_ARCS_EXECUTABLE=tests/test_$(TEST_FUSED_ARCS_NAME)
+TEST_FUSED_ARCS_OBJECTS=tests/test_$(TEST_FUSED_ARCS_NAME).o
+TEST_EXECUTABLES+=$(TEST_FUSED_ARCS_EXECUTABLE)
+TEST_OBJECTS+=$(TEST_FUSED_ARCS_OBJECTS)
+$(TEST_FUSED_ARCS_EXECUTABLE): $(LIBRARY_OBJECTS) $(TEST_FUSED_ARCS_OBJECTS) $(TEST_LIBRARY_OBJECTS)
+	$(Q)$(ECHO) "  LD $@"
+	$(Q)$(CC) $(CFLAGS) $^ -o $@ $(LDFLAGS) $(CONFIG_LDFLAGS)
+TEST_FUSED_ARCS_RUN=test_run_$(TEST_FUSED_ARCS_NAME)
+$(TEST_FUSED_ARCS_RUN): $(TEST_FUSED_ARCS_EXECUTABLE)
+	./$^
+TEST_RUNS+=$(TEST_FUSED_ARCS_RUN)
+
@@ -0,0 +1,326 @@
+#include <core/file_storage/input/buffered_reader.h>
+#include <core/file_storage/input/bgzf_index.h>
+
+#include <genomics/formats/record_splitter.h>
+
+#include <core/structures/vector.h>
+
+#include "test.h"
+
+#include <zlib.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+#define RECORD_COUNT 2000
+#define MAXIMUM_LINE_LENGTH 128
+
+/*
+ * Small blocks, so that the file has many blocks.
+ */
+#define BGZF_BLOCK_CONTENT_SIZE 4000
+#define BGZF_BLOCK_CAPACITY 65536
+
+static uint64_t write_file(const char *file, int bgzf, uint64_t *record_offsets);
+static void write_bgzf_block(FILE *stream, const char *data, int length);
+static void write_gzi(const char *file, struct core_bgzf_index *index);
+static int is_record_start(uint64_t offset, uint64_t *record_offsets);
+
+int main(int argc, char **argv)
+{
+    BEGIN_TESTS();
+
+    struct core_buffered_reader reader;
+    struct core_vector start_offsets;
+    struct core_vector end_offsets;
+    struct core_bgzf_index index;
+    struct core_bgzf_block block;
+    struct core_bgzf_block other_block;
+    uint64_t record_offsets[RECORD_COUNT];
+    char file[] = "/tmp/test_gzip_buffered_reader.fastq.gz";
+    char bgzf_file[] = "/tmp/test_gzip_buffered_reader_bgzf.fastq.gz";
+    char index_file[] = "/tmp/test_gzip_buffered_reader_bgzf.fastq.gz" CORE_BGZF_INDEX_SUFFIX;
+    char buffer[MAXIMUM_LINE_LENGTH];
+    uint64_t content_size;
+    uint64_t size;
+    uint64_t bytes;
+    uint64_t end;
+    int lines;
+    int read;
+    int bad_starts;
+    int blocks;
+    int i;
+
+    /*
+     * gzip: lines keep their new line, and offsets are in uncompressed bytes.
+     */
+    content_size = write_file(file, 0, record_offsets);
+
+    TEST_INT_EQUALS(core_bgzf_index_detect(file), 0);
+    TEST_INT_EQUALS(core_buffered_reader_get_content_size(file, &size), 0);
+
+    core_buffered_reader_init(&reader, file, 0);
+
+    lines = 0;
+    bytes = 0;
+
+    while ((read = core_buffered_reader_read_line(&reader, buffer, MAXIMUM_LINE_LENGTH)) > 0) {
+        ++lines;
+        bytes += read;
+    }
+
+    TEST_INT_EQUALS(lines, RECORD_COUNT * 4);
+    TEST_UINT64_T_EQUALS(bytes, content_size);
+    TEST_UINT64_T_EQUALS(core_buffered_reader_get_offset(&reader), content_size);
+
+    core_buffered_reader_destroy(&reader);
+
+    core_buffered_reader_init(&reader, file, record_offsets[700]);
+    core_buffered_reader_read_line(&reader, buffer, MAXIMUM_LINE_LENGTH);
+    TEST_INT_EQUALS(strcmp(buffer, "@r700\n"), 0);
+    core_buffered_reader_destroy(&reader);
+
+    /*
+     * A gzip file is not split.
+     */
+    core_vector_init(&start_offsets, sizeof(uint64_t));
+    core_vector_init(&end_offsets, sizeof(uint64_t));
+
+    biosal_record_splitter_split(file, 4, &start_offsets, &end_offsets);
+
+    TEST_INT_EQUALS(core_vector_size(&start_offsets), 1);
+    TEST_UINT64_T_EQUALS(core_vector_at_as_uint64_t(&start_offsets, 0), 0);
+
+    end = core_vector_at_as_uint64_t(&end_offsets, 0);
+    TEST_INT_IS_GREATER_THAN_OR_EQUAL(end, content_size);
+
+    /*
+     * BGZF
+     */
+    content_size = write_file(bgzf_file, 1, record_offsets);
+
+    TEST_INT_EQUALS(core_bgzf_index_detect(bgzf_file), 1);
+    TEST_INT_EQUALS(core_buffered_reader_get_content_size(bgzf_file, &size), 1);
+    TEST_UINT64_T_EQUALS(size, content_size);
+
+    core_bgzf_index_init(&index);
+
+    TEST_INT_EQUALS(core_bgzf_index_load(&index, bgzf_file), 1);
+    TEST_UINT64_T_EQUALS(core_bgzf_index_uncompressed_size(&index), content_size);
+
+    blocks = core_bgzf_index_size(&index);
+    TEST_INT_IS_GREATER_THAN(blocks, 10);
+
+    core_bgzf_index_find(&index, record_offsets[1234], &block);
+    TEST_INT_IS_LOWER_THAN_OR_EQUAL(block.uncompressed_offset, record_offsets[1234]);
+    TEST_INT_IS_LOWER_THAN(record_offsets[1234] - block.uncompressed_offset, BGZF_BLOCK_CONTENT_SIZE);
+
+    core_buffered_reader_init(&reader, bgzf_file, record_offsets[1234]);
+    core_buffered_reader_read_line(&reader, buffer, MAXIMUM_LINE_LENGTH);
+    TEST_INT_EQUALS(strcmp(buffer, "@r1234\n"), 0);
+    TEST_UINT64_T_EQUALS(core_buffered_reader_get_offset(&reader), record_offsets[1234] + 7);
+
+    lines = 1;
+
+    while (core_buffered_reader_read_line(&reader, buffer, MAXIMUM_LINE_LENGTH) > 0) {
+        ++lines;
+    }
+
+    TEST_INT_EQUALS(lines, (RECORD_COUNT - 1234) * 4);
+    TEST_UINT64_T_EQUALS(core_buffered_reader_get_offset(&reader), content_size);
+
+    core_buffered_reader_destroy(&reader);
+
+    /*
+     * A BGZF file is split on records, like a raw file.
+     */
+    core_vector_clear(&start_offsets);
+    core_vector_clear(&end_offsets);
+
+    biosal_record_splitter_split(bgzf_file, 5, &start_offsets, &end_offsets);
+
+    TEST_INT_EQUALS(core_vector_size(&start_offsets), 5);
+
+    bad_starts = 0;
+
+    for (i = 0; i < core_vector_size(&start_offsets); i++) {
+        if (!is_record_start(core_vector_at_as_uint64_t(&start_offsets, i), record_offsets)) {
+            ++bad_starts;
+        }
+    }
+
+    TEST_INT_EQUALS(bad_starts, 0);
+    TEST_UINT64_T_EQUALS(core_vector_at_as_uint64_t(&end_offsets, 4), content_size - 1);
+
+    /*
+     * The blocks after the last entry of the .gzi index are read from the file.
+     */
+    write_gzi(bgzf_file, &index);
+
+    core_bgzf_index_destroy(&index);
+    core_bgzf_index_init(&index);
+
+    TEST_INT_EQUALS(core_bgzf_index_load(&index, bgzf_file), 1);
+    TEST_INT_EQUALS(core_bgzf_index_size(&index), blocks);
+    TEST_UINT64_T_EQUALS(core_bgzf_index_uncompressed_size(&index), content_size);
+
+    core_bgzf_index_find(&index, record_offsets[1234], &other_block);
+    TEST_UINT64_T_EQUALS(other_block.compressed_offset, block.compressed_offset);
+    TEST_UINT64_T_EQUALS(other_block.uncompressed_offset, block.uncompressed_offset);
+
+    core_bgzf_index_destroy(&index);
+
+    core_vector_destroy(&start_offsets);
+    core_vector_destroy(&end_offsets);
+
+    remove(file);
+    remove(bgzf_file);
+    remove(index_file);
+
+    END_TESTS();
+
+    return 0;
+}
+
+static uint64_t write_file(const char *file, int bgzf, uint64_t *record_offsets)
+{
+    FILE *stream;
+    gzFile compressed_stream;
+    char content[BGZF_BLOCK_CONTENT_SIZE + MAXIMUM_LINE_LENGTH];
+    int content_size;
+    uint64_t offset;
+    int i;
+
+    stream = NULL;
+    compressed_stream = NULL;
+
+    if (bgzf) {
+        stream = fopen(file, "w");
+    } else {
+        compressed_stream = gzopen(file, "w");
+    }
+
+    offset = 0;
+    content_size = 0;
+
+    for (i = 0; i < RECORD_COUNT; i++) {
+        record_offsets[i] = offset + content_size;
+
+        content_size += sprintf(content + content_size, "@r%d\n", i);
+        content_size += sprintf(content + content_size, "ACGTACGTACGTACGTACGTACGTACGTACGT\n");
+        content_size += sprintf(content + content_size, "+\n");
+        content_size += sprintf(content + content_size, "@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@\n");
+
+        if (content_size < BGZF_BLOCK_CONTENT_SIZE && i < RECORD_COUNT - 1) {
+            continue;
+        }
+
+        /*
+         * Blocks end in the middle of lines.
+         */
+        if (bgzf) {
+            write_bgzf_block(stream, content, content_size - 3);
+            write_bgzf_block(stream, content + content_size - 3, 3);
+        } else {
+            gzwrite(compressed_stream, content, content_size);
+        }
+
+        offset += content_size;
+        content_size = 0;
+    }
+
+    if (bgzf) {
+        /*
+         * The end-of-file marker is an empty block.
+         */
+        write_bgzf_block(stream, content, 0);
+        fclose(stream);
+    } else {
+        gzclose(compressed_stream);
+    }
+
+    return offset;
+}
+
+static void write_bgzf_block(FILE *stream, const char *data, int length)
+{
+    uint8_t header[18] = { 0x1f, 0x8b, 8, 4, 0, 0, 0, 0, 0, 0xff, 6, 0, 'B', 'C', 2, 0, 0, 0 };
+    uint8_t output[BGZF_BLOCK_CAPACITY];
+    uint8_t trailer[8];
+    z_stream compressor;
+    uint32_t crc;
+    int block_size;
+    int i;
+
+    memset(&compressor, 0, sizeof(compressor));
+    deflateInit2(&compressor, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY);
+
+    compressor.next_in = (unsigned char *)data;
+    compressor.avail_in = length;
+    compressor.next_out = output;
+    compressor.avail_out = BGZF_BLOCK_CAPACITY;
+
+    deflate(&compressor, Z_FINISH);
+    deflateEnd(&compressor);
+
+    block_size = sizeof(header) + compressor.total_out + sizeof(trailer);
+    header[16] = (block_size - 1) & 0xff;
+    header[17] = (block_size - 1) >> 8;
+
+    crc = crc32(0, (const unsigned char *)data, length);
+
+    for (i = 0; i < 4; i++) {
+        trailer[i] = crc >> (8 * i);
+        trailer[4 + i] = (uint32_t)length >> (8 * i);
+    }
+
+    fwrite(header, 1, sizeof(header), stream);
+    fwrite(output, 1, compressor.total_out, stream);
+    fwrite(trailer, 1, sizeof(trailer), stream);
+}
+
+/*
+ * List the blocks but the first one (like bgzip) and the last ones.
+ */
+static void write_gzi(const char *file, struct core_bgzf_index *index)
+{
+    FILE *stream;
+    char index_file[MAXIMUM_LINE_LENGTH];
+    struct core_bgzf_block *block;
+    uint64_t count;
+    int i;
+
+    sprintf(index_file, "%s%s", file, CORE_BGZF_INDEX_SUFFIX);
+    stream = fopen(index_file, "w");
+
+    count = 0;
+
+    for (i = 1; i < core_bgzf_index_size(index) - 3; i++) {
+        ++count;
+    }
+
+    fwrite(&count, sizeof(count), 1, stream);
+
+    for (i = 1; i < core_bgzf_index_size(index) - 3; i++) {
+        block = core_vector_at(&index->blocks, i);
+
+        fwrite(&block->compressed_offset, sizeof(uint64_t), 1, stream);
+        fwrite(&block->uncompressed_offset, sizeof(uint64_t), 1, stream);
+    }
+
+    fclose(stream);
+}
+
+static int is_record_start(uint64_t offset, uint64_t *record_offsets)
+{
+    int i;
+
+    for (i = 0; i < RECORD_COUNT; i++) {
+        if (record_offsets[i] == offset) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,13 @@
+TEST_GZIP_BUFFERED_READER_NAME=gzip_buffered_reader
+TEST_GZIP_BUFFERED_READER_EXECUTABLE=tests/test_$(TEST_GZIP_BUFFERED_READER_NAME)
+TEST_GZIP_BUFFERED_READER_OBJECTS=tests/test_$(TEST_GZIP_BUFFERED_READER_NAME).o
+TEST_EXECUTABLES+=$(TEST_GZIP_BUFFERED_READER_EXECUTABLE)
+TEST_OBJECTS+=$(TEST_GZIP_BUFFERED_READER_OBJECTS)
+$(TEST_GZIP_BUFFERED_READER_EXECUTABLE): $(LIBRARY_OBJECTS) $(TEST_GZIP_BUFFERED_READER_OBJECTS) $(TEST_LIBRARY_OBJECTS)
+	$(Q)$(ECHO) "  LD $@"
+	$(Q)$(CC) $(CFLAGS) $^ -o $@ $(LDFLAGS) $(CONFIG_LDFLAGS)
+TEST_GZIP_BUFFERED_READER_RUN=test_run_$(TEST_GZIP_BUFFERED_READER_NAME)
+$(TEST_GZIP_BUFFERED_READER_RUN): $(TEST_GZIP_BUFFERED_READER_EXECUTABLE)
+	./$^
+TEST_RUNS+=$(TEST_GZIP_BUFFERED_READER_RUN)
+
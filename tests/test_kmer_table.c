@@ -0,0 +1,147 @@
+
+#include "test.h"
+
+#include <genomics/storage/kmer_table.h>
+#include <genomics/storage/kmer_table_iterator.h>
+
+#include <core/structures/map.h>
+#include <core/system/memory_pool.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+int main(int argc, char **argv)
+{
+    struct biosal_kmer_table table;
+    struct biosal_kmer_table_iterator iterator;
+    struct core_map map;
+    struct core_memory_pool pool;
+    int key_sizes[] = { 8, 9, 16, 24, 32, 33 };
+    uint8_t key[64];
+    void *iterator_key;
+    int *value;
+    int *expected;
+    int key_size;
+    int keys;
+    int i;
+    int j;
+    int k;
+    int inserted;
+    int new_keys;
+    int errors;
+    uint64_t iterated;
+    uint64_t total;
+
+    BEGIN_TESTS();
+
+    core_memory_pool_init(&pool, 1000000, -1);
+
+    for (k = 0; k < (int)(sizeof(key_sizes) / sizeof(key_sizes[0])); ++k) {
+
+        key_size = key_sizes[k];
+        keys = 50000;
+
+        biosal_kmer_table_init(&table, key_size, sizeof(int), &pool);
+        core_map_init(&map, key_size, sizeof(int));
+
+        TEST_INT_EQUALS(biosal_kmer_table_key_size(&table), key_size);
+        TEST_UINT64_T_EQUALS(biosal_kmer_table_size(&table), 0);
+
+        srand(k);
+        new_keys = 0;
+        errors = 0;
+
+        /*
+         * Keys come from a small set so that most of
+         * them are seen many times.
+         */
+        for (i = 0; i < 4 * keys; ++i) {
+
+            memset(key, 0, sizeof(key));
+
+            for (j = 0; j < key_size; ++j) {
+                key[j] = rand() % 256;
+            }
+
+            if (i % 4 != 0) {
+                memset(key, 0, 4);
+            }
+
+            if (biosal_kmer_table_get(&table, key) == NULL) {
+                ++new_keys;
+            }
+
+            value = biosal_kmer_table_add(&table, key, &inserted);
+            *value += 1;
+
+            if ((*value == 1) != inserted) {
+                ++errors;
+            }
+
+            expected = core_map_get(&map, key);
+
+            if (expected == NULL) {
+                expected = core_map_add(&map, key);
+                *expected = 0;
+            }
+
+            *expected += 1;
+
+            if (biosal_kmer_table_increment(&table, key, 2) != *expected + 2) {
+                ++errors;
+            }
+
+            *expected += 2;
+        }
+
+        TEST_INT_EQUALS(errors, 0);
+        TEST_UINT64_T_EQUALS(biosal_kmer_table_size(&table), core_map_size(&map));
+        TEST_UINT64_T_EQUALS(biosal_kmer_table_size(&table), (uint64_t)new_keys);
+        TEST_INT_IS_GREATER_THAN(biosal_kmer_table_capacity(&table), biosal_kmer_table_size(&table));
+
+        /*
+         * Every key is found with the same count.
+         */
+        biosal_kmer_table_iterator_init(&iterator, &table);
+
+        iterated = 0;
+        total = 0;
+        errors = 0;
+
+        while (biosal_kmer_table_iterator_has_next(&iterator)) {
+            biosal_kmer_table_iterator_next(&iterator, &iterator_key, (void **)&value);
+
+            expected = core_map_get(&map, iterator_key);
+
+            if (expected == NULL || *expected != *value) {
+                ++errors;
+            }
+
+            if (biosal_kmer_table_get(&table, iterator_key) != value) {
+                ++errors;
+            }
+
+            total += *value;
+            ++iterated;
+        }
+
+        biosal_kmer_table_iterator_destroy(&iterator);
+
+        TEST_INT_EQUALS(errors, 0);
+        TEST_UINT64_T_EQUALS(iterated, core_map_size(&map));
+        TEST_UINT64_T_EQUALS(total, (uint64_t)4 * keys * 3);
+
+        memset(key, 0xff, sizeof(key));
+        TEST_POINTER_EQUALS(biosal_kmer_table_get(&table, key), NULL);
+
+        core_map_destroy(&map);
+        biosal_kmer_table_destroy(&table);
+    }
+
+    core_memory_pool_destroy(&pool);
+
+    END_TESTS();
+
+    return 0;
+}
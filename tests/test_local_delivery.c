@@ -0,0 +1,214 @@
+
+#include "test.h"
+
+#include <engine/thorium/worker_pool.h>
+#include <engine/thorium/worker.h>
+#include <engine/thorium/actor.h>
+#include <engine/thorium/node.h>
+#include <engine/thorium/message.h>
+#include <engine/thorium/actor_name_codec.h>
+
+#include <core/structures/fast_ring.h>
+#include <core/structures/vector.h>
+#include <core/structures/queue.h>
+
+#include <string.h>
+
+#define WORKERS 3
+#define ACTORS 2
+
+#define ACTION_TEST_FILLER 100
+#define ACTION_TEST_FIRST 200
+
+#define SENT_BEFORE_MIGRATION 5
+#define SENT_AFTER_MIGRATION 3
+
+static void test_init_node(struct thorium_node *node, int argc, char **argv);
+static void test_destroy_node(struct thorium_node *node);
+static void test_send(struct thorium_worker *worker, int destination, int action);
+
+/*
+ * With -direct-local-delivery, a worker sends messages to the actors of
+ * its node without the node thread. The messages of a worker to an
+ * actor must arrive in order, even when the actor moves to another
+ * worker while some of them wait in the sending worker.
+ */
+int main(int argc, char **argv)
+{
+    BEGIN_TESTS();
+
+    struct thorium_node node;
+    struct thorium_worker_pool pool;
+    struct thorium_worker *sender;
+    struct thorium_worker *old_worker;
+    struct thorium_worker *new_worker;
+    struct thorium_worker *worker;
+    struct thorium_actor *actor;
+    struct thorium_actor *other_actor;
+    struct thorium_message message;
+    char *direct_argv[] = { "test_local_delivery", "-direct-local-delivery" };
+    int fillers;
+    int expected;
+    int errors;
+    int worker_index;
+    int i;
+
+    test_init_node(&node, 2, direct_argv);
+    thorium_worker_pool_init(&pool, WORKERS, &node);
+
+    sender = thorium_worker_pool_get_worker(&pool, 0);
+    old_worker = thorium_worker_pool_get_worker(&pool, 1);
+    new_worker = thorium_worker_pool_get_worker(&pool, 2);
+
+    actor = core_vector_at(&node.actors, 0);
+    other_actor = core_vector_at(&node.actors, 1);
+
+    thorium_actor_set_assigned_worker(actor, 1);
+
+    /*
+     * The inbound ring of the worker of the actor is full.
+     */
+    fillers = 0;
+
+    while (1) {
+        thorium_message_init(&message, ACTION_TEST_FILLER, 0, NULL);
+        thorium_message_set_destination(&message, thorium_actor_name(actor));
+
+        if (!thorium_worker_enqueue_inbound_message(old_worker, &message)) {
+            break;
+        }
+
+        ++fillers;
+    }
+
+    TEST_INT_IS_GREATER_THAN(fillers, 0);
+
+    for (i = 0; i < SENT_BEFORE_MIGRATION; ++i) {
+        test_send(sender, thorium_actor_name(actor), ACTION_TEST_FIRST + i);
+    }
+
+    TEST_INT_EQUALS(core_queue_size(&sender->local_delivery_queue), SENT_BEFORE_MIGRATION);
+
+    /*
+     * The actor moves to another worker, with an empty ring. The new
+     * messages must not pass the ones that are waiting.
+     */
+    thorium_actor_set_assigned_worker(actor, 2);
+
+    for (i = 0; i < SENT_AFTER_MIGRATION; ++i) {
+        test_send(sender, thorium_actor_name(actor), ACTION_TEST_FIRST + SENT_BEFORE_MIGRATION + i);
+    }
+
+    TEST_INT_EQUALS(core_queue_size(&sender->local_delivery_queue),
+                    SENT_BEFORE_MIGRATION + SENT_AFTER_MIGRATION);
+    TEST_INT_EQUALS(core_fast_ring_size_from_consumer(&new_worker->input_inbound_message_ring), 0);
+
+    thorium_worker_flush_local_delivery(sender);
+
+    TEST_INT_EQUALS(core_queue_size(&sender->local_delivery_queue), 0);
+    TEST_INT_EQUALS(core_fast_ring_size_from_consumer(&old_worker->input_inbound_message_ring),
+                    fillers);
+
+    /*
+     * All the messages are with the new worker, in the order in which
+     * they were sent.
+     */
+    expected = ACTION_TEST_FIRST;
+    errors = 0;
+
+    while (core_fast_ring_pop_from_consumer(&new_worker->input_inbound_message_ring, &message)) {
+        if (thorium_message_action(&message) != expected) {
+            ++errors;
+        }
+
+        ++expected;
+    }
+
+    TEST_INT_EQUALS(errors, 0);
+    TEST_INT_EQUALS(expected, ACTION_TEST_FIRST + SENT_BEFORE_MIGRATION + SENT_AFTER_MIGRATION);
+
+    /*
+     * An actor without a worker is placed by the sender, not by the
+     * node.
+     */
+    TEST_INT_EQUALS(thorium_actor_assigned_worker(other_actor), THORIUM_WORKER_NONE);
+
+    test_send(sender, thorium_actor_name(other_actor), ACTION_TEST_FIRST);
+
+    worker_index = thorium_actor_assigned_worker(other_actor);
+
+    TEST_INT_IS_GREATER_THAN_OR_EQUAL(worker_index, 0);
+    TEST_INT_IS_LOWER_THAN(worker_index, WORKERS);
+    TEST_INT_EQUALS(core_queue_size(&sender->output_outbound_message_queue), 0);
+    TEST_UINT64_T_EQUALS(sender->node_local_delivery_count, 0);
+
+    worker = thorium_worker_pool_get_worker(&pool, worker_index);
+
+    TEST_INT_EQUALS(core_fast_ring_pop_from_consumer(&worker->input_inbound_message_ring, &message), 1);
+    TEST_INT_EQUALS(thorium_message_destination(&message), thorium_actor_name(other_actor));
+
+    /*
+     * The first placement is kept.
+     */
+    TEST_INT_EQUALS(thorium_actor_place_on_worker(other_actor, (worker_index + 1) % WORKERS),
+                    worker_index);
+
+    thorium_worker_pool_destroy(&pool);
+    test_destroy_node(&node);
+
+    END_TESTS();
+
+    return 0;
+}
+
+/*
+ * The node is not started: it only has the actors needed by
+ * thorium_node_get_actor_from_name.
+ */
+static void test_init_node(struct thorium_node *node, int argc, char **argv)
+{
+    struct thorium_actor *actor;
+    int i;
+
+    memset(node, 0, sizeof(*node));
+
+    node->name = 0;
+    node->nodes = 1;
+    node->argc = argc;
+    node->argv = argv;
+
+    thorium_actor_name_codec_init(&node->actor_name_codec, node->name, node->nodes);
+
+    core_vector_init(&node->actors, sizeof(struct thorium_actor));
+    core_vector_resize(&node->actors, ACTORS);
+    core_vector_init(&node->actor_generations, sizeof(int));
+    core_vector_resize(&node->actor_generations, ACTORS);
+
+    for (i = 0; i < ACTORS; ++i) {
+        actor = core_vector_at(&node->actors, i);
+        memset(actor, 0, sizeof(*actor));
+
+        actor->name = thorium_actor_name_codec_encode(&node->actor_name_codec, i,
+                        THORIUM_ACTOR_NAME_CODEC_FIRST_GENERATION);
+        thorium_actor_set_assigned_worker(actor, THORIUM_WORKER_NONE);
+
+        core_vector_set_int(&node->actor_generations, i, THORIUM_ACTOR_NAME_CODEC_FIRST_GENERATION);
+    }
+}
+
+static void test_destroy_node(struct thorium_node *node)
+{
+    core_vector_destroy(&node->actors);
+    core_vector_destroy(&node->actor_generations);
+    thorium_actor_name_codec_destroy(&node->actor_name_codec);
+}
+
+static void test_send(struct thorium_worker *worker, int destination, int action)
+{
+    struct thorium_message message;
+
+    thorium_message_init(&message, action, 0, NULL);
+    thorium_message_set_destination(&message, destination);
+
+    thorium_worker_send_local_delivery(worker, &message);
+}
@@ -0,0 +1,13 @@
+TEST_LOCAL_DELIVERY_NAME=local_delivery
+TEST_LOCAL_DELIVERY_EXECUTABLE=tests/test_$(TEST_LOCAL_DELIVERY_NAME)
+TEST_LOCAL_DELIVERY_OBJECTS=tests/test_$(TEST_LOCAL_DELIVERY_NAME).o
+TEST_EXECUTABLES+=$(TEST_LOCAL_DELIVERY_EXECUTABLE)
+TEST_OBJECTS+=$(TEST_LOCAL_DELIVERY_OBJECTS)
+$(TEST_LOCAL_DELIVERY_EXECUTABLE): $(LIBRARY_OBJECTS) $(TEST_LOCAL_DELIVERY_OBJECTS) $(TEST_LIBRARY_OBJECTS)
+	$(Q)$(ECHO) "  LD $@"
+	$(Q)$(CC) $(CFLAGS) $^ -o $@ $(LDFLAGS) $(CONFIG_LDFLAGS)
+TEST_LOCAL_DELIVERY_RUN=test_run_$(TEST_LOCAL_DELIVERY_NAME)
+$(TEST_LOCAL_DELIVERY_RUN): $(TEST_LOCAL_DELIVERY_EXECUTABLE)
+	./$^
+TEST_RUNS+=$(TEST_LOCAL_DELIVERY_RUN)
+
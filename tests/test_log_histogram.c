@@ -0,0 +1,92 @@
+
+#include <core/structures/log_histogram.h>
+
+#include "test.h"
+
+int main(int argc, char **argv)
+{
+    struct core_log_histogram histogram;
+    struct core_log_histogram other;
+    uint64_t value;
+    uint64_t maximum;
+    int bucket;
+    int i;
+
+    BEGIN_TESTS();
+
+    core_log_histogram_init(&histogram);
+
+    TEST_UINT64_T_EQUALS(core_log_histogram_get_percentile(&histogram, 50), 0);
+
+    /*
+     * Small values are exact.
+     */
+    for (i = 0; i < CORE_LOG_HISTOGRAM_SUB_BUCKETS; ++i) {
+        TEST_INT_EQUALS(core_log_histogram_get_bucket(i), i);
+        TEST_UINT64_T_EQUALS(core_log_histogram_get_bucket_maximum(i), (uint64_t)i);
+    }
+
+    /*
+     * Each value is in a bucket whose maximum is at most 12.5% above it.
+     */
+    for (value = 1; value < ((uint64_t)1 << 36); value = value * 3 / 2 + 1) {
+        bucket = core_log_histogram_get_bucket(value);
+        maximum = core_log_histogram_get_bucket_maximum(bucket);
+
+        TEST_INT_IS_LOWER_THAN_OR_EQUAL(value, maximum);
+        TEST_INT_IS_LOWER_THAN_OR_EQUAL(maximum - value, value / CORE_LOG_HISTOGRAM_SUB_BUCKETS);
+
+        if (bucket > 0) {
+            TEST_INT_IS_LOWER_THAN(core_log_histogram_get_bucket_maximum(bucket - 1), value);
+        }
+    }
+
+    TEST_INT_EQUALS(core_log_histogram_get_bucket(UINT64_MAX), CORE_LOG_HISTOGRAM_BUCKETS - 1);
+
+    /*
+     * 1, 2, ..., 1000
+     */
+    for (i = 1; i <= 1000; ++i) {
+        core_log_histogram_add(&histogram, i);
+    }
+
+    TEST_UINT64_T_EQUALS(core_log_histogram_count(&histogram), 1000);
+    TEST_UINT64_T_EQUALS(core_log_histogram_sum(&histogram), 500500);
+    TEST_UINT64_T_EQUALS(core_log_histogram_maximum(&histogram), 1000);
+    TEST_UINT64_T_EQUALS(core_log_histogram_get_percentile(&histogram, 100), 1000);
+
+    value = core_log_histogram_get_percentile(&histogram, 50);
+    TEST_INT_IS_GREATER_THAN_OR_EQUAL(value, 500);
+    TEST_INT_IS_LOWER_THAN_OR_EQUAL(value, 500 + 500 / 8);
+
+    value = core_log_histogram_get_percentile(&histogram, 99);
+    TEST_INT_IS_GREATER_THAN_OR_EQUAL(value, 990);
+    TEST_INT_IS_LOWER_THAN_OR_EQUAL(value, 1000);
+
+    /*
+     * Merge a slow tail.
+     */
+    core_log_histogram_init(&other);
+
+    for (i = 0; i < 1000; ++i) {
+        core_log_histogram_add(&other, 1000000);
+    }
+
+    core_log_histogram_merge(&histogram, &other);
+
+    TEST_UINT64_T_EQUALS(core_log_histogram_count(&histogram), 2000);
+    TEST_UINT64_T_EQUALS(core_log_histogram_maximum(&histogram), 1000000);
+
+    value = core_log_histogram_get_percentile(&histogram, 25);
+    TEST_INT_IS_GREATER_THAN_OR_EQUAL(value, 500);
+    TEST_INT_IS_LOWER_THAN_OR_EQUAL(value, 500 + 500 / 8);
+
+    TEST_UINT64_T_EQUALS(core_log_histogram_get_percentile(&histogram, 99), 1000000);
+
+    core_log_histogram_destroy(&other);
+    core_log_histogram_destroy(&histogram);
+
+    END_TESTS();
+
+    return 0;
+}
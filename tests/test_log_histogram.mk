@@ -0,0 +1,13 @@
+TEST_LOG_HISTOGRAM_NAME=log_histogram
+TEST_LOG_HISTOGRAM_EXECUTABLE=tests/test_$(TEST_LOG_HISTOGRAM_NAME)
+TEST_LOG_HISTOGRAM_OBJECTS=tests/test_$(TEST_LOG_HISTOGRAM_NAME).o
+TEST_EXECUTABLES+=$(TEST_LOG_HISTOGRAM_EXECUTABLE)
+TEST_OBJECTS+=$(TEST_LOG_HISTOGRAM_OBJECTS)
+$(TEST_LOG_HISTOGRAM_EXECUTABLE): $(LIBRARY_OBJECTS) $(TEST_LOG_HISTOGRAM_OBJECTS) $(TEST_LIBRARY_OBJECTS)
+	$(Q)$(ECHO) "  LD $@"
+	$(Q)$(CC) $(CFLAGS) $^ -o $@ $(LDFLAGS) $(CONFIG_LDFLAGS)
+TEST_LOG_HISTOGRAM_RUN=test_run_$(TEST_LOG_HISTOGRAM_NAME)
+$(TEST_LOG_HISTOGRAM_RUN): $(TEST_LOG_HISTOGRAM_EXECUTABLE)
+	./$^
+TEST_RUNS+=$(TEST_LOG_HISTOGRAM_RUN)
+
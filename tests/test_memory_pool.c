@@ -8,6 +8,7 @@
 
 #include <stdint.h>
 #include <inttypes.h>
+#include <string.h>
 
 void test_allocator(struct core_memory_pool *memory)
 {
@@ -186,6 +187,200 @@ int main(int argc, char **argv)
     TEST_BOOLEAN_EQUALS(core_memory_pool_has_leaks(&pool), 0);
 
     core_memory_pool_destroy(&pool);
+
+    /*
+     * Slab mode
+     */
+    TEST_INT_EQUALS(core_memory_pool_get_size_class(1), 0);
+    TEST_INT_EQUALS(core_memory_pool_get_size_class(16), 0);
+    TEST_INT_EQUALS(core_memory_pool_get_size_class(17), 1);
+    TEST_INT_EQUALS(core_memory_pool_get_size_class(128), 7);
+    TEST_INT_EQUALS(core_memory_pool_get_size_class(129), 8);
+    TEST_INT_EQUALS(core_memory_pool_get_size_class(256), 11);
+    TEST_INT_EQUALS(core_memory_pool_get_size_class(257), 12);
+    TEST_INT_EQUALS(core_memory_pool_get_size_class(CORE_MEMORY_POOL_SLAB_MAXIMUM_SIZE),
+                    CORE_MEMORY_POOL_SLAB_CLASS_COUNT - 1);
+
+    for (i = 1; i <= CORE_MEMORY_POOL_SLAB_MAXIMUM_SIZE; i += 7) {
+        int size_class;
+
+        size_class = core_memory_pool_get_size_class(i);
+
+        TEST_INT_IS_GREATER_THAN_OR_EQUAL(core_memory_pool_get_class_size(size_class), (size_t)i);
+
+        if (size_class > 0) {
+            TEST_INT_IS_LOWER_THAN(core_memory_pool_get_class_size(size_class - 1), (size_t)i);
+        }
+    }
+
+    core_memory_pool_init(&pool, 65536, name);
+    core_memory_pool_enable_slab_mode(&pool);
+    core_vector_clear(&vector);
+
+    for (i = 0; i < 9999; ++i) {
+        object = core_memory_pool_allocate(&pool, 1 + (i * 13) % 3000);
+
+        TEST_POINTER_NOT_EQUALS(object, NULL);
+
+        memset(object, 0xff, 1 + (i * 13) % 3000);
+        core_vector_push_back(&vector, &object);
+    }
+
+    for (i = 0; i < (int)core_vector_size(&vector); ++i) {
+        object = core_vector_at_as_void_pointer(&vector, i);
+
+        /*
+         * Half of the buffers are freed by "another thread".
+         */
+        if (i % 2) {
+            TEST_INT_EQUALS(core_memory_pool_free_remote(&pool, object), 1);
+        } else {
+            core_memory_pool_free(&pool, object);
+        }
+    }
+
+    core_memory_pool_collect_remote_frees(&pool);
+
+    TEST_BOOLEAN_EQUALS(core_memory_pool_has_double_free(&pool), 0);
+    TEST_BOOLEAN_EQUALS(core_memory_pool_has_leaks(&pool), 0);
+
+    /*
+     * A freed buffer is reused for the same class.
+     */
+    object = core_memory_pool_allocate(&pool, 100);
+    core_memory_pool_free(&pool, object);
+    TEST_POINTER_EQUALS(core_memory_pool_allocate(&pool, 112), object);
+    core_memory_pool_free(&pool, object);
+
+    object = core_memory_pool_allocate(&pool, 1000000);
+    TEST_POINTER_NOT_EQUALS(object, NULL);
+    TEST_BOOLEAN_EQUALS(core_memory_pool_has_leaks(&pool), 1);
+    core_memory_pool_free(&pool, object);
+    TEST_BOOLEAN_EQUALS(core_memory_pool_has_leaks(&pool), 0);
+
+    core_memory_pool_destroy(&pool);
+
+#ifndef CORE_DEBUGGER_ASSERT_ENABLED
+    /*
+     * core_memory_pool_free_all releases the large buffers and drops
+     * the buffers given back by other threads.
+     */
+    core_memory_pool_init(&pool, 65536, name);
+    core_memory_pool_enable_slab_mode(&pool);
+
+    object = core_memory_pool_allocate(&pool, 100);
+    core_memory_pool_allocate(&pool, 1000000);
+    core_memory_pool_allocate(&pool, 2000000);
+    TEST_INT_EQUALS(core_memory_pool_free_remote(&pool, object), 1);
+
+    core_memory_pool_free_all(&pool);
+
+    TEST_POINTER_EQUALS(pool.slab_large_blocks, NULL);
+    TEST_POINTER_EQUALS(pool.remote_free_list, NULL);
+
+    object = core_memory_pool_allocate(&pool, 1000000);
+    TEST_POINTER_NOT_EQUALS(pool.slab_large_blocks, NULL);
+    core_memory_pool_free(&pool, object);
+    TEST_POINTER_EQUALS(pool.slab_large_blocks, NULL);
+
+    core_memory_pool_destroy(&pool);
+#endif
+
+    /*
+     * Remote frees are not possible without slab mode.
+     */
+    core_memory_pool_init(&pool, 65536, name);
+    object = core_memory_pool_allocate(&pool, 100);
+    TEST_INT_EQUALS(core_memory_pool_free_remote(&pool, object), 0);
+    core_memory_pool_free(&pool, object);
+    core_memory_pool_destroy(&pool);
+
+    /*
+     * Arena scopes
+     */
+    {
+        struct core_memory_pool_scope outer;
+        struct core_memory_pool_scope inner;
+        void *first;
+
+        core_memory_pool_init(&pool, 4096, name);
+        core_memory_pool_disable_tracking(&pool);
+        core_memory_pool_enable_ephemeral_mode(&pool);
+        core_memory_pool_enable_arena_mode(&pool);
+
+        core_memory_pool_begin_scope(&pool, &outer);
+
+        first = core_memory_pool_allocate(&pool, 100);
+
+        core_memory_pool_begin_scope(&pool, &inner);
+
+        object = core_memory_pool_allocate(&pool, 100);
+        TEST_POINTER_NOT_EQUALS(object, first);
+
+        /*
+         * Fill a few blocks and add large buffers.
+         */
+        for (i = 0; i < 1000; ++i) {
+            object = core_memory_pool_allocate(&pool, 1 + i % 1000);
+            memset(object, 0, 1 + i % 1000);
+            core_memory_pool_free(&pool, object);
+        }
+
+        object = core_memory_pool_allocate(&pool, 100000);
+        TEST_POINTER_NOT_EQUALS(object, NULL);
+
+        core_memory_pool_end_scope(&pool, &inner);
+
+        /*
+         * The inner scope is gone, and the outer one is still there.
+         */
+        object = core_memory_pool_allocate(&pool, 100);
+        TEST_POINTER_EQUALS(object, (char *)first + 100);
+
+        core_memory_pool_end_scope(&pool, &outer);
+
+        core_memory_pool_begin_scope(&pool, &outer);
+        object = core_memory_pool_allocate(&pool, 100);
+        TEST_POINTER_NOT_EQUALS(object, NULL);
+        core_memory_pool_end_scope(&pool, &outer);
+
+        TEST_UINT64_T_EQUALS(core_memory_pool_scope_count(&pool), 3);
+        TEST_INT_IS_GREATER_THAN_OR_EQUAL(core_memory_pool_scope_high_water_mark(&pool), 100000);
+
+        core_memory_pool_destroy(&pool);
+    }
+
+    /*
+     * Mapped blocks
+     */
+    {
+        uint64_t byte_count;
+        int node;
+
+        core_memory_pool_init(&pool, CORE_MEMORY_HUGE_PAGE_SIZE, name);
+        core_memory_pool_enable_huge_pages(&pool);
+        core_memory_pool_set_numa_node(&pool, core_memory_get_processor_numa_node(0));
+
+        for (i = 0; i < 100; ++i) {
+            object = core_memory_pool_allocate(&pool, 65536);
+            TEST_POINTER_NOT_EQUALS(object, NULL);
+            memset(object, 1, 65536);
+        }
+
+        byte_count = core_memory_pool_numa_node_byte_count(&pool, CORE_MEMORY_NUMA_NODE_NONE);
+
+        for (node = 0; node < CORE_MEMORY_POOL_NUMA_NODE_COUNT; ++node) {
+            byte_count += core_memory_pool_numa_node_byte_count(&pool, node);
+        }
+
+        /*
+         * 100 buffers of 64 KiB (and their size) need 4 blocks.
+         */
+        TEST_UINT64_T_EQUALS(byte_count, 4 * CORE_MEMORY_HUGE_PAGE_SIZE);
+
+        core_memory_pool_destroy(&pool);
+    }
+
     core_vector_destroy(&vector);
 
     END_TESTS();
@@ -0,0 +1,154 @@
+
+#include <engine/thorium/transport/multiplexed_buffer.h>
+#include <engine/thorium/message.h>
+
+#include "test.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+#define BUFFER_SIZE 65536
+#define MESSAGE_COUNT 12
+
+int main(int argc, char **argv)
+{
+    struct thorium_multiplexed_buffer multiplexed_buffer;
+    struct thorium_message message;
+    struct thorium_message read_message;
+    int headers[MESSAGE_COUNT][THORIUM_MULTIPLEXED_BUFFER_HEADER_FIELDS] = {
+        /* action, source, destination, identifier, parent actor, parent identifier */
+        { 1, 2, 3, 4, 5, 6 },
+        { 1, 2, 3, 5, 5, 7 },
+        { 1, 2, 3, 5, 5, 7 },
+        { 0, 1, 0, 0, -1, -1 },
+        { INT_MAX, INT_MAX, INT_MAX, INT_MAX, INT_MAX, INT_MAX },
+        { INT_MIN, INT_MIN, INT_MIN, INT_MIN, INT_MIN, INT_MIN },
+        { INT_MAX, INT_MIN, INT_MAX, INT_MIN, INT_MAX, INT_MIN },
+        { -2, -1, -1, -1, -1, -1 },
+        { 0, 0, 0, 0, 0, 0 },
+        { -64, 63, -65, 64, -8192, 8191 },
+        { 0x7000, 1000000, -1000000, 123456789, -123456789, 42 },
+        { 0x7001, 1000001, -1000001, 123456788, -123456790, 41 },
+    };
+    int counts[MESSAGE_COUNT] = { 0, 1, 1, 127, 128, 300, 16383, 16384, 5, 0, 64, 65 };
+    int previous_header[THORIUM_MULTIPLEXED_BUFFER_HEADER_FIELDS];
+    char *buffer;
+    char *payload;
+    char *position;
+    int required_size;
+    int current_size;
+    int header_size;
+    int count;
+    int i;
+
+    BEGIN_TESTS();
+
+    buffer = malloc(BUFFER_SIZE);
+    payload = malloc(BUFFER_SIZE);
+
+    for (i = 0; i < BUFFER_SIZE; ++i) {
+        payload[i] = (char)(i * 7 + 3);
+    }
+
+    thorium_multiplexed_buffer_init(&multiplexed_buffer, BUFFER_SIZE, 0);
+    thorium_multiplexed_buffer_set_buffer(&multiplexed_buffer, buffer);
+
+    /*
+     * Append the messages.
+     */
+    for (i = 0; i < MESSAGE_COUNT; ++i) {
+        thorium_message_init(&message, headers[i][0],
+                        counts[i] + THORIUM_MESSAGE_METADATA_SIZE, payload + i);
+        thorium_message_set_source(&message, headers[i][1]);
+        thorium_message_set_destination(&message, headers[i][2]);
+        thorium_message_set_identifier(&message, headers[i][3]);
+        thorium_message_set_parent_actor(&message, headers[i][4]);
+        thorium_message_set_parent_identifier(&message, headers[i][5]);
+
+        current_size = thorium_multiplexed_buffer_current_size(&multiplexed_buffer);
+        required_size = thorium_multiplexed_buffer_required_size(&multiplexed_buffer, &message);
+
+        thorium_multiplexed_buffer_append(&multiplexed_buffer, &message, 0);
+
+        TEST_INT_EQUALS(thorium_multiplexed_buffer_current_size(&multiplexed_buffer),
+                        current_size + required_size);
+
+        /*
+         * A header equal to the previous one has null deltas (1 byte each).
+         */
+        if (i == 2) {
+            TEST_INT_EQUALS(required_size - counts[i],
+                            1 + THORIUM_MULTIPLEXED_BUFFER_HEADER_FIELDS + TRACEPOINT_SIZE);
+        }
+    }
+
+    /*
+     * Read them back.
+     */
+    thorium_multiplexed_buffer_clear_header(previous_header);
+    position = buffer;
+
+    for (i = 0; i < MESSAGE_COUNT; ++i) {
+        header_size = thorium_multiplexed_buffer_read_header(previous_header, position,
+                        &read_message, &count);
+
+        TEST_INT_EQUALS(count, counts[i]);
+        TEST_INT_EQUALS(thorium_message_action(&read_message), headers[i][0]);
+        TEST_INT_EQUALS(thorium_message_source(&read_message), headers[i][1]);
+        TEST_INT_EQUALS(thorium_message_destination(&read_message), headers[i][2]);
+        TEST_INT_EQUALS(thorium_message_get_identifier(&read_message), headers[i][3]);
+        TEST_INT_EQUALS(thorium_message_get_parent_actor(&read_message), headers[i][4]);
+        TEST_INT_EQUALS(thorium_message_get_parent_identifier(&read_message), headers[i][5]);
+
+        /*
+         * A delta takes at most 5 bytes.
+         */
+        TEST_INT_IS_LOWER_THAN_OR_EQUAL(header_size,
+                        5 + 5 * THORIUM_MULTIPLEXED_BUFFER_HEADER_FIELDS + TRACEPOINT_SIZE);
+
+        position += header_size;
+
+        TEST_INT_EQUALS(memcmp(position, payload + i, count), 0);
+
+        position += count;
+    }
+
+    current_size = position - buffer;
+    TEST_INT_EQUALS(current_size, thorium_multiplexed_buffer_current_size(&multiplexed_buffer));
+
+    /*
+     * Resetting the buffer clears the previous header.
+     */
+    thorium_multiplexed_buffer_reset(&multiplexed_buffer);
+    thorium_multiplexed_buffer_set_buffer(&multiplexed_buffer, buffer);
+
+    thorium_message_init(&message, -2, THORIUM_MESSAGE_METADATA_SIZE, payload);
+    thorium_message_set_source(&message, INT_MIN);
+    thorium_message_set_destination(&message, INT_MAX);
+    thorium_message_set_identifier(&message, -1);
+    thorium_message_set_parent_actor(&message, -2);
+    thorium_message_set_parent_identifier(&message, 1);
+
+    thorium_multiplexed_buffer_append(&multiplexed_buffer, &message, 0);
+
+    thorium_multiplexed_buffer_clear_header(previous_header);
+    thorium_multiplexed_buffer_read_header(previous_header, buffer, &read_message, &count);
+
+    TEST_INT_EQUALS(count, 0);
+    TEST_INT_EQUALS(thorium_message_action(&read_message), -2);
+    TEST_INT_EQUALS(thorium_message_source(&read_message), INT_MIN);
+    TEST_INT_EQUALS(thorium_message_destination(&read_message), INT_MAX);
+    TEST_INT_EQUALS(thorium_message_get_identifier(&read_message), -1);
+    TEST_INT_EQUALS(thorium_message_get_parent_actor(&read_message), -2);
+    TEST_INT_EQUALS(thorium_message_get_parent_identifier(&read_message), 1);
+
+    thorium_multiplexed_buffer_destroy(&multiplexed_buffer);
+
+    free(buffer);
+    free(payload);
+
+    END_TESTS();
+
+    return 0;
+}
@@ -0,0 +1,13 @@
+TEST_MULTIPLEXED_BUFFER_NAME=multiplexed_buffer
+TEST_MULTIPLEXED_BUFFER_EXECUTABLE=tests/test_$(TEST_MULTIPLEXED_BUFFER_NAME)
+TEST_MULTIPLEXED_BUFFER_OBJECTS=tests/test_$(TEST_MULTIPLEXED_BUFFER_NAME).o
+TEST_EXECUTABLES+=$(TEST_MULTIPLEXED_BUFFER_EXECUTABLE)
+TEST_OBJECTS+=$(TEST_MULTIPLEXED_BUFFER_OBJECTS)
+$(TEST_MULTIPLEXED_BUFFER_EXECUTABLE): $(LIBRARY_OBJECTS) $(TEST_MULTIPLEXED_BUFFER_OBJECTS) $(TEST_LIBRARY_OBJECTS)
+	$(Q)$(ECHO) "  LD $@"
+	$(Q)$(CC) $(CFLAGS) $^ -o $@ $(LDFLAGS) $(CONFIG_LDFLAGS)
+TEST_MULTIPLEXED_BUFFER_RUN=test_run_$(TEST_MULTIPLEXED_BUFFER_NAME)
+$(TEST_MULTIPLEXED_BUFFER_RUN): $(TEST_MULTIPLEXED_BUFFER_EXECUTABLE)
+	./$^
+TEST_RUNS+=$(TEST_MULTIPLEXED_BUFFER_RUN)
+
@@ -0,0 +1,241 @@
+
+#include "test.h"
+
+#include <engine/thorium/cache/node_message_cache.h>
+#include <engine/thorium/message.h>
+
+#include <core/system/memory_pool.h>
+
+#include <stdint.h>
+#include <string.h>
+
+#define ACTION_TEST_GET 100
+#define ACTION_TEST_GET_REPLY 101
+#define ACTION_TEST_SET 102
+
+#define TEST_DESTINATION 7
+#define REPLY_SIZE 64
+#define KEYS 1000
+
+/*
+ * The cache is small so that entries are evicted.
+ */
+#define SMALL_CACHE_BYTE_COUNT 32768
+#define LARGE_CACHE_BYTE_COUNT 16777216
+
+static void test_make_tag(struct thorium_cache_tag *tag, int *key);
+static int test_get(struct thorium_node_message_cache *cache, int *key,
+                struct core_memory_pool *pool, int *value);
+
+int main(int argc, char **argv)
+{
+    BEGIN_TESTS();
+
+    struct thorium_node_message_cache cache;
+    struct thorium_cache_tag tag;
+    struct thorium_message reply_message;
+    struct thorium_message set_message;
+    struct core_memory_pool pool;
+    char reply_buffer[REPLY_SIZE];
+    int set_buffer[3];
+    uint64_t hit_count;
+    uint64_t miss_count;
+    uint64_t eviction_count;
+    uint64_t invalidation_count;
+    uint64_t epoch;
+    int key[2];
+    int value;
+    int i;
+
+    core_memory_pool_init(&pool, 65536, -1);
+
+    /*
+     * put / get
+     */
+    thorium_node_message_cache_init(&cache, LARGE_CACHE_BYTE_COUNT);
+
+    for (i = 0; i < KEYS; ++i) {
+        key[0] = i;
+        key[1] = i * 3;
+        test_make_tag(&tag, key);
+
+        memset(reply_buffer, 0, REPLY_SIZE);
+        memcpy(reply_buffer, &i, sizeof(i));
+        thorium_message_init(&reply_message, ACTION_TEST_GET_REPLY, REPLY_SIZE, reply_buffer);
+        thorium_node_message_cache_put(&cache, &tag, &reply_message,
+                        thorium_node_message_cache_get_epoch(&cache, &tag));
+        thorium_message_destroy(&reply_message);
+    }
+
+    TEST_UINT64_T_EQUALS(thorium_node_message_cache_size(&cache), KEYS);
+
+    key[0] = 123;
+    key[1] = 369;
+    TEST_INT_EQUALS(test_get(&cache, key, &pool, &value), 1);
+    TEST_INT_EQUALS(value, 123);
+
+    key[1] = 370;
+    TEST_INT_EQUALS(test_get(&cache, key, &pool, &value), 0);
+
+    /*
+     * A message ACTION_TEST_SET with the key and a flag invalidates
+     * the reply of ACTION_TEST_GET with the key.
+     */
+    thorium_node_message_cache_add_rule(&cache, ACTION_TEST_SET, ACTION_TEST_GET, sizeof(int));
+    thorium_node_message_cache_add_rule(&cache, ACTION_TEST_SET, ACTION_TEST_GET, sizeof(int));
+
+    set_buffer[0] = 123;
+    set_buffer[1] = 369;
+    set_buffer[2] = 42;
+    thorium_message_init(&set_message, ACTION_TEST_SET, sizeof(set_buffer), set_buffer);
+
+    /*
+     * Another destination does not invalidate anything.
+     */
+    thorium_node_message_cache_invalidate(&cache, TEST_DESTINATION + 1, &set_message);
+    TEST_UINT64_T_EQUALS(thorium_node_message_cache_size(&cache), KEYS);
+
+    thorium_node_message_cache_invalidate(&cache, TEST_DESTINATION, &set_message);
+    thorium_message_destroy(&set_message);
+
+    TEST_UINT64_T_EQUALS(thorium_node_message_cache_size(&cache), KEYS - 1);
+
+    key[0] = 123;
+    key[1] = 369;
+    TEST_INT_EQUALS(test_get(&cache, key, &pool, &value), 0);
+
+    thorium_node_message_cache_get_profile(&cache, &hit_count, &miss_count,
+                    &eviction_count, &invalidation_count);
+
+    TEST_UINT64_T_EQUALS(hit_count, 1);
+    TEST_UINT64_T_EQUALS(miss_count, 2);
+    TEST_UINT64_T_EQUALS(eviction_count, 0);
+    TEST_UINT64_T_EQUALS(invalidation_count, 1);
+
+    /*
+     * Drop one request directly, like a change that no rule can see.
+     */
+    key[0] = 456;
+    key[1] = 1368;
+    TEST_INT_EQUALS(test_get(&cache, key, &pool, &value), 1);
+
+    thorium_node_message_cache_invalidate_request(&cache, TEST_DESTINATION + 1,
+                    ACTION_TEST_GET, sizeof(key), key);
+    TEST_UINT64_T_EQUALS(thorium_node_message_cache_size(&cache), KEYS - 1);
+
+    thorium_node_message_cache_invalidate_request(&cache, TEST_DESTINATION,
+                    ACTION_TEST_GET, sizeof(key), key);
+    TEST_UINT64_T_EQUALS(thorium_node_message_cache_size(&cache), KEYS - 2);
+    TEST_INT_EQUALS(test_get(&cache, key, &pool, &value), 0);
+
+    /*
+     * A request is sent and a change is invalidated before its reply
+     * arrives. The reply may be from before the change, so it is not
+     * saved.
+     */
+    key[0] = 789;
+    key[1] = 1;
+    test_make_tag(&tag, key);
+
+    TEST_INT_EQUALS(test_get(&cache, key, &pool, &value), 0);
+    epoch = thorium_node_message_cache_get_epoch(&cache, &tag);
+
+    thorium_node_message_cache_invalidate_request(&cache, TEST_DESTINATION,
+                    ACTION_TEST_GET, sizeof(key), key);
+
+    memset(reply_buffer, 0, REPLY_SIZE);
+    memcpy(reply_buffer, &key[0], sizeof(key[0]));
+    thorium_message_init(&reply_message, ACTION_TEST_GET_REPLY, REPLY_SIZE, reply_buffer);
+    thorium_node_message_cache_put(&cache, &tag, &reply_message, epoch);
+
+    TEST_UINT64_T_EQUALS(thorium_node_message_cache_size(&cache), KEYS - 2);
+    TEST_UINT64_T_EQUALS(thorium_node_message_cache_stale_reply_count(&cache), 1);
+    TEST_INT_EQUALS(test_get(&cache, key, &pool, &value), 0);
+
+    /*
+     * The reply of a request sent after the invalidation is saved.
+     */
+    epoch = thorium_node_message_cache_get_epoch(&cache, &tag);
+    thorium_node_message_cache_put(&cache, &tag, &reply_message, epoch);
+    thorium_message_destroy(&reply_message);
+
+    TEST_UINT64_T_EQUALS(thorium_node_message_cache_size(&cache), KEYS - 1);
+    TEST_INT_EQUALS(test_get(&cache, key, &pool, &value), 1);
+    TEST_INT_EQUALS(value, 789);
+
+    thorium_node_message_cache_destroy(&cache);
+
+    /*
+     * Eviction
+     */
+    thorium_node_message_cache_init(&cache, SMALL_CACHE_BYTE_COUNT);
+
+    for (i = 0; i < KEYS; ++i) {
+        key[0] = i;
+        key[1] = i * 3;
+        test_make_tag(&tag, key);
+
+        memset(reply_buffer, 0, REPLY_SIZE);
+        memcpy(reply_buffer, &i, sizeof(i));
+        thorium_message_init(&reply_message, ACTION_TEST_GET_REPLY, REPLY_SIZE, reply_buffer);
+        thorium_node_message_cache_put(&cache, &tag, &reply_message,
+                        thorium_node_message_cache_get_epoch(&cache, &tag));
+        thorium_message_destroy(&reply_message);
+
+        /*
+         * Key 0 is used all the time, so the CLOCK keeps it.
+         */
+        key[0] = 0;
+        key[1] = 0;
+        TEST_INT_EQUALS(test_get(&cache, key, &pool, &value), 1);
+    }
+
+    TEST_INT_IS_LOWER_THAN_OR_EQUAL(thorium_node_message_cache_byte_count(&cache), SMALL_CACHE_BYTE_COUNT);
+    TEST_INT_IS_LOWER_THAN(thorium_node_message_cache_size(&cache), KEYS);
+
+    key[0] = KEYS - 1;
+    key[1] = (KEYS - 1) * 3;
+    TEST_INT_EQUALS(test_get(&cache, key, &pool, &value), 1);
+    TEST_INT_EQUALS(value, KEYS - 1);
+
+    thorium_node_message_cache_get_profile(&cache, &hit_count, &miss_count,
+                    &eviction_count, &invalidation_count);
+
+    TEST_UINT64_T_EQUALS(eviction_count + thorium_node_message_cache_size(&cache), KEYS);
+
+    thorium_node_message_cache_destroy(&cache);
+
+    core_memory_pool_destroy(&pool);
+
+    END_TESTS();
+
+    return 0;
+}
+
+static void test_make_tag(struct thorium_cache_tag *tag, int *key)
+{
+    struct thorium_message request_message;
+
+    thorium_message_init(&request_message, ACTION_TEST_GET, 2 * sizeof(int), key);
+    thorium_message_set_destination(&request_message, TEST_DESTINATION);
+    thorium_cache_tag_set(tag, &request_message);
+    thorium_message_destroy(&request_message);
+}
+
+static int test_get(struct thorium_node_message_cache *cache, int *key,
+                struct core_memory_pool *pool, int *value)
+{
+    struct thorium_cache_tag tag;
+    struct thorium_message reply_message;
+
+    test_make_tag(&tag, key);
+
+    if (!thorium_node_message_cache_get(cache, &tag, &reply_message, pool)) {
+        return 0;
+    }
+
+    memcpy(value, thorium_message_buffer(&reply_message), sizeof(*value));
+    core_memory_pool_free(pool, thorium_message_buffer(&reply_message));
+
+    return 1;
+}
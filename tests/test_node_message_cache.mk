@@ -0,0 +1,13 @@
+TEST_NODE_MESSAGE_CACHE_NAME=node_message_cache
+TEST_NODE_MESSAGE_CACHE_EXECUTABLE=tests/test_$(TEST_NODE_MESSAGE_CACHE_NAME)
+TEST_NODE_MESSAGE_CACHE_OBJECTS=tests/test_$(TEST_NODE_MESSAGE_CACHE_NAME).o
+TEST_EXECUTABLES+=$(TEST_NODE_MESSAGE_CACHE_EXECUTABLE)
+TEST_OBJECTS+=$(TEST_NODE_MESSAGE_CACHE_OBJECTS)
+$(TEST_NODE_MESSAGE_CACHE_EXECUTABLE): $(LIBRARY_OBJECTS) $(TEST_NODE_MESSAGE_CACHE_OBJECTS) $(TEST_LIBRARY_OBJECTS)
+	$(Q)$(ECHO) "  LD $@"
+	$(Q)$(CC) $(CFLAGS) $^ -o $@ $(LDFLAGS) $(CONFIG_LDFLAGS)
+TEST_NODE_MESSAGE_CACHE_RUN=test_run_$(TEST_NODE_MESSAGE_CACHE_NAME)
+$(TEST_NODE_MESSAGE_CACHE_RUN): $(TEST_NODE_MESSAGE_CACHE_EXECUTABLE)
+	./$^
+TEST_RUNS+=$(TEST_NODE_MESSAGE_CACHE_RUN)
+
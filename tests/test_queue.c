@@ -101,6 +101,28 @@ int main(int argc, char **argv)
         core_queue_destroy(&queue);
     }
 
+    {
+        /* peek at the first element */
+
+        struct core_queue queue;
+        int i;
+
+        core_queue_init(&queue, sizeof(int));
+
+        TEST_POINTER_EQUALS(core_queue_peek(&queue), NULL);
+
+        for (i = 0; i < 3; i++) {
+            TEST_INT_EQUALS(core_queue_enqueue(&queue, &i), 1);
+        }
+
+        TEST_INT_EQUALS(*(int *)core_queue_peek(&queue), 0);
+        TEST_INT_EQUALS(core_queue_dequeue(&queue, &i), 1);
+        TEST_INT_EQUALS(*(int *)core_queue_peek(&queue), 1);
+        TEST_INT_EQUALS(core_queue_size(&queue), 2);
+
+        core_queue_destroy(&queue);
+    }
+
     {
         /* stress test the code by inserting one element,
            and then removing. */
@@ -0,0 +1,189 @@
+#include <genomics/formats/record_splitter.h>
+
+#include <core/file_storage/input/buffered_reader.h>
+#include <core/structures/vector.h>
+
+#include "test.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+#define RECORD_COUNT 1000
+#define MAXIMUM_LINE_LENGTH 128
+
+static uint64_t write_file(const char *file, int fastq, uint64_t *record_offsets);
+static int is_record_start(uint64_t offset, uint64_t *record_offsets);
+
+int main(int argc, char **argv)
+{
+    BEGIN_TESTS();
+
+    struct core_vector start_offsets;
+    struct core_vector end_offsets;
+    struct core_buffered_reader reader;
+    uint64_t record_offsets[RECORD_COUNT];
+    char file[] = "/tmp/test_record_splitter.fastq";
+    char other_file[] = "/tmp/test_record_splitter.fasta";
+    char buffer[MAXIMUM_LINE_LENGTH];
+    const char *line;
+    uint64_t file_size;
+    uint64_t start;
+    uint64_t end;
+    int size;
+    int i;
+    int bad_starts;
+
+    /*
+     * FASTQ: the quality lines start with '@' too.
+     */
+    file_size = write_file(file, 1, record_offsets);
+
+    core_vector_init(&start_offsets, sizeof(uint64_t));
+    core_vector_init(&end_offsets, sizeof(uint64_t));
+
+    biosal_record_splitter_split(file, 7, &start_offsets, &end_offsets);
+
+    size = core_vector_size(&start_offsets);
+    TEST_INT_EQUALS(size, 7);
+    TEST_INT_EQUALS(core_vector_size(&end_offsets), size);
+
+    bad_starts = 0;
+
+    for (i = 0; i < size; i++) {
+        start = core_vector_at_as_uint64_t(&start_offsets, i);
+        end = core_vector_at_as_uint64_t(&end_offsets, i);
+
+        if (!is_record_start(start, record_offsets)) {
+            ++bad_starts;
+        }
+
+        if (i > 0) {
+            TEST_UINT64_T_EQUALS(start, core_vector_at_as_uint64_t(&end_offsets, i - 1) + 1);
+        }
+
+        TEST_INT_IS_LOWER_THAN(start, end);
+    }
+
+    TEST_INT_EQUALS(bad_starts, 0);
+    TEST_UINT64_T_EQUALS(core_vector_at_as_uint64_t(&start_offsets, 0), 0);
+    TEST_UINT64_T_EQUALS(core_vector_at_as_uint64_t(&end_offsets, size - 1), file_size - 1);
+
+    /*
+     * More ranges than records: empty ranges are dropped.
+     */
+    core_vector_clear(&start_offsets);
+    core_vector_clear(&end_offsets);
+
+    biosal_record_splitter_split(file, RECORD_COUNT * 4, &start_offsets, &end_offsets);
+
+    size = core_vector_size(&start_offsets);
+    TEST_INT_IS_LOWER_THAN_OR_EQUAL(size, RECORD_COUNT);
+    TEST_UINT64_T_EQUALS(core_vector_at_as_uint64_t(&end_offsets, size - 1), file_size - 1);
+
+    bad_starts = 0;
+
+    for (i = 0; i < size; i++) {
+        if (!is_record_start(core_vector_at_as_uint64_t(&start_offsets, i), record_offsets)) {
+            ++bad_starts;
+        }
+    }
+
+    TEST_INT_EQUALS(bad_starts, 0);
+
+    /*
+     * Line views and copies give the same lines.
+     */
+    core_buffered_reader_init(&reader, file, record_offsets[10]);
+
+    if (core_buffered_reader_has_line_views(&reader)) {
+        TEST_INT_EQUALS(core_buffered_reader_read_line_view(&reader, &line), 5);
+        TEST_INT_EQUALS(memcmp(line, "@r10\n", 5), 0);
+    } else {
+        core_buffered_reader_read_line(&reader, buffer, MAXIMUM_LINE_LENGTH);
+        TEST_INT_EQUALS(strcmp(buffer, "@r10\n"), 0);
+    }
+
+    TEST_INT_EQUALS(core_buffered_reader_read_line(&reader, buffer, MAXIMUM_LINE_LENGTH), 33);
+    TEST_INT_EQUALS(buffer[32], '\n');
+    TEST_UINT64_T_EQUALS(core_buffered_reader_get_offset(&reader),
+                    record_offsets[10] + 5 + 33);
+
+    core_buffered_reader_destroy(&reader);
+
+    /*
+     * FASTA
+     */
+    core_vector_clear(&start_offsets);
+    core_vector_clear(&end_offsets);
+
+    file_size = write_file(other_file, 0, record_offsets);
+
+    biosal_record_splitter_split(other_file, 5, &start_offsets, &end_offsets);
+
+    size = core_vector_size(&start_offsets);
+    TEST_INT_EQUALS(size, 5);
+
+    bad_starts = 0;
+
+    for (i = 0; i < size; i++) {
+        if (!is_record_start(core_vector_at_as_uint64_t(&start_offsets, i), record_offsets)) {
+            ++bad_starts;
+        }
+    }
+
+    TEST_INT_EQUALS(bad_starts, 0);
+    TEST_UINT64_T_EQUALS(core_vector_at_as_uint64_t(&end_offsets, size - 1), file_size - 1);
+
+    core_vector_destroy(&start_offsets);
+    core_vector_destroy(&end_offsets);
+
+    remove(file);
+    remove(other_file);
+
+    END_TESTS();
+
+    return 0;
+}
+
+static uint64_t write_file(const char *file, int fastq, uint64_t *record_offsets)
+{
+    FILE *stream;
+    uint64_t offset;
+    int i;
+
+    stream = fopen(file, "w");
+    offset = 0;
+
+    for (i = 0; i < RECORD_COUNT; i++) {
+        record_offsets[i] = offset;
+
+        if (fastq) {
+            offset += fprintf(stream, "@r%d\n", i);
+            offset += fprintf(stream, "ACGTACGTACGTACGTACGTACGTACGTACGT\n");
+            offset += fprintf(stream, "+\n");
+            offset += fprintf(stream, "@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@\n");
+        } else {
+            offset += fprintf(stream, ">r%d\n", i);
+            offset += fprintf(stream, "ACGTACGTACGTACGTACGTACGTACGTACGT\n");
+            offset += fprintf(stream, "GGGGCCCCAAAATTTT\n");
+        }
+    }
+
+    fclose(stream);
+
+    return offset;
+}
+
+static int is_record_start(uint64_t offset, uint64_t *record_offsets)
+{
+    int i;
+
+    for (i = 0; i < RECORD_COUNT; i++) {
+        if (record_offsets[i] == offset) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,13 @@
+TEST_RECORD_SPLITTER_NAME=record_splitter
+TEST_RECORD_SPLITTER_EXECUTABLE=tests/test_$(TEST_RECORD_SPLITTER_NAME)
+TEST_RECORD_SPLITTER_OBJECTS=tests/test_$(TEST_RECORD_SPLITTER_NAME).o
+TEST_EXECUTABLES+=$(TEST_RECORD_SPLITTER_EXECUTABLE)
+TEST_OBJECTS+=$(TEST_RECORD_SPLITTER_OBJECTS)
+$(TEST_RECORD_SPLITTER_EXECUTABLE): $(LIBRARY_OBJECTS) $(TEST_RECORD_SPLITTER_OBJECTS) $(TEST_LIBRARY_OBJECTS)
+	$(Q)$(ECHO) "  LD $@"
+	$(Q)$(CC) $(CFLAGS) $^ -o $@ $(LDFLAGS) $(CONFIG_LDFLAGS)
+TEST_RECORD_SPLITTER_RUN=test_run_$(TEST_RECORD_SPLITTER_NAME)
+$(TEST_RECORD_SPLITTER_RUN): $(TEST_RECORD_SPLITTER_EXECUTABLE)
+	./$^
+TEST_RUNS+=$(TEST_RECORD_SPLITTER_RUN)
+
@@ -0,0 +1,254 @@
+
+#include "test.h"
+
+#include <genomics/storage/sharded_kmer_table.h>
+#include <genomics/storage/kmer_table.h>
+
+#include <core/system/thread.h>
+#include <core/system/atomic.h>
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#define KEY_SIZE 8
+#define SHARDS 4
+#define KEYS 10000
+#define WRITES 200000
+
+/*
+ * Both halves of a value are always equal after a write.
+ */
+struct test_value {
+    uint64_t first;
+    uint64_t second;
+};
+
+struct test_reader {
+    struct biosal_kmer_table_shard *shard;
+    uint64_t key;
+    int reads;
+    int errors;
+    int done;
+};
+
+/*
+ * The owner of a shard changes a value and then replies, like a graph
+ * store handling ACTION_MARK_VERTEX_AS_VISITED.
+ */
+struct test_owner {
+    struct biosal_kmer_table_shard *shard;
+    uint64_t key;
+    int request;
+    int reply;
+};
+
+static void *test_reply_after_write(void *argument)
+{
+    struct test_owner *owner;
+    struct test_value *bucket;
+    int request;
+
+    owner = argument;
+
+    for (request = 1; request <= WRITES / 10; ++request) {
+
+        while (core_atomic_read_int(&owner->request) != request) {
+            core_atomic_spin();
+        }
+
+        biosal_kmer_table_shard_begin_write(owner->shard);
+
+        bucket = biosal_kmer_table_get(biosal_kmer_table_shard_table(owner->shard), &owner->key);
+        bucket->first = request;
+        bucket->second = request;
+
+        biosal_kmer_table_shard_end_write(owner->shard);
+
+        core_atomic_compare_and_swap_int(&owner->reply, request - 1, request);
+    }
+
+    return NULL;
+}
+
+static void *test_read_shard(void *argument)
+{
+    struct test_reader *reader;
+    struct test_value value;
+
+    reader = argument;
+
+    while (!*(volatile int *)&reader->done) {
+
+        if (biosal_kmer_table_shard_read(reader->shard, &reader->key, &value)) {
+            if (value.first != value.second) {
+                ++reader->errors;
+            }
+            ++reader->reads;
+        }
+    }
+
+    return NULL;
+}
+
+int main(int argc, char **argv)
+{
+    struct biosal_sharded_kmer_table table;
+    struct biosal_kmer_table_shard *shard;
+    struct biosal_kmer_table_shard *shards[SHARDS];
+    struct test_value *bucket;
+    struct test_value value;
+    struct test_reader reader;
+    struct test_owner owner_thread;
+    struct core_thread thread;
+    uint64_t key;
+    int owner;
+    int inserted;
+    int errors;
+    int i;
+
+    BEGIN_TESTS();
+
+    biosal_sharded_kmer_table_init(&table, KEY_SIZE, sizeof(struct test_value));
+
+    TEST_INT_EQUALS(biosal_sharded_kmer_table_key_size(&table), KEY_SIZE);
+    TEST_INT_EQUALS(biosal_sharded_kmer_table_shard_count(&table), 0);
+
+    for (i = 0; i < SHARDS; ++i) {
+        shards[i] = biosal_sharded_kmer_table_add_shard(&table, 1000 + i);
+
+        TEST_POINTER_NOT_EQUALS(shards[i], NULL);
+        TEST_INT_EQUALS(biosal_kmer_table_shard_owner(shards[i]), 1000 + i);
+    }
+
+    TEST_INT_EQUALS(biosal_sharded_kmer_table_shard_count(&table), SHARDS);
+    TEST_POINTER_EQUALS(biosal_sharded_kmer_table_get_shard(&table, 1002), shards[2]);
+    TEST_POINTER_EQUALS(biosal_sharded_kmer_table_get_shard(&table, 42), NULL);
+
+    /*
+     * Each owner writes its keys in its shard.
+     */
+    for (key = 0; key < KEYS; ++key) {
+        owner = key % SHARDS;
+        shard = shards[owner];
+
+        biosal_kmer_table_shard_begin_write(shard);
+
+        bucket = biosal_kmer_table_add(biosal_kmer_table_shard_table(shard), &key, &inserted);
+        bucket->first = key * 3;
+        bucket->second = key * 3;
+
+        biosal_kmer_table_shard_end_write(shard);
+    }
+
+    TEST_UINT64_T_EQUALS(biosal_sharded_kmer_table_size(&table), KEYS);
+
+    /*
+     * Reads are rejected until the owner stops adding keys.
+     */
+    key = 0;
+    TEST_INT_EQUALS(biosal_kmer_table_shard_is_frozen(shards[0]), 0);
+    TEST_INT_EQUALS(biosal_sharded_kmer_table_read(&table, 1000, &key, &value), 0);
+
+    for (i = 0; i < SHARDS; ++i) {
+        biosal_kmer_table_shard_freeze(shards[i]);
+    }
+
+    TEST_INT_EQUALS(biosal_kmer_table_shard_is_frozen(shards[0]), 1);
+    TEST_INT_EQUALS(biosal_sharded_kmer_table_read(&table, 1000, &key, &value), 1);
+
+    errors = 0;
+
+    for (key = 0; key < KEYS; ++key) {
+        owner = 1000 + key % SHARDS;
+
+        if (!biosal_sharded_kmer_table_read(&table, owner, &key, &value)
+                        || value.first != key * 3) {
+            ++errors;
+        }
+
+        /*
+         * The key is not in the other shards.
+         */
+        if (biosal_sharded_kmer_table_read(&table, 1000 + (key + 1) % SHARDS, &key, &value)) {
+            ++errors;
+        }
+    }
+
+    TEST_INT_EQUALS(errors, 0);
+
+    key = KEYS;
+    TEST_INT_EQUALS(biosal_sharded_kmer_table_read(&table, 1000, &key, &value), 0);
+    TEST_INT_EQUALS(biosal_sharded_kmer_table_read(&table, 42, &key, &value), 0);
+
+    /*
+     * A reader on another thread never sees a write in progress.
+     */
+    reader.shard = shards[1];
+    reader.key = 1;
+    reader.reads = 0;
+    reader.errors = 0;
+    reader.done = 0;
+
+    core_thread_init(&thread, test_read_shard, &reader);
+    core_thread_start(&thread);
+
+    key = 1;
+
+    for (i = 0; i < WRITES; ++i) {
+        biosal_kmer_table_shard_begin_write(shards[1]);
+
+        bucket = biosal_kmer_table_get(biosal_kmer_table_shard_table(shards[1]), &key);
+        bucket->first = i;
+        bucket->second = i;
+
+        biosal_kmer_table_shard_end_write(shards[1]);
+    }
+
+    *(volatile int *)&reader.done = 1;
+
+    core_thread_join(&thread);
+    core_thread_destroy(&thread);
+
+    TEST_INT_EQUALS(reader.errors, 0);
+    TEST_INT_IS_GREATER_THAN(reader.reads, 0);
+
+    /*
+     * A direct read made after the reply to a change sees the change,
+     * even though it does not go through the mailbox of the owner.
+     */
+    owner_thread.shard = shards[2];
+    owner_thread.key = 2;
+    owner_thread.request = 0;
+    owner_thread.reply = 0;
+
+    core_thread_init(&thread, test_reply_after_write, &owner_thread);
+    core_thread_start(&thread);
+
+    errors = 0;
+    key = 2;
+
+    for (i = 1; i <= WRITES / 10; ++i) {
+        core_atomic_compare_and_swap_int(&owner_thread.request, i - 1, i);
+
+        while (core_atomic_read_int(&owner_thread.reply) != i) {
+            core_atomic_spin();
+        }
+
+        if (!biosal_kmer_table_shard_read(shards[2], &key, &value)
+                        || value.first != (uint64_t)i) {
+            ++errors;
+        }
+    }
+
+    core_thread_join(&thread);
+    core_thread_destroy(&thread);
+
+    TEST_INT_EQUALS(errors, 0);
+
+    biosal_sharded_kmer_table_destroy(&table);
+
+    END_TESTS();
+
+    return 0;
+}
@@ -0,0 +1,363 @@
+
+#include "test.h"
+
+#include <engine/thorium/transport/shared_memory/shared_memory_transport.h>
+#include <engine/thorium/transport/transport.h>
+
+#include <engine/thorium/worker_buffer.h>
+#include <engine/thorium/message.h>
+
+#include <core/system/memory.h>
+#include <core/system/memory_pool.h>
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define TEST_ACTION 0x00007e57
+
+#define LARGE_MESSAGE_SIZE (THORIUM_SHARED_MEMORY_SLAB_BLOCK_SIZE / 2)
+
+/*
+ * Any number of tries is enough when the process sends to itself.
+ */
+#define MAXIMUM_TRIES 100000000
+
+static void clear_environment(void)
+{
+    unsetenv("THORIUM_RANK");
+    unsetenv("THORIUM_SIZE");
+    unsetenv("OMPI_COMM_WORLD_RANK");
+    unsetenv("OMPI_COMM_WORLD_SIZE");
+    unsetenv("PMI_RANK");
+    unsetenv("PMI_SIZE");
+}
+
+static void init_transport(struct thorium_transport *transport, char *key)
+{
+    char *arguments[] = { "test_shared_memory_transport", "-shared-memory-key", key, NULL };
+    char **argv;
+    int argc;
+
+    argc = 3;
+    argv = arguments;
+
+    transport->node = NULL;
+    transport->inbound_message_memory_pool = NULL;
+    transport->outbound_message_memory_pool = NULL;
+    transport->transport_interface = &thorium_shared_memory_transport_implementation;
+    transport->concrete_transport = core_memory_allocate(thorium_shared_memory_transport_implementation.size, -1);
+
+    thorium_shared_memory_transport_implementation.init(transport, &argc, &argv);
+}
+
+static void destroy_transport(struct thorium_transport *transport)
+{
+    thorium_shared_memory_transport_implementation.destroy(transport);
+    core_memory_free(transport->concrete_transport, -1);
+    transport->concrete_transport = NULL;
+}
+
+static int get_pending_message_count(struct thorium_transport *transport)
+{
+    struct thorium_shared_memory_transport *concrete_transport;
+
+    concrete_transport = transport->concrete_transport;
+
+    return concrete_transport->pending_message_count;
+}
+
+/*
+ * The worker of the message is the seed of its content.
+ */
+static void send_message(struct thorium_transport *transport, int destination, int count, int seed)
+{
+    struct thorium_message message;
+    char *buffer;
+    int i;
+
+    buffer = NULL;
+
+    if (count > 0)
+        buffer = core_memory_allocate(count, -1);
+
+    for (i = 0; i < count; ++i)
+        buffer[i] = (char)(seed * 31 + i);
+
+    thorium_message_init(&message, TEST_ACTION, count, buffer);
+    thorium_message_set_destination_node(&message, destination);
+    thorium_message_set_worker(&message, seed);
+
+    thorium_shared_memory_transport_implementation.send(transport, &message);
+}
+
+/*
+ * \return 1 if the next message has the expected source and content
+ */
+static int receive_message(struct thorium_transport *transport, int source, int count, int seed)
+{
+    struct thorium_message message;
+    char *buffer;
+    int tries;
+    int valid;
+    int i;
+
+    tries = 0;
+
+    while (!thorium_shared_memory_transport_implementation.receive(transport, &message)) {
+        if (++tries == MAXIMUM_TRIES)
+            return 0;
+    }
+
+    buffer = thorium_message_buffer(&message);
+    valid = thorium_message_count(&message) == count
+            && thorium_message_source_node(&message) == source
+            && thorium_message_destination_node(&message) == transport->rank
+            && (count > 0 || buffer == NULL);
+
+    for (i = 0; valid && i < count; ++i) {
+        if (buffer[i] != (char)(seed * 31 + i))
+            valid = 0;
+    }
+
+    if (buffer != NULL)
+        core_memory_pool_free(NULL, buffer);
+
+    return valid;
+}
+
+/*
+ * \return the number of buffers given back to their workers
+ */
+static int free_completed_buffers(struct thorium_transport *transport)
+{
+    struct thorium_worker_buffer worker_buffer;
+    void *buffer;
+    int count;
+
+    count = 0;
+
+    while (thorium_shared_memory_transport_implementation.test(transport, &worker_buffer)) {
+        buffer = thorium_worker_buffer_get_buffer(&worker_buffer);
+
+        if (buffer != NULL)
+            core_memory_free(buffer, -1);
+
+        ++count;
+    }
+
+    return count;
+}
+
+/*
+ * Rank 1 of 2 (see main). It finds its rank in the PMI_* variables.
+ *
+ * \return 0 on success
+ */
+static int run_child(char *key)
+{
+    struct thorium_transport transport;
+    int valid;
+    int completed;
+
+    clear_environment();
+    setenv("PMI_RANK", "1", 1);
+    setenv("PMI_SIZE", "2", 1);
+
+    init_transport(&transport, key);
+
+    valid = transport.rank == 1 && transport.size == 2;
+
+    send_message(&transport, 0, LARGE_MESSAGE_SIZE, 1);
+    send_message(&transport, 0, 100, 2);
+
+    valid = valid && receive_message(&transport, 0, 100, 3);
+
+    completed = 0;
+
+    while (completed < 2)
+        completed += free_completed_buffers(&transport);
+
+    destroy_transport(&transport);
+
+    return valid ? 0 : 1;
+}
+
+int main(int argc, char **argv)
+{
+    struct thorium_transport transport;
+    char key[64];
+    int count;
+    int correct;
+    int completed;
+    int pending;
+    int status;
+    int i;
+    pid_t child;
+
+    BEGIN_TESTS();
+
+    snprintf(key, sizeof(key), "test-%d", (int)getpid());
+
+    /*
+     * THORIUM_RANK and THORIUM_SIZE come before the variables of
+     * Open-MPI and Hydra.
+     */
+    clear_environment();
+    setenv("THORIUM_RANK", "0", 1);
+    setenv("THORIUM_SIZE", "1", 1);
+    setenv("OMPI_COMM_WORLD_RANK", "3", 1);
+    setenv("OMPI_COMM_WORLD_SIZE", "4", 1);
+
+    init_transport(&transport, key);
+
+    TEST_INT_EQUALS(transport.rank, 0);
+    TEST_INT_EQUALS(transport.size, 1);
+
+    /*
+     * A message without a buffer.
+     */
+    send_message(&transport, 0, 0, 0);
+    TEST_INT_EQUALS(receive_message(&transport, 0, 0, 0), 1);
+    TEST_INT_EQUALS(free_completed_buffers(&transport), 1);
+
+    /*
+     * Inline messages of many sizes wrap around the ring many times
+     * (THORIUM_SHARED_MEMORY_RING_SIZE is 256 KiB).
+     */
+    correct = 0;
+    completed = 0;
+
+    for (i = 0; i < 3000; i += 3) {
+        send_message(&transport, 0, (i * 997) % 6000 + 1, i);
+        send_message(&transport, 0, ((i + 1) * 997) % 6000 + 1, i + 1);
+        send_message(&transport, 0, ((i + 2) * 997) % 6000 + 1, i + 2);
+
+        correct += receive_message(&transport, 0, (i * 997) % 6000 + 1, i);
+        correct += receive_message(&transport, 0, ((i + 1) * 997) % 6000 + 1, i + 1);
+        correct += receive_message(&transport, 0, ((i + 2) * 997) % 6000 + 1, i + 2);
+
+        completed += free_completed_buffers(&transport);
+    }
+
+    TEST_INT_EQUALS(correct, 3000);
+    TEST_INT_EQUALS(completed, 3000);
+
+    /*
+     * When the ring is full, the messages wait in order.
+     */
+    count = 100;
+
+    for (i = 0; i < count; ++i)
+        send_message(&transport, 0, 4000, i);
+
+    pending = get_pending_message_count(&transport);
+    TEST_INT_IS_GREATER_THAN(pending, 0);
+
+    correct = 0;
+
+    for (i = 0; i < count; ++i)
+        correct += receive_message(&transport, 0, 4000, i);
+
+    TEST_INT_EQUALS(correct, count);
+    pending = get_pending_message_count(&transport);
+    TEST_INT_EQUALS(pending, 0);
+    TEST_INT_EQUALS(free_completed_buffers(&transport), count);
+
+    /*
+     * Large messages are handed off in the slab: they are done as soon
+     * as they are sent, even if nothing is received.
+     */
+    for (i = 0; i < THORIUM_SHARED_MEMORY_SLAB_BLOCKS; ++i)
+        send_message(&transport, 0, LARGE_MESSAGE_SIZE, i);
+
+    pending = get_pending_message_count(&transport);
+    TEST_INT_EQUALS(pending, 0);
+    TEST_INT_EQUALS(free_completed_buffers(&transport), THORIUM_SHARED_MEMORY_SLAB_BLOCKS);
+
+    /*
+     * The slab is full, so the next large message is streamed in
+     * fragments, and it does not fit in the ring.
+     */
+    send_message(&transport, 0, LARGE_MESSAGE_SIZE, THORIUM_SHARED_MEMORY_SLAB_BLOCKS);
+
+    pending = get_pending_message_count(&transport);
+    TEST_INT_EQUALS(pending, 1);
+    TEST_INT_EQUALS(free_completed_buffers(&transport), 0);
+
+    correct = 0;
+
+    for (i = 0; i < THORIUM_SHARED_MEMORY_SLAB_BLOCKS + 1; ++i)
+        correct += receive_message(&transport, 0, LARGE_MESSAGE_SIZE, i);
+
+    TEST_INT_EQUALS(correct, THORIUM_SHARED_MEMORY_SLAB_BLOCKS + 1);
+    pending = get_pending_message_count(&transport);
+    TEST_INT_EQUALS(pending, 0);
+    TEST_INT_EQUALS(free_completed_buffers(&transport), 1);
+
+    /*
+     * The receiver gave the blocks back.
+     */
+    for (i = 0; i < THORIUM_SHARED_MEMORY_SLAB_BLOCKS; ++i)
+        send_message(&transport, 0, LARGE_MESSAGE_SIZE, i);
+
+    pending = get_pending_message_count(&transport);
+    TEST_INT_EQUALS(pending, 0);
+    TEST_INT_EQUALS(free_completed_buffers(&transport), THORIUM_SHARED_MEMORY_SLAB_BLOCKS);
+
+    correct = 0;
+
+    for (i = 0; i < THORIUM_SHARED_MEMORY_SLAB_BLOCKS; ++i)
+        correct += receive_message(&transport, 0, LARGE_MESSAGE_SIZE, i);
+
+    TEST_INT_EQUALS(correct, THORIUM_SHARED_MEMORY_SLAB_BLOCKS);
+
+    destroy_transport(&transport);
+
+    /*
+     * Two processes: rank 0 finds its rank in the Open-MPI variables
+     * and rank 1 in the Hydra variables.
+     */
+    snprintf(key, sizeof(key), "test-%d-2", (int)getpid());
+
+    child = fork();
+
+    if (child == 0)
+        _exit(run_child(key));
+
+    TEST_INT_IS_GREATER_THAN(child, 0);
+
+    if (child > 0) {
+        clear_environment();
+        setenv("OMPI_COMM_WORLD_RANK", "0", 1);
+        setenv("OMPI_COMM_WORLD_SIZE", "2", 1);
+
+        init_transport(&transport, key);
+
+        TEST_INT_EQUALS(transport.rank, 0);
+        TEST_INT_EQUALS(transport.size, 2);
+
+        send_message(&transport, 1, 100, 3);
+
+        TEST_INT_EQUALS(receive_message(&transport, 1, LARGE_MESSAGE_SIZE, 1), 1);
+        TEST_INT_EQUALS(receive_message(&transport, 1, 100, 2), 1);
+        TEST_INT_EQUALS(free_completed_buffers(&transport), 1);
+
+        status = -1;
+        waitpid(child, &status, 0);
+
+        TEST_INT_EQUALS(WIFEXITED(status), 1);
+        TEST_INT_EQUALS(WEXITSTATUS(status), 0);
+
+        destroy_transport(&transport);
+    }
+
+    clear_environment();
+
+    END_TESTS();
+
+    return 0;
+}
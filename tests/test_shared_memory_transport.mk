@@ -0,0 +1,13 @@
+TEST_SHARED_MEMORY_TRANSPORT_NAME=shared_memory_transport
+TEST_SHARED_MEMORY_TRANSPORT_EXECUTABLE=tests/test_$(TEST_SHARED_MEMORY_TRANSPORT_NAME)
+TEST_SHARED_MEMORY_TRANSPORT_OBJECTS=tests/test_$(TEST_SHARED_MEMORY_TRANSPORT_NAME).o
+TEST_EXECUTABLES+=$(TEST_SHARED_MEMORY_TRANSPORT_EXECUTABLE)
+TEST_OBJECTS+=$(TEST_SHARED_MEMORY_TRANSPORT_OBJECTS)
+$(TEST_SHARED_MEMORY_TRANSPORT_EXECUTABLE): $(LIBRARY_OBJECTS) $(TEST_SHARED_MEMORY_TRANSPORT_OBJECTS) $(TEST_LIBRARY_OBJECTS)
+	$(Q)$(ECHO) "  LD $@"
+	$(Q)$(CC) $(CFLAGS) $^ -o $@ $(LDFLAGS) $(CONFIG_LDFLAGS)
+TEST_SHARED_MEMORY_TRANSPORT_RUN=test_run_$(TEST_SHARED_MEMORY_TRANSPORT_NAME)
+$(TEST_SHARED_MEMORY_TRANSPORT_RUN): $(TEST_SHARED_MEMORY_TRANSPORT_EXECUTABLE)
+	./$^
+TEST_RUNS+=$(TEST_SHARED_MEMORY_TRANSPORT_RUN)
+
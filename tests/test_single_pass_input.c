@@ -0,0 +1,242 @@
+
+#include <genomics/formats/record_splitter.h>
+#include <genomics/formats/input_proxy.h>
+#include <genomics/formats/input_format.h>
+
+#include <core/structures/vector.h>
+#include <core/system/memory.h>
+
+#include "test.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+#define RECORD_COUNT 3000
+#define RANGE_COUNT 7
+#define STORE_COUNT 3
+#define BLOCK_SIZE 64
+
+#define MEMORY_TEST 0x51f0c2a7
+
+/*
+ * The sequences read by a pass: their number, their total length and
+ * a hash that depends on their order.
+ */
+struct test_input_summary {
+    uint64_t entries;
+    uint64_t bases;
+    uint64_t hash;
+};
+
+static void write_file(const char *file, int fastq, unsigned int seed);
+static void read_range(char *file, uint64_t start, uint64_t end, char *sequence,
+                struct test_input_summary *summary, uint64_t *store_entries);
+static void test_input_summary_init(struct test_input_summary *self);
+
+/*
+ * With -single-pass-input, the input controller splits each file in
+ * ranges with biosal_record_splitter_split, and the input streams read
+ * each range with a biosal_input_proxy and append blocks of sequences
+ * to the stores in round-robin order. The two-pass input reads each
+ * file from the start to the end.
+ *
+ * Both must see the same sequences, in the same order when the ranges
+ * are read in order.
+ */
+int main(int argc, char **argv)
+{
+    BEGIN_TESTS();
+
+    struct core_vector start_offsets;
+    struct core_vector end_offsets;
+    struct test_input_summary two_pass;
+    struct test_input_summary single_pass;
+    char fastq_file[] = "/tmp/test_single_pass_input.fastq";
+    char fasta_file[] = "/tmp/test_single_pass_input.fasta";
+    char *files[2];
+    char *sequence;
+    uint64_t store_entries[STORE_COUNT];
+    uint64_t range_entries[RANGE_COUNT];
+    uint64_t first_entries[RANGE_COUNT];
+    uint64_t total_entries;
+    uint64_t entries;
+    int size;
+    int i;
+    int j;
+
+    sequence = core_memory_allocate(BIOSAL_INPUT_MAXIMUM_SEQUENCE_LENGTH, MEMORY_TEST);
+
+    write_file(fastq_file, 1, 1);
+    write_file(fasta_file, 0, 2);
+
+    files[0] = fastq_file;
+    files[1] = fasta_file;
+
+    core_vector_init(&start_offsets, sizeof(uint64_t));
+    core_vector_init(&end_offsets, sizeof(uint64_t));
+
+    for (j = 0; j < 2; ++j) {
+
+        /*
+         * Two-pass input: one stream reads the whole file.
+         */
+        test_input_summary_init(&two_pass);
+        read_range(files[j], 0, UINT64_MAX, sequence, &two_pass, NULL);
+
+        TEST_UINT64_T_EQUALS(two_pass.entries, RECORD_COUNT);
+
+        /*
+         * Single-pass input: the ranges are read one after the other.
+         */
+        core_vector_clear(&start_offsets);
+        core_vector_clear(&end_offsets);
+
+        biosal_record_splitter_split(files[j], RANGE_COUNT, &start_offsets, &end_offsets);
+
+        size = core_vector_size(&start_offsets);
+        TEST_INT_EQUALS(size, RANGE_COUNT);
+
+        test_input_summary_init(&single_pass);
+
+        for (i = 0; i < STORE_COUNT; ++i) {
+            store_entries[i] = 0;
+        }
+
+        for (i = 0; i < size; ++i) {
+            entries = single_pass.entries;
+
+            read_range(files[j], core_vector_at_as_uint64_t(&start_offsets, i),
+                            core_vector_at_as_uint64_t(&end_offsets, i), sequence,
+                            &single_pass, store_entries);
+
+            range_entries[i] = single_pass.entries - entries;
+            TEST_INT_IS_GREATER_THAN(range_entries[i], 0);
+        }
+
+        TEST_UINT64_T_EQUALS(single_pass.entries, two_pass.entries);
+        TEST_UINT64_T_EQUALS(single_pass.bases, two_pass.bases);
+        TEST_UINT64_T_EQUALS(single_pass.hash, two_pass.hash);
+
+        /*
+         * The stores get all the sequences, and the round-robin keeps
+         * them balanced.
+         */
+        total_entries = 0;
+
+        for (i = 0; i < STORE_COUNT; ++i) {
+            total_entries += store_entries[i];
+            TEST_INT_IS_GREATER_THAN(store_entries[i], 0);
+        }
+
+        TEST_UINT64_T_EQUALS(total_entries, two_pass.entries);
+
+        /*
+         * The global index of the first sequence of each range is the
+         * prefix sum of the range counts.
+         */
+        first_entries[0] = 0;
+
+        for (i = 1; i < size; ++i) {
+            first_entries[i] = first_entries[i - 1] + range_entries[i - 1];
+        }
+
+        TEST_UINT64_T_EQUALS(first_entries[size - 1] + range_entries[size - 1],
+                        two_pass.entries);
+    }
+
+    core_vector_destroy(&start_offsets);
+    core_vector_destroy(&end_offsets);
+
+    core_memory_free(sequence, MEMORY_TEST);
+
+    remove(fastq_file);
+    remove(fasta_file);
+
+    END_TESTS();
+
+    return 0;
+}
+
+/*
+ * Reads of random lengths (40 to 139) with a fixed seed. In the FASTQ
+ * file, some quality lines start with '@', like headers.
+ */
+static void write_file(const char *file, int fastq, unsigned int seed)
+{
+    FILE *stream;
+    const char *bases = "ACGT";
+    int length;
+    int i;
+    int k;
+
+    stream = fopen(file, "w");
+
+    for (i = 0; i < RECORD_COUNT; i++) {
+        seed = seed * 1103515245 + 12345;
+        length = 40 + (seed >> 16) % 100;
+
+        fprintf(stream, "%cread-%d\n", fastq ? '@' : '>', i);
+
+        for (k = 0; k < length; ++k) {
+            seed = seed * 1103515245 + 12345;
+            fputc(bases[(seed >> 16) % 4], stream);
+        }
+
+        fputc('\n', stream);
+
+        if (fastq) {
+            fprintf(stream, "+\n");
+
+            for (k = 0; k < length; ++k) {
+                fputc(i % 3 == 0 ? '@' : 'I', stream);
+            }
+
+            fputc('\n', stream);
+        }
+    }
+
+    fclose(stream);
+}
+
+/*
+ * Read the sequences of a range like an input stream does. Blocks of
+ * BLOCK_SIZE sequences go to the stores in round-robin order.
+ */
+static void read_range(char *file, uint64_t start, uint64_t end, char *sequence,
+                struct test_input_summary *summary, uint64_t *store_entries)
+{
+    struct biosal_input_proxy proxy;
+    uint64_t range_entries;
+    char *base;
+
+    biosal_input_proxy_init(&proxy, file, start, end);
+
+    range_entries = 0;
+
+    while (biosal_input_proxy_get_sequence(&proxy, sequence)) {
+
+        for (base = sequence; *base != '\0'; ++base) {
+            summary->hash = (summary->hash ^ (uint8_t)*base) * 1099511628211ULL;
+        }
+
+        summary->hash = (summary->hash ^ '\n') * 1099511628211ULL;
+        summary->bases += base - sequence;
+        ++summary->entries;
+
+        if (store_entries != NULL) {
+            ++store_entries[(range_entries / BLOCK_SIZE) % STORE_COUNT];
+        }
+
+        ++range_entries;
+    }
+
+    biosal_input_proxy_destroy(&proxy);
+}
+
+static void test_input_summary_init(struct test_input_summary *self)
+{
+    self->entries = 0;
+    self->bases = 0;
+    self->hash = 14695981039346656037ULL;
+}
@@ -0,0 +1,13 @@
+TEST_SINGLE_PASS_INPUT_NAME=single_pass_input
+TEST_SINGLE_PASS_INPUT_EXECUTABLE=tests/test_$(TEST_SINGLE_PASS_INPUT_NAME)
+TEST_SINGLE_PASS_INPUT_OBJECTS=tests/test_$(TEST_SINGLE_PASS_INPUT_NAME).o
+TEST_EXECUTABLES+=$(TEST_SINGLE_PASS_INPUT_EXECUTABLE)
+TEST_OBJECTS+=$(TEST_SINGLE_PASS_INPUT_OBJECTS)
+$(TEST_SINGLE_PASS_INPUT_EXECUTABLE): $(LIBRARY_OBJECTS) $(TEST_SINGLE_PASS_INPUT_OBJECTS) $(TEST_LIBRARY_OBJECTS)
+	$(Q)$(ECHO) "  LD $@"
+	$(Q)$(CC) $(CFLAGS) $^ -o $@ $(LDFLAGS) $(CONFIG_LDFLAGS)
+TEST_SINGLE_PASS_INPUT_RUN=test_run_$(TEST_SINGLE_PASS_INPUT_NAME)
+$(TEST_SINGLE_PASS_INPUT_RUN): $(TEST_SINGLE_PASS_INPUT_EXECUTABLE)
+	./$^
+TEST_RUNS+=$(TEST_SINGLE_PASS_INPUT_RUN)
+
@@ -0,0 +1,154 @@
+#!/bin/bash
+
+# Check that -single-pass-input gives the same sequences and kmer counts
+# as the two-pass input (counting pass, then distribution) on a small
+# FASTQ sample.
+#
+# usage: tests/test_single_pass_input.sh
+#
+# MPIEXEC can be set to change how argonnite is started
+# (default: "mpiexec -n 2").
+
+argonnite=applications/argonnite_kmer_counter/argonnite
+mpiexec_command=${MPIEXEC:-"mpiexec -n 2"}
+kmer_length=21
+
+# Write @count reads of random lengths (40 to 139) with a fixed seed.
+function write_fastq_sample()
+{
+    local file
+    local count
+    local seed
+
+    file=$1
+    count=$2
+    seed=$3
+
+    awk -v count=$count -v seed=$seed '
+    BEGIN {
+        srand(seed);
+        split("A C G T", bases, " ");
+
+        for (i = 0; i < count; ++i) {
+            length_ = 40 + int(rand() * 100);
+            sequence = "";
+            quality = "";
+
+            for (j = 0; j < length_; ++j) {
+                sequence = sequence bases[1 + int(rand() * 4)];
+                quality = quality "I";
+            }
+
+            printf("@read-%d-%d\n%s\n+\n%s\n", seed, i, sequence, quality);
+        }
+    }' > $file
+}
+
+# Print the number of sequences and kmers seen by the kernels.
+function get_totals()
+{
+    local log
+
+    log=$1
+
+    grep "^kernel/.* generated .* kmers from .* entries" $log \
+        | awk '{ kmers += $3; entries += $6 } END { print entries " sequences, " kmers " kmers" }'
+}
+
+# \return 0 if the two files are the same
+function compare_files()
+{
+    local name
+    local expected
+    local actual
+
+    name=$1
+    expected=$2
+    actual=$3
+
+    if cmp -s $expected $actual
+    then
+        echo "$name: same"
+        return 0
+    fi
+
+    echo "$name: different"
+    diff $expected $actual | head -n 10
+    return 1
+}
+
+function main()
+{
+    local directory
+    local mode
+    local options
+    local failures
+    local result
+
+    if ! test -x $argonnite
+    then
+        echo "$argonnite is missing, run make"
+        echo "Test single-pass-input result: FAILED"
+        return 1
+    fi
+
+    directory=$(mktemp -d -t single-pass-input.XXXXXX)
+
+    # Several files of different sizes, so that there are several
+    # ranges and input streams.
+    write_fastq_sample $directory/sample-1.fastq 3000 1
+    write_fastq_sample $directory/sample-2.fastq 1000 2
+    write_fastq_sample $directory/sample-3.fastq 17 3
+
+    for mode in two-pass single-pass
+    do
+        if test $mode = "single-pass"
+        then
+            options="-single-pass-input"
+        else
+            options=""
+        fi
+
+        $mpiexec_command $argonnite $options -k $kmer_length -threads-per-node 2 \
+            -enable-actor-log biosal_input_controller \
+            -o $directory/$mode $directory/sample-*.fastq &> $directory/$mode.log
+    done
+
+    failures=0
+
+    # The input controller logs its ranges only in single-pass mode.
+    if ! grep -q "single-pass input: .* ranges" $directory/single-pass.log
+    then
+        echo "single-pass input was not used"
+        failures=$(($failures + 1))
+    fi
+
+    compare_files "sequences and kmers" \
+        <(get_totals $directory/two-pass.log) <(get_totals $directory/single-pass.log) \
+        || failures=$(($failures + 1))
+
+    echo "two-pass: $(get_totals $directory/two-pass.log)"
+    echo "single-pass: $(get_totals $directory/single-pass.log)"
+
+    # coverage_distribution.txt has the kmer counts.
+    for file in coverage_distribution.txt coverage_distribution.txt-canonical
+    do
+        compare_files $file $directory/two-pass/$file $directory/single-pass/$file \
+            || failures=$(($failures + 1))
+    done
+
+    if test $failures -eq 0 && test -s $directory/two-pass/coverage_distribution.txt
+    then
+        result="PASSED"
+        rm -rf $directory
+    else
+        result="FAILED"
+        echo "Logs and outputs are in $directory"
+    fi
+
+    echo "Test single-pass-input result: $result"
+
+    test $result = "PASSED"
+}
+
+main
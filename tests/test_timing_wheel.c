@@ -0,0 +1,105 @@
+
+#include <core/structures/ordered/timing_wheel.h>
+
+#include "test.h"
+
+#include <stdlib.h>
+
+#define TICK_DURATION 1024
+
+int main(int argc, char **argv)
+{
+    struct core_timing_wheel wheel;
+    uint64_t key;
+    uint64_t now;
+    uint64_t last_tick;
+    int value;
+    int i;
+    int count;
+    int popped;
+    int recycled;
+    int sum;
+    int expected_sum;
+
+    BEGIN_TESTS();
+
+    core_timing_wheel_init(&wheel, sizeof(int), TICK_DURATION, NULL);
+
+    TEST_INT_EQUALS(core_timing_wheel_size(&wheel), 0);
+    TEST_INT_EQUALS(core_timing_wheel_pop(&wheel, 1000000, &key, &value), 0);
+
+    /*
+     * An entry is not due before its tick.
+     */
+    core_timing_wheel_add(&wheel, 5000000, &i);
+    TEST_INT_EQUALS(core_timing_wheel_pop(&wheel, 4000000, &key, &value), 0);
+    TEST_INT_EQUALS(core_timing_wheel_size(&wheel), 1);
+    TEST_INT_EQUALS(core_timing_wheel_pop(&wheel, 5000000, &key, &value), 1);
+    TEST_UINT64_T_EQUALS(key, 5000000);
+    TEST_BOOLEAN_EQUALS(core_timing_wheel_empty(&wheel), TRUE);
+
+    /*
+     * An entry in the past is due right away.
+     */
+    value = 42;
+    core_timing_wheel_add(&wheel, 10, &value);
+    value = 0;
+    TEST_INT_EQUALS(core_timing_wheel_pop(&wheel, 5000000, &key, &value), 1);
+    TEST_INT_EQUALS(value, 42);
+
+    /*
+     * Entries at all the levels are removed in the order of their ticks.
+     */
+    srand(7);
+    count = 10000;
+    now = 5000000;
+    expected_sum = 0;
+
+    for (i = 0; i < count; ++i) {
+        key = now + ((uint64_t)rand() << (rand() % 24));
+        value = i;
+        expected_sum += i;
+        core_timing_wheel_add(&wheel, key, &value);
+    }
+
+    TEST_INT_EQUALS(core_timing_wheel_size(&wheel), count);
+
+    popped = 0;
+    recycled = 0;
+    sum = 0;
+    last_tick = 0;
+
+    while (popped < count) {
+        now += 1 + ((uint64_t)rand() << (rand() % 16));
+
+        while (core_timing_wheel_pop(&wheel, now, &key, &value)) {
+            TEST_INT_IS_LOWER_THAN_OR_EQUAL(key / TICK_DURATION, now / TICK_DURATION);
+            TEST_INT_IS_LOWER_THAN_OR_EQUAL(last_tick, key / TICK_DURATION);
+
+            last_tick = key / TICK_DURATION;
+            sum += value;
+            ++popped;
+
+            /*
+             * Recycle some entries.
+             */
+            if (recycled < count / 4 && value % 4 == 0) {
+                key = now + 1 + rand();
+                core_timing_wheel_add(&wheel, key, &value);
+                sum -= value;
+                --popped;
+                ++recycled;
+            }
+        }
+    }
+
+    TEST_INT_EQUALS(popped, count);
+    TEST_INT_EQUALS(sum, expected_sum);
+    TEST_BOOLEAN_EQUALS(core_timing_wheel_empty(&wheel), TRUE);
+
+    core_timing_wheel_destroy(&wheel);
+
+    END_TESTS();
+
+    return 0;
+}
@@ -0,0 +1,13 @@
+TEST_TIMING_WHEEL_NAME=timing_wheel
+TEST_TIMING_WHEEL_EXECUTABLE=tests/test_$(TEST_TIMING_WHEEL_NAME)
+TEST_TIMING_WHEEL_OBJECTS=tests/test_$(TEST_TIMING_WHEEL_NAME).o
+TEST_EXECUTABLES+=$(TEST_TIMING_WHEEL_EXECUTABLE)
+TEST_OBJECTS+=$(TEST_TIMING_WHEEL_OBJECTS)
+$(TEST_TIMING_WHEEL_EXECUTABLE): $(LIBRARY_OBJECTS) $(TEST_TIMING_WHEEL_OBJECTS) $(TEST_LIBRARY_OBJECTS)
+	$(Q)$(ECHO) "  LD $@"
+	$(Q)$(CC) $(CFLAGS) $^ -o $@ $(LDFLAGS) $(CONFIG_LDFLAGS)
+TEST_TIMING_WHEEL_RUN=test_run_$(TEST_TIMING_WHEEL_NAME)
+$(TEST_TIMING_WHEEL_RUN): $(TEST_TIMING_WHEEL_EXECUTABLE)
+	./$^
+TEST_RUNS+=$(TEST_TIMING_WHEEL_RUN)
+
@@ -0,0 +1,159 @@
+#!/bin/bash
+
+# Check that spate still assembles a small genome in a few unitigs,
+# with one unitig that covers (almost) all of it.
+#
+# usage: tests/test_unitig_quality.sh
+#
+# MPIEXEC can be set to change how spate is started
+# (default: "mpiexec -n 2"). RUNS is the number of runs (default: 3).
+#
+# Walkers compete for the vertices, so the unitigs change between
+# runs. The bounds come from the runs of spate before the path
+# extensions (ACTION_ASSEMBLY_GET_PATH_EXTENSION): at most 12 unitigs
+# and a largest unitig of at least the genome length minus the kmer
+# length.
+
+spate=applications/spate_metagenome_assembler/spate
+mpiexec_command=${MPIEXEC:-"mpiexec -n 2"}
+runs=${RUNS:-3}
+kmer_length=21
+genome_length=3000
+maximum_unitig_count=12
+minimum_largest_unitig=$(($genome_length - $kmer_length))
+
+# Write a random genome and @count reads of 150 nucleotides from both
+# strands, with a fixed seed.
+function write_sample()
+{
+    local file
+    local count
+    local seed
+
+    file=$1
+    count=$2
+    seed=$3
+
+    awk -v genome_length=$genome_length -v count=$count -v seed=$seed '
+    BEGIN {
+        srand(seed);
+        split("A C G T", bases, " ");
+        complement["A"] = "T";
+        complement["C"] = "G";
+        complement["G"] = "C";
+        complement["T"] = "A";
+
+        genome = "";
+
+        for (i = 0; i < genome_length; ++i)
+            genome = genome bases[1 + int(rand() * 4)];
+
+        quality = "";
+
+        for (j = 0; j < 150; ++j)
+            quality = quality "I";
+
+        for (i = 0; i < count; ++i) {
+            sequence = substr(genome, 1 + int(rand() * (genome_length - 150 + 1)), 150);
+
+            if (rand() < 0.5) {
+                reverse = "";
+
+                for (j = 150; j >= 1; --j)
+                    reverse = reverse complement[substr(sequence, j, 1)];
+
+                sequence = reverse;
+            }
+
+            printf("@read-%d\n%s\n+\n%s\n", i, sequence, quality);
+        }
+    }' > $file
+}
+
+# Print the number of unitigs and the length of the largest one.
+function get_unitig_statistics()
+{
+    local file
+
+    file=$1
+
+    awk '
+    /^>/ {
+        if (length_ > 0)
+            ++count;
+        if (length_ > largest)
+            largest = length_;
+        length_ = 0;
+        next;
+    }
+    {
+        length_ += length($0);
+    }
+    END {
+        if (length_ > 0)
+            ++count;
+        if (length_ > largest)
+            largest = length_;
+        print count + 0, largest + 0;
+    }' $file
+}
+
+function main()
+{
+    local directory
+    local run
+    local failures
+    local result
+    local statistics
+    local unitig_count
+    local largest_unitig
+
+    if ! test -x $spate
+    then
+        echo "$spate is missing, run make"
+        echo "Test unitig-quality result: FAILED"
+        return 1
+    fi
+
+    directory=$(mktemp -d -t unitig-quality.XXXXXX)
+
+    write_sample $directory/sample.fastq 600 1
+
+    failures=0
+
+    for run in $(seq 1 $runs)
+    do
+        $mpiexec_command $spate -k $kmer_length -threads-per-node 2 \
+            -o $directory/run-$run $directory/sample.fastq &> $directory/run-$run.log
+
+        statistics=$(get_unitig_statistics $directory/run-$run/unitigs.fasta)
+        unitig_count=$(echo $statistics | awk '{print $1}')
+        largest_unitig=$(echo $statistics | awk '{print $2}')
+
+        echo "run $run: $unitig_count unitigs, largest unitig: $largest_unitig"
+
+        if test $unitig_count -eq 0 \
+            || test $unitig_count -gt $maximum_unitig_count \
+            || test $largest_unitig -lt $minimum_largest_unitig
+        then
+            failures=$(($failures + 1))
+        fi
+    done
+
+    echo "bounds: 1 to $maximum_unitig_count unitigs, largest unitig: $minimum_largest_unitig or more"
+
+    if test $failures -eq 0
+    then
+        result="PASSED"
+        rm -rf $directory
+    else
+        result="FAILED"
+        echo "Logs and outputs are in $directory"
+    fi
+
+    echo "Test unitig-quality result: $result"
+
+    test $result = "PASSED"
+}
+
+main
@@ -0,0 +1,83 @@
+
+#include <core/structures/work_stealing_deque.h>
+
+#include "test.h"
+
+int main(int argc, char **argv)
+{
+    BEGIN_TESTS();
+
+    {
+        struct core_work_stealing_deque deque;
+        int values[8];
+        void *item;
+        int i;
+
+        core_work_stealing_deque_init(&deque, 5);
+
+        TEST_INT_EQUALS(core_work_stealing_deque_capacity(&deque), 8);
+        TEST_INT_EQUALS(core_work_stealing_deque_size(&deque), 0);
+        TEST_INT_EQUALS(core_work_stealing_deque_pop(&deque, &item), 0);
+        TEST_INT_EQUALS(core_work_stealing_deque_steal(&deque, &item), 0);
+
+        for (i = 0; i < 8; ++i) {
+            TEST_INT_EQUALS(core_work_stealing_deque_push(&deque, values + i), 1);
+        }
+
+        /*
+         * The deque is full.
+         */
+        TEST_INT_EQUALS(core_work_stealing_deque_push(&deque, values), 0);
+        TEST_INT_EQUALS(core_work_stealing_deque_size(&deque), 8);
+
+        /*
+         * Thieves take the oldest items, the owner takes the newest.
+         */
+        TEST_INT_EQUALS(core_work_stealing_deque_steal(&deque, &item), 1);
+        TEST_POINTER_EQUALS(item, values + 0);
+        TEST_INT_EQUALS(core_work_stealing_deque_steal(&deque, &item), 1);
+        TEST_POINTER_EQUALS(item, values + 1);
+        TEST_INT_EQUALS(core_work_stealing_deque_pop(&deque, &item), 1);
+        TEST_POINTER_EQUALS(item, values + 7);
+        TEST_INT_EQUALS(core_work_stealing_deque_size(&deque), 5);
+
+        /*
+         * The cells are reused.
+         */
+        TEST_INT_EQUALS(core_work_stealing_deque_push(&deque, values + 0), 1);
+        TEST_INT_EQUALS(core_work_stealing_deque_push(&deque, values + 1), 1);
+        TEST_INT_EQUALS(core_work_stealing_deque_push(&deque, values + 7), 1);
+        TEST_INT_EQUALS(core_work_stealing_deque_push(&deque, values + 7), 0);
+
+        for (i = 2; i < 7; ++i) {
+            TEST_INT_EQUALS(core_work_stealing_deque_steal(&deque, &item), 1);
+            TEST_POINTER_EQUALS(item, values + i);
+        }
+
+        TEST_INT_EQUALS(core_work_stealing_deque_pop(&deque, &item), 1);
+        TEST_POINTER_EQUALS(item, values + 7);
+        TEST_INT_EQUALS(core_work_stealing_deque_pop(&deque, &item), 1);
+        TEST_POINTER_EQUALS(item, values + 1);
+
+        /*
+         * The last item.
+         */
+        TEST_INT_EQUALS(core_work_stealing_deque_pop(&deque, &item), 1);
+        TEST_POINTER_EQUALS(item, values + 0);
+
+        TEST_INT_EQUALS(core_work_stealing_deque_size(&deque), 0);
+        TEST_INT_EQUALS(core_work_stealing_deque_pop(&deque, &item), 0);
+        TEST_INT_EQUALS(core_work_stealing_deque_steal(&deque, &item), 0);
+
+        TEST_INT_EQUALS(core_work_stealing_deque_push(&deque, values + 3), 1);
+        TEST_INT_EQUALS(core_work_stealing_deque_steal(&deque, &item), 1);
+        TEST_POINTER_EQUALS(item, values + 3);
+        TEST_INT_EQUALS(core_work_stealing_deque_pop(&deque, &item), 0);
+
+        core_work_stealing_deque_destroy(&deque);
+    }
+
+    END_TESTS();
+
+    return 0;
+}
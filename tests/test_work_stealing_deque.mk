@@ -0,0 +1,13 @@
+TEST_WORK_STEALING_DEQUE_NAME=work_stealing_deque
+TEST_WORK_STEALING_DEQUE_EXECUTABLE=tests/test_$(TEST_WORK_STEALING_DEQUE_NAME)
+TEST_WORK_STEALING_DEQUE_OBJECTS=tests/test_$(TEST_WORK_STEALING_DEQUE_NAME).o
+TEST_EXECUTABLES+=$(TEST_WORK_STEALING_DEQUE_EXECUTABLE)
+TEST_OBJECTS+=$(TEST_WORK_STEALING_DEQUE_OBJECTS)
+$(TEST_WORK_STEALING_DEQUE_EXECUTABLE): $(LIBRARY_OBJECTS) $(TEST_WORK_STEALING_DEQUE_OBJECTS) $(TEST_LIBRARY_OBJECTS)
+	$(Q)$(ECHO) "  LD $@"
+	$(Q)$(CC) $(CFLAGS) $^ -o $@ $(LDFLAGS) $(CONFIG_LDFLAGS)
+TEST_WORK_STEALING_DEQUE_RUN=test_run_$(TEST_WORK_STEALING_DEQUE_NAME)
+$(TEST_WORK_STEALING_DEQUE_RUN): $(TEST_WORK_STEALING_DEQUE_EXECUTABLE)
+	./$^
+TEST_RUNS+=$(TEST_WORK_STEALING_DEQUE_RUN)
+
@@ -13,6 +13,7 @@ TRACEPOINTS_OBJECTS-y += tracepoints/message_tracepoints.o
 TRACEPOINTS_OBJECTS-y += tracepoints/actor_tracepoints.o
 TRACEPOINTS_OBJECTS-y += tracepoints/node_tracepoints.o
 TRACEPOINTS_OBJECTS-y += tracepoints/tracepoint_session.o
+TRACEPOINTS_OBJECTS-y += tracepoints/event_tracer.o
 
 TRACEPOINTS_OBJECTS-$(CONFIG_LTTNG) += tracepoints/lttng/message.o
 TRACEPOINTS_OBJECTS-$(CONFIG_LTTNG) += tracepoints/lttng/binomial_tree.o
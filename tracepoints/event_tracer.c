@@ -0,0 +1,155 @@
+
+#include "event_tracer.h"
+
+#include <core/file_storage/output/buffered_file_writer.h>
+
+#include <core/system/memory.h>
+#include <core/system/debugger.h>
+
+#include <stdio.h>
+
+#define MEMORY_EVENT_TRACER 0x633ebdf4
+
+#define INDEX_MASK (THORIUM_EVENT_TRACER_CAPACITY - 1)
+
+void thorium_event_tracer_init(struct thorium_event_tracer *self, int thread)
+{
+    self->enabled = 0;
+    self->thread = thread;
+
+    self->head = 0;
+    self->tail = 0;
+
+    self->events = NULL;
+    self->dropped_event_count = 0;
+
+    core_timer_init(&self->timer);
+}
+
+void thorium_event_tracer_destroy(struct thorium_event_tracer *self)
+{
+    if (self->events != NULL) {
+        core_memory_free(self->events, MEMORY_EVENT_TRACER);
+        self->events = NULL;
+    }
+
+    self->enabled = 0;
+
+    core_timer_destroy(&self->timer);
+}
+
+/*
+ * This must be done before the producer starts.
+ */
+void thorium_event_tracer_enable(struct thorium_event_tracer *self)
+{
+    if (self->events == NULL) {
+        self->events = core_memory_allocate(THORIUM_EVENT_TRACER_CAPACITY * sizeof(struct thorium_trace_event),
+                        MEMORY_EVENT_TRACER);
+    }
+
+    self->enabled = 1;
+}
+
+int thorium_event_tracer_is_enabled(struct thorium_event_tracer *self)
+{
+    return self->enabled;
+}
+
+void thorium_event_tracer_record(struct thorium_event_tracer *self, int type,
+                int actor, int peer, int action, int count)
+{
+    struct thorium_trace_event *event;
+    uint64_t tail;
+
+    tail = self->tail;
+
+    if (tail - self->head == THORIUM_EVENT_TRACER_CAPACITY) {
+        ++self->dropped_event_count;
+        return;
+    }
+
+    event = self->events + (tail & INDEX_MASK);
+
+    event->time = core_timer_get_nanoseconds(&self->timer);
+    event->type = type;
+    event->thread = self->thread;
+    event->actor = actor;
+    event->peer = peer;
+    event->action = action;
+    event->count = count;
+
+    /*
+     * The event must be visible before the tail is moved.
+     */
+    core_memory_store_fence();
+    self->tail = tail + 1;
+}
+
+int thorium_event_tracer_drain(struct thorium_event_tracer *self,
+                struct core_buffered_file_writer *writer)
+{
+    uint64_t head;
+    uint64_t tail;
+    int count;
+    int first;
+    int index;
+
+    if (!self->enabled)
+        return 0;
+
+    head = self->head;
+    tail = self->tail;
+
+    /*
+     * Read the events after reading the tail.
+     */
+    core_memory_load_fence();
+
+    count = tail - head;
+
+    if (count == 0)
+        return 0;
+
+    /*
+     * The events may wrap around the end of the ring.
+     */
+    index = head & INDEX_MASK;
+    first = THORIUM_EVENT_TRACER_CAPACITY - index;
+
+    if (first > count)
+        first = count;
+
+    core_buffered_file_writer_write(writer, (char *)(self->events + index),
+                    first * sizeof(struct thorium_trace_event));
+
+    if (count > first) {
+        core_buffered_file_writer_write(writer, (char *)self->events,
+                    (count - first) * sizeof(struct thorium_trace_event));
+    }
+
+    /*
+     * The events were copied before the producer can reuse them.
+     */
+    core_memory_fence();
+    self->head = tail;
+
+    return count;
+}
+
+uint64_t thorium_event_tracer_dropped_event_count(struct thorium_event_tracer *self)
+{
+    return self->dropped_event_count;
+}
+
+void thorium_event_tracer_write_header(struct core_buffered_file_writer *writer, int node)
+{
+    struct thorium_trace_file_header header;
+
+    header.magic = THORIUM_EVENT_TRACER_MAGIC;
+    header.version = THORIUM_EVENT_TRACER_VERSION;
+    header.node = node;
+    header.event_size = sizeof(struct thorium_trace_event);
+
+    core_buffered_file_writer_write(writer, (char *)&header, sizeof(header));
+}
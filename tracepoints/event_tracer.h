@@ -0,0 +1,120 @@
+
+#ifndef THORIUM_EVENT_TRACER_H
+#define THORIUM_EVENT_TRACER_H
+
+#include <core/system/timer.h>
+
+#include <stdint.h>
+
+struct core_buffered_file_writer;
+
+/*
+ * Event types.
+ */
+#define THORIUM_TRACE_EVENT_ACTOR_RECEIVE_ENTER     0
+#define THORIUM_TRACE_EVENT_ACTOR_RECEIVE_EXIT      1
+#define THORIUM_TRACE_EVENT_ACTOR_SEND              2
+#define THORIUM_TRACE_EVENT_MULTIPLEXER_FLUSH       3
+#define THORIUM_TRACE_EVENT_TRANSPORT_SEND          4
+#define THORIUM_TRACE_EVENT_TRANSPORT_RECEIVE       5
+
+/*
+ * Threads of a node that are not workers.
+ */
+#define THORIUM_TRACE_THREAD_NODE                   (-1)
+#define THORIUM_TRACE_THREAD_NODE_SEND              (-2)
+
+/*
+ * Events in each ring (must be a power of 2).
+ */
+#define THORIUM_EVENT_TRACER_CAPACITY               65536
+
+/*
+ * Header of an event file, followed by the events.
+ */
+#define THORIUM_EVENT_TRACER_MAGIC                  0x544e5645
+#define THORIUM_EVENT_TRACER_VERSION                1
+
+struct thorium_trace_file_header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t node;
+    uint32_t event_size;
+};
+
+/*
+ * A fixed-size binary event.
+ *
+ * For ACTOR_RECEIVE_*, actor is the receiver and peer is the source.
+ * For ACTOR_SEND, actor is the source and peer is the destination.
+ * For MULTIPLEXER_FLUSH, actor is the number of multiplexed messages,
+ * peer is the destination node, and action is the reason
+ * (1: size, 2: timeout, 3: degree of aggregation).
+ * For TRANSPORT_*, peer is the other node.
+ */
+struct thorium_trace_event {
+    uint64_t time;
+    int32_t type;
+    int32_t thread;
+    int32_t actor;
+    int32_t peer;
+    int32_t action;
+    int32_t count;
+};
+
+/*
+ * A single-producer single-consumer ring of events.
+ *
+ * The producer is the thread that owns the tracer (a worker or the node).
+ * The consumer is the main thread of the node which drains all the rings
+ * in the event file of the node. When a ring is full, events are dropped
+ * and counted.
+ *
+ * Tracing is enabled at run time with -trace-events. When it is disabled,
+ * THORIUM_EVENT_TRACER_RECORD costs one predictable branch.
+ */
+struct thorium_event_tracer {
+    int enabled;
+    int thread;
+
+    volatile uint64_t head;
+    volatile uint64_t tail;
+
+    struct thorium_trace_event *events;
+    uint64_t dropped_event_count;
+
+    struct core_timer timer;
+};
+
+#define THORIUM_EVENT_TRACER_RECORD(tracer, type, actor, peer, action, count) \
+    do { \
+        if ((tracer)->enabled) { \
+            thorium_event_tracer_record(tracer, type, actor, peer, action, count); \
+        } \
+    } while (0)
+
+void thorium_event_tracer_init(struct thorium_event_tracer *self, int thread);
+void thorium_event_tracer_destroy(struct thorium_event_tracer *self);
+
+void thorium_event_tracer_enable(struct thorium_event_tracer *self);
+int thorium_event_tracer_is_enabled(struct thorium_event_tracer *self);
+
+/*
+ * Called by the producer.
+ */
+void thorium_event_tracer_record(struct thorium_event_tracer *self, int type,
+                int actor, int peer, int action, int count);
+
+/*
+ * Called by the consumer.
+ *
+ * \return the number of events written
+ */
+int thorium_event_tracer_drain(struct thorium_event_tracer *self,
+                struct core_buffered_file_writer *writer);
+
+uint64_t thorium_event_tracer_dropped_event_count(struct thorium_event_tracer *self);
+
+void thorium_event_tracer_write_header(struct core_buffered_file_writer *writer, int node);
+
+#endif